@@ -16,12 +16,107 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <algorithm>
 #include <string>
 
+#include "monitoring/statistics.h"
+#include "util/compression.h"
 #include "util/mutexlock.h"
+#include "util/sync_point.h"
 
 namespace rocksdb {
 
+namespace {
+// The compressed tier adapts its share of the capacity once per this many
+// demotions in a shard, by kTierRatioStep at a time.
+const uint64_t kTierAdaptInterval = 1024;
+const double kTierRatioStep = 0.05;
+
+// Entries of the compressed tier are a std::string that holds the
+// compression type followed by the (maybe compressed) saved entry.
+void DeleteTierEntry(const Slice& key, void* value) {
+  delete reinterpret_cast<std::string*>(value);
+}
+
+// Returns false if the data does not compress well with type
+bool CompressTierEntry(CompressionType type, const Slice& raw,
+                       std::string* output) {
+  CompressionOptions opts;
+  // Decompressed sizes are stored in the compressed data
+  const uint32_t kFormatVersion = 2;
+  bool ok = false;
+  switch (type) {
+    case kSnappyCompression:
+      ok = Snappy_Compress(opts, raw.data(), raw.size(), output);
+      break;
+    case kZlibCompression:
+      ok = Zlib_Compress(opts, kFormatVersion, raw.data(), raw.size(), output);
+      break;
+    case kLZ4Compression:
+      ok = LZ4_Compress(opts, kFormatVersion, raw.data(), raw.size(), output);
+      break;
+    case kLZ4HCCompression:
+      ok = LZ4HC_Compress(opts, kFormatVersion, raw.data(), raw.size(),
+                          output);
+      break;
+    case kZSTD:
+    case kZSTDNotFinalCompression:
+      ok = ZSTD_Compress(opts, raw.data(), raw.size(), output);
+      break;
+    default:
+      break;
+  }
+  // Same threshold as for data blocks: at least 12.5% smaller
+  return ok && output->size() < raw.size() - (raw.size() / 8u);
+}
+
+CacheAllocationPtr UncompressTierEntry(CompressionType type, const Slice& data,
+                                       size_t* size) {
+  const uint32_t kFormatVersion = 2;
+  int decompress_size = 0;
+  CacheAllocationPtr result;
+  switch (type) {
+    case kSnappyCompression: {
+      size_t ulength = 0;
+      if (!Snappy_GetUncompressedLength(data.data(), data.size(), &ulength)) {
+        return nullptr;
+      }
+      result = AllocateBlock(ulength, nullptr);
+      if (!Snappy_Uncompress(data.data(), data.size(), result.get())) {
+        return nullptr;
+      }
+      *size = ulength;
+      return result;
+    }
+    case kZlibCompression:
+      result = Zlib_Uncompress(data.data(), data.size(), &decompress_size,
+                               kFormatVersion);
+      break;
+    case kLZ4Compression:
+    case kLZ4HCCompression:
+      result = LZ4_Uncompress(data.data(), data.size(), &decompress_size,
+                              kFormatVersion);
+      break;
+    case kZSTD:
+    case kZSTDNotFinalCompression:
+      result = ZSTD_Uncompress(data.data(), data.size(), &decompress_size);
+      break;
+    default:
+      return nullptr;
+  }
+  *size = static_cast<size_t>(decompress_size);
+  return result;
+}
+}  // namespace
+
+CompressedTierOptions::CompressedTierOptions()
+    : compression_type(kLZ4Compression),
+      initial_ratio(0.25),
+      adaptive(true),
+      min_ratio(0.05),
+      max_ratio(0.6) {}
+
 LRUHandleTable::LRUHandleTable() : list_(nullptr), length_(0), elems_(0) {
   Resize();
 }
@@ -100,11 +195,25 @@ void LRUHandleTable::Resize() {
 }
 
 LRUCacheShard::LRUCacheShard()
-    : high_pri_pool_usage_(0), usage_(0), lru_usage_(0) {
+    : total_capacity_(0),
+      high_pri_pool_usage_(0),
+      compressed_tier_(nullptr),
+      tier_compression_type_(kNoCompression),
+      tier_adaptive_(false),
+      tier_min_ratio_(0),
+      tier_max_ratio_(0),
+      allocator_(nullptr),
+      usage_(0),
+      lru_usage_(0),
+      tier_ratio_(0),
+      tier_demotions_(0),
+      tier_hits_(0),
+      update_seq_(0) {
   // Make empty circular linked list
   lru_.next = &lru_;
   lru_.prev = &lru_;
   lru_low_pri_ = &lru_;
+  memset(key_update_seq_, 0, sizeof(key_update_seq_));
 }
 
 LRUCacheShard::~LRUCacheShard() {}
@@ -138,6 +247,9 @@ void LRUCacheShard::EraseUnRefEntries() {
   for (auto entry : last_reference_list) {
     entry->Free();
   }
+  if (compressed_tier_ != nullptr) {
+    compressed_tier_->EraseUnRefEntries();
+  }
 }
 
 void LRUCacheShard::ApplyToAllCacheEntries(void (*callback)(void*, size_t),
@@ -233,6 +345,96 @@ void LRUCacheShard::EvictFromLRU(size_t charge,
   }
 }
 
+void LRUCacheShard::FreeEvicted(const autovector<LRUHandle*>& entries,
+                                size_t num_evicted, uint64_t evict_seq) {
+  for (size_t i = 0; i < entries.size(); i++) {
+    if (i < num_evicted && compressed_tier_ != nullptr &&
+        entries[i]->helper != nullptr) {
+      Demote(entries[i], evict_seq);
+    }
+    entries[i]->Free();
+  }
+  if (num_evicted > 0 && compressed_tier_ != nullptr) {
+    MaybeAdaptTierSplit();
+  }
+}
+
+void LRUCacheShard::Demote(LRUHandle* e, uint64_t evict_seq) {
+  const Cache::CacheItemHelper* helper = e->helper;
+  const size_t size = helper->size_cb(e->value);
+  if (size == 0) {
+    return;
+  }
+  std::string saved(size, '\0');
+  helper->saveto_cb(e->value, &saved[0]);
+  std::string* entry = new std::string();
+  entry->reserve(1 + size);
+  std::string compressed;
+  if (tier_compression_type_ != kNoCompression &&
+      CompressTierEntry(tier_compression_type_, saved, &compressed)) {
+    entry->push_back(static_cast<char>(tier_compression_type_));
+    entry->append(compressed);
+  } else {
+    entry->push_back(static_cast<char>(kNoCompression));
+    entry->append(saved);
+  }
+  TEST_SYNC_POINT_CALLBACK("LRUCacheShard::Demote:BeforeInsert", e);
+  {
+    // Insert() and Erase() drop the saved copy of a key only after they
+    // release mutex_, so holding it here orders the insert into the tier
+    // before theirs, or lets us see their update.
+    MutexLock l(&mutex_);
+    if (key_update_seq_[KeyUpdateStripe(e->hash)] > evict_seq) {
+      delete entry;
+      return;
+    }
+    compressed_tier_->Insert(e->key(), e->hash, entry, entry->size(),
+                             &DeleteTierEntry, nullptr, Cache::Priority::LOW);
+  }
+  tier_demotions_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LRUCacheShard::MaybeAdaptTierSplit() {
+  uint64_t demotions = tier_demotions_.load(std::memory_order_relaxed);
+  if (!tier_adaptive_ || demotions < kTierAdaptInterval ||
+      !tier_demotions_.compare_exchange_strong(demotions, 0)) {
+    return;
+  }
+  const uint64_t hits = tier_hits_.exchange(0);
+  autovector<LRUHandle*> last_reference_list;
+  size_t tier_capacity;
+  uint64_t evict_seq;
+  {
+    MutexLock l(&mutex_);
+    double ratio = tier_ratio_;
+    if (hits * 8 > demotions) {
+      // More than 1 in 8 demoted entries came back: the compressed tier
+      // holds part of the working set, and holds more of it per byte.
+      ratio = std::min(tier_max_ratio_, ratio + kTierRatioStep);
+    } else if (hits * 32 < demotions) {
+      // The compressed tier mostly holds entries that are not used again
+      ratio = std::max(tier_min_ratio_, ratio - kTierRatioStep);
+    }
+    if (ratio == tier_ratio_) {
+      return;
+    }
+    tier_ratio_ = ratio;
+    tier_capacity = static_cast<size_t>(total_capacity_ * tier_ratio_);
+    capacity_ = total_capacity_ - tier_capacity;
+    high_pri_pool_capacity_ = capacity_ * high_pri_pool_ratio_;
+    MaintainPoolSize();
+    EvictFromLRU(0, &last_reference_list);
+    evict_seq = update_seq_;
+  }
+  compressed_tier_->SetCapacity(tier_capacity);
+  for (auto entry : last_reference_list) {
+    if (entry->helper != nullptr) {
+      Demote(entry, evict_seq);
+    }
+    entry->Free();
+  }
+}
+
 void* LRUCacheShard::operator new(size_t size) {
   return port::cacheline_aligned_alloc(size);
 }
@@ -251,15 +453,28 @@ void LRUCacheShard::operator delete[](void* memblock) {
 
 void LRUCacheShard::SetCapacity(size_t capacity) {
   autovector<LRUHandle*> last_reference_list;
+  size_t tier_capacity = 0;
+  uint64_t evict_seq;
   {
     MutexLock l(&mutex_);
-    capacity_ = capacity;
+    total_capacity_ = capacity;
+    if (compressed_tier_ != nullptr) {
+      tier_capacity = static_cast<size_t>(capacity * tier_ratio_);
+    }
+    capacity_ = capacity - tier_capacity;
     high_pri_pool_capacity_ = capacity_ * high_pri_pool_ratio_;
     EvictFromLRU(0, &last_reference_list);
+    evict_seq = update_seq_;
+  }
+  if (compressed_tier_ != nullptr) {
+    compressed_tier_->SetCapacity(tier_capacity);
   }
   // we free the entries here outside of mutex for
   // performance reasons
   for (auto entry : last_reference_list) {
+    if (compressed_tier_ != nullptr && entry->helper != nullptr) {
+      Demote(entry, evict_seq);
+    }
     entry->Free();
   }
 }
@@ -282,6 +497,55 @@ Cache::Handle* LRUCacheShard::Lookup(const Slice& key, uint32_t hash) {
   return reinterpret_cast<Cache::Handle*>(e);
 }
 
+Cache::Handle* LRUCacheShard::LookupWithHelper(
+    const Slice& key, uint32_t hash, const Cache::CacheItemHelper* helper,
+    void* create_context, Statistics* stats) {
+  Cache::Handle* handle = Lookup(key, hash);
+  if (handle != nullptr || compressed_tier_ == nullptr) {
+    return handle;
+  }
+  Cache::Handle* tier_handle = compressed_tier_->Lookup(key, hash);
+  if (tier_handle == nullptr) {
+    return nullptr;
+  }
+  const std::string* entry = reinterpret_cast<const std::string*>(
+      reinterpret_cast<LRUHandle*>(tier_handle)->value);
+  assert(!entry->empty());
+  const CompressionType type = static_cast<CompressionType>((*entry)[0]);
+  Slice data(entry->data() + 1, entry->size() - 1);
+  CacheAllocationPtr uncompressed;
+  Status s;
+  if (type != kNoCompression) {
+    size_t size = 0;
+    uncompressed = UncompressTierEntry(type, data, &size);
+    if (uncompressed) {
+      data = Slice(uncompressed.get(), size);
+    } else {
+      s = Status::Corruption("Cannot uncompress cache entry");
+    }
+  }
+  void* value = nullptr;
+  size_t charge = 0;
+  if (s.ok()) {
+    s = helper->create_cb(data, create_context, allocator_, &value, &charge);
+  }
+  uncompressed.reset();
+  // The entry moves back to this tier
+  compressed_tier_->Release(tier_handle, true /* force_erase */);
+  if (!s.ok()) {
+    return nullptr;
+  }
+  tier_hits_.fetch_add(1, std::memory_order_relaxed);
+  RecordTick(stats, BLOCK_CACHE_COMPRESSED_TIER_HIT);
+  s = InsertItem(key, hash, value, charge, helper->del_cb, helper, &handle,
+                 Cache::Priority::LOW);
+  if (!s.ok()) {
+    (*helper->del_cb)(key, value);
+    return nullptr;
+  }
+  return handle;
+}
+
 bool LRUCacheShard::Ref(Cache::Handle* h) {
   LRUHandle* handle = reinterpret_cast<LRUHandle*>(h);
   MutexLock l(&mutex_);
@@ -292,6 +556,22 @@ bool LRUCacheShard::Ref(Cache::Handle* h) {
   return true;
 }
 
+void LRUCacheShard::SetCompressedTier(LRUCacheShard* tier,
+                                      const CompressedTierOptions& tier_options,
+                                      MemoryAllocator* allocator) {
+  MutexLock l(&mutex_);
+  compressed_tier_ = tier;
+  tier_compression_type_ =
+      CompressionTypeSupported(tier_options.compression_type)
+          ? tier_options.compression_type
+          : kNoCompression;
+  tier_adaptive_ = tier_options.adaptive;
+  tier_min_ratio_ = tier_options.min_ratio;
+  tier_max_ratio_ = tier_options.max_ratio;
+  tier_ratio_ = tier_options.initial_ratio;
+  allocator_ = allocator;
+}
+
 void LRUCacheShard::SetHighPriorityPoolRatio(double high_pri_pool_ratio) {
   MutexLock l(&mutex_);
   high_pri_pool_ratio_ = high_pri_pool_ratio;
@@ -305,6 +585,8 @@ bool LRUCacheShard::Release(Cache::Handle* handle, bool force_erase) {
   }
   LRUHandle* e = reinterpret_cast<LRUHandle*>(handle);
   bool last_reference = false;
+  bool evicted = false;
+  uint64_t evict_seq = 0;
   {
     MutexLock l(&mutex_);
     last_reference = Unref(e);
@@ -323,6 +605,8 @@ bool LRUCacheShard::Release(Cache::Handle* handle, bool force_erase) {
         Unref(e);
         usage_ -= e->charge;
         last_reference = true;
+        evicted = !force_erase;
+        evict_seq = update_seq_;
       } else {
         // put the item on the list to be potentially freed
         LRU_Insert(e);
@@ -331,6 +615,9 @@ bool LRUCacheShard::Release(Cache::Handle* handle, bool force_erase) {
   }
 
   // free outside of mutex
+  if (evicted && compressed_tier_ != nullptr && e->helper != nullptr) {
+    Demote(e, evict_seq);
+  }
   if (last_reference) {
     e->Free();
   }
@@ -341,6 +628,25 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
                              size_t charge,
                              void (*deleter)(const Slice& key, void* value),
                              Cache::Handle** handle, Cache::Priority priority) {
+  return InsertItem(key, hash, value, charge, deleter, nullptr, handle,
+                    priority);
+}
+
+Status LRUCacheShard::InsertWithHelper(const Slice& key, uint32_t hash,
+                                       void* value,
+                                       const Cache::CacheItemHelper* helper,
+                                       size_t charge, Cache::Handle** handle,
+                                       Cache::Priority priority) {
+  return InsertItem(key, hash, value, charge, helper->del_cb, helper, handle,
+                    priority);
+}
+
+Status LRUCacheShard::InsertItem(const Slice& key, uint32_t hash, void* value,
+                                 size_t charge,
+                                 void (*deleter)(const Slice& key, void* value),
+                                 const Cache::CacheItemHelper* helper,
+                                 Cache::Handle** handle,
+                                 Cache::Priority priority) {
   // Allocate the memory here outside of the mutex
   // If the cache is full, we'll have to release it
   // It shouldn't happen very often though.
@@ -348,9 +654,12 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
       new char[sizeof(LRUHandle) - 1 + key.size()]);
   Status s;
   autovector<LRUHandle*> last_reference_list;
+  size_t num_evicted = 0;
+  uint64_t evict_seq;
 
   e->value = value;
   e->deleter = deleter;
+  e->helper = helper;
   e->charge = charge;
   e->key_length = key.size();
   e->hash = hash;
@@ -368,6 +677,11 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
     // Free the space following strict LRU policy until enough space
     // is freed or the lru list is empty
     EvictFromLRU(charge, &last_reference_list);
+    num_evicted = last_reference_list.size();
+    // Taken before this insert is recorded, so that an evicted older value
+    // of the key is not demoted
+    evict_seq = update_seq_;
+    RecordKeyUpdate(hash);
 
     if (usage_ - lru_usage_ + charge > capacity_ &&
         (strict_capacity_limit_ || handle == nullptr)) {
@@ -405,11 +719,14 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
     }
   }
 
+  if (compressed_tier_ != nullptr) {
+    // Drop a saved copy of an older value
+    compressed_tier_->Erase(key, hash);
+  }
+
   // we free the entries here outside of mutex for
   // performance reasons
-  for (auto entry : last_reference_list) {
-    entry->Free();
-  }
+  FreeEvicted(last_reference_list, num_evicted, evict_seq);
 
   return s;
 }
@@ -419,6 +736,7 @@ void LRUCacheShard::Erase(const Slice& key, uint32_t hash) {
   bool last_reference = false;
   {
     MutexLock l(&mutex_);
+    RecordKeyUpdate(hash);
     e = table_.Remove(key, hash);
     if (e != nullptr) {
       last_reference = Unref(e);
@@ -437,11 +755,16 @@ void LRUCacheShard::Erase(const Slice& key, uint32_t hash) {
   if (last_reference) {
     e->Free();
   }
+  if (compressed_tier_ != nullptr) {
+    compressed_tier_->Erase(key, hash);
+  }
 }
 
 size_t LRUCacheShard::GetUsage() const {
+  size_t tier_usage =
+      compressed_tier_ != nullptr ? compressed_tier_->GetUsage() : 0;
   MutexLock l(&mutex_);
-  return usage_;
+  return usage_ + tier_usage;
 }
 
 size_t LRUCacheShard::GetPinnedUsage() const {
@@ -458,14 +781,36 @@ std::string LRUCacheShard::GetPrintableOptions() const {
     snprintf(buffer, kBufferSize, "    high_pri_pool_ratio: %.3lf\n",
              high_pri_pool_ratio_);
   }
-  return std::string(buffer);
+  std::string ret(buffer);
+  if (compressed_tier_ != nullptr) {
+    snprintf(buffer, kBufferSize,
+             "    compressed_tier_compression: %s\n"
+             "    compressed_tier_adaptive: %d\n"
+             "    compressed_tier_ratio: %.3lf [%.3lf, %.3lf]\n",
+             CompressionTypeToString(tier_compression_type_).c_str(),
+             tier_adaptive_, tier_ratio_, tier_min_ratio_, tier_max_ratio_);
+    ret.append(buffer);
+  }
+  return ret;
 }
 
 LRUCache::LRUCache(size_t capacity, int num_shard_bits,
-                   bool strict_capacity_limit, double high_pri_pool_ratio)
-    : ShardedCache(capacity, num_shard_bits, strict_capacity_limit) {
+                   bool strict_capacity_limit, double high_pri_pool_ratio,
+                   std::shared_ptr<MemoryAllocator> memory_allocator,
+                   const CompressedTierOptions* tier_options)
+    : ShardedCache(capacity, num_shard_bits, strict_capacity_limit,
+                   std::move(memory_allocator)) {
   num_shards_ = 1 << num_shard_bits;
   shards_ = new LRUCacheShard[num_shards_];
+  if (tier_options != nullptr) {
+    tier_shards_ = new LRUCacheShard[num_shards_];
+    for (int i = 0; i < num_shards_; i++) {
+      tier_shards_[i].SetStrictCapacityLimit(false);
+      tier_shards_[i].SetHighPriorityPoolRatio(0.0);
+      shards_[i].SetCompressedTier(&tier_shards_[i], *tier_options,
+                                   this->memory_allocator());
+    }
+  }
   SetCapacity(capacity);
   SetStrictCapacityLimit(strict_capacity_limit);
   for (int i = 0; i < num_shards_; i++) {
@@ -473,7 +818,31 @@ LRUCache::LRUCache(size_t capacity, int num_shard_bits,
   }
 }
 
-LRUCache::~LRUCache() { delete[] shards_; }
+LRUCache::~LRUCache() {
+  delete[] shards_;
+  delete[] tier_shards_;
+}
+
+Status LRUCache::InsertWithHelper(const Slice& key, void* value,
+                                  const CacheItemHelper* helper, size_t charge,
+                                  Handle** handle, Priority priority) {
+  if (tier_shards_ == nullptr) {
+    // Same as Insert(), which subclasses may override
+    return Insert(key, value, charge, helper->del_cb, handle, priority);
+  }
+  return ShardedCache::InsertWithHelper(key, value, helper, charge, handle,
+                                        priority);
+}
+
+Cache::Handle* LRUCache::LookupWithHelper(const Slice& key,
+                                          const CacheItemHelper* helper,
+                                          void* create_context,
+                                          Statistics* stats) {
+  if (tier_shards_ == nullptr) {
+    return Lookup(key, stats);
+  }
+  return ShardedCache::LookupWithHelper(key, helper, create_context, stats);
+}
 
 CacheShard* LRUCache::GetShard(int shard) {
   return reinterpret_cast<CacheShard*>(&shards_[shard]);
@@ -499,6 +868,7 @@ void LRUCache::DisownData() {
 // Do not drop data if compile with ASAN to suppress leak warning.
 #ifndef __SANITIZE_ADDRESS__
   shards_ = nullptr;
+  tier_shards_ = nullptr;
 #endif  // !__SANITIZE_ADDRESS__
 }
 
@@ -510,9 +880,10 @@ size_t LRUCache::TEST_GetLRUSize() {
   return lru_size_of_all_shards;
 }
 
-std::shared_ptr<Cache> NewLRUCache(size_t capacity, int num_shard_bits,
-                                   bool strict_capacity_limit,
-                                   double high_pri_pool_ratio) {
+std::shared_ptr<Cache> NewLRUCache(
+    size_t capacity, int num_shard_bits, bool strict_capacity_limit,
+    double high_pri_pool_ratio,
+    std::shared_ptr<MemoryAllocator> memory_allocator) {
   if (num_shard_bits >= 20) {
     return nullptr;  // the cache cannot be sharded into too many fine pieces
   }
@@ -524,7 +895,34 @@ std::shared_ptr<Cache> NewLRUCache(size_t capacity, int num_shard_bits,
     num_shard_bits = GetDefaultCacheShardBits(capacity);
   }
   return std::make_shared<LRUCache>(capacity, num_shard_bits,
-                                    strict_capacity_limit, high_pri_pool_ratio);
+                                    strict_capacity_limit, high_pri_pool_ratio,
+                                    std::move(memory_allocator));
+}
+
+std::shared_ptr<Cache> NewCompressedTieredCache(
+    size_t capacity, const CompressedTierOptions& tier_options,
+    int num_shard_bits, bool strict_capacity_limit, double high_pri_pool_ratio,
+    std::shared_ptr<MemoryAllocator> memory_allocator) {
+  if (num_shard_bits >= 20) {
+    return nullptr;  // the cache cannot be sharded into too many fine pieces
+  }
+  if (high_pri_pool_ratio < 0.0 || high_pri_pool_ratio > 1.0) {
+    // invalid high_pri_pool_ratio
+    return nullptr;
+  }
+  if (tier_options.min_ratio < 0.0 ||
+      tier_options.min_ratio > tier_options.initial_ratio ||
+      tier_options.initial_ratio > tier_options.max_ratio ||
+      tier_options.max_ratio >= 1.0) {
+    // invalid tier ratios
+    return nullptr;
+  }
+  if (num_shard_bits < 0) {
+    num_shard_bits = GetDefaultCacheShardBits(capacity);
+  }
+  return std::make_shared<LRUCache>(
+      capacity, num_shard_bits, strict_capacity_limit, high_pri_pool_ratio,
+      std::move(memory_allocator), &tier_options);
 }
 
 }  // namespace rocksdb
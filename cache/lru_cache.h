@@ -8,6 +8,7 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #pragma once
 
+#include <atomic>
 #include <string>
 
 #include "cache/sharded_cache.h"
@@ -46,6 +47,8 @@ namespace rocksdb {
 struct LRUHandle {
   void* value;
   void (*deleter)(const Slice&, void* value);
+  // Set for entries that can be saved to a compressed tier
+  const Cache::CacheItemHelper* helper;
   LRUHandle* next_hash;
   LRUHandle* next;
   LRUHandle* prev;
@@ -170,13 +173,29 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard : public CacheShard {
   // Set percentage of capacity reserved for high-pri cache entries.
   void SetHighPriorityPoolRatio(double high_pri_pool_ratio);
 
+  // Keep the entries evicted for room in `tier`, compressed, and give it
+  // part of the capacity set by SetCapacity(). Must be called before
+  // SetCapacity().
+  void SetCompressedTier(LRUCacheShard* tier,
+                         const CompressedTierOptions& tier_options,
+                         MemoryAllocator* allocator);
+
   // Like Cache methods, but with an extra "hash" parameter.
   virtual Status Insert(const Slice& key, uint32_t hash, void* value,
                         size_t charge,
                         void (*deleter)(const Slice& key, void* value),
                         Cache::Handle** handle,
                         Cache::Priority priority) override;
+  virtual Status InsertWithHelper(const Slice& key, uint32_t hash,
+                                  void* value,
+                                  const Cache::CacheItemHelper* helper,
+                                  size_t charge, Cache::Handle** handle,
+                                  Cache::Priority priority) override;
   virtual Cache::Handle* Lookup(const Slice& key, uint32_t hash) override;
+  virtual Cache::Handle* LookupWithHelper(const Slice& key, uint32_t hash,
+                                          const Cache::CacheItemHelper* helper,
+                                          void* create_context,
+                                          Statistics* stats) override;
   virtual bool Ref(Cache::Handle* handle) override;
   virtual bool Release(Cache::Handle* handle,
                        bool force_erase = false) override;
@@ -229,9 +248,45 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard : public CacheShard {
   // holding the mutex_
   void EvictFromLRU(size_t charge, autovector<LRUHandle*>* deleted);
 
+  Status InsertItem(const Slice& key, uint32_t hash, void* value,
+                    size_t charge, void (*deleter)(const Slice& key,
+                                                   void* value),
+                    const Cache::CacheItemHelper* helper,
+                    Cache::Handle** handle, Cache::Priority priority);
+
+  // Frees entries that were evicted for room, after saving the first
+  // num_evicted of them to the compressed tier. evict_seq is update_seq_ as
+  // of the eviction. Called without mutex_ held.
+  void FreeEvicted(const autovector<LRUHandle*>& entries, size_t num_evicted,
+                   uint64_t evict_seq);
+
+  // Compresses the entry and inserts it into the compressed tier, unless its
+  // key was inserted or erased after update_seq_ was evict_seq. Called
+  // without mutex_ held; the compression runs on the calling thread.
+  void Demote(LRUHandle* e, uint64_t evict_seq);
+
+  // Records an insert or erase of a key with the given hash.
+  // REQUIRES: mutex_ held
+  void RecordKeyUpdate(uint32_t hash) {
+    key_update_seq_[KeyUpdateStripe(hash)] = ++update_seq_;
+  }
+
+  // The low bits of the hashes of keys that differ only in their last bytes
+  // are often the same, so the stripe comes from all the bits
+  static uint32_t KeyUpdateStripe(uint32_t hash) {
+    return (hash * 0x9E3779B1U) >> (32 - kKeyUpdateStripeBits);
+  }
+
+  // Moves capacity between this tier and the compressed tier, based on how
+  // many of the entries demoted since the last call were looked up again.
+  void MaybeAdaptTierSplit();
+
   // Initialized before use.
   size_t capacity_;
 
+  // Capacity of this shard including the compressed tier
+  size_t total_capacity_;
+
   // Memory size for entries in high-pri pool.
   size_t high_pri_pool_usage_;
 
@@ -253,6 +308,14 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard : public CacheShard {
   // Pointer to head of low-pri pool in LRU list.
   LRUHandle* lru_low_pri_;
 
+  // Compressed tier, or nullptr. Owned by LRUCache.
+  LRUCacheShard* compressed_tier_;
+  CompressionType tier_compression_type_;
+  bool tier_adaptive_;
+  double tier_min_ratio_;
+  double tier_max_ratio_;
+  MemoryAllocator* allocator_;
+
   // ------------^^^^^^^^^^^^^-----------
   // Not frequently modified data members
   // ------------------------------------
@@ -272,6 +335,24 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard : public CacheShard {
   // Memory size for entries residing only in the LRU list
   size_t lru_usage_;
 
+  // Fraction of total_capacity_ given to the compressed tier
+  double tier_ratio_;
+
+  // Entries demoted to, and promoted from, the compressed tier since the
+  // split was last adapted
+  std::atomic<uint64_t> tier_demotions_;
+  std::atomic<uint64_t> tier_hits_;
+
+  // Inserts and erases are numbered by update_seq_, and key_update_seq_
+  // keeps the number of the last one for each stripe of key hashes. An
+  // entry is demoted after mutex_ is released, so Demote() uses them to
+  // skip an entry whose key may have been inserted or erased since it was
+  // evicted.
+  static const int kKeyUpdateStripeBits = 6;
+  static const uint32_t kNumKeyUpdateStripes = 1U << kKeyUpdateStripeBits;
+  uint64_t update_seq_;
+  uint64_t key_update_seq_[kNumKeyUpdateStripes];
+
   // mutex_ protects the following state.
   // We don't count mutex_ as the cache's internal state so semantically we
   // don't mind mutex_ invoking the non-const actions.
@@ -281,9 +362,18 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard : public CacheShard {
 class LRUCache : public ShardedCache {
  public:
   LRUCache(size_t capacity, int num_shard_bits, bool strict_capacity_limit,
-           double high_pri_pool_ratio);
+           double high_pri_pool_ratio,
+           std::shared_ptr<MemoryAllocator> memory_allocator = nullptr,
+           const CompressedTierOptions* tier_options = nullptr);
   virtual ~LRUCache();
   virtual const char* Name() const override { return "LRUCache"; }
+  virtual Status InsertWithHelper(const Slice& key, void* value,
+                                  const CacheItemHelper* helper, size_t charge,
+                                  Handle** handle, Priority priority) override;
+  virtual Handle* LookupWithHelper(const Slice& key,
+                                   const CacheItemHelper* helper,
+                                   void* create_context,
+                                   Statistics* stats) override;
   virtual CacheShard* GetShard(int shard) override;
   virtual const CacheShard* GetShard(int shard) const override;
   virtual void* Value(Handle* handle) override;
@@ -296,6 +386,8 @@ class LRUCache : public ShardedCache {
 
  private:
   LRUCacheShard* shards_;
+  // Compressed tiers of the shards, or nullptr
+  LRUCacheShard* tier_shards_ = nullptr;
   int num_shards_ = 0;
 };
 
@@ -5,8 +5,12 @@
 
 #include "cache/lru_cache.h"
 
+#include <stdlib.h>
 #include <string>
 #include <vector>
+#include "rocksdb/statistics.h"
+#include "util/compression.h"
+#include "util/sync_point.h"
 #include "util/testharness.h"
 
 namespace rocksdb {
@@ -164,6 +168,240 @@ TEST_F(LRUCacheTest, MidPointInsertion) {
   ValidateLRUList({"e", "f", "g", "d", "Z"}, 1);
 }
 
+namespace {
+void DeleteString(const Slice& key, void* value) {
+  delete reinterpret_cast<std::string*>(value);
+}
+
+size_t GetStringSize(void* value) {
+  return reinterpret_cast<std::string*>(value)->size();
+}
+
+void SaveStringTo(void* value, char* out) {
+  const std::string* str = reinterpret_cast<std::string*>(value);
+  memcpy(out, str->data(), str->size());
+}
+
+Status CreateString(const Slice& data, void* create_context,
+                    MemoryAllocator* allocator, void** value, size_t* charge) {
+  ++*reinterpret_cast<int*>(create_context);
+  *value = new std::string(data.ToString());
+  *charge = data.size();
+  return Status::OK();
+}
+
+const Cache::CacheItemHelper kStringHelper = {&DeleteString, &GetStringSize,
+                                              &SaveStringTo, &CreateString};
+}  // namespace
+
+class CompressedTierTest : public testing::Test {
+ public:
+  static const size_t kValueSize = 1000;
+
+  CompressedTierTest() : num_created_(0) {}
+
+  void NewCache(size_t capacity, const CompressedTierOptions& tier_options) {
+    cache_ = NewCompressedTieredCache(capacity, tier_options,
+                                      0 /* num_shard_bits */);
+    ASSERT_NE(nullptr, cache_);
+  }
+
+  static std::string Value(int i) {
+    std::string value = "value" + std::to_string(i);
+    value.resize(kValueSize, 'a');
+    return value;
+  }
+
+  static std::string Key(int i) { return "key" + std::to_string(i); }
+
+  void Insert(int i) {
+    ASSERT_OK(cache_->InsertWithHelper(Key(i), new std::string(Value(i)),
+                                       &kStringHelper, kValueSize));
+  }
+
+  // Returns false if the entry is not in either tier
+  bool Lookup(int i, Statistics* stats = nullptr) {
+    Cache::Handle* handle =
+        cache_->LookupWithHelper(Key(i), &kStringHelper, &num_created_, stats);
+    if (handle == nullptr) {
+      return false;
+    }
+    EXPECT_EQ(Value(i),
+              *reinterpret_cast<std::string*>(cache_->Value(handle)));
+    cache_->Release(handle);
+    return true;
+  }
+
+  bool InFirstTier(int i) {
+    Cache::Handle* handle = cache_->Lookup(Key(i));
+    if (handle == nullptr) {
+      return false;
+    }
+    cache_->Release(handle);
+    return true;
+  }
+
+  double GetTierRatio() {
+    const std::string options = cache_->GetPrintableOptions();
+    const std::string name = "compressed_tier_ratio: ";
+    size_t pos = options.find(name);
+    EXPECT_NE(std::string::npos, pos);
+    return atof(options.c_str() + pos + name.size());
+  }
+
+  static CompressionType SupportedCompression() {
+    for (auto type : {kLZ4Compression, kZlibCompression, kSnappyCompression,
+                      kZSTD}) {
+      if (CompressionTypeSupported(type)) {
+        return type;
+      }
+    }
+    return kNoCompression;
+  }
+
+  std::shared_ptr<Cache> cache_;
+  int num_created_;
+};
+
+TEST_F(CompressedTierTest, DemoteAndPromote) {
+  CompressedTierOptions tier_options;
+  tier_options.compression_type = SupportedCompression();
+  tier_options.adaptive = false;
+  tier_options.initial_ratio = 0.5;
+  // Room for 5 entries in each tier, even uncompressed ones with their
+  // compression type byte
+  NewCache(10 * kValueSize + 100, tier_options);
+  for (int i = 0; i < 10; i++) {
+    Insert(i);
+  }
+  // 0-4 were evicted from the first tier
+  for (int i = 0; i < 5; i++) {
+    ASSERT_FALSE(InFirstTier(i));
+  }
+  for (int i = 5; i < 10; i++) {
+    ASSERT_TRUE(InFirstTier(i));
+  }
+  ASSERT_LE(cache_->GetUsage(), 10 * kValueSize + 100);
+
+  std::shared_ptr<Statistics> stats = CreateDBStatistics();
+  ASSERT_TRUE(Lookup(0, stats.get()));
+  ASSERT_EQ(1, num_created_);
+  ASSERT_EQ(1U, stats->getTickerCount(BLOCK_CACHE_COMPRESSED_TIER_HIT));
+  // Promoted, which demoted 5
+  ASSERT_TRUE(InFirstTier(0));
+  ASSERT_FALSE(InFirstTier(5));
+  ASSERT_TRUE(Lookup(5, stats.get()));
+  ASSERT_EQ(2U, stats->getTickerCount(BLOCK_CACHE_COMPRESSED_TIER_HIT));
+  ASSERT_TRUE(Lookup(0, stats.get()));
+  ASSERT_EQ(2U, stats->getTickerCount(BLOCK_CACHE_COMPRESSED_TIER_HIT));
+
+  // Plain lookups do not go to the compressed tier
+  ASSERT_FALSE(InFirstTier(1));
+  ASSERT_EQ(nullptr, cache_->Lookup(Key(1)));
+
+  // Erase drops the entry from both tiers
+  cache_->Erase(Key(1));
+  ASSERT_FALSE(Lookup(1));
+
+  cache_->EraseUnRefEntries();
+  ASSERT_EQ(0U, cache_->GetUsage());
+  for (int i = 0; i < 10; i++) {
+    ASSERT_FALSE(Lookup(i));
+  }
+}
+
+TEST_F(CompressedTierTest, EraseWhileDemoting) {
+  CompressedTierOptions tier_options;
+  tier_options.compression_type = SupportedCompression();
+  tier_options.adaptive = false;
+  tier_options.initial_ratio = 0.5;
+  NewCache(10 * kValueSize + 100, tier_options);
+
+  // Erase key 0 after it was evicted but before it reaches the compressed
+  // tier
+  bool erased = false;
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "LRUCacheShard::Demote:BeforeInsert", [&](void* arg) {
+        LRUHandle* e = reinterpret_cast<LRUHandle*>(arg);
+        if (!erased && e->key() == Key(0)) {
+          erased = true;
+          cache_->Erase(Key(0));
+        }
+      });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+  for (int i = 0; i < 6; i++) {
+    Insert(i);
+  }
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  ASSERT_TRUE(erased);
+  ASSERT_FALSE(Lookup(0));
+  ASSERT_EQ(0, num_created_);
+}
+
+TEST_F(CompressedTierTest, EntriesWithoutHelper) {
+  CompressedTierOptions tier_options;
+  tier_options.compression_type = SupportedCompression();
+  tier_options.adaptive = false;
+  tier_options.initial_ratio = 0.5;
+  NewCache(10 * kValueSize, tier_options);
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(cache_->Insert(Key(i), new std::string(Value(i)), kValueSize,
+                             &DeleteString));
+  }
+  // Evicted entries are dropped
+  for (int i = 0; i < 5; i++) {
+    ASSERT_FALSE(Lookup(i));
+  }
+  for (int i = 5; i < 10; i++) {
+    ASSERT_TRUE(Lookup(i));
+  }
+  ASSERT_EQ(0, num_created_);
+}
+
+TEST_F(CompressedTierTest, AdaptiveSplit) {
+  CompressedTierOptions tier_options;
+  // Without compression the tiers hold as many entries per byte, which
+  // keeps the test independent of the compression libraries
+  tier_options.compression_type = kNoCompression;
+  tier_options.initial_ratio = 0.25;
+  tier_options.min_ratio = 0.05;
+  tier_options.max_ratio = 0.6;
+  NewCache(100 * kValueSize, tier_options);
+  ASSERT_DOUBLE_EQ(0.25, GetTierRatio());
+
+  // Cycling through slightly more entries than the first tier holds keeps
+  // hitting the compressed tier
+  for (int round = 0; round < 100; round++) {
+    for (int i = 0; i < 90; i++) {
+      if (!Lookup(i)) {
+        Insert(i);
+      }
+    }
+  }
+  ASSERT_DOUBLE_EQ(0.6, GetTierRatio());
+  ASSERT_LE(cache_->GetUsage(), 100 * kValueSize);
+
+  // Entries that are never looked up again shrink the compressed tier
+  for (int i = 1000; i < 20000; i++) {
+    Insert(i);
+  }
+  ASSERT_DOUBLE_EQ(0.05, GetTierRatio());
+  ASSERT_LE(cache_->GetUsage(), 100 * kValueSize);
+}
+
+TEST_F(CompressedTierTest, InvalidOptions) {
+  CompressedTierOptions tier_options;
+  tier_options.initial_ratio = 0.7;
+  tier_options.max_ratio = 0.6;
+  ASSERT_EQ(nullptr, NewCompressedTieredCache(1000, tier_options));
+  tier_options.max_ratio = 1.0;
+  ASSERT_EQ(nullptr, NewCompressedTieredCache(1000, tier_options));
+  tier_options.max_ratio = 0.8;
+  ASSERT_NE(nullptr, NewCompressedTieredCache(1000, tier_options));
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -28,7 +28,19 @@ class CacheShard {
                         size_t charge,
                         void (*deleter)(const Slice& key, void* value),
                         Cache::Handle** handle, Cache::Priority priority) = 0;
+  virtual Status InsertWithHelper(const Slice& key, uint32_t hash, void* value,
+                                  const Cache::CacheItemHelper* helper,
+                                  size_t charge, Cache::Handle** handle,
+                                  Cache::Priority priority) {
+    return Insert(key, hash, value, charge, helper->del_cb, handle, priority);
+  }
   virtual Cache::Handle* Lookup(const Slice& key, uint32_t hash) = 0;
+  virtual Cache::Handle* LookupWithHelper(const Slice& key, uint32_t hash,
+                                          const Cache::CacheItemHelper* helper,
+                                          void* create_context,
+                                          Statistics* stats) {
+    return Lookup(key, hash);
+  }
   virtual bool Ref(Cache::Handle* handle) = 0;
   virtual bool Release(Cache::Handle* handle, bool force_erase = false) = 0;
   virtual void Erase(const Slice& key, uint32_t hash) = 0;
@@ -47,7 +59,8 @@ class CacheShard {
 // Keys are sharded by the highest num_shard_bits bits of hash value.
 class ShardedCache : public Cache {
  public:
-  ShardedCache(size_t capacity, int num_shard_bits, bool strict_capacity_limit);
+  ShardedCache(size_t capacity, int num_shard_bits, bool strict_capacity_limit,
+               std::shared_ptr<MemoryAllocator> memory_allocator = nullptr);
   virtual ~ShardedCache() = default;
   virtual const char* Name() const override = 0;
   virtual CacheShard* GetShard(int shard) = 0;
@@ -63,7 +76,14 @@ class ShardedCache : public Cache {
   virtual Status Insert(const Slice& key, void* value, size_t charge,
                         void (*deleter)(const Slice& key, void* value),
                         Handle** handle, Priority priority) override;
+  virtual Status InsertWithHelper(const Slice& key, void* value,
+                                  const CacheItemHelper* helper, size_t charge,
+                                  Handle** handle, Priority priority) override;
   virtual Handle* Lookup(const Slice& key, Statistics* stats) override;
+  virtual Handle* LookupWithHelper(const Slice& key,
+                                   const CacheItemHelper* helper,
+                                   void* create_context,
+                                   Statistics* stats) override;
   virtual bool Ref(Handle* handle) override;
   virtual bool Release(Handle* handle, bool force_erase = false) override;
   virtual void Erase(const Slice& key) override;
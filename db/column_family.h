@@ -19,6 +19,7 @@
 #include "db/table_properties_collector.h"
 #include "db/write_batch_internal.h"
 #include "db/write_controller.h"
+#include "monitoring/key_range_hotness.h"
 #include "options/cf_options.h"
 #include "rocksdb/compaction_job_stats.h"
 #include "rocksdb/db.h"
@@ -28,6 +29,7 @@
 
 namespace rocksdb {
 
+class BlockCacheTracer;
 class Version;
 class VersionSet;
 class MemTable;
@@ -229,6 +231,7 @@ class ColumnFamilyData {
 #endif  // ROCKSDB_LITE
 
   InternalStats* internal_stats() { return internal_stats_.get(); }
+  KeyRangeHotness* key_range_hotness() { return &key_range_hotness_; }
 
   MemTableList* imm() { return &imm_; }
   MemTable* mem() { return mem_; }
@@ -253,6 +256,12 @@ class ColumnFamilyData {
   // See documentation in compaction_picker.h
   // REQUIRES: DB mutex held
   bool NeedsCompaction() const;
+  // How urgently this column family needs compaction. This is the larger of
+  // the highest compaction score of its levels and a weighted measure of how
+  // close it is to a write slowdown, so that column families about to stall
+  // writes are compacted before ones that merely have work pending.
+  // REQUIRES: DB mutex held
+  double CompactionUrgency() const;
   // REQUIRES: DB mutex held
   Compaction* PickCompaction(const MutableCFOptions& mutable_options,
                              LogBuffer* log_buffer);
@@ -345,7 +354,8 @@ class ColumnFamilyData {
                    const ColumnFamilyOptions& options,
                    const ImmutableDBOptions& db_options,
                    const EnvOptions& env_options,
-                   ColumnFamilySet* column_family_set);
+                   ColumnFamilySet* column_family_set,
+                   BlockCacheTracer* const block_cache_tracer);
 
   uint32_t id_;
   const std::string name_;
@@ -370,6 +380,8 @@ class ColumnFamilyData {
 
   std::unique_ptr<InternalStats> internal_stats_;
 
+  KeyRangeHotness key_range_hotness_;
+
   WriteBufferManager* write_buffer_manager_;
 
   MemTable* mem_;
@@ -465,7 +477,8 @@ class ColumnFamilySet {
                   const ImmutableDBOptions* db_options,
                   const EnvOptions& env_options, Cache* table_cache,
                   WriteBufferManager* write_buffer_manager,
-                  WriteController* write_controller);
+                  WriteController* write_controller,
+                  BlockCacheTracer* const block_cache_tracer);
   ~ColumnFamilySet();
 
   ColumnFamilyData* GetDefault() const;
@@ -524,6 +537,7 @@ class ColumnFamilySet {
   Cache* table_cache_;
   WriteBufferManager* write_buffer_manager_;
   WriteController* write_controller_;
+  BlockCacheTracer* const block_cache_tracer_;
 };
 
 // We use ColumnFamilyMemTablesImpl to provide WriteBatch a way to access
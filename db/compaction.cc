@@ -434,7 +434,8 @@ uint64_t Compaction::OutputFilePreallocationSize() const {
   return preallocation_size + (preallocation_size / 10);
 }
 
-std::unique_ptr<CompactionFilter> Compaction::CreateCompactionFilter() const {
+std::unique_ptr<CompactionFilter> Compaction::CreateCompactionFilter(
+    int job_id) const {
   if (!cfd_->ioptions()->compaction_filter_factory) {
     return nullptr;
   }
@@ -443,6 +444,7 @@ std::unique_ptr<CompactionFilter> Compaction::CreateCompactionFilter() const {
   context.is_full_compaction = is_full_compaction_;
   context.is_manual_compaction = is_manual_compaction_;
   context.column_family_id = cfd_->GetID();
+  context.job_id = job_id;
   return cfd_->ioptions()->compaction_filter_factory->CreateCompactionFilter(
       context);
 }
@@ -47,6 +47,7 @@ namespace rocksdb {
 
 class MemTable;
 class TableCache;
+class ThreadPoolImpl;
 class Version;
 class VersionEdit;
 class VersionSet;
@@ -63,7 +64,8 @@ class CompactionJob {
                 Status* db_bg_error,
                 std::vector<SequenceNumber> existing_snapshots,
                 SequenceNumber earliest_write_conflict_snapshot,
-                std::shared_ptr<Cache> table_cache, EventLogger* event_logger,
+                std::shared_ptr<Cache> table_cache,
+                ThreadPoolImpl* input_prefetch_pool, EventLogger* event_logger,
                 bool paranoid_file_checks, bool measure_io_stats,
                 const std::string& dbname,
                 CompactionJobStats* compaction_job_stats);
@@ -151,6 +153,9 @@ class CompactionJob {
 
   std::shared_ptr<Cache> table_cache_;
 
+  // Reads the input files ahead, if not nullptr
+  ThreadPoolImpl* input_prefetch_pool_;
+
   EventLogger* event_logger_;
 
   bool bottommost_level_;
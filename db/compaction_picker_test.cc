@@ -575,6 +575,33 @@ TEST_F(CompactionPickerTest, CompactionPriMinOverlapping2) {
   ASSERT_EQ(7U, compaction->input(0, 0)->fd.GetNumber());
 }
 
+TEST_F(CompactionPickerTest, CompactionPriColdestFirst) {
+  NewVersionStorage(6, kCompactionStyleLevel);
+  ioptions_.compaction_pri = kColdestFirst;
+  mutable_cf_options_.target_file_size_base = 10000000;
+  mutable_cf_options_.target_file_size_multiplier = 10;
+  mutable_cf_options_.max_bytes_for_level_base = 10 * 1024 * 1024;
+
+  Add(2, 6U, "150", "179", 50000000U);
+  files_.back()->stats.num_reads_sampled = 4096;
+  Add(2, 7U, "180", "220", 100000000U);
+  files_.back()->stats.num_reads_sampled = 2048;
+  Add(2, 8U, "321", "400", 50000000U);
+  files_.back()->stats.num_reads_sampled = 2048;
+
+  Add(3, 26U, "150", "170", 260000000U);
+  Add(3, 27U, "171", "179", 260000000U);
+  UpdateVersionStorageInfo();
+
+  std::unique_ptr<Compaction> compaction(level_compaction_picker.PickCompaction(
+      cf_name_, mutable_cf_options_, vstorage_.get(), &log_buffer_));
+  ASSERT_TRUE(compaction.get() != nullptr);
+  ASSERT_EQ(1U, compaction->num_input_files(0));
+  // Pick file 7 because it has the fewest reads per byte, even though it
+  // overlaps with more files on level 3 than file 8.
+  ASSERT_EQ(7U, compaction->input(0, 0)->fd.GetNumber());
+}
+
 TEST_F(CompactionPickerTest, CompactionPriMinOverlapping3) {
   NewVersionStorage(6, kCompactionStyleLevel);
   ioptions_.compaction_pri = kMinOverlappingRatio;
@@ -1433,6 +1460,61 @@ TEST_F(CompactionPickerTest, CacheNextCompactionIndex) {
   ASSERT_EQ(4, vstorage_->NextCompactionIndex(1 /* level */));
 }
 
+TEST_F(CompactionPickerTest, PickFileWithManySkippedTombstones) {
+  NewVersionStorage(6, kCompactionStyleLevel);
+  Add(1, 1U, "100", "200", 1U);
+  Add(1, 2U, "300", "400", 1U);
+  Add(2, 3U, "350", "450", 1U);
+
+  // Sampled iterators skipped fewer tombstones than the minimum.
+  FileMetaData* f = file_map_[2U].first;
+  f->num_entries = 100;
+  f->stats.num_tombstones_skipped_sampled = (1 << 20) - 1;
+  UpdateVersionStorageInfo();
+  ASSERT_TRUE(vstorage_->FilesMarkedForCompaction().empty());
+
+  f->stats.num_tombstones_skipped_sampled = 1 << 20;
+  vstorage_->ComputeFilesMarkedForCompaction();
+  ASSERT_EQ(1U, vstorage_->FilesMarkedForCompaction().size());
+
+  std::unique_ptr<Compaction> compaction(level_compaction_picker.PickCompaction(
+      cf_name_, mutable_cf_options_, vstorage_.get(), &log_buffer_));
+  ASSERT_TRUE(compaction.get() != nullptr);
+  ASSERT_EQ(1U, compaction->num_input_files(0));
+  ASSERT_EQ(2U, compaction->input(0, 0)->fd.GetNumber());
+  ASSERT_EQ(1U, compaction->num_input_files(1));
+  ASSERT_EQ(3U, compaction->input(1, 0)->fd.GetNumber());
+}
+
+TEST_F(CompactionPickerTest, RangeDeletionCompensatedSize) {
+  NewVersionStorage(6, kCompactionStyleLevel);
+  Add(1, 1U, "200", "500", 10U);
+  Add(2, 2U, "100", "250", 100U);
+  Add(2, 3U, "300", "350", 1000U);
+  Add(2, 4U, "400", "450", 10000U);
+  Add(3, 5U, "450", "600", 100000U);
+
+  FileMetaData* f = file_map_[1U].first;
+  f->num_range_deletions = 2;
+  // Tables written without the range deletion bounds get no boost.
+  ASSERT_EQ(0U, vstorage_->EstimateLiveDataCoveredByRangeDeletions(1, f));
+
+  // Only file 3 lies entirely within [300, 360), not the rest of the file's
+  // key range.
+  f->range_del_smallest_key = "300";
+  f->range_del_largest_key = "360";
+  ASSERT_EQ(1000U, vstorage_->EstimateLiveDataCoveredByRangeDeletions(1, f));
+
+  // Only files 3 and 4 lie entirely within [200, 500).
+  f->range_del_smallest_key = "200";
+  f->range_del_largest_key = "500";
+  ASSERT_EQ(11000U, vstorage_->EstimateLiveDataCoveredByRangeDeletions(1, f));
+
+  f->compensated_file_size = 0;
+  vstorage_->ComputeCompensatedSizes();
+  ASSERT_EQ(11010U, f->compensated_file_size);
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -317,6 +317,89 @@ TEST_F(CuckooTableDBTest, AdaptiveTable) {
   ASSERT_EQ("v4", Get("key4"));
   ASSERT_EQ("v6", Get("key5"));
 }
+
+TEST_F(CuckooTableDBTest, AdaptiveTablePerLevel) {
+  Options options = CurrentOptions();
+  BlockBasedTableOptions small_blocks;
+  small_blocks.block_size = 256;
+  BlockBasedTableOptions large_blocks;
+  large_blocks.block_size = 64 << 10;
+  // Cuckoo tables in level 0, small blocks in level 1, large blocks below
+  options.table_factory.reset(NewAdaptiveTableFactory(
+      nullptr, nullptr, nullptr, nullptr,
+      {std::shared_ptr<TableFactory>(NewCuckooTableFactory()),
+       std::shared_ptr<TableFactory>(NewBlockBasedTableFactory(small_blocks)),
+       std::shared_ptr<TableFactory>(
+           NewBlockBasedTableFactory(large_blocks))}));
+  Reopen(&options);
+
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Put(Key(i), std::string(100, 'a' + i % 26)));
+  }
+  dbfull()->TEST_FlushMemTable();
+
+  // Each step leaves a single table file
+  DB* db = dbfull();
+  auto get_properties = [&]() {
+    TablePropertiesCollection props;
+    EXPECT_OK(db->GetPropertiesOfAllTables(&props));
+    EXPECT_EQ(1U, props.size());
+    return props.begin()->second;
+  };
+  ASSERT_EQ("1", FilesPerLevel());
+  auto props = get_properties();
+  ASSERT_EQ(1U, props->user_collected_properties.count(
+                    CuckooTablePropertyNames::kEmptyKey));
+
+  ASSERT_OK(dbfull()->TEST_CompactRange(0, nullptr, nullptr, nullptr,
+                                        true /* disallow_trivial_move */));
+  ASSERT_EQ("0,1", FilesPerLevel());
+  props = get_properties();
+  ASSERT_EQ(0U, props->user_collected_properties.count(
+                    CuckooTablePropertyNames::kEmptyKey));
+  ASSERT_GT(props->num_data_blocks, 10U);
+
+  ASSERT_OK(dbfull()->TEST_CompactRange(1, nullptr, nullptr, nullptr,
+                                        true /* disallow_trivial_move */));
+  ASSERT_EQ("0,0,1", FilesPerLevel());
+  ASSERT_EQ(1U, get_properties()->num_data_blocks);
+  // Levels past the end of the vector use its last factory
+  ASSERT_OK(dbfull()->TEST_CompactRange(2, nullptr, nullptr, nullptr,
+                                        true /* disallow_trivial_move */));
+  ASSERT_EQ("0,0,0,1", FilesPerLevel());
+  ASSERT_EQ(1U, get_properties()->num_data_blocks);
+
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(std::string(100, 'a' + i % 26), Get(Key(i)));
+  }
+}
+
+TEST_F(CuckooTableDBTest, AdaptiveTableSanitizeOptions) {
+  Options options = CurrentOptions();
+  options.prefix_extractor.reset();
+  BlockBasedTableOptions hash_index;
+  hash_index.index_type = BlockBasedTableOptions::kHashSearch;
+  std::shared_ptr<TableFactory> hash_index_factory(
+      NewBlockBasedTableFactory(hash_index));
+  // The hash index needs a prefix extractor, whether its factory writes
+  // every level or only some of them
+  options.table_factory.reset(NewAdaptiveTableFactory(hash_index_factory));
+  ASSERT_TRUE(options.table_factory
+                  ->SanitizeOptions(DBOptions(options),
+                                    ColumnFamilyOptions(options))
+                  .IsInvalidArgument());
+  options.table_factory.reset(NewAdaptiveTableFactory(
+      nullptr, nullptr, nullptr, nullptr,
+      {std::shared_ptr<TableFactory>(NewCuckooTableFactory()),
+       hash_index_factory}));
+  ASSERT_TRUE(options.table_factory
+                  ->SanitizeOptions(DBOptions(options),
+                                    ColumnFamilyOptions(options))
+                  .IsInvalidArgument());
+  options.table_factory.reset(NewAdaptiveTableFactory());
+  ASSERT_OK(options.table_factory->SanitizeOptions(
+      DBOptions(options), ColumnFamilyOptions(options)));
+}
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -10,6 +10,9 @@
 #include "cache/lru_cache.h"
 #include "db/db_test_util.h"
 #include "port/stack_trace.h"
+#include "rocksdb/trace_reader_writer.h"
+#include "util/block_cache_tracer.h"
+#include "utilities/simulator_cache/cache_simulator.h"
 
 namespace rocksdb {
 
@@ -225,6 +228,126 @@ TEST_F(DBBlockCacheTest, TestWithCompressedBlockCache) {
 }
 #endif  // SNAPPY
 
+namespace {
+// Counts the blocks of a pooled allocator that are not freed
+class CountingMemoryAllocator : public MemoryAllocator {
+ public:
+  CountingMemoryAllocator()
+      : base_(NewPooledMemoryAllocator()), allocations_(0), live_(0) {}
+
+  const char* Name() const override { return "CountingMemoryAllocator"; }
+
+  void* Allocate(size_t size) override {
+    allocations_++;
+    live_++;
+    return base_->Allocate(size);
+  }
+
+  void Deallocate(void* p) override {
+    live_--;
+    base_->Deallocate(p);
+  }
+
+  size_t UsableSize(void* p, size_t allocation_size) const override {
+    return base_->UsableSize(p, allocation_size);
+  }
+
+  int allocations() const { return allocations_; }
+  int live() const { return live_; }
+
+ private:
+  std::shared_ptr<MemoryAllocator> base_;
+  std::atomic<int> allocations_;
+  std::atomic<int> live_;
+};
+}  // anonymous namespace
+
+TEST_F(DBBlockCacheTest, MemoryAllocator) {
+  auto allocator = std::make_shared<CountingMemoryAllocator>();
+  std::shared_ptr<Cache> cache =
+      NewLRUCache(1 << 20, 0 /* num_shard_bits */,
+                  false /* strict_capacity_limit */,
+                  0.0 /* high_pri_pool_ratio */, allocator);
+  ASSERT_EQ(allocator.get(), cache->memory_allocator());
+  auto table_options = GetTableOptions();
+  table_options.block_cache = cache;
+  auto options = GetOptions(table_options);
+  options.compression =
+      Snappy_Supported() ? kSnappyCompression : kNoCompression;
+  DestroyAndReopen(options);
+
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Put(Key(i), std::string(1000, static_cast<char>('a' + i % 26))));
+  }
+  ASSERT_OK(Flush());
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(std::string(1000, static_cast<char>('a' + i % 26)), Get(Key(i)));
+  }
+  // Each data block came from the allocator and stays in the cache
+  ASSERT_EQ(100, allocator->allocations());
+  ASSERT_EQ(100, allocator->live());
+  ASSERT_LE(100 * 1000, cache->GetUsage());
+
+  // Blocks that do not go to the cache come from the allocator as well, and
+  // are freed with the iterator
+  for (int i = 100; i < 200; i++) {
+    ASSERT_OK(Put(Key(i), std::string(1000, 'x')));
+  }
+  ASSERT_OK(Flush());
+  ReadOptions read_options;
+  read_options.fill_cache = false;
+  std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+  int count = 0;
+  for (iter->Seek(Key(100)); iter->Valid(); iter->Next()) {
+    count++;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(100, count);
+  iter.reset();
+  ASSERT_EQ(200, allocator->allocations());
+  ASSERT_EQ(100, allocator->live());
+
+  Close();
+  cache->EraseUnRefEntries();
+  ASSERT_EQ(0, allocator->live());
+}
+
+TEST_F(DBBlockCacheTest, CompressedTier) {
+  CompressedTierOptions tier_options;
+  tier_options.compression_type =
+      LZ4_Supported() ? kLZ4Compression
+                      : (Snappy_Supported() ? kSnappyCompression
+                                            : kNoCompression);
+  tier_options.adaptive = false;
+  tier_options.initial_ratio = 0.5;
+  // Each tier holds more than half of the blocks
+  std::shared_ptr<Cache> cache =
+      NewCompressedTieredCache(160 << 10, tier_options, 0 /* num_shard_bits */);
+  auto table_options = GetTableOptions();
+  table_options.block_cache = cache;
+  auto options = GetOptions(table_options);
+  DestroyAndReopen(options);
+
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Put(Key(i), std::string(1000, static_cast<char>('a' + i % 26))));
+  }
+  ASSERT_OK(Flush());
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(std::string(1000, static_cast<char>('a' + i % 26)), Get(Key(i)));
+  }
+  ASSERT_EQ(100, TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS));
+  ASSERT_EQ(0, TestGetTickerCount(options, BLOCK_CACHE_COMPRESSED_TIER_HIT));
+
+  // The blocks evicted by the first pass come back from the compressed tier
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(std::string(1000, static_cast<char>('a' + i % 26)), Get(Key(i)));
+  }
+  ASSERT_EQ(100, TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS));
+  ASSERT_LT(0, TestGetTickerCount(options, BLOCK_CACHE_COMPRESSED_TIER_HIT));
+  ASSERT_EQ(100, TestGetTickerCount(options, BLOCK_CACHE_DATA_HIT));
+  ASSERT_LE(cache->GetUsage(), cache->GetCapacity());
+}
+
 #ifndef ROCKSDB_LITE
 
 // Make sure that when options.block_cache is set, after a new table is
@@ -568,6 +691,91 @@ TEST_F(DBBlockCacheTest, CompressedCache) {
   }
 }
 
+TEST_F(DBBlockCacheTest, BlockCacheTrace) {
+  auto table_options = GetTableOptions();
+  table_options.block_cache = NewLRUCache(1 << 20, 0 /* num_shard_bits */);
+  table_options.cache_index_and_filter_blocks = true;
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10));
+  auto options = GetOptions(table_options);
+  DestroyAndReopen(options);
+  InitTable(options);
+  ASSERT_OK(Flush());
+
+  ASSERT_TRUE(db_->EndBlockCacheTrace().IsNotFound());
+  std::string trace_filename = dbname_ + "/block_cache.trace";
+  std::unique_ptr<TraceWriter> trace_writer;
+  ASSERT_OK(
+      NewFileTraceWriter(env_, EnvOptions(), trace_filename, &trace_writer));
+  ASSERT_OK(
+      db_->StartBlockCacheTrace(TraceOptions(), std::move(trace_writer)));
+  ASSERT_TRUE(db_->StartBlockCacheTrace(TraceOptions(), nullptr).IsBusy());
+
+  // Each key has its own data block, which misses on the first Get
+  for (int pass = 0; pass < 2; pass++) {
+    for (size_t i = 0; i < kNumBlocks; i++) {
+      ASSERT_NE("NOT_FOUND", Get(ToString(i)));
+    }
+  }
+  {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    size_t count = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      count++;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(kNumBlocks, count);
+  }
+  ASSERT_OK(db_->EndBlockCacheTrace());
+
+  std::unique_ptr<TraceReader> trace_reader;
+  ASSERT_OK(
+      NewFileTraceReader(env_, EnvOptions(), trace_filename, &trace_reader));
+  BlockCacheTraceReader reader(std::move(trace_reader));
+  ASSERT_OK(reader.ReadHeader());
+  auto simulator = NewMissRatioSimulator("lru", {1 << 20});
+  std::set<std::string> blocks;
+  std::map<std::pair<TraceType, TableReaderCaller>, size_t> accesses;
+  std::map<std::pair<TraceType, TableReaderCaller>, size_t> hits;
+  Status s;
+  while (true) {
+    BlockCacheTraceRecord access;
+    s = reader.ReadAccess(&access);
+    if (!s.ok()) {
+      break;
+    }
+    ASSERT_EQ(0U, access.cf_id);
+    ASSERT_EQ(0, access.level);
+    ASSERT_FALSE(access.no_insert);
+    ASSERT_LT(0U, access.block_size);
+    accesses[std::make_pair(access.block_type, access.caller)]++;
+    if (access.is_cache_hit) {
+      hits[std::make_pair(access.block_type, access.caller)]++;
+    }
+    blocks.insert(access.block_key);
+    simulator->Access(access);
+  }
+  ASSERT_TRUE(s.IsIncomplete()) << s.ToString();
+
+  auto get_data = std::make_pair(kBlockTraceDataBlock, kUserGet);
+  ASSERT_EQ(2 * kNumBlocks, accesses[get_data]);
+  ASSERT_EQ(kNumBlocks, hits[get_data]);
+  auto get_index = std::make_pair(kBlockTraceIndexBlock, kUserGet);
+  ASSERT_EQ(2 * kNumBlocks, accesses[get_index]);
+  ASSERT_EQ(2 * kNumBlocks, hits[get_index]);
+  auto get_filter = std::make_pair(kBlockTraceFilterBlock, kUserGet);
+  ASSERT_EQ(2 * kNumBlocks, accesses[get_filter]);
+  ASSERT_EQ(2 * kNumBlocks, hits[get_filter]);
+  auto iterator_data = std::make_pair(kBlockTraceDataBlock, kUserIterator);
+  ASSERT_EQ(kNumBlocks, accesses[iterator_data]);
+  ASSERT_EQ(kNumBlocks, hits[iterator_data]);
+  ASSERT_LT(0U,
+            accesses[std::make_pair(kBlockTraceIndexBlock, kUserIterator)]);
+  // The data blocks, the index block and the filter block
+  ASSERT_EQ(kNumBlocks + 2, blocks.size());
+  // A simulated cache that holds all of them only misses on each block once
+  ASSERT_EQ(blocks.size(), simulator->num_misses(0));
+}
+
 #endif  // ROCKSDB_LITE
 
 }  // namespace rocksdb
@@ -422,6 +422,60 @@ TEST_F(DBBloomFilterTest, BloomFilterRate) {
   }
 }
 
+TEST_F(DBBloomFilterTest, XorFilter) {
+  for (bool partition_filters : {false, true}) {
+    Options options = CurrentOptions();
+    options.statistics = rocksdb::CreateDBStatistics();
+    BlockBasedTableOptions table_options;
+    // Files written to L0 get a real filter, L1 and below none at all
+    table_options.filter_policy.reset(NewXorFilterPolicy(10, {10, 0}));
+    if (partition_filters) {
+      table_options.partition_filters = true;
+      table_options.index_type =
+          BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch;
+      table_options.metadata_block_size = 512;
+    }
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    DestroyAndReopen(options);
+
+    const int maxKey = 10000;
+    for (int i = 0; i < maxKey; i++) {
+      ASSERT_OK(Put(Key(i), Key(i)));
+    }
+    ASSERT_OK(Put(Key(maxKey + 55555), Key(maxKey + 55555)));
+    Flush();
+
+    for (int i = 0; i < maxKey; i++) {
+      ASSERT_EQ(Key(i), Get(Key(i)));
+    }
+    ASSERT_EQ(TestGetTickerCount(options, BLOOM_FILTER_USEFUL), 0);
+    ASSERT_EQ(TestGetTickerCount(options, BLOOM_FILTER_FULL_POSITIVE),
+              maxKey);
+    ASSERT_EQ(TestGetTickerCount(options, BLOOM_FILTER_FULL_TRUE_POSITIVE),
+              maxKey);
+
+    for (int i = 0; i < maxKey; i++) {
+      ASSERT_EQ("NOT_FOUND", Get(Key(i + 33333)));
+    }
+    uint64_t useful = TestGetTickerCount(options, BLOOM_FILTER_USEFUL);
+    ASSERT_GE(useful, maxKey * 0.99);
+    ASSERT_EQ(TestGetTickerCount(options, BLOOM_FILTER_FULL_POSITIVE),
+              maxKey + (maxKey - useful));
+    ASSERT_EQ(TestGetTickerCount(options, BLOOM_FILTER_FULL_TRUE_POSITIVE),
+              maxKey);
+
+    // Rewrite the data into L1, where the policy builds no filter
+    ASSERT_OK(dbfull()->TEST_CompactRange(0, nullptr, nullptr, nullptr,
+                                          true /* disallow_trivial_move */));
+    ASSERT_EQ(0, NumTableFilesAtLevel(0));
+    ASSERT_GT(NumTableFilesAtLevel(1), 0);
+    for (int i = 0; i < maxKey; i++) {
+      ASSERT_EQ("NOT_FOUND", Get(Key(i + 33333)));
+    }
+    ASSERT_EQ(TestGetTickerCount(options, BLOOM_FILTER_USEFUL), useful);
+  }
+}
+
 TEST_F(DBBloomFilterTest, BloomFilterCompatibility) {
   Options options = CurrentOptions();
   options.statistics = rocksdb::CreateDBStatistics();
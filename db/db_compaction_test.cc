@@ -349,6 +349,60 @@ TEST_F(DBCompactionTest, TestTableReaderForCompaction) {
   rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
 }
 
+TEST_F(DBCompactionTest, CompactionReadaheadThreads) {
+  // The readahead of all compactions runs on the threads of the DB's pool
+  std::mutex mu;
+  std::set<std::thread::id> prefetch_threads;
+  int num_prefetches = 0;
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "AsyncReadaheadRandomAccessFile::BGPrefetch", [&](void* /*arg*/) {
+        std::lock_guard<std::mutex> l(mu);
+        prefetch_threads.insert(std::this_thread::get_id());
+        num_prefetches++;
+      });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+
+  for (int num_threads : {0, 2}) {
+    Options options = CurrentOptions();
+    options.env = env_;
+    options.disable_auto_compactions = true;
+    options.compaction_readahead_size = 32 << 10;
+    options.compaction_readahead_threads = num_threads;
+    options.max_subcompactions = 4;
+    DestroyAndReopen(options);
+    prefetch_threads.clear();
+    num_prefetches = 0;
+
+    Random rnd(301);
+    std::vector<std::string> values;
+    for (int i = 0; i < 1000; i++) {
+      values.push_back(RandomString(&rnd, 100));
+    }
+    for (int round = 0; round < 2; round++) {
+      for (int f = 0; f < 4; f++) {
+        for (int i = f; i < 1000; i += 2) {
+          ASSERT_OK(Put(Key(i), values[i]));
+        }
+        ASSERT_OK(Flush());
+      }
+      ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+    }
+    for (int i = 0; i < 1000; i++) {
+      ASSERT_EQ(values[i], Get(Key(i)));
+    }
+
+    if (num_threads == 0) {
+      ASSERT_EQ(0, num_prefetches);
+    } else {
+      ASSERT_GT(num_prefetches, 0);
+    }
+    ASSERT_LE(prefetch_threads.size(), static_cast<size_t>(num_threads));
+  }
+
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 TEST_P(DBCompactionTestWithParam, CompactionDeletionTriggerReopen) {
   for (int tid = 0; tid < 2; ++tid) {
     uint64_t db_size[3];
@@ -2730,6 +2784,64 @@ INSTANTIATE_TEST_CASE_P(DBCompactionTestWithParam, DBCompactionTestWithParam,
                                           std::make_tuple(4, true),
                                           std::make_tuple(4, false)));
 
+class CompactionOrderListener : public EventListener {
+ public:
+  virtual void OnCompactionCompleted(DB* db,
+                                     const CompactionJobInfo& ci) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    column_families_.push_back(ci.cf_name);
+  }
+
+  std::vector<std::string> GetColumnFamilies() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return column_families_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<std::string> column_families_;
+};
+
+TEST_F(DBCompactionTest, UrgentCompactionRunsFirst) {
+  Options options = CurrentOptions();
+  options.max_background_compactions = 1;
+  options.level0_file_num_compaction_trigger = 2;
+  options.level0_slowdown_writes_trigger = 100;
+  options.level0_stop_writes_trigger = 100;
+  CompactionOrderListener* listener = new CompactionOrderListener();
+  options.listeners.emplace_back(listener);
+  env_->SetBackgroundThreads(1, Env::HIGH);
+  env_->SetBackgroundThreads(1, Env::LOW);
+  CreateAndReopenWithCF({"cleanup", "stalling"}, options);
+  // Both column families reach the L0 compaction trigger, but "stalling" is
+  // also two thirds of the way to its L0 slowdown trigger
+  Options stalling_options = options;
+  stalling_options.level0_slowdown_writes_trigger = 3;
+  ReopenWithColumnFamilies({"default", "cleanup", "stalling"},
+                           {options, options, stalling_options});
+
+  test::SleepingBackgroundTask sleeping_task_low;
+  env_->Schedule(&test::SleepingBackgroundTask::DoSleepTask, &sleeping_task_low,
+                 Env::Priority::LOW);
+  // "cleanup" is queued first, and "stalling" waits behind it
+  for (int cf : {1, 2}) {
+    for (int i = 0; i < 2; i++) {
+      ASSERT_OK(Put(cf, "key", ToString(i)));
+      ASSERT_OK(Flush(cf));
+    }
+  }
+  ASSERT_EQ("2", FilesPerLevel(1));
+  ASSERT_EQ("2", FilesPerLevel(2));
+
+  sleeping_task_low.WakeUp();
+  sleeping_task_low.WaitUntilDone();
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  ASSERT_EQ(0, NumTableFilesAtLevel(0, 1));
+  ASSERT_EQ(0, NumTableFilesAtLevel(0, 2));
+  std::vector<std::string> expected = {"stalling", "cleanup"};
+  ASSERT_EQ(expected, listener->GetColumnFamilies());
+}
+
 TEST_P(DBCompactionDirectIOTest, DirectIO) {
   Options options = CurrentOptions();
   Destroy(options);
@@ -58,6 +58,7 @@
 #include "memtable/hash_skiplist_rep.h"
 #include "monitoring/iostats_context_imp.h"
 #include "monitoring/perf_context_imp.h"
+#include "monitoring/stats_history.h"
 #include "monitoring/thread_status_updater.h"
 #include "monitoring/thread_status_util.h"
 #include "options/cf_options.h"
@@ -98,6 +99,8 @@
 #include "util/stop_watch.h"
 #include "util/string_util.h"
 #include "util/sync_point.h"
+#include "util/threadpool_imp.h"
+#include "util/trace_replay.h"
 
 namespace rocksdb {
 const std::string kDefaultColumnFamilyName("default");
@@ -195,7 +198,18 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname)
       refitting_level_(false),
       opened_successfully_(false),
       concurrent_prepare_(options.concurrent_prepare),
-      manual_wal_flush_(options.manual_wal_flush) {
+      manual_wal_flush_(options.manual_wal_flush),
+      tracing_(false),
+      trace_sampling_frequency_(1),
+      trace_request_count_(0),
+      stats_history_size_(0),
+      stats_slice_initialized_(false),
+      last_stats_persist_time_(0),
+      persisted_stats_size_(0),
+      persisted_stats_sizes_loaded_(false),
+      stats_persist_timer_id_(0),
+      stats_persist_generation_(0),
+      persist_stats_cf_handle_(nullptr) {
   env_->GetAbsolutePath(dbname, &db_absolute_path_);
 
   // Reserve ten files or so for other uses and give the rest to TableCache.
@@ -205,10 +219,16 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname)
                                    : mutable_db_options_.max_open_files - 10;
   table_cache_ = NewLRUCache(table_cache_size,
                              immutable_db_options_.table_cache_numshardbits);
+  if (immutable_db_options_.compaction_readahead_size > 0 &&
+      immutable_db_options_.compaction_readahead_threads > 0) {
+    compaction_readahead_pool_.reset(new ThreadPoolImpl());
+    compaction_readahead_pool_->SetBackgroundThreads(
+        immutable_db_options_.compaction_readahead_threads);
+  }
 
   versions_.reset(new VersionSet(dbname_, &immutable_db_options_, env_options_,
                                  table_cache_.get(), write_buffer_manager_,
-                                 &write_controller_));
+                                 &write_controller_, &block_cache_tracer_));
   column_family_memtables_.reset(
       new ColumnFamilyMemTablesImpl(versions_->GetColumnFamilySet()));
 
@@ -254,6 +274,10 @@ void DBImpl::CancelAllBackgroundWork(bool wait) {
 }
 
 DBImpl::~DBImpl() {
+  // Stop the snapshots of the stats history first. This waits for a running
+  // PersistStats().
+  stats_persist_timer_.reset();
+
   // CancelAllBackgroundWork called with false means we just set the shutdown
   // marker. After this we do a variant of the waiting and unschedule work
   // (to consider: moving all the waiting into CancelAllBackgroundWork(true))
@@ -273,6 +297,11 @@ DBImpl::~DBImpl() {
     TEST_SYNC_POINT("DBImpl::~DBImpl:WaitJob");
     bg_cv_.Wait();
   }
+  if (compaction_readahead_pool_ != nullptr) {
+    // The compactions have closed their input files, so none of them has a
+    // prefetch queued or running.
+    compaction_readahead_pool_->JoinAllThreads();
+  }
   EraseThreadStatusDbInfo();
   flush_scheduler_.Clear();
 
@@ -289,10 +318,11 @@ DBImpl::~DBImpl() {
     }
   }
 
-  if (default_cf_handle_ != nullptr) {
+  if (default_cf_handle_ != nullptr || persist_stats_cf_handle_ != nullptr) {
     // we need to delete handle outside of lock because it does its own locking
     mutex_.Unlock();
     delete default_cf_handle_;
+    delete persist_stats_cf_handle_;
     mutex_.Lock();
   }
 
@@ -447,6 +477,279 @@ void DBImpl::MaybeDumpStats() {
   }
 }
 
+void DBImpl::GetTickerValues(std::map<std::string, uint64_t>* tickers) {
+  Statistics* statistics = immutable_db_options_.statistics.get();
+  if (statistics == nullptr) {
+    return;
+  }
+  for (const auto& ticker : TickersNameMap) {
+    (*tickers)[ticker.second] = statistics->getTickerCount(ticker.first);
+  }
+}
+
+Status DBImpl::LoadPersistedStatsSizes(std::map<uint64_t, size_t>* sizes) {
+  std::unique_ptr<Iterator> iter(
+      NewIterator(ReadOptions(), persist_stats_cf_handle_));
+  uint64_t time;
+  std::string name;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    if (DecodePersistentStatsKey(iter->key(), &time, &name)) {
+      (*sizes)[time] += iter->key().size() + iter->value().size();
+    }
+  }
+  return iter->status();
+}
+
+void DBImpl::PersistStats() {
+  TEST_SYNC_POINT("DBImpl::PersistStats:Start");
+  if (shutting_down_.load(std::memory_order_acquire)) {
+    return;
+  }
+  std::map<std::string, uint64_t> tickers;
+  GetTickerValues(&tickers);
+
+  // The properties are read before stats_history_mutex_ is locked, since they
+  // lock mutex_
+  std::map<std::string, uint64_t> stats;
+  const std::string* aggregated_properties[] = {
+      &DB::Properties::kCurSizeAllMemTables, &DB::Properties::kEstimateNumKeys,
+      &DB::Properties::kTotalSstFilesSize,
+      &DB::Properties::kEstimatePendingCompactionBytes};
+  const std::string* db_properties[] = {
+      &DB::Properties::kNumRunningFlushes,
+      &DB::Properties::kNumRunningCompactions,
+      &DB::Properties::kActualDelayedWriteRate,
+      &DB::Properties::kIsWriteStopped};
+  uint64_t value;
+  for (const std::string* property : aggregated_properties) {
+    if (GetAggregatedIntProperty(*property, &value)) {
+      stats[*property] = value;
+    }
+  }
+  for (const std::string* property : db_properties) {
+    if (GetIntProperty(default_cf_handle_, *property, &value)) {
+      stats[*property] = value;
+    }
+  }
+  size_t stats_history_buffer_size;
+  {
+    InstrumentedMutexLock l(&mutex_);
+    stats_history_buffer_size = mutable_db_options_.stats_history_buffer_size;
+  }
+
+  const uint64_t now_seconds = env_->NowMicros() / (1000 * 1000);
+  const bool persist_to_disk = immutable_db_options_.persist_stats_to_disk &&
+                               persist_stats_cf_handle_ != nullptr;
+  std::map<uint64_t, size_t> loaded_sizes;
+  bool load_sizes = false;
+  if (persist_to_disk) {
+    {
+      InstrumentedMutexLock l(&stats_history_mutex_);
+      load_sizes = !persisted_stats_sizes_loaded_;
+    }
+    // The column family is read without stats_history_mutex_, since reading
+    // may lock mutex_
+    if (load_sizes) {
+      Status s = LoadPersistedStatsSizes(&loaded_sizes);
+      if (!s.ok()) {
+        ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                       "Unable to read the stats history: %s",
+                       s.ToString().c_str());
+        return;
+      }
+    }
+  }
+  WriteBatch batch;
+  size_t batch_stats_size = 0;
+  {
+    InstrumentedMutexLock l(&stats_history_mutex_);
+    // Snapshots are kept by the second. The changes of the tickers within the
+    // second of the previous snapshot go to the next one.
+    if (stats_slice_initialized_ && now_seconds <= last_stats_persist_time_) {
+      return;
+    }
+    for (const auto& ticker : tickers) {
+      uint64_t& last_value = stats_slice_[ticker.first];
+      // The ticker went back if the statistics were reset
+      uint64_t delta = ticker.second >= last_value
+                           ? ticker.second - last_value
+                           : ticker.second;
+      if (delta > 0) {
+        stats[ticker.first] = delta;
+      }
+      last_value = ticker.second;
+    }
+    stats_slice_initialized_ = true;
+    last_stats_persist_time_ = now_seconds;
+
+    if (!persist_to_disk) {
+      stats_history_size_ += EstimateStatsSnapshotSize(stats);
+      stats_history_[now_seconds] = stats;
+      while (stats_history_size_ > stats_history_buffer_size &&
+             !stats_history_.empty()) {
+        stats_history_size_ -=
+            EstimateStatsSnapshotSize(stats_history_.begin()->second);
+        stats_history_.erase(stats_history_.begin());
+      }
+    } else {
+      if (load_sizes && !persisted_stats_sizes_loaded_) {
+        persisted_stats_sizes_ = std::move(loaded_sizes);
+        persisted_stats_size_ = 0;
+        for (const auto& snapshot : persisted_stats_sizes_) {
+          persisted_stats_size_ += snapshot.second;
+        }
+        persisted_stats_sizes_loaded_ = true;
+      }
+      for (const auto& stat : stats) {
+        std::string stat_key =
+            EncodePersistentStatsKey(now_seconds, stat.first);
+        std::string stat_value = ToString(stat.second);
+        batch_stats_size += stat_key.size() + stat_value.size();
+        batch.Put(persist_stats_cf_handle_, stat_key, stat_value);
+      }
+      persisted_stats_sizes_[now_seconds] += batch_stats_size;
+      persisted_stats_size_ += batch_stats_size;
+      // The oldest snapshots are deleted with a range deletion of all the
+      // keys before the oldest snapshot left
+      uint64_t trimmed_time = 0;
+      while (persisted_stats_size_ > stats_history_buffer_size &&
+             !persisted_stats_sizes_.empty()) {
+        persisted_stats_size_ -= persisted_stats_sizes_.begin()->second;
+        trimmed_time = persisted_stats_sizes_.begin()->first + 1;
+        persisted_stats_sizes_.erase(persisted_stats_sizes_.begin());
+      }
+      if (trimmed_time > 0) {
+        batch.DeleteRange(persist_stats_cf_handle_,
+                          EncodePersistentStatsKey(0, ""),
+                          EncodePersistentStatsKey(trimmed_time, ""));
+      }
+    }
+  }
+
+  if (persist_to_disk) {
+    // The stats are written by the timer thread, which must not wait for a
+    // write stall. A snapshot that would wait is dropped instead.
+    WriteOptions write_options;
+    write_options.no_slowdown = true;
+    Status s = WriteImpl(write_options, &batch, nullptr, nullptr, 0, false,
+                         nullptr, true /* internal_write */);
+    if (!s.ok()) {
+      ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                     "Unable to persist the stats history: %s",
+                     s.ToString().c_str());
+      InstrumentedMutexLock l(&stats_history_mutex_);
+      auto iter = persisted_stats_sizes_.find(now_seconds);
+      if (iter != persisted_stats_sizes_.end() &&
+          iter->second >= batch_stats_size) {
+        iter->second -= batch_stats_size;
+        persisted_stats_size_ -= batch_stats_size;
+        if (iter->second == 0) {
+          persisted_stats_sizes_.erase(iter);
+        }
+      }
+    }
+  }
+}
+
+void DBImpl::ScheduleStatsPersist() {
+  mutex_.AssertHeld();
+  stats_persist_generation_++;
+  if (stats_persist_timer_id_ != 0) {
+    stats_persist_timer_->cancel(stats_persist_timer_id_);
+    stats_persist_timer_id_ = 0;
+  }
+  const unsigned int period_sec = mutable_db_options_.stats_persist_period_sec;
+  if (period_sec == 0) {
+    return;
+  }
+  {
+    // The first snapshot holds the changes since the timer started
+    InstrumentedMutexLock l(&stats_history_mutex_);
+    if (!stats_slice_initialized_) {
+      GetTickerValues(&stats_slice_);
+      stats_slice_initialized_ = true;
+      last_stats_persist_time_ = env_->NowMicros() / (1000 * 1000);
+    }
+  }
+  if (stats_persist_timer_ == nullptr) {
+    stats_persist_timer_.reset(new TimerQueue());
+  }
+  const uint64_t generation = stats_persist_generation_;
+  stats_persist_timer_id_ = stats_persist_timer_->add(
+      static_cast<int64_t>(period_sec) * 1000,
+      [this, generation](bool aborted) -> std::pair<bool, int64_t> {
+        if (aborted) {
+          return std::make_pair(false, int64_t{0});
+        }
+        {
+          InstrumentedMutexLock l(&mutex_);
+          if (generation != stats_persist_generation_) {
+            return std::make_pair(false, int64_t{0});
+          }
+        }
+        PersistStats();
+        // Keep the period
+        return std::make_pair(true, int64_t{-1});
+      });
+}
+
+Status DBImpl::GetStatsHistory(
+    uint64_t start_time, uint64_t end_time,
+    std::unique_ptr<StatsHistoryIterator>* stats_iterator) {
+  if (stats_iterator == nullptr) {
+    return Status::InvalidArgument("stats_iterator must not be nullptr");
+  }
+  if (!immutable_db_options_.persist_stats_to_disk) {
+    stats_iterator->reset(
+        new InMemoryStatsHistoryIterator(start_time, end_time, this));
+    return Status::OK();
+  }
+  if (persist_stats_cf_handle_ == nullptr) {
+    return Status::NotSupported(
+        "The column family of the stats history is not open");
+  }
+  stats_iterator->reset(new PersistentStatsHistoryIterator(
+      start_time, end_time,
+      NewIterator(ReadOptions(), persist_stats_cf_handle_)));
+  return Status::OK();
+}
+
+bool DBImpl::FindStatsByTime(uint64_t start_time, uint64_t end_time,
+                             uint64_t* new_time,
+                             std::map<std::string, uint64_t>* stats_map) {
+  InstrumentedMutexLock l(&stats_history_mutex_);
+  auto iter = stats_history_.lower_bound(start_time);
+  if (iter == stats_history_.end() || iter->first >= end_time) {
+    return false;
+  }
+  *new_time = iter->first;
+  *stats_map = iter->second;
+  return true;
+}
+
+Status DBImpl::InitPersistStatsColumnFamily() {
+  mutex_.AssertHeld();
+  if (!immutable_db_options_.persist_stats_to_disk) {
+    return Status::OK();
+  }
+  assert(persist_stats_cf_handle_ == nullptr);
+  auto cfd = versions_->GetColumnFamilySet()->GetColumnFamily(
+      kPersistentStatsColumnFamilyName);
+  if (cfd != nullptr) {
+    persist_stats_cf_handle_ = new ColumnFamilyHandleImpl(cfd, this, &mutex_);
+    return Status::OK();
+  }
+  ColumnFamilyHandle* handle = nullptr;
+  mutex_.Unlock();
+  Status s = CreateColumnFamily(PersistentStatsColumnFamilyOptions(),
+                                kPersistentStatsColumnFamilyName, &handle);
+  mutex_.Lock();
+  if (s.ok()) {
+    persist_stats_cf_handle_ = static_cast<ColumnFamilyHandleImpl*>(handle);
+  }
+  return s;
+}
+
 void DBImpl::ScheduleBgLogWriterClose(JobContext* job_context) {
   if (!job_context->logs_to_free.empty()) {
     for (auto l : job_context->logs_to_free) {
@@ -561,7 +864,13 @@ Status DBImpl::SetDBOptions(
                                           ? TableCache::kInfiniteCapacity
                                           : new_options.max_open_files - 10);
 
+      const bool stats_persist_period_changed =
+          new_options.stats_persist_period_sec !=
+          mutable_db_options_.stats_persist_period_sec;
       mutable_db_options_ = new_options;
+      if (stats_persist_period_changed) {
+        ScheduleStatsPersist();
+      }
 
       write_thread_.EnterUnbatched(&w, &mutex_);
       if (total_log_size_ > GetMaxTotalWalSize()) {
@@ -860,10 +1169,16 @@ InternalIterator* DBImpl::NewInternalIterator(
   assert(arena != nullptr);
   assert(range_del_agg != nullptr);
   // Need to create internal iterator from the arena.
+  // With an upper bound, a table's range filter may invalidate a child on
+  // Seek() even though it has keys past the bound. The prefix seek mode
+  // switches direction with SeekForPrev(), which does not rely on Seek()
+  // having found everything >= the key.
   MergeIteratorBuilder merge_iter_builder(
       &cfd->internal_comparator(), arena,
-      !read_options.total_order_seek &&
-          cfd->ioptions()->prefix_extractor != nullptr);
+      (!read_options.total_order_seek &&
+       cfd->ioptions()->prefix_extractor != nullptr) ||
+          (read_options.iterate_upper_bound != nullptr &&
+           TableFactoryUsesRangeFilter(cfd->ioptions()->table_factory)));
   // Collect iterator for mutable mem
   merge_iter_builder.AddIterator(
       super_version->mem->NewIterator(read_options, arena));
@@ -906,6 +1221,12 @@ ColumnFamilyHandle* DBImpl::DefaultColumnFamily() const {
 Status DBImpl::Get(const ReadOptions& read_options,
                    ColumnFamilyHandle* column_family, const Slice& key,
                    PinnableSlice* value) {
+  if (ShouldTrace()) {
+    InstrumentedMutexLock lock(&trace_mutex_);
+    if (tracer_) {
+      tracer_->Get(column_family->GetID(), key);
+    }
+  }
   return GetImpl(read_options, column_family, key, value);
 }
 
@@ -918,6 +1239,7 @@ Status DBImpl::GetImpl(const ReadOptions& read_options,
 
   auto cfh = reinterpret_cast<ColumnFamilyHandleImpl*>(column_family);
   auto cfd = cfh->cfd();
+  cfd->key_range_hotness()->SampleRead(key);
 
   // Acquire SuperVersion
   SuperVersion* sv = GetAndRefSuperVersion(cfd);
@@ -1059,6 +1381,7 @@ std::vector<Status> DBImpl::MultiGet(
 
     LookupKey lkey(keys[i], snapshot);
     auto cfh = reinterpret_cast<ColumnFamilyHandleImpl*>(column_family[i]);
+    cfh->cfd()->key_range_hotness()->SampleRead(keys[i]);
     RangeDelAggregator range_del_agg(cfh->cfd()->internal_comparator(),
                                      snapshot);
     auto mgd_iter = multiget_cf_data.find(cfh->cfd()->GetID());
@@ -1474,6 +1797,8 @@ Iterator* DBImpl::NewIterator(const ReadOptions& read_options,
         sv->mutable_cf_options.max_sequential_skip_in_iterations,
         sv->version_number,
         ((read_options.snapshot != nullptr) ? nullptr : this), cfd);
+    db_iter->StoreTraceInfo(this, cfd->GetID());
+    db_iter->StoreKeyRangeHotness(cfd->key_range_hotness());
 
     InternalIterator* internal_iter =
         NewInternalIterator(read_options, cfd, sv, db_iter->GetArena(),
@@ -1546,6 +1871,8 @@ Status DBImpl::NewIterators(
           sv->mutable_cf_options.max_sequential_skip_in_iterations,
           sv->version_number,
           ((read_options.snapshot != nullptr) ? nullptr : this), cfd);
+      db_iter->StoreTraceInfo(this, cfd->GetID());
+      db_iter->StoreKeyRangeHotness(cfd->key_range_hotness());
       InternalIterator* internal_iter =
           NewInternalIterator(read_options, cfd, sv, db_iter->GetArena(),
                               db_iter->GetRangeDelAggregator());
@@ -1773,7 +2100,10 @@ bool DBImpl::GetAggregatedIntProperty(const Slice& property,
     InstrumentedMutexLock l(&mutex_);
     uint64_t value;
     for (auto* cfd : *versions_->GetColumnFamilySet()) {
-      if (!cfd->initialized()) {
+      // The hidden column family of the stats history is left out
+      if (!cfd->initialized() ||
+          (persist_stats_cf_handle_ != nullptr &&
+           cfd == persist_stats_cf_handle_->cfd())) {
         continue;
       }
       if (GetIntPropertyInternal(cfd, *property_info, true, &value)) {
@@ -2202,6 +2532,74 @@ Status DBImpl::GetDbIdentity(std::string& identity) const {
   return s;
 }
 
+Status DBImpl::StartTrace(const TraceOptions& trace_options,
+                          std::unique_ptr<TraceWriter>&& trace_writer) {
+  InstrumentedMutexLock lock(&trace_mutex_);
+  if (tracer_) {
+    return Status::Busy("A trace is already running");
+  }
+  tracer_.reset(new Tracer(env_, trace_options, std::move(trace_writer)));
+  trace_sampling_frequency_.store(trace_options.sampling_frequency,
+                                  std::memory_order_relaxed);
+  trace_request_count_.store(0, std::memory_order_relaxed);
+  tracing_.store(true, std::memory_order_relaxed);
+  return Status::OK();
+}
+
+Status DBImpl::EndTrace() {
+  InstrumentedMutexLock lock(&trace_mutex_);
+  if (!tracer_) {
+    return Status::NotFound("No trace running");
+  }
+  tracing_.store(false, std::memory_order_relaxed);
+  Status s = tracer_->Close();
+  tracer_.reset();
+  return s;
+}
+
+bool DBImpl::ShouldTrace() {
+  if (!tracing_.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  const uint64_t sampling_frequency =
+      trace_sampling_frequency_.load(std::memory_order_relaxed);
+  if (sampling_frequency <= 1) {
+    return true;
+  }
+  // Records the sampling_frequency-th, 2*sampling_frequency-th, ... operation
+  return (trace_request_count_.fetch_add(1, std::memory_order_relaxed) + 1) %
+             sampling_frequency ==
+         0;
+}
+
+void DBImpl::TraceIteratorSeek(uint32_t column_family_id, const Slice& key) {
+  if (ShouldTrace()) {
+    InstrumentedMutexLock lock(&trace_mutex_);
+    if (tracer_) {
+      tracer_->IteratorSeek(column_family_id, key);
+    }
+  }
+}
+
+void DBImpl::TraceIteratorSeekForPrev(uint32_t column_family_id,
+                                      const Slice& key) {
+  if (ShouldTrace()) {
+    InstrumentedMutexLock lock(&trace_mutex_);
+    if (tracer_) {
+      tracer_->IteratorSeekForPrev(column_family_id, key);
+    }
+  }
+}
+
+Status DBImpl::StartBlockCacheTrace(
+    const TraceOptions& trace_options,
+    std::unique_ptr<TraceWriter>&& trace_writer) {
+  return block_cache_tracer_.StartTrace(env_, trace_options,
+                                        std::move(trace_writer));
+}
+
+Status DBImpl::EndBlockCacheTrace() { return block_cache_tracer_.EndTrace(); }
+
 // Default implementation -- returns not supported status
 Status DB::CreateColumnFamily(const ColumnFamilyOptions& cf_options,
                               const std::string& column_family_name,
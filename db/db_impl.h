@@ -45,20 +45,24 @@
 #include "rocksdb/write_buffer_manager.h"
 #include "table/scoped_arena_iterator.h"
 #include "util/autovector.h"
+#include "util/block_cache_tracer.h"
 #include "util/event_logger.h"
 #include "util/hash.h"
 #include "util/stop_watch.h"
 #include "util/thread_local.h"
+#include "util/timer_queue.h"
 
 namespace rocksdb {
 
 class MemTable;
 class TableCache;
+class ThreadPoolImpl;
 class Version;
 class VersionEdit;
 class VersionSet;
 class Arena;
 class WriteCallback;
+class Tracer;
 struct JobContext;
 struct ExternalSstFileInfo;
 struct MemTableInfo;
@@ -309,6 +313,37 @@ class DBImpl : public DB {
 
   virtual Status GetDbIdentity(std::string& identity) const override;
 
+  virtual Status StartTrace(
+      const TraceOptions& options,
+      std::unique_ptr<TraceWriter>&& trace_writer) override;
+
+  virtual Status EndTrace() override;
+
+  // Record a Seek() or SeekForPrev() of an iterator over the column family
+  // if a trace is running
+  void TraceIteratorSeek(uint32_t column_family_id, const Slice& key);
+  void TraceIteratorSeekForPrev(uint32_t column_family_id, const Slice& key);
+
+  // Returns true if a trace is running and the next operation is sampled
+  bool ShouldTrace();
+
+  virtual Status StartBlockCacheTrace(
+      const TraceOptions& options,
+      std::unique_ptr<TraceWriter>&& trace_writer) override;
+
+  virtual Status EndBlockCacheTrace() override;
+
+  virtual Status GetStatsHistory(
+      uint64_t start_time, uint64_t end_time,
+      std::unique_ptr<StatsHistoryIterator>* stats_iterator) override;
+
+  // Copies into *new_time and *stats_map the earliest snapshot of the
+  // in-memory stats history taken at start_time <= time < end_time. Returns
+  // false if there is none.
+  bool FindStatsByTime(uint64_t start_time, uint64_t end_time,
+                       uint64_t* new_time,
+                       std::map<std::string, uint64_t>* stats_map);
+
   Status RunManualCompaction(ColumnFamilyData* cfd, int input_level,
                              int output_level, uint32_t output_path_id,
                              const Slice* begin, const Slice* end,
@@ -386,6 +421,9 @@ class DBImpl : public DB {
 
   uint64_t TEST_total_log_size() const { return total_log_size_; }
 
+  // Takes a snapshot of the stats history now
+  void TEST_PersistStats();
+
   // Returns column family name to ImmutableCFOptions map.
   Status TEST_GetAllImmutableCFOptions(
       std::unordered_map<std::string, const ImmutableCFOptions*>* iopts_map);
@@ -613,10 +651,13 @@ class DBImpl : public DB {
 
   void EraseThreadStatusDbInfo() const;
 
+  // internal_write is set by the writes of the DB itself, which are not
+  // recorded by a trace
   Status WriteImpl(const WriteOptions& options, WriteBatch* updates,
                    WriteCallback* callback = nullptr,
                    uint64_t* log_used = nullptr, uint64_t log_ref = 0,
-                   bool disable_memtable = false, uint64_t* seq_used = nullptr);
+                   bool disable_memtable = false, uint64_t* seq_used = nullptr,
+                   bool internal_write = false);
 
   Status PipelinedWriteImpl(const WriteOptions& options, WriteBatch* updates,
                             WriteCallback* callback = nullptr,
@@ -825,6 +866,25 @@ class DBImpl : public DB {
   // dump rocksdb.stats to LOG
   void MaybeDumpStats();
 
+  // Takes a snapshot of the tickers and properties into the stats history
+  void PersistStats();
+
+  // Reads the current value of each ticker of the statistics
+  void GetTickerValues(std::map<std::string, uint64_t>* tickers);
+
+  // Reads the size of each snapshot of the persisted stats history
+  Status LoadPersistedStatsSizes(std::map<uint64_t, size_t>* sizes);
+
+  // (Re)starts the timer of PersistStats() with the current
+  // stats_persist_period_sec, or stops it if that is 0.
+  // REQUIRES: mutex_ held
+  void ScheduleStatsPersist();
+
+  // Opens the column family of the stats history if persist_stats_to_disk
+  // is set, creating it if needed.
+  // REQUIRES: mutex_ held
+  Status InitPersistStatsColumnFamily();
+
   // Return the minimum empty level that could hold the total data in the
   // input level. Return the input level, if such level could not be found.
   int FindMinimumEmptyLevelFitting(ColumnFamilyData* cfd,
@@ -838,6 +898,12 @@ class DBImpl : public DB {
   // helper functions for adding and removing from flush & compaction queues
   void AddToCompactionQueue(ColumnFamilyData* cfd);
   ColumnFamilyData* PopFirstFromCompactionQueue();
+  // Moves the column family with the highest CompactionUrgency() to the
+  // front of compaction_queue_, keeping the others in order.
+  void MoveMostUrgentToCompactionQueueFront();
+  // Urgencies of the queued column families that no scheduled compaction
+  // job will pick up yet, most urgent first.
+  std::vector<double> UnscheduledCompactionUrgencies();
   void AddToFlushQueue(ColumnFamilyData* cfd);
   ColumnFamilyData* PopFirstFromFlushQueue();
 
@@ -851,6 +917,10 @@ class DBImpl : public DB {
   // table_cache_ provides its own synchronization
   std::shared_ptr<Cache> table_cache_;
 
+  // Shared by the compactions to read their input files ahead. nullptr if
+  // they read ahead synchronously, or not at all.
+  std::unique_ptr<ThreadPoolImpl> compaction_readahead_pool_;
+
   // Lock over the persistent DB state.  Non-nullptr iff successfully acquired.
   FileLock* db_lock_;
 
@@ -1265,6 +1335,52 @@ class DBImpl : public DB {
   // 2PC these are the writes at Prepare phase.
   const bool concurrent_prepare_;
   const bool manual_wal_flush_;
+
+  // Guards tracer_
+  InstrumentedMutex trace_mutex_;
+  // The trace started by StartTrace(), if any
+  std::unique_ptr<Tracer> tracer_;
+  // Whether tracer_ is set, so that operations skip trace_mutex_ when no
+  // trace is running
+  std::atomic<bool> tracing_;
+  // TraceOptions::sampling_frequency of the running trace and the number of
+  // operations seen since it started. Operations that are not sampled skip
+  // trace_mutex_.
+  std::atomic<uint64_t> trace_sampling_frequency_;
+  std::atomic<uint64_t> trace_request_count_;
+
+  // Records the block cache accesses of the tables of the DB while a trace
+  // started by StartBlockCacheTrace() is running
+  BlockCacheTracer block_cache_tracer_;
+
+  // Guards the stats history below. Never held while locking mutex_.
+  InstrumentedMutex stats_history_mutex_;
+  // The snapshots of the stats history kept in memory, by their time in
+  // seconds
+  std::map<uint64_t, std::map<std::string, uint64_t>> stats_history_;
+  // The EstimateStatsSnapshotSize() of the snapshots in stats_history_
+  size_t stats_history_size_;
+  // The value of each ticker at the last snapshot
+  std::map<std::string, uint64_t> stats_slice_;
+  bool stats_slice_initialized_;
+  // The time of the last snapshot, in seconds
+  uint64_t last_stats_persist_time_;
+  // The size of the keys and values of each snapshot of the persisted
+  // history, by time, and their sum. Read from the column family by the first
+  // PersistStats() that writes to it.
+  std::map<uint64_t, size_t> persisted_stats_sizes_;
+  size_t persisted_stats_size_;
+  bool persisted_stats_sizes_loaded_;
+
+  // Runs PersistStats() every stats_persist_period_sec. Created by the first
+  // ScheduleStatsPersist() with a non-zero period.
+  std::unique_ptr<TimerQueue> stats_persist_timer_;
+  // The timer of PersistStats() and its generation, which tells the
+  // handlers of replaced timers to stop. Guarded by mutex_.
+  uint64_t stats_persist_timer_id_;
+  uint64_t stats_persist_generation_;
+  // The hidden column family of the stats history, if persist_stats_to_disk
+  ColumnFamilyHandleImpl* persist_stats_cf_handle_;
 };
 
 extern Options SanitizeOptions(const std::string& db,
@@ -12,6 +12,8 @@
 #define __STDC_FORMAT_MACROS
 #endif
 #include <inttypes.h>
+#include <algorithm>
+#include <functional>
 
 #include "db/builder.h"
 #include "db/event_helpers.h"
@@ -535,7 +537,8 @@ Status DBImpl::CompactFilesImpl(
       versions_.get(), &shutting_down_, log_buffer, directories_.GetDbDir(),
       directories_.GetDataDir(c->output_path_id()), stats_, &mutex_, &bg_error_,
       snapshot_seqs, earliest_write_conflict_snapshot, table_cache_,
-      &event_logger_, c->mutable_cf_options()->paranoid_file_checks,
+      compaction_readahead_pool_.get(), &event_logger_,
+      c->mutable_cf_options()->paranoid_file_checks,
       c->mutable_cf_options()->report_bg_io_stats, dbname_,
       nullptr);  // Here we pass a nullptr for CompactionJobStats because
                  // CompactFiles does not trigger OnCompactionCompleted(),
@@ -1047,6 +1050,18 @@ void DBImpl::MaybeScheduleFlushOrCompaction() {
     return;
   }
 
+  // Each job is queued in the thread pool with the urgency of the column
+  // family it is expected to pick, so that when several DBs share an Env the
+  // pool runs the compactions most likely to prevent a write stall first.
+  // That urgency is the one at scheduling time: the pool does not update it
+  // while the job waits, but the job picks the column family that is most
+  // urgent when it runs.
+  std::vector<double> urgencies;
+  if (bg_compaction_scheduled_ < bg_job_limits.max_compactions &&
+      unscheduled_compactions_ > 0) {
+    urgencies = UnscheduledCompactionUrgencies();
+  }
+  size_t next_urgency = 0;
   while (bg_compaction_scheduled_ < bg_job_limits.max_compactions &&
          unscheduled_compactions_ > 0) {
     CompactionArg* ca = new CompactionArg;
@@ -1054,11 +1069,32 @@ void DBImpl::MaybeScheduleFlushOrCompaction() {
     ca->prepicked_compaction = nullptr;
     bg_compaction_scheduled_++;
     unscheduled_compactions_--;
-    env_->Schedule(&DBImpl::BGWorkCompaction, ca, Env::Priority::LOW, this,
-                   &DBImpl::UnscheduleCallback);
+    double urgency =
+        next_urgency < urgencies.size() ? urgencies[next_urgency++] : 0;
+    env_->ScheduleWithUrgency(&DBImpl::BGWorkCompaction, ca,
+                              Env::Priority::LOW, this,
+                              &DBImpl::UnscheduleCallback, urgency);
   }
 }
 
+std::vector<double> DBImpl::UnscheduledCompactionUrgencies() {
+  mutex_.AssertHeld();
+  std::vector<double> urgencies;
+  urgencies.reserve(compaction_queue_.size());
+  for (auto* cfd : compaction_queue_) {
+    urgencies.push_back(cfd->CompactionUrgency());
+  }
+  std::sort(urgencies.begin(), urgencies.end(), std::greater<double>());
+  // Jobs already in the thread pool pick the most urgent column families
+  // first when they run.
+  size_t covered = 0;
+  if (urgencies.size() > static_cast<size_t>(unscheduled_compactions_)) {
+    covered = urgencies.size() - unscheduled_compactions_;
+  }
+  urgencies.erase(urgencies.begin(), urgencies.begin() + covered);
+  return urgencies;
+}
+
 DBImpl::BGJobLimits DBImpl::GetBGJobLimits() const {
   mutex_.AssertHeld();
   return GetBGJobLimits(immutable_db_options_.max_background_flushes,
@@ -1097,6 +1133,23 @@ void DBImpl::AddToCompactionQueue(ColumnFamilyData* cfd) {
   cfd->set_pending_compaction(true);
 }
 
+void DBImpl::MoveMostUrgentToCompactionQueueFront() {
+  mutex_.AssertHeld();
+  if (compaction_queue_.size() < 2) {
+    return;
+  }
+  auto most_urgent = compaction_queue_.begin();
+  double max_urgency = (*most_urgent)->CompactionUrgency();
+  for (auto it = std::next(most_urgent); it != compaction_queue_.end(); ++it) {
+    double urgency = (*it)->CompactionUrgency();
+    if (urgency > max_urgency) {
+      max_urgency = urgency;
+      most_urgent = it;
+    }
+  }
+  std::rotate(compaction_queue_.begin(), most_urgent, std::next(most_urgent));
+}
+
 ColumnFamilyData* DBImpl::PopFirstFromCompactionQueue() {
   assert(!compaction_queue_.empty());
   auto cfd = *compaction_queue_.begin();
@@ -1488,6 +1541,7 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
                : m->manual_end->DebugString().c_str()));
     }
   } else if (!is_prepicked && !compaction_queue_.empty()) {
+    MoveMostUrgentToCompactionQueueFront();
     if (HaveManualCompaction(compaction_queue_.front())) {
       // Can't compact right now, but try again later
       TEST_SYNC_POINT("DBImpl::BackgroundCompaction()::Conflict");
@@ -1676,7 +1730,7 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
         versions_.get(), &shutting_down_, log_buffer, directories_.GetDbDir(),
         directories_.GetDataDir(c->output_path_id()), stats_, &mutex_,
         &bg_error_, snapshot_seqs, earliest_write_conflict_snapshot,
-        table_cache_, &event_logger_,
+        table_cache_, compaction_readahead_pool_.get(), &event_logger_,
         c->mutable_cf_options()->paranoid_file_checks,
         c->mutable_cf_options()->report_bg_io_stats, dbname_,
         &compaction_job_stats);
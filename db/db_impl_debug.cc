@@ -145,6 +145,8 @@ size_t DBImpl::TEST_LogsToFreeSize() {
   return logs_to_free_.size();
 }
 
+void DBImpl::TEST_PersistStats() { PersistStats(); }
+
 uint64_t DBImpl::TEST_LogfileNumber() {
   InstrumentedMutexLock l(&mutex_);
   return logfile_number_;
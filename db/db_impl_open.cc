@@ -1025,6 +1025,9 @@ Status DB::Open(const DBOptions& db_options, const std::string& dbname,
           }
         }
       }
+      if (s.ok()) {
+        s = impl->InitPersistStatsColumnFamily();
+      }
     }
     if (s.ok()) {
       for (auto cfd : *impl->versions_->GetColumnFamilySet()) {
@@ -1083,6 +1086,7 @@ Status DB::Open(const DBOptions& db_options, const std::string& dbname,
     *dbptr = impl;
     impl->opened_successfully_ = true;
     impl->MaybeScheduleFlushOrCompaction();
+    impl->ScheduleStatsPersist();
   }
   impl->mutex_.Unlock();
 
@@ -16,6 +16,7 @@
 #include "monitoring/perf_context_imp.h"
 #include "options/options_helper.h"
 #include "util/sync_point.h"
+#include "util/trace_replay.h"
 
 namespace rocksdb {
 // Convenience methods
@@ -60,7 +61,8 @@ Status DBImpl::WriteWithCallback(const WriteOptions& write_options,
 Status DBImpl::WriteImpl(const WriteOptions& write_options,
                          WriteBatch* my_batch, WriteCallback* callback,
                          uint64_t* log_used, uint64_t log_ref,
-                         bool disable_memtable, uint64_t* seq_used) {
+                         bool disable_memtable, uint64_t* seq_used,
+                         bool internal_write) {
   if (my_batch == nullptr) {
     return Status::Corruption("Batch is nullptr!");
   }
@@ -77,6 +79,16 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
     }
   }
 
+  // Only the batches that were accepted are recorded. The writes that skip
+  // the memtable are the WAL-only prepares of 2PC, whose data is recorded
+  // with the write of the commit.
+  if (!disable_memtable && !internal_write && ShouldTrace()) {
+    InstrumentedMutexLock lock(&trace_mutex_);
+    if (tracer_) {
+      tracer_->Write(my_batch);
+    }
+  }
+
   if (concurrent_prepare_ && disable_memtable) {
     return WriteImplWALOnly(write_options, my_batch, callback, log_used,
                             log_ref, seq_used);
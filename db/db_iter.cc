@@ -17,6 +17,7 @@
 #include "db/merge_context.h"
 #include "db/merge_helper.h"
 #include "db/pinned_iterators_manager.h"
+#include "monitoring/key_range_hotness.h"
 #include "monitoring/perf_context_imp.h"
 #include "port/port.h"
 #include "rocksdb/env.h"
@@ -1181,9 +1182,21 @@ inline bool ArenaWrappedDBIter::Valid() const { return db_iter_->Valid(); }
 inline void ArenaWrappedDBIter::SeekToFirst() { db_iter_->SeekToFirst(); }
 inline void ArenaWrappedDBIter::SeekToLast() { db_iter_->SeekToLast(); }
 inline void ArenaWrappedDBIter::Seek(const Slice& target) {
+  if (trace_db_impl_ != nullptr) {
+    trace_db_impl_->TraceIteratorSeek(trace_column_family_id_, target);
+  }
+  if (key_range_hotness_ != nullptr) {
+    key_range_hotness_->SampleRead(target);
+  }
   db_iter_->Seek(target);
 }
 inline void ArenaWrappedDBIter::SeekForPrev(const Slice& target) {
+  if (trace_db_impl_ != nullptr) {
+    trace_db_impl_->TraceIteratorSeekForPrev(trace_column_family_id_, target);
+  }
+  if (key_range_hotness_ != nullptr) {
+    key_range_hotness_->SampleRead(target);
+  }
   db_iter_->SeekForPrev(target);
 }
 inline void ArenaWrappedDBIter::Next() { db_iter_->Next(); }
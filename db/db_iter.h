@@ -24,6 +24,7 @@ namespace rocksdb {
 class Arena;
 class DBIter;
 class InternalIterator;
+class KeyRangeHotness;
 
 // Return a new iterator that converts internal keys (yielded by
 // "*internal_iter") that were live at the specified "sequence" number
@@ -79,6 +80,19 @@ class ArenaWrappedDBIter : public Iterator {
     cfd_ = cfd;
   }
 
+  // Seek() and SeekForPrev() are recorded in the traces of db_impl (see
+  // DB::StartTrace())
+  void StoreTraceInfo(DBImpl* db_impl, uint32_t column_family_id) {
+    trace_db_impl_ = db_impl;
+    trace_column_family_id_ = column_family_id;
+  }
+
+  // Seek() and SeekForPrev() are sampled as reads of the key range of their
+  // target (see ColumnFamilyOptions::key_hotness_prefix_extractor)
+  void StoreKeyRangeHotness(KeyRangeHotness* key_range_hotness) {
+    key_range_hotness_ = key_range_hotness;
+  }
+
  private:
   DBIter* db_iter_;
   Arena arena_;
@@ -86,6 +100,9 @@ class ArenaWrappedDBIter : public Iterator {
   ColumnFamilyData* cfd_ = nullptr;
   DBImpl* db_impl_ = nullptr;
   ReadOptions read_options_;
+  DBImpl* trace_db_impl_ = nullptr;
+  uint32_t trace_column_family_id_ = 0;
+  KeyRangeHotness* key_range_hotness_ = nullptr;
 };
 
 // Generate the arena wrapped iterator class.
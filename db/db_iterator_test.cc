@@ -14,6 +14,7 @@
 #include "port/stack_trace.h"
 #include "rocksdb/iostats_context.h"
 #include "rocksdb/perf_context.h"
+#include "rocksdb/threadpool.h"
 
 namespace rocksdb {
 
@@ -1047,6 +1048,123 @@ TEST_F(DBIteratorTest, DBIteratorBoundOptimizationTest) {
   ASSERT_FALSE(iter->Valid());
   ASSERT_EQ(upper_bound_hits, 1);
 }
+
+TEST_F(DBIteratorTest, RangeFilterSkipsEmptyRange) {
+  Options options = CurrentOptions();
+  options.env = env_;
+  options.create_if_missing = true;
+  options.prefix_extractor = nullptr;
+  options.statistics = rocksdb::CreateDBStatistics();
+  BlockBasedTableOptions table_options;
+  table_options.range_filter = true;
+  table_options.range_filter_suffix_bytes = 1;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+  DestroyAndReopen(options);
+  ASSERT_OK(Put("t100", "v1"));
+  ASSERT_OK(Put("t200", "v2"));
+  ASSERT_OK(Put("t300", "v3"));
+  ASSERT_OK(Flush());
+
+  ReadOptions ro;
+  Slice ub("t160");
+  ro.iterate_upper_bound = &ub;
+  {
+    // No key in [t150, t160): the data block is never read
+    uint64_t misses = TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS);
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ro));
+    iter->Seek("t150");
+    ASSERT_FALSE(iter->Valid());
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(misses, TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS));
+  }
+  {
+    uint64_t misses = TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS);
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ro));
+    iter->Seek("t100");
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("t100", iter->key().ToString());
+    ASSERT_LT(misses, TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS));
+    iter->Next();
+    ASSERT_FALSE(iter->Valid());
+  }
+
+  // A filtered out table must not break switching to Prev() when another
+  // source has a key in the range.
+  ASSERT_OK(Put("t155", "v4"));
+  {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ro));
+    iter->Seek("t150");
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("t155", iter->key().ToString());
+    iter->Prev();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("t100", iter->key().ToString());
+    iter->Prev();
+    ASSERT_FALSE(iter->Valid());
+  }
+
+  // Without an upper bound the filter is not consulted
+  {
+    ReadOptions no_bound;
+    std::unique_ptr<Iterator> iter(db_->NewIterator(no_bound));
+    iter->Seek("t150");
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("t155", iter->key().ToString());
+    iter->Next();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("t200", iter->key().ToString());
+  }
+}
+
+TEST_F(DBIteratorTest, UpperBoundPrevWithoutRangeFilter) {
+  Options options = CurrentOptions();
+  options.env = env_;
+  options.create_if_missing = true;
+  options.prefix_extractor = nullptr;
+  BlockBasedTableOptions table_options;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+  // The merging iterator switches direction with Seek() and Prev() on its
+  // children, unless a table has a range filter
+  int num_prev = 0;
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "MergeIterator::Prev:BeforePrev", [&](void* /*arg*/) { num_prev++; });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+
+  for (bool range_filter : {false, true}) {
+    table_options.range_filter = range_filter;
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    DestroyAndReopen(options);
+    ASSERT_OK(Put("a", "v1"));
+    ASSERT_OK(Put("c", "v3"));
+    ASSERT_OK(Flush());
+    ASSERT_OK(Put("b", "v2"));
+
+    num_prev = 0;
+    ReadOptions ro;
+    Slice ub("z");
+    ro.iterate_upper_bound = &ub;
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ro));
+    iter->Seek("b");
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("b", iter->key().ToString());
+    iter->Prev();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("a", iter->key().ToString());
+    iter->Next();
+    iter->Next();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("c", iter->key().ToString());
+    iter->Next();
+    ASSERT_FALSE(iter->Valid());
+    ASSERT_EQ(range_filter ? 0 : 1, num_prev);
+  }
+
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 // TODO(3.13): fix the issue of Seek() + Prev() which might not necessary
 //             return the biggest key which is smaller than the seek key.
 TEST_F(DBIteratorTest, PrevAfterAndNextAfterMerge) {
@@ -1864,6 +1982,85 @@ TEST_F(DBIteratorTest, ReadAhead) {
   delete iter;
 }
 
+TEST_F(DBIteratorTest, DecompressionReadahead) {
+  std::unique_ptr<ThreadPool> pool(NewThreadPool(2));
+  std::atomic<int> blocks_read_ahead(0);
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "BlockBasedTable::DataBlockReadahead::ReadBlock",
+      [&](void* arg) { blocks_read_ahead++; });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+
+  for (bool no_block_cache : {true, false}) {
+    Options options = CurrentOptions();
+    options.disable_auto_compactions = true;
+    BlockBasedTableOptions table_options;
+    table_options.block_size = 1024;
+    table_options.no_block_cache = no_block_cache;
+    options.table_factory.reset(new BlockBasedTableFactory(table_options));
+    DestroyAndReopen(options);
+
+    Random rnd(301);
+    std::vector<std::string> values;
+    for (int i = 0; i < 200; i++) {
+      values.push_back(RandomString(&rnd, 300));
+      ASSERT_OK(Put(Key(i), values.back()));
+    }
+    ASSERT_OK(Flush());
+
+    ReadOptions read_options;
+    read_options.decompression_readahead_blocks = 4;
+    read_options.decompression_thread_pool = pool.get();
+
+    blocks_read_ahead = 0;
+    std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+    int count = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      ASSERT_EQ(Key(count), iter->key().ToString());
+      ASSERT_EQ(values[count], iter->value().ToString());
+      count++;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(200, count);
+    ASSERT_GT(blocks_read_ahead.load(), 0);
+
+    // Seeks and backward steps drop the blocks read ahead
+    for (int i = 0; i < 200; i += 37) {
+      iter->Seek(Key(i));
+      for (int j = i; j < i + 20 && j < 200; j++) {
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(values[j], iter->value().ToString());
+        iter->Next();
+      }
+      for (int j = 0; j < 10 && iter->Valid(); j++) {
+        iter->Prev();
+      }
+    }
+    for (iter->SeekToLast(), count = 199; iter->Valid(); iter->Prev()) {
+      ASSERT_EQ(values[count--], iter->value().ToString());
+    }
+    ASSERT_EQ(-1, count);
+    // Leave blocks in flight when the iterator is deleted
+    iter->SeekToFirst();
+    iter->Next();
+    iter.reset();
+
+    std::string upper_bound = Key(50);
+    Slice upper_bound_slice(upper_bound);
+    read_options.iterate_upper_bound = &upper_bound_slice;
+    iter.reset(db_->NewIterator(read_options));
+    count = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      ASSERT_EQ(values[count++], iter->value().ToString());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(50, count);
+  }
+
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+  pool->JoinAllThreads();
+}
+
 // Insert a key, create a snapshot iterator, overwrite key lots of times,
 // seek to a smaller key. Expect DBIter to fall back to a seek instead of
 // going through all the overwrites linearly.
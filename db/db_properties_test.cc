@@ -1309,6 +1309,63 @@ TEST_F(DBPropertiesTest, EstimateNumKeysUnderflow) {
   ASSERT_EQ(0, num_keys);
 }
 
+TEST_F(DBPropertiesTest, KeyRangeHotness) {
+  Options options = CurrentOptions();
+  options.key_hotness_prefix_extractor.reset(NewFixedPrefixTransform(3));
+  Reopen(options);
+
+  // One in 1024 operations is sampled, so the hot prefix gets many more
+  for (int i = 0; i < 20000; i++) {
+    ASSERT_OK(Put("hot" + ToString(i % 100), "value"));
+  }
+  ASSERT_OK(Put("cold", "value"));
+  ASSERT_OK(Put("x", "value"));
+  ASSERT_OK(Flush());
+  for (int i = 0; i < 50000; i++) {
+    ASSERT_EQ("value", Get("hot" + ToString(i % 100)));
+  }
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  for (int i = 0; i < 20000; i++) {
+    iter->Seek("hot");
+    ASSERT_TRUE(iter->Valid());
+  }
+  iter.reset();
+
+  std::string hotness;
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kKeyRangeHotness, &hotness));
+  // The prefixes come by decreasing operations, so "hot" first
+  std::string prefixes =
+      hotness.substr(hotness.find("** Sampled reads and writes by key"));
+  size_t line_start = prefixes.find('\n', prefixes.find("Prefix")) + 1;
+  std::string hot_line =
+      prefixes.substr(line_start, prefixes.find('\n', line_start) - line_start);
+  uint64_t num_reads = 0;
+  uint64_t num_writes = 0;
+  char prefix[100];
+  ASSERT_EQ(3, sscanf(hot_line.c_str(), "%" SCNu64 " %" SCNu64 " %99s",
+                      &num_reads, &num_writes, prefix));
+  ASSERT_EQ(Slice("hot").ToString(true /* hex */), std::string(prefix));
+  ASSERT_GT(num_reads, 0U);
+  ASSERT_GT(num_writes, 0U);
+  ASSERT_EQ(0U, num_reads % 1024);
+
+  // The reads of the file of the flush
+  std::vector<LiveFileMetaData> metadata;
+  db_->GetLiveFilesMetaData(&metadata);
+  ASSERT_EQ(1U, metadata.size());
+  ASSERT_GT(metadata[0].num_reads_sampled, 0U);
+  ASSERT_FALSE(metadata[0].being_compacted);
+  ASSERT_NE(std::string::npos,
+            hotness.find(" " + ToString(metadata[0].num_reads_sampled) + "\n"));
+
+  // Without the option, only the reads of the files
+  options.key_hotness_prefix_extractor.reset();
+  Reopen(options);
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kKeyRangeHotness, &hotness));
+  ASSERT_NE(std::string::npos,
+            hotness.find("(key_hotness_prefix_extractor is not set)"));
+}
+
 #endif  // ROCKSDB_LITE
 }  // namespace rocksdb
 
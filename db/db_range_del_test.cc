@@ -49,6 +49,23 @@ TEST_F(DBRangeDelTest, FlushOutputHasOnlyRangeTombstones) {
   ASSERT_EQ(1, NumTableFilesAtLevel(0));
 }
 
+TEST_F(DBRangeDelTest, TablePropertiesHaveRangeDelBounds) {
+  ASSERT_OK(db_->Put(WriteOptions(), "b", "val"));
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "c",
+                             "x"));
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "a",
+                             "d"));
+  ASSERT_OK(db_->Flush(FlushOptions()));
+
+  TablePropertiesCollection props;
+  ASSERT_OK(db_->GetPropertiesOfAllTables(&props));
+  ASSERT_EQ(1U, props.size());
+  const auto& tp = props.begin()->second;
+  ASSERT_EQ(2U, tp->num_range_deletions);
+  ASSERT_EQ("a", tp->range_del_smallest_key);
+  ASSERT_EQ("x", tp->range_del_largest_key);
+}
+
 TEST_F(DBRangeDelTest, CompactionOutputHasOnlyRangeTombstone) {
   Options opts = CurrentOptions();
   opts.disable_auto_compactions = true;
@@ -14,7 +14,9 @@
 #include "port/port.h"
 #include "port/stack_trace.h"
 #include "rocksdb/persistent_cache.h"
+#include "rocksdb/trace_reader_writer.h"
 #include "rocksdb/wal_filter.h"
+#include "util/trace_replay.h"
 
 namespace rocksdb {
 
@@ -2325,6 +2327,409 @@ TEST_F(DBTest2, ReduceLevel) {
   Reopen(options);
   ASSERT_EQ("0,1", FilesPerLevel());
 }
+
+TEST_F(DBTest2, IndexFormatVersion3) {
+  for (auto index_type : {BlockBasedTableOptions::kBinarySearch,
+                          BlockBasedTableOptions::kTwoLevelIndexSearch}) {
+    Options options = CurrentOptions();
+    options.disable_auto_compactions = true;
+    BlockBasedTableOptions table_options;
+    table_options.format_version = 3;
+    table_options.index_type = index_type;
+    table_options.index_block_restart_interval = 16;
+    table_options.block_size = 256;
+    table_options.metadata_block_size = 256;
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    DestroyAndReopen(options);
+
+    Random rnd(301);
+    std::map<std::string, std::string> expected;
+    std::map<std::string, std::string> expected_at_snapshot;
+    const Snapshot* snapshot = nullptr;
+    for (int round = 0; round < 2; round++) {
+      for (int i = 0; i < 1000; i++) {
+        std::string key = Key(static_cast<int>(rnd.Uniform(2000)));
+        std::string value = RandomString(&rnd, 20 + rnd.Uniform(100));
+        ASSERT_OK(Put(key, value));
+        expected[key] = value;
+      }
+      if (snapshot == nullptr) {
+        // Keep the first versions so that user keys span data blocks
+        snapshot = db_->GetSnapshot();
+        expected_at_snapshot = expected;
+      }
+    }
+    ASSERT_OK(Flush());
+    ASSERT_OK(dbfull()->TEST_CompactRange(0, nullptr, nullptr, nullptr, true));
+
+    for (int i = 0; i < 2000; i++) {
+      std::string key = Key(i);
+      auto it = expected.find(key);
+      ASSERT_EQ(it == expected.end() ? "NOT_FOUND" : it->second, Get(key));
+      it = expected_at_snapshot.find(key);
+      ASSERT_EQ(it == expected_at_snapshot.end() ? "NOT_FOUND" : it->second,
+                Get(key, snapshot));
+    }
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    auto expected_it = expected.rbegin();
+    for (iter->SeekToLast(); iter->Valid(); iter->Prev(), expected_it++) {
+      ASSERT_TRUE(expected_it != expected.rend());
+      ASSERT_EQ(expected_it->first, iter->key().ToString());
+      ASSERT_EQ(expected_it->second, iter->value().ToString());
+    }
+    ASSERT_TRUE(expected_it == expected.rend());
+    db_->ReleaseSnapshot(snapshot);
+  }
+}
+
+TEST_F(DBTest2, FixedKeySize) {
+  // Values of one size, values of varying sizes, and deletions mixed in
+  for (int mode = 0; mode < 3; mode++) {
+    Options options = CurrentOptions();
+    options.disable_auto_compactions = true;
+    BlockBasedTableOptions table_options;
+    table_options.fixed_key_size = static_cast<uint32_t>(Key(0).size());
+    table_options.block_size = 1024;
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    DestroyAndReopen(options);
+
+    Random rnd(301);
+    std::map<std::string, std::string> expected;
+    for (int i = 0; i < 2000; i++) {
+      std::string key = Key(static_cast<int>(rnd.Uniform(3000)));
+      if (mode == 2 && rnd.OneIn(4)) {
+        ASSERT_OK(Delete(key));
+        expected.erase(key);
+        continue;
+      }
+      std::string value =
+          RandomString(&rnd, mode == 0 ? 50 : 20 + rnd.Uniform(100));
+      ASSERT_OK(Put(key, value));
+      expected[key] = value;
+    }
+    if (mode == 2) {
+      // A key of another size puts its block back in the regular format
+      ASSERT_OK(Put("key001500a", "v"));
+      expected["key001500a"] = "v";
+    }
+    ASSERT_OK(Flush());
+    for (int level = 0; level < 2; level++) {
+      for (int i = 0; i < 3000; i++) {
+        std::string key = Key(i);
+        auto it = expected.find(key);
+        ASSERT_EQ(it == expected.end() ? "NOT_FOUND" : it->second, Get(key));
+      }
+      std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+      auto expected_it = expected.rbegin();
+      for (iter->SeekToLast(); iter->Valid(); iter->Prev(), expected_it++) {
+        ASSERT_TRUE(expected_it != expected.rend());
+        ASSERT_EQ(expected_it->first, iter->key().ToString());
+        ASSERT_EQ(expected_it->second, iter->value().ToString());
+      }
+      ASSERT_TRUE(expected_it == expected.rend());
+      for (int i = 0; i < 100; i++) {
+        std::string key = Key(static_cast<int>(rnd.Uniform(3000)));
+        auto it = expected.lower_bound(key);
+        iter->Seek(key);
+        ASSERT_EQ(it != expected.end(), iter->Valid());
+        if (iter->Valid()) {
+          ASSERT_EQ(it->first, iter->key().ToString());
+          iter->Next();
+          ++it;
+          ASSERT_EQ(it != expected.end(), iter->Valid());
+        }
+      }
+      ASSERT_OK(iter->status());
+      ASSERT_OK(dbfull()->TEST_CompactRange(0, nullptr, nullptr, nullptr,
+                                            true));
+    }
+  }
+}
+
+TEST_F(DBTest2, ColumnAwareBlocks) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.compression = kSnappyCompression;
+  if (!Snappy_Supported()) {
+    options.compression = kNoCompression;
+  }
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 4096;
+  // A fixed-length id, a name and a big-endian counter
+  table_options.value_columns = {
+      ValueColumn(ValueColumn::kFixedLength, 4, ValueColumn::kRunLength),
+      ValueColumn(ValueColumn::kVariableLength, 0, ValueColumn::kDictionary),
+      ValueColumn(ValueColumn::kFixedLength, 8, ValueColumn::kDelta, true)};
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  auto make_row = [](uint32_t id, const std::string& name, uint64_t counter,
+                     const std::string& payload) {
+    std::string row;
+    PutFixed32(&row, id);
+    PutLengthPrefixedSlice(&row, name);
+    for (int i = 7; i >= 0; i--) {
+      row.push_back(static_cast<char>(counter >> (8 * i)));
+    }
+    return row + payload;
+  };
+  Random rnd(301);
+  std::map<std::string, std::string> expected;
+  for (int i = 0; i < 3000; i++) {
+    std::string value = i % 10 == 5
+                            ? "not a row"
+                            : make_row(i / 100, "name" + ToString(i % 3),
+                                       1000000 + i, RandomString(&rnd, 10));
+    ASSERT_OK(Put(Key(i), value));
+    expected[Key(i)] = value;
+  }
+  for (int i = 0; i < 3000; i += 7) {
+    ASSERT_OK(Delete(Key(i)));
+    expected.erase(Key(i));
+  }
+  ASSERT_OK(Flush());
+
+  for (int level = 0; level < 2; level++) {
+    // Reads that bypass the block cache decode only the projected columns.
+    // They come first, as blocks already in the block cache are whole.
+    std::vector<uint32_t> projection = {2};
+    ReadOptions ro;
+    ro.fill_cache = false;
+    ro.column_projection = &projection;
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ro));
+    auto expected_it = expected.begin();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), expected_it++) {
+      ASSERT_TRUE(expected_it != expected.end());
+      int i = std::stoi(expected_it->first.substr(3));
+      ASSERT_EQ(i % 10 == 5 ? "not a row" : make_row(0, "", 1000000 + i, ""),
+                iter->value().ToString());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(expected_it == expected.end());
+
+    for (int i = 0; i < 3000; i++) {
+      auto it = expected.find(Key(i));
+      ASSERT_EQ(it == expected.end() ? "NOT_FOUND" : it->second, Get(Key(i)));
+    }
+    // With fill_cache, the blocks are cached whole and the projection does
+    // not apply
+    ReadOptions fill_cache_ro;
+    fill_cache_ro.column_projection = &projection;
+    std::string value;
+    ASSERT_OK(db_->Get(fill_cache_ro, Key(1), &value));
+    ASSERT_EQ(expected[Key(1)], value);
+    iter.reset(db_->NewIterator(ReadOptions()));
+    expected_it = expected.begin();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), expected_it++) {
+      ASSERT_TRUE(expected_it != expected.end());
+      ASSERT_EQ(expected_it->first, iter->key().ToString());
+      ASSERT_EQ(expected_it->second, iter->value().ToString());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(expected_it == expected.end());
+
+    ASSERT_OK(dbfull()->TEST_CompactRange(0, nullptr, nullptr, nullptr,
+                                          true));
+  }
+
+  // Columns that cannot be encoded are rejected
+  table_options.value_columns = {
+      ValueColumn(ValueColumn::kVariableLength, 0, ValueColumn::kDelta)};
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+}
+
+TEST_F(DBTest2, TraceAndReplay) {
+  Options options = CurrentOptions();
+  options.merge_operator = MergeOperators::CreatePutOperator();
+  CreateAndReopenWithCF({"pikachu"}, options);
+  ASSERT_OK(Put(0, "b", "0"));
+
+  EnvOptions env_options;
+  std::string trace_filename = dbname_ + "/rocksdb.trace";
+  std::unique_ptr<TraceWriter> trace_writer;
+  ASSERT_OK(
+      NewFileTraceWriter(env_, env_options, trace_filename, &trace_writer));
+  ASSERT_OK(db_->StartTrace(TraceOptions(), std::move(trace_writer)));
+  ASSERT_TRUE(db_->StartTrace(TraceOptions(), nullptr).IsBusy());
+
+  ASSERT_OK(Put(0, "a", "1"));
+  ASSERT_OK(Merge(0, "b", "2"));
+  ASSERT_OK(Delete(0, "c"));
+  ASSERT_OK(SingleDelete(0, "d"));
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), handles_[0], "e", "f"));
+  WriteBatch batch;
+  ASSERT_OK(batch.Put(handles_[1], "x", "3"));
+  ASSERT_OK(batch.Put(handles_[0], "y", "4"));
+  ASSERT_OK(db_->Write(WriteOptions(), &batch));
+  ASSERT_EQ("1", Get(0, "a"));
+  ASSERT_EQ("NOT_FOUND", Get(1, "g"));
+  {
+    // Iterators with a snapshot are traced as well
+    ReadOptions ro;
+    ro.snapshot = db_->GetSnapshot();
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ro, handles_[1]));
+    iter->Seek("x");
+    ASSERT_TRUE(iter->Valid());
+    iter->SeekForPrev("z");
+    ASSERT_TRUE(iter->Valid());
+    db_->ReleaseSnapshot(ro.snapshot);
+  }
+  ASSERT_OK(db_->EndTrace());
+  ASSERT_TRUE(db_->EndTrace().IsNotFound());
+  ASSERT_OK(Put(0, "z", "not traced"));
+
+  for (int num_threads : {1, 4}) {
+    std::string replay_dbname = test::TmpDir(env_) + "/db_replay";
+    ASSERT_OK(DestroyDB(replay_dbname, options));
+    Options replay_options = options;
+    replay_options.create_if_missing = true;
+    replay_options.create_missing_column_families = true;
+    std::vector<ColumnFamilyDescriptor> cf_descs;
+    cf_descs.emplace_back(kDefaultColumnFamilyName, replay_options);
+    cf_descs.emplace_back("pikachu", replay_options);
+    std::vector<ColumnFamilyHandle*> handles;
+    DB* replay_db = nullptr;
+    ASSERT_OK(DB::Open(DBOptions(replay_options), replay_dbname, cf_descs,
+                       &handles, &replay_db));
+    ASSERT_OK(replay_db->Put(WriteOptions(), handles[0], "b", "0"));
+
+    std::unique_ptr<TraceReader> trace_reader;
+    ASSERT_OK(
+        NewFileTraceReader(env_, env_options, trace_filename, &trace_reader));
+    Replayer replayer(replay_db, handles, std::move(trace_reader));
+    ReplayOptions replay_opts;
+    replay_opts.num_threads = num_threads;
+    replay_opts.fast_forward = 100.0;
+    ReplayStats stats;
+    ASSERT_OK(replayer.Replay(replay_opts, &stats));
+    ASSERT_EQ(6U, stats.write_latency.num());
+    ASSERT_EQ(2U, stats.get_latency.num());
+    ASSERT_EQ(1U, stats.seek_latency.num());
+    ASSERT_EQ(1U, stats.seek_for_prev_latency.num());
+    ASSERT_EQ(0U, stats.num_errors.load());
+    ASSERT_EQ(0U, stats.num_skipped.load());
+
+    std::string value;
+    ASSERT_OK(replay_db->Get(ReadOptions(), handles[0], "a", &value));
+    ASSERT_EQ("1", value);
+    ASSERT_OK(replay_db->Get(ReadOptions(), handles[0], "b", &value));
+    ASSERT_EQ("2", value);
+    ASSERT_OK(replay_db->Get(ReadOptions(), handles[1], "x", &value));
+    ASSERT_EQ("3", value);
+    ASSERT_OK(replay_db->Get(ReadOptions(), handles[0], "y", &value));
+    ASSERT_EQ("4", value);
+    ASSERT_TRUE(
+        replay_db->Get(ReadOptions(), handles[0], "z", &value).IsNotFound());
+
+    for (auto handle : handles) {
+      delete handle;
+    }
+    delete replay_db;
+    ASSERT_OK(DestroyDB(replay_dbname, options));
+  }
+}
+
+TEST_F(DBTest2, TraceSampling) {
+  Options options = CurrentOptions();
+  Reopen(options);
+
+  EnvOptions env_options;
+  std::string trace_filename = dbname_ + "/rocksdb.trace";
+  for (uint64_t max_trace_file_size : {uint64_t{0}, uint64_t{200}}) {
+    std::unique_ptr<TraceWriter> trace_writer;
+    ASSERT_OK(
+        NewFileTraceWriter(env_, env_options, trace_filename, &trace_writer));
+    TraceOptions trace_options;
+    trace_options.sampling_frequency = 3;
+    if (max_trace_file_size > 0) {
+      trace_options.max_trace_file_size = max_trace_file_size;
+    }
+    ASSERT_OK(db_->StartTrace(trace_options, std::move(trace_writer)));
+    for (int i = 0; i < 30; i++) {
+      ASSERT_OK(Put(Key(i), "value"));
+    }
+    ASSERT_OK(db_->EndTrace());
+
+    std::unique_ptr<TraceReader> trace_reader;
+    ASSERT_OK(
+        NewFileTraceReader(env_, env_options, trace_filename, &trace_reader));
+    std::string encoded;
+    Trace trace;
+    int num_writes = 0;
+    bool ended = false;
+    while (trace_reader->Read(&encoded).ok()) {
+      ASSERT_OK(DecodeTrace(encoded, &trace));
+      if (trace.type == kTraceWrite) {
+        num_writes++;
+      } else if (trace.type == kTraceEnd) {
+        ended = true;
+      }
+    }
+    ASSERT_TRUE(ended);
+    if (max_trace_file_size == 0) {
+      ASSERT_EQ(10, num_writes);
+    } else {
+      // Recording stops once the trace is larger than the limit
+      ASSERT_GT(num_writes, 0);
+      ASSERT_LT(num_writes, 10);
+    }
+  }
+}
+
+TEST_F(DBTest2, TraceSkipsRejectedWrites) {
+  Options options = CurrentOptions();
+  // Compaction pressure should trigger since 6 files
+  options.level0_file_num_compaction_trigger = 4;
+  options.level0_slowdown_writes_trigger = 12;
+  options.level0_stop_writes_trigger = 30;
+  env_->SetBackgroundThreads(1, Env::HIGH);
+  env_->SetBackgroundThreads(1, Env::LOW);
+  Reopen(options);
+
+  // Block compaction
+  test::SleepingBackgroundTask sleeping_task_low;
+  env_->Schedule(&test::SleepingBackgroundTask::DoSleepTask, &sleeping_task_low,
+                 Env::Priority::LOW);
+  for (int i = 0; i < 6; i++) {
+    ASSERT_OK(Put("a", ToString(i)));
+    ASSERT_OK(Flush());
+  }
+
+  EnvOptions env_options;
+  std::string trace_filename = dbname_ + "/rocksdb.trace";
+  std::unique_ptr<TraceWriter> trace_writer;
+  ASSERT_OK(
+      NewFileTraceWriter(env_, env_options, trace_filename, &trace_writer));
+  ASSERT_OK(db_->StartTrace(TraceOptions(), std::move(trace_writer)));
+  // A low priority write that would be throttled is rejected
+  WriteOptions wo;
+  wo.low_pri = true;
+  wo.no_slowdown = true;
+  ASSERT_TRUE(Put("a", "rejected", wo).IsIncomplete());
+  ASSERT_EQ("5", Get("a"));
+  ASSERT_OK(db_->EndTrace());
+  sleeping_task_low.WakeUp();
+  sleeping_task_low.WaitUntilDone();
+
+  std::unique_ptr<TraceReader> trace_reader;
+  ASSERT_OK(
+      NewFileTraceReader(env_, env_options, trace_filename, &trace_reader));
+  std::string encoded;
+  Trace trace;
+  int num_writes = 0;
+  int num_gets = 0;
+  while (trace_reader->Read(&encoded).ok()) {
+    ASSERT_OK(DecodeTrace(encoded, &trace));
+    if (trace.type == kTraceWrite) {
+      num_writes++;
+    } else if (trace.type == kTraceGet) {
+      num_gets++;
+    }
+  }
+  ASSERT_EQ(0, num_writes);
+  ASSERT_EQ(1, num_gets);
+}
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -43,6 +43,7 @@
 #include "table/merging_iterator.h"
 #include "table/table_builder.h"
 #include "table/two_level_iterator.h"
+#include "util/block_cache_tracer.h"
 #include "util/coding.h"
 #include "util/event_logger.h"
 #include "util/file_util.h"
@@ -240,6 +241,7 @@ Status FlushJob::WriteLevel0Table() {
   AutoThreadOperationStageUpdater stage_updater(
       ThreadStatus::STAGE_FLUSH_WRITE_L0);
   db_mutex_->AssertHeld();
+  BlockCacheTraceCallerScope caller_scope(kFlush);
   const uint64_t start_micros = db_options_.env->NowMicros();
   Status s;
   {
@@ -238,6 +238,7 @@ static const std::string aggregated_table_properties =
     "aggregated-table-properties";
 static const std::string aggregated_table_properties_at_level =
     aggregated_table_properties + "-at-level";
+static const std::string key_range_hotness = "key-range-hotness";
 static const std::string num_running_compactions = "num-running-compactions";
 static const std::string num_running_flushes = "num-running-flushes";
 static const std::string actual_delayed_write_rate =
@@ -312,6 +313,8 @@ const std::string DB::Properties::kAggregatedTableProperties =
     rocksdb_prefix + aggregated_table_properties;
 const std::string DB::Properties::kAggregatedTablePropertiesAtLevel =
     rocksdb_prefix + aggregated_table_properties_at_level;
+const std::string DB::Properties::kKeyRangeHotness =
+    rocksdb_prefix + key_range_hotness;
 const std::string DB::Properties::kActualDelayedWriteRate =
     rocksdb_prefix + actual_delayed_write_rate;
 const std::string DB::Properties::kIsWriteStopped =
@@ -346,6 +349,8 @@ const std::unordered_map<std::string, DBPropertyInfo>
         {DB::Properties::kAggregatedTablePropertiesAtLevel,
          {false, &InternalStats::HandleAggregatedTablePropertiesAtLevel,
           nullptr, nullptr}},
+        {DB::Properties::kKeyRangeHotness,
+         {false, &InternalStats::HandleKeyRangeHotness, nullptr, nullptr}},
         {DB::Properties::kNumImmutableMemTable,
          {false, nullptr, &InternalStats::HandleNumImmutableMemTable, nullptr}},
         {DB::Properties::kNumImmutableMemTableFlushed,
@@ -575,6 +580,31 @@ bool InternalStats::HandleAggregatedTablePropertiesAtLevel(std::string* value,
   return true;
 }
 
+bool InternalStats::HandleKeyRangeHotness(std::string* value, Slice suffix) {
+  char buf[200];
+  value->append("** Sampled reads by file **\n");
+  snprintf(buf, sizeof(buf), "%5s %10s %14s %12s\n", "Level", "File",
+           "Size", "Reads");
+  value->append(buf);
+  const auto* vstorage = cfd_->current()->storage_info();
+  for (int level = 0; level < vstorage->num_levels(); level++) {
+    for (const auto* file : vstorage->LevelFiles(level)) {
+      snprintf(buf, sizeof(buf), "%5d %10" PRIu64 " %14" PRIu64 " %12" PRIu64
+                                 "\n",
+               level, file->fd.GetNumber(), file->fd.GetFileSize(),
+               file->stats.num_reads_sampled.load(std::memory_order_relaxed));
+      value->append(buf);
+    }
+  }
+  value->append("** Sampled reads and writes by key prefix **\n");
+  if (cfd_->key_range_hotness()->enabled()) {
+    value->append(cfd_->key_range_hotness()->ToString());
+  } else {
+    value->append("(key_hotness_prefix_extractor is not set)\n");
+  }
+  return true;
+}
+
 bool InternalStats::HandleNumImmutableMemTable(uint64_t* value, DBImpl* db,
                                                Version* version) {
   *value = cfd_->imm()->NumNotFlushed();
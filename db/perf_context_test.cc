@@ -13,9 +13,11 @@
 #include "monitoring/thread_status_util.h"
 #include "port/port.h"
 #include "rocksdb/db.h"
+#include "rocksdb/filter_policy.h"
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/perf_context.h"
 #include "rocksdb/slice_transform.h"
+#include "rocksdb/table.h"
 #include "util/stop_watch.h"
 #include "util/string_util.h"
 #include "util/testharness.h"
@@ -615,6 +617,71 @@ TEST_F(PerfContextTest, ToString) {
   ASSERT_NE(std::string::npos, zero_excluded.find("= 12345"));
 }
 
+TEST_F(PerfContextTest, PerfContextByLevel) {
+  DestroyDB(kDbName, Options());
+  DB* db;
+  Options options;
+  options.create_if_missing = true;
+  BlockBasedTableOptions table_options;
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10, false));
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  ASSERT_OK(DB::Open(options, kDbName, &db));
+
+  // k1 at level 2, and a file at level 0 that overlaps it
+  ASSERT_OK(db->Put(WriteOptions(), "k1", "v1"));
+  ASSERT_OK(db->Flush(FlushOptions()));
+  CompactRangeOptions compact_options;
+  compact_options.change_level = true;
+  compact_options.target_level = 2;
+  ASSERT_OK(db->CompactRange(compact_options, nullptr, nullptr));
+  ASSERT_OK(db->Put(WriteOptions(), "a", "va"));
+  ASSERT_OK(db->Put(WriteOptions(), "z", "vz"));
+  ASSERT_OK(db->Flush(FlushOptions()));
+
+  SetPerfLevel(kEnableTimeExceptForMutex);
+  get_perf_context()->Reset();
+  get_perf_context()->EnablePerLevelPerfContext();
+  std::string value;
+  ASSERT_OK(db->Get(ReadOptions(), "k1", &value));
+  ASSERT_OK(db->Get(ReadOptions(), "k1", &value));
+
+  const PerfContextByLevel* by_level =
+      get_perf_context()->level_to_perf_context;
+  // The filter of the level 0 file keeps its blocks from being read
+  ASSERT_EQ(2U, by_level[0].get_from_table_count);
+  ASSERT_EQ(2U, by_level[0].bloom_sst_miss_count);
+  ASSERT_EQ(0U, by_level[0].bloom_sst_hit_count);
+  ASSERT_EQ(0U, by_level[0].block_read_count);
+  ASSERT_EQ(0U, by_level[1].get_from_table_count);
+  // The data block of the level 2 file is read once, then cached
+  ASSERT_EQ(2U, by_level[2].get_from_table_count);
+  ASSERT_EQ(2U, by_level[2].bloom_sst_hit_count);
+  ASSERT_EQ(1U, by_level[2].block_read_count);
+  ASSERT_EQ(1U, by_level[2].block_cache_hit_count);
+  ASSERT_GT(by_level[2].block_read_byte, 0U);
+  ASSERT_GT(by_level[2].get_from_table_nanos, 0U);
+  ASSERT_EQ(get_perf_context()->block_read_count,
+            by_level[2].block_read_count);
+
+  std::string by_level_string = get_perf_context()->ToString(true);
+  ASSERT_NE(
+      std::string::npos,
+      by_level_string.find("get_from_table_count = 2@level0, 2@level2, "));
+  ASSERT_NE(std::string::npos,
+            by_level_string.find("bloom_sst_miss_count = 2@level0, "));
+
+  // Without the breakdown, the counters of the levels are left alone
+  get_perf_context()->DisablePerLevelPerfContext();
+  ASSERT_OK(db->Get(ReadOptions(), "k1", &value));
+  ASSERT_EQ(0U, by_level[2].get_from_table_count);
+  ASSERT_EQ(std::string::npos,
+            get_perf_context()->ToString().find("get_from_table_count"));
+  ASSERT_EQ(3U, get_perf_context()->bloom_sst_hit_count);
+
+  SetPerfLevel(kEnableCount);
+  delete db;
+}
+
 TEST_F(PerfContextTest, MergeOperatorTime) {
   DestroyDB(kDbName, Options());
   DB* db;
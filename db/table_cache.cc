@@ -64,8 +64,12 @@ void AppendVarint64(IterKey* key, uint64_t v) {
 }  // namespace
 
 TableCache::TableCache(const ImmutableCFOptions& ioptions,
-                       const EnvOptions& env_options, Cache* const cache)
-    : ioptions_(ioptions), env_options_(env_options), cache_(cache) {
+                       const EnvOptions& env_options, Cache* const cache,
+                       BlockCacheTracer* const block_cache_tracer)
+    : ioptions_(ioptions),
+      env_options_(env_options),
+      cache_(cache),
+      block_cache_tracer_(block_cache_tracer) {
   if (ioptions_.row_cache) {
     // If the same cache is shared by multiple instances, we need to
     // disambiguate its entries.
@@ -90,7 +94,7 @@ Status TableCache::GetTableReader(
     bool sequential_mode, size_t readahead, bool record_read_stats,
     HistogramImpl* file_read_hist, unique_ptr<TableReader>* table_reader,
     bool skip_filters, int level, bool prefetch_index_and_filter_in_cache,
-    bool for_compaction) {
+    bool for_compaction, ThreadPoolImpl* prefetch_pool) {
   std::string fname =
       TableFileName(ioptions_.db_paths, fd.GetNumber(), fd.GetPathId());
   unique_ptr<RandomAccessFile> file;
@@ -99,7 +103,8 @@ Status TableCache::GetTableReader(
   RecordTick(ioptions_.statistics, NO_FILE_OPENS);
   if (s.ok()) {
     if (readahead > 0) {
-      file = NewReadaheadRandomAccessFile(std::move(file), readahead);
+      file = NewReadaheadRandomAccessFile(std::move(file), readahead,
+                                          prefetch_pool);
     }
     if (!sequential_mode && ioptions_.advise_random_on_open) {
       file->Hint(RandomAccessFile::RANDOM);
@@ -112,7 +117,7 @@ Status TableCache::GetTableReader(
             file_read_hist, ioptions_.rate_limiter, for_compaction));
     s = ioptions_.table_factory->NewTableReader(
         TableReaderOptions(ioptions_, env_options, internal_comparator,
-                           skip_filters, level),
+                           skip_filters, level, block_cache_tracer_),
         std::move(file_reader), fd.GetFileSize(), table_reader,
         prefetch_index_and_filter_in_cache);
     TEST_SYNC_POINT("TableCache::GetTableReader:0");
@@ -173,7 +178,7 @@ InternalIterator* TableCache::NewIterator(
     const InternalKeyComparator& icomparator, const FileDescriptor& fd,
     RangeDelAggregator* range_del_agg, TableReader** table_reader_ptr,
     HistogramImpl* file_read_hist, bool for_compaction, Arena* arena,
-    bool skip_filters, int level) {
+    bool skip_filters, int level, ThreadPoolImpl* compaction_prefetch_pool) {
   PERF_TIMER_GUARD(new_table_iterator_nanos);
 
   Status s;
@@ -206,7 +211,8 @@ InternalIterator* TableCache::NewIterator(
           env_options, icomparator, fd, true /* sequential_mode */, readahead,
           !for_compaction /* record stats */, nullptr, &table_reader_unique_ptr,
           false /* skip_filters */, level,
-          true /* prefetch_index_and_filter_in_cache */, for_compaction);
+          true /* prefetch_index_and_filter_in_cache */, for_compaction,
+          for_compaction ? compaction_prefetch_pool : nullptr);
       if (s.ok()) {
         table_reader = table_reader_unique_ptr.release();
       }
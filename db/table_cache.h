@@ -26,17 +26,20 @@
 
 namespace rocksdb {
 
+class BlockCacheTracer;
 class Env;
 class Arena;
 struct FileDescriptor;
 class GetContext;
 class HistogramImpl;
 class InternalIterator;
+class ThreadPoolImpl;
 
 class TableCache {
  public:
   TableCache(const ImmutableCFOptions& ioptions,
-             const EnvOptions& storage_options, Cache* cache);
+             const EnvOptions& storage_options, Cache* cache,
+             BlockCacheTracer* const block_cache_tracer = nullptr);
   ~TableCache();
 
   // Return an iterator for the specified file number (the corresponding
@@ -50,13 +53,17 @@ class TableCache {
   //    aggregator. If an error occurs, returns it in a NewErrorInternalIterator
   // @param skip_filters Disables loading/accessing the filter block
   // @param level The level this table is at, -1 for "not set / don't know"
+  // @param compaction_prefetch_pool If non-nullptr and a new table reader with
+  //    readahead is created for compaction, the next readahead window is read
+  //    on this pool while the current one is consumed.
   InternalIterator* NewIterator(
       const ReadOptions& options, const EnvOptions& toptions,
       const InternalKeyComparator& internal_comparator,
       const FileDescriptor& file_fd, RangeDelAggregator* range_del_agg,
       TableReader** table_reader_ptr = nullptr,
       HistogramImpl* file_read_hist = nullptr, bool for_compaction = false,
-      Arena* arena = nullptr, bool skip_filters = false, int level = -1);
+      Arena* arena = nullptr, bool skip_filters = false, int level = -1,
+      ThreadPoolImpl* compaction_prefetch_pool = nullptr);
 
   InternalIterator* NewRangeTombstoneIterator(
       const ReadOptions& options, const EnvOptions& toptions,
@@ -135,12 +142,14 @@ class TableCache {
                         unique_ptr<TableReader>* table_reader,
                         bool skip_filters = false, int level = -1,
                         bool prefetch_index_and_filter_in_cache = true,
-                        bool for_compaction = false);
+                        bool for_compaction = false,
+                        ThreadPoolImpl* prefetch_pool = nullptr);
 
   const ImmutableCFOptions& ioptions_;
   const EnvOptions& env_options_;
   Cache* const cache_;
   std::string row_cache_id_;
+  BlockCacheTracer* const block_cache_tracer_;
 };
 
 }  // namespace rocksdb
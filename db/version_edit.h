@@ -62,15 +62,20 @@ struct FileDescriptor {
 };
 
 struct FileSampledStats {
-  FileSampledStats() : num_reads_sampled(0) {}
+  FileSampledStats() : num_reads_sampled(0), num_tombstones_skipped_sampled(0) {}
   FileSampledStats(const FileSampledStats& other) { *this = other; }
   FileSampledStats& operator=(const FileSampledStats& other) {
     num_reads_sampled = other.num_reads_sampled.load();
+    num_tombstones_skipped_sampled =
+        other.num_tombstones_skipped_sampled.load();
     return *this;
   }
 
   // number of user reads to this file.
   mutable std::atomic<uint64_t> num_reads_sampled;
+  // number of point tombstones in this file that user iterators had to step
+  // over.
+  mutable std::atomic<uint64_t> num_tombstones_skipped_sampled;
 };
 
 struct FileMetaData {
@@ -95,8 +100,13 @@ struct FileMetaData {
   // single-threaded LogAndApply thread
   uint64_t num_entries;            // the number of entries.
   uint64_t num_deletions;          // the number of deletion entries.
+  uint64_t num_range_deletions;    // the number of range deletion entries.
   uint64_t raw_key_size;           // total uncompressed key size.
   uint64_t raw_value_size;         // total uncompressed value size.
+  // Smallest begin key and largest end key of the range deletions in the
+  // file. Only meaningful if num_range_deletions > 0.
+  std::string range_del_smallest_key;
+  std::string range_del_largest_key;
 
   int refs;  // Reference count
 
@@ -114,6 +124,7 @@ struct FileMetaData {
         compensated_file_size(0),
         num_entries(0),
         num_deletions(0),
+        num_range_deletions(0),
         raw_key_size(0),
         raw_value_size(0),
         refs(0),
@@ -34,6 +34,7 @@
 #include "db/version_builder.h"
 #include "monitoring/file_read_sample.h"
 #include "monitoring/perf_context_imp.h"
+#include "monitoring/stats_history.h"
 #include "rocksdb/env.h"
 #include "rocksdb/merge_operator.h"
 #include "rocksdb/write_buffer_manager.h"
@@ -425,6 +426,88 @@ bool SomeFileOverlapsRange(
 
 namespace {
 
+// Wraps the iterator of a single table file for an iterator that was picked
+// by should_sample_file_read(). It counts the point tombstones the user
+// iterator steps over in that file, so that files which make reads skip many
+// deleted keys can be picked for compaction.
+class TombstoneSamplingIterator : public InternalIterator {
+ public:
+  TombstoneSamplingIterator(InternalIterator* iter, FileMetaData* file_meta,
+                            bool is_arena_mode)
+      : iter_(iter),
+        file_meta_(file_meta),
+        is_arena_mode_(is_arena_mode),
+        num_tombstones_(0) {}
+
+  ~TombstoneSamplingIterator() {
+    if (num_tombstones_ > 0) {
+      file_meta_->stats.num_tombstones_skipped_sampled.fetch_add(
+          num_tombstones_ * kFileReadSampleRate, std::memory_order_relaxed);
+    }
+    if (is_arena_mode_) {
+      iter_->~InternalIterator();
+    } else {
+      delete iter_;
+    }
+  }
+
+  virtual bool Valid() const override { return iter_->Valid(); }
+  virtual void SeekToFirst() override {
+    iter_->SeekToFirst();
+    CountTombstone();
+  }
+  virtual void SeekToLast() override {
+    iter_->SeekToLast();
+    CountTombstone();
+  }
+  virtual void Seek(const Slice& target) override {
+    iter_->Seek(target);
+    CountTombstone();
+  }
+  virtual void SeekForPrev(const Slice& target) override {
+    iter_->SeekForPrev(target);
+    CountTombstone();
+  }
+  virtual void Next() override {
+    iter_->Next();
+    CountTombstone();
+  }
+  virtual void Prev() override {
+    iter_->Prev();
+    CountTombstone();
+  }
+  virtual Slice key() const override { return iter_->key(); }
+  virtual Slice value() const override { return iter_->value(); }
+  virtual Status status() const override { return iter_->status(); }
+  virtual void SetPinnedItersMgr(
+      PinnedIteratorsManager* pinned_iters_mgr) override {
+    iter_->SetPinnedItersMgr(pinned_iters_mgr);
+  }
+  virtual bool IsKeyPinned() const override { return iter_->IsKeyPinned(); }
+  virtual bool IsValuePinned() const override {
+    return iter_->IsValuePinned();
+  }
+  virtual Status GetProperty(std::string prop_name,
+                             std::string* prop) override {
+    return iter_->GetProperty(prop_name, prop);
+  }
+
+ private:
+  void CountTombstone() {
+    if (iter_->Valid()) {
+      ValueType type = ExtractValueType(iter_->key());
+      if (type == kTypeDeletion || type == kTypeSingleDeletion) {
+        num_tombstones_++;
+      }
+    }
+  }
+
+  InternalIterator* iter_;
+  FileMetaData* file_meta_;
+  bool is_arena_mode_;
+  uint64_t num_tombstones_;
+};
+
 // An internal iterator.  For a given version/level pair, yields
 // information about the files in the level.  For a given entry, key()
 // is the largest key that occurs in the file, and value() is an
@@ -482,6 +565,13 @@ class LevelFileNumIterator : public InternalIterator {
   }
   virtual Status status() const override { return Status::OK(); }
 
+  // Metadata of the file the iterator is currently positioned at.
+  // REQUIRES: Valid()
+  FileMetaData* file_metadata() const {
+    assert(Valid());
+    return flevel_->files[index_].file_metadata;
+  }
+
  private:
   const InternalKeyComparator icmp_;
   const LevelFilesBrief* flevel_;
@@ -493,13 +583,18 @@ class LevelFileNumIterator : public InternalIterator {
 class LevelFileIteratorState : public TwoLevelIteratorState {
  public:
   // @param skip_filters Disables loading/accessing the filter block
+  // @param sampled_file_iter If not nullptr, tombstones skipped in the file
+  //                          it is positioned at are sampled
   LevelFileIteratorState(TableCache* table_cache,
                          const ReadOptions& read_options,
                          const EnvOptions& env_options,
                          const InternalKeyComparator& icomparator,
                          HistogramImpl* file_read_hist, bool for_compaction,
                          bool prefix_enabled, bool skip_filters, int level,
-                         RangeDelAggregator* range_del_agg)
+                         RangeDelAggregator* range_del_agg,
+                         const LevelFileNumIterator* sampled_file_iter =
+                             nullptr,
+                         ThreadPoolImpl* compaction_prefetch_pool = nullptr)
       : TwoLevelIteratorState(prefix_enabled),
         table_cache_(table_cache),
         read_options_(read_options),
@@ -509,19 +604,30 @@ class LevelFileIteratorState : public TwoLevelIteratorState {
         for_compaction_(for_compaction),
         skip_filters_(skip_filters),
         level_(level),
-        range_del_agg_(range_del_agg) {}
+        range_del_agg_(range_del_agg),
+        sampled_file_iter_(sampled_file_iter),
+        compaction_prefetch_pool_(compaction_prefetch_pool) {}
 
-  InternalIterator* NewSecondaryIterator(const Slice& meta_handle) override {
+  InternalIterator* NewSecondaryIterator(
+      const Slice& meta_handle, const Slice& first_level_key) override {
     if (meta_handle.size() != sizeof(FileDescriptor)) {
       return NewErrorInternalIterator(
           Status::Corruption("FileReader invoked with unexpected value"));
     }
     const FileDescriptor* fd =
         reinterpret_cast<const FileDescriptor*>(meta_handle.data());
-    return table_cache_->NewIterator(
+    InternalIterator* iter = table_cache_->NewIterator(
         read_options_, env_options_, icomparator_, *fd, range_del_agg_,
         nullptr /* don't need reference to table */, file_read_hist_,
-        for_compaction_, nullptr /* arena */, skip_filters_, level_);
+        for_compaction_, nullptr /* arena */, skip_filters_, level_,
+        compaction_prefetch_pool_);
+    if (sampled_file_iter_ != nullptr) {
+      // The first level iterator is still positioned at the file whose
+      // descriptor was passed in as `meta_handle`.
+      iter = new TombstoneSamplingIterator(
+          iter, sampled_file_iter_->file_metadata(), false /* arena_mode */);
+    }
+    return iter;
   }
 
   bool PrefixMayMatch(const Slice& internal_key) override {
@@ -545,6 +651,8 @@ class LevelFileIteratorState : public TwoLevelIteratorState {
   bool skip_filters_;
   int level_;
   RangeDelAggregator* range_del_agg_;
+  const LevelFileNumIterator* sampled_file_iter_;
+  ThreadPoolImpl* compaction_prefetch_pool_;
 };
 
 // A wrapper of version builder which references the current version in
@@ -840,10 +948,16 @@ void Version::AddIteratorsForLevel(const ReadOptions& read_options,
     // Merge all level zero files together since they may overlap
     for (size_t i = 0; i < storage_info_.LevelFilesBrief(0).num_files; i++) {
       const auto& file = storage_info_.LevelFilesBrief(0).files[i];
-      merge_iter_builder->AddIterator(cfd_->table_cache()->NewIterator(
+      InternalIterator* iter = cfd_->table_cache()->NewIterator(
           read_options, soptions, cfd_->internal_comparator(), file.fd,
           range_del_agg, nullptr, cfd_->internal_stats()->GetFileReadHist(0),
-          false, arena, false /* skip_filters */, 0 /* level */));
+          false, arena, false /* skip_filters */, 0 /* level */);
+      if (should_sample) {
+        auto* mem = arena->AllocateAligned(sizeof(TombstoneSamplingIterator));
+        iter = new (mem) TombstoneSamplingIterator(
+            iter, file.file_metadata, true /* arena_mode */);
+      }
+      merge_iter_builder->AddIterator(iter);
     }
     if (should_sample) {
       // Count ones for every L0 files. This is done per iterator creation
@@ -858,18 +972,18 @@ void Version::AddIteratorsForLevel(const ReadOptions& read_options,
     // For levels > 0, we can use a concatenating iterator that sequentially
     // walks through the non-overlapping files in the level, opening them
     // lazily.
-    auto* mem = arena->AllocateAligned(sizeof(LevelFileIteratorState));
-    auto* state = new (mem)
-        LevelFileIteratorState(cfd_->table_cache(), read_options, soptions,
-                               cfd_->internal_comparator(),
-                               cfd_->internal_stats()->GetFileReadHist(level),
-                               false /* for_compaction */,
-                               cfd_->ioptions()->prefix_extractor != nullptr,
-                               IsFilterSkipped(level), level, range_del_agg);
-    mem = arena->AllocateAligned(sizeof(LevelFileNumIterator));
+    auto* mem = arena->AllocateAligned(sizeof(LevelFileNumIterator));
     auto* first_level_iter = new (mem) LevelFileNumIterator(
         cfd_->internal_comparator(), &storage_info_.LevelFilesBrief(level),
-        should_sample_file_read());
+        should_sample);
+    mem = arena->AllocateAligned(sizeof(LevelFileIteratorState));
+    auto* state = new (mem) LevelFileIteratorState(
+        cfd_->table_cache(), read_options, soptions,
+        cfd_->internal_comparator(),
+        cfd_->internal_stats()->GetFileReadHist(level),
+        false /* for_compaction */,
+        cfd_->ioptions()->prefix_extractor != nullptr, IsFilterSkipped(level),
+        level, range_del_agg, should_sample ? first_level_iter : nullptr);
     merge_iter_builder->AddIterator(
         NewTwoLevelIterator(state, first_level_iter, arena, false));
   }
@@ -997,12 +1111,15 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
     if (get_context.sample()) {
       sample_file_read_inc(f->file_metadata);
     }
-    *status = table_cache_->Get(
-        read_options, *internal_comparator(), f->fd, ikey, &get_context,
-        cfd_->internal_stats()->GetFileReadHist(fp.GetHitFileLevel()),
-        IsFilterSkipped(static_cast<int>(fp.GetHitFileLevel()),
-                        fp.IsHitFileLastInLevel()),
-        fp.GetCurrentLevel());
+    {
+      PERF_COUNTER_BY_LEVEL_GUARD(static_cast<int>(fp.GetHitFileLevel()));
+      *status = table_cache_->Get(
+          read_options, *internal_comparator(), f->fd, ikey, &get_context,
+          cfd_->internal_stats()->GetFileReadHist(fp.GetHitFileLevel()),
+          IsFilterSkipped(static_cast<int>(fp.GetHitFileLevel()),
+                          fp.IsHitFileLastInLevel()),
+          fp.GetCurrentLevel());
+    }
     // TODO: examine the behavior for corrupted key
     if (!status->ok()) {
       return;
@@ -1104,6 +1221,9 @@ bool Version::MaybeInitializeFileMetaData(FileMetaData* file_meta) {
   if (tp.get() == nullptr) return false;
   file_meta->num_entries = tp->num_entries;
   file_meta->num_deletions = GetDeletedKeys(tp->user_collected_properties);
+  file_meta->num_range_deletions = tp->num_range_deletions;
+  file_meta->range_del_smallest_key = tp->range_del_smallest_key;
+  file_meta->range_del_largest_key = tp->range_del_largest_key;
   file_meta->raw_value_size = tp->raw_value_size;
   file_meta->raw_key_size = tp->raw_key_size;
 
@@ -1215,9 +1335,56 @@ void VersionStorageInfo::ComputeCompensatedSizes() {
               (file_meta->num_deletions * 2 - file_meta->num_entries) *
               average_value_size * kDeletionWeightOnCompaction;
         }
+        // Range deletions can cover an arbitrary amount of data, so their
+        // entry count says nothing about how much space they free. Instead,
+        // boost the size by the data in lower levels they may reclaim.
+        if (file_meta->num_range_deletions > 0) {
+          file_meta->compensated_file_size +=
+              EstimateLiveDataCoveredByRangeDeletions(level, file_meta);
+        }
+      }
+    }
+  }
+}
+
+uint64_t VersionStorageInfo::EstimateLiveDataCoveredByRangeDeletions(
+    int level, const FileMetaData* file_meta) const {
+  // Count lower-level files that lie entirely within [smallest begin key,
+  // largest end key) of the file's range deletions. Partially overlapping
+  // files are not counted. Tables written before the bounds were recorded
+  // get no boost.
+  if (file_meta->range_del_largest_key.empty()) {
+    return 0;
+  }
+  const Slice begin_key = file_meta->range_del_smallest_key;
+  const Slice end_key = file_meta->range_del_largest_key;
+  const InternalKey begin_ikey(begin_key, kMaxSequenceNumber,
+                               kValueTypeForSeek);
+  uint64_t covered_bytes = 0;
+  for (int lower_level = level + 1; lower_level < num_levels_;
+       lower_level++) {
+    // level_files_brief_ is not built yet when compensated sizes are
+    // computed, so search files_ directly. Files in levels > 0 are sorted
+    // and do not overlap, so the first candidate is the first file whose
+    // largest key is not before begin_key.
+    const auto& files = files_[lower_level];
+    auto it = std::lower_bound(
+        files.begin(), files.end(), begin_ikey,
+        [this](const FileMetaData* f, const InternalKey& k) {
+          return internal_comparator_->Compare(f->largest, k) < 0;
+        });
+    for (; it != files.end(); ++it) {
+      const FileMetaData* f = *it;
+      if (user_comparator_->Compare(f->largest.user_key(), end_key) >= 0) {
+        // The end key is exclusive, and later files end even further.
+        break;
+      }
+      if (user_comparator_->Compare(f->smallest.user_key(), begin_key) >= 0) {
+        covered_bytes += f->fd.GetFileSize();
       }
     }
   }
+  return covered_bytes;
 }
 
 int VersionStorageInfo::MaxInputLevel() const {
@@ -1459,13 +1626,25 @@ void VersionStorageInfo::ComputeFilesMarkedForCompaction() {
 
   for (int level = 0; level <= last_qualify_level; level++) {
     for (auto* f : files_[level]) {
-      if (!f->being_compacted && f->marked_for_compaction) {
+      if (!f->being_compacted &&
+          (f->marked_for_compaction || TooManyTombstonesSkipped(f))) {
         files_marked_for_compaction_.emplace_back(level, f);
       }
     }
   }
 }
 
+bool VersionStorageInfo::TooManyTombstonesSkipped(const FileMetaData* f) {
+  // Mark a file once sampled reads have stepped over more tombstones than
+  // the file has entries, i.e. reads have already paid more than rewriting
+  // the file would cost. The floor keeps small files from being picked on
+  // the strength of a handful of samples.
+  static const uint64_t kMinTombstonesSkipped = 1 << 20;
+  return f->stats.num_tombstones_skipped_sampled.load(
+             std::memory_order_relaxed) >=
+         std::max(f->num_entries, kMinTombstonesSkipped);
+}
+
 namespace {
 
 // used to sort files by size
@@ -1602,6 +1781,29 @@ void SortFileByOverlappingRatio(
                      file_to_order[f2.file->fd.GetNumber()];
             });
 }
+
+// Sort `temp` based on the sampled reads per byte of the files, the oldest
+// files first among the ones read as often
+void SortFileByReadDensity(std::vector<Fsize>* temp) {
+  std::unordered_map<uint64_t, uint64_t> file_to_order;
+  for (auto& f : *temp) {
+    // The reads keep growing while sorting, so they are loaded once here
+    uint64_t num_reads =
+        f.file->stats.num_reads_sampled.load(std::memory_order_relaxed);
+    file_to_order[f.file->fd.GetNumber()] =
+        num_reads * 1024u / (f.file->fd.file_size / 1024u + 1);
+  }
+
+  std::sort(temp->begin(), temp->end(),
+            [&](const Fsize& f1, const Fsize& f2) -> bool {
+              uint64_t order1 = file_to_order[f1.file->fd.GetNumber()];
+              uint64_t order2 = file_to_order[f2.file->fd.GetNumber()];
+              if (order1 != order2) {
+                return order1 < order2;
+              }
+              return f1.file->smallest_seqno < f2.file->smallest_seqno;
+            });
+}
 }  // namespace
 
 void VersionStorageInfo::UpdateFilesByCompactionPri(
@@ -1650,6 +1852,9 @@ void VersionStorageInfo::UpdateFilesByCompactionPri(
         SortFileByOverlappingRatio(*internal_comparator_, files_[level],
                                    files_[level + 1], &temp);
         break;
+      case kColdestFirst:
+        SortFileByReadDensity(&temp);
+        break;
       default:
         assert(false);
     }
@@ -2308,10 +2513,11 @@ VersionSet::VersionSet(const std::string& dbname,
                        const ImmutableDBOptions* db_options,
                        const EnvOptions& storage_options, Cache* table_cache,
                        WriteBufferManager* write_buffer_manager,
-                       WriteController* write_controller)
-    : column_family_set_(
-          new ColumnFamilySet(dbname, db_options, storage_options, table_cache,
-                              write_buffer_manager, write_controller)),
+                       WriteController* write_controller,
+                       BlockCacheTracer* const block_cache_tracer)
+    : column_family_set_(new ColumnFamilySet(
+          dbname, db_options, storage_options, table_cache,
+          write_buffer_manager, write_controller, block_cache_tracer)),
       env_(db_options->env),
       dbname_(dbname),
       db_options_(db_options),
@@ -2690,6 +2896,10 @@ Status VersionSet::Recover(
   for (auto cf : column_families) {
     cf_name_to_options.insert({cf.name, cf.options});
   }
+  // The column family of the stats history does not have to be passed, the
+  // DB opens it internally (see DBOptions::persist_stats_to_disk)
+  cf_name_to_options.insert(
+      {kPersistentStatsColumnFamilyName, PersistentStatsColumnFamilyOptions()});
   // keeps track of column families in manifest that were not found in
   // column families parameters. if those column families are not dropped
   // by subsequent manifest records, Recover() will return failure status
@@ -3579,7 +3789,8 @@ void VersionSet::AddLiveFiles(std::vector<FileDescriptor>* live_list) {
 }
 
 InternalIterator* VersionSet::MakeInputIterator(
-    const Compaction* c, RangeDelAggregator* range_del_agg) {
+    const Compaction* c, RangeDelAggregator* range_del_agg,
+    ThreadPoolImpl* prefetch_pool) {
   auto cfd = c->column_family_data();
   ReadOptions read_options;
   read_options.verify_checksums = true;
@@ -3609,7 +3820,8 @@ InternalIterator* VersionSet::MakeInputIterator(
               nullptr /* table_reader_ptr */,
               nullptr /* no per level latency histogram */,
               true /* for_compaction */, nullptr /* arena */,
-              false /* skip_filters */, (int)which /* level */);
+              false /* skip_filters */, (int)which /* level */,
+              prefetch_pool);
         }
       } else {
         // Create concatenating iterator for the files from this level
@@ -3620,7 +3832,8 @@ InternalIterator* VersionSet::MakeInputIterator(
                 nullptr /* no per level latency histogram */,
                 true /* for_compaction */, false /* prefix enabled */,
                 false /* skip_filters */, (int)which /* level */,
-                range_del_agg),
+                range_del_agg, nullptr /* sampled_file_iter */,
+                prefetch_pool),
             new LevelFileNumIterator(cfd->internal_comparator(),
                                      c->input_levels(which),
                                      false /* don't sample compaction */));
@@ -3731,6 +3944,9 @@ void VersionSet::GetLiveFilesMetaData(std::vector<LiveFileMetaData>* metadata) {
         filemetadata.largestkey = file->largest.user_key().ToString();
         filemetadata.smallest_seqno = file->smallest_seqno;
         filemetadata.largest_seqno = file->largest_seqno;
+        filemetadata.num_reads_sampled =
+            file->stats.num_reads_sampled.load(std::memory_order_relaxed);
+        filemetadata.being_compacted = file->being_compacted;
         metadata->push_back(filemetadata);
       }
     }
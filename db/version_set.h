@@ -50,6 +50,7 @@ namespace log {
 class Writer;
 }
 
+class BlockCacheTracer;
 class Compaction;
 class InternalIterator;
 class LogBuffer;
@@ -62,6 +63,7 @@ class MergeContext;
 class ColumnFamilySet;
 class TableCache;
 class MergeIteratorBuilder;
+class ThreadPoolImpl;
 
 // Return the smallest index i such that file_level.files[i]->largest >= key.
 // Return file_level.num_files if there is no such file.
@@ -119,6 +121,12 @@ class VersionStorageInfo {
 
   void ComputeCompensatedSizes();
 
+  // Estimate the bytes in levels below `level` that the range deletions in
+  // `file_meta` may drop once compacted down, from the bounds of those range
+  // deletions.
+  uint64_t EstimateLiveDataCoveredByRangeDeletions(
+      int level, const FileMetaData* file_meta) const;
+
   // Updates internal structures that keep track of compaction scores
   // We use compaction scores to figure out which compaction to do next
   // REQUIRES: db_mutex held!!
@@ -134,6 +142,10 @@ class VersionStorageInfo {
   // ComputeCompactionScore()
   void ComputeFilesMarkedForCompaction();
 
+  // Returns true if sampled iterators skipped enough tombstones in `f` that
+  // it should be compacted even though nobody marked it.
+  static bool TooManyTombstonesSkipped(const FileMetaData* f);
+
   // Generate level_files_brief_ from files_
   void GenerateLevelFilesBrief();
   // Sort all files for this version based on their file size and
@@ -618,7 +630,8 @@ class VersionSet {
   VersionSet(const std::string& dbname, const ImmutableDBOptions* db_options,
              const EnvOptions& env_options, Cache* table_cache,
              WriteBufferManager* write_buffer_manager,
-             WriteController* write_controller);
+             WriteController* write_controller,
+             BlockCacheTracer* const block_cache_tracer = nullptr);
   ~VersionSet();
 
   // Apply *edit to the current version to form a new descriptor that
@@ -747,8 +760,12 @@ class VersionSet {
 
   // Create an iterator that reads over the compaction inputs for "*c".
   // The caller should delete the iterator when no longer needed.
+  // If `prefetch_pool` is not nullptr, input files opened with
+  // compaction_readahead_size have their next readahead window read on it.
+  // It must outlive the iterator.
   InternalIterator* MakeInputIterator(const Compaction* c,
-                                      RangeDelAggregator* range_del_agg);
+                                      RangeDelAggregator* range_del_agg,
+                                      ThreadPoolImpl* prefetch_pool = nullptr);
 
   // Add all files listed in any live version to *live.
   void AddLiveFiles(std::vector<FileDescriptor>* live_list);
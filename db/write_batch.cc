@@ -948,6 +948,7 @@ public:
       return seek_status;
     }
 
+    SampleWrite(key);
     MemTable* mem = cf_mems_->GetMemTable();
     auto* moptions = mem->GetMemTableOptions();
     if (!moptions->inplace_update_support) {
@@ -1005,6 +1006,7 @@ public:
 
   Status DeleteImpl(uint32_t column_family_id, const Slice& key,
                     const Slice& value, ValueType delete_type) {
+    SampleWrite(key);
     MemTable* mem = cf_mems_->GetMemTable();
     mem->Add(sequence_, delete_type, key, value, concurrent_memtable_writes_,
              get_post_process_info(mem));
@@ -1090,6 +1092,7 @@ public:
       return seek_status;
     }
 
+    SampleWrite(key);
     MemTable* mem = cf_mems_->GetMemTable();
     auto* moptions = mem->GetMemTableOptions();
     bool perform_merge = false;
@@ -1159,6 +1162,15 @@ public:
     return Status::OK();
   }
 
+  // Counts the write of key in the key range hotness of the current column
+  // family, except in recovery
+  void SampleWrite(const Slice& key) {
+    auto* cfd = cf_mems_->current();
+    if (cfd != nullptr && recovering_log_number_ == 0) {
+      cfd->key_range_hotness()->SampleWrite(key);
+    }
+  }
+
   void CheckMemtableFull() {
     if (flush_scheduler_ != nullptr) {
       auto* cfd = cf_mems_->current();
@@ -630,6 +630,11 @@ class PosixEnv : public Env {
                         Priority pri = LOW, void* tag = nullptr,
                         void (*unschedFunction)(void* arg) = 0) override;
 
+  virtual void ScheduleWithUrgency(void (*function)(void* arg1), void* arg,
+                                   Priority pri, void* tag,
+                                   void (*unschedFunction)(void* arg),
+                                   double urgency) override;
+
   virtual int UnSchedule(void* arg, Priority pri) override;
 
   virtual void StartThread(void (*function)(void* arg), void* arg) override;
@@ -887,6 +892,14 @@ void PosixEnv::Schedule(void (*function)(void* arg1), void* arg, Priority pri,
   thread_pools_[pri].Schedule(function, arg, tag, unschedFunction);
 }
 
+void PosixEnv::ScheduleWithUrgency(void (*function)(void* arg1), void* arg,
+                                   Priority pri, void* tag,
+                                   void (*unschedFunction)(void* arg),
+                                   double urgency) {
+  assert(pri >= Priority::BOTTOM && pri <= Priority::HIGH);
+  thread_pools_[pri].Schedule(function, arg, tag, unschedFunction, urgency);
+}
+
 int PosixEnv::UnSchedule(void* arg, Priority pri) {
   return thread_pools_[pri].UnSchedule(arg);
 }
@@ -171,6 +171,61 @@ TEST_P(EnvPosixTestWithParam, UnSchedule) {
   WaitThreadPoolsEmpty();
 }
 
+namespace {
+struct RunOrderRecorder {
+  port::Mutex mu;
+  std::vector<int> order;
+};
+
+struct RunOrderTask {
+  RunOrderRecorder* recorder;
+  int id;
+};
+
+void RecordRunOrder(void* arg) {
+  auto* task = reinterpret_cast<RunOrderTask*>(arg);
+  MutexLock l(&task->recorder->mu);
+  task->recorder->order.push_back(task->id);
+}
+}  // namespace
+
+TEST_P(EnvPosixTestWithParam, ScheduleWithUrgency) {
+  env_->SetBackgroundThreads(1, Env::LOW);
+
+  // Block the low priority queue so that all tasks below are queued
+  test::SleepingBackgroundTask sleeping_task;
+  env_->Schedule(&test::SleepingBackgroundTask::DoSleepTask, &sleeping_task,
+                 Env::Priority::LOW);
+  sleeping_task.WaitUntilSleeping();
+
+  RunOrderRecorder recorder;
+  RunOrderTask tasks[] = {{&recorder, 0}, {&recorder, 1}, {&recorder, 2},
+                          {&recorder, 3}, {&recorder, 4}};
+  env_->ScheduleWithUrgency(&RecordRunOrder, &tasks[0], Env::Priority::LOW,
+                            nullptr, nullptr, 1.0);
+  env_->Schedule(&RecordRunOrder, &tasks[1], Env::Priority::LOW);
+  env_->ScheduleWithUrgency(&RecordRunOrder, &tasks[2], Env::Priority::LOW,
+                            nullptr, nullptr, 3.0);
+  env_->ScheduleWithUrgency(&RecordRunOrder, &tasks[3], Env::Priority::LOW,
+                            nullptr, nullptr, 1.0);
+  env_->ScheduleWithUrgency(&RecordRunOrder, &tasks[4], Env::Priority::LOW,
+                            nullptr, nullptr, 3.0);
+  ASSERT_EQ(5U, env_->GetThreadPoolQueueLen(Env::Priority::LOW));
+
+  sleeping_task.WakeUp();
+  while (true) {
+    {
+      MutexLock l(&recorder.mu);
+      if (recorder.order.size() == 5) {
+        break;
+      }
+    }
+    Env::Default()->SleepForMicroseconds(kDelayMicros);
+  }
+  // Most urgent first, scheduling order among equally urgent tasks
+  ASSERT_EQ(std::vector<int>({2, 4, 0, 3, 1}), recorder.order);
+}
+
 TEST_P(EnvPosixTestWithParam, RunMany) {
   std::atomic<int> last_id(0);
 
@@ -54,6 +54,11 @@ enum CompactionPri : char {
   // and its size is the smallest. It in many cases can optimize write
   // amplification.
   kMinOverlappingRatio = 0x3,
+  // First compact files with the fewest sampled reads per byte, so that cold
+  // key ranges move down to the last levels while hot ones stay in the upper
+  // levels, where they are cheaper to read. Try this if your reads are skewed
+  // to some key ranges.
+  kColdestFirst = 0x4,
 };
 
 struct CompactionOptionsFIFO {
@@ -544,6 +549,16 @@ struct AdvancedColumnFamilyOptions {
   // Default: false
   bool report_bg_io_stats = false;
 
+  // If set, about one in 1024 reads and writes of the column family is
+  // sampled and counted by the prefix of its key returned by this extractor,
+  // as reported by the "rocksdb.key-range-hotness" property. Keys outside of
+  // its domain are counted together, and so are the prefixes after the first
+  // 4096 ones seen. Reads are sampled by Get(), MultiGet() and iterator
+  // seeks, writes by each key of a write batch.
+  //
+  // Default: nullptr (disable)
+  std::shared_ptr<const SliceTransform> key_hotness_prefix_extractor = nullptr;
+
   // Create ColumnFamilyOptions with default values for all fields
   AdvancedColumnFamilyOptions();
   // Create ColumnFamilyOptions from Options
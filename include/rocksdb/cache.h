@@ -25,6 +25,7 @@
 #include <stdint.h>
 #include <memory>
 #include <string>
+#include "rocksdb/memory_allocator.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/statistics.h"
 #include "rocksdb/status.h"
@@ -32,6 +33,7 @@
 namespace rocksdb {
 
 class Cache;
+enum CompressionType : unsigned char;
 
 // Create a new cache with a fixed size capacity. The cache is sharded
 // to 2^num_shard_bits shards, by hash of the key. The total capacity
@@ -41,10 +43,54 @@ class Cache;
 // high_pri_pool_pct.
 // num_shard_bits = -1 means it is automatically determined: every shard
 // will be at least 512KB and number of shard bits will not exceed 6.
-extern std::shared_ptr<Cache> NewLRUCache(size_t capacity,
-                                          int num_shard_bits = -1,
-                                          bool strict_capacity_limit = false,
-                                          double high_pri_pool_ratio = 0.0);
+// If memory_allocator is not nullptr, block-based tables allocate the blocks
+// they insert into the cache with it (see NewPooledMemoryAllocator()).
+extern std::shared_ptr<Cache> NewLRUCache(
+    size_t capacity, int num_shard_bits = -1,
+    bool strict_capacity_limit = false, double high_pri_pool_ratio = 0.0,
+    std::shared_ptr<MemoryAllocator> memory_allocator = nullptr);
+
+struct CompressedTierOptions {
+  CompressedTierOptions();
+
+  // How entries are compressed in the tier. If the compression type is not
+  // supported, or an entry does not compress well, it is kept uncompressed.
+  // Entries are compressed on the thread whose insert, release or capacity
+  // change evicted them, so reads that miss the cache pay for it. Use
+  // kNoCompression to keep evicted entries without that cost.
+  //
+  // Default: kLZ4Compression
+  CompressionType compression_type;
+
+  // Fraction of the capacity given to the compressed tier at first
+  //
+  // Default: 0.25
+  double initial_ratio;
+
+  // If true, the split between the tiers is adjusted as the cache runs:
+  // the compressed tier grows while the entries it keeps are often looked
+  // up again, and shrinks while they are not. The fraction of the capacity
+  // given to it stays within [min_ratio, max_ratio].
+  //
+  // Default: true
+  bool adaptive;
+  double min_ratio;  // Default: 0.05
+  double max_ratio;  // Default: 0.6
+};
+
+// Similar to NewLRUCache, but entries that the cache evicts for room are
+// compressed and kept in a second, compressed tier, out of the same
+// capacity. A lookup that hits the compressed tier decompresses the entry
+// and moves it back to the uncompressed tier. Only entries inserted with a
+// CacheItemHelper that can save them (like data blocks of block-based
+// tables) go to the compressed tier.
+//
+// Return nullptr if the options are invalid.
+extern std::shared_ptr<Cache> NewCompressedTieredCache(
+    size_t capacity, const CompressedTierOptions& tier_options,
+    int num_shard_bits = -1, bool strict_capacity_limit = false,
+    double high_pri_pool_ratio = 0.0,
+    std::shared_ptr<MemoryAllocator> memory_allocator = nullptr);
 
 // Similar to NewLRUCache, but create a cache based on CLOCK algorithm with
 // better concurrent performance in some cases. See util/clock_cache.cc for
@@ -61,7 +107,8 @@ class Cache {
   // likely to get evicted than low priority entries.
   enum class Priority { HIGH, LOW };
 
-  Cache() {}
+  explicit Cache(std::shared_ptr<MemoryAllocator> allocator = nullptr)
+      : memory_allocator_(std::move(allocator)) {}
 
   // Destroys all existing entries by calling the "deleter"
   // function that was passed via the Insert() function.
@@ -72,6 +119,25 @@ class Cache {
   // Opaque handle to an entry stored in the cache.
   struct Handle {};
 
+  // Tells a cache how to save an entry and create it again, so that it can
+  // keep the entry in another form after evicting it (see
+  // NewCompressedTieredCache()). The callbacks must be thread-safe.
+  struct CacheItemHelper {
+    // Called when the entry is no longer needed, as with Insert()
+    void (*del_cb)(const Slice& key, void* value);
+    // Returns the size of the saved form of the value, or 0 if it cannot
+    // be saved
+    size_t (*size_cb)(void* value);
+    // Writes the saved form of the value, which is size_cb(value) bytes
+    void (*saveto_cb)(void* value, char* out);
+    // Creates a value from its saved form and returns its charge.
+    // create_context is the one passed to LookupWithHelper(). The value
+    // should be allocated with allocator, the cache's memory_allocator().
+    Status (*create_cb)(const Slice& data, void* create_context,
+                        MemoryAllocator* allocator, void** value,
+                        size_t* charge);
+  };
+
   // The type of the Cache
   virtual const char* Name() const = 0;
 
@@ -95,6 +161,15 @@ class Cache {
                         Handle** handle = nullptr,
                         Priority priority = Priority::LOW) = 0;
 
+  // Like Insert() above, but the entry may be saved with helper when it is
+  // evicted. The default implementation ignores all but helper->del_cb.
+  virtual Status InsertWithHelper(const Slice& key, void* value,
+                                  const CacheItemHelper* helper, size_t charge,
+                                  Handle** handle = nullptr,
+                                  Priority priority = Priority::LOW) {
+    return Insert(key, value, charge, helper->del_cb, handle, priority);
+  }
+
   // If the cache has no mapping for "key", returns nullptr.
   //
   // Else return a handle that corresponds to the mapping.  The caller
@@ -104,6 +179,16 @@ class Cache {
   // function.
   virtual Handle* Lookup(const Slice& key, Statistics* stats = nullptr) = 0;
 
+  // Like Lookup() above, but if the entry was saved when it was evicted,
+  // creates it again with helper and create_context and inserts it back.
+  // The default implementation ignores helper and create_context.
+  virtual Handle* LookupWithHelper(const Slice& key,
+                                   const CacheItemHelper* helper,
+                                   void* create_context,
+                                   Statistics* stats = nullptr) {
+    return Lookup(key, stats);
+  }
+
   // Increments the reference count for the handle if it refers to an entry in
   // the cache. Returns true if refcount was incremented; otherwise, returns
   // false.
@@ -191,10 +276,16 @@ class Cache {
   // in tests. The default implementation does nothing.
   virtual void TEST_mark_as_data_block(const Slice& key, size_t charge) {}
 
+  // The allocator for the memory of cached blocks, or nullptr for the
+  // default. It outlives the entries of the cache.
+  MemoryAllocator* memory_allocator() const { return memory_allocator_.get(); }
+
  private:
   // No copying allowed
   Cache(const Cache&);
   Cache& operator=(const Cache&);
+
+  std::shared_ptr<MemoryAllocator> memory_allocator_;
 };
 
 }  // namespace rocksdb
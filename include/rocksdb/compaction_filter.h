@@ -54,6 +54,10 @@ class CompactionFilter {
     bool is_manual_compaction;
     // Which column family this compaction is for.
     uint32_t column_family_id;
+    // The id of the compaction job, as in the CompactionJobInfo passed to
+    // EventListener::OnCompactionCompleted(). It is 0 for the compactions
+    // run by DB::CompactFiles().
+    int job_id;
   };
 
   virtual ~CompactionFilter() {}
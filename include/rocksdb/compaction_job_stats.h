@@ -75,6 +75,13 @@ struct CompactionJobStats {
   // Time spent on preparing file write (falocate, etc)
   uint64_t file_prepare_write_nanos;
 
+  // Time spent on input file's Read() call.
+  uint64_t file_read_nanos;
+
+  // Part of file_read_nanos spent waiting for background readahead of input
+  // files.
+  uint64_t file_prefetch_wait_nanos;
+
   // 0-terminated strings storing the first 8 bytes of the smallest and
   // largest key in the output.
   static const size_t kMaxPrefixLength = 8;
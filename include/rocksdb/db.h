@@ -22,7 +22,9 @@
 #include "rocksdb/options.h"
 #include "rocksdb/snapshot.h"
 #include "rocksdb/sst_file_writer.h"
+#include "rocksdb/stats_history.h"
 #include "rocksdb/thread_status.h"
+#include "rocksdb/trace_reader_writer.h"
 #include "rocksdb/transaction_log.h"
 #include "rocksdb/types.h"
 #include "rocksdb/version.h"
@@ -576,6 +578,12 @@ class DB {
     //      specified level "N" at the target column family.
     static const std::string kAggregatedTablePropertiesAtLevel;
 
+    //  "rocksdb.key-range-hotness" - returns a multi-line string with the
+    //      estimated reads of each SST file of the column family, by level,
+    //      from sampled reads, and the estimated reads and writes of each key
+    //      prefix (see ColumnFamilyOptions::key_hotness_prefix_extractor).
+    static const std::string kKeyRangeHotness;
+
     //  "rocksdb.actual-delayed-write-rate" - returns the current actual delayed
     //      write rate. 0 means no delay.
     static const std::string kActualDelayedWriteRate;
@@ -1112,6 +1120,49 @@ class DB {
 
 #endif  // ROCKSDB_LITE
 
+  // Starts recording the operations on the DB to trace_writer: writes
+  // (Put, Delete, Merge, Write, ...), Get()s and iterator Seek()s and
+  // SeekForPrev()s, each with its time and column family. The trace can be
+  // replayed with the db_replay tool. Only one trace can run at a time.
+  virtual Status StartTrace(const TraceOptions& options,
+                            std::unique_ptr<TraceWriter>&& trace_writer) {
+    return Status::NotSupported("StartTrace() is not implemented.");
+  }
+
+  // Stops the trace started by StartTrace() and closes its TraceWriter
+  virtual Status EndTrace() {
+    return Status::NotSupported("EndTrace() is not implemented.");
+  }
+
+  // Starts recording the lookups of blocks in the block cache by the tables
+  // of the DB to trace_writer: the block, its type (data, index or filter),
+  // size, level and column family, the operation that read it and whether it
+  // was a hit. TraceOptions::sampling_frequency samples blocks, not lookups.
+  // The trace can be analyzed with the block_cache_trace_analyzer tool. Only
+  // one block cache trace can run at a time.
+  virtual Status StartBlockCacheTrace(
+      const TraceOptions& options,
+      std::unique_ptr<TraceWriter>&& trace_writer) {
+    return Status::NotSupported("StartBlockCacheTrace() is not implemented.");
+  }
+
+  // Stops the trace started by StartBlockCacheTrace() and closes its
+  // TraceWriter
+  virtual Status EndBlockCacheTrace() {
+    return Status::NotSupported("EndBlockCacheTrace() is not implemented.");
+  }
+
+  // Returns in *stats_iterator the snapshots of the stats history taken at
+  // start_time <= time < end_time, in seconds since the epoch (see
+  // DBOptions::stats_persist_period_sec). The history is read from the
+  // hidden column family if DBOptions::persist_stats_to_disk is set, and
+  // from memory otherwise.
+  virtual Status GetStatsHistory(
+      uint64_t start_time, uint64_t end_time,
+      std::unique_ptr<StatsHistoryIterator>* stats_iterator) {
+    return Status::NotSupported("GetStatsHistory() is not implemented.");
+  }
+
   // Needed for StackableDB
   virtual DB* GetRootDB() { return this; }
 
@@ -306,6 +306,18 @@ class Env {
                         Priority pri = LOW, void* tag = nullptr,
                         void (*unschedFunction)(void* arg) = 0) = 0;
 
+  // Same as Schedule(), but jobs waiting in the same thread pool start in
+  // order of decreasing "urgency", and in scheduling order among jobs of
+  // equal urgency. The urgency of a job is fixed when it is scheduled and is
+  // not updated while the job waits. The default implementation ignores
+  // "urgency".
+  virtual void ScheduleWithUrgency(void (*function)(void* arg), void* arg,
+                                   Priority pri, void* tag,
+                                   void (*unschedFunction)(void* arg),
+                                   double urgency) {
+    Schedule(function, arg, pri, tag, unschedFunction);
+  }
+
   // Arrange to remove jobs for given arg from the queue_ if they are not
   // already scheduled. Caller is expected to have exclusive lock on arg.
   virtual int UnSchedule(void* arg, Priority pri) { return 0; }
@@ -991,6 +1003,12 @@ class EnvWrapper : public Env {
     return target_->Schedule(f, a, pri, tag, u);
   }
 
+  void ScheduleWithUrgency(void (*f)(void* arg), void* a, Priority pri,
+                           void* tag, void (*u)(void* arg),
+                           double urgency) override {
+    return target_->ScheduleWithUrgency(f, a, pri, tag, u, urgency);
+  }
+
   int UnSchedule(void* tag, Priority pri) override {
     return target_->UnSchedule(tag, pri);
   }
@@ -1159,6 +1177,18 @@ Status NewHdfsEnv(Env** hdfs_env, const std::string& fsname);
 // This is a factory method for TimedEnv defined in utilities/env_timed.cc.
 Env* NewTimedEnv(Env* base_env);
 
+// Returns a new environment that records each file operation (file, offset,
+// length, latency, type and operation of the calling thread) into a trace
+// at trace_filename, written through base_env. The trace keeps the latest
+// records within max_trace_file_size bytes, and can be read by the
+// io_trace_analyzer tool. The operation of the threads is only known with
+// DBOptions::enable_thread_tracking. The caller owns *result, and the trace
+// is complete once *result is deleted.
+// This is a factory method for IOTracingEnv defined in
+// utilities/env_io_tracing.cc.
+Status NewIOTracingEnv(Env* base_env, const std::string& trace_filename,
+                       uint64_t max_trace_file_size, Env** result);
+
 }  // namespace rocksdb
 
 #endif  // STORAGE_ROCKSDB_INCLUDE_ENV_H_
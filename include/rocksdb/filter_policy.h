@@ -112,6 +112,13 @@ class FilterPolicy {
     return nullptr;
   }
 
+  // Same as GetFilterBitsBuilder(), but called with the LSM level the
+  // table file is being written to (-1 if unknown), so that a policy can
+  // trade memory for accuracy per level. The default ignores the level.
+  virtual FilterBitsBuilder* GetFilterBitsBuilderForLevel(int level) const {
+    return GetFilterBitsBuilder();
+  }
+
   // Get the FilterBitsReader, which is ONLY used for full filter block
   // It contains interface to tell if key can be in filter
   // The input slice should NOT be deleted by FilterPolicy
@@ -140,6 +147,24 @@ class FilterPolicy {
 // trailing spaces in keys.
 extern const FilterPolicy* NewBloomFilterPolicy(int bits_per_key,
     bool use_block_based_builder = true);
+
+// Return a new filter policy that uses a static XOR filter with
+// approximately the specified number of bits per key. An XOR filter needs
+// about 1.23 * log2(1/fp_rate) bits per key, so at the same false positive
+// rate it is ~20% smaller than the bloom filter (e.g. 10 bits per key
+// yields ~0.4% instead of ~1%, and 8 bits per key ~1.6%).
+//
+// bits_per_key: bits per key used when the level is unknown or is not
+// covered by bits_per_key_per_level.
+// bits_per_key_per_level: optional override indexed by the LSM level of the
+// table file being written. Levels beyond the end of the vector use its
+// last element, so {10, 10, 10, 6} makes every level from L3 down use 6
+// bits per key. A value <= 0 writes a filter that matches every key.
+//
+// The policy always builds full (or partitioned) filter blocks.
+// The same caveats about custom comparators as NewBloomFilterPolicy apply.
+extern const FilterPolicy* NewXorFilterPolicy(
+    int bits_per_key, const std::vector<int>& bits_per_key_per_level = {});
 }
 
 #endif  // STORAGE_ROCKSDB_INCLUDE_FILTER_POLICY_H_
@@ -36,6 +36,8 @@ struct IOStatsContext {
   uint64_t write_nanos;
   // time spent in read() and pread()
   uint64_t read_nanos;
+  // time spent waiting for reads issued by background readahead.
+  uint64_t prefetch_wait_nanos;
   // time spent in sync_file_range().
   uint64_t range_sync_nanos;
   // time spent in fsync
@@ -0,0 +1,74 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stddef.h>
+#include <memory>
+
+namespace rocksdb {
+
+// MemoryAllocator is an interface that a client can implement to supply the
+// memory of the blocks that a block cache holds (see NewLRUCache()). Block-
+// based tables also use the allocator of their block cache for blocks they
+// read and decompress without inserting them into the cache.
+//
+// All methods must be thread-safe. The allocator must stay alive as long as
+// any memory it allocated; a cache keeps its allocator alive until all of its
+// entries are freed.
+class MemoryAllocator {
+ public:
+  virtual ~MemoryAllocator() {}
+
+  // Name of the allocator, for logging
+  virtual const char* Name() const = 0;
+
+  // Allocates a block of at least `size` bytes. The block is suitably
+  // aligned for any object type. Returns nullptr if the allocator cannot
+  // allocate the block, in which case RocksDB allocates it with new[].
+  virtual void* Allocate(size_t size) = 0;
+
+  // Frees a block returned by Allocate()
+  virtual void Deallocate(void* p) = 0;
+
+  // Returns the memory that the block at `p` takes up, which is charged to
+  // the block cache. `allocation_size` is the size passed to Allocate().
+  virtual size_t UsableSize(void* /*p*/, size_t allocation_size) const {
+    return allocation_size;
+  }
+};
+
+struct PooledMemoryAllocatorOptions {
+  // Allocations up to this size are rounded up to one of a set of size
+  // classes (four per power of two), and freed blocks are kept in a free
+  // list of their class for reuse. Larger allocations go to malloc().
+  //
+  // Default: 1MB
+  size_t max_pooled_size = 1 << 20;
+
+  // The most memory that the free lists keep. Blocks freed beyond it go
+  // back to malloc(). With use_transparent_huge_pages, a chunk goes back to
+  // the system once the free lists are beyond it and none of the chunk's
+  // blocks is in use, so they may keep more while chunks are partly used.
+  //
+  // Default: 64MB
+  size_t max_free_bytes = 64 << 20;
+
+  // If true, pooled blocks are carved from 2MB chunks that are aligned and
+  // advised to be backed by transparent huge pages (madvise(MADV_HUGEPAGE)
+  // on Linux), which reduces TLB misses when scanning a large block cache.
+  //
+  // Default: false
+  bool use_transparent_huge_pages = false;
+};
+
+// Returns an allocator that recycles freed blocks by size class, so that a
+// block cache that keeps evicting and loading blocks of similar sizes does
+// not go through malloc() and free() for each of them.
+extern std::shared_ptr<MemoryAllocator> NewPooledMemoryAllocator(
+    const PooledMemoryAllocatorOptions& options =
+        PooledMemoryAllocatorOptions());
+
+}  // namespace rocksdb
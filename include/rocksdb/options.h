@@ -46,6 +46,7 @@ class MemTableRepFactory;
 class RateLimiter;
 class Slice;
 class Statistics;
+class ThreadPool;
 class InternalKeyComparator;
 class WalFilter;
 
@@ -613,6 +614,38 @@ struct DBOptions {
   // Default: 600 (10 min)
   unsigned int stats_dump_period_sec = 600;
 
+  // If not zero, take a snapshot of the statistics every
+  // stats_persist_period_sec and keep it in the stats history, which
+  // DB::GetStatsHistory() returns. A snapshot holds the change of each ticker
+  // of `statistics` since the previous snapshot (tickers that did not change
+  // are left out), and the value of these integer properties at the time of
+  // the snapshot: rocksdb.cur-size-all-mem-tables, rocksdb.estimate-num-keys,
+  // rocksdb.total-sst-files-size and rocksdb.estimate-pending-compaction-bytes,
+  // summed over the column families, and rocksdb.num-running-flushes,
+  // rocksdb.num-running-compactions, rocksdb.actual-delayed-write-rate and
+  // rocksdb.is-write-stopped. The snapshots are taken by a timer thread,
+  // which is only started when this is not zero.
+  // Default: 0 (no stats history)
+  unsigned int stats_persist_period_sec = 0;
+
+  // If true, the stats history is written to a hidden column family,
+  // "___rocksdb_stats_history___", where it survives restarts, instead of
+  // being kept in memory. The column family is opened internally, so it does
+  // not have to be passed to DB::Open(), and it is left out of the
+  // properties summed over the column families. The snapshots are written
+  // with WriteOptions::no_slowdown, so a snapshot taken during a write stall
+  // is dropped, and they are not recorded by DB::StartTrace().
+  // Default: false
+  bool persist_stats_to_disk = false;
+
+  // The stats history drops its oldest snapshots once it takes more than
+  // stats_history_buffer_size bytes: the memory of the snapshots in memory,
+  // or the size of their keys and values with persist_stats_to_disk, where
+  // the dropped snapshots are deleted with a range deletion. 0 keeps no
+  // history.
+  // Default: 1MB
+  size_t stats_history_buffer_size = 1024 * 1024;
+
   // If set true, will hint the underlying file system that the file
   // access pattern is random, when a sst file is opened.
   // Default: true
@@ -679,6 +712,14 @@ struct DBOptions {
   // Default: 0
   size_t compaction_readahead_size = 0;
 
+  // If non-zero and compaction_readahead_size is non-zero, compactions read
+  // the next readahead window of their input files on a pool of this many
+  // threads, shared by all compactions of the DB, while the current window
+  // is processed. With 0, input files are read ahead synchronously.
+  //
+  // Default: 1
+  int compaction_readahead_threads = 1;
+
   // This is a maximum buffer size that is used by WinMmapReadableFile in
   // unbuffered disk I/O mode. We need to maintain an aligned buffer for
   // reads. We allow the buffer to grow until the specified value and then
@@ -1053,6 +1094,40 @@ struct ReadOptions {
   // Default: false
   bool ignore_range_deletions;
 
+  // If non-nullptr, the indexes of the columns of
+  // BlockBasedTableOptions::value_columns that the read needs, in
+  // ascending order. Data blocks of column-aware tables that are not
+  // inserted into the block cache then decode only these columns; in
+  // values read from them, the other columns are zero-filled (fixed-length)
+  // or empty (variable-length), and the bytes past the last column are
+  // dropped. Values from memtables, from other tables and from the block
+  // cache are returned whole, so only the listed columns are reliable.
+  //
+  // The block cache holds whole blocks only, so the projection applies
+  // only when the table has no block cache or fill_cache is false. With the
+  // defaults (a block cache and fill_cache = true), it has no effect: the
+  // blocks are read from or inserted into the cache decoded in full. Set
+  // fill_cache = false on the reads, e.g. scans, that should decode fewer
+  // columns.
+  // Default: nullptr
+  const std::vector<uint32_t>* column_projection;
+
+  // If non-zero and decompression_thread_pool is not nullptr, an iterator
+  // that scans a block-based table forward reads and decompresses up to this
+  // many of the following data blocks on decompression_thread_pool, and
+  // hands them to the scan in order as it reaches them. A scan is detected
+  // once the iterator moves into the data block right after the previous
+  // one. Useful for long scans over compressed data that is not in the block
+  // cache. Not used with read_tier == kBlockCacheTier.
+  // Default: 0
+  size_t decompression_readahead_blocks;
+
+  // The pool that runs the reads for decompression_readahead_blocks (see
+  // NewThreadPool()). It may be shared by many iterators and must outlive
+  // them.
+  // Default: nullptr
+  ThreadPool* decompression_thread_pool;
+
   ReadOptions();
   ReadOptions(bool cksum, bool cache);
 };
@@ -1117,6 +1192,21 @@ struct FlushOptions {
   FlushOptions() : wait(true) {}
 };
 
+// Options for DB::StartTrace()
+struct TraceOptions {
+  // Tracing stops recording operations once the trace is larger than this.
+  // Default: 64GB
+  uint64_t max_trace_file_size;
+
+  // Record one in every sampling_frequency operations. 1 records them all.
+  // Default: 1
+  uint64_t sampling_frequency;
+
+  TraceOptions()
+      : max_trace_file_size(uint64_t{64} * 1024 * 1024 * 1024),
+        sampling_frequency(1) {}
+};
+
 // Create a Logger from provided DBOptions
 extern Status CreateLoggerFromOptions(const std::string& dbname,
                                       const DBOptions& options,
@@ -13,6 +13,21 @@
 
 namespace rocksdb {
 
+// The counters of the table file reads of Get()s at one level of the LSM
+// tree, see PerfContext::EnablePerLevelPerfContext()
+struct PerfContextByLevel {
+  void Reset();  // reset all performance counters to zero
+
+  uint64_t get_from_table_count;   // number of table files queried
+  uint64_t get_from_table_nanos;   // total nanos spent querying them
+  uint64_t block_cache_hit_count;  // total number of block cache hits
+  uint64_t block_read_count;       // total number of block reads (with IO)
+  uint64_t block_read_byte;        // total number of bytes from block reads
+  uint64_t block_read_time;        // total nanos spent on block reads
+  uint64_t bloom_sst_hit_count;    // total number of SST table bloom hits
+  uint64_t bloom_sst_miss_count;   // total number of SST table bloom misses
+};
+
 // A thread local context for gathering performance counter efficiently
 // and transparently.
 // Use SetPerfLevel(PerfLevel::kEnableTime) to enable time stats.
@@ -23,6 +38,16 @@ struct PerfContext {
 
   std::string ToString(bool exclude_zero_counters = false) const;
 
+  // Break the counters of the table file reads of Get()s down by the level
+  // of the file, into level_to_perf_context, in addition to the totals
+  // below. Counting needs PerfLevel::kEnableCount, and the time
+  // PerfLevel::kEnableTimeExceptForMutex. Off by default.
+  void EnablePerLevelPerfContext();
+  // Stops the per-level breakdown and resets its counters
+  void DisablePerLevelPerfContext();
+  // Resets the per-level counters only
+  void ClearPerLevelPerfContext();
+
   uint64_t user_key_comparison_count; // total number of user key comparisons
   uint64_t block_cache_hit_count;     // total number of block cache hits
   uint64_t block_read_count;          // total number of block reads (with IO)
@@ -153,6 +178,13 @@ struct PerfContext {
   uint64_t env_lock_file_nanos;
   uint64_t env_unlock_file_nanos;
   uint64_t env_new_logger_nanos;
+
+  // The levels broken down, the last one also counts the levels below it
+  static const int kNumPerfContextLevels = 8;
+
+  bool per_level_perf_context_enabled;
+  // The counters of each level, while per_level_perf_context_enabled
+  PerfContextByLevel level_to_perf_context[kNumPerfContextLevels];
 };
 
 // Get Thread-local PerfContext object pointer
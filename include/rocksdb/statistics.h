@@ -223,6 +223,19 @@ enum Tickers : uint32_t {
   // Number of refill intervals where rate limiter's bytes are fully consumed.
   NUMBER_RATE_LIMITER_DRAINS,
 
+  // # of times the full filter of a file did not rule out the key.
+  BLOOM_FILTER_FULL_POSITIVE,
+  // # of those times where the key was actually present in the file.
+  // (BLOOM_FILTER_FULL_POSITIVE - BLOOM_FILTER_FULL_TRUE_POSITIVE) /
+  // (BLOOM_FILTER_FULL_POSITIVE - BLOOM_FILTER_FULL_TRUE_POSITIVE +
+  //  BLOOM_FILTER_USEFUL) is the observed false positive rate.
+  BLOOM_FILTER_FULL_TRUE_POSITIVE,
+
+  // # of block cache hits that were served by the compressed tier of a
+  // cache created with NewCompressedTieredCache(). Also counted in
+  // BLOCK_CACHE_HIT.
+  BLOCK_CACHE_COMPRESSED_TIER_HIT,
+
   TICKER_ENUM_MAX
 };
 
@@ -328,6 +341,10 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
     {READ_AMP_ESTIMATE_USEFUL_BYTES, "rocksdb.read.amp.estimate.useful.bytes"},
     {READ_AMP_TOTAL_READ_BYTES, "rocksdb.read.amp.total.read.bytes"},
     {NUMBER_RATE_LIMITER_DRAINS, "rocksdb.number.rate_limiter.drains"},
+    {BLOOM_FILTER_FULL_POSITIVE, "rocksdb.bloom.filter.full.positive"},
+    {BLOOM_FILTER_FULL_TRUE_POSITIVE,
+     "rocksdb.bloom.filter.full.true.positive"},
+    {BLOCK_CACHE_COMPRESSED_TIER_HIT, "rocksdb.block.cache.compressed.tier.hit"},
 };
 
 /**
@@ -0,0 +1,57 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "rocksdb/status.h"
+
+namespace rocksdb {
+
+// StatsHistoryIterator walks the snapshots of the stats history returned by
+// DB::GetStatsHistory(), in increasing order of time. Each snapshot maps the
+// name of a ticker to its change since the previous snapshot, and the name of
+// a DB property to its value at the time of the snapshot (see
+// DBOptions::stats_persist_period_sec).
+//
+//   std::unique_ptr<StatsHistoryIterator> iter;
+//   db->GetStatsHistory(start_time, end_time, &iter);
+//   for (; iter->Valid(); iter->Next()) {
+//     uint64_t time = iter->GetStatsTime();
+//     for (const auto& stat : iter->GetStatsMap()) { ... }
+//   }
+class StatsHistoryIterator {
+ public:
+  StatsHistoryIterator() {}
+  virtual ~StatsHistoryIterator() {}
+
+  // False once the iterator has passed the last snapshot before the end
+  // time, or hit an error
+  virtual bool Valid() const = 0;
+
+  // Moves to the next snapshot.
+  // REQUIRES: Valid()
+  virtual void Next() = 0;
+
+  // Non-ok if reading the history failed
+  virtual Status status() const = 0;
+
+  // The time of the current snapshot, in seconds since the epoch.
+  // REQUIRES: Valid()
+  virtual uint64_t GetStatsTime() const = 0;
+
+  // The stats of the current snapshot, by name.
+  // REQUIRES: Valid()
+  virtual const std::map<std::string, uint64_t>& GetStatsMap() const = 0;
+
+ private:
+  // No copying allowed
+  StatsHistoryIterator(const StatsHistoryIterator&);
+  void operator=(const StatsHistoryIterator&);
+};
+
+}  // namespace rocksdb
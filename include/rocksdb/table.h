@@ -19,6 +19,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "rocksdb/cache.h"
 #include "rocksdb/env.h"
@@ -48,6 +49,45 @@ enum ChecksumType : char {
   kxxHash = 0x2,
 };
 
+// A column of the values of a block-based table with column-aware data
+// blocks (see BlockBasedTableOptions::value_columns). A value is the
+// concatenation of its columns, in order, optionally followed by more bytes.
+struct ValueColumn {
+  enum Type : unsigned char {
+    // `size` bytes
+    kFixedLength = 0x0,
+    // A varint32 length followed by that many bytes
+    kVariableLength = 0x1,
+  };
+
+  enum Encoding : unsigned char {
+    // The values as they are
+    kPlain = 0x0,
+    // Runs of equal values are stored once with their length
+    kRunLength = 0x1,
+    // The difference to the value of the previous row, read as an unsigned
+    // integer. Only for fixed-length columns of at most 8 bytes.
+    kDelta = 0x2,
+    // The distinct values of a block are stored once, and rows refer to
+    // them by number
+    kDictionary = 0x3,
+  };
+
+  Type type;
+  // Size of a fixed-length column; ignored for variable-length columns
+  uint32_t size;
+  Encoding encoding;
+  // Byte order of the integer that kDelta reads from the column
+  bool big_endian;
+
+  ValueColumn(Type _type = kFixedLength, uint32_t _size = 0,
+              Encoding _encoding = kPlain, bool _big_endian = false)
+      : type(_type),
+        size(_size),
+        encoding(_encoding),
+        big_endian(_big_endian) {}
+};
+
 // For advanced user only
 struct BlockBasedTableOptions {
   // @flush_block_policy_factory creates the instances of flush block policy.
@@ -170,6 +210,48 @@ struct BlockBasedTableOptions {
   // Default: true
   bool use_delta_encoding = true;
 
+  // If true, data and index blocks with enough restart points store a
+  // linear model that maps a key to the approximate position of its
+  // restart point, and seeks binary-search only a few restart points around
+  // that position. This pays off for keys that are spread nearly uniformly,
+  // e.g. fixed-width random keys, in blocks with many restart points, such
+  // as index blocks and data blocks with a small block_restart_interval.
+  // A block gets a model only if it narrows the search down to at most half
+  // of its restart points. Only used with BytewiseComparator(). Blocks with
+  // a model cannot be read by RocksDB versions that predate this option.
+  //
+  // Default: false
+  bool use_learned_index = false;
+
+  // If not zero, the size of every user key of the table. Data blocks whose
+  // keys all have this size store their entries back to back without
+  // per-entry headers or prefix compression, and seeks and iteration index
+  // into them directly instead of decoding entry after entry. If all values
+  // of a block have the same size as well, the block also omits the offsets
+  // of its entries. A block that receives a key of another size falls back
+  // to the regular format, so this is only a hint. Blocks in this format
+  // cannot be read by RocksDB versions that predate this option.
+  //
+  // Default: 0
+  uint32_t fixed_key_size = 0;
+
+  // If not empty, values are rows made of these columns, and data blocks
+  // store the values of their rows column by column, each column with its
+  // own encoding. Columns of similar values encode much better this way,
+  // before and after compression. Values that do not parse as such rows,
+  // e.g. those of deletions, are stored as they are. Blocks are turned back
+  // into rows when they are read, so Get() and iterators work as usual;
+  // ReadOptions::column_projection lets reads that bypass the block cache
+  // (no block cache, or ReadOptions::fill_cache = false) decode only some of
+  // the columns; cached blocks are always decoded in full. Blocks are cut
+  // when their rows reach block_size, as by the default
+  // flush_block_policy_factory, which is not used. Files with column-aware
+  // blocks cannot be read by RocksDB versions that predate this option. Not
+  // supported in option strings.
+  //
+  // Default: empty
+  std::vector<ValueColumn> value_columns;
+
   // If non-nullptr, use the specified filter policy to reduce disk reads.
   // Many applications will benefit from passing the result of
   // NewBloomFilterPolicy() here.
@@ -179,6 +261,23 @@ struct BlockBasedTableOptions {
   // This must generally be true for gets to be efficient.
   bool whole_key_filtering = true;
 
+  // If true, build a range filter over the user keys of each table file.
+  // Iterators with ReadOptions::iterate_upper_bound consult it on Seek() and
+  // skip files that have no key in [target, upper bound) without reading
+  // their index or data blocks, which helps short range scans over many
+  // files. The filter is kept in memory while the file is open, and is only
+  // built and used when the comparator is BytewiseComparator().
+  //
+  // Default: false
+  bool range_filter = false;
+
+  // Number of key bytes the range filter keeps beyond the prefix that
+  // distinguishes a key from its neighbours. Each extra byte makes false
+  // positives for narrow ranges less likely at the cost of a larger filter.
+  //
+  // Default: 1
+  uint32_t range_filter_suffix_bytes = 1;
+
   // Verify that decompressing the compressed block gives back the input. This
   // is a verification mode that we use to detect bugs in compression
   // algorithms.
@@ -207,7 +306,7 @@ struct BlockBasedTableOptions {
   // Default: 0 (disabled)
   uint32_t read_amp_bytes_per_bit = 0;
 
-  // We currently have three versions:
+  // We currently have four versions:
   // 0 -- This version is currently written out by all RocksDB's versions by
   // default.  Can be read by really old RocksDB's. Doesn't support changing
   // checksum (default is CRC32).
@@ -219,6 +318,13 @@ struct BlockBasedTableOptions {
   // encode compressed blocks with LZ4, BZip2 and Zlib compression. If you
   // don't plan to run RocksDB before version 3.10, you should probably use
   // this.
+  // 3 -- Can be read by RocksDB's versions after 5.8.0; 5.8.0 and older
+  // refuse to open such tables. Index blocks store user keys instead of
+  // internal keys when no user key spans two data blocks, and store each
+  // block handle as the change of the block size since the previous index
+  // entry, except at restart points. Use it with index_block_restart_interval
+  // larger than 1 (e.g. 16), since entries at restart points are stored in
+  // full.
   // This option only affects newly written tables. When reading exising tables,
   // the information about version is read from the footer.
   uint32_t format_version = 2;
@@ -502,11 +608,27 @@ class TableFactory {
 //                              a default one.
 // @plain_table_factory: plain table factory to use. If NULL, use a default one.
 // @cuckoo_table_factory: cuckoo table factory to use. If NULL, use a default one.
+// @table_factory_per_level: if not empty, the table factory used when writing
+//                           files of level i is table_factory_per_level[i],
+//                           and levels past its end use its last entry. Flush
+//                           writes level 0 and compactions write their output
+//                           level; files whose level is unknown (e.g. written
+//                           by recovery or repair) use table_factory_to_write.
+//                           A NULL entry also means table_factory_to_write.
+//                           This allows e.g. small blocks with a hash index
+//                           in the upper levels and large blocks in the last
+//                           level (pair it with compression_per_level).
+//                           Files are still read with the three reader
+//                           factories above, picked by their format, so
+//                           block-based entries should differ from
+//                           block_based_table_factory only in options that
+//                           affect writing, such as block_size.
 extern TableFactory* NewAdaptiveTableFactory(
     std::shared_ptr<TableFactory> table_factory_to_write = nullptr,
     std::shared_ptr<TableFactory> block_based_table_factory = nullptr,
     std::shared_ptr<TableFactory> plain_table_factory = nullptr,
-    std::shared_ptr<TableFactory> cuckoo_table_factory = nullptr);
+    std::shared_ptr<TableFactory> cuckoo_table_factory = nullptr,
+    std::vector<std::shared_ptr<TableFactory>> table_factory_per_level = {});
 
 #endif  // ROCKSDB_LITE
 
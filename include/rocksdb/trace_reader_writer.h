@@ -0,0 +1,51 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "rocksdb/env.h"
+
+namespace rocksdb {
+
+// TraceWriter receives the records of a trace started with
+// DB::StartTrace(), one encoded record per Write(). Implementations can
+// store them anywhere; NewFileTraceWriter() writes them to a file.
+class TraceWriter {
+ public:
+  TraceWriter() {}
+  virtual ~TraceWriter() {}
+
+  virtual Status Write(const Slice& data) = 0;
+  virtual Status Close() = 0;
+  // The number of bytes written so far
+  virtual uint64_t GetFileSize() = 0;
+};
+
+// TraceReader returns the records written by a TraceWriter, in order, one
+// per Read(). Read() returns Status::Incomplete at the end of the trace.
+class TraceReader {
+ public:
+  TraceReader() {}
+  virtual ~TraceReader() {}
+
+  virtual Status Read(std::string* data) = 0;
+  virtual Status Close() = 0;
+};
+
+// Create a TraceWriter that writes the trace to the file trace_filename
+extern Status NewFileTraceWriter(Env* env, const EnvOptions& env_options,
+                                 const std::string& trace_filename,
+                                 std::unique_ptr<TraceWriter>* trace_writer);
+
+// Create a TraceReader that reads the trace file written by a TraceWriter
+// from NewFileTraceWriter()
+extern Status NewFileTraceReader(Env* env, const EnvOptions& env_options,
+                                 const std::string& trace_filename,
+                                 std::unique_ptr<TraceReader>* trace_reader);
+
+}  // namespace rocksdb
@@ -2176,6 +2176,8 @@ class CompactionPriorityJni {
         return 0x2;
       case rocksdb::CompactionPri::kMinOverlappingRatio:
         return 0x3;
+      case rocksdb::CompactionPri::kColdestFirst:
+        return 0x4;
       default:
         return 0x0;  // undefined
     }
@@ -2194,6 +2196,8 @@ class CompactionPriorityJni {
         return rocksdb::CompactionPri::kOldestSmallestSeqFirst;
       case 0x3:
         return rocksdb::CompactionPri::kMinOverlappingRatio;
+      case 0x4:
+        return rocksdb::CompactionPri::kColdestFirst;
       default:
         // undefined/default
         return rocksdb::CompactionPri::kByCompensatedSize;
@@ -2477,8 +2481,14 @@ class TickerTypeJni {
         return 0x5B;
       case rocksdb::Tickers::NUMBER_RATE_LIMITER_DRAINS:
         return 0x5C;
-      case rocksdb::Tickers::TICKER_ENUM_MAX:
+      case rocksdb::Tickers::BLOOM_FILTER_FULL_POSITIVE:
         return 0x5D;
+      case rocksdb::Tickers::BLOOM_FILTER_FULL_TRUE_POSITIVE:
+        return 0x5E;
+      case rocksdb::Tickers::BLOCK_CACHE_COMPRESSED_TIER_HIT:
+        return 0x5F;
+      case rocksdb::Tickers::TICKER_ENUM_MAX:
+        return 0x60;
       
       default:
         // undefined/default
@@ -2677,6 +2687,12 @@ class TickerTypeJni {
       case 0x5C:
         return rocksdb::Tickers::NUMBER_RATE_LIMITER_DRAINS;
       case 0x5D:
+        return rocksdb::Tickers::BLOOM_FILTER_FULL_POSITIVE;
+      case 0x5E:
+        return rocksdb::Tickers::BLOOM_FILTER_FULL_TRUE_POSITIVE;
+      case 0x5F:
+        return rocksdb::Tickers::BLOCK_CACHE_COMPRESSED_TIER_HIT;
+      case 0x60:
         return rocksdb::Tickers::TICKER_ENUM_MAX;
 
       default:
@@ -33,7 +33,15 @@ public enum CompactionPriority {
    * and its size is the smallest. It in many cases can optimize write
    * amplification.
    */
-  MinOverlappingRatio((byte)0x3);
+  MinOverlappingRatio((byte)0x3),
+
+  /**
+   * First compact files with the fewest sampled reads per byte, so that cold
+   * key ranges move down to the last levels while hot ones stay in the upper
+   * levels, where they are cheaper to read. Try this if your reads are skewed
+   * to some key ranges.
+   */
+  ColdestFirst((byte)0x4);
 
 
   private final byte value;
@@ -465,7 +465,23 @@ public enum TickerType {
      */
     NUMBER_RATE_LIMITER_DRAINS((byte) 0x5C),
 
-    TICKER_ENUM_MAX((byte) 0x5D);
+    /**
+     * Number of times the full filter of a file did not rule out the key.
+     */
+    BLOOM_FILTER_FULL_POSITIVE((byte) 0x5D),
+
+    /**
+     * Number of times the full filter did not rule out the key and the key
+     * was present in the file.
+     */
+    BLOOM_FILTER_FULL_TRUE_POSITIVE((byte) 0x5E),
+
+    /**
+     * Number of block cache hits that were served by the compressed tier.
+     */
+    BLOCK_CACHE_COMPRESSED_TIER_HIT((byte) 0x5F),
+
+    TICKER_ENUM_MAX((byte) 0x60);
 
 
     private final byte value;
@@ -0,0 +1,56 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// Arena allocations. The argument is the size of each allocation.
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+
+#include "util/arena.h"
+
+namespace rocksdb {
+
+namespace {
+
+// Allocations per arena, so that the arenas are replaced (and their blocks
+// freed) within the measured loop as they would be as memtables are
+const int kAllocationsPerArena = 4096;
+
+}  // namespace
+
+static void BM_ArenaAllocate(benchmark::State& state) {
+  const size_t size = static_cast<size_t>(state.range(0));
+  std::unique_ptr<Arena> arena(new Arena());
+  int allocations = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(arena->Allocate(size));
+    if (++allocations == kAllocationsPerArena) {
+      arena.reset(new Arena());
+      allocations = 0;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ArenaAllocate)->Arg(8)->Arg(64)->Arg(1024);
+
+static void BM_ArenaAllocateAligned(benchmark::State& state) {
+  const size_t size = static_cast<size_t>(state.range(0));
+  std::unique_ptr<Arena> arena(new Arena());
+  int allocations = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(arena->AllocateAligned(size));
+    if (++allocations == kAllocationsPerArena) {
+      arena.reset(new Arena());
+      allocations = 0;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ArenaAllocateAligned)->Arg(8)->Arg(64)->Arg(1024);
+
+}  // namespace rocksdb
+
+BENCHMARK_MAIN();
@@ -0,0 +1,132 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// Varint and fixed-width coding of util/coding.h. The argument is the
+// encoded size of the varints in bytes.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "util/coding.h"
+#include "util/random.h"
+
+namespace rocksdb {
+
+namespace {
+
+const int kNumValues = 4096;
+
+// Values that encode to exactly bytes bytes
+template <typename T>
+std::vector<T> VarintValues(int bytes) {
+  Random64 rnd(301);
+  std::vector<T> values;
+  for (int i = 0; i < kNumValues; i++) {
+    uint64_t low = bytes == 1 ? 0 : uint64_t{1} << (7 * (bytes - 1));
+    uint64_t high = 7 * bytes >= 64 ? ~uint64_t{0}
+                                    : (uint64_t{1} << (7 * bytes)) - 1;
+    high = std::min<uint64_t>(high, static_cast<T>(~T{0}));
+    values.push_back(static_cast<T>(low + rnd.Next() % (high - low + 1)));
+  }
+  return values;
+}
+
+}  // namespace
+
+static void BM_EncodeVarint32(benchmark::State& state) {
+  auto values = VarintValues<uint32_t>(static_cast<int>(state.range(0)));
+  std::string buf(kNumValues * 5, '\0');
+  for (auto _ : state) {
+    char* p = &buf[0];
+    for (uint32_t value : values) {
+      p = EncodeVarint32(p, value);
+    }
+    benchmark::DoNotOptimize(p);
+  }
+  state.SetItemsProcessed(state.iterations() * kNumValues);
+}
+BENCHMARK(BM_EncodeVarint32)->DenseRange(1, 5);
+
+static void BM_DecodeVarint32(benchmark::State& state) {
+  std::string buf;
+  for (uint32_t value :
+       VarintValues<uint32_t>(static_cast<int>(state.range(0)))) {
+    PutVarint32(&buf, value);
+  }
+  for (auto _ : state) {
+    const char* p = buf.data();
+    const char* limit = p + buf.size();
+    uint32_t sum = 0;
+    while (p < limit) {
+      uint32_t value;
+      p = GetVarint32Ptr(p, limit, &value);
+      sum += value;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * kNumValues);
+}
+BENCHMARK(BM_DecodeVarint32)->DenseRange(1, 5);
+
+static void BM_EncodeVarint64(benchmark::State& state) {
+  auto values = VarintValues<uint64_t>(static_cast<int>(state.range(0)));
+  std::string buf(kNumValues * 10, '\0');
+  for (auto _ : state) {
+    char* p = &buf[0];
+    for (uint64_t value : values) {
+      p = EncodeVarint64(p, value);
+    }
+    benchmark::DoNotOptimize(p);
+  }
+  state.SetItemsProcessed(state.iterations() * kNumValues);
+}
+BENCHMARK(BM_EncodeVarint64)->Arg(1)->Arg(3)->Arg(5)->Arg(8)->Arg(10);
+
+static void BM_DecodeVarint64(benchmark::State& state) {
+  std::string buf;
+  for (uint64_t value :
+       VarintValues<uint64_t>(static_cast<int>(state.range(0)))) {
+    PutVarint64(&buf, value);
+  }
+  for (auto _ : state) {
+    const char* p = buf.data();
+    const char* limit = p + buf.size();
+    uint64_t sum = 0;
+    while (p < limit) {
+      uint64_t value;
+      p = GetVarint64Ptr(p, limit, &value);
+      sum += value;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * kNumValues);
+}
+BENCHMARK(BM_DecodeVarint64)->Arg(1)->Arg(3)->Arg(5)->Arg(8)->Arg(10);
+
+static void BM_Fixed64(benchmark::State& state) {
+  auto values = VarintValues<uint64_t>(8);
+  std::string buf(kNumValues * 8, '\0');
+  for (auto _ : state) {
+    char* p = &buf[0];
+    for (uint64_t value : values) {
+      EncodeFixed64(p, value);
+      p += 8;
+    }
+    uint64_t sum = 0;
+    for (const char* q = buf.data(); q < p; q += 8) {
+      sum += DecodeFixed64(q);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * kNumValues);
+}
+BENCHMARK(BM_Fixed64);
+
+}  // namespace rocksdb
+
+BENCHMARK_MAIN();
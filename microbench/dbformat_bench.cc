@@ -0,0 +1,53 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// InternalKeyComparator::Compare() on keys whose user keys differ in their
+// last byte, or are equal so that the sequence numbers decide. The argument
+// is the size of the user keys.
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "rocksdb/comparator.h"
+
+namespace rocksdb {
+
+static void InternalKeyCompare(benchmark::State& state, bool same_user_key) {
+  InternalKeyComparator icmp(BytewiseComparator());
+  std::string user_key(static_cast<size_t>(state.range(0)), 'k');
+  std::string a;
+  AppendInternalKey(&a, ParsedInternalKey(user_key, 100, kTypeValue));
+  if (!same_user_key) {
+    user_key.back() = 'l';
+  }
+  std::string b;
+  AppendInternalKey(&b, ParsedInternalKey(user_key, 99, kTypeValue));
+  Slice a_slice(a);
+  Slice b_slice(b);
+  int sum = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(a_slice.data());
+    sum += icmp.Compare(a_slice, b_slice);
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_InternalKeyCompareUserKey(benchmark::State& state) {
+  InternalKeyCompare(state, false);
+}
+BENCHMARK(BM_InternalKeyCompareUserKey)->Arg(8)->Arg(16)->Arg(64)->Arg(256);
+
+static void BM_InternalKeyCompareSequence(benchmark::State& state) {
+  InternalKeyCompare(state, true);
+}
+BENCHMARK(BM_InternalKeyCompareSequence)->Arg(8)->Arg(16)->Arg(64)->Arg(256);
+
+}  // namespace rocksdb
+
+BENCHMARK_MAIN();
@@ -0,0 +1,89 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// Building and probing the full bloom filters of block-based tables. The
+// argument is the number of bits per key.
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/filter_policy.h"
+#include "rocksdb/slice.h"
+
+namespace rocksdb {
+
+namespace {
+
+const int kNumKeys = 100000;
+
+std::vector<std::string> FilterKeys(int first) {
+  std::vector<std::string> keys;
+  for (int i = first; i < first + kNumKeys; i++) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "key%012d", i);
+    keys.push_back(buf);
+  }
+  return keys;
+}
+
+}  // namespace
+
+static void BM_BloomBuild(benchmark::State& state) {
+  std::unique_ptr<const FilterPolicy> policy(NewBloomFilterPolicy(
+      static_cast<int>(state.range(0)), false /* use_block_based_builder */));
+  std::vector<std::string> keys = FilterKeys(0);
+  for (auto _ : state) {
+    std::unique_ptr<FilterBitsBuilder> builder(policy->GetFilterBitsBuilder());
+    for (const auto& key : keys) {
+      builder->AddKey(key);
+    }
+    std::unique_ptr<const char[]> buf;
+    benchmark::DoNotOptimize(builder->Finish(&buf).size());
+  }
+  state.SetItemsProcessed(state.iterations() * kNumKeys);
+}
+BENCHMARK(BM_BloomBuild)->Arg(10)->Arg(20);
+
+// With present, the probed keys are in the filter; otherwise the probes
+// measure the false positive path
+static void BloomProbe(benchmark::State& state, bool present) {
+  std::unique_ptr<const FilterPolicy> policy(NewBloomFilterPolicy(
+      static_cast<int>(state.range(0)), false /* use_block_based_builder */));
+  std::unique_ptr<FilterBitsBuilder> builder(policy->GetFilterBitsBuilder());
+  for (const auto& key : FilterKeys(0)) {
+    builder->AddKey(key);
+  }
+  std::unique_ptr<const char[]> buf;
+  Slice filter = builder->Finish(&buf);
+  std::unique_ptr<FilterBitsReader> reader(
+      policy->GetFilterBitsReader(filter));
+  std::vector<std::string> probes = FilterKeys(present ? 0 : kNumKeys);
+  size_t i = 0;
+  int64_t matches = 0;
+  for (auto _ : state) {
+    matches += reader->MayMatch(probes[i++ % probes.size()]) ? 1 : 0;
+  }
+  benchmark::DoNotOptimize(matches);
+  state.SetItemsProcessed(state.iterations());
+  state.counters["match_ratio"] =
+      static_cast<double>(matches) / state.iterations();
+}
+
+static void BM_BloomProbeHit(benchmark::State& state) {
+  BloomProbe(state, true);
+}
+BENCHMARK(BM_BloomProbeHit)->Arg(10)->Arg(20);
+
+static void BM_BloomProbeMiss(benchmark::State& state) {
+  BloomProbe(state, false);
+}
+BENCHMARK(BM_BloomProbeMiss)->Arg(10)->Arg(20);
+
+}  // namespace rocksdb
+
+BENCHMARK_MAIN();
@@ -0,0 +1,166 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// Seek() and Next() of BlockIter over a data block, and of a
+// MergingIterator over several of them.
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "rocksdb/comparator.h"
+#include "table/block.h"
+#include "table/block_builder.h"
+#include "table/format.h"
+#include "table/internal_iterator.h"
+#include "table/merging_iterator.h"
+#include "util/random.h"
+
+namespace rocksdb {
+
+namespace {
+
+const int kValueSize = 100;
+
+std::string UserKey(int i) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "key%012d", i);
+  return buf;
+}
+
+// A data block of internal keys, with the keys that are numbered
+// first, first + step, first + 2 * step... below num_keys
+class TestBlock {
+ public:
+  TestBlock(int first, int step, int num_keys, int restart_interval) {
+    BlockBuilder builder(restart_interval);
+    std::string value(kValueSize, 'v');
+    for (int i = first; i < num_keys; i += step) {
+      std::string key;
+      AppendInternalKey(&key, ParsedInternalKey(UserKey(i), i, kTypeValue));
+      builder.Add(key, value);
+    }
+    data_ = builder.Finish().ToString();
+    block_.reset(new Block(BlockContents(data_, false, kNoCompression),
+                           kDisableGlobalSequenceNumber));
+  }
+
+  Block* block() { return block_.get(); }
+
+ private:
+  std::string data_;
+  std::unique_ptr<Block> block_;
+};
+
+// Seek targets for keys in [0, num_keys)
+std::vector<std::string> SeekTargets(int num_keys) {
+  Random rnd(301);
+  std::vector<std::string> targets;
+  for (int i = 0; i < 1024; i++) {
+    targets.emplace_back();
+    AppendInternalKey(
+        &targets.back(),
+        ParsedInternalKey(UserKey(rnd.Uniform(num_keys)), kMaxSequenceNumber,
+                          kValueTypeForSeek));
+  }
+  return targets;
+}
+
+}  // namespace
+
+// Arguments: the number of entries of the block, and its restart interval
+static void BM_BlockIterSeek(benchmark::State& state) {
+  const int num_keys = static_cast<int>(state.range(0));
+  InternalKeyComparator icmp(BytewiseComparator());
+  TestBlock block(0, 1, num_keys, static_cast<int>(state.range(1)));
+  std::vector<std::string> targets = SeekTargets(num_keys);
+  BlockIter iter;
+  block.block()->NewIterator(&icmp, &iter);
+  size_t i = 0;
+  for (auto _ : state) {
+    iter.Seek(targets[i++ % targets.size()]);
+    benchmark::DoNotOptimize(iter.Valid());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BlockIterSeek)->Args({32, 16})->Args({256, 1})->Args({256, 16});
+
+static void BM_BlockIterNext(benchmark::State& state) {
+  const int num_keys = static_cast<int>(state.range(0));
+  InternalKeyComparator icmp(BytewiseComparator());
+  TestBlock block(0, 1, num_keys, static_cast<int>(state.range(1)));
+  BlockIter iter;
+  block.block()->NewIterator(&icmp, &iter);
+  for (auto _ : state) {
+    for (iter.SeekToFirst(); iter.Valid(); iter.Next()) {
+      benchmark::DoNotOptimize(iter.key().data());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * num_keys);
+}
+BENCHMARK(BM_BlockIterNext)->Args({256, 1})->Args({256, 16});
+
+namespace {
+
+// The keys [0, num_keys) spread round-robin over num_children blocks
+class MergedBlocks {
+ public:
+  MergedBlocks(int num_children, int num_keys)
+      : icmp_(BytewiseComparator()) {
+    for (int i = 0; i < num_children; i++) {
+      blocks_.emplace_back(new TestBlock(i, num_children, num_keys, 16));
+    }
+  }
+
+  InternalIterator* NewIterator() {
+    std::vector<InternalIterator*> children;
+    for (auto& block : blocks_) {
+      children.push_back(block->block()->NewIterator(&icmp_));
+    }
+    return NewMergingIterator(&icmp_, children.data(),
+                              static_cast<int>(children.size()));
+  }
+
+ private:
+  InternalKeyComparator icmp_;
+  std::vector<std::unique_ptr<TestBlock>> blocks_;
+};
+
+}  // namespace
+
+// Argument: the number of children
+static void BM_MergingIteratorSeek(benchmark::State& state) {
+  const int kNumKeys = 4096;
+  MergedBlocks blocks(static_cast<int>(state.range(0)), kNumKeys);
+  std::unique_ptr<InternalIterator> iter(blocks.NewIterator());
+  std::vector<std::string> targets = SeekTargets(kNumKeys);
+  size_t i = 0;
+  for (auto _ : state) {
+    iter->Seek(targets[i++ % targets.size()]);
+    benchmark::DoNotOptimize(iter->Valid());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MergingIteratorSeek)->Arg(1)->Arg(4)->Arg(16);
+
+static void BM_MergingIteratorNext(benchmark::State& state) {
+  const int kNumKeys = 4096;
+  MergedBlocks blocks(static_cast<int>(state.range(0)), kNumKeys);
+  std::unique_ptr<InternalIterator> iter(blocks.NewIterator());
+  for (auto _ : state) {
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      benchmark::DoNotOptimize(iter->key().data());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kNumKeys);
+}
+BENCHMARK(BM_MergingIteratorNext)->Arg(1)->Arg(4)->Arg(16);
+
+}  // namespace rocksdb
+
+BENCHMARK_MAIN();
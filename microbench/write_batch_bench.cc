@@ -0,0 +1,78 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// Building a WriteBatch of Puts and iterating over it. The argument is the
+// size of the values.
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "rocksdb/write_batch.h"
+
+namespace rocksdb {
+
+namespace {
+
+const int kBatchSize = 100;
+
+std::vector<std::string> BatchKeys() {
+  std::vector<std::string> keys;
+  for (int i = 0; i < kBatchSize; i++) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "key%012d", i);
+    keys.push_back(buf);
+  }
+  return keys;
+}
+
+class CountingHandler : public WriteBatch::Handler {
+ public:
+  virtual Status PutCF(uint32_t /*column_family_id*/, const Slice& key,
+                       const Slice& value) override {
+    bytes_ += key.size() + value.size();
+    return Status::OK();
+  }
+
+  size_t bytes_ = 0;
+};
+
+}  // namespace
+
+static void BM_WriteBatchPut(benchmark::State& state) {
+  std::vector<std::string> keys = BatchKeys();
+  std::string value(static_cast<size_t>(state.range(0)), 'v');
+  WriteBatch batch;
+  for (auto _ : state) {
+    batch.Clear();
+    for (const auto& key : keys) {
+      batch.Put(key, value);
+    }
+    benchmark::DoNotOptimize(batch.GetDataSize());
+  }
+  state.SetItemsProcessed(state.iterations() * kBatchSize);
+}
+BENCHMARK(BM_WriteBatchPut)->Arg(16)->Arg(100)->Arg(1024);
+
+static void BM_WriteBatchIterate(benchmark::State& state) {
+  std::string value(static_cast<size_t>(state.range(0)), 'v');
+  WriteBatch batch;
+  for (const auto& key : BatchKeys()) {
+    batch.Put(key, value);
+  }
+  CountingHandler handler;
+  for (auto _ : state) {
+    Status s = batch.Iterate(&handler);
+    benchmark::DoNotOptimize(s.ok());
+  }
+  benchmark::DoNotOptimize(handler.bytes_);
+  state.SetItemsProcessed(state.iterations() * kBatchSize);
+}
+BENCHMARK(BM_WriteBatchIterate)->Arg(16)->Arg(100)->Arg(1024);
+
+}  // namespace rocksdb
+
+BENCHMARK_MAIN();
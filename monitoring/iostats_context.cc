@@ -30,6 +30,7 @@ void IOStatsContext::Reset() {
   allocate_nanos = 0;
   write_nanos = 0;
   read_nanos = 0;
+  prefetch_wait_nanos = 0;
   range_sync_nanos = 0;
   prepare_write_nanos = 0;
   fsync_nanos = 0;
@@ -50,6 +51,7 @@ std::string IOStatsContext::ToString(bool exclude_zero_counters) const {
   IOSTATS_CONTEXT_OUTPUT(allocate_nanos);
   IOSTATS_CONTEXT_OUTPUT(write_nanos);
   IOSTATS_CONTEXT_OUTPUT(read_nanos);
+  IOSTATS_CONTEXT_OUTPUT(prefetch_wait_nanos);
   IOSTATS_CONTEXT_OUTPUT(range_sync_nanos);
   IOSTATS_CONTEXT_OUTPUT(fsync_nanos);
   IOSTATS_CONTEXT_OUTPUT(prepare_write_nanos);
@@ -0,0 +1,92 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "monitoring/key_range_hotness.h"
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <algorithm>
+
+#include "util/mutexlock.h"
+
+namespace rocksdb {
+
+void KeyRangeHotness::Record(const Slice& key, bool is_read) {
+  const bool in_domain = prefix_extractor_->InDomain(key);
+  Slice prefix;
+  if (in_domain) {
+    prefix = prefix_extractor_->Transform(key);
+  }
+  MutexLock l(&mutex_);
+  Counts* counts = &other_counts_;
+  if (in_domain) {
+    auto iter = counts_.find(prefix.ToString());
+    if (iter != counts_.end()) {
+      counts = &iter->second;
+    } else if (counts_.size() < kMaxPrefixes) {
+      counts = &counts_[prefix.ToString()];
+    }
+  }
+  if (is_read) {
+    counts->num_reads += kFileReadSampleRate;
+  } else {
+    counts->num_writes += kFileReadSampleRate;
+  }
+}
+
+std::vector<KeyRangeHotnessStats> KeyRangeHotness::GetStats() const {
+  std::vector<KeyRangeHotnessStats> stats;
+  {
+    MutexLock l(&mutex_);
+    stats.reserve(counts_.size() + 1);
+    for (const auto& prefix_counts : counts_) {
+      stats.emplace_back();
+      stats.back().prefix = prefix_counts.first;
+      stats.back().num_reads = prefix_counts.second.num_reads;
+      stats.back().num_writes = prefix_counts.second.num_writes;
+    }
+    if (other_counts_.num_reads > 0 || other_counts_.num_writes > 0) {
+      stats.emplace_back();
+      stats.back().num_reads = other_counts_.num_reads;
+      stats.back().num_writes = other_counts_.num_writes;
+    }
+  }
+  std::sort(stats.begin(), stats.end(),
+            [](const KeyRangeHotnessStats& s1, const KeyRangeHotnessStats& s2) {
+              uint64_t total1 = s1.num_reads + s1.num_writes;
+              uint64_t total2 = s2.num_reads + s2.num_writes;
+              if (total1 != total2) {
+                return total1 > total2;
+              }
+              return s1.prefix < s2.prefix;
+            });
+  return stats;
+}
+
+std::string KeyRangeHotness::ToString() const {
+  std::string result;
+  char buf[100];
+  snprintf(buf, sizeof(buf), "%12s %12s  %s\n", "Reads", "Writes",
+           "Prefix (hex)");
+  result.append(buf);
+  for (const auto& stats : GetStats()) {
+    snprintf(buf, sizeof(buf), "%12" PRIu64 " %12" PRIu64 "  ",
+             stats.num_reads, stats.num_writes);
+    result.append(buf);
+    if (stats.prefix.empty()) {
+      result.append("(other)");
+    } else {
+      result.append(Slice(stats.prefix).ToString(true /* hex */));
+    }
+    result.push_back('\n');
+  }
+  return result;
+}
+
+}  // namespace rocksdb
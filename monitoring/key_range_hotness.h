@@ -0,0 +1,81 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "monitoring/file_read_sample.h"
+#include "port/port.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/slice_transform.h"
+
+namespace rocksdb {
+
+// The estimated reads and writes of the keys sharing a prefix
+struct KeyRangeHotnessStats {
+  KeyRangeHotnessStats() : num_reads(0), num_writes(0) {}
+
+  // The prefix, empty for the keys counted together (see KeyRangeHotness)
+  std::string prefix;
+  uint64_t num_reads;
+  uint64_t num_writes;
+};
+
+// Counts the sampled reads and writes of a column family by the prefix of
+// their key (see ColumnFamilyOptions::key_hotness_prefix_extractor). Like
+// FileSampledStats::num_reads_sampled, each sample counts for
+// kFileReadSampleRate operations. Thread-safe.
+class KeyRangeHotness {
+ public:
+  // The number of prefixes counted separately, the keys of the prefixes
+  // seen after them are counted together
+  static const size_t kMaxPrefixes = 4096;
+
+  // Counts nothing if prefix_extractor is nullptr
+  explicit KeyRangeHotness(const SliceTransform* prefix_extractor)
+      : prefix_extractor_(prefix_extractor) {}
+
+  bool enabled() const { return prefix_extractor_ != nullptr; }
+
+  void SampleRead(const Slice& key) {
+    if (enabled() && should_sample_file_read()) {
+      Record(key, true /* is_read */);
+    }
+  }
+
+  void SampleWrite(const Slice& key) {
+    if (enabled() && should_sample_file_read()) {
+      Record(key, false /* is_read */);
+    }
+  }
+
+  // Returns the counts of each prefix by decreasing reads plus writes
+  std::vector<KeyRangeHotnessStats> GetStats() const;
+
+  // The stats in the format of the "rocksdb.key-range-hotness" property
+  std::string ToString() const;
+
+ private:
+  struct Counts {
+    Counts() : num_reads(0), num_writes(0) {}
+    uint64_t num_reads;
+    uint64_t num_writes;
+  };
+
+  void Record(const Slice& key, bool is_read);
+
+  const SliceTransform* prefix_extractor_;
+  mutable port::Mutex mutex_;
+  std::unordered_map<std::string, Counts> counts_;
+  // The keys outside of the domain of prefix_extractor_, or past
+  // kMaxPrefixes
+  Counts other_counts_;
+};
+
+}  // namespace rocksdb
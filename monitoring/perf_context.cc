@@ -31,6 +31,17 @@ PerfContext* get_perf_context() {
 #endif
 }
 
+void PerfContextByLevel::Reset() {
+  get_from_table_count = 0;
+  get_from_table_nanos = 0;
+  block_cache_hit_count = 0;
+  block_read_count = 0;
+  block_read_byte = 0;
+  block_read_time = 0;
+  bloom_sst_hit_count = 0;
+  bloom_sst_miss_count = 0;
+}
+
 void PerfContext::Reset() {
 #ifndef NPERF_CONTEXT
   user_key_comparison_count = 0;
@@ -100,14 +111,46 @@ void PerfContext::Reset() {
   env_lock_file_nanos = 0;
   env_unlock_file_nanos = 0;
   env_new_logger_nanos = 0;
+  ClearPerLevelPerfContext();
 #endif
 }
 
+void PerfContext::EnablePerLevelPerfContext() {
+  per_level_perf_context_enabled = true;
+}
+
+void PerfContext::DisablePerLevelPerfContext() {
+  per_level_perf_context_enabled = false;
+  ClearPerLevelPerfContext();
+}
+
+void PerfContext::ClearPerLevelPerfContext() {
+  for (int level = 0; level < kNumPerfContextLevels; level++) {
+    level_to_perf_context[level].Reset();
+  }
+}
+
 #define PERF_CONTEXT_OUTPUT(counter)             \
   if (!exclude_zero_counters || (counter > 0)) { \
     ss << #counter << " = " << counter << ", ";  \
   }
 
+// Outputs the non-zero counts of the levels as
+// "counter = count@level0, count@level2, ", or nothing if all are zero
+#define PERF_CONTEXT_BY_LEVEL_OUTPUT(counter)                          \
+  {                                                                    \
+    std::ostringstream by_level;                                       \
+    for (int level = 0; level < kNumPerfContextLevels; level++) {      \
+      if (level_to_perf_context[level].counter > 0) {                  \
+        by_level << level_to_perf_context[level].counter << "@level"   \
+                 << level << ", ";                                     \
+      }                                                                \
+    }                                                                  \
+    if (!by_level.str().empty()) {                                     \
+      ss << #counter << " = " << by_level.str();                       \
+    }                                                                  \
+  }
+
 std::string PerfContext::ToString(bool exclude_zero_counters) const {
 #ifdef NPERF_CONTEXT
   return "";
@@ -178,6 +221,16 @@ std::string PerfContext::ToString(bool exclude_zero_counters) const {
   PERF_CONTEXT_OUTPUT(env_lock_file_nanos);
   PERF_CONTEXT_OUTPUT(env_unlock_file_nanos);
   PERF_CONTEXT_OUTPUT(env_new_logger_nanos);
+  if (per_level_perf_context_enabled) {
+    PERF_CONTEXT_BY_LEVEL_OUTPUT(get_from_table_count);
+    PERF_CONTEXT_BY_LEVEL_OUTPUT(get_from_table_nanos);
+    PERF_CONTEXT_BY_LEVEL_OUTPUT(block_cache_hit_count);
+    PERF_CONTEXT_BY_LEVEL_OUTPUT(block_read_count);
+    PERF_CONTEXT_BY_LEVEL_OUTPUT(block_read_byte);
+    PERF_CONTEXT_BY_LEVEL_OUTPUT(block_read_time);
+    PERF_CONTEXT_BY_LEVEL_OUTPUT(bloom_sst_hit_count);
+    PERF_CONTEXT_BY_LEVEL_OUTPUT(bloom_sst_miss_count);
+  }
   return ss.str();
 #endif
 }
@@ -4,6 +4,8 @@
 //  (found in the LICENSE.Apache file in the root directory).
 //
 #pragma once
+#include <algorithm>
+
 #include "monitoring/perf_step_timer.h"
 #include "rocksdb/perf_context.h"
 #include "util/stop_watch.h"
@@ -18,6 +20,7 @@ namespace rocksdb {
 #define PERF_TIMER_STOP(metric)
 #define PERF_TIMER_START(metric)
 #define PERF_COUNTER_ADD(metric, value)
+#define PERF_COUNTER_BY_LEVEL_GUARD(level)
 
 #else
 
@@ -47,6 +50,72 @@ namespace rocksdb {
     get_perf_context()->metric += value;       \
   }
 
+// Adds the change of the table read counters of the PerfContext while in
+// scope to the counters of the level, when the per-level breakdown is
+// enabled. Otherwise costs a check of perf_level, or of a flag.
+class PerfContextByLevelGuard {
+ public:
+  explicit PerfContextByLevelGuard(int level) : by_level_(nullptr), start_(0) {
+    if (perf_level >= PerfLevel::kEnableCount) {
+      PerfContext* context = get_perf_context();
+      if (context->per_level_perf_context_enabled) {
+        Start(context, level);
+      }
+    }
+  }
+
+  ~PerfContextByLevelGuard() {
+    if (by_level_ != nullptr) {
+      Stop();
+    }
+  }
+
+ private:
+  void Start(PerfContext* context, int level) {
+    level = std::min(std::max(level, 0),
+                     PerfContext::kNumPerfContextLevels - 1);
+    by_level_ = &context->level_to_perf_context[level];
+    base_.block_cache_hit_count = context->block_cache_hit_count;
+    base_.block_read_count = context->block_read_count;
+    base_.block_read_byte = context->block_read_byte;
+    base_.block_read_time = context->block_read_time;
+    base_.bloom_sst_hit_count = context->bloom_sst_hit_count;
+    base_.bloom_sst_miss_count = context->bloom_sst_miss_count;
+    if (perf_level >= PerfLevel::kEnableTimeExceptForMutex) {
+      start_ = Env::Default()->NowNanos();
+    }
+  }
+
+  void Stop() {
+    PerfContext* context = get_perf_context();
+    by_level_->get_from_table_count++;
+    if (start_ != 0) {
+      by_level_->get_from_table_nanos += Env::Default()->NowNanos() - start_;
+    }
+    by_level_->block_cache_hit_count +=
+        context->block_cache_hit_count - base_.block_cache_hit_count;
+    by_level_->block_read_count +=
+        context->block_read_count - base_.block_read_count;
+    by_level_->block_read_byte +=
+        context->block_read_byte - base_.block_read_byte;
+    by_level_->block_read_time +=
+        context->block_read_time - base_.block_read_time;
+    by_level_->bloom_sst_hit_count +=
+        context->bloom_sst_hit_count - base_.bloom_sst_hit_count;
+    by_level_->bloom_sst_miss_count +=
+        context->bloom_sst_miss_count - base_.bloom_sst_miss_count;
+  }
+
+  PerfContextByLevel* by_level_;
+  uint64_t start_;
+  // The counters of the PerfContext when started, set only when enabled
+  PerfContextByLevel base_;
+};
+
+// Break the table read counters down by level for the rest of the scope
+#define PERF_COUNTER_BY_LEVEL_GUARD(level) \
+  PerfContextByLevelGuard perf_context_by_level_guard(level);
+
 #endif
 
 }
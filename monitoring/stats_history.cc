@@ -0,0 +1,134 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "monitoring/stats_history.h"
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "db/db_impl.h"
+#include "util/string_util.h"
+
+namespace rocksdb {
+
+const std::string kPersistentStatsColumnFamilyName =
+    "___rocksdb_stats_history___";
+
+namespace {
+const size_t kStatsKeyTimeDigits = 10;
+}  // namespace
+
+ColumnFamilyOptions PersistentStatsColumnFamilyOptions() {
+  ColumnFamilyOptions cf_options;
+  cf_options.write_buffer_size = 2 << 20;
+  cf_options.compression = kNoCompression;
+  return cf_options;
+}
+
+std::string EncodePersistentStatsKey(uint64_t time, const Slice& name) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%010" PRIu64 "#", time);
+  std::string key(buf);
+  key.append(name.data(), name.size());
+  return key;
+}
+
+bool DecodePersistentStatsKey(const Slice& key, uint64_t* time,
+                              std::string* name) {
+  if (key.size() <= kStatsKeyTimeDigits ||
+      key[kStatsKeyTimeDigits] != '#') {
+    return false;
+  }
+  Slice digits(key.data(), kStatsKeyTimeDigits);
+  if (!ConsumeDecimalNumber(&digits, time) || !digits.empty()) {
+    return false;
+  }
+  name->assign(key.data() + kStatsKeyTimeDigits + 1,
+               key.size() - kStatsKeyTimeDigits - 1);
+  return true;
+}
+
+size_t EstimateStatsSnapshotSize(
+    const std::map<std::string, uint64_t>& stats) {
+  // The map node of the snapshot and of each stat, roughly
+  const size_t kNodeOverhead = 4 * sizeof(void*);
+  size_t size = kNodeOverhead + sizeof(uint64_t) + sizeof(stats);
+  for (const auto& stat : stats) {
+    size += kNodeOverhead + sizeof(std::string) + stat.first.capacity() +
+            sizeof(uint64_t);
+  }
+  return size;
+}
+
+InMemoryStatsHistoryIterator::InMemoryStatsHistoryIterator(
+    uint64_t start_time, uint64_t end_time, DBImpl* db_impl)
+    : end_time_(end_time), db_impl_(db_impl), valid_(false), time_(0) {
+  FindFrom(start_time);
+}
+
+void InMemoryStatsHistoryIterator::Next() {
+  assert(valid_);
+  FindFrom(time_ + 1);
+}
+
+void InMemoryStatsHistoryIterator::FindFrom(uint64_t start_time) {
+  valid_ = start_time < end_time_ &&
+           db_impl_->FindStatsByTime(start_time, end_time_, &time_,
+                                     &stats_map_);
+}
+
+PersistentStatsHistoryIterator::PersistentStatsHistoryIterator(
+    uint64_t start_time, uint64_t end_time, Iterator* iter)
+    : end_time_(end_time), iter_(iter), valid_(false), time_(0) {
+  iter_->Seek(EncodePersistentStatsKey(start_time, Slice()));
+  ReadSnapshot();
+}
+
+void PersistentStatsHistoryIterator::Next() {
+  assert(valid_);
+  ReadSnapshot();
+}
+
+void PersistentStatsHistoryIterator::ReadSnapshot() {
+  valid_ = false;
+  stats_map_.clear();
+  bool found = false;
+  for (; iter_->Valid(); iter_->Next()) {
+    uint64_t time;
+    std::string name;
+    if (!DecodePersistentStatsKey(iter_->key(), &time, &name)) {
+      status_ = Status::Corruption("Invalid key in the stats history",
+                                   iter_->key().ToString(true /* hex */));
+      return;
+    }
+    if (!found) {
+      if (time >= end_time_) {
+        return;
+      }
+      time_ = time;
+      found = true;
+    } else if (time != time_) {
+      break;
+    }
+    Slice value = iter_->value();
+    uint64_t stat;
+    if (!ConsumeDecimalNumber(&value, &stat) || !value.empty()) {
+      status_ = Status::Corruption("Invalid value in the stats history", name);
+      return;
+    }
+    stats_map_[name] = stat;
+  }
+  if (!iter_->status().ok()) {
+    status_ = iter_->status();
+    return;
+  }
+  valid_ = found;
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,96 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "rocksdb/iterator.h"
+#include "rocksdb/options.h"
+#include "rocksdb/stats_history.h"
+
+namespace rocksdb {
+
+class DBImpl;
+
+// The hidden column family of the stats history, when
+// DBOptions::persist_stats_to_disk is set
+extern const std::string kPersistentStatsColumnFamilyName;
+
+// The options of the column family of the stats history. The history grows
+// by a few KB per snapshot, so its memtables stay small.
+extern ColumnFamilyOptions PersistentStatsColumnFamilyOptions();
+
+// The persisted history stores each stat of a snapshot under its own key:
+// the time of the snapshot in seconds as 10 decimal digits, so that the keys
+// sort by time, then '#' and the name of the stat. The value is the stat in
+// decimal.
+extern std::string EncodePersistentStatsKey(uint64_t time, const Slice& name);
+extern bool DecodePersistentStatsKey(const Slice& key, uint64_t* time,
+                                     std::string* name);
+
+// An estimate of the memory taken by a snapshot in the in-memory history
+extern size_t EstimateStatsSnapshotSize(
+    const std::map<std::string, uint64_t>& stats);
+
+// Iterates the history kept in memory by DBImpl, copying one snapshot at a
+// time so that the history is not locked while the caller reads it
+class InMemoryStatsHistoryIterator : public StatsHistoryIterator {
+ public:
+  // Returns the snapshots taken at start_time <= time < end_time
+  InMemoryStatsHistoryIterator(uint64_t start_time, uint64_t end_time,
+                               DBImpl* db_impl);
+
+  virtual bool Valid() const override { return valid_; }
+  virtual void Next() override;
+  virtual Status status() const override { return Status::OK(); }
+  virtual uint64_t GetStatsTime() const override { return time_; }
+  virtual const std::map<std::string, uint64_t>& GetStatsMap()
+      const override {
+    return stats_map_;
+  }
+
+ private:
+  void FindFrom(uint64_t start_time);
+
+  const uint64_t end_time_;
+  DBImpl* db_impl_;
+  bool valid_;
+  uint64_t time_;
+  std::map<std::string, uint64_t> stats_map_;
+};
+
+// Iterates the history persisted in kPersistentStatsColumnFamilyName,
+// through iter over that column family
+class PersistentStatsHistoryIterator : public StatsHistoryIterator {
+ public:
+  // Returns the snapshots taken at start_time <= time < end_time
+  PersistentStatsHistoryIterator(uint64_t start_time, uint64_t end_time,
+                                 Iterator* iter);
+
+  virtual bool Valid() const override { return valid_; }
+  virtual void Next() override;
+  virtual Status status() const override { return status_; }
+  virtual uint64_t GetStatsTime() const override { return time_; }
+  virtual const std::map<std::string, uint64_t>& GetStatsMap()
+      const override {
+    return stats_map_;
+  }
+
+ private:
+  // Reads the stats of the snapshot at the position of iter_
+  void ReadSnapshot();
+
+  const uint64_t end_time_;
+  std::unique_ptr<Iterator> iter_;
+  bool valid_;
+  Status status_;
+  uint64_t time_;
+  std::map<std::string, uint64_t> stats_map_;
+};
+
+}  // namespace rocksdb
@@ -0,0 +1,337 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "monitoring/stats_history.h"
+
+#include <atomic>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "db/db_test_util.h"
+#include "port/stack_trace.h"
+#include "rocksdb/statistics.h"
+#include "rocksdb/trace_reader_writer.h"
+#include "util/sync_point.h"
+#include "util/trace_replay.h"
+
+namespace rocksdb {
+
+class StatsHistoryTest : public DBTestBase {
+ public:
+  StatsHistoryTest() : DBTestBase("/stats_history_test") {}
+
+  Options StatsOptions() {
+    Options options = CurrentOptions();
+    options.statistics = CreateDBStatistics();
+    // Long enough for the timer not to fire, the tests take the snapshots
+    options.stats_persist_period_sec = 100000;
+    return options;
+  }
+
+  void AdvanceTime(uint64_t seconds) {
+    env_->addon_time_.fetch_add(seconds * 1000 * 1000);
+  }
+
+  // Returns the snapshots of the stats history taken at
+  // start_time <= time < end_time
+  std::map<uint64_t, std::map<std::string, uint64_t>> ReadHistory(
+      uint64_t start_time = 0,
+      uint64_t end_time = std::numeric_limits<uint64_t>::max()) {
+    std::map<uint64_t, std::map<std::string, uint64_t>> history;
+    std::unique_ptr<StatsHistoryIterator> iter;
+    EXPECT_OK(db_->GetStatsHistory(start_time, end_time, &iter));
+    uint64_t last_time = 0;
+    for (; iter->Valid(); iter->Next()) {
+      EXPECT_GT(iter->GetStatsTime(), last_time);
+      last_time = iter->GetStatsTime();
+      history[iter->GetStatsTime()] = iter->GetStatsMap();
+    }
+    EXPECT_OK(iter->status());
+    return history;
+  }
+
+  static uint64_t GetStat(const std::map<std::string, uint64_t>& stats,
+                          const std::string& name) {
+    auto iter = stats.find(name);
+    return iter == stats.end() ? 0 : iter->second;
+  }
+
+  // The size of the keys and values of a snapshot of the persisted history
+  static size_t PersistedSize(
+      uint64_t time, const std::map<std::string, uint64_t>& stats) {
+    size_t size = 0;
+    for (const auto& stat : stats) {
+      size += EncodePersistentStatsKey(time, stat.first).size() +
+              ToString(stat.second).size();
+    }
+    return size;
+  }
+
+  static size_t PersistedSize(
+      const std::map<uint64_t, std::map<std::string, uint64_t>>& history) {
+    size_t size = 0;
+    for (const auto& snapshot : history) {
+      size += PersistedSize(snapshot.first, snapshot.second);
+    }
+    return size;
+  }
+
+  const std::string kKeysWritten = "rocksdb.number.keys.written";
+  const std::string kKeysRead = "rocksdb.number.keys.read";
+};
+
+TEST_F(StatsHistoryTest, PersistentStatsKey) {
+  std::string key = EncodePersistentStatsKey(1500000000, "rocksdb.stat");
+  ASSERT_EQ("1500000000#rocksdb.stat", key);
+  uint64_t time;
+  std::string name;
+  ASSERT_TRUE(DecodePersistentStatsKey(key, &time, &name));
+  ASSERT_EQ(1500000000U, time);
+  ASSERT_EQ("rocksdb.stat", name);
+  // Keys sort by time
+  ASSERT_LT(EncodePersistentStatsKey(99, "z"),
+            EncodePersistentStatsKey(100, ""));
+  ASSERT_FALSE(DecodePersistentStatsKey("1500000000", &time, &name));
+  ASSERT_FALSE(DecodePersistentStatsKey("15000000x0#a", &time, &name));
+  ASSERT_FALSE(DecodePersistentStatsKey("1500000000-a", &time, &name));
+}
+
+TEST_F(StatsHistoryTest, InMemoryHistory) {
+  Reopen(StatsOptions());
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(Put(Key(i), "value"));
+  }
+  AdvanceTime(5);
+  dbfull()->TEST_PersistStats();
+  // Within the same second as the previous snapshot, left out
+  ASSERT_OK(Put(Key(10), "value"));
+  dbfull()->TEST_PersistStats();
+  for (int i = 0; i < 10; i++) {
+    ASSERT_EQ("value", Get(Key(i)));
+  }
+  AdvanceTime(5);
+  dbfull()->TEST_PersistStats();
+
+  auto history = ReadHistory();
+  ASSERT_EQ(2U, history.size());
+  const uint64_t first_time = history.begin()->first;
+  const auto& first = history.begin()->second;
+  const auto& second = history.rbegin()->second;
+  ASSERT_EQ(first_time + 5, history.rbegin()->first);
+  // The tickers hold their change since the previous snapshot
+  ASSERT_EQ(10U, GetStat(first, kKeysWritten));
+  ASSERT_EQ(0U, GetStat(first, kKeysRead));
+  ASSERT_EQ(1U, GetStat(second, kKeysWritten));
+  ASSERT_EQ(10U, GetStat(second, kKeysRead));
+  // The properties hold their value
+  ASSERT_EQ(10U, GetStat(first, DB::Properties::kEstimateNumKeys));
+  ASSERT_EQ(11U, GetStat(second, DB::Properties::kEstimateNumKeys));
+  ASSERT_EQ(1U, second.count(DB::Properties::kNumRunningCompactions));
+
+  // The time range
+  ASSERT_EQ(1U, ReadHistory(first_time + 1).size());
+  ASSERT_EQ(1U, ReadHistory(0, first_time + 1).size());
+  ASSERT_EQ(0U, ReadHistory(first_time + 1, first_time + 5).size());
+}
+
+TEST_F(StatsHistoryTest, InMemoryHistoryBufferSize) {
+  Options options = StatsOptions();
+  Reopen(options);
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(Put(Key(i), "value"));
+    AdvanceTime(1);
+    dbfull()->TEST_PersistStats();
+  }
+  auto history = ReadHistory();
+  ASSERT_EQ(10U, history.size());
+
+  // Room for the last two snapshots
+  size_t buffer_size = EstimateStatsSnapshotSize(history.rbegin()->second) +
+                       EstimateStatsSnapshotSize((++history.rbegin())->second);
+  ASSERT_OK(dbfull()->SetDBOptions(
+      {{"stats_history_buffer_size", ToString(buffer_size)}}));
+  ASSERT_OK(Put(Key(10), "value"));
+  AdvanceTime(1);
+  dbfull()->TEST_PersistStats();
+  auto trimmed_history = ReadHistory();
+  ASSERT_GE(2U, trimmed_history.size());
+  ASSERT_LT(0U, trimmed_history.size());
+  // The newest snapshots are kept
+  ASSERT_EQ(history.rbegin()->first + 1, trimmed_history.rbegin()->first);
+  size_t size = 0;
+  for (const auto& snapshot : trimmed_history) {
+    size += EstimateStatsSnapshotSize(snapshot.second);
+  }
+  ASSERT_LE(size, buffer_size);
+
+  ASSERT_OK(dbfull()->SetDBOptions({{"stats_history_buffer_size", "0"}}));
+  AdvanceTime(1);
+  dbfull()->TEST_PersistStats();
+  ASSERT_EQ(0U, ReadHistory().size());
+}
+
+TEST_F(StatsHistoryTest, PersistPeriod) {
+  std::atomic<int> num_persists(0);
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::PersistStats:Start", [&](void* arg) { num_persists++; });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+
+  Options options = StatsOptions();
+  options.stats_persist_period_sec = 1;
+  Reopen(options);
+  for (int i = 0; i < 100 && num_persists < 2; i++) {
+    Env::Default()->SleepForMicroseconds(100 * 1000);
+  }
+  ASSERT_GE(num_persists, 2);
+
+  // Stopping the timer
+  ASSERT_OK(dbfull()->SetDBOptions({{"stats_persist_period_sec", "0"}}));
+  int stopped_persists = num_persists;
+  Env::Default()->SleepForMicroseconds(1500 * 1000);
+  ASSERT_EQ(stopped_persists, num_persists);
+
+  // And starting it again
+  ASSERT_OK(dbfull()->SetDBOptions({{"stats_persist_period_sec", "1"}}));
+  for (int i = 0; i < 100 && num_persists == stopped_persists; i++) {
+    Env::Default()->SleepForMicroseconds(100 * 1000);
+  }
+  ASSERT_LT(stopped_persists, num_persists);
+
+  Close();
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
+TEST_F(StatsHistoryTest, PersistentHistory) {
+  Options options = StatsOptions();
+  options.persist_stats_to_disk = true;
+  Reopen(options);
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(Put(Key(i), "value"));
+  }
+  AdvanceTime(5);
+  dbfull()->TEST_PersistStats();
+  auto history = ReadHistory();
+  ASSERT_EQ(1U, history.size());
+  ASSERT_EQ(10U, GetStat(history.begin()->second, kKeysWritten));
+
+  // The history survives a restart, and the column family does not have to
+  // be passed to DB::Open()
+  Reopen(options);
+  ASSERT_EQ(history, ReadHistory());
+  ASSERT_OK(Flush());
+  Reopen(options);
+  ASSERT_EQ(history, ReadHistory());
+  ASSERT_EQ("value", Get(Key(0)));
+  AdvanceTime(5);
+  dbfull()->TEST_PersistStats();
+  ASSERT_EQ(2U, ReadHistory().size());
+  ASSERT_EQ(1U, ReadHistory(history.begin()->first + 1).size());
+
+  std::vector<std::string> column_families;
+  ASSERT_OK(DB::ListColumnFamilies(options, dbname_, &column_families));
+  ASSERT_EQ(2U, column_families.size());
+  ASSERT_EQ(kPersistentStatsColumnFamilyName, column_families[1]);
+
+  // Without persist_stats_to_disk, the history is kept in memory
+  options.persist_stats_to_disk = false;
+  Reopen(options);
+  ASSERT_EQ(0U, ReadHistory().size());
+  ASSERT_EQ("value", Get(Key(0)));
+}
+
+TEST_F(StatsHistoryTest, PersistentHistoryBufferSize) {
+  Options options = StatsOptions();
+  options.persist_stats_to_disk = true;
+  Reopen(options);
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(Put(Key(i), "value"));
+    AdvanceTime(1);
+    dbfull()->TEST_PersistStats();
+  }
+  auto history = ReadHistory();
+  ASSERT_EQ(10U, history.size());
+
+  // Room for about three snapshots, the oldest are deleted
+  size_t buffer_size = 3 * PersistedSize(history.rbegin()->first,
+                                         history.rbegin()->second);
+  options.stats_history_buffer_size = buffer_size;
+  Reopen(options);
+  ASSERT_EQ(10U, ReadHistory().size());
+  AdvanceTime(1);
+  dbfull()->TEST_PersistStats();
+  auto trimmed_history = ReadHistory();
+  ASSERT_LT(0U, trimmed_history.size());
+  ASSERT_GT(10U, trimmed_history.size());
+  ASSERT_EQ(history.rbegin()->first + 1, trimmed_history.rbegin()->first);
+  ASSERT_LE(PersistedSize(trimmed_history), buffer_size);
+
+  // The sizes of the snapshots are read again after a restart
+  Reopen(options);
+  for (int i = 0; i < 5; i++) {
+    AdvanceTime(1);
+    dbfull()->TEST_PersistStats();
+  }
+  trimmed_history = ReadHistory();
+  ASSERT_LT(0U, trimmed_history.size());
+  ASSERT_EQ(history.rbegin()->first + 6, trimmed_history.rbegin()->first);
+  ASSERT_LE(PersistedSize(trimmed_history), buffer_size);
+
+  ASSERT_OK(dbfull()->SetDBOptions({{"stats_history_buffer_size", "0"}}));
+  AdvanceTime(1);
+  dbfull()->TEST_PersistStats();
+  ASSERT_EQ(0U, ReadHistory().size());
+}
+
+TEST_F(StatsHistoryTest, PersistentHistoryIsInternal) {
+  Options options = StatsOptions();
+  options.persist_stats_to_disk = true;
+  Reopen(options);
+  ASSERT_OK(Put(Key(0), "value"));
+
+  EnvOptions env_options;
+  std::string trace_filename = dbname_ + "/rocksdb.trace";
+  std::unique_ptr<TraceWriter> trace_writer;
+  ASSERT_OK(
+      NewFileTraceWriter(env_, env_options, trace_filename, &trace_writer));
+  ASSERT_OK(db_->StartTrace(TraceOptions(), std::move(trace_writer)));
+  AdvanceTime(1);
+  dbfull()->TEST_PersistStats();
+  ASSERT_OK(db_->EndTrace());
+  ASSERT_EQ(1U, ReadHistory().size());
+
+  // The snapshot is not in the trace
+  std::unique_ptr<TraceReader> trace_reader;
+  ASSERT_OK(
+      NewFileTraceReader(env_, env_options, trace_filename, &trace_reader));
+  std::string encoded;
+  Trace trace;
+  while (trace_reader->Read(&encoded).ok()) {
+    ASSERT_OK(DecodeTrace(encoded, &trace));
+    ASSERT_NE(kTraceWrite, trace.type);
+  }
+
+  // Nor in the properties summed over the column families
+  uint64_t aggregated = 0;
+  uint64_t value = 0;
+  ASSERT_TRUE(db_->GetAggregatedIntProperty(
+      DB::Properties::kCurSizeAllMemTables, &aggregated));
+  ASSERT_TRUE(
+      db_->GetIntProperty(DB::Properties::kCurSizeAllMemTables, &value));
+  ASSERT_EQ(value, aggregated);
+  ASSERT_TRUE(db_->GetAggregatedIntProperty(DB::Properties::kEstimateNumKeys,
+                                            &aggregated));
+  ASSERT_EQ(1U, aggregated);
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  rocksdb::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -64,6 +64,22 @@ const void* ThreadStatusUpdater::GetColumnFamilyInfoKey() {
   return data->cf_key.load(std::memory_order_relaxed);
 }
 
+ThreadStatus::ThreadType ThreadStatusUpdater::GetThreadType() {
+  auto* data = Get();
+  if (data == nullptr) {
+    return ThreadStatus::USER;
+  }
+  return data->thread_type.load(std::memory_order_relaxed);
+}
+
+ThreadStatus::OperationType ThreadStatusUpdater::GetThreadOperation() {
+  auto* data = GetLocalThreadStatus();
+  if (data == nullptr) {
+    return ThreadStatus::OP_UNKNOWN;
+  }
+  return data->operation_type.load(std::memory_order_acquire);
+}
+
 void ThreadStatusUpdater::SetThreadOperation(
     const ThreadStatus::OperationType type) {
   auto* data = GetLocalThreadStatus();
@@ -310,6 +326,14 @@ void ThreadStatusUpdater::SetThreadOperation(
     const ThreadStatus::OperationType type) {
 }
 
+ThreadStatus::ThreadType ThreadStatusUpdater::GetThreadType() {
+  return ThreadStatus::USER;
+}
+
+ThreadStatus::OperationType ThreadStatusUpdater::GetThreadOperation() {
+  return ThreadStatus::OP_UNKNOWN;
+}
+
 void ThreadStatusUpdater::ClearThreadOperation() {
 }
 
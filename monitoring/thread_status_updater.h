@@ -131,6 +131,13 @@ class ThreadStatusUpdater {
   // Update the thread operation of the current thread.
   void SetThreadOperation(const ThreadStatus::OperationType type);
 
+  // Returns the type of the current thread, USER if it is not registered.
+  ThreadStatus::ThreadType GetThreadType();
+
+  // Returns the operation of the current thread, OP_UNKNOWN when thread
+  // tracking is disabled.
+  ThreadStatus::OperationType GetThreadOperation();
+
   // The start time of the current thread operation.  It is in the format
   // of micro-seconds since some fixed point in time.
   void SetOperationStartTime(const uint64_t start_time);
@@ -69,6 +69,20 @@ void ThreadStatusUtil::SetThreadOperation(ThreadStatus::OperationType op) {
   thread_updater_local_cache_->SetThreadOperation(op);
 }
 
+ThreadStatus::ThreadType ThreadStatusUtil::GetThreadType() {
+  if (thread_updater_local_cache_ == nullptr) {
+    return ThreadStatus::USER;
+  }
+  return thread_updater_local_cache_->GetThreadType();
+}
+
+ThreadStatus::OperationType ThreadStatusUtil::GetThreadOperation() {
+  if (thread_updater_local_cache_ == nullptr) {
+    return ThreadStatus::OP_UNKNOWN;
+  }
+  return thread_updater_local_cache_->GetThreadOperation();
+}
+
 ThreadStatus::OperationStage ThreadStatusUtil::SetThreadOperationStage(
     ThreadStatus::OperationStage stage) {
   if (thread_updater_local_cache_ == nullptr) {
@@ -184,6 +198,14 @@ void ThreadStatusUtil::SetColumnFamily(const ColumnFamilyData* cfd,
 void ThreadStatusUtil::SetThreadOperation(ThreadStatus::OperationType op) {
 }
 
+ThreadStatus::ThreadType ThreadStatusUtil::GetThreadType() {
+  return ThreadStatus::USER;
+}
+
+ThreadStatus::OperationType ThreadStatusUtil::GetThreadOperation() {
+  return ThreadStatus::OP_UNKNOWN;
+}
+
 void ThreadStatusUtil::SetThreadOperationProperty(
     int code, uint64_t value) {
 }
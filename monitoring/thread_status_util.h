@@ -59,6 +59,12 @@ class ThreadStatusUtil {
 
   static void SetThreadOperation(ThreadStatus::OperationType type);
 
+  // The type and operation of the current thread, as they would be
+  // reported by Env::GetThreadList()
+  static ThreadStatus::ThreadType GetThreadType();
+
+  static ThreadStatus::OperationType GetThreadOperation();
+
   static ThreadStatus::OperationStage SetThreadOperationStage(
       ThreadStatus::OperationStage stage);
 
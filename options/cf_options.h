@@ -121,6 +121,8 @@ struct ImmutableCFOptions {
   uint32_t max_subcompactions;
 
   const SliceTransform* memtable_insert_with_hint_prefix_extractor;
+
+  const SliceTransform* key_hotness_prefix_extractor;
 };
 
 struct MutableCFOptions {
@@ -63,6 +63,7 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       new_table_reader_for_compaction_inputs(
           options.new_table_reader_for_compaction_inputs),
       compaction_readahead_size(options.compaction_readahead_size),
+      compaction_readahead_threads(options.compaction_readahead_threads),
       random_access_max_buffer_size(options.random_access_max_buffer_size),
       writable_file_max_buffer_size(options.writable_file_max_buffer_size),
       use_adaptive_mutex(options.use_adaptive_mutex),
@@ -88,7 +89,8 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       avoid_flush_during_recovery(options.avoid_flush_during_recovery),
       allow_ingest_behind(options.allow_ingest_behind),
       concurrent_prepare(options.concurrent_prepare),
-      manual_wal_flush(options.manual_wal_flush) {
+      manual_wal_flush(options.manual_wal_flush),
+      persist_stats_to_disk(options.persist_stats_to_disk) {
 }
 
 void ImmutableDBOptions::Dump(Logger* log) const {
@@ -173,6 +175,8 @@ void ImmutableDBOptions::Dump(Logger* log) const {
   ROCKS_LOG_HEADER(
       log, "              Options.compaction_readahead_size: %" ROCKSDB_PRIszt,
       compaction_readahead_size);
+  ROCKS_LOG_HEADER(log, "           Options.compaction_readahead_threads: %d",
+                   compaction_readahead_threads);
   ROCKS_LOG_HEADER(
       log, "          Options.random_access_max_buffer_size: %" ROCKSDB_PRIszt,
       random_access_max_buffer_size);
@@ -229,6 +233,8 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    concurrent_prepare);
   ROCKS_LOG_HEADER(log, "            Options.manual_wal_flush: %d",
                    manual_wal_flush);
+  ROCKS_LOG_HEADER(log, "            Options.persist_stats_to_disk: %d",
+                   persist_stats_to_disk);
 }
 
 MutableDBOptions::MutableDBOptions()
@@ -240,6 +246,8 @@ MutableDBOptions::MutableDBOptions()
       max_total_wal_size(0),
       delete_obsolete_files_period_micros(6ULL * 60 * 60 * 1000000),
       stats_dump_period_sec(600),
+      stats_persist_period_sec(0),
+      stats_history_buffer_size(1024 * 1024),
       max_open_files(-1) {}
 
 MutableDBOptions::MutableDBOptions(const DBOptions& options)
@@ -252,6 +260,8 @@ MutableDBOptions::MutableDBOptions(const DBOptions& options)
       delete_obsolete_files_period_micros(
           options.delete_obsolete_files_period_micros),
       stats_dump_period_sec(options.stats_dump_period_sec),
+      stats_persist_period_sec(options.stats_persist_period_sec),
+      stats_history_buffer_size(options.stats_history_buffer_size),
       max_open_files(options.max_open_files) {}
 
 void MutableDBOptions::Dump(Logger* log) const {
@@ -270,6 +280,11 @@ void MutableDBOptions::Dump(Logger* log) const {
       delete_obsolete_files_period_micros);
   ROCKS_LOG_HEADER(log, "                  Options.stats_dump_period_sec: %u",
                    stats_dump_period_sec);
+  ROCKS_LOG_HEADER(log, "               Options.stats_persist_period_sec: %u",
+                   stats_persist_period_sec);
+  ROCKS_LOG_HEADER(
+      log, "              Options.stats_history_buffer_size: %" ROCKSDB_PRIszt,
+      stats_history_buffer_size);
   ROCKS_LOG_HEADER(log, "                         Options.max_open_files: %d",
                    max_open_files);
 }
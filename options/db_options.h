@@ -56,6 +56,7 @@ struct ImmutableDBOptions {
   DBOptions::AccessHint access_hint_on_compaction_start;
   bool new_table_reader_for_compaction_inputs;
   size_t compaction_readahead_size;
+  int compaction_readahead_threads;
   size_t random_access_max_buffer_size;
   size_t writable_file_max_buffer_size;
   bool use_adaptive_mutex;
@@ -81,6 +82,7 @@ struct ImmutableDBOptions {
   bool allow_ingest_behind;
   bool concurrent_prepare;
   bool manual_wal_flush;
+  bool persist_stats_to_disk;
 };
 
 struct MutableDBOptions {
@@ -98,6 +100,8 @@ struct MutableDBOptions {
   uint64_t max_total_wal_size;
   uint64_t delete_obsolete_files_period_micros;
   unsigned int stats_dump_period_sec;
+  unsigned int stats_persist_period_sec;
+  size_t stats_history_buffer_size;
   int max_open_files;
 };
 
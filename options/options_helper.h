@@ -35,7 +35,8 @@ static std::map<CompactionPri, std::string> compaction_pri_to_string = {
     {kByCompensatedSize, "kByCompensatedSize"},
     {kOldestLargestSeqFirst, "kOldestLargestSeqFirst"},
     {kOldestSmallestSeqFirst, "kOldestSmallestSeqFirst"},
-    {kMinOverlappingRatio, "kMinOverlappingRatio"}};
+    {kMinOverlappingRatio, "kMinOverlappingRatio"},
+    {kColdestFirst, "kColdestFirst"}};
 
 static std::map<CompactionStopStyle, std::string>
     compaction_stop_style_to_string = {
@@ -211,6 +212,9 @@ static std::unordered_map<std::string, OptionTypeInfo> db_options_type_info = {
     {"compaction_readahead_size",
      {offsetof(struct DBOptions, compaction_readahead_size), OptionType::kSizeT,
       OptionVerificationType::kNormal, false, 0}},
+    {"compaction_readahead_threads",
+     {offsetof(struct DBOptions, compaction_readahead_threads),
+      OptionType::kInt, OptionVerificationType::kNormal, false, 0}},
     {"random_access_max_buffer_size",
      {offsetof(struct DBOptions, random_access_max_buffer_size),
       OptionType::kSizeT, OptionVerificationType::kNormal, false, 0}},
@@ -306,6 +310,18 @@ static std::unordered_map<std::string, OptionTypeInfo> db_options_type_info = {
      {offsetof(struct DBOptions, stats_dump_period_sec), OptionType::kUInt,
       OptionVerificationType::kNormal, true,
       offsetof(struct MutableDBOptions, stats_dump_period_sec)}},
+    {"stats_persist_period_sec",
+     {offsetof(struct DBOptions, stats_persist_period_sec), OptionType::kUInt,
+      OptionVerificationType::kNormal, true,
+      offsetof(struct MutableDBOptions, stats_persist_period_sec)}},
+    {"persist_stats_to_disk",
+     {offsetof(struct DBOptions, persist_stats_to_disk), OptionType::kBoolean,
+      OptionVerificationType::kNormal, false,
+      offsetof(struct ImmutableDBOptions, persist_stats_to_disk)}},
+    {"stats_history_buffer_size",
+     {offsetof(struct DBOptions, stats_history_buffer_size),
+      OptionType::kSizeT, OptionVerificationType::kNormal, true,
+      offsetof(struct MutableDBOptions, stats_history_buffer_size)}},
     {"fail_if_options_file_error",
      {offsetof(struct DBOptions, fail_if_options_file_error),
       OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
@@ -552,6 +568,10 @@ static std::unordered_map<std::string, OptionTypeInfo> cf_options_type_info = {
           &ColumnFamilyOptions::memtable_insert_with_hint_prefix_extractor),
       OptionType::kSliceTransform, OptionVerificationType::kByNameAllowNull,
       false, 0}},
+    {"key_hotness_prefix_extractor",
+     {offset_of(&ColumnFamilyOptions::key_hotness_prefix_extractor),
+      OptionType::kSliceTransform, OptionVerificationType::kByNameAllowNull,
+      false, 0}},
     {"memtable_factory",
      {offset_of(&ColumnFamilyOptions::memtable_factory),
       OptionType::kMemTableRepFactory, OptionVerificationType::kByName, false,
@@ -615,7 +635,8 @@ static std::unordered_map<std::string, CompactionPri>
         {"kByCompensatedSize", kByCompensatedSize},
         {"kOldestLargestSeqFirst", kOldestLargestSeqFirst},
         {"kOldestSmallestSeqFirst", kOldestSmallestSeqFirst},
-        {"kMinOverlappingRatio", kMinOverlappingRatio}};
+        {"kMinOverlappingRatio", kMinOverlappingRatio},
+        {"kColdestFirst", kColdestFirst}};
 
 static std::unordered_map<std::string,
                           WALRecoveryMode> wal_recovery_mode_string_map = {
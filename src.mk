@@ -73,9 +73,11 @@ LIB_SOURCES =                                                   \
   monitoring/histogram_windowing.cc                             \
   monitoring/instrumented_mutex.cc                              \
   monitoring/iostats_context.cc                                 \
+  monitoring/key_range_hotness.cc                               \
   monitoring/perf_context.cc                                    \
   monitoring/perf_level.cc                                      \
   monitoring/statistics.cc                                      \
+  monitoring/stats_history.cc                                   \
   monitoring/thread_status_impl.cc                              \
   monitoring/thread_status_updater.cc                           \
   monitoring/thread_status_updater_debug.cc                     \
@@ -96,8 +98,10 @@ LIB_SOURCES =                                                   \
   table/block_based_table_factory.cc                            \
   table/block_based_table_reader.cc                             \
   table/block_builder.cc                                        \
+  table/block_learned_index.cc                                  \
   table/block_prefix_index.cc                                   \
   table/bloom_block.cc                                          \
+  table/column_aware_block.cc                                   \
   table/cuckoo_table_builder.cc                                 \
   table/cuckoo_table_factory.cc                                 \
   table/cuckoo_table_reader.cc                                  \
@@ -116,12 +120,14 @@ LIB_SOURCES =                                                   \
   table/plain_table_index.cc                                    \
   table/plain_table_key_coding.cc                               \
   table/plain_table_reader.cc                                   \
+  table/range_filter_block.cc                                   \
   table/sst_file_writer.cc                                      \
   table/table_properties.cc                                     \
   table/two_level_iterator.cc                                   \
   tools/dump/db_dump_tool.cc                                    \
   util/arena.cc                                                 \
   util/auto_roll_logger.cc                                      \
+  util/block_cache_tracer.cc                                    \
   util/bloom.cc                                                 \
   util/build_version.cc                                         \
   util/coding.cc                                                \
@@ -139,6 +145,7 @@ LIB_SOURCES =                                                   \
   util/hash.cc                                                  \
   util/log_buffer.cc                                            \
   util/murmurhash.cc                                            \
+  util/pooled_memory_allocator.cc                               \
   util/random.cc                                                \
   util/rate_limiter.cc                                          \
   util/slice.cc                                                 \
@@ -149,7 +156,9 @@ LIB_SOURCES =                                                   \
   util/sync_point.cc                                            \
   util/thread_local.cc                                          \
   util/threadpool_imp.cc                                        \
+  util/trace_replay.cc                                          \
   util/transaction_test_util.cc                                 \
+  util/xor_filter.cc                                            \
   util/xxhash.cc                                                \
   utilities/backupable/backupable_db.cc                         \
   utilities/blob_db/blob_db.cc                                  \
@@ -170,6 +179,7 @@ LIB_SOURCES =                                                   \
   utilities/document/document_db.cc                             \
   utilities/document/json_document.cc                           \
   utilities/document/json_document_builder.cc                   \
+  utilities/env_io_tracing.cc                                   \
   utilities/env_mirror.cc                                       \
   utilities/env_timed.cc                                        \
   utilities/geodb/geodb_impl.cc                                 \
@@ -189,9 +199,12 @@ LIB_SOURCES =                                                   \
   utilities/persistent_cache/persistent_cache_tier.cc           \
   utilities/persistent_cache/volatile_tier_impl.cc              \
   utilities/redis/redis_lists.cc                                \
+  utilities/simulator_cache/cache_simulator.cc                  \
   utilities/simulator_cache/sim_cache.cc                        \
+  utilities/simulator_compaction/compaction_simulator.cc        \
   utilities/spatialdb/spatial_db.cc                             \
   utilities/table_properties_collectors/compact_on_deletion_collector.cc \
+  utilities/trace/file_trace_reader_writer.cc                   \
   utilities/transactions/optimistic_transaction_db_impl.cc      \
   utilities/transactions/optimistic_transaction.cc         \
   utilities/transactions/transaction_base.cc                    \
@@ -228,6 +241,15 @@ MOCK_LIB_SOURCES = \
 BENCH_LIB_SOURCES = \
   tools/db_bench_tool.cc                                        \
 
+# Google Benchmark microbenchmarks, see `make microbench`
+MICROBENCH_SOURCES = \
+  microbench/arena_bench.cc                                     \
+  microbench/coding_bench.cc                                    \
+  microbench/dbformat_bench.cc                                  \
+  microbench/filter_bench.cc                                    \
+  microbench/iterator_bench.cc                                  \
+  microbench/write_batch_bench.cc                               \
+
 EXP_LIB_SOURCES = \
   utilities/col_buf_encoder.cc                                          \
   utilities/col_buf_decoder.cc                                          \
@@ -308,13 +330,17 @@ MAIN_SOURCES =                                                    \
   monitoring/histogram_test.cc                                          \
   monitoring/iostats_context_test.cc                                    \
   monitoring/statistics_test.cc                                         \
+  monitoring/stats_history_test.cc                                      \
   options/options_test.cc                                               \
   table/block_based_filter_block_test.cc                                \
+  table/block_learned_index_test.cc                                     \
   table/block_test.cc                                                   \
+  table/column_aware_block_test.cc                                      \
   table/cuckoo_table_builder_test.cc                                    \
   table/cuckoo_table_reader_test.cc                                     \
   table/full_filter_block_test.cc                                       \
   table/merger_test.cc                                                  \
+  table/range_filter_block_test.cc                                      \
   table/table_reader_bench.cc                                           \
   table/table_test.cc                                                   \
   third-party/gtest-1.7.0/fused-src/gtest/gtest-all.cc                  \
@@ -334,11 +360,13 @@ MAIN_SOURCES =                                                    \
   util/event_logger_test.cc                                             \
   util/filelock_test.cc                                                 \
   util/log_write_bench.cc                                               \
+  util/memory_allocator_test.cc                                         \
   util/rate_limiter_test.cc                                             \
   util/slice_transform_test.cc                                          \
   util/timer_queue_test.cc                                              \
   util/thread_list_test.cc                                              \
   util/thread_local_test.cc                                             \
+  util/xor_filter_test.cc                                               \
   utilities/backupable/backupable_db_test.cc                            \
   utilities/blob_db/blob_db_test.cc                                     \
   utilities/cassandra/cassandra_format_test.cc                          \
@@ -351,6 +379,7 @@ MAIN_SOURCES =                                                    \
   utilities/date_tiered/date_tiered_test.cc                             \
   utilities/document/document_db_test.cc                                \
   utilities/document/json_document_test.cc                              \
+  utilities/env_io_tracing_test.cc                                      \
   utilities/geodb/geodb_test.cc                                         \
   utilities/lua/rocks_lua_test.cc                                       \
   utilities/memory/memory_test.cc                                       \
@@ -359,7 +388,9 @@ MAIN_SOURCES =                                                    \
   utilities/option_change_migration/option_change_migration_test.cc     \
   utilities/options/options_util_test.cc                                \
   utilities/redis/redis_lists_test.cc                                   \
+  utilities/simulator_cache/cache_simulator_test.cc                     \
   utilities/simulator_cache/sim_cache_test.cc                           \
+  utilities/simulator_compaction/compaction_simulator_test.cc           \
   utilities/spatialdb/spatial_db_test.cc                                \
   utilities/table_properties_collectors/compact_on_deletion_collector_test.cc  \
   utilities/transactions/optimistic_transaction_test.cc                 \
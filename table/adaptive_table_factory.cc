@@ -5,6 +5,8 @@
 #ifndef ROCKSDB_LITE
 #include "table/adaptive_table_factory.h"
 
+#include <algorithm>
+
 #include "table/table_builder.h"
 #include "table/format.h"
 #include "port/port.h"
@@ -15,8 +17,10 @@ AdaptiveTableFactory::AdaptiveTableFactory(
     std::shared_ptr<TableFactory> table_factory_to_write,
     std::shared_ptr<TableFactory> block_based_table_factory,
     std::shared_ptr<TableFactory> plain_table_factory,
-    std::shared_ptr<TableFactory> cuckoo_table_factory)
+    std::shared_ptr<TableFactory> cuckoo_table_factory,
+    std::vector<std::shared_ptr<TableFactory>> table_factory_per_level)
     : table_factory_to_write_(table_factory_to_write),
+      table_factory_per_level_(std::move(table_factory_per_level)),
       block_based_table_factory_(block_based_table_factory),
       plain_table_factory_(plain_table_factory),
       cuckoo_table_factory_(cuckoo_table_factory) {
@@ -67,11 +71,41 @@ Status AdaptiveTableFactory::NewTableReader(
   }
 }
 
+TableFactory* AdaptiveTableFactory::TableFactoryToWrite(int level) const {
+  if (level < 0 || table_factory_per_level_.empty()) {
+    return table_factory_to_write_.get();
+  }
+  size_t index = std::min(static_cast<size_t>(level),
+                          table_factory_per_level_.size() - 1);
+  if (!table_factory_per_level_[index]) {
+    return table_factory_to_write_.get();
+  }
+  return table_factory_per_level_[index].get();
+}
+
 TableBuilder* AdaptiveTableFactory::NewTableBuilder(
     const TableBuilderOptions& table_builder_options, uint32_t column_family_id,
     WritableFileWriter* file) const {
-  return table_factory_to_write_->NewTableBuilder(table_builder_options,
-                                                  column_family_id, file);
+  return TableFactoryToWrite(table_builder_options.level)
+      ->NewTableBuilder(table_builder_options, column_family_id, file);
+}
+
+Status AdaptiveTableFactory::SanitizeOptions(
+    const DBOptions& db_opts, const ColumnFamilyOptions& cf_opts) const {
+  // table_factory_to_write_ writes the levels without a factory of their own
+  Status s = table_factory_to_write_->SanitizeOptions(db_opts, cf_opts);
+  if (!s.ok()) {
+    return s;
+  }
+  for (const auto& factory : table_factory_per_level_) {
+    if (factory) {
+      s = factory->SanitizeOptions(db_opts, cf_opts);
+      if (!s.ok()) {
+        return s;
+      }
+    }
+  }
+  return Status::OK();
 }
 
 std::string AdaptiveTableFactory::GetPrintableTableOptions() const {
@@ -87,6 +121,17 @@ std::string AdaptiveTableFactory::GetPrintableTableOptions() const {
              table_factory_to_write_->GetPrintableTableOptions().c_str());
     ret.append(buffer);
   }
+  for (size_t level = 0; level < table_factory_per_level_.size(); level++) {
+    const auto& factory = table_factory_per_level_[level];
+    if (!factory) {
+      continue;
+    }
+    snprintf(buffer, kBufferSize, "  level %d write factory (%s) options:\n",
+             static_cast<int>(level), factory->Name() ? factory->Name() : "");
+    ret.append(buffer);
+    ret.append(factory->GetPrintableTableOptions());
+    ret.append("\n");
+  }
   if (plain_table_factory_) {
     snprintf(buffer, kBufferSize, "  %s options:\n%s\n",
              plain_table_factory_->Name() ? plain_table_factory_->Name() : "",
@@ -114,9 +159,11 @@ extern TableFactory* NewAdaptiveTableFactory(
     std::shared_ptr<TableFactory> table_factory_to_write,
     std::shared_ptr<TableFactory> block_based_table_factory,
     std::shared_ptr<TableFactory> plain_table_factory,
-    std::shared_ptr<TableFactory> cuckoo_table_factory) {
-  return new AdaptiveTableFactory(table_factory_to_write,
-      block_based_table_factory, plain_table_factory, cuckoo_table_factory);
+    std::shared_ptr<TableFactory> cuckoo_table_factory,
+    std::vector<std::shared_ptr<TableFactory>> table_factory_per_level) {
+  return new AdaptiveTableFactory(
+      table_factory_to_write, block_based_table_factory, plain_table_factory,
+      cuckoo_table_factory, std::move(table_factory_per_level));
 }
 
 }  // namespace rocksdb
@@ -7,6 +7,7 @@
 #ifndef ROCKSDB_LITE
 
 #include <string>
+#include <vector>
 #include "rocksdb/options.h"
 #include "rocksdb/table.h"
 
@@ -29,7 +30,9 @@ class AdaptiveTableFactory : public TableFactory {
       std::shared_ptr<TableFactory> table_factory_to_write,
       std::shared_ptr<TableFactory> block_based_table_factory,
       std::shared_ptr<TableFactory> plain_table_factory,
-      std::shared_ptr<TableFactory> cuckoo_table_factory);
+      std::shared_ptr<TableFactory> cuckoo_table_factory,
+      std::vector<std::shared_ptr<TableFactory>> table_factory_per_level =
+          {});
 
   const char* Name() const override { return "AdaptiveTableFactory"; }
 
@@ -43,16 +46,24 @@ class AdaptiveTableFactory : public TableFactory {
       const TableBuilderOptions& table_builder_options,
       uint32_t column_family_id, WritableFileWriter* file) const override;
 
-  // Sanitizes the specified DB Options.
+  // Sanitizes the specified DB Options for the per-level write factories.
   Status SanitizeOptions(const DBOptions& db_opts,
-                         const ColumnFamilyOptions& cf_opts) const override {
-    return Status::OK();
-  }
+                         const ColumnFamilyOptions& cf_opts) const override;
 
   std::string GetPrintableTableOptions() const override;
 
+  // Returns the factory that writes files of the given level
+  // (-1 if unknown).
+  TableFactory* TableFactoryToWrite(int level) const;
+
+  // The factory that reads block-based tables
+  TableFactory* block_based_table_factory() const {
+    return block_based_table_factory_.get();
+  }
+
  private:
   std::shared_ptr<TableFactory> table_factory_to_write_;
+  std::vector<std::shared_ptr<TableFactory>> table_factory_per_level_;
   std::shared_ptr<TableFactory> block_based_table_factory_;
   std::shared_ptr<TableFactory> plain_table_factory_;
   std::shared_ptr<TableFactory> cuckoo_table_factory_;
@@ -20,6 +20,7 @@
 #include "port/stack_trace.h"
 #include "rocksdb/comparator.h"
 #include "table/block_prefix_index.h"
+#include "table/column_aware_block.h"
 #include "table/format.h"
 #include "util/coding.h"
 #include "util/logging.h"
@@ -56,6 +57,66 @@ static inline const char* DecodeEntry(const char* p, const char* limit,
   return p;
 }
 
+// Like DecodeEntry, for blocks with delta-encoded values, whose entries have
+// no value length.
+static inline const char* DecodeKeyEntry(const char* p, const char* limit,
+                                         uint32_t* shared,
+                                         uint32_t* non_shared) {
+  // Two bytes for the lengths and at least one for the value
+  if (limit - p < 3) return nullptr;
+  *shared = reinterpret_cast<const unsigned char*>(p)[0];
+  *non_shared = reinterpret_cast<const unsigned char*>(p)[1];
+  if ((*shared | *non_shared) < 128) {
+    // Fast path: both values are encoded in one byte each
+    p += 2;
+  } else {
+    if ((p = GetVarint32Ptr(p, limit, shared)) == nullptr) return nullptr;
+    if ((p = GetVarint32Ptr(p, limit, non_shared)) == nullptr) return nullptr;
+  }
+
+  if (static_cast<uint32_t>(limit - p) < *non_shared) {
+    return nullptr;
+  }
+  return p;
+}
+
+const char* BlockIter::DecodeEntryHeader(const char* p, const char* limit,
+                                         uint32_t* shared,
+                                         uint32_t* non_shared,
+                                         uint32_t* value_length) const {
+  if (value_delta_encoded_) {
+    return DecodeKeyEntry(p, limit, shared, non_shared);
+  }
+  return DecodeEntry(p, limit, shared, non_shared, value_length);
+}
+
+bool BlockIter::DecodeDeltaEncodedValue(const char* p, const char* limit,
+                                        bool is_full_handle) {
+  const char* q;
+  if (is_full_handle) {
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    q = GetVarint64Ptr(p, limit, &offset);
+    if (q != nullptr) {
+      q = GetVarint64Ptr(q, limit, &size);
+    }
+    decoded_value_ = BlockHandle(offset, size);
+  } else {
+    // Blocks are written back to back, so this one starts right after the
+    // previous block and its trailer. Only the change in size is stored.
+    int64_t size_delta = 0;
+    q = GetVarsignedint64Ptr(p, limit, &size_delta);
+    decoded_value_ = BlockHandle(
+        decoded_value_.offset() + decoded_value_.size() + kBlockTrailerSize,
+        decoded_value_.size() + size_delta);
+  }
+  if (q == nullptr) {
+    return false;
+  }
+  value_ = Slice(p, static_cast<size_t>(q - p));
+  return true;
+}
+
 void BlockIter::Next() {
   assert(Valid());
   ParseNextKey();
@@ -64,9 +125,22 @@ void BlockIter::Next() {
 void BlockIter::Prev() {
   assert(Valid());
 
+  if (fixed_key_size_ != 0) {
+    // Every entry is a restart point
+    if (restart_index_ == 0) {
+      current_ = restarts_;
+      restart_index_ = num_restarts_;
+      return;
+    }
+    SeekToRestartPoint(restart_index_ - 1);
+    ParseNextKey();
+    return;
+  }
+
   assert(prev_entries_idx_ == -1 ||
          static_cast<size_t>(prev_entries_idx_) < prev_entries_.size());
-  // Check if we can use cached prev_entries_
+  // Check if we can use cached prev_entries_. They are not kept for
+  // delta-encoded values, which can only be decoded going forward.
   if (prev_entries_idx_ > 0 &&
       prev_entries_[prev_entries_idx_].offset == current_) {
     // Read cached CachedPrevEntry
@@ -87,7 +161,11 @@ void BlockIter::Prev() {
     const Slice current_key(key_ptr, current_prev_entry.key_size);
 
     current_ = current_prev_entry.offset;
-    key_.SetInternalKey(current_key, false /* copy */);
+    if (key_includes_seq_) {
+      key_.SetInternalKey(current_key, false /* copy */);
+    } else {
+      key_.SetUserKey(current_key, false /* copy */);
+    }
     value_ = current_prev_entry.value;
 
     return;
@@ -116,7 +194,10 @@ void BlockIter::Prev() {
     if (!ParseNextKey()) {
       break;
     }
-    Slice current_key = key();
+    if (value_delta_encoded_) {
+      continue;
+    }
+    Slice current_key = RawKey();
 
     if (key_.IsKeyPinned()) {
       // The key is not delta encoded
@@ -132,7 +213,9 @@ void BlockIter::Prev() {
     }
     // Loop until end of current entry hits the start of original entry
   } while (NextEntryOffset() < original);
-  prev_entries_idx_ = static_cast<int32_t>(prev_entries_.size()) - 1;
+  if (!value_delta_encoded_) {
+    prev_entries_idx_ = static_cast<int32_t>(prev_entries_.size()) - 1;
+  }
 }
 
 void BlockIter::Seek(const Slice& target) {
@@ -144,6 +227,8 @@ void BlockIter::Seek(const Slice& target) {
   bool ok = false;
   if (prefix_index_) {
     ok = PrefixSeek(target, &index);
+  } else if (learned_index_) {
+    ok = LearnedSeek(target, &index);
   } else {
     ok = BinarySeek(target, 0, num_restarts_ - 1, &index);
   }
@@ -155,7 +240,7 @@ void BlockIter::Seek(const Slice& target) {
   // Linear search (within restart block) for first key >= target
 
   while (true) {
-    if (!ParseNextKey() || Compare(key_.GetInternalKey(), target) >= 0) {
+    if (!ParseNextKey() || Compare(RawKey(), target) >= 0) {
       return;
     }
   }
@@ -168,7 +253,11 @@ void BlockIter::SeekForPrev(const Slice& target) {
   }
   uint32_t index = 0;
   bool ok = false;
-  ok = BinarySeek(target, 0, num_restarts_ - 1, &index);
+  if (learned_index_) {
+    ok = LearnedSeek(target, &index);
+  } else {
+    ok = BinarySeek(target, 0, num_restarts_ - 1, &index);
+  }
 
   if (!ok) {
     return;
@@ -176,12 +265,12 @@ void BlockIter::SeekForPrev(const Slice& target) {
   SeekToRestartPoint(index);
   // Linear search (within restart block) for first key >= target
 
-  while (ParseNextKey() && Compare(key_.GetInternalKey(), target) < 0) {
+  while (ParseNextKey() && Compare(RawKey(), target) < 0) {
   }
   if (!Valid()) {
     SeekToLast();
   } else {
-    while (Valid() && Compare(key_.GetInternalKey(), target) > 0) {
+    while (Valid() && Compare(RawKey(), target) > 0) {
       Prev();
     }
   }
@@ -224,9 +313,18 @@ bool BlockIter::ParseNextKey() {
     return false;
   }
 
+  if (fixed_key_size_ != 0) {
+    if (!DecodeFixedSizeEntry()) {
+      CorruptionError();
+      return false;
+    }
+    UpdateGlobalSeqno();
+    return true;
+  }
+
   // Decode next entry
   uint32_t shared, non_shared, value_length;
-  p = DecodeEntry(p, limit, &shared, &non_shared, &value_length);
+  p = DecodeEntryHeader(p, limit, &shared, &non_shared, &value_length);
   if (p == nullptr || key_.Size() < shared) {
     CorruptionError();
     return false;
@@ -234,7 +332,11 @@ bool BlockIter::ParseNextKey() {
     if (shared == 0) {
       // If this key dont share any bytes with prev key then we dont need
       // to decode it and can use it's address in the block directly.
-      key_.SetInternalKey(Slice(p, non_shared), false /* copy */);
+      if (key_includes_seq_) {
+        key_.SetInternalKey(Slice(p, non_shared), false /* copy */);
+      } else {
+        key_.SetUserKey(Slice(p, non_shared), false /* copy */);
+      }
       key_pinned_ = true;
     } else {
       // This key share `shared` bytes with prev key, we need to decode it
@@ -242,31 +344,16 @@ bool BlockIter::ParseNextKey() {
       key_pinned_ = false;
     }
 
-    if (global_seqno_ != kDisableGlobalSequenceNumber) {
-      // If we are reading a file with a global sequence number we should
-      // expect that all encoded sequence numbers are zeros and any value
-      // type is kTypeValue, kTypeMerge or kTypeDeletion
-      assert(GetInternalKeySeqno(key_.GetInternalKey()) == 0);
-
-      ValueType value_type = ExtractValueType(key_.GetInternalKey());
-      assert(value_type == ValueType::kTypeValue ||
-             value_type == ValueType::kTypeMerge ||
-             value_type == ValueType::kTypeDeletion);
-
-      if (key_pinned_) {
-        // TODO(tec): Investigate updating the seqno in the loaded block
-        // directly instead of doing a copy and update.
-
-        // We cannot use the key address in the block directly because
-        // we have a global_seqno_ that will overwrite the encoded one.
-        key_.OwnKey();
-        key_pinned_ = false;
-      }
+    UpdateGlobalSeqno();
 
-      key_.UpdateInternalKey(global_seqno_, value_type);
+    if (value_delta_encoded_) {
+      if (!DecodeDeltaEncodedValue(p + non_shared, limit, shared == 0)) {
+        CorruptionError();
+        return false;
+      }
+    } else {
+      value_ = Slice(p + non_shared, value_length);
     }
-
-    value_ = Slice(p + non_shared, value_length);
     while (restart_index_ + 1 < num_restarts_ &&
            GetRestartPoint(restart_index_ + 1) < current_) {
       ++restart_index_;
@@ -275,6 +362,82 @@ bool BlockIter::ParseNextKey() {
   }
 }
 
+void BlockIter::UpdateGlobalSeqno() {
+  if (global_seqno_ == kDisableGlobalSequenceNumber || !key_includes_seq_) {
+    return;
+  }
+  // If we are reading a file with a global sequence number we should
+  // expect that all encoded sequence numbers are zeros and any value
+  // type is kTypeValue, kTypeMerge or kTypeDeletion
+  assert(GetInternalKeySeqno(key_.GetInternalKey()) == 0);
+
+  ValueType value_type = ExtractValueType(key_.GetInternalKey());
+  assert(value_type == ValueType::kTypeValue ||
+         value_type == ValueType::kTypeMerge ||
+         value_type == ValueType::kTypeDeletion);
+
+  if (key_pinned_) {
+    // TODO(tec): Investigate updating the seqno in the loaded block
+    // directly instead of doing a copy and update.
+
+    // We cannot use the key address in the block directly because
+    // we have a global_seqno_ that will overwrite the encoded one.
+    key_.OwnKey();
+    key_pinned_ = false;
+  }
+
+  key_.UpdateInternalKey(global_seqno_, value_type);
+}
+
+bool BlockIter::DecodeFixedSizeEntry() {
+  assert(key_includes_seq_ && !value_delta_encoded_);
+  // Every entry is a restart point, so restart_index_ is either the index
+  // of this entry or, after Next(), of the one before it.
+  if (GetRestartPoint(restart_index_) < current_) {
+    if (++restart_index_ == num_restarts_) {
+      return false;
+    }
+  }
+  uint32_t next_offset;
+  if (fixed_entry_size_ != 0) {
+    next_offset = current_ + fixed_entry_size_;
+  } else if (restart_index_ + 1 < num_restarts_) {
+    next_offset = GetRestartPoint(restart_index_ + 1);
+  } else {
+    next_offset = restarts_;
+  }
+  if (GetRestartPoint(restart_index_) != current_ || next_offset > restarts_ ||
+      next_offset < current_ + fixed_key_size_) {
+    return false;
+  }
+  const char* p = data_ + current_;
+  key_.SetInternalKey(Slice(p, fixed_key_size_), false /* copy */);
+  key_pinned_ = true;
+  value_ = Slice(p + fixed_key_size_, next_offset - current_ - fixed_key_size_);
+  return true;
+}
+
+bool BlockIter::DecodeRestartKey(uint32_t index, Slice* key) {
+  uint32_t region_offset = GetRestartPoint(index);
+  if (fixed_key_size_ != 0) {
+    if (region_offset >= restarts_ ||
+        restarts_ - region_offset < fixed_key_size_) {
+      return false;
+    }
+    *key = Slice(data_ + region_offset, fixed_key_size_);
+    return true;
+  }
+  uint32_t shared, non_shared, value_length;
+  const char* key_ptr =
+      DecodeEntryHeader(data_ + region_offset, data_ + restarts_, &shared,
+                        &non_shared, &value_length);
+  if (key_ptr == nullptr || (shared != 0)) {
+    return false;
+  }
+  *key = Slice(key_ptr, non_shared);
+  return true;
+}
+
 // Binary search in restart array to find the first restart point that
 // is either the last restart point with a key less than target,
 // which means the key of next restart point is larger than target, or
@@ -285,15 +448,11 @@ bool BlockIter::BinarySeek(const Slice& target, uint32_t left, uint32_t right,
 
   while (left < right) {
     uint32_t mid = (left + right + 1) / 2;
-    uint32_t region_offset = GetRestartPoint(mid);
-    uint32_t shared, non_shared, value_length;
-    const char* key_ptr = DecodeEntry(data_ + region_offset, data_ + restarts_,
-                                      &shared, &non_shared, &value_length);
-    if (key_ptr == nullptr || (shared != 0)) {
+    Slice mid_key;
+    if (!DecodeRestartKey(mid, &mid_key)) {
       CorruptionError();
       return false;
     }
-    Slice mid_key(key_ptr, non_shared);
     int cmp = Compare(mid_key, target);
     if (cmp < 0) {
       // Key at "mid" is smaller than "target". Therefore all
@@ -312,18 +471,42 @@ bool BlockIter::BinarySeek(const Slice& target, uint32_t left, uint32_t right,
   return true;
 }
 
+// Like BinarySeek() over all restart points, but only searches the window
+// that the learned index predicts for target. The result is checked against
+// the restart points just outside of the window, and the whole block is
+// searched if target turns out not to lie within it.
+bool BlockIter::LearnedSeek(const Slice& target, uint32_t* index) {
+  assert(learned_index_ != nullptr);
+  uint32_t left, right;
+  learned_index_->Predict(ExtractUserKey(target), &left, &right);
+  if (!BinarySeek(target, left, right, index)) {
+    return false;
+  }
+  bool in_window = true;
+  if (*index == left && left > 0) {
+    // BinarySeek() never looks at the key of `left` itself
+    in_window = CompareBlockKey(left, target) < 0;
+  }
+  if (in_window && *index == right && right + 1 < num_restarts_) {
+    in_window = CompareBlockKey(right + 1, target) >= 0;
+  }
+  if (!status_.ok()) {
+    return false;
+  }
+  if (!in_window) {
+    return BinarySeek(target, 0, num_restarts_ - 1, index);
+  }
+  return true;
+}
+
 // Compare target key and the block key of the block of `block_index`.
 // Return -1 if error.
 int BlockIter::CompareBlockKey(uint32_t block_index, const Slice& target) {
-  uint32_t region_offset = GetRestartPoint(block_index);
-  uint32_t shared, non_shared, value_length;
-  const char* key_ptr = DecodeEntry(data_ + region_offset, data_ + restarts_,
-                                    &shared, &non_shared, &value_length);
-  if (key_ptr == nullptr || (shared != 0)) {
+  Slice block_key;
+  if (!DecodeRestartKey(block_index, &block_key)) {
     CorruptionError();
     return 1;  // Return target is smaller
   }
-  Slice block_key(key_ptr, non_shared);
   return Compare(block_key, target);
 }
 
@@ -394,24 +577,82 @@ bool BlockIter::PrefixSeek(const Slice& target, uint32_t* index) {
 
 uint32_t Block::NumRestarts() const {
   assert(size_ >= 2*sizeof(uint32_t));
-  return DecodeFixed32(data_ + size_ - sizeof(uint32_t));
+  return DecodeFixed32(data_ + size_ - sizeof(uint32_t)) &
+         ~(BlockLearnedIndex::kLearnedIndexFlag | BlockBuilder::kFixedSizeFlag);
 }
 
 Block::Block(BlockContents&& contents, SequenceNumber _global_seqno,
-             size_t read_amp_bytes_per_bit, Statistics* statistics)
+             size_t read_amp_bytes_per_bit, Statistics* statistics,
+             const std::vector<uint32_t>* column_projection)
     : contents_(std::move(contents)),
       data_(contents_.data.data()),
       size_(contents_.data.size()),
+      fixed_key_size_(0),
+      fixed_value_size_(0),
       global_seqno_(_global_seqno) {
+  if (contents_.compression_type == kNoCompression &&
+      IsColumnAwareBlock(contents_.data)) {
+    BlockContents decoded;
+    if (DecodeColumnAwareBlock(contents_.data, column_projection, &decoded)
+            .ok()) {
+      decoded.cachable = contents_.cachable;
+      contents_ = std::move(decoded);
+      data_ = contents_.data.data();
+      size_ = contents_.data.size();
+    } else {
+      size_ = 0;  // Error marker
+    }
+  }
   if (size_ < sizeof(uint32_t)) {
     size_ = 0;  // Error marker
+  } else if (DecodeFixed32(data_ + size_ - sizeof(uint32_t)) &
+             BlockBuilder::kFixedSizeFlag) {
+    const uint32_t num_entries = NumRestarts();
+    const size_t kFooterSize = 3 * sizeof(uint32_t);
+    if (size_ < kFooterSize) {
+      size_ = 0;
+    } else {
+      fixed_key_size_ = DecodeFixed32(data_ + size_ - kFooterSize);
+      fixed_value_size_ =
+          DecodeFixed32(data_ + size_ - kFooterSize + sizeof(uint32_t));
+      uint64_t trailer_size = kFooterSize;
+      uint64_t data_size = 0;
+      if (fixed_value_size_ == BlockBuilder::kVariableValueSize) {
+        trailer_size += static_cast<uint64_t>(num_entries) * sizeof(uint32_t);
+        data_size = size_ > trailer_size ? size_ - trailer_size : 0;
+      } else {
+        data_size = static_cast<uint64_t>(num_entries) *
+                    (static_cast<uint64_t>(fixed_key_size_) +
+                     fixed_value_size_);
+      }
+      if (fixed_key_size_ == 0 || trailer_size + data_size != size_ ||
+          data_size < static_cast<uint64_t>(num_entries) * fixed_key_size_) {
+        size_ = 0;
+        fixed_key_size_ = 0;
+      } else {
+        restart_offset_ = static_cast<uint32_t>(data_size);
+      }
+    }
   } else {
-    restart_offset_ =
-        static_cast<uint32_t>(size_) - (1 + NumRestarts()) * sizeof(uint32_t);
-    if (restart_offset_ > size_ - sizeof(uint32_t)) {
-      // The size is too small for NumRestarts() and therefore
-      // restart_offset_ wrapped around.
+    const uint32_t num_restarts = NumRestarts();
+    const bool has_learned_index =
+        (DecodeFixed32(data_ + size_ - sizeof(uint32_t)) &
+         BlockLearnedIndex::kLearnedIndexFlag) != 0;
+    uint64_t trailer_size =
+        (1 + static_cast<uint64_t>(num_restarts)) * sizeof(uint32_t);
+    if (has_learned_index) {
+      trailer_size += BlockLearnedIndex::kEncodedLength;
+    }
+    if (trailer_size > size_) {
+      // The size is too small for NumRestarts()
       size_ = 0;
+    } else {
+      restart_offset_ = static_cast<uint32_t>(size_ - trailer_size);
+      if (has_learned_index && num_restarts > 0) {
+        learned_index_.reset(new BlockLearnedIndex(
+            data_ + restart_offset_ + num_restarts * sizeof(uint32_t),
+            num_restarts));
+      }
     }
   }
   if (read_amp_bytes_per_bit != 0 && statistics && size_ != 0) {
@@ -421,7 +662,9 @@ Block::Block(BlockContents&& contents, SequenceNumber _global_seqno,
 }
 
 InternalIterator* Block::NewIterator(const Comparator* cmp, BlockIter* iter,
-                                     bool total_order_seek, Statistics* stats) {
+                                     bool total_order_seek, Statistics* stats,
+                                     bool key_includes_seq,
+                                     bool value_delta_encoded) {
   if (size_ < 2*sizeof(uint32_t)) {
     if (iter != nullptr) {
       iter->SetStatus(Status::Corruption("bad block contents"));
@@ -444,11 +687,16 @@ InternalIterator* Block::NewIterator(const Comparator* cmp, BlockIter* iter,
 
     if (iter != nullptr) {
       iter->Initialize(cmp, data_, restart_offset_, num_restarts,
-                       prefix_index_ptr, global_seqno_, read_amp_bitmap_.get());
+                       prefix_index_ptr, global_seqno_, read_amp_bitmap_.get(),
+                       key_includes_seq, value_delta_encoded,
+                       learned_index_.get(), fixed_key_size_,
+                       fixed_value_size_);
     } else {
       iter = new BlockIter(cmp, data_, restart_offset_, num_restarts,
                            prefix_index_ptr, global_seqno_,
-                           read_amp_bitmap_.get());
+                           read_amp_bitmap_.get(), key_includes_seq,
+                           value_delta_encoded, learned_index_.get(),
+                           fixed_key_size_, fixed_value_size_);
     }
 
     if (read_amp_bitmap_) {
@@ -462,6 +710,16 @@ InternalIterator* Block::NewIterator(const Comparator* cmp, BlockIter* iter,
   return iter;
 }
 
+InternalIterator* Block::NewIndexIterator(
+    const InternalKeyComparator* icomparator, BlockIter* iter,
+    bool total_order_seek, bool key_includes_seq, bool value_delta_encoded) {
+  const Comparator* cmp = key_includes_seq
+                              ? static_cast<const Comparator*>(icomparator)
+                              : icomparator->user_comparator();
+  return NewIterator(cmp, iter, total_order_seek, nullptr /* stats */,
+                     key_includes_seq, value_delta_encoded);
+}
+
 void Block::SetBlockPrefixIndex(BlockPrefixIndex* prefix_index) {
   prefix_index_.reset(prefix_index);
 }
@@ -471,6 +729,9 @@ size_t Block::ApproximateMemoryUsage() const {
   if (prefix_index_) {
     usage += prefix_index_->ApproximateMemoryUsage();
   }
+  if (learned_index_) {
+    usage += sizeof(BlockLearnedIndex);
+  }
   return usage;
 }
 
@@ -25,6 +25,8 @@
 #include "rocksdb/iterator.h"
 #include "rocksdb/options.h"
 #include "rocksdb/statistics.h"
+#include "table/block_builder.h"
+#include "table/block_learned_index.h"
 #include "table/block_prefix_index.h"
 #include "table/internal_iterator.h"
 #include "util/random.h"
@@ -132,10 +134,13 @@ class BlockReadAmpBitmap {
 
 class Block {
  public:
-  // Initialize the block with the specified contents.
+  // Initialize the block with the specified contents. Column-aware blocks
+  // are decoded into the regular layout; column_projection selects the
+  // value columns to decode (see ReadOptions::column_projection).
   explicit Block(BlockContents&& contents, SequenceNumber _global_seqno,
                  size_t read_amp_bytes_per_bit = 0,
-                 Statistics* statistics = nullptr);
+                 Statistics* statistics = nullptr,
+                 const std::vector<uint32_t>* column_projection = nullptr);
 
   ~Block() = default;
 
@@ -143,11 +148,16 @@ class Block {
   const char* data() const { return data_; }
   bool cachable() const { return contents_.cachable; }
   size_t usable_size() const {
-#ifdef ROCKSDB_MALLOC_USABLE_SIZE
     if (contents_.allocation.get() != nullptr) {
+      MemoryAllocator* allocator = contents_.allocation.get_deleter().allocator;
+      if (allocator != nullptr) {
+        return allocator->UsableSize(contents_.allocation.get(),
+                                     contents_.data.size());
+      }
+#ifdef ROCKSDB_MALLOC_USABLE_SIZE
       return malloc_usable_size(contents_.allocation.get());
-    }
 #endif  // ROCKSDB_MALLOC_USABLE_SIZE
+    }
     return size_;
   }
   uint32_t NumRestarts() const;
@@ -168,10 +178,26 @@ class Block {
   // If total_order_seek is true, hash_index_ and prefix_index_ are ignored.
   // This option only applies for index block. For data block, hash_index_
   // and prefix_index_ are null, so this option does not matter.
+  //
+  // key_includes_seq and value_delta_encoded describe index blocks, see
+  // NewIndexIterator().
   InternalIterator* NewIterator(const Comparator* comparator,
                                 BlockIter* iter = nullptr,
                                 bool total_order_seek = true,
-                                Statistics* stats = nullptr);
+                                Statistics* stats = nullptr,
+                                bool key_includes_seq = true,
+                                bool value_delta_encoded = false);
+
+  // Like NewIterator(), for an index block. If `key_includes_seq` is false
+  // the block stores user keys and the iterator compares them with the user
+  // comparator of `icomparator`. If `value_delta_encoded` is true the block
+  // handles are delta-encoded (see BlockBuilder). Either way the iterator
+  // returns internal keys and fully encoded block handles.
+  InternalIterator* NewIndexIterator(const InternalKeyComparator* icomparator,
+                                     BlockIter* iter = nullptr,
+                                     bool total_order_seek = true,
+                                     bool key_includes_seq = true,
+                                     bool value_delta_encoded = false);
   void SetBlockPrefixIndex(BlockPrefixIndex* prefix_index);
 
   // Report an approximation of how much memory has been used.
@@ -186,6 +212,11 @@ class Block {
   uint32_t restart_offset_;     // Offset in data_ of restart array
   std::unique_ptr<BlockPrefixIndex> prefix_index_;
   std::unique_ptr<BlockReadAmpBitmap> read_amp_bitmap_;
+  std::unique_ptr<BlockLearnedIndex> learned_index_;
+  // Key and value size of a block with the fixed-size layout (see
+  // block_builder.cc); fixed_key_size_ is 0 for other blocks.
+  uint32_t fixed_key_size_;
+  uint32_t fixed_value_size_;
   // All keys in the block will have seqno = global_seqno_, regardless of
   // the encoded value (kDisableGlobalSequenceNumber means disabled)
   const SequenceNumber global_seqno_;
@@ -209,20 +240,39 @@ class BlockIter : public InternalIterator {
         key_pinned_(false),
         global_seqno_(kDisableGlobalSequenceNumber),
         read_amp_bitmap_(nullptr),
-        last_bitmap_offset_(0) {}
+        last_bitmap_offset_(0),
+        key_includes_seq_(true),
+        value_delta_encoded_(false),
+        learned_index_(nullptr),
+        fixed_key_size_(0),
+        fixed_entry_size_(0) {}
 
   BlockIter(const Comparator* comparator, const char* data, uint32_t restarts,
             uint32_t num_restarts, BlockPrefixIndex* prefix_index,
-            SequenceNumber global_seqno, BlockReadAmpBitmap* read_amp_bitmap)
+            SequenceNumber global_seqno, BlockReadAmpBitmap* read_amp_bitmap,
+            bool key_includes_seq = true, bool value_delta_encoded = false,
+            const BlockLearnedIndex* learned_index = nullptr,
+            uint32_t fixed_key_size = 0, uint32_t fixed_value_size = 0)
       : BlockIter() {
     Initialize(comparator, data, restarts, num_restarts, prefix_index,
-               global_seqno, read_amp_bitmap);
+               global_seqno, read_amp_bitmap, key_includes_seq,
+               value_delta_encoded, learned_index, fixed_key_size,
+               fixed_value_size);
   }
 
+  // If key_includes_seq is false, comparator must be a user comparator.
+  // Seeks with a learned_index expect internal keys as targets.
+  // A non-zero fixed_key_size means the block has the fixed-size layout;
+  // `restarts` is then the offset of the entry offsets, or the end of the
+  // entries if fixed_value_size is not BlockBuilder::kVariableValueSize.
   void Initialize(const Comparator* comparator, const char* data,
                   uint32_t restarts, uint32_t num_restarts,
                   BlockPrefixIndex* prefix_index, SequenceNumber global_seqno,
-                  BlockReadAmpBitmap* read_amp_bitmap) {
+                  BlockReadAmpBitmap* read_amp_bitmap,
+                  bool key_includes_seq = true,
+                  bool value_delta_encoded = false,
+                  const BlockLearnedIndex* learned_index = nullptr,
+                  uint32_t fixed_key_size = 0, uint32_t fixed_value_size = 0) {
     assert(data_ == nullptr);           // Ensure it is called only once
     assert(num_restarts > 0);           // Ensure the param is valid
 
@@ -236,6 +286,15 @@ class BlockIter : public InternalIterator {
     global_seqno_ = global_seqno;
     read_amp_bitmap_ = read_amp_bitmap;
     last_bitmap_offset_ = current_ + 1;
+    key_includes_seq_ = key_includes_seq;
+    value_delta_encoded_ = value_delta_encoded;
+    learned_index_ = learned_index;
+    fixed_key_size_ = fixed_key_size;
+    fixed_entry_size_ =
+        fixed_key_size == 0 ||
+                fixed_value_size == BlockBuilder::kVariableValueSize
+            ? 0
+            : fixed_key_size + fixed_value_size;
   }
 
   void SetStatus(Status s) {
@@ -246,10 +305,22 @@ class BlockIter : public InternalIterator {
   virtual Status status() const override { return status_; }
   virtual Slice key() const override {
     assert(Valid());
+    if (!key_includes_seq_) {
+      // A user key separates blocks as the largest internal key with that
+      // user key would.
+      internal_key_.SetInternalKey(key_.GetUserKey(), 0 /* seqno */,
+                                   kValueTypeForSeekForPrev);
+      return internal_key_.GetInternalKey();
+    }
     return key_.GetInternalKey();
   }
   virtual Slice value() const override {
     assert(Valid());
+    if (value_delta_encoded_) {
+      char* end = EncodeVarint64(value_buf_, decoded_value_.offset());
+      end = EncodeVarint64(end, decoded_value_.size());
+      return Slice(value_buf_, static_cast<size_t>(end - value_buf_));
+    }
     if (read_amp_bitmap_ && current_ < restarts_ &&
         current_ != last_bitmap_offset_) {
       read_amp_bitmap_->Mark(current_ /* current entry offset */,
@@ -284,9 +355,11 @@ class BlockIter : public InternalIterator {
   PinnedIteratorsManager* pinned_iters_mgr_ = nullptr;
 #endif
 
-  virtual bool IsKeyPinned() const override { return key_pinned_; }
+  virtual bool IsKeyPinned() const override {
+    return key_includes_seq_ && key_pinned_;
+  }
 
-  virtual bool IsValuePinned() const override { return true; }
+  virtual bool IsValuePinned() const override { return !value_delta_encoded_; }
 
   size_t TEST_CurrentEntrySize() { return NextEntryOffset() - current_; }
 
@@ -315,6 +388,22 @@ class BlockIter : public InternalIterator {
   // last `current_` value we report to read-amp bitmp
   mutable uint32_t last_bitmap_offset_;
 
+  // Index blocks of format_version 3 may store user keys only, and block
+  // handles relative to the previous entry.
+  bool key_includes_seq_;
+  bool value_delta_encoded_;
+  // key() of a block of user keys
+  mutable IterKey internal_key_;
+  // The block handle of the current entry if value_delta_encoded_
+  BlockHandle decoded_value_;
+  mutable char value_buf_[BlockHandle::kMaxEncodedLength];
+  // Narrows down the binary search over restart points, if not nullptr
+  const BlockLearnedIndex* learned_index_;
+  // Size of every key of a block with the fixed-size layout, or 0
+  uint32_t fixed_key_size_;
+  // Size of every entry if the values have a fixed size as well, or 0
+  uint32_t fixed_entry_size_;
+
   struct CachedPrevEntry {
     explicit CachedPrevEntry(uint32_t _offset, const char* _key_ptr,
                              size_t _key_offset, size_t _key_size, Slice _value)
@@ -339,8 +428,24 @@ class BlockIter : public InternalIterator {
   std::vector<CachedPrevEntry> prev_entries_;
   int32_t prev_entries_idx_ = -1;
 
+  // Compares key `a` of this block with the internal key `b`.
   inline int Compare(const Slice& a, const Slice& b) const {
-    return comparator_->Compare(a, b);
+    if (key_includes_seq_) {
+      return comparator_->Compare(a, b);
+    }
+    // `a` stands for the largest internal key with user key `a`, which is
+    // larger than any other internal key with the same user key.
+    assert(b.size() >= 8);
+    int r = comparator_->Compare(a, ExtractUserKey(b));
+    if (r == 0 && DecodeFixed64(b.data() + b.size() - 8) != 0) {
+      r = 1;
+    }
+    return r;
+  }
+
+  // The current key as stored in the block
+  inline Slice RawKey() const {
+    return key_includes_seq_ ? key_.GetInternalKey() : key_.GetUserKey();
   }
 
   // Return the offset in data_ just past the end of the current entry.
@@ -351,6 +456,9 @@ class BlockIter : public InternalIterator {
 
   uint32_t GetRestartPoint(uint32_t index) {
     assert(index < num_restarts_);
+    if (fixed_entry_size_ != 0) {
+      return index * fixed_entry_size_;
+    }
     return DecodeFixed32(data_ + restarts_ + index * sizeof(uint32_t));
   }
 
@@ -366,11 +474,36 @@ class BlockIter : public InternalIterator {
 
   void CorruptionError();
 
+  // Decodes the header of the entry at p. value_length is not set for
+  // blocks with delta-encoded values.
+  const char* DecodeEntryHeader(const char* p, const char* limit,
+                                uint32_t* shared, uint32_t* non_shared,
+                                uint32_t* value_length) const;
+
+  // Decodes the block handle starting at p into decoded_value_ and points
+  // value_ at its encoding. Returns false on corruption.
+  bool DecodeDeltaEncodedValue(const char* p, const char* limit,
+                               bool is_full_handle);
+
+  // Decodes the key of restart point `index`, which is stored in full.
+  // Returns false on corruption.
+  bool DecodeRestartKey(uint32_t index, Slice* key);
+
+  // Points key_ and value_ at the entry at current_ of a block with the
+  // fixed-size layout. Returns false on corruption.
+  bool DecodeFixedSizeEntry();
+
+  // Replaces the sequence number of the current key with global_seqno_,
+  // if the block has one.
+  void UpdateGlobalSeqno();
+
   bool ParseNextKey();
 
   bool BinarySeek(const Slice& target, uint32_t left, uint32_t right,
                   uint32_t* index);
 
+  bool LearnedSeek(const Slice& target, uint32_t* index);
+
   int CompareBlockKey(uint32_t block_index, const Slice& target);
 
   bool BinaryBlockIndexSeek(const Slice& target, uint32_t* block_ids,
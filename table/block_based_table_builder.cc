@@ -12,6 +12,7 @@
 #include <assert.h>
 #include <inttypes.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <list>
 #include <map>
@@ -35,10 +36,13 @@
 #include "table/block_based_table_factory.h"
 #include "table/block_based_table_reader.h"
 #include "table/block_builder.h"
+#include "table/block_learned_index.h"
+#include "table/column_aware_block.h"
 #include "table/filter_block.h"
 #include "table/format.h"
 #include "table/full_filter_block.h"
 #include "table/meta_blocks.h"
+#include "table/range_filter_block.h"
 #include "table/table_builder.h"
 
 #include "util/string_util.h"
@@ -64,11 +68,11 @@ namespace {
 // Create a filter block builder based on its type.
 FilterBlockBuilder* CreateFilterBlockBuilder(
     const ImmutableCFOptions& opt, const BlockBasedTableOptions& table_opt,
-    PartitionedIndexBuilder* const p_index_builder) {
+    PartitionedIndexBuilder* const p_index_builder, int level) {
   if (table_opt.filter_policy == nullptr) return nullptr;
 
   FilterBitsBuilder* filter_bits_builder =
-      table_opt.filter_policy->GetFilterBitsBuilder();
+      table_opt.filter_policy->GetFilterBitsBuilderForLevel(level);
   if (filter_bits_builder == nullptr) {
     return new BlockBasedFilterBlockBuilder(opt.prefix_extractor, table_opt);
   } else {
@@ -251,6 +255,9 @@ struct BlockBasedTableBuilder::Rep {
   uint64_t offset = 0;
   Status status;
   BlockBuilder data_block;
+  // Set if the data blocks are column-aware, instead of data_block. Blocks
+  // are then cut by the size of their rows, see ColumnBlockFull().
+  std::unique_ptr<ColumnAwareBlockBuilder> column_block;
   BlockBuilder range_del_block;
 
   InternalKeySliceTransform internal_prefix_transform;
@@ -266,6 +273,7 @@ struct BlockBasedTableBuilder::Rep {
 
   bool closed = false;  // Either Finish() or Abandon() has been called.
   std::unique_ptr<FilterBlockBuilder> filter_builder;
+  std::unique_ptr<RangeFilterBlockBuilder> range_filter_builder;
   char compressed_cache_key_prefix[BlockBasedTable::kMaxCacheKeyPrefixSize];
   size_t compressed_cache_key_prefix_size;
 
@@ -288,13 +296,22 @@ struct BlockBasedTableBuilder::Rep {
       const CompressionType _compression_type,
       const CompressionOptions& _compression_opts,
       const std::string* _compression_dict, const bool skip_filters,
-      const std::string& _column_family_name, const uint64_t _creation_time)
+      const std::string& _column_family_name, const uint64_t _creation_time,
+      const int level)
       : ioptions(_ioptions),
         table_options(table_opt),
         internal_comparator(icomparator),
         file(f),
         data_block(table_options.block_restart_interval,
-                   table_options.use_delta_encoding),
+                   table_options.use_delta_encoding,
+                   false /* use_value_delta_encoding */,
+                   table_options.use_learned_index &&
+                       BlockLearnedIndex::Supports(
+                           icomparator.user_comparator()),
+                   true /* keys_include_seq */,
+                   table_options.fixed_key_size == 0
+                       ? 0
+                       : table_options.fixed_key_size + 8),
         range_del_block(1),  // TODO(andrewkr): restart_interval unnecessary
         internal_prefix_transform(_ioptions.prefix_extractor),
         compression_type(_compression_type),
@@ -306,6 +323,16 @@ struct BlockBasedTableBuilder::Rep {
         column_family_id(_column_family_id),
         column_family_name(_column_family_name),
         creation_time(_creation_time) {
+    if (!table_options.value_columns.empty()) {
+      column_block.reset(new ColumnAwareBlockBuilder(
+          table_options.value_columns, table_options.block_restart_interval,
+          table_options.use_delta_encoding,
+          table_options.use_learned_index &&
+              BlockLearnedIndex::Supports(icomparator.user_comparator()),
+          table_options.fixed_key_size == 0
+              ? 0
+              : table_options.fixed_key_size + 8));
+    }
     if (table_options.index_type ==
         BlockBasedTableOptions::kTwoLevelIndexSearch) {
       p_index_builder_ = PartitionedIndexBuilder::CreateIndexBuilder(
@@ -320,7 +347,15 @@ struct BlockBasedTableBuilder::Rep {
       filter_builder = nullptr;
     } else {
       filter_builder.reset(
-          CreateFilterBlockBuilder(_ioptions, table_options, p_index_builder_));
+          CreateFilterBlockBuilder(_ioptions, table_options, p_index_builder_,
+                                   level));
+    }
+    // Range filter truncation relies on bytewise key order.
+    if (table_options.range_filter &&
+        strcmp(icomparator.user_comparator()->Name(),
+               BytewiseComparator()->Name()) == 0) {
+      range_filter_builder.reset(
+          new RangeFilterBlockBuilder(table_options.range_filter_suffix_bytes));
     }
 
     for (auto& collector_factories : *int_tbl_prop_collector_factories) {
@@ -332,6 +367,30 @@ struct BlockBasedTableBuilder::Rep {
             table_options.index_type, table_options.whole_key_filtering,
             _ioptions.prefix_extractor != nullptr));
   }
+
+  bool DataBlockEmpty() const {
+    return column_block != nullptr ? column_block->empty()
+                                   : data_block.empty();
+  }
+
+  // As FlushBlockBySizePolicy on the rows of the column-aware block. Flush
+  // policies take a BlockBuilder, which would encode every row a second time.
+  bool ColumnBlockFull(const Slice& key, const Slice& value) const {
+    if (column_block->empty()) {
+      return false;
+    }
+    const uint64_t block_size = table_options.block_size;
+    const uint64_t deviation_limit =
+        ((block_size * (100 - table_options.block_size_deviation)) + 99) /
+        100;
+    const size_t curr_size = column_block->RowSizeEstimate();
+    if (curr_size >= block_size) {
+      return true;
+    }
+    return deviation_limit != 0 &&
+           column_block->EstimateRowSizeAfterKV(key, value) > block_size &&
+           curr_size > deviation_limit;
+  }
 };
 
 BlockBasedTableBuilder::BlockBasedTableBuilder(
@@ -344,7 +403,8 @@ BlockBasedTableBuilder::BlockBasedTableBuilder(
     const CompressionType compression_type,
     const CompressionOptions& compression_opts,
     const std::string* compression_dict, const bool skip_filters,
-    const std::string& column_family_name, const uint64_t creation_time) {
+    const std::string& column_family_name, const uint64_t creation_time,
+    const int level) {
   BlockBasedTableOptions sanitized_table_options(table_options);
   if (sanitized_table_options.format_version == 0 &&
       sanitized_table_options.checksum != kCRC32c) {
@@ -360,7 +420,7 @@ BlockBasedTableBuilder::BlockBasedTableBuilder(
   rep_ = new Rep(ioptions, sanitized_table_options, internal_comparator,
                  int_tbl_prop_collector_factories, column_family_id, file,
                  compression_type, compression_opts, compression_dict,
-                 skip_filters, column_family_name, creation_time);
+                 skip_filters, column_family_name, creation_time, level);
 
   if (rep_->filter_builder != nullptr) {
     rep_->filter_builder->StartBlock(0);
@@ -388,9 +448,11 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
       assert(r->internal_comparator.Compare(key, Slice(r->last_key)) > 0);
     }
 
-    auto should_flush = r->flush_block_policy->Update(key, value);
+    auto should_flush = r->column_block != nullptr
+                            ? r->ColumnBlockFull(key, value)
+                            : r->flush_block_policy->Update(key, value);
     if (should_flush) {
-      assert(!r->data_block.empty());
+      assert(!r->DataBlockEmpty());
       Flush();
 
       // Add item to index block.
@@ -411,9 +473,16 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
     if (r->filter_builder != nullptr) {
       r->filter_builder->Add(ExtractUserKey(key));
     }
+    if (r->range_filter_builder != nullptr) {
+      r->range_filter_builder->Add(ExtractUserKey(key));
+    }
 
     r->last_key.assign(key.data(), key.size());
-    r->data_block.Add(key, value);
+    if (r->column_block != nullptr) {
+      r->column_block->Add(key, value);
+    } else {
+      r->data_block.Add(key, value);
+    }
     r->props.num_entries++;
     r->props.raw_key_size += key.size();
     r->props.raw_value_size += value.size();
@@ -424,9 +493,19 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
                                       r->ioptions.info_log);
 
   } else if (value_type == kTypeRangeDeletion) {
-    // TODO(wanning&andrewkr) add num_tomestone to table properties
     r->range_del_block.Add(key, value);
+    const Comparator* ucmp = r->internal_comparator.user_comparator();
+    Slice begin_key = ExtractUserKey(key);
+    if (r->props.num_range_deletions == 0 ||
+        ucmp->Compare(begin_key, r->props.range_del_smallest_key) < 0) {
+      r->props.range_del_smallest_key = begin_key.ToString();
+    }
+    if (r->props.num_range_deletions == 0 ||
+        ucmp->Compare(value, r->props.range_del_largest_key) > 0) {
+      r->props.range_del_largest_key = value.ToString();
+    }
     ++r->props.num_entries;
+    ++r->props.num_range_deletions;
     r->props.raw_key_size += key.size();
     r->props.raw_value_size += value.size();
     NotifyCollectTableCollectorsOnAdd(key, value, r->offset,
@@ -441,8 +520,14 @@ void BlockBasedTableBuilder::Flush() {
   Rep* r = rep_;
   assert(!r->closed);
   if (!ok()) return;
-  if (r->data_block.empty()) return;
-  WriteBlock(&r->data_block, &r->pending_handle, true /* is_data_block */);
+  if (r->DataBlockEmpty()) return;
+  if (r->column_block != nullptr) {
+    WriteBlock(r->column_block->Finish(), &r->pending_handle,
+               true /* is_data_block */);
+    r->column_block->Reset();
+  } else {
+    WriteBlock(&r->data_block, &r->pending_handle, true /* is_data_block */);
+  }
   if (r->filter_builder != nullptr) {
     r->filter_builder->StartBlock(r->offset);
   }
@@ -630,7 +715,7 @@ Status BlockBasedTableBuilder::InsertBlockInCache(const Slice& block_contents,
 
 Status BlockBasedTableBuilder::Finish() {
   Rep* r = rep_;
-  bool empty_data_block = r->data_block.empty();
+  bool empty_data_block = r->DataBlockEmpty();
   Flush();
   assert(!r->closed);
   r->closed = true;
@@ -669,10 +754,11 @@ Status BlockBasedTableBuilder::Finish() {
 
   // Write meta blocks and metaindex block with the following order.
   //    1. [meta block: filter]
-  //    2. [meta block: properties]
-  //    3. [meta block: compression dictionary]
-  //    4. [meta block: range deletion tombstone]
-  //    5. [metaindex block]
+  //    2. [meta block: range filter]
+  //    3. [meta block: properties]
+  //    4. [meta block: compression dictionary]
+  //    5. [meta block: range deletion tombstone]
+  //    6. [metaindex block]
   // write meta blocks
   MetaIndexBuilder meta_index_builder;
   for (const auto& item : index_blocks.meta_blocks) {
@@ -697,6 +783,15 @@ Status BlockBasedTableBuilder::Finish() {
       meta_index_builder.Add(key, filter_block_handle);
     }
 
+    if (r->range_filter_builder != nullptr &&
+        !r->range_filter_builder->empty()) {
+      BlockHandle range_filter_block_handle;
+      WriteRawBlock(r->range_filter_builder->Finish(), kNoCompression,
+                    &range_filter_block_handle);
+      meta_index_builder.Add(BlockBasedTable::kRangeFilterBlock,
+                             range_filter_block_handle);
+    }
+
     // Write properties and compression dictionary blocks.
     {
       PropertyBlockBuilder property_block_builder;
@@ -706,6 +801,10 @@ Status BlockBasedTableBuilder::Finish() {
           r->table_options.filter_policy->Name() : "";
       r->props.index_size =
           r->index_builder->EstimatedSize() + kBlockTrailerSize;
+      r->props.index_key_is_user_key =
+          !r->index_builder->seperator_is_key_plus_seq();
+      r->props.index_value_is_delta_encoded =
+          r->table_options.format_version >= 3;
       r->props.comparator_name = r->ioptions.user_comparator != nullptr
                                      ? r->ioptions.user_comparator->Name()
                                      : "nullptr";
@@ -860,6 +959,7 @@ TableProperties BlockBasedTableBuilder::GetTableProperties() const {
 
 const std::string BlockBasedTable::kFilterBlockPrefix = "filter.";
 const std::string BlockBasedTable::kFullFilterBlockPrefix = "fullfilter.";
+const std::string BlockBasedTable::kRangeFilterBlock = "rocksdb.range_filter";
 const std::string BlockBasedTable::kPartitionedFilterBlockPrefix =
     "partitionedfilter.";
 }  // namespace rocksdb
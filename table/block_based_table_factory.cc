@@ -12,14 +12,17 @@
 #include <memory>
 #include <string>
 #include <stdint.h>
+#include <string.h>
 
 #include "options/options_helper.h"
 #include "port/port.h"
 #include "rocksdb/cache.h"
 #include "rocksdb/convenience.h"
 #include "rocksdb/flush_block_policy.h"
+#include "table/adaptive_table_factory.h"
 #include "table/block_based_table_builder.h"
 #include "table/block_based_table_reader.h"
+#include "table/column_aware_block.h"
 #include "table/format.h"
 #include "util/string_util.h"
 
@@ -64,7 +67,8 @@ Status BlockBasedTableFactory::NewTableReader(
       table_reader_options.ioptions, table_reader_options.env_options,
       table_options_, table_reader_options.internal_comparator, std::move(file),
       file_size, table_reader, prefetch_index_and_filter_in_cache,
-      table_reader_options.skip_filters, table_reader_options.level);
+      table_reader_options.skip_filters, table_reader_options.level,
+      table_reader_options.block_cache_tracer);
 }
 
 TableBuilder* BlockBasedTableFactory::NewTableBuilder(
@@ -79,7 +83,7 @@ TableBuilder* BlockBasedTableFactory::NewTableBuilder(
       table_builder_options.compression_dict,
       table_builder_options.skip_filters,
       table_builder_options.column_family_name,
-      table_builder_options.creation_time);
+      table_builder_options.creation_time, table_builder_options.level);
 
   return table_builder;
 }
@@ -108,6 +112,10 @@ Status BlockBasedTableFactory::SanitizeOptions(
         "Unsupported BlockBasedTable format_version. Please check "
         "include/rocksdb/table.h for more info");
   }
+  Status s = ValidateValueColumns(table_options_.value_columns);
+  if (!s.ok()) {
+    return s;
+  }
   return Status::OK();
 }
 
@@ -198,6 +206,21 @@ std::string BlockBasedTableFactory::GetPrintableTableOptions() const {
   snprintf(buffer, kBufferSize, "  whole_key_filtering: %d\n",
            table_options_.whole_key_filtering);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  use_learned_index: %d\n",
+           table_options_.use_learned_index);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  fixed_key_size: %u\n",
+           table_options_.fixed_key_size);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  value_columns: %" ROCKSDB_PRIszt "\n",
+           table_options_.value_columns.size());
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  range_filter: %d\n",
+           table_options_.range_filter);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  range_filter_suffix_bytes: %u\n",
+           table_options_.range_filter_suffix_bytes);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  format_version: %d\n",
            table_options_.format_version);
   ret.append(buffer);
@@ -400,6 +423,22 @@ TableFactory* NewBlockBasedTableFactory(
   return new BlockBasedTableFactory(_table_options);
 }
 
+bool TableFactoryUsesRangeFilter(TableFactory* factory) {
+#ifndef ROCKSDB_LITE
+  if (strcmp(factory->Name(), "AdaptiveTableFactory") == 0) {
+    // It reads block-based tables with this one
+    factory = static_cast<AdaptiveTableFactory*>(factory)
+                  ->block_based_table_factory();
+  }
+#endif  // ROCKSDB_LITE
+  if (factory == nullptr || factory->Name() != BlockBasedTableFactory::kName) {
+    return false;
+  }
+  return static_cast<BlockBasedTableFactory*>(factory)
+      ->table_options()
+      .range_filter;
+}
+
 const std::string BlockBasedTableFactory::kName = "BlockBasedTable";
 const std::string BlockBasedTablePropertyNames::kIndexType =
     "rocksdb.block.based.table.index.type";
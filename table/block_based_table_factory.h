@@ -66,6 +66,10 @@ class BlockBasedTableFactory : public TableFactory {
   BlockBasedTableOptions table_options_;
 };
 
+// Whether the tables read by factory may skip Seek()s under an upper bound
+// with BlockBasedTableOptions::range_filter
+extern bool TableFactoryUsesRangeFilter(TableFactory* factory);
+
 extern const std::string kHashIndexPrefixesBlock;
 extern const std::string kHashIndexPrefixesMetadataBlock;
 extern const std::string kPropTrue;
@@ -141,6 +145,18 @@ static std::unordered_map<std::string, OptionTypeInfo>
         {"whole_key_filtering",
          {offsetof(struct BlockBasedTableOptions, whole_key_filtering),
           OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+        {"use_learned_index",
+         {offsetof(struct BlockBasedTableOptions, use_learned_index),
+          OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+        {"fixed_key_size",
+         {offsetof(struct BlockBasedTableOptions, fixed_key_size),
+          OptionType::kUInt32T, OptionVerificationType::kNormal, false, 0}},
+        {"range_filter",
+         {offsetof(struct BlockBasedTableOptions, range_filter),
+          OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+        {"range_filter_suffix_bytes",
+         {offsetof(struct BlockBasedTableOptions, range_filter_suffix_bytes),
+          OptionType::kUInt32T, OptionVerificationType::kNormal, false, 0}},
         {"skip_table_builder_flush",
          {0, OptionType::kBoolean, OptionVerificationType::kDeprecated, false,
           0}},
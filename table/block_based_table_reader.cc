@@ -8,7 +8,9 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #include "table/block_based_table_reader.h"
 
+#include <string.h>
 #include <algorithm>
+#include <deque>
 #include <limits>
 #include <string>
 #include <utility>
@@ -26,6 +28,7 @@
 #include "rocksdb/statistics.h"
 #include "rocksdb/table.h"
 #include "rocksdb/table_properties.h"
+#include "rocksdb/threadpool.h"
 
 #include "table/block.h"
 #include "table/block_based_filter_block.h"
@@ -43,8 +46,10 @@
 #include "table/two_level_iterator.h"
 
 #include "monitoring/perf_context_imp.h"
+#include "util/block_cache_tracer.h"
 #include "util/coding.h"
 #include "util/file_reader_writer.h"
+#include "util/mutexlock.h"
 #include "util/stop_watch.h"
 #include "util/string_util.h"
 #include "util/sync_point.h"
@@ -70,25 +75,40 @@ namespace {
 // On success fill *result and return OK - caller owns *result
 // @param compression_dict Data for presetting the compression library's
 //    dictionary.
+// @param memory_allocator Allocator of the memory of the block, or nullptr.
+// @param column_projection Value columns to decode from a column-aware data
+//    block; the block must not be shared with other readers then.
 Status ReadBlockFromFile(
     RandomAccessFileReader* file, FilePrefetchBuffer* prefetch_buffer,
     const Footer& footer, const ReadOptions& options, const BlockHandle& handle,
     std::unique_ptr<Block>* result, const ImmutableCFOptions& ioptions,
     bool do_uncompress, const Slice& compression_dict,
     const PersistentCacheOptions& cache_options, SequenceNumber global_seqno,
-    size_t read_amp_bytes_per_bit) {
+    size_t read_amp_bytes_per_bit, MemoryAllocator* memory_allocator = nullptr,
+    const std::vector<uint32_t>* column_projection = nullptr) {
   BlockContents contents;
   Status s = ReadBlockContents(file, prefetch_buffer, footer, options, handle,
                                &contents, ioptions, do_uncompress,
-                               compression_dict, cache_options);
+                               compression_dict, cache_options,
+                               memory_allocator);
   if (s.ok()) {
     result->reset(new Block(std::move(contents), global_seqno,
-                            read_amp_bytes_per_bit, ioptions.statistics));
+                            read_amp_bytes_per_bit, ioptions.statistics,
+                            column_projection));
   }
 
   return s;
 }
 
+// Blocks that tables read come from the allocator of their block cache, so
+// that the allocator outlives the blocks the cache holds.
+MemoryAllocator* GetMemoryAllocator(
+    const BlockBasedTableOptions& table_options) {
+  return table_options.block_cache != nullptr
+             ? table_options.block_cache->memory_allocator()
+             : nullptr;
+}
+
 // Delete the resource that is held by the iterator.
 template <class ResourceType>
 void DeleteHeldResource(void* arg, void* ignored) {
@@ -123,11 +143,61 @@ Slice GetCacheKeyFromOffset(const char* cache_key_prefix,
   return Slice(cache_key, static_cast<size_t>(end - cache_key));
 }
 
-Cache::Handle* GetEntryFromCache(Cache* block_cache, const Slice& key,
-                                 Tickers block_cache_miss_ticker,
-                                 Tickers block_cache_hit_ticker,
-                                 Statistics* statistics) {
-  auto cache_handle = block_cache->Lookup(key, statistics);
+// Data blocks are saved to the compressed tier of a block cache as their
+// contents followed by their global sequence number.
+size_t GetSavedBlockSize(void* value) {
+  const Block* block = reinterpret_cast<const Block*>(value);
+  return block->size() == 0 ? 0 : block->size() + sizeof(uint64_t);
+}
+
+void SaveBlockTo(void* value, char* out) {
+  const Block* block = reinterpret_cast<const Block*>(value);
+  memcpy(out, block->data(), block->size());
+  EncodeFixed64(out + block->size(), block->global_seqno());
+}
+
+// What a data block needs besides its saved form to be created again
+struct BlockCreateContext {
+  size_t read_amp_bytes_per_bit;
+  Statistics* statistics;
+};
+
+Status CreateSavedBlock(const Slice& data, void* create_context,
+                        MemoryAllocator* allocator, void** value,
+                        size_t* charge) {
+  if (data.size() < sizeof(uint64_t)) {
+    return Status::Corruption("Saved block too small");
+  }
+  const BlockCreateContext* context =
+      reinterpret_cast<const BlockCreateContext*>(create_context);
+  const size_t size = data.size() - sizeof(uint64_t);
+  CacheAllocationPtr buf = AllocateBlock(size, allocator);
+  memcpy(buf.get(), data.data(), size);
+  Block* block = new Block(
+      BlockContents(std::move(buf), size, true /* cachable */, kNoCompression),
+      DecodeFixed64(data.data() + size), context->read_amp_bytes_per_bit,
+      context->statistics);
+  *value = block;
+  *charge = block->usable_size();
+  return Status::OK();
+}
+
+const Cache::CacheItemHelper kDataBlockCacheHelper = {
+    &DeleteCachedEntry<Block>, &GetSavedBlockSize, &SaveBlockTo,
+    &CreateSavedBlock};
+
+// If helper is not nullptr, the entry is looked up with it (see
+// Cache::LookupWithHelper()).
+Cache::Handle* GetEntryFromCache(
+    Cache* block_cache, const Slice& key, Tickers block_cache_miss_ticker,
+    Tickers block_cache_hit_ticker, Statistics* statistics,
+    const Cache::CacheItemHelper* helper = nullptr,
+    void* create_context = nullptr) {
+  auto cache_handle =
+      helper != nullptr
+          ? block_cache->LookupWithHelper(key, helper, create_context,
+                                          statistics)
+          : block_cache->Lookup(key, statistics);
   if (cache_handle != nullptr) {
     PERF_COUNTER_ADD(block_cache_hit_count, 1);
     // overall cache hit
@@ -311,7 +381,9 @@ class BinarySearchIndexReader : public IndexReader {
                        const ImmutableCFOptions& ioptions,
                        const InternalKeyComparator* icomparator,
                        IndexReader** index_reader,
-                       const PersistentCacheOptions& cache_options) {
+                       const PersistentCacheOptions& cache_options,
+                       const bool index_key_includes_seq,
+                       const bool index_value_is_delta_encoded) {
     std::unique_ptr<Block> index_block;
     auto s = ReadBlockFromFile(
         file, prefetch_buffer, footer, ReadOptions(), index_handle,
@@ -321,7 +393,8 @@ class BinarySearchIndexReader : public IndexReader {
 
     if (s.ok()) {
       *index_reader = new BinarySearchIndexReader(
-          icomparator, std::move(index_block), ioptions.statistics);
+          icomparator, std::move(index_block), ioptions.statistics,
+          index_key_includes_seq, index_value_is_delta_encoded);
     }
 
     return s;
@@ -329,7 +402,9 @@ class BinarySearchIndexReader : public IndexReader {
 
   virtual InternalIterator* NewIterator(BlockIter* iter = nullptr,
                                         bool dont_care = true) override {
-    return index_block_->NewIterator(icomparator_, iter, true);
+    return index_block_->NewIndexIterator(icomparator_, iter, true,
+                                          index_key_includes_seq_,
+                                          index_value_is_delta_encoded_);
   }
 
   virtual size_t size() const override { return index_block_->size(); }
@@ -345,11 +420,17 @@ class BinarySearchIndexReader : public IndexReader {
  private:
   BinarySearchIndexReader(const InternalKeyComparator* icomparator,
                           std::unique_ptr<Block>&& index_block,
-                          Statistics* stats)
-      : IndexReader(icomparator, stats), index_block_(std::move(index_block)) {
+                          Statistics* stats, const bool index_key_includes_seq,
+                          const bool index_value_is_delta_encoded)
+      : IndexReader(icomparator, stats),
+        index_block_(std::move(index_block)),
+        index_key_includes_seq_(index_key_includes_seq),
+        index_value_is_delta_encoded_(index_value_is_delta_encoded) {
     assert(index_block_ != nullptr);
   }
   std::unique_ptr<Block> index_block_;
+  const bool index_key_includes_seq_;
+  const bool index_value_is_delta_encoded_;
 };
 
 // Index that leverages an internal hash table to quicken the lookup for a given
@@ -365,7 +446,9 @@ class HashIndexReader : public IndexReader {
                        InternalIterator* meta_index_iter,
                        IndexReader** index_reader,
                        bool hash_index_allow_collision,
-                       const PersistentCacheOptions& cache_options) {
+                       const PersistentCacheOptions& cache_options,
+                       const bool index_key_includes_seq,
+                       const bool index_value_is_delta_encoded) {
     std::unique_ptr<Block> index_block;
     auto s = ReadBlockFromFile(
         file, prefetch_buffer, footer, ReadOptions(), index_handle,
@@ -381,9 +464,9 @@ class HashIndexReader : public IndexReader {
     // hard error. We can still fall back to the original binary search index.
     // So, Create will succeed regardless, from this point on.
 
-    auto new_index_reader =
-        new HashIndexReader(icomparator, std::move(index_block),
-          ioptions.statistics);
+    auto new_index_reader = new HashIndexReader(
+        icomparator, std::move(index_block), ioptions.statistics,
+        index_key_includes_seq, index_value_is_delta_encoded);
     *index_reader = new_index_reader;
 
     // Get prefixes block
@@ -436,7 +519,9 @@ class HashIndexReader : public IndexReader {
 
   virtual InternalIterator* NewIterator(BlockIter* iter = nullptr,
                                         bool total_order_seek = true) override {
-    return index_block_->NewIterator(icomparator_, iter, total_order_seek);
+    return index_block_->NewIndexIterator(icomparator_, iter, total_order_seek,
+                                          index_key_includes_seq_,
+                                          index_value_is_delta_encoded_);
   }
 
   virtual size_t size() const override { return index_block_->size(); }
@@ -452,8 +537,13 @@ class HashIndexReader : public IndexReader {
 
  private:
   HashIndexReader(const InternalKeyComparator* icomparator,
-                  std::unique_ptr<Block>&& index_block, Statistics* stats)
-      : IndexReader(icomparator, stats), index_block_(std::move(index_block)) {
+                  std::unique_ptr<Block>&& index_block, Statistics* stats,
+                  const bool index_key_includes_seq,
+                  const bool index_value_is_delta_encoded)
+      : IndexReader(icomparator, stats),
+        index_block_(std::move(index_block)),
+        index_key_includes_seq_(index_key_includes_seq),
+        index_value_is_delta_encoded_(index_value_is_delta_encoded) {
     assert(index_block_ != nullptr);
   }
 
@@ -462,6 +552,8 @@ class HashIndexReader : public IndexReader {
 
   std::unique_ptr<Block> index_block_;
   BlockContents prefixes_contents_;
+  const bool index_key_includes_seq_;
+  const bool index_value_is_delta_encoded_;
 };
 
 // Helper function to setup the cache key's prefix for the Table.
@@ -603,8 +695,10 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
                              uint64_t file_size,
                              unique_ptr<TableReader>* table_reader,
                              const bool prefetch_index_and_filter_in_cache,
-                             const bool skip_filters, const int level) {
+                             const bool skip_filters, const int level,
+                             BlockCacheTracer* const block_cache_tracer) {
   table_reader->reset();
+  BlockCacheTraceCallerScope caller_scope(kPrefetch);
 
   Footer footer;
 
@@ -650,6 +744,8 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
   rep->footer = footer;
   rep->index_type = table_options.index_type;
   rep->hash_index_allow_collision = table_options.hash_index_allow_collision;
+  rep->level = level;
+  rep->block_cache_tracer = block_cache_tracer;
   // We need to wrap data with internal_prefix_transform to make sure it can
   // handle prefix correctly.
   rep->internal_prefix_transform.reset(
@@ -785,6 +881,30 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
     }
   }
 
+  // Read the range filter meta block. It is small and kept in memory for
+  // the lifetime of the reader, like the compression dictionary.
+  BlockHandle range_filter_handle;
+  if (table_options.range_filter &&
+      strcmp(internal_comparator.user_comparator()->Name(),
+             BytewiseComparator()->Name()) == 0 &&
+      FindMetaBlock(meta_iter.get(), kRangeFilterBlock, &range_filter_handle)
+          .ok()) {
+    BlockContents range_filter_contents;
+    s = ReadBlockContents(rep->file.get(), prefetch_buffer.get(), rep->footer,
+                          ReadOptions(), range_filter_handle,
+                          &range_filter_contents, rep->ioptions,
+                          false /* decompress */);
+    if (!s.ok()) {
+      ROCKS_LOG_WARN(
+          rep->ioptions.info_log,
+          "Encountered error while reading data from range filter block %s",
+          s.ToString().c_str());
+    } else {
+      rep->range_filter.reset(
+          new RangeFilterBlockReader(std::move(range_filter_contents)));
+    }
+  }
+
   // Determine whether whole key filtering is supported.
   if (rep->table_properties) {
     rep->whole_key_filtering &=
@@ -797,6 +917,10 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
 
     rep->global_seqno = GetGlobalSequenceNumber(*(rep->table_properties),
                                                 rep->ioptions.info_log);
+    rep->index_key_includes_seq =
+        rep->table_properties->index_key_is_user_key == 0;
+    rep->index_value_is_delta_encoded =
+        rep->table_properties->index_value_is_delta_encoded != 0;
   }
 
   const bool pin =
@@ -909,6 +1033,9 @@ size_t BlockBasedTable::ApproximateMemoryUsage() const {
   if (rep_->index_reader) {
     usage += rep_->index_reader->ApproximateMemoryUsage();
   }
+  if (rep_->range_filter) {
+    usage += rep_->range_filter->ApproximateMemoryUsage();
+  }
   return usage;
 }
 
@@ -956,10 +1083,12 @@ Status BlockBasedTable::GetDataBlockFromCache(
 
   // Lookup uncompressed cache first
   if (block_cache != nullptr) {
+    BlockCreateContext create_context = {read_amp_bytes_per_bit, statistics};
     block->cache_handle = GetEntryFromCache(
         block_cache, block_cache_key,
         is_index ? BLOCK_CACHE_INDEX_MISS : BLOCK_CACHE_DATA_MISS,
-        is_index ? BLOCK_CACHE_INDEX_HIT : BLOCK_CACHE_DATA_HIT, statistics);
+        is_index ? BLOCK_CACHE_INDEX_HIT : BLOCK_CACHE_DATA_HIT, statistics,
+        is_index ? nullptr : &kDataBlockCacheHelper, &create_context);
     if (block->cache_handle != nullptr) {
       block->value =
           reinterpret_cast<Block*>(block_cache->Value(block->cache_handle));
@@ -992,23 +1121,30 @@ Status BlockBasedTable::GetDataBlockFromCache(
 
   // Retrieve the uncompressed contents into a new buffer
   BlockContents contents;
-  s = UncompressBlockContents(compressed_block->data(),
-                              compressed_block->size(), &contents,
-                              format_version, compression_dict,
-                              ioptions);
+  s = UncompressBlockContents(
+      compressed_block->data(), compressed_block->size(), &contents,
+      format_version, compression_dict, ioptions,
+      block_cache != nullptr ? block_cache->memory_allocator() : nullptr);
 
   // Insert uncompressed block into block cache
   if (s.ok()) {
-    block->value =
-        new Block(std::move(contents), compressed_block->global_seqno(),
-                  read_amp_bytes_per_bit,
-                  statistics);  // uncompressed block
+    // A projected block is only fine if it does not go to the block cache
+    const bool project =
+        !is_index && (block_cache == nullptr || !read_options.fill_cache);
+    block->value = new Block(
+        std::move(contents), compressed_block->global_seqno(),
+        read_amp_bytes_per_bit, statistics,
+        project ? read_options.column_projection : nullptr);  // uncompressed
     assert(block->value->compression_type() == kNoCompression);
     if (block_cache != nullptr && block->value->cachable() &&
         read_options.fill_cache) {
-      s = block_cache->Insert(
-          block_cache_key, block->value, block->value->usable_size(),
-          &DeleteCachedEntry<Block>, &(block->cache_handle));
+      s = is_index ? block_cache->Insert(block_cache_key, block->value,
+                                         block->value->usable_size(),
+                                         &DeleteCachedEntry<Block>,
+                                         &(block->cache_handle))
+                   : block_cache->InsertWithHelper(
+                         block_cache_key, block->value, &kDataBlockCacheHelper,
+                         block->value->usable_size(), &(block->cache_handle));
       block_cache->TEST_mark_as_data_block(block_cache_key,
                                            block->value->usable_size());
       if (s.ok()) {
@@ -1052,8 +1188,10 @@ Status BlockBasedTable::PutDataBlockToCache(
   BlockContents contents;
   Statistics* statistics = ioptions.statistics;
   if (raw_block->compression_type() != kNoCompression) {
-    s = UncompressBlockContents(raw_block->data(), raw_block->size(), &contents,
-                                format_version, compression_dict, ioptions);
+    s = UncompressBlockContents(
+        raw_block->data(), raw_block->size(), &contents, format_version,
+        compression_dict, ioptions,
+        block_cache != nullptr ? block_cache->memory_allocator() : nullptr);
   }
   if (!s.ok()) {
     delete raw_block;
@@ -1089,9 +1227,14 @@ Status BlockBasedTable::PutDataBlockToCache(
   // insert into uncompressed block cache
   assert((block->value->compression_type() == kNoCompression));
   if (block_cache != nullptr && block->value->cachable()) {
-    s = block_cache->Insert(
-        block_cache_key, block->value, block->value->usable_size(),
-        &DeleteCachedEntry<Block>, &(block->cache_handle), priority);
+    s = is_index ? block_cache->Insert(block_cache_key, block->value,
+                                       block->value->usable_size(),
+                                       &DeleteCachedEntry<Block>,
+                                       &(block->cache_handle), priority)
+                 : block_cache->InsertWithHelper(
+                       block_cache_key, block->value, &kDataBlockCacheHelper,
+                       block->value->usable_size(), &(block->cache_handle),
+                       priority);
     block_cache->TEST_mark_as_data_block(block_cache_key,
                                          block->value->usable_size());
     if (s.ok()) {
@@ -1225,8 +1368,13 @@ BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
   if (cache_handle != nullptr) {
     filter = reinterpret_cast<FilterBlockReader*>(
         block_cache->Value(cache_handle));
+    TraceBlockCacheAccess(rep_, kBlockTraceFilterBlock, key, filter->size(),
+                          true /* is_cache_hit */, false /* no_insert */);
   } else if (no_io) {
     // Do not invoke any io.
+    TraceBlockCacheAccess(rep_, kBlockTraceFilterBlock, key,
+                          filter_blk_handle.size(), false /* is_cache_hit */,
+                          false /* no_insert */);
     return CachableEntry<FilterBlockReader>();
   } else {
     filter =
@@ -1246,9 +1394,16 @@ BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
       } else {
         RecordTick(statistics, BLOCK_CACHE_ADD_FAILURES);
         delete filter;
-        return CachableEntry<FilterBlockReader>();
+        filter = nullptr;
       }
     }
+    TraceBlockCacheAccess(
+        rep_, kBlockTraceFilterBlock, key,
+        filter != nullptr ? filter->size() : filter_blk_handle.size(),
+        false /* is_cache_hit */, false /* no_insert */);
+    if (filter == nullptr) {
+      return CachableEntry<FilterBlockReader>();
+    }
   }
 
   return { filter, cache_handle };
@@ -1282,6 +1437,9 @@ InternalIterator* BlockBasedTable::NewIndexIterator(
                         BLOCK_CACHE_INDEX_HIT, statistics);
 
   if (cache_handle == nullptr && no_io) {
+    TraceBlockCacheAccess(rep_, kBlockTraceIndexBlock, key,
+                          rep_->footer.index_handle().size(),
+                          false /* is_cache_hit */, false /* no_insert */);
     if (input_iter != nullptr) {
       input_iter->SetStatus(Status::Incomplete("no blocking io"));
       return input_iter;
@@ -1294,6 +1452,9 @@ InternalIterator* BlockBasedTable::NewIndexIterator(
   if (cache_handle != nullptr) {
     index_reader =
         reinterpret_cast<IndexReader*>(block_cache->Value(cache_handle));
+    TraceBlockCacheAccess(rep_, kBlockTraceIndexBlock, key,
+                          index_reader->usable_size(), true /* is_cache_hit */,
+                          false /* no_insert */);
   } else {
     // Create index reader and put it in the cache.
     Status s;
@@ -1312,6 +1473,11 @@ InternalIterator* BlockBasedTable::NewIndexIterator(
               : Cache::Priority::LOW);
     }
 
+    TraceBlockCacheAccess(
+        rep_, kBlockTraceIndexBlock, key,
+        index_reader != nullptr ? index_reader->usable_size()
+                                : rep_->footer.index_handle().size(),
+        false /* is_cache_hit */, false /* no_insert */);
     if (s.ok()) {
       size_t usable_size = index_reader->usable_size();
       RecordTick(statistics, BLOCK_CACHE_ADD);
@@ -1369,53 +1535,70 @@ InternalIterator* BlockBasedTable::NewDataBlockIterator(
     BlockIter* input_iter, bool is_index, Status s) {
   PERF_TIMER_GUARD(new_table_block_iter_nanos);
 
-  const bool no_io = (ro.read_tier == kBlockCacheTier);
-  Cache* block_cache = rep->table_options.block_cache.get();
   CachableEntry<Block> block;
-  Slice compression_dict;
   if (s.ok()) {
-    if (rep->compression_dict_block) {
-      compression_dict = rep->compression_dict_block->data;
-    }
-    s = MaybeLoadDataBlockToCache(nullptr /*prefetch_buffer*/, rep, ro, handle,
-                                  compression_dict, &block, is_index);
+    s = RetrieveBlock(rep, ro, handle, is_index, &block);
   }
+  return NewBlockEntryIterator(rep, &block, input_iter, is_index, s);
+}
+
+Status BlockBasedTable::RetrieveBlock(Rep* rep, const ReadOptions& ro,
+                                      const BlockHandle& handle, bool is_index,
+                                      CachableEntry<Block>* block) {
+  const bool no_io = (ro.read_tier == kBlockCacheTier);
+  Slice compression_dict;
+  if (rep->compression_dict_block) {
+    compression_dict = rep->compression_dict_block->data;
+  }
+  Status s = MaybeLoadDataBlockToCache(nullptr /*prefetch_buffer*/, rep, ro,
+                                       handle, compression_dict, block,
+                                       is_index);
 
   // Didn't get any data from block caches.
-  if (s.ok() && block.value == nullptr) {
+  if (s.ok() && block->value == nullptr) {
     if (no_io) {
       // Could not read from block_cache and can't do IO
-      if (input_iter != nullptr) {
-        input_iter->SetStatus(Status::Incomplete("no blocking io"));
-        return input_iter;
-      } else {
-        return NewErrorInternalIterator(Status::Incomplete("no blocking io"));
-      }
+      return Status::Incomplete("no blocking io");
     }
     std::unique_ptr<Block> block_value;
     s = ReadBlockFromFile(rep->file.get(), nullptr /* prefetch_buffer */,
                           rep->footer, ro, handle, &block_value, rep->ioptions,
                           true /* compress */, compression_dict,
                           rep->persistent_cache_options, rep->global_seqno,
-                          rep->table_options.read_amp_bytes_per_bit);
+                          rep->table_options.read_amp_bytes_per_bit,
+                          GetMemoryAllocator(rep->table_options),
+                          is_index ? nullptr : ro.column_projection);
     if (s.ok()) {
-      block.value = block_value.release();
+      block->value = block_value.release();
     }
   }
+  return s;
+}
 
+InternalIterator* BlockBasedTable::NewBlockEntryIterator(
+    Rep* rep, CachableEntry<Block>* block, BlockIter* input_iter,
+    bool is_index, const Status& s) {
   InternalIterator* iter;
   if (s.ok()) {
-    assert(block.value != nullptr);
-    iter = block.value->NewIterator(&rep->internal_comparator, input_iter, true,
-                                    rep->ioptions.statistics);
-    if (block.cache_handle != nullptr) {
-      iter->RegisterCleanup(&ReleaseCachedEntry, block_cache,
-                            block.cache_handle);
+    assert(block->value != nullptr);
+    if (is_index) {
+      // An index partition
+      iter = block->value->NewIndexIterator(
+          &rep->internal_comparator, input_iter, true,
+          rep->index_key_includes_seq, rep->index_value_is_delta_encoded);
+    } else {
+      iter = block->value->NewIterator(&rep->internal_comparator, input_iter,
+                                       true, rep->ioptions.statistics);
+    }
+    if (block->cache_handle != nullptr) {
+      iter->RegisterCleanup(&ReleaseCachedEntry,
+                            rep->table_options.block_cache.get(),
+                            block->cache_handle);
     } else {
-      iter->RegisterCleanup(&DeleteHeldResource<Block>, block.value, nullptr);
+      iter->RegisterCleanup(&DeleteHeldResource<Block>, block->value, nullptr);
     }
   } else {
-    assert(block.value == nullptr);
+    assert(block->value == nullptr);
     if (input_iter != nullptr) {
       input_iter->SetStatus(s);
       iter = input_iter;
@@ -1461,16 +1644,22 @@ Status BlockBasedTable::MaybeLoadDataBlockToCache(
         key, ckey, block_cache, block_cache_compressed, rep->ioptions, ro,
         block_entry, rep->table_options.format_version, compression_dict,
         rep->table_options.read_amp_bytes_per_bit, is_index);
+    const bool is_cache_hit = block_entry->value != nullptr;
 
     if (block_entry->value == nullptr && !no_io && ro.fill_cache) {
       std::unique_ptr<Block> raw_block;
       {
         StopWatch sw(rep->ioptions.env, statistics, READ_BLOCK_GET_MICROS);
+        // Raw blocks that go to the compressed block cache use the default
+        // allocator, which does not depend on the uncompressed block cache.
         s = ReadBlockFromFile(
             rep->file.get(), prefetch_buffer, rep->footer, ro, handle,
             &raw_block, rep->ioptions, block_cache_compressed == nullptr,
             compression_dict, rep->persistent_cache_options, rep->global_seqno,
-            rep->table_options.read_amp_bytes_per_bit);
+            rep->table_options.read_amp_bytes_per_bit,
+            block_cache_compressed == nullptr
+                ? GetMemoryAllocator(rep->table_options)
+                : nullptr);
       }
 
       if (s.ok()) {
@@ -1486,26 +1675,249 @@ Status BlockBasedTable::MaybeLoadDataBlockToCache(
                 : Cache::Priority::LOW);
       }
     }
+
+    if (block_cache != nullptr) {
+      TraceBlockCacheAccess(
+          rep, is_index ? kBlockTraceIndexBlock : kBlockTraceDataBlock, key,
+          block_entry->value != nullptr ? block_entry->value->usable_size()
+                                        : handle.size(),
+          is_cache_hit, !ro.fill_cache);
+    }
   }
   assert(s.ok() || block_entry->value == nullptr);
   return s;
 }
 
+void BlockBasedTable::TraceBlockCacheAccess(const Rep* rep,
+                                            TraceType block_type,
+                                            const Slice& block_key,
+                                            uint64_t block_size,
+                                            bool is_cache_hit,
+                                            bool no_insert) {
+  BlockCacheTracer* tracer = rep->block_cache_tracer;
+  if (tracer == nullptr || !tracer->is_tracing_enabled()) {
+    return;
+  }
+  BlockCacheTraceRecord record;
+  record.block_key = block_key.ToString();
+  record.block_type = block_type;
+  record.block_size = block_size;
+  record.cf_id = rep->table_properties != nullptr
+                     ? rep->table_properties->column_family_id
+                     : TablePropertiesCollectorFactory::Context::
+                           kUnknownColumnFamily;
+  record.level = rep->level;
+  record.is_cache_hit = is_cache_hit;
+  record.no_insert = no_insert;
+  tracer->WriteBlockAccess(&record);
+}
+
+// Reads and decompresses the data blocks that follow the current one of a
+// forward scan on ReadOptions::decompression_thread_pool, so that they are
+// ready by the time the scan reaches them.
+class BlockBasedTable::BlockEntryIteratorState::DataBlockReadahead {
+ public:
+  DataBlockReadahead(BlockBasedTable* table, const ReadOptions& read_options)
+      : table_(table),
+        read_options_(read_options),
+        shared_(std::make_shared<Shared>()),
+        next_offset_(0),
+        has_next_offset_(false) {
+    assert(read_options.decompression_readahead_blocks > 0);
+    assert(read_options.decompression_thread_pool != nullptr);
+    // The look-ahead index iterator steps through all the blocks
+    read_options_.total_order_seek = true;
+  }
+
+  ~DataBlockReadahead() { Reset(); }
+
+  // Returns an iterator over the data block at handle if it was read ahead,
+  // and nullptr if the caller has to read it. index_key is the key of its
+  // index entry.
+  InternalIterator* NewIterator(const Slice& index_key,
+                                const BlockHandle& handle) {
+    InternalIterator* iter = nullptr;
+    if (!slots_.empty() && slots_.front()->handle.offset() == handle.offset()) {
+      std::shared_ptr<Slot> slot = slots_.front();
+      slots_.pop_front();
+      bool read_ahead = true;
+      {
+        MutexLock l(&shared_->mu);
+        if (slot->state == kQueued) {
+          // Reading the block here is faster than waiting for the jobs
+          // queued before it
+          slot->state = kDropped;
+          read_ahead = false;
+        } else {
+          while (slot->state == kRunning) {
+            shared_->cv.Wait();
+          }
+        }
+      }
+      if (read_ahead) {
+        assert(slot->state == kDone);
+        iter = NewBlockEntryIterator(table_->rep_, &slot->block, nullptr,
+                                     false /* is_index */, slot->status);
+      }
+      Schedule();
+    } else {
+      // The iterator did not move to the next block: stop reading ahead
+      Reset();
+      if (has_next_offset_ && handle.offset() == next_offset_) {
+        if (index_iter_ == nullptr) {
+          index_iter_.reset(table_->NewIndexIterator(read_options_));
+        }
+        index_iter_->Seek(index_key);
+        if (index_iter_->Valid()) {
+          BlockHandle found;
+          Slice input = index_iter_->value();
+          if (found.DecodeFrom(&input).ok() &&
+              found.offset() == handle.offset()) {
+            Schedule();
+          }
+        }
+      }
+    }
+    next_offset_ = handle.offset() + handle.size() + kBlockTrailerSize;
+    has_next_offset_ = true;
+    return iter;
+  }
+
+ private:
+  enum SlotState { kQueued, kRunning, kDone, kDropped };
+
+  // A block being read ahead
+  struct Slot {
+    BlockHandle handle;
+    // The fields below are guarded by Shared::mu
+    SlotState state = kQueued;
+    Status status;
+    CachableEntry<Block> block;
+  };
+
+  // Shared with the jobs, which may outlive this object
+  struct Shared {
+    Shared() : cv(&mu) {}
+    port::Mutex mu;
+    port::CondVar cv;
+  };
+
+  static void ReadBlock(Rep* rep, const ReadOptions& ro,
+                        const std::shared_ptr<Shared>& shared,
+                        const std::shared_ptr<Slot>& slot) {
+    {
+      MutexLock l(&shared->mu);
+      if (slot->state != kQueued) {
+        // Dropped, and rep may be gone
+        return;
+      }
+      slot->state = kRunning;
+    }
+    TEST_SYNC_POINT("BlockBasedTable::DataBlockReadahead::ReadBlock");
+    BlockCacheTraceCallerScope caller_scope(kUserIterator);
+    CachableEntry<Block> block;
+    Status s = RetrieveBlock(rep, ro, slot->handle, false /* is_index */,
+                             &block);
+    MutexLock l(&shared->mu);
+    slot->status = s;
+    slot->block = block;
+    slot->state = kDone;
+    shared->cv.SignalAll();
+  }
+
+  // Schedules the blocks after the one index_iter_ is at, until
+  // decompression_readahead_blocks are in flight.
+  void Schedule() {
+    const Comparator* ucmp = table_->rep_->internal_comparator.user_comparator();
+    const Slice* upper_bound = read_options_.iterate_upper_bound;
+    while (slots_.size() < read_options_.decompression_readahead_blocks &&
+           index_iter_->Valid()) {
+      // The index key bounds the keys of its block, so the blocks after it
+      // start past the upper bound once it reaches it
+      if (upper_bound != nullptr &&
+          ucmp->Compare(ExtractUserKey(index_iter_->key()), *upper_bound) >=
+              0) {
+        break;
+      }
+      index_iter_->Next();
+      if (!index_iter_->Valid()) {
+        break;
+      }
+      std::shared_ptr<Slot> slot = std::make_shared<Slot>();
+      Slice input = index_iter_->value();
+      if (!slot->handle.DecodeFrom(&input).ok()) {
+        break;
+      }
+      slots_.push_back(slot);
+      Rep* rep = table_->rep_;
+      ReadOptions ro = read_options_;
+      std::shared_ptr<Shared> shared = shared_;
+      read_options_.decompression_thread_pool->SubmitJob(
+          [rep, ro, shared, slot]() { ReadBlock(rep, ro, shared, slot); });
+    }
+  }
+
+  // Drops the blocks read ahead, waiting for the jobs that are reading them
+  void Reset() {
+    Cache* block_cache = table_->rep_->table_options.block_cache.get();
+    MutexLock l(&shared_->mu);
+    for (auto& slot : slots_) {
+      while (slot->state == kRunning) {
+        shared_->cv.Wait();
+      }
+      if (slot->state == kDone) {
+        if (slot->block.cache_handle != nullptr) {
+          slot->block.Release(block_cache);
+        } else {
+          delete slot->block.value;
+        }
+        slot->block.value = nullptr;
+      }
+      slot->state = kDropped;
+    }
+    slots_.clear();
+  }
+
+  BlockBasedTable* table_;
+  ReadOptions read_options_;
+  std::shared_ptr<Shared> shared_;
+  // The blocks being read ahead, in order
+  std::deque<std::shared_ptr<Slot>> slots_;
+  // At the index entry of the last block scheduled
+  std::unique_ptr<InternalIterator> index_iter_;
+  // The offset of the block after the one returned last
+  uint64_t next_offset_;
+  bool has_next_offset_;
+};
+
 BlockBasedTable::BlockEntryIteratorState::BlockEntryIteratorState(
     BlockBasedTable* table, const ReadOptions& read_options,
     const InternalKeyComparator* icomparator, bool skip_filters, bool is_index,
     std::unordered_map<uint64_t, CachableEntry<Block>>* block_map)
-    : TwoLevelIteratorState(table->rep_->ioptions.prefix_extractor != nullptr),
+    : TwoLevelIteratorState(
+          table->rep_->ioptions.prefix_extractor != nullptr,
+          !skip_filters && table->rep_->range_filter != nullptr &&
+              read_options.iterate_upper_bound != nullptr),
       table_(table),
       read_options_(read_options),
       icomparator_(icomparator),
       skip_filters_(skip_filters),
       is_index_(is_index),
-      block_map_(block_map) {}
+      block_map_(block_map) {
+  if (!is_index && block_map == nullptr &&
+      read_options.decompression_readahead_blocks > 0 &&
+      read_options.decompression_thread_pool != nullptr &&
+      read_options.read_tier != kBlockCacheTier) {
+    readahead_.reset(new DataBlockReadahead(table, read_options));
+  }
+}
+
+BlockBasedTable::BlockEntryIteratorState::~BlockEntryIteratorState() {}
 
 InternalIterator*
 BlockBasedTable::BlockEntryIteratorState::NewSecondaryIterator(
-    const Slice& index_value) {
+    const Slice& index_value, const Slice& index_key) {
+  BlockCacheTraceCallerScope caller_scope(kUserIterator);
   // Return a block iterator on the index partition
   BlockHandle handle;
   Slice input = index_value;
@@ -1523,8 +1935,15 @@ BlockBasedTable::BlockEntryIteratorState::NewSecondaryIterator(
       assert(block_cache);
       RecordTick(rep->ioptions.statistics, BLOCK_CACHE_BYTES_READ,
                  block_cache->GetUsage(block->second.cache_handle));
-      return block->second.value->NewIterator(
-          &rep->internal_comparator, nullptr, true, rep->ioptions.statistics);
+      return block->second.value->NewIndexIterator(
+          &rep->internal_comparator, nullptr, true,
+          rep->index_key_includes_seq, rep->index_value_is_delta_encoded);
+    }
+  }
+  if (readahead_ != nullptr && s.ok()) {
+    InternalIterator* iter = readahead_->NewIterator(index_key, handle);
+    if (iter != nullptr) {
+      return iter;
     }
   }
   return NewDataBlockIterator(rep, read_options_, handle, nullptr, is_index_,
@@ -1536,9 +1955,17 @@ bool BlockBasedTable::BlockEntryIteratorState::PrefixMayMatch(
   if (read_options_.total_order_seek || skip_filters_) {
     return true;
   }
+  BlockCacheTraceCallerScope caller_scope(kUserIterator);
   return table_->PrefixMayMatch(internal_key);
 }
 
+bool BlockBasedTable::BlockEntryIteratorState::RangeMayMatch(
+    const Slice& internal_key) {
+  assert(table_->rep_->range_filter != nullptr);
+  return table_->rep_->range_filter->RangeMayMatch(
+      ExtractUserKey(internal_key), read_options_.iterate_upper_bound);
+}
+
 bool BlockBasedTable::BlockEntryIteratorState::KeyReachedUpperBound(
     const Slice& internal_key) {
   bool reached_upper_bound = read_options_.iterate_upper_bound != nullptr &&
@@ -1656,6 +2083,7 @@ bool BlockBasedTable::PrefixMayMatch(const Slice& internal_key) {
 InternalIterator* BlockBasedTable::NewIterator(const ReadOptions& read_options,
                                                Arena* arena,
                                                bool skip_filters) {
+  BlockCacheTraceCallerScope caller_scope(kUserIterator);
   return NewTwoLevelIterator(
       new BlockEntryIteratorState(this, read_options,
                                   &rep_->internal_comparator, skip_filters),
@@ -1718,6 +2146,7 @@ bool BlockBasedTable::FullFilterKeyMayMatch(const ReadOptions& read_options,
 
 Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
                             GetContext* get_context, bool skip_filters) {
+  BlockCacheTraceCallerScope caller_scope(kUserGet);
   Status s;
   const bool no_io = read_options.read_tier == kBlockCacheTier;
   CachableEntry<FilterBlockReader> filter_entry;
@@ -1732,6 +2161,13 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
   if (!FullFilterKeyMayMatch(read_options, filter, key, no_io)) {
     RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_USEFUL);
   } else {
+    const bool full_filter_positive = filter != nullptr &&
+                                      !filter->IsBlockBased() &&
+                                      filter->whole_key_filtering();
+    bool matched = false;  // key is present in the file
+    if (full_filter_positive) {
+      RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_FULL_POSITIVE);
+    }
     BlockIter iiter_on_stack;
     auto iiter = NewIndexIterator(read_options, &iiter_on_stack);
     std::unique_ptr<InternalIterator> iiter_unique_ptr;
@@ -1778,6 +2214,10 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
           if (!ParseInternalKey(biter.key(), &parsed_key)) {
             s = Status::Corruption(Slice());
           }
+          if (full_filter_positive && !matched) {
+            matched = rep_->internal_comparator.user_comparator()->Equal(
+                parsed_key.user_key, ExtractUserKey(key));
+          }
 
           if (!get_context->SaveValue(parsed_key, biter.value(), &biter)) {
             done = true;
@@ -1791,6 +2231,9 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
         break;
       }
     }
+    if (matched) {
+      RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_FULL_TRUE_POSITIVE);
+    }
     if (s.ok()) {
       s = iiter->status();
     }
@@ -1987,7 +2430,8 @@ Status BlockBasedTable::CreateIndexReader(
     case BlockBasedTableOptions::kBinarySearch: {
       return BinarySearchIndexReader::Create(
           file, prefetch_buffer, footer, footer.index_handle(), rep_->ioptions,
-          icomparator, index_reader, rep_->persistent_cache_options);
+          icomparator, index_reader, rep_->persistent_cache_options,
+          rep_->index_key_includes_seq, rep_->index_value_is_delta_encoded);
     }
     case BlockBasedTableOptions::kHashSearch: {
       std::unique_ptr<Block> meta_guard;
@@ -2005,7 +2449,8 @@ Status BlockBasedTable::CreateIndexReader(
           return BinarySearchIndexReader::Create(
               file, prefetch_buffer, footer, footer.index_handle(),
               rep_->ioptions, icomparator, index_reader,
-              rep_->persistent_cache_options);
+              rep_->persistent_cache_options, rep_->index_key_includes_seq,
+              rep_->index_value_is_delta_encoded);
         }
         meta_index_iter = meta_iter_guard.get();
       }
@@ -2014,7 +2459,8 @@ Status BlockBasedTable::CreateIndexReader(
           rep_->internal_prefix_transform.get(), footer, file, prefetch_buffer,
           rep_->ioptions, icomparator, footer.index_handle(), meta_index_iter,
           index_reader, rep_->hash_index_allow_collision,
-          rep_->persistent_cache_options);
+          rep_->persistent_cache_options, rep_->index_key_includes_seq,
+          rep_->index_value_is_delta_encoded);
     }
     default: {
       std::string error_message =
@@ -25,9 +25,11 @@
 #include "table/filter_block.h"
 #include "table/format.h"
 #include "table/persistent_cache_helper.h"
+#include "table/range_filter_block.h"
 #include "table/table_properties_internal.h"
 #include "table/table_reader.h"
 #include "table/two_level_iterator.h"
+#include "util/block_cache_tracer.h"
 #include "util/coding.h"
 #include "util/file_reader_writer.h"
 
@@ -65,6 +67,7 @@ class BlockBasedTable : public TableReader {
   static const std::string kFilterBlockPrefix;
   static const std::string kFullFilterBlockPrefix;
   static const std::string kPartitionedFilterBlockPrefix;
+  static const std::string kRangeFilterBlock;
   // The longest prefix of the cache key used to identify blocks.
   // For Posix files the unique ID is three varints.
   static const size_t kMaxCacheKeyPrefixSize = kMaxVarint64Length * 3 + 1;
@@ -92,7 +95,8 @@ class BlockBasedTable : public TableReader {
                      unique_ptr<RandomAccessFileReader>&& file,
                      uint64_t file_size, unique_ptr<TableReader>* table_reader,
                      bool prefetch_index_and_filter_in_cache = true,
-                     bool skip_filters = false, int level = -1);
+                     bool skip_filters = false, int level = -1,
+                     BlockCacheTracer* const block_cache_tracer = nullptr);
 
   bool PrefixMayMatch(const Slice& internal_key);
 
@@ -219,11 +223,32 @@ class BlockBasedTable : public TableReader {
                                                 const Slice& index_value,
                                                 BlockIter* input_iter = nullptr,
                                                 bool is_index = false);
+
+  // Records a lookup of block_key in the block cache if a block cache trace
+  // is running
+  static void TraceBlockCacheAccess(const Rep* rep, TraceType block_type,
+                                    const Slice& block_key,
+                                    uint64_t block_size, bool is_cache_hit,
+                                    bool no_insert);
   static InternalIterator* NewDataBlockIterator(Rep* rep, const ReadOptions& ro,
                                                 const BlockHandle& block_hanlde,
                                                 BlockIter* input_iter = nullptr,
                                                 bool is_index = false,
                                                 Status s = Status());
+  // Reads the block identified by handle from the block caches, or from the
+  // file if they do not have it and ro allows I/O. Returns
+  // Status::Incomplete if it would need I/O that ro does not allow.
+  static Status RetrieveBlock(Rep* rep, const ReadOptions& ro,
+                              const BlockHandle& handle, bool is_index,
+                              CachableEntry<Block>* block);
+  // Returns an iterator over block, which then owns the block (or its cache
+  // handle), or over the error s if it is not ok.
+  // input_iter: if it is not null, update this one and return it as Iterator
+  static InternalIterator* NewBlockEntryIterator(Rep* rep,
+                                                 CachableEntry<Block>* block,
+                                                 BlockIter* input_iter,
+                                                 bool is_index,
+                                                 const Status& s);
   // If block cache enabled (compressed or uncompressed), looks for the block
   // identified by handle in (1) uncompressed cache, (2) compressed cache, and
   // then (3) file. If found, inserts into the cache(s) that were searched
@@ -358,8 +383,11 @@ class BlockBasedTable::BlockEntryIteratorState : public TwoLevelIteratorState {
       const InternalKeyComparator* icomparator, bool skip_filters,
       bool is_index = false,
       std::unordered_map<uint64_t, CachableEntry<Block>>* block_map = nullptr);
-  InternalIterator* NewSecondaryIterator(const Slice& index_value) override;
+  ~BlockEntryIteratorState();
+  InternalIterator* NewSecondaryIterator(const Slice& index_value,
+                                         const Slice& index_key) override;
   bool PrefixMayMatch(const Slice& internal_key) override;
+  bool RangeMayMatch(const Slice& internal_key) override;
   bool KeyReachedUpperBound(const Slice& internal_key) override;
 
  private:
@@ -372,6 +400,9 @@ class BlockBasedTable::BlockEntryIteratorState : public TwoLevelIteratorState {
   bool is_index_;
   std::unordered_map<uint64_t, CachableEntry<Block>>* block_map_;
   port::RWMutex cleaner_mu;
+  // Reads data blocks ahead, see ReadOptions::decompression_readahead_blocks
+  class DataBlockReadahead;
+  std::unique_ptr<DataBlockReadahead> readahead_;
 };
 
 // CachableEntry represents the entries that *may* be fetched from block cache.
@@ -452,6 +483,9 @@ struct BlockBasedTable::Rep {
   // is easier because the Slice member depends on the continued existence of
   // another member ("allocation").
   std::unique_ptr<const BlockContents> compression_dict_block;
+  // Only set if BlockBasedTableOptions::range_filter is true and the file
+  // has a range filter block.
+  std::unique_ptr<RangeFilterBlockReader> range_filter;
   BlockBasedTableOptions::IndexType index_type;
   bool hash_index_allow_collision;
   bool whole_key_filtering;
@@ -480,7 +514,16 @@ struct BlockBasedTable::Rep {
   // A value of kDisableGlobalSequenceNumber means that this feature is disabled
   // and every key have it's own seqno.
   SequenceNumber global_seqno;
+  // Index blocks of format_version 3 may store user keys and delta-encoded
+  // block handles, as recorded in the table properties. For partitioned
+  // indexes this applies to the partitions, not to the top-level index.
+  bool index_key_includes_seq = true;
+  bool index_value_is_delta_encoded = false;
   bool closed = false;
+  // The level of the table, -1 if unknown
+  int level = -1;
+  // Records the block cache accesses of the table, if not nullptr
+  BlockCacheTracer* block_cache_tracer = nullptr;
 };
 
 }  // namespace rocksdb
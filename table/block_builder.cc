@@ -26,10 +26,29 @@
 //     value: char[value_length]
 // shared_bytes == 0 for restart points.
 //
+// With use_value_delta_encoding (index blocks of format_version 3) the
+// value_length field is omitted because the values are self-delimiting
+// block handles, and an entry with shared_bytes != 0 stores a delta of its
+// block handle relative to the previous entry instead of the full handle.
+//
 // The trailer of the block has the form:
 //     restarts: uint32[num_restarts]
 //     num_restarts: uint32
 // restarts[i] contains the offset within the block of the ith restart point.
+// A block with a learned index stores it between the restart array and
+// num_restarts, and sets the top bit of num_restarts (see
+// table/block_learned_index.h).
+//
+// A block whose keys all have the same size (fixed_key_size) has the
+// fixed-size layout instead, where entries are stored back to back without
+// headers or prefix compression:
+//     entries: (key: char[key_size], value: char[value_size])[num_entries]
+//     offsets: uint32[num_entries]  (only if value_size == kVariableValueSize)
+//     key_size: uint32
+//     value_size: uint32
+//     num_entries | kFixedSizeFlag: uint32
+// Every entry is a restart point. If all values have the same size as well,
+// entry i starts at i * (key_size + value_size) and no offsets are stored.
 
 #include "table/block_builder.h"
 
@@ -37,19 +56,37 @@
 #include <assert.h>
 #include "rocksdb/comparator.h"
 #include "db/dbformat.h"
+#include "table/block_learned_index.h"
 #include "util/coding.h"
 
 namespace rocksdb {
 
-BlockBuilder::BlockBuilder(int block_restart_interval, bool use_delta_encoding)
+const uint32_t BlockBuilder::kFixedSizeFlag;
+const uint32_t BlockBuilder::kVariableValueSize;
+
+BlockBuilder::BlockBuilder(int block_restart_interval, bool use_delta_encoding,
+                           bool use_value_delta_encoding,
+                           bool use_learned_index, bool keys_include_seq,
+                           uint32_t fixed_key_size)
     : block_restart_interval_(block_restart_interval),
       use_delta_encoding_(use_delta_encoding),
+      use_value_delta_encoding_(use_value_delta_encoding),
+      use_learned_index_(use_learned_index),
+      keys_include_seq_(keys_include_seq),
+      fixed_key_size_(fixed_key_size),
       restarts_(),
       counter_(0),
-      finished_(false) {
+      finished_(false),
+      fixed_layout_(fixed_key_size != 0),
+      fixed_value_size_(kVariableValueSize) {
   assert(block_restart_interval_ >= 1);
+  // Delta-encoded values cannot be told apart without headers
+  assert(fixed_key_size_ == 0 || !use_value_delta_encoding_);
   restarts_.push_back(0);       // First restart point is at offset 0
   estimate_ = sizeof(uint32_t) + sizeof(uint32_t);
+  if (use_learned_index_) {
+    estimate_ += BlockLearnedIndex::kEncodedLength;
+  }
 }
 
 void BlockBuilder::Reset() {
@@ -57,15 +94,25 @@ void BlockBuilder::Reset() {
   restarts_.clear();
   restarts_.push_back(0);       // First restart point is at offset 0
   estimate_ = sizeof(uint32_t) + sizeof(uint32_t);
+  if (use_learned_index_) {
+    estimate_ += BlockLearnedIndex::kEncodedLength;
+  }
   counter_ = 0;
   finished_ = false;
   last_key_.clear();
+  fixed_layout_ = fixed_key_size_ != 0;
+  fixed_value_size_ = kVariableValueSize;
 }
 
 size_t BlockBuilder::EstimateSizeAfterKV(const Slice& key, const Slice& value)
   const {
   size_t estimate = CurrentSizeEstimate();
   estimate += key.size() + value.size();
+  if (fixed_layout_ && key.size() == fixed_key_size_) {
+    // An entry offset, or the key and value sizes for the first entry,
+    // whose offset is counted from the start
+    return estimate + (buffer_.empty() ? 2 : 1) * sizeof(uint32_t);
+  }
   if (counter_ >= block_restart_interval_) {
     estimate += sizeof(uint32_t); // a new restart entry.
   }
@@ -78,17 +125,110 @@ size_t BlockBuilder::EstimateSizeAfterKV(const Slice& key, const Slice& value)
 }
 
 Slice BlockBuilder::Finish() {
+  if (fixed_layout_ && !buffer_.empty()) {
+    if (fixed_value_size_ == kVariableValueSize) {
+      for (size_t i = 0; i < restarts_.size(); i++) {
+        PutFixed32(&buffer_, restarts_[i]);
+      }
+    }
+    PutFixed32(&buffer_, fixed_key_size_);
+    PutFixed32(&buffer_, fixed_value_size_);
+    assert(restarts_.size() < kFixedSizeFlag);
+    PutFixed32(&buffer_,
+               static_cast<uint32_t>(restarts_.size()) | kFixedSizeFlag);
+    finished_ = true;
+    return Slice(buffer_);
+  }
+
+  const size_t restarts_offset = buffer_.size();
   // Append restart array
   for (size_t i = 0; i < restarts_.size(); i++) {
     PutFixed32(&buffer_, restarts_[i]);
   }
-  PutFixed32(&buffer_, static_cast<uint32_t>(restarts_.size()));
+  uint32_t num_restarts = static_cast<uint32_t>(restarts_.size());
+  assert(num_restarts < kFixedSizeFlag);
+  if (use_learned_index_ && restarts_offset > 0 &&
+      AppendLearnedIndex(restarts_offset)) {
+    num_restarts |= BlockLearnedIndex::kLearnedIndexFlag;
+  }
+  PutFixed32(&buffer_, num_restarts);
   finished_ = true;
   return Slice(buffer_);
 }
 
-void BlockBuilder::Add(const Slice& key, const Slice& value) {
+bool BlockBuilder::AppendLearnedIndex(size_t restarts_offset) {
+  // Restart points store their keys in full
+  std::vector<Slice> restart_user_keys;
+  restart_user_keys.reserve(restarts_.size());
+  const char* limit = buffer_.data() + restarts_offset;
+  for (uint32_t restart : restarts_) {
+    uint32_t shared = 0;
+    uint32_t non_shared = 0;
+    uint32_t value_length = 0;
+    const char* p = GetVarint32Ptr(buffer_.data() + restart, limit, &shared);
+    p = GetVarint32Ptr(p, limit, &non_shared);
+    if (!use_value_delta_encoding_) {
+      p = GetVarint32Ptr(p, limit, &value_length);
+    }
+    assert(p != nullptr && shared == 0);
+    Slice key(p, non_shared);
+    restart_user_keys.push_back(keys_include_seq_ ? ExtractUserKey(key) : key);
+  }
+  std::string learned_index;
+  if (!BlockLearnedIndex::Build(restart_user_keys, &learned_index)) {
+    return false;
+  }
+  buffer_.append(learned_index);
+  return true;
+}
+
+void BlockBuilder::AddFixedSize(const Slice& key, const Slice& value) {
+  assert(key.size() == fixed_key_size_);
+  if (buffer_.empty()) {
+    fixed_value_size_ = static_cast<uint32_t>(value.size());
+    // The key and value sizes
+    estimate_ += 2 * sizeof(uint32_t);
+  } else {
+    restarts_.push_back(static_cast<uint32_t>(buffer_.size()));
+    estimate_ += sizeof(uint32_t);
+    if (value.size() != fixed_value_size_) {
+      fixed_value_size_ = kVariableValueSize;
+    }
+  }
+  buffer_.append(key.data(), key.size());
+  buffer_.append(value.data(), value.size());
+  estimate_ += key.size() + value.size();
+}
+
+void BlockBuilder::SwitchToRegularLayout() {
+  std::string entries;
+  entries.swap(buffer_);
+  std::vector<uint32_t> offsets;
+  offsets.swap(restarts_);
+  Reset();
+  fixed_layout_ = false;
+  if (entries.empty()) {
+    return;
+  }
+  for (size_t i = 0; i < offsets.size(); i++) {
+    size_t end = i + 1 < offsets.size() ? offsets[i + 1] : entries.size();
+    Slice key(entries.data() + offsets[i], fixed_key_size_);
+    Slice value(key.data() + key.size(), end - offsets[i] - key.size());
+    Add(key, value);
+  }
+}
+
+void BlockBuilder::Add(const Slice& key, const Slice& value,
+                       const Slice* const delta_value) {
   assert(!finished_);
+  if (fixed_layout_) {
+    if (key.size() == fixed_key_size_) {
+      AddFixedSize(key, value);
+      return;
+    }
+    SwitchToRegularLayout();
+  }
+  assert(!use_value_delta_encoding_ || delta_value != nullptr);
   assert(counter_ <= block_restart_interval_);
   size_t shared = 0;  // number of bytes shared with prev key
   if (counter_ >= block_restart_interval_) {
@@ -115,14 +255,27 @@ void BlockBuilder::Add(const Slice& key, const Slice& value) {
   const size_t non_shared = key.size() - shared;
   const size_t curr_size = buffer_.size();
 
-  // Add "<shared><non_shared><value_size>" to buffer_
-  PutVarint32Varint32Varint32(&buffer_, static_cast<uint32_t>(shared),
-                              static_cast<uint32_t>(non_shared),
-                              static_cast<uint32_t>(value.size()));
+  if (use_value_delta_encoding_) {
+    // Add "<shared><non_shared>" to buffer_
+    PutVarint32Varint32(&buffer_, static_cast<uint32_t>(shared),
+                        static_cast<uint32_t>(non_shared));
+  } else {
+    // Add "<shared><non_shared><value_size>" to buffer_
+    PutVarint32Varint32Varint32(&buffer_, static_cast<uint32_t>(shared),
+                                static_cast<uint32_t>(non_shared),
+                                static_cast<uint32_t>(value.size()));
+  }
 
   // Add string delta to buffer_ followed by value
   buffer_.append(key.data() + shared, non_shared);
-  buffer_.append(value.data(), value.size());
+  // The value is delta-encoded only when the key shares bytes with the
+  // previous one, so readers can tell the two apart from `shared` alone. In
+  // particular every restart point keeps its full value.
+  if (shared != 0 && use_value_delta_encoding_) {
+    buffer_.append(delta_value->data(), delta_value->size());
+  } else {
+    buffer_.append(value.data(), value.size());
+  }
 
   counter_++;
   estimate_ += buffer_.size() - curr_size;
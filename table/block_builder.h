@@ -20,15 +20,37 @@ class BlockBuilder {
   BlockBuilder(const BlockBuilder&) = delete;
   void operator=(const BlockBuilder&) = delete;
 
+  // Set in the stored restart count of a block with the fixed-size layout
+  static const uint32_t kFixedSizeFlag = 1u << 30;
+  // Stored as the value size of a fixed-size block whose values vary
+  static const uint32_t kVariableValueSize = 0xffffffff;
+
+  // If use_learned_index is true, Finish() appends a model that predicts
+  // the restart point of a key (see BlockLearnedIndex). keys_include_seq
+  // tells whether the keys are internal keys or user keys.
+  //
+  // If fixed_key_size is not zero, a block whose keys all have that size
+  // is laid out as a packed array of entries without headers (see
+  // block_builder.cc). Once a key of another size is added the block falls
+  // back to the regular layout.
   explicit BlockBuilder(int block_restart_interval,
-                        bool use_delta_encoding = true);
+                        bool use_delta_encoding = true,
+                        bool use_value_delta_encoding = false,
+                        bool use_learned_index = false,
+                        bool keys_include_seq = true,
+                        uint32_t fixed_key_size = 0);
 
   // Reset the contents as if the BlockBuilder was just constructed.
   void Reset();
 
   // REQUIRES: Finish() has not been called since the last call to Reset().
   // REQUIRES: key is larger than any previously added key
-  void Add(const Slice& key, const Slice& value);
+  // REQUIRES: delta_value is not nullptr if use_value_delta_encoding is set.
+  // Entries whose key shares a prefix with the previous key store
+  // *delta_value instead of value, so value must be self-delimiting and
+  // delta_value must be decodable given the previous entry's value.
+  void Add(const Slice& key, const Slice& value,
+           const Slice* const delta_value = nullptr);
 
   // Finish building the block and return a slice that refers to the
   // block contents.  The returned slice will remain valid for the
@@ -50,6 +72,11 @@ class BlockBuilder {
  private:
   const int          block_restart_interval_;
   const bool         use_delta_encoding_;
+  // Values carry no length and may be delta-encoded (see block_builder.cc)
+  const bool         use_value_delta_encoding_;
+  const bool         use_learned_index_;
+  const bool         keys_include_seq_;
+  const uint32_t     fixed_key_size_;
 
   std::string           buffer_;    // Destination buffer
   std::vector<uint32_t> restarts_;  // Restart points
@@ -57,6 +84,20 @@ class BlockBuilder {
   int                   counter_;   // Number of entries emitted since restart
   bool                  finished_;  // Has Finish() been called?
   std::string           last_key_;
+  // True while the block has the fixed-size layout. restarts_ then holds
+  // the offset of every entry.
+  bool                  fixed_layout_;
+  // Size of all values so far in the fixed-size layout, or
+  // kVariableValueSize if they differ
+  uint32_t              fixed_value_size_;
+
+  // Appends the learned index, if it pays off, and returns true.
+  bool AppendLearnedIndex(size_t restarts_offset);
+
+  void AddFixedSize(const Slice& key, const Slice& value);
+
+  // Rewrites the entries added so far in the regular layout.
+  void SwitchToRegularLayout();
 };
 
 }  // namespace rocksdb
@@ -0,0 +1,126 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_learned_index.h"
+
+#include <string.h>
+#include <algorithm>
+
+#include "rocksdb/comparator.h"
+#include "util/coding.h"
+
+namespace rocksdb {
+
+const uint32_t BlockLearnedIndex::kLearnedIndexFlag;
+const size_t BlockLearnedIndex::kEncodedLength;
+
+namespace {
+// Blocks with fewer restart points are searched just as fast without a
+// model.
+const size_t kMinRestarts = 8;
+
+uint64_t KeyNumber(const Slice& user_key, uint32_t skip) {
+  uint64_t number = 0;
+  for (size_t i = skip; i < skip + sizeof(uint64_t); i++) {
+    number <<= 8;
+    if (i < user_key.size()) {
+      number |= static_cast<unsigned char>(user_key[i]);
+    }
+  }
+  return number;
+}
+
+uint32_t PredictPosition(uint64_t number, uint64_t base, double slope,
+                         uint32_t num_restarts) {
+  if (number <= base) {
+    return 0;
+  }
+  double position = static_cast<double>(number - base) * slope;
+  if (position >= num_restarts - 1) {
+    return num_restarts - 1;
+  }
+  return static_cast<uint32_t>(position + 0.5);
+}
+}  // namespace
+
+bool BlockLearnedIndex::Build(const std::vector<Slice>& restart_user_keys,
+                              std::string* dst) {
+  const size_t num_restarts = restart_user_keys.size();
+  if (num_restarts < kMinRestarts) {
+    return false;
+  }
+  const Slice& first = restart_user_keys.front();
+  const Slice& last = restart_user_keys.back();
+  uint32_t skip = 0;
+  while (skip < first.size() && skip < last.size() &&
+         first[skip] == last[skip]) {
+    skip++;
+  }
+  uint64_t base = KeyNumber(first, skip);
+  uint64_t last_number = KeyNumber(last, skip);
+  if (last_number <= base) {
+    // The keys differ only past the bytes the model looks at
+    return false;
+  }
+  double slope =
+      static_cast<double>(num_restarts - 1) / static_cast<double>(last_number -
+                                                                  base);
+
+  uint32_t max_error = 0;
+  for (size_t i = 0; i < num_restarts; i++) {
+    uint32_t position =
+        PredictPosition(KeyNumber(restart_user_keys[i], skip), base, slope,
+                        static_cast<uint32_t>(num_restarts));
+    uint32_t error = position > i ? static_cast<uint32_t>(position - i)
+                                  : static_cast<uint32_t>(i - position);
+    max_error = std::max(max_error, error);
+  }
+  // Worth it only if the window is at most half of the restart points
+  if ((2 * static_cast<uint64_t>(max_error) + 3) * 2 > num_restarts) {
+    return false;
+  }
+
+  uint64_t slope_bits;
+  static_assert(sizeof(slope_bits) == sizeof(slope), "double is not 64 bits");
+  memcpy(&slope_bits, &slope, sizeof(slope));
+  PutFixed32(dst, skip);
+  PutFixed64(dst, base);
+  PutFixed64(dst, slope_bits);
+  PutFixed32(dst, max_error);
+  return true;
+}
+
+bool BlockLearnedIndex::Supports(const Comparator* user_comparator) {
+  return strcmp(user_comparator->Name(), BytewiseComparator()->Name()) == 0;
+}
+
+BlockLearnedIndex::BlockLearnedIndex(const char* data, uint32_t num_restarts)
+    : skip_(DecodeFixed32(data)),
+      base_(DecodeFixed64(data + 4)),
+      max_error_(DecodeFixed32(data + 20)),
+      num_restarts_(num_restarts) {
+  uint64_t slope_bits = DecodeFixed64(data + 12);
+  memcpy(&slope_, &slope_bits, sizeof(slope_));
+  if (!(slope_ >= 0)) {
+    // Corrupt; searching the whole block is always correct
+    slope_ = 0;
+    max_error_ = num_restarts_;
+  }
+}
+
+void BlockLearnedIndex::Predict(const Slice& user_key, uint32_t* left,
+                                uint32_t* right) const {
+  assert(num_restarts_ > 0);
+  uint32_t position = PredictPosition(KeyNumber(user_key, skip_), base_,
+                                      slope_, num_restarts_);
+  // A key between two restart keys is predicted between their predictions,
+  // and the answer of the search may be the restart point before it.
+  uint64_t margin = static_cast<uint64_t>(max_error_) + 1;
+  *left = position > margin ? static_cast<uint32_t>(position - margin) : 0;
+  *right = static_cast<uint32_t>(
+      std::min<uint64_t>(num_restarts_ - 1, position + margin));
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,74 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "rocksdb/slice.h"
+
+namespace rocksdb {
+
+class Comparator;
+
+// A learned index predicts which restart point of a block a key falls
+// under, so that a seek only binary-searches a few restart points around
+// the prediction instead of all of them.
+//
+// The model is a straight line through the first and the last restart key
+// (as in interpolation search). Keys are mapped to numbers by the eight
+// bytes that follow the common prefix of those two keys, read big-endian;
+// for bytewise-ordered user keys this mapping is monotone. The builder
+// records the largest distance between a restart point and its prediction,
+// which bounds the search window. Nearly uniform keys, such as fixed-width
+// keys drawn at random, give windows of a handful of restart points.
+//
+// The model works on user keys, so it is only built for tables whose user
+// comparator is BytewiseComparator(). A seek never trusts the model
+// blindly: BlockIter checks the ends of the window and falls back to a
+// binary search over the whole block if the key lies outside of it.
+//
+// Block layout with a learned index:
+//     restarts: uint32[num_restarts]
+//     learned index: char[BlockLearnedIndex::kEncodedLength]
+//     num_restarts | kLearnedIndexFlag: uint32
+class BlockLearnedIndex {
+ public:
+  // Set in the stored restart count of a block with a learned index.
+  static const uint32_t kLearnedIndexFlag = 1u << 31;
+  static const size_t kEncodedLength = 24;
+
+  // Fits a model to the user keys of the restart points of a block, in
+  // order. Appends it to *dst and returns true if it narrows the search
+  // down enough to pay for its space; otherwise appends nothing and returns
+  // false.
+  static bool Build(const std::vector<Slice>& restart_user_keys,
+                    std::string* dst);
+
+  // Returns true if the learned index applies to tables with this user
+  // comparator.
+  static bool Supports(const Comparator* user_comparator);
+
+  // Decodes the model from the kEncodedLength bytes at `data`.
+  BlockLearnedIndex(const char* data, uint32_t num_restarts);
+
+  // Sets [*left, *right] to the restart points to search for `user_key`.
+  // The last restart point with a key smaller than `user_key` lies in this
+  // window whenever `user_key` lies between the keys of the block.
+  void Predict(const Slice& user_key, uint32_t* left, uint32_t* right) const;
+
+  uint32_t max_error() const { return max_error_; }
+
+ private:
+  uint32_t skip_;       // Length of the prefix that all keys share
+  uint64_t base_;       // Number of the first restart key
+  double slope_;        // Restart points per unit of key number
+  uint32_t max_error_;  // Largest distance of a restart from its prediction
+  uint32_t num_restarts_;
+};
+
+}  // namespace rocksdb
@@ -0,0 +1,192 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_learned_index.h"
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "table/block.h"
+#include "table/block_builder.h"
+#include "util/coding.h"
+#include "util/random.h"
+#include "util/testharness.h"
+#include "util/testutil.h"
+
+namespace rocksdb {
+
+namespace {
+// Printable characters drawn uniformly, so the keys are spread evenly
+std::string UniformKey(Random* rnd, int len) {
+  std::string key;
+  test::RandomString(rnd, len, &key);
+  return key;
+}
+}  // namespace
+
+class BlockLearnedIndexTest : public testing::Test {
+ public:
+  BlockLearnedIndexTest() : icomp_(BytewiseComparator()) {}
+
+  // Builds a block of the given user keys, one restart point per key.
+  void Build(const std::vector<std::string>& user_keys, bool learned) {
+    BlockBuilder builder(1 /* block_restart_interval */,
+                         true /* use_delta_encoding */,
+                         false /* use_value_delta_encoding */, learned);
+    for (const auto& user_key : user_keys) {
+      builder.Add(InternalKey(user_key, 1, kTypeValue).Encode(), user_key);
+    }
+    contents_ = builder.Finish().ToString();
+    BlockContents contents;
+    contents.data = Slice(contents_);
+    contents.cachable = false;
+    block_.reset(new Block(std::move(contents), kDisableGlobalSequenceNumber));
+  }
+
+  bool HasLearnedIndex() const {
+    return (DecodeFixed32(contents_.data() + contents_.size() - 4) &
+            BlockLearnedIndex::kLearnedIndexFlag) != 0;
+  }
+
+  // Returns the user key found by Seek(), or "END"
+  std::string Seek(const std::string& user_key) {
+    std::unique_ptr<InternalIterator> iter(block_->NewIterator(&icomp_));
+    iter->Seek(InternalKey(user_key, kMaxSequenceNumber, kTypeValue).Encode());
+    EXPECT_OK(iter->status());
+    return iter->Valid() ? ExtractUserKey(iter->key()).ToString() : "END";
+  }
+
+  // Returns the user key found by SeekForPrev(), or "BEGIN"
+  std::string SeekForPrev(const std::string& user_key) {
+    std::unique_ptr<InternalIterator> iter(block_->NewIterator(&icomp_));
+    iter->SeekForPrev(InternalKey(user_key, 0, kTypeValue).Encode());
+    EXPECT_OK(iter->status());
+    return iter->Valid() ? ExtractUserKey(iter->key()).ToString() : "BEGIN";
+  }
+
+  // Checks Seek() and SeekForPrev() against a search of `user_keys`
+  void Check(const std::set<std::string>& user_keys,
+             const std::string& target) {
+    auto it = user_keys.lower_bound(target);
+    ASSERT_EQ(it == user_keys.end() ? "END" : *it, Seek(target)) << target;
+    it = user_keys.upper_bound(target);
+    ASSERT_EQ(it == user_keys.begin() ? "BEGIN" : *(--it), SeekForPrev(target))
+        << target;
+  }
+
+  size_t BlockSize() const { return contents_.size(); }
+
+ private:
+  InternalKeyComparator icomp_;
+  std::string contents_;
+  std::unique_ptr<Block> block_;
+};
+
+TEST_F(BlockLearnedIndexTest, UniformKeys) {
+  Random rnd(301);
+  std::set<std::string> key_set;
+  while (key_set.size() < 1000) {
+    key_set.insert(UniformKey(&rnd, 16));
+  }
+  std::vector<std::string> keys(key_set.begin(), key_set.end());
+
+  Build(keys, false);
+  size_t plain_size = BlockSize();
+  Build(keys, true);
+  ASSERT_TRUE(HasLearnedIndex());
+  ASSERT_EQ(plain_size + BlockLearnedIndex::kEncodedLength, BlockSize());
+
+  for (const auto& key : keys) {
+    Check(key_set, key);
+    // Between keys
+    Check(key_set, key + "0");
+    Check(key_set, key.substr(0, 15));
+  }
+  for (int i = 0; i < 1000; i++) {
+    Check(key_set, UniformKey(&rnd, 1 + rnd.Uniform(20)));
+  }
+  // Outside of the keys of the block
+  Check(key_set, "");
+  Check(key_set, std::string(17, '\xff'));
+}
+
+TEST_F(BlockLearnedIndexTest, SmallError) {
+  std::vector<std::string> keys;
+  std::vector<Slice> slices;
+  for (uint64_t i = 0; i < 1000; i++) {
+    std::string key = "prefix";
+    PutFixed64(&key, 0);
+    // Evenly spaced, big-endian
+    for (int b = 0; b < 8; b++) {
+      key[6 + b] = static_cast<char>((i * 1000003) >> (56 - 8 * b));
+    }
+    keys.push_back(key);
+  }
+  for (const auto& key : keys) {
+    slices.push_back(key);
+  }
+  std::string model;
+  ASSERT_TRUE(BlockLearnedIndex::Build(slices, &model));
+  ASSERT_EQ(BlockLearnedIndex::kEncodedLength, model.size());
+  BlockLearnedIndex index(model.data(), static_cast<uint32_t>(keys.size()));
+  ASSERT_EQ(0U, index.max_error());
+  for (uint32_t i = 0; i < keys.size(); i++) {
+    uint32_t left, right;
+    index.Predict(keys[i], &left, &right);
+    ASSERT_LE(left, i);
+    ASSERT_GE(right, i);
+    ASSERT_LE(right - left, 2U);
+  }
+}
+
+TEST_F(BlockLearnedIndexTest, NoModelWhenUseless) {
+  std::vector<std::string> keys;
+  // Too few restart points
+  for (int i = 0; i < 4; i++) {
+    keys.push_back("key" + std::to_string(i));
+  }
+  Build(keys, true);
+  ASSERT_FALSE(HasLearnedIndex());
+
+  // Most keys bunched up at the start; a line through the ends is far off
+  keys.clear();
+  for (int i = 100; i < 200; i++) {
+    keys.push_back("a" + std::to_string(i));
+  }
+  keys.push_back("z");
+  Build(keys, true);
+  ASSERT_FALSE(HasLearnedIndex());
+  std::set<std::string> key_set(keys.begin(), keys.end());
+  Check(key_set, "a150");
+  Check(key_set, "b");
+}
+
+TEST_F(BlockLearnedIndexTest, TargetsOutsideOfPrefix) {
+  Random rnd(301);
+  std::set<std::string> key_set;
+  while (key_set.size() < 500) {
+    key_set.insert("k" + UniformKey(&rnd, 16));
+  }
+  std::vector<std::string> keys(key_set.begin(), key_set.end());
+  Build(keys, true);
+  ASSERT_TRUE(HasLearnedIndex());
+  // Targets that do not share the prefix of the keys get predictions that
+  // are far off, and must fall back to a full search.
+  Check(key_set, "a" + std::string(16, '\xff'));
+  Check(key_set, "z" + std::string(16, '\0'));
+  Check(key_set, "k");
+  Check(key_set, "j\xff");
+  Check(key_set, "l");
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -129,6 +129,242 @@ TEST_F(BlockTest, SimpleTest) {
   delete iter;
 }
 
+// Index blocks of format_version 3: user keys and delta-encoded handles
+TEST_F(BlockTest, DeltaEncodedIndexBlock) {
+  InternalKeyComparator icomp(BytewiseComparator());
+  for (bool key_includes_seq : {true, false}) {
+    std::vector<std::string> keys;
+    std::vector<std::string> values;
+    GenerateRandomKVs(&keys, &values, 0, 1000);
+
+    BlockBuilder builder(16, true /* use_delta_encoding */,
+                         true /* use_value_delta_encoding */);
+    std::vector<BlockHandle> handles;
+    BlockHandle prev(0, 0);
+    Random rnd(301);
+    for (size_t i = 0; i < keys.size(); i++) {
+      BlockHandle handle(prev.offset() + prev.size() + kBlockTrailerSize,
+                         100 + rnd.Uniform(4000));
+      std::string handle_encoding;
+      handle.EncodeTo(&handle_encoding);
+      std::string delta_encoding;
+      PutVarsignedint64(&delta_encoding, static_cast<int64_t>(handle.size()) -
+                                             static_cast<int64_t>(prev.size()));
+      Slice delta(delta_encoding);
+      if (key_includes_seq) {
+        keys[i] = InternalKey(keys[i], 0, kTypeValue).Encode().ToString();
+      }
+      builder.Add(keys[i], handle_encoding, &delta);
+      handles.push_back(handle);
+      prev = handle;
+    }
+    BlockContents contents;
+    contents.data = builder.Finish();
+    contents.cachable = false;
+    Block reader(std::move(contents), kDisableGlobalSequenceNumber);
+
+    auto check = [&](InternalIterator* iter, size_t i) {
+      ASSERT_TRUE(iter->Valid());
+      Slice user_key = key_includes_seq ? ExtractUserKey(keys[i]) : keys[i];
+      ASSERT_EQ(user_key, ExtractUserKey(iter->key()));
+      BlockHandle handle;
+      Slice value = iter->value();
+      ASSERT_OK(handle.DecodeFrom(&value));
+      ASSERT_EQ(handles[i].offset(), handle.offset());
+      ASSERT_EQ(handles[i].size(), handle.size());
+    };
+
+    std::unique_ptr<InternalIterator> iter(reader.NewIndexIterator(
+        &icomp, nullptr, true, key_includes_seq, true));
+    size_t i = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), i++) {
+      check(iter.get(), i);
+    }
+    ASSERT_EQ(keys.size(), i);
+    for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+      check(iter.get(), --i);
+    }
+    ASSERT_EQ(0U, i);
+
+    for (i = 0; i < keys.size(); i++) {
+      Slice user_key = key_includes_seq ? ExtractUserKey(keys[i]) : keys[i];
+      // Any version of the user key finds its own entry
+      iter->Seek(InternalKey(user_key, kMaxSequenceNumber, kTypeValue)
+                     .Encode());
+      check(iter.get(), i);
+      iter->Seek(InternalKey(user_key, 0, kTypeValue).Encode());
+      check(iter.get(), i);
+      // A key just past it finds the next one
+      iter->Seek(InternalKey(user_key.ToString() + "0", kMaxSequenceNumber,
+                             kTypeValue)
+                     .Encode());
+      if (i + 1 < keys.size()) {
+        check(iter.get(), i + 1);
+        iter->Prev();
+        check(iter.get(), i);
+      } else {
+        ASSERT_FALSE(iter->Valid());
+      }
+    }
+  }
+}
+
+TEST_F(BlockTest, FixedSizeKeyBlock) {
+  InternalKeyComparator icomp(BytewiseComparator());
+  const uint32_t kKeySize = 10 + 8;
+  // 0: fixed-size values, 1: values of varying size, 2: one key of another
+  // size, which falls back to the regular layout
+  for (int mode = 0; mode < 3; mode++) {
+    std::vector<std::string> keys;
+    std::vector<std::string> values;
+    GenerateRandomKVs(&keys, &values, 0, 500);
+    Random rnd(301);
+    for (size_t i = 0; i < keys.size(); i++) {
+      keys[i] = InternalKey(keys[i], 0, kTypeValue).Encode().ToString();
+      if (mode != 0) {
+        values[i] = RandomString(&rnd, rnd.Uniform(100));
+      }
+    }
+    if (mode == 2) {
+      keys[250] = InternalKey(ExtractUserKey(keys[250]).ToString() + "0", 0,
+                              kTypeValue)
+                      .Encode()
+                      .ToString();
+    }
+
+    BlockBuilder builder(16, true /* use_delta_encoding */,
+                         false /* use_value_delta_encoding */,
+                         false /* use_learned_index */,
+                         true /* keys_include_seq */, kKeySize);
+    size_t estimate = builder.CurrentSizeEstimate();
+    for (size_t i = 0; i < keys.size(); i++) {
+      if (mode != 2) {
+        ASSERT_EQ(estimate, builder.CurrentSizeEstimate());
+      }
+      estimate = builder.EstimateSizeAfterKV(keys[i], values[i]);
+      builder.Add(keys[i], values[i]);
+    }
+    Slice raw = builder.Finish();
+    std::string contents_data = raw.ToString();
+    uint32_t stored_count =
+        DecodeFixed32(contents_data.data() + contents_data.size() - 4);
+    size_t data_size = 0;
+    for (size_t i = 0; i < keys.size(); i++) {
+      data_size += keys[i].size() + values[i].size();
+    }
+    if (mode == 0) {
+      ASSERT_EQ(keys.size() | BlockBuilder::kFixedSizeFlag, stored_count);
+      ASSERT_EQ(data_size + 3 * sizeof(uint32_t), contents_data.size());
+    } else if (mode == 1) {
+      ASSERT_EQ(keys.size() | BlockBuilder::kFixedSizeFlag, stored_count);
+      ASSERT_EQ(data_size + (keys.size() + 3) * sizeof(uint32_t),
+                contents_data.size());
+    } else {
+      ASSERT_EQ(0U, stored_count & BlockBuilder::kFixedSizeFlag);
+    }
+    ASSERT_GE(estimate, contents_data.size());
+
+    BlockContents contents;
+    contents.data = Slice(contents_data);
+    contents.cachable = false;
+    Block reader(std::move(contents), kDisableGlobalSequenceNumber);
+
+    auto check = [&](InternalIterator* iter, size_t i) {
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(keys[i], iter->key().ToString());
+      ASSERT_EQ(values[i], iter->value().ToString());
+    };
+
+    std::unique_ptr<InternalIterator> iter(reader.NewIterator(&icomp));
+    size_t i = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), i++) {
+      check(iter.get(), i);
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(keys.size(), i);
+    for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+      check(iter.get(), --i);
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(0U, i);
+
+    for (i = 0; i < keys.size(); i++) {
+      std::string user_key = ExtractUserKey(keys[i]).ToString();
+      iter->Seek(InternalKey(user_key, kMaxSequenceNumber, kTypeValue)
+                     .Encode());
+      check(iter.get(), i);
+      // Between this key and the next one
+      iter->Seek(InternalKey(user_key + "\xff", kMaxSequenceNumber,
+                             kTypeValue)
+                     .Encode());
+      if (i + 1 < keys.size()) {
+        check(iter.get(), i + 1);
+        iter->Prev();
+        check(iter.get(), i);
+        iter->Next();
+        check(iter.get(), i + 1);
+      } else {
+        ASSERT_FALSE(iter->Valid());
+      }
+      iter->SeekForPrev(
+          InternalKey(user_key + "\xff", 0, kTypeValue).Encode());
+      check(iter.get(), i);
+    }
+    iter->Seek(InternalKey("", kMaxSequenceNumber, kTypeValue).Encode());
+    check(iter.get(), 0);
+    iter->SeekForPrev(InternalKey("", 0, kTypeValue).Encode());
+    ASSERT_FALSE(iter->Valid());
+    ASSERT_OK(iter->status());
+  }
+}
+
+TEST_F(BlockTest, FixedSizeKeyBlockGlobalSeqno) {
+  InternalKeyComparator icomp(BytewiseComparator());
+  BlockBuilder builder(16, true, false, false, true, 8 + 8);
+  std::vector<std::string> user_keys;
+  for (int i = 0; i < 100; i++) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "key%05d", i);
+    user_keys.push_back(buf);
+    builder.Add(InternalKey(buf, 0, kTypeValue).Encode(), "value");
+  }
+  BlockContents contents;
+  contents.data = builder.Finish();
+  contents.cachable = false;
+  Block reader(std::move(contents), 10 /* global_seqno */);
+
+  std::unique_ptr<InternalIterator> iter(reader.NewIterator(&icomp));
+  size_t i = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), i++) {
+    ParsedInternalKey ikey;
+    ASSERT_TRUE(ParseInternalKey(iter->key(), &ikey));
+    ASSERT_EQ(user_keys[i], ikey.user_key.ToString());
+    ASSERT_EQ(10U, ikey.sequence);
+    ASSERT_FALSE(iter->IsKeyPinned());
+  }
+  ASSERT_EQ(user_keys.size(), i);
+}
+
+TEST_F(BlockTest, CorruptFixedSizeKeyBlock) {
+  InternalKeyComparator icomp(BytewiseComparator());
+  BlockBuilder builder(16, true, false, false, true, 8 + 8);
+  for (int i = 0; i < 10; i++) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "key%05d", i);
+    builder.Add(InternalKey(buf, 0, kTypeValue).Encode(), "value");
+  }
+  std::string data = builder.Finish().ToString();
+  // Claim one more entry than there is room for
+  EncodeFixed32(&data[data.size() - 4], 11 | BlockBuilder::kFixedSizeFlag);
+  BlockContents contents;
+  contents.data = Slice(data);
+  contents.cachable = false;
+  Block reader(std::move(contents), kDisableGlobalSequenceNumber);
+  std::unique_ptr<InternalIterator> iter(reader.NewIterator(&icomp));
+  ASSERT_TRUE(iter->status().IsCorruption());
+  ASSERT_FALSE(iter->Valid());
+}
+
 // return the block contents
 BlockContents GetBlockContents(std::unique_ptr<BlockBuilder> *builder,
                                const std::vector<std::string> &keys,
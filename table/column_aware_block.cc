@@ -0,0 +1,502 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/column_aware_block.h"
+
+#include <string.h>
+#include <unordered_map>
+
+#include "table/block_builder.h"
+#include "table/format.h"
+#include "util/coding.h"
+#include "util/string_util.h"
+
+namespace rocksdb {
+
+const uint32_t ColumnAwareBlockBuilder::kColumnAwareBlockFlag;
+
+namespace {
+const char kUseDeltaEncoding = 0x1;
+const char kUseLearnedIndex = 0x2;
+
+// Reads the integer that kDelta encodes from a column value
+uint64_t ToNumber(const Slice& value, bool big_endian) {
+  uint64_t number = 0;
+  for (size_t i = 0; i < value.size(); i++) {
+    size_t pos = big_endian ? i : value.size() - 1 - i;
+    number = (number << 8) | static_cast<unsigned char>(value[pos]);
+  }
+  return number;
+}
+
+void AppendNumber(uint64_t number, size_t size, bool big_endian,
+                  std::string* dst) {
+  size_t start = dst->size();
+  dst->resize(start + size);
+  for (size_t i = 0; i < size; i++) {
+    size_t pos = big_endian ? size - 1 - i : i;
+    (*dst)[start + pos] = static_cast<char>(number & 0xff);
+    number >>= 8;
+  }
+}
+
+// Reads a value of `column` from the front of *input. The value of a
+// variable-length column does not include its length.
+bool GetColumnValue(const ValueColumn& column, Slice* input, Slice* value) {
+  if (column.type == ValueColumn::kFixedLength) {
+    if (input->size() < column.size) {
+      return false;
+    }
+    *value = Slice(input->data(), column.size);
+    input->remove_prefix(column.size);
+    return true;
+  }
+  return GetLengthPrefixedSlice(input, value);
+}
+
+void PutColumnValue(const ValueColumn& column, const Slice& value,
+                    std::string* dst) {
+  if (column.type == ValueColumn::kFixedLength) {
+    dst->append(value.data(), value.size());
+  } else {
+    PutLengthPrefixedSlice(dst, value);
+  }
+}
+
+// Decodes the section of one column, row by row.
+class ColumnReader {
+ public:
+  explicit ColumnReader(const ValueColumn& column)
+      : column_(column), run_remaining_(0), last_number_(0) {}
+
+  bool Init(const Slice& section) {
+    input_ = section;
+    if (column_.encoding == ValueColumn::kDictionary) {
+      uint32_t dictionary_size = 0;
+      if (!GetVarint32(&input_, &dictionary_size) ||
+          dictionary_size > input_.size()) {
+        return false;
+      }
+      dictionary_.resize(dictionary_size);
+      for (uint32_t i = 0; i < dictionary_size; i++) {
+        if (!GetColumnValue(column_, &input_, &dictionary_[i])) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  // Appends the value of the next row, as it is laid out in the row
+  bool Next(std::string* dst) {
+    Slice value;
+    switch (column_.encoding) {
+      case ValueColumn::kRunLength:
+        if (run_remaining_ == 0) {
+          if (!GetVarint64(&input_, &run_remaining_) || run_remaining_ == 0 ||
+              !GetColumnValue(column_, &input_, &run_value_)) {
+            return false;
+          }
+        }
+        run_remaining_--;
+        value = run_value_;
+        break;
+      case ValueColumn::kDelta: {
+        int64_t delta = 0;
+        if (!GetVarsignedint64(&input_, &delta)) {
+          return false;
+        }
+        last_number_ += static_cast<uint64_t>(delta);
+        AppendNumber(last_number_, column_.size, column_.big_endian, dst);
+        return true;
+      }
+      case ValueColumn::kDictionary: {
+        uint32_t id = 0;
+        if (!GetVarint32(&input_, &id) || id >= dictionary_.size()) {
+          return false;
+        }
+        value = dictionary_[id];
+        break;
+      }
+      default:
+        if (!GetColumnValue(column_, &input_, &value)) {
+          return false;
+        }
+        break;
+    }
+    PutColumnValue(column_, value, dst);
+    return true;
+  }
+
+ private:
+  const ValueColumn column_;
+  Slice input_;
+  std::vector<Slice> dictionary_;
+  Slice run_value_;
+  uint64_t run_remaining_;
+  uint64_t last_number_;
+};
+}  // namespace
+
+// Encodes the values of one column, row by row.
+class ColumnWriter {
+ public:
+  explicit ColumnWriter(const ValueColumn& column) : column_(column) {
+    Reset();
+  }
+
+  void Add(const Slice& value) {
+    switch (column_.encoding) {
+      case ValueColumn::kRunLength:
+        if (run_length_ > 0 && value == Slice(run_value_)) {
+          run_length_++;
+          return;
+        }
+        FlushRun();
+        run_value_.assign(value.data(), value.size());
+        run_length_ = 1;
+        break;
+      case ValueColumn::kDelta: {
+        uint64_t number = ToNumber(value, column_.big_endian);
+        PutVarsignedint64(&data_, static_cast<int64_t>(number - last_number_));
+        last_number_ = number;
+        break;
+      }
+      case ValueColumn::kDictionary: {
+        std::string key = value.ToString();
+        auto it = dictionary_.find(key);
+        uint32_t id;
+        if (it == dictionary_.end()) {
+          id = static_cast<uint32_t>(dictionary_.size());
+          dictionary_.emplace(std::move(key), id);
+          PutColumnValue(column_, value, &dictionary_data_);
+        } else {
+          id = it->second;
+        }
+        PutVarint32(&data_, id);
+        break;
+      }
+      default:
+        PutColumnValue(column_, value, &data_);
+        break;
+    }
+  }
+
+  void Finish(std::string* dst) {
+    FlushRun();
+    if (column_.encoding == ValueColumn::kDictionary) {
+      PutVarint32(dst, static_cast<uint32_t>(dictionary_.size()));
+      dst->append(dictionary_data_);
+    }
+    dst->append(data_);
+  }
+
+  void Reset() {
+    data_.clear();
+    run_value_.clear();
+    run_length_ = 0;
+    last_number_ = 0;
+    dictionary_.clear();
+    dictionary_data_.clear();
+  }
+
+ private:
+  void FlushRun() {
+    if (run_length_ > 0) {
+      PutVarint64(&data_, run_length_);
+      PutColumnValue(column_, run_value_, &data_);
+      run_length_ = 0;
+    }
+  }
+
+  const ValueColumn column_;
+  std::string data_;
+  std::string run_value_;
+  uint64_t run_length_;
+  uint64_t last_number_;
+  std::unordered_map<std::string, uint32_t> dictionary_;
+  std::string dictionary_data_;  // Distinct values in order of their ids
+};
+
+ColumnAwareBlockBuilder::ColumnAwareBlockBuilder(
+    const std::vector<ValueColumn>& columns, int block_restart_interval,
+    bool use_delta_encoding, bool use_learned_index, uint32_t fixed_key_size)
+    : columns_(columns),
+      block_restart_interval_(block_restart_interval),
+      use_delta_encoding_(use_delta_encoding),
+      use_learned_index_(use_learned_index),
+      fixed_key_size_(fixed_key_size),
+      num_rows_(0),
+      row_size_estimate_(0),
+      column_values_(columns.size()) {
+  assert(ValidateValueColumns(columns_).ok());
+  for (const auto& column : columns_) {
+    writers_.emplace_back(new ColumnWriter(column));
+  }
+}
+
+ColumnAwareBlockBuilder::~ColumnAwareBlockBuilder() {}
+
+void ColumnAwareBlockBuilder::Add(const Slice& key, const Slice& value) {
+  size_t shared = key.difference_offset(last_key_);
+  // As BlockBuilder::Add() with delta encoding
+  size_t row_shared = shared;
+  if (num_rows_ % block_restart_interval_ == 0) {
+    row_shared = 0;
+    row_size_estimate_ += sizeof(uint32_t);
+  }
+  row_size_estimate_ += VarintLength(row_shared) +
+                        VarintLength(key.size() - row_shared) +
+                        VarintLength(value.size()) + key.size() - row_shared +
+                        value.size();
+
+  PutVarint32Varint32(&keys_, static_cast<uint32_t>(shared),
+                      static_cast<uint32_t>(key.size() - shared));
+  keys_.append(key.data() + shared, key.size() - shared);
+  last_key_.assign(key.data(), key.size());
+
+  Slice input = value;
+  bool parsed = true;
+  for (size_t i = 0; parsed && i < columns_.size(); i++) {
+    parsed = GetColumnValue(columns_[i], &input, &column_values_[i]);
+  }
+  if (parsed) {
+    for (size_t i = 0; i < columns_.size(); i++) {
+      writers_[i]->Add(column_values_[i]);
+    }
+    PutVarint64(&rest_, static_cast<uint64_t>(input.size()) << 1);
+    rest_.append(input.data(), input.size());
+  } else {
+    PutVarint64(&rest_, (static_cast<uint64_t>(value.size()) << 1) | 1);
+    rest_.append(value.data(), value.size());
+  }
+  num_rows_++;
+}
+
+Slice ColumnAwareBlockBuilder::Finish() {
+  buffer_.clear();
+  PutVarint32(&buffer_, num_rows_);
+  PutVarint32(&buffer_, static_cast<uint32_t>(block_restart_interval_));
+  char flags = 0;
+  if (use_delta_encoding_) {
+    flags |= kUseDeltaEncoding;
+  }
+  if (use_learned_index_) {
+    flags |= kUseLearnedIndex;
+  }
+  buffer_.push_back(flags);
+  PutVarint32(&buffer_, fixed_key_size_);
+  PutVarint32(&buffer_, static_cast<uint32_t>(columns_.size()));
+  for (const auto& column : columns_) {
+    buffer_.push_back(static_cast<char>(column.type));
+    buffer_.push_back(static_cast<char>(column.encoding));
+    buffer_.push_back(column.big_endian ? 1 : 0);
+    PutVarint32(&buffer_, column.size);
+  }
+
+  std::vector<std::string> sections(columns_.size());
+  for (size_t i = 0; i < columns_.size(); i++) {
+    writers_[i]->Finish(&sections[i]);
+  }
+  PutVarint32(&buffer_, static_cast<uint32_t>(keys_.size()));
+  PutVarint32(&buffer_, static_cast<uint32_t>(rest_.size()));
+  for (const auto& section : sections) {
+    PutVarint32(&buffer_, static_cast<uint32_t>(section.size()));
+  }
+  buffer_.append(keys_);
+  buffer_.append(rest_);
+  for (const auto& section : sections) {
+    buffer_.append(section);
+  }
+  PutFixed32(&buffer_, kColumnAwareBlockFlag);
+  return Slice(buffer_);
+}
+
+size_t ColumnAwareBlockBuilder::EstimateRowSizeAfterKV(
+    const Slice& key, const Slice& value) const {
+  size_t estimate = RowSizeEstimate() + key.size() + value.size();
+  if (num_rows_ % block_restart_interval_ == 0) {
+    estimate += sizeof(uint32_t);  // a new restart entry.
+  }
+  estimate += sizeof(int32_t);  // varint for shared prefix length.
+  estimate += VarintLength(key.size());
+  estimate += VarintLength(value.size());
+  return estimate;
+}
+
+void ColumnAwareBlockBuilder::Reset() {
+  num_rows_ = 0;
+  row_size_estimate_ = 0;
+  keys_.clear();
+  rest_.clear();
+  last_key_.clear();
+  for (auto& writer : writers_) {
+    writer->Reset();
+  }
+  buffer_.clear();
+}
+
+Status ValidateValueColumns(const std::vector<ValueColumn>& columns) {
+  for (size_t i = 0; i < columns.size(); i++) {
+    const ValueColumn& column = columns[i];
+    const std::string name = "Value column " + ToString(i);
+    if (column.type != ValueColumn::kFixedLength &&
+        column.type != ValueColumn::kVariableLength) {
+      return Status::InvalidArgument(name + " has an unknown type");
+    }
+    if (column.encoding > ValueColumn::kDictionary) {
+      return Status::InvalidArgument(name + " has an unknown encoding");
+    }
+    if (column.type == ValueColumn::kFixedLength && column.size == 0) {
+      return Status::InvalidArgument(name + " has a fixed length of 0");
+    }
+    if (column.encoding == ValueColumn::kDelta &&
+        (column.type != ValueColumn::kFixedLength || column.size > 8)) {
+      return Status::InvalidArgument(
+          name + ": delta encoding needs a fixed length of at most 8 bytes");
+    }
+  }
+  return Status::OK();
+}
+
+bool IsColumnAwareBlock(const Slice& block) {
+  return block.size() >= sizeof(uint32_t) &&
+         DecodeFixed32(block.data() + block.size() - sizeof(uint32_t)) ==
+             ColumnAwareBlockBuilder::kColumnAwareBlockFlag;
+}
+
+Status DecodeColumnAwareBlock(const Slice& block,
+                              const std::vector<uint32_t>* projection,
+                              BlockContents* contents) {
+  assert(IsColumnAwareBlock(block));
+  Slice input(block.data(), block.size() - sizeof(uint32_t));
+  uint32_t num_rows = 0;
+  uint32_t block_restart_interval = 0;
+  uint32_t fixed_key_size = 0;
+  uint32_t num_columns = 0;
+  if (!GetVarint32(&input, &num_rows) ||
+      !GetVarint32(&input, &block_restart_interval) ||
+      block_restart_interval == 0 || input.empty()) {
+    return Status::Corruption("bad column-aware block");
+  }
+  const char flags = input[0];
+  input.remove_prefix(1);
+  if (!GetVarint32(&input, &fixed_key_size) ||
+      !GetVarint32(&input, &num_columns) || num_columns > input.size()) {
+    return Status::Corruption("bad column-aware block");
+  }
+  std::vector<ValueColumn> columns(num_columns);
+  for (auto& column : columns) {
+    if (input.size() < 3) {
+      return Status::Corruption("bad column-aware block");
+    }
+    column.type = static_cast<ValueColumn::Type>(input[0]);
+    column.encoding = static_cast<ValueColumn::Encoding>(input[1]);
+    column.big_endian = input[2] != 0;
+    input.remove_prefix(3);
+    if (!GetVarint32(&input, &column.size)) {
+      return Status::Corruption("bad column-aware block");
+    }
+  }
+  if (!ValidateValueColumns(columns).ok()) {
+    return Status::Corruption("bad column-aware block");
+  }
+  std::vector<Slice> sections(2 + num_columns);
+  std::vector<uint32_t> section_sizes(sections.size());
+  for (auto& size : section_sizes) {
+    if (!GetVarint32(&input, &size)) {
+      return Status::Corruption("bad column-aware block");
+    }
+  }
+  for (size_t i = 0; i < sections.size(); i++) {
+    if (input.size() < section_sizes[i]) {
+      return Status::Corruption("bad column-aware block");
+    }
+    sections[i] = Slice(input.data(), section_sizes[i]);
+    input.remove_prefix(section_sizes[i]);
+  }
+  if (!input.empty()) {
+    return Status::Corruption("bad column-aware block");
+  }
+  Slice keys = sections[0];
+  Slice rest = sections[1];
+
+  std::vector<bool> decode(num_columns, projection == nullptr);
+  if (projection != nullptr) {
+    for (uint32_t column : *projection) {
+      if (column < num_columns) {
+        decode[column] = true;
+      }
+    }
+  }
+  std::vector<ColumnReader> readers;
+  readers.reserve(num_columns);
+  for (uint32_t i = 0; i < num_columns; i++) {
+    readers.emplace_back(columns[i]);
+    if (decode[i] && !readers[i].Init(sections[2 + i])) {
+      return Status::Corruption("bad column-aware block");
+    }
+  }
+
+  BlockBuilder builder(static_cast<int>(block_restart_interval),
+                       (flags & kUseDeltaEncoding) != 0,
+                       false /* use_value_delta_encoding */,
+                       (flags & kUseLearnedIndex) != 0,
+                       true /* keys_include_seq */, fixed_key_size);
+  std::string key;
+  std::string value;
+  for (uint32_t row = 0; row < num_rows; row++) {
+    uint32_t shared = 0;
+    uint32_t non_shared = 0;
+    if (!GetVarint32(&keys, &shared) || !GetVarint32(&keys, &non_shared) ||
+        shared > key.size() || keys.size() < non_shared) {
+      return Status::Corruption("bad column-aware block");
+    }
+    key.resize(shared);
+    key.append(keys.data(), non_shared);
+    keys.remove_prefix(non_shared);
+
+    uint64_t tag = 0;
+    if (!GetVarint64(&rest, &tag) || rest.size() < (tag >> 1)) {
+      return Status::Corruption("bad column-aware block");
+    }
+    Slice bytes(rest.data(), static_cast<size_t>(tag >> 1));
+    rest.remove_prefix(bytes.size());
+    if (tag & 1) {
+      // A raw row
+      builder.Add(key, bytes);
+      continue;
+    }
+
+    value.clear();
+    for (uint32_t i = 0; i < num_columns; i++) {
+      if (decode[i]) {
+        if (!readers[i].Next(&value)) {
+          return Status::Corruption("bad column-aware block");
+        }
+      } else if (columns[i].type == ValueColumn::kFixedLength) {
+        value.append(columns[i].size, '\0');
+      } else {
+        PutVarint32(&value, 0);
+      }
+    }
+    if (projection == nullptr) {
+      value.append(bytes.data(), bytes.size());
+    }
+    builder.Add(key, value);
+  }
+  if (!keys.empty() || !rest.empty()) {
+    return Status::Corruption("bad column-aware block");
+  }
+
+  Slice rows = builder.Finish();
+  std::unique_ptr<char[]> buf(new char[rows.size()]);
+  memcpy(buf.get(), rows.data(), rows.size());
+  *contents = BlockContents(std::move(buf), rows.size(), false /* cachable */,
+                            kNoCompression);
+  return Status::OK();
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,113 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+#include "rocksdb/table.h"
+
+namespace rocksdb {
+
+struct BlockContents;
+class ColumnWriter;
+
+// A column-aware data block stores the keys of its rows, and the values
+// column by column (see BlockBasedTableOptions::value_columns). Readers turn
+// it back into a regular data block with DecodeColumnAwareBlock() when they
+// load it, so that BlockIter never sees the column-aware layout.
+//
+// Block layout:
+//     num_rows: varint32
+//     block_restart_interval: varint32
+//     flags: char  (kUseDeltaEncoding, kUseLearnedIndex)
+//     fixed_key_size: varint32
+//     num_columns: varint32
+//     columns: (type: char, encoding: char, big_endian: char,
+//               size: varint32)[num_columns]
+//     section sizes: varint32[2 + num_columns]
+//     keys section: (shared: varint32, non_shared: varint32,
+//                    key_delta: char[non_shared])[num_rows]
+//     rest section: (length << 1 | is_raw: varint64,
+//                    bytes: char[length])[num_rows]
+//     column sections[num_columns]
+//     kColumnAwareBlockFlag: uint32
+// The first fields describe how to lay out the decoded block. A row whose
+// value parses as the declared columns stores them in the column sections
+// and the bytes past the last column in the rest section. Other rows are
+// "raw" and store their whole value in the rest section.
+//
+// The trailing word is where other blocks store their number of restart
+// points; readers that do not know this layout find the block corrupt.
+class ColumnAwareBlockBuilder {
+ public:
+  static const uint32_t kColumnAwareBlockFlag = 1u << 29;
+
+  // The remaining arguments are those of the BlockBuilder that
+  // DecodeColumnAwareBlock() lays the rows out with.
+  // REQUIRES: ValidateValueColumns(columns) is OK
+  ColumnAwareBlockBuilder(const std::vector<ValueColumn>& columns,
+                          int block_restart_interval, bool use_delta_encoding,
+                          bool use_learned_index, uint32_t fixed_key_size);
+  ~ColumnAwareBlockBuilder();
+
+  ColumnAwareBlockBuilder(const ColumnAwareBlockBuilder&) = delete;
+  void operator=(const ColumnAwareBlockBuilder&) = delete;
+
+  // REQUIRES: key is larger than any previously added key
+  void Add(const Slice& key, const Slice& value);
+
+  // Returns the block, which remains valid until Reset()
+  Slice Finish();
+
+  void Reset();
+
+  bool empty() const { return num_rows_ == 0; }
+
+  // The size that the rows would take in a regular data block, which blocks
+  // are cut by
+  size_t RowSizeEstimate() const {
+    return row_size_estimate_ + sizeof(uint32_t);
+  }
+  // As BlockBuilder::EstimateSizeAfterKV()
+  size_t EstimateRowSizeAfterKV(const Slice& key, const Slice& value) const;
+
+ private:
+  const std::vector<ValueColumn> columns_;
+  const int block_restart_interval_;
+  const bool use_delta_encoding_;
+  const bool use_learned_index_;
+  const uint32_t fixed_key_size_;
+
+  uint32_t num_rows_;
+  size_t row_size_estimate_;
+  std::string keys_;
+  std::string rest_;
+  std::string last_key_;
+  std::vector<std::unique_ptr<ColumnWriter>> writers_;
+  std::vector<Slice> column_values_;  // Scratch space for Add()
+  std::string buffer_;
+};
+
+// Returns OK if the columns can be used for BlockBasedTableOptions.
+Status ValidateValueColumns(const std::vector<ValueColumn>& columns);
+
+// Returns true if `block` (uncompressed) has the column-aware layout.
+bool IsColumnAwareBlock(const Slice& block);
+
+// Decodes a column-aware block into a regular data block. If projection is
+// not nullptr, it lists the columns to decode in ascending order; the other
+// columns of the values are zero-filled or left empty, and the bytes past
+// the last column are dropped.
+Status DecodeColumnAwareBlock(const Slice& block,
+                              const std::vector<uint32_t>* projection,
+                              BlockContents* contents);
+
+}  // namespace rocksdb
@@ -0,0 +1,260 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/column_aware_block.h"
+
+#include <string>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "table/block.h"
+#include "table/block_builder.h"
+#include "table/format.h"
+#include "util/coding.h"
+#include "util/random.h"
+#include "util/string_util.h"
+#include "util/testharness.h"
+#include "util/testutil.h"
+
+namespace rocksdb {
+
+class ColumnAwareBlockTest : public testing::Test {
+ public:
+  ColumnAwareBlockTest() : icomp_(BytewiseComparator()) {}
+
+  // Columns: a 4-byte id, a variable-length name and a 8-byte timestamp,
+  // followed by a free-form payload.
+  static std::vector<ValueColumn> Columns(ValueColumn::Encoding id_encoding,
+                                          ValueColumn::Encoding name_encoding,
+                                          ValueColumn::Encoding ts_encoding) {
+    return {ValueColumn(ValueColumn::kFixedLength, 4, id_encoding),
+            ValueColumn(ValueColumn::kVariableLength, 0, name_encoding),
+            ValueColumn(ValueColumn::kFixedLength, 8, ts_encoding, true)};
+  }
+
+  static std::string Row(uint32_t id, const std::string& name, uint64_t ts,
+                         const std::string& payload) {
+    std::string row;
+    PutFixed32(&row, id);
+    PutLengthPrefixedSlice(&row, name);
+    for (int i = 7; i >= 0; i--) {
+      row.push_back(static_cast<char>(ts >> (8 * i)));
+    }
+    row.append(payload);
+    return row;
+  }
+
+  void Build(const std::vector<ValueColumn>& columns,
+             const std::vector<std::string>& values) {
+    keys_.clear();
+    ColumnAwareBlockBuilder builder(columns, 4 /* block_restart_interval */,
+                                    true /* use_delta_encoding */,
+                                    false /* use_learned_index */,
+                                    0 /* fixed_key_size */);
+    BlockBuilder rows(4);
+    for (size_t i = 0; i < values.size(); i++) {
+      char user_key[16];
+      snprintf(user_key, sizeof(user_key), "key%06d", static_cast<int>(i));
+      keys_.push_back(InternalKey(user_key, 1, kTypeValue).Encode().ToString());
+      builder.Add(keys_.back(), values[i]);
+      rows.Add(keys_.back(), values[i]);
+    }
+    block_ = builder.Finish().ToString();
+    rows_ = rows.Finish().ToString();
+    ASSERT_TRUE(IsColumnAwareBlock(block_));
+    ASSERT_FALSE(IsColumnAwareBlock(rows_));
+  }
+
+  // Reads back the values of the block
+  std::vector<std::string> Read(const std::vector<uint32_t>* projection) {
+    BlockContents contents;
+    contents.data = Slice(block_);
+    contents.cachable = false;
+    contents.compression_type = kNoCompression;
+    Block block(std::move(contents), kDisableGlobalSequenceNumber,
+                0 /* read_amp_bytes_per_bit */, nullptr /* statistics */,
+                projection);
+    std::vector<std::string> values;
+    std::unique_ptr<InternalIterator> iter(block.NewIterator(&icomp_));
+    size_t i = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), i++) {
+      EXPECT_LT(i, keys_.size());
+      if (i < keys_.size()) {
+        EXPECT_EQ(keys_[i], iter->key().ToString());
+      }
+      values.push_back(iter->value().ToString());
+    }
+    EXPECT_OK(iter->status());
+    EXPECT_EQ(keys_.size(), values.size());
+    return values;
+  }
+
+  const std::string& block() const { return block_; }
+  const std::string& rows() const { return rows_; }
+
+ private:
+  InternalKeyComparator icomp_;
+  std::vector<std::string> keys_;
+  std::string block_;
+  std::string rows_;
+};
+
+TEST_F(ColumnAwareBlockTest, RoundTrip) {
+  Random rnd(301);
+  std::vector<std::string> values;
+  const std::vector<std::string> names = {"alice", "bob", "", "carol"};
+  uint64_t ts = 1500000000000ULL;
+  for (int i = 0; i < 200; i++) {
+    ts += rnd.Uniform(1000);
+    values.push_back(Row(i / 10, names[rnd.Uniform(4)], ts,
+                         test::RandomKey(&rnd, rnd.Uniform(4))));
+  }
+
+  const ValueColumn::Encoding encodings[] = {
+      ValueColumn::kPlain, ValueColumn::kRunLength, ValueColumn::kDelta,
+      ValueColumn::kDictionary};
+  for (auto id_encoding : encodings) {
+    for (auto name_encoding : encodings) {
+      if (name_encoding == ValueColumn::kDelta) {
+        continue;
+      }
+      for (auto ts_encoding : encodings) {
+        Build(Columns(id_encoding, name_encoding, ts_encoding), values);
+        // Decoding gives the block that BlockBuilder builds from the rows
+        BlockContents contents;
+        ASSERT_OK(DecodeColumnAwareBlock(block(), nullptr, &contents));
+        ASSERT_EQ(rows(), contents.data.ToString());
+        ASSERT_EQ(values, Read(nullptr));
+      }
+    }
+  }
+
+  // Ids in runs, few names and close timestamps take less space
+  Build(Columns(ValueColumn::kRunLength, ValueColumn::kDictionary,
+                ValueColumn::kDelta),
+        values);
+  ASSERT_LT(block().size() * 10, rows().size() * 7);
+}
+
+TEST_F(ColumnAwareBlockTest, RawRows) {
+  std::vector<std::string> values;
+  for (int i = 0; i < 50; i++) {
+    switch (i % 4) {
+      case 0:
+        values.push_back(Row(i, "name", i * 7, "payload"));
+        break;
+      case 1:
+        values.push_back("");  // e.g. a deletion
+        break;
+      case 2:
+        // The length of the name goes past the end of the value
+        values.push_back(Row(i, "name", i * 7, "").substr(0, 6));
+        break;
+      default:
+        values.push_back(Row(i, std::string(300, 'x'), 0, ""));
+        break;
+    }
+  }
+  Build(Columns(ValueColumn::kRunLength, ValueColumn::kDictionary,
+                ValueColumn::kDelta),
+        values);
+  BlockContents contents;
+  ASSERT_OK(DecodeColumnAwareBlock(block(), nullptr, &contents));
+  ASSERT_EQ(rows(), contents.data.ToString());
+  ASSERT_EQ(values, Read(nullptr));
+}
+
+TEST_F(ColumnAwareBlockTest, Projection) {
+  std::vector<std::string> values;
+  for (int i = 0; i < 100; i++) {
+    values.push_back(Row(i, "name" + ToString(i % 3), 1000 + i, "payload"));
+  }
+  values.push_back("raw");
+  Build(Columns(ValueColumn::kPlain, ValueColumn::kDictionary,
+                ValueColumn::kDelta),
+        values);
+
+  std::vector<uint32_t> projection = {1};
+  std::vector<std::string> projected = Read(&projection);
+  ASSERT_EQ(values.size(), projected.size());
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(Row(0, "name" + ToString(i % 3), 0, ""), projected[i]);
+  }
+  // Raw rows are returned whole
+  ASSERT_EQ("raw", projected.back());
+
+  projection = {0, 2, 7 /* no such column */};
+  projected = Read(&projection);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(Row(i, "", 1000 + i, ""), projected[i]);
+  }
+
+  projection.clear();
+  projected = Read(&projection);
+  ASSERT_EQ(Row(0, "", 0, ""), projected[0]);
+}
+
+TEST_F(ColumnAwareBlockTest, Corruption) {
+  Random rnd(301);
+  std::vector<std::string> values;
+  for (int i = 0; i < 100; i++) {
+    values.push_back(Row(i / 5, "name" + ToString(i % 3), 1000 + i, "xy"));
+  }
+  Build(Columns(ValueColumn::kRunLength, ValueColumn::kDictionary,
+                ValueColumn::kDelta),
+        values);
+  const std::string good = block();
+  const Slice trailer(good.data() + good.size() - 4, 4);
+
+  // Truncated blocks
+  for (size_t len = 0; len < good.size() - 4; len++) {
+    std::string bad = good.substr(0, len) + trailer.ToString();
+    BlockContents contents;
+    ASSERT_NOK(DecodeColumnAwareBlock(bad, nullptr, &contents)) << len;
+  }
+  // Random bytes are either rejected or decode to some block
+  for (int i = 0; i < 1000; i++) {
+    std::string bad = good;
+    bad[rnd.Uniform(static_cast<int>(good.size()) - 4)] =
+        static_cast<char>(rnd.Uniform(256));
+    BlockContents contents;
+    DecodeColumnAwareBlock(bad, nullptr, &contents);
+  }
+
+  // Blocks that fail to decode are bad blocks
+  BlockContents contents;
+  std::string bad = good.substr(0, good.size() / 2) + trailer.ToString();
+  contents.data = Slice(bad);
+  contents.cachable = false;
+  contents.compression_type = kNoCompression;
+  Block block(std::move(contents), kDisableGlobalSequenceNumber);
+  ASSERT_EQ(0U, block.size());
+  InternalKeyComparator icomp(BytewiseComparator());
+  std::unique_ptr<InternalIterator> iter(block.NewIterator(&icomp));
+  ASSERT_TRUE(iter->status().IsCorruption());
+}
+
+TEST_F(ColumnAwareBlockTest, ValidateValueColumns) {
+  ASSERT_OK(ValidateValueColumns({}));
+  ASSERT_OK(ValidateValueColumns(Columns(
+      ValueColumn::kDelta, ValueColumn::kRunLength, ValueColumn::kDelta)));
+  // Fixed-length columns have a size
+  ASSERT_TRUE(ValidateValueColumns({ValueColumn(ValueColumn::kFixedLength, 0)})
+                  .IsInvalidArgument());
+  // Delta encoding is for numbers
+  ASSERT_TRUE(ValidateValueColumns({ValueColumn(ValueColumn::kFixedLength, 9,
+                                                ValueColumn::kDelta)})
+                  .IsInvalidArgument());
+  ASSERT_TRUE(ValidateValueColumns({ValueColumn(ValueColumn::kVariableLength,
+                                                0, ValueColumn::kDelta)})
+                  .IsInvalidArgument());
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -344,11 +344,12 @@ Status ReadBlockContents(RandomAccessFileReader* file,
                          const ImmutableCFOptions& ioptions,
                          bool decompression_requested,
                          const Slice& compression_dict,
-                         const PersistentCacheOptions& cache_options) {
+                         const PersistentCacheOptions& cache_options,
+                         MemoryAllocator* allocator) {
   Status status;
   Slice slice;
   size_t n = static_cast<size_t>(handle.size());
-  std::unique_ptr<char[]> heap_buf;
+  CacheAllocationPtr heap_buf;
   char stack_buf[DefaultStackBufferSize];
   char* used_buf = nullptr;
   rocksdb::CompressionType compression_type;
@@ -387,8 +388,10 @@ Status ReadBlockContents(RandomAccessFileReader* file,
   } else if (cache_options.persistent_cache &&
              cache_options.persistent_cache->IsCompressed()) {
     // lookup uncompressed cache mode p-cache
+    std::unique_ptr<char[]> raw_page;
     status = PersistentCacheHelper::LookupRawPage(
-        cache_options, handle, &heap_buf, n + kBlockTrailerSize);
+        cache_options, handle, &raw_page, n + kBlockTrailerSize);
+    heap_buf.reset(raw_page.release());
   } else {
     status = Status::NotFound();
   }
@@ -412,7 +415,7 @@ Status ReadBlockContents(RandomAccessFileReader* file,
         // trivially allocated stack buffer instead of needing a full malloc()
         used_buf = &stack_buf[0];
       } else {
-        heap_buf = std::unique_ptr<char[]>(new char[n + kBlockTrailerSize]);
+        heap_buf = AllocateBlock(n + kBlockTrailerSize, allocator);
         used_buf = heap_buf.get();
       }
 
@@ -439,14 +442,14 @@ Status ReadBlockContents(RandomAccessFileReader* file,
     // compressed page, uncompress, update cache
     status = UncompressBlockContents(slice.data(), n, contents,
                                      footer.version(), compression_dict,
-                                     ioptions);
+                                     ioptions, allocator);
   } else if (slice.data() != used_buf) {
     // the slice content is not the buffer provided
     *contents = BlockContents(Slice(slice.data(), n), false, compression_type);
   } else {
     // page is uncompressed, the buffer either stack or heap provided
     if (got_from_prefetch_buffer || used_buf == &stack_buf[0]) {
-      heap_buf = std::unique_ptr<char[]>(new char[n]);
+      heap_buf = AllocateBlock(n, allocator);
       memcpy(heap_buf.get(), used_buf, n);
     }
     *contents = BlockContents(std::move(heap_buf), n, true, compression_type);
@@ -466,8 +469,9 @@ Status ReadBlockContents(RandomAccessFileReader* file,
 Status UncompressBlockContentsForCompressionType(
     const char* data, size_t n, BlockContents* contents,
     uint32_t format_version, const Slice& compression_dict,
-    CompressionType compression_type, const ImmutableCFOptions &ioptions) {
-  std::unique_ptr<char[]> ubuf;
+    CompressionType compression_type, const ImmutableCFOptions &ioptions,
+    MemoryAllocator* allocator) {
+  CacheAllocationPtr ubuf;
 
   assert(compression_type != kNoCompression && "Invalid compression type");
 
@@ -482,7 +486,7 @@ Status UncompressBlockContentsForCompressionType(
       if (!Snappy_GetUncompressedLength(data, n, &ulength)) {
         return Status::Corruption(snappy_corrupt_msg);
       }
-      ubuf.reset(new char[ulength]);
+      ubuf = AllocateBlock(ulength, allocator);
       if (!Snappy_Uncompress(data, n, ubuf.get())) {
         return Status::Corruption(snappy_corrupt_msg);
       }
@@ -490,10 +494,10 @@ Status UncompressBlockContentsForCompressionType(
       break;
     }
     case kZlibCompression:
-      ubuf.reset(Zlib_Uncompress(
+      ubuf = Zlib_Uncompress(
           data, n, &decompress_size,
           GetCompressFormatForVersion(kZlibCompression, format_version),
-          compression_dict));
+          compression_dict, allocator);
       if (!ubuf) {
         static char zlib_corrupt_msg[] =
           "Zlib not supported or corrupted Zlib compressed block contents";
@@ -503,9 +507,10 @@ Status UncompressBlockContentsForCompressionType(
           BlockContents(std::move(ubuf), decompress_size, true, kNoCompression);
       break;
     case kBZip2Compression:
-      ubuf.reset(BZip2_Uncompress(
+      ubuf = BZip2_Uncompress(
           data, n, &decompress_size,
-          GetCompressFormatForVersion(kBZip2Compression, format_version)));
+          GetCompressFormatForVersion(kBZip2Compression, format_version),
+          allocator);
       if (!ubuf) {
         static char bzip2_corrupt_msg[] =
           "Bzip2 not supported or corrupted Bzip2 compressed block contents";
@@ -515,10 +520,10 @@ Status UncompressBlockContentsForCompressionType(
           BlockContents(std::move(ubuf), decompress_size, true, kNoCompression);
       break;
     case kLZ4Compression:
-      ubuf.reset(LZ4_Uncompress(
+      ubuf = LZ4_Uncompress(
           data, n, &decompress_size,
           GetCompressFormatForVersion(kLZ4Compression, format_version),
-          compression_dict));
+          compression_dict, allocator);
       if (!ubuf) {
         static char lz4_corrupt_msg[] =
           "LZ4 not supported or corrupted LZ4 compressed block contents";
@@ -528,10 +533,10 @@ Status UncompressBlockContentsForCompressionType(
           BlockContents(std::move(ubuf), decompress_size, true, kNoCompression);
       break;
     case kLZ4HCCompression:
-      ubuf.reset(LZ4_Uncompress(
+      ubuf = LZ4_Uncompress(
           data, n, &decompress_size,
           GetCompressFormatForVersion(kLZ4HCCompression, format_version),
-          compression_dict));
+          compression_dict, allocator);
       if (!ubuf) {
         static char lz4hc_corrupt_msg[] =
           "LZ4HC not supported or corrupted LZ4HC compressed block contents";
@@ -541,7 +546,7 @@ Status UncompressBlockContentsForCompressionType(
           BlockContents(std::move(ubuf), decompress_size, true, kNoCompression);
       break;
     case kXpressCompression:
-      ubuf.reset(XPRESS_Uncompress(data, n, &decompress_size));
+      ubuf = XPRESS_Uncompress(data, n, &decompress_size, allocator);
       if (!ubuf) {
         static char xpress_corrupt_msg[] =
           "XPRESS not supported or corrupted XPRESS compressed block contents";
@@ -552,7 +557,8 @@ Status UncompressBlockContentsForCompressionType(
       break;
     case kZSTD:
     case kZSTDNotFinalCompression:
-      ubuf.reset(ZSTD_Uncompress(data, n, &decompress_size, compression_dict));
+      ubuf = ZSTD_Uncompress(data, n, &decompress_size, compression_dict,
+                             allocator);
       if (!ubuf) {
         static char zstd_corrupt_msg[] =
             "ZSTD not supported or corrupted ZSTD compressed block contents";
@@ -585,11 +591,12 @@ Status UncompressBlockContentsForCompressionType(
 Status UncompressBlockContents(const char* data, size_t n,
                                BlockContents* contents, uint32_t format_version,
                                const Slice& compression_dict,
-                               const ImmutableCFOptions &ioptions) {
+                               const ImmutableCFOptions &ioptions,
+                               MemoryAllocator* allocator) {
   assert(data[n] != kNoCompression);
   return UncompressBlockContentsForCompressionType(
       data, n, contents, format_version, compression_dict,
-      (CompressionType)data[n], ioptions);
+      (CompressionType)data[n], ioptions, allocator);
 }
 
 }  // namespace rocksdb
@@ -16,10 +16,12 @@
 #include <string>
 #include <unordered_map>
 
+#include "db/dbformat.h"
 #include "rocksdb/comparator.h"
 #include "table/block_based_table_factory.h"
 #include "table/block_builder.h"
 #include "table/format.h"
+#include "util/coding.h"
 
 namespace rocksdb {
 // The interface for building index.
@@ -99,7 +101,16 @@ class IndexBuilder {
   // Get the estimated size for index block.
   virtual size_t EstimatedSize() const = 0;
 
+  // Returns true if the index block keys are internal keys. From
+  // format_version 3 on they are user keys unless two adjacent data blocks
+  // cannot be told apart by user key alone. Only valid after Finish().
+  virtual bool seperator_is_key_plus_seq() { return true; }
+
  protected:
+  // Whether index blocks get a learned index (see BlockLearnedIndex)
+  static bool UseLearnedIndex(const InternalKeyComparator* comparator,
+                              const BlockBasedTableOptions& table_opt);
+
   const InternalKeyComparator* comparator_;
 };
 
@@ -112,12 +123,27 @@ class IndexBuilder {
 //  2. Shorten the key length for index block. Other than honestly using the
 //     last key in the data block as the index key, we instead find a shortest
 //     substitute key that serves the same function.
+//  3. From format_version 3 on, store only the user key of the separators
+//     when that is enough to tell all data blocks apart, and store only the
+//     change of the block size for entries that are not restart points,
+//     since each data block starts right after the previous one. Both pay
+//     off with an index_block_restart_interval larger than 1.
 class ShortenedIndexBuilder : public IndexBuilder {
  public:
   explicit ShortenedIndexBuilder(const InternalKeyComparator* comparator,
-                                 int index_block_restart_interval)
+                                 int index_block_restart_interval,
+                                 uint32_t format_version = 2,
+                                 bool use_learned_index = false)
       : IndexBuilder(comparator),
-        index_block_builder_(index_block_restart_interval) {}
+        use_value_delta_encoding_(format_version >= 3),
+        index_block_builder_(index_block_restart_interval,
+                             true /* use_delta_encoding */,
+                             use_value_delta_encoding_, use_learned_index),
+        index_block_builder_without_seq_(
+            index_block_restart_interval, true /* use_delta_encoding */,
+            use_value_delta_encoding_, use_learned_index,
+            false /* keys_include_seq */),
+        seperator_is_key_plus_seq_(format_version < 3) {}
 
   virtual void AddIndexEntry(std::string* last_key_in_current_block,
                              const Slice* first_key_in_next_block,
@@ -125,31 +151,74 @@ class ShortenedIndexBuilder : public IndexBuilder {
     if (first_key_in_next_block != nullptr) {
       comparator_->FindShortestSeparator(last_key_in_current_block,
                                          *first_key_in_next_block);
+      if (!seperator_is_key_plus_seq_ &&
+          comparator_->user_comparator()->Compare(
+              ExtractUserKey(*last_key_in_current_block),
+              ExtractUserKey(*first_key_in_next_block)) == 0) {
+        // A user key spans both blocks
+        seperator_is_key_plus_seq_ = true;
+      }
     } else {
       comparator_->FindShortSuccessor(last_key_in_current_block);
     }
 
     std::string handle_encoding;
     block_handle.EncodeTo(&handle_encoding);
-    index_block_builder_.Add(*last_key_in_current_block, handle_encoding);
+    std::string handle_delta_encoding;
+    if (use_value_delta_encoding_) {
+      assert(index_block_builder_.empty() ||
+             block_handle.offset() == last_encoded_handle_.offset() +
+                                          last_encoded_handle_.size() +
+                                          kBlockTrailerSize);
+      PutVarsignedint64(&handle_delta_encoding,
+                        static_cast<int64_t>(block_handle.size()) -
+                            static_cast<int64_t>(last_encoded_handle_.size()));
+      last_encoded_handle_ = block_handle;
+    }
+    const Slice handle_delta_encoding_slice(handle_delta_encoding);
+    index_block_builder_.Add(*last_key_in_current_block, handle_encoding,
+                             &handle_delta_encoding_slice);
+    if (!seperator_is_key_plus_seq_) {
+      index_block_builder_without_seq_.Add(
+          ExtractUserKey(*last_key_in_current_block), handle_encoding,
+          &handle_delta_encoding_slice);
+    }
   }
 
   using IndexBuilder::Finish;
   virtual Status Finish(
       IndexBlocks* index_blocks,
       const BlockHandle& last_partition_block_handle) override {
-    index_blocks->index_block_contents = index_block_builder_.Finish();
+    if (seperator_is_key_plus_seq_) {
+      index_blocks->index_block_contents = index_block_builder_.Finish();
+    } else {
+      index_blocks->index_block_contents =
+          index_block_builder_without_seq_.Finish();
+    }
     return Status::OK();
   }
 
   virtual size_t EstimatedSize() const override {
-    return index_block_builder_.CurrentSizeEstimate();
+    if (seperator_is_key_plus_seq_) {
+      return index_block_builder_.CurrentSizeEstimate();
+    } else {
+      return index_block_builder_without_seq_.CurrentSizeEstimate();
+    }
+  }
+
+  virtual bool seperator_is_key_plus_seq() override {
+    return seperator_is_key_plus_seq_;
   }
 
   friend class PartitionedIndexBuilder;
 
  private:
+  const bool use_value_delta_encoding_;
   BlockBuilder index_block_builder_;
+  // Same entries with user keys, kept while they are unambiguous
+  BlockBuilder index_block_builder_without_seq_;
+  bool seperator_is_key_plus_seq_;
+  BlockHandle last_encoded_handle_ = BlockHandle(0, 0);
 };
 
 // HashIndexBuilder contains a binary-searchable primary index and the
@@ -183,9 +252,12 @@ class HashIndexBuilder : public IndexBuilder {
  public:
   explicit HashIndexBuilder(const InternalKeyComparator* comparator,
                             const SliceTransform* hash_key_extractor,
-                            int index_block_restart_interval)
+                            int index_block_restart_interval,
+                            uint32_t format_version = 2,
+                            bool use_learned_index = false)
       : IndexBuilder(comparator),
-        primary_index_builder_(comparator, index_block_restart_interval),
+        primary_index_builder_(comparator, index_block_restart_interval,
+                               format_version, use_learned_index),
         hash_key_extractor_(hash_key_extractor) {}
 
   virtual void AddIndexEntry(std::string* last_key_in_current_block,
@@ -240,6 +312,10 @@ class HashIndexBuilder : public IndexBuilder {
            prefix_meta_block_.size();
   }
 
+  virtual bool seperator_is_key_plus_seq() override {
+    return primary_index_builder_.seperator_is_key_plus_seq();
+  }
+
  private:
   void FlushPendingPrefix() {
     prefix_block_.append(pending_entry_prefix_.data(),
@@ -301,6 +377,12 @@ class PartitionedIndexBuilder : public IndexBuilder {
   size_t EstimateTopLevelIndexSize(uint64_t) const;
   size_t NumPartitions() const;
 
+  // The partitions share one key format; the top-level index always has
+  // internal keys and full block handles.
+  virtual bool seperator_is_key_plus_seq() override {
+    return seperator_is_key_plus_seq_;
+  }
+
   inline bool ShouldCutFilterBlock() {
     // Current policy is to align the partitions of index and filters
     if (cut_filter_block) {
@@ -338,5 +420,7 @@ class PartitionedIndexBuilder : public IndexBuilder {
   bool partition_cut_requested_ = true;
   // true if it should cut the next filter partition block
   bool cut_filter_block = false;
+  // true if any partition needs internal keys
+  bool seperator_is_key_plus_seq_;
 };
 }  // namespace rocksdb
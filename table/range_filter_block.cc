@@ -0,0 +1,101 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/range_filter_block.h"
+
+#include <algorithm>
+
+#include "db/dbformat.h"
+#include "rocksdb/comparator.h"
+
+namespace rocksdb {
+
+namespace {
+// Truncated keys are short and mostly share prefixes, so restart rarely.
+const int kRangeFilterRestartInterval = 16;
+
+size_t SharedPrefixLength(const Slice& a, const Slice& b) {
+  size_t n = std::min(a.size(), b.size());
+  size_t i = 0;
+  while (i < n && a[i] == b[i]) {
+    i++;
+  }
+  return i;
+}
+}  // namespace
+
+RangeFilterBlockBuilder::RangeFilterBlockBuilder(uint32_t suffix_bytes)
+    : suffix_bytes_(suffix_bytes),
+      block_(kRangeFilterRestartInterval),
+      pending_shared_(0),
+      num_keys_(0) {}
+
+void RangeFilterBlockBuilder::Add(const Slice& user_key) {
+  if (num_keys_ > 0) {
+    if (user_key == Slice(pending_key_)) {
+      return;
+    }
+    assert(BytewiseComparator()->Compare(pending_key_, user_key) < 0);
+    size_t shared = SharedPrefixLength(pending_key_, user_key);
+    EmitPending(shared);
+    pending_shared_ = shared;
+  }
+  pending_key_.assign(user_key.data(), user_key.size());
+  num_keys_++;
+}
+
+void RangeFilterBlockBuilder::EmitPending(size_t next_shared) {
+  // The first byte past both common prefixes distinguishes the key from its
+  // neighbours; keep that and suffix_bytes_ more.
+  size_t len = std::max(pending_shared_, next_shared) + 1 + suffix_bytes_;
+  len = std::min(len, pending_key_.size());
+  block_.Add(Slice(pending_key_.data(), len), Slice());
+}
+
+Slice RangeFilterBlockBuilder::Finish() {
+  if (num_keys_ > 0) {
+    EmitPending(0);
+  }
+  return block_.Finish();
+}
+
+RangeFilterBlockReader::RangeFilterBlockReader(BlockContents&& contents)
+    : block_(new Block(std::move(contents), kDisableGlobalSequenceNumber)) {}
+
+bool RangeFilterBlockReader::RangeMayMatch(const Slice& lo,
+                                           const Slice* hi) const {
+  if (hi != nullptr && lo.compare(*hi) >= 0) {
+    return false;
+  }
+  BlockIter iter;
+  block_->NewIterator(BytewiseComparator(), &iter);
+  if (!iter.status().ok()) {
+    return true;
+  }
+  iter.Seek(lo);
+  if (iter.Valid() && (hi == nullptr || iter.key().compare(*hi) < 0)) {
+    return true;
+  }
+  if (!iter.status().ok()) {
+    return true;
+  }
+  // Only the truncated key right before lo can cover keys >= lo: any
+  // earlier one that is also a prefix of lo must be a complete key.
+  if (iter.Valid()) {
+    iter.Prev();
+  } else {
+    iter.SeekToLast();
+  }
+  if (iter.Valid() && lo.starts_with(iter.key())) {
+    return true;
+  }
+  return !iter.status().ok();
+}
+
+size_t RangeFilterBlockReader::ApproximateMemoryUsage() const {
+  return block_->ApproximateMemoryUsage();
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,79 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+
+#include "rocksdb/slice.h"
+#include "table/block.h"
+#include "table/block_builder.h"
+
+namespace rocksdb {
+
+// A range filter answers "may the table contain a user key in [lo, hi)?"
+// without touching the index or data blocks. It follows the truncation
+// scheme of SuRF (Zhang et al., SIGMOD 2018): every user key is cut down
+// to the shortest prefix that tells it apart from both of its neighbours,
+// plus `suffix_bytes` more bytes of the key. The truncated keys stay sorted
+// and are stored front-coded in a regular block, which shares prefixes the
+// same way a trie does.
+//
+// A query finds the first truncated key t >= lo. The range may be
+// non-empty if t < hi, or if the truncated key just before t is a prefix of
+// lo (a key under it may lie anywhere after lo). Otherwise no key of the
+// table is in the range. False positives come only from truncation.
+//
+// Truncation assumes keys are ordered bytewise, so the filter is only built
+// for tables that use BytewiseComparator().
+class RangeFilterBlockBuilder {
+ public:
+  explicit RangeFilterBlockBuilder(uint32_t suffix_bytes);
+
+  // REQUIRES: user keys are added in ascending order; duplicates are allowed.
+  void Add(const Slice& user_key);
+
+  bool empty() const { return num_keys_ == 0; }
+
+  // Returns the block contents. They stay valid for the lifetime of the
+  // builder.
+  Slice Finish();
+
+ private:
+  void EmitPending(size_t next_shared);
+
+  const uint32_t suffix_bytes_;
+  BlockBuilder block_;
+  std::string pending_key_;
+  // Length of the common prefix of pending_key_ and the key before it
+  size_t pending_shared_;
+  uint64_t num_keys_;
+
+  // No copying allowed
+  RangeFilterBlockBuilder(const RangeFilterBlockBuilder&);
+  void operator=(const RangeFilterBlockBuilder&);
+};
+
+class RangeFilterBlockReader {
+ public:
+  explicit RangeFilterBlockReader(BlockContents&& contents);
+
+  // Returns false only if the table has no user key k with
+  // lo <= k < *hi (or lo <= k if hi is nullptr).
+  bool RangeMayMatch(const Slice& lo, const Slice* hi) const;
+
+  size_t ApproximateMemoryUsage() const;
+
+ private:
+  std::unique_ptr<Block> block_;
+
+  // No copying allowed
+  RangeFilterBlockReader(const RangeFilterBlockReader&);
+  void operator=(const RangeFilterBlockReader&);
+};
+
+}  // namespace rocksdb
@@ -0,0 +1,156 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/range_filter_block.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "util/random.h"
+#include "util/testharness.h"
+#include "util/testutil.h"
+
+namespace rocksdb {
+
+class RangeFilterBlockTest : public testing::Test {
+ public:
+  RangeFilterBlockTest() {}
+
+  void Build(const std::vector<std::string>& keys, uint32_t suffix_bytes = 0) {
+    RangeFilterBlockBuilder builder(suffix_bytes);
+    for (const auto& key : keys) {
+      builder.Add(key);
+    }
+    Slice block = builder.Finish();
+    contents_.assign(block.data(), block.size());
+    BlockContents contents;
+    contents.data = Slice(contents_);
+    contents.cachable = false;
+    reader_.reset(new RangeFilterBlockReader(std::move(contents)));
+  }
+
+  bool Matches(const Slice& lo, const Slice& hi) {
+    return reader_->RangeMayMatch(lo, &hi);
+  }
+
+  bool MatchesFrom(const Slice& lo) {
+    return reader_->RangeMayMatch(lo, nullptr);
+  }
+
+  size_t Size() const { return contents_.size(); }
+
+ private:
+  std::string contents_;
+  std::unique_ptr<RangeFilterBlockReader> reader_;
+};
+
+TEST_F(RangeFilterBlockTest, Empty) {
+  Build({});
+  ASSERT_FALSE(Matches("a", "z"));
+  ASSERT_FALSE(MatchesFrom(""));
+}
+
+TEST_F(RangeFilterBlockTest, SingleKey) {
+  Build({"hello"});
+  ASSERT_TRUE(Matches("hello", "hello0"));
+  ASSERT_TRUE(Matches("a", "z"));
+  ASSERT_TRUE(MatchesFrom(""));
+  // Empty and inverted ranges never match
+  ASSERT_FALSE(Matches("hello", "hello"));
+  ASSERT_FALSE(Matches("z", "a"));
+  // With no neighbours only the first byte is kept, so anything under "h"
+  // may match but nothing outside of it does.
+  ASSERT_TRUE(Matches("hz", "i"));
+  ASSERT_FALSE(Matches("i", "z"));
+  ASSERT_FALSE(Matches("a", "h"));
+}
+
+TEST_F(RangeFilterBlockTest, EmptyRangeBetweenKeys) {
+  Build({"t100", "t200", "t300"});
+  ASSERT_TRUE(Matches("t100", "t101"));
+  ASSERT_TRUE(Matches("t150", "t250"));
+  ASSERT_TRUE(Matches("t000", "t2"));
+  // The keys differ at the second byte after 't', so gaps between the
+  // truncated keys "t1", "t2", "t3" are rejected.
+  ASSERT_FALSE(Matches("t0", "t1"));
+  ASSERT_FALSE(Matches("t4", "u"));
+  ASSERT_FALSE(MatchesFrom("t4"));
+  // Inside a truncated key we cannot tell
+  ASSERT_TRUE(Matches("t150", "t160"));
+}
+
+TEST_F(RangeFilterBlockTest, SuffixBytes) {
+  Build({"t100", "t200", "t300"}, 1);
+  ASSERT_TRUE(Matches("t100", "t101"));
+  ASSERT_TRUE(Matches("t105", "t110"));
+  // One more byte past "t1" tells "t10" apart from "t15"
+  ASSERT_FALSE(Matches("t150", "t160"));
+  ASSERT_FALSE(Matches("t210", "t290"));
+}
+
+TEST_F(RangeFilterBlockTest, KeyIsPrefixOfNext) {
+  Build({"ab", "abc", "abd"});
+  ASSERT_TRUE(Matches("ab", std::string("ab\0", 3)));
+  ASSERT_TRUE(Matches("abc", std::string("abc\0", 4)));
+  ASSERT_TRUE(Matches("abd", "abe"));
+  ASSERT_FALSE(Matches("a", "ab"));
+  ASSERT_FALSE(Matches("abe", "b"));
+}
+
+TEST_F(RangeFilterBlockTest, DuplicateKeys) {
+  Build({"a", "b", "c"});
+  size_t unique_size = Size();
+  Build({"a", "b", "b", "b", "c"});
+  ASSERT_EQ(unique_size, Size());
+  ASSERT_TRUE(Matches("b", std::string("b\0", 2)));
+}
+
+TEST_F(RangeFilterBlockTest, NoFalseNegatives) {
+  Random rnd(301);
+  std::set<std::string> key_set;
+  for (int i = 0; i < 2000; i++) {
+    key_set.insert(test::RandomKey(&rnd, 1 + rnd.Uniform(12)));
+  }
+  std::vector<std::string> keys(key_set.begin(), key_set.end());
+  for (uint32_t suffix_bytes : {0u, 1u, 2u}) {
+    Build(keys, suffix_bytes);
+    int rejected = 0;
+    for (int i = 0; i < 5000; i++) {
+      std::string lo = test::RandomKey(&rnd, 1 + rnd.Uniform(12));
+      std::string hi;
+      if (i % 2 == 0) {
+        hi = test::RandomKey(&rnd, 1 + rnd.Uniform(12));
+        if (hi < lo) {
+          std::swap(lo, hi);
+        }
+      } else {
+        // Narrow ranges are the ones that can be empty
+        hi = lo + test::RandomKey(&rnd, 1 + rnd.Uniform(3));
+      }
+      auto it = key_set.lower_bound(lo);
+      bool present = it != key_set.end() && *it < hi;
+      bool matched = Matches(lo, hi);
+      if (present) {
+        ASSERT_TRUE(matched) << "[" << lo << ", " << hi << ")";
+      } else if (!matched) {
+        rejected++;
+      }
+      if (it != key_set.end()) {
+        ASSERT_TRUE(MatchesFrom(lo));
+      }
+    }
+    fprintf(stderr, "suffix_bytes = %u: %d bytes, %d empty ranges rejected\n",
+            suffix_bytes, static_cast<int>(Size()), rejected);
+    ASSERT_GT(rejected, 0);
+  }
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
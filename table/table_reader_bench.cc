@@ -268,6 +268,14 @@ DEFINE_bool(mmap_read, true, "Whether use mmap read");
 DEFINE_string(table_factory, "block_based",
               "Table factory to use: `block_based` (default), `plain_table` or "
               "`cuckoo_hash`.");
+DEFINE_int32(block_restart_interval, 16,
+             "Block restart interval of block-based tables");
+DEFINE_bool(use_learned_index, false,
+            "Let block-based tables predict restart points with a learned "
+            "index instead of binary-searching all of them");
+DEFINE_bool(fixed_size_keys, false,
+            "Declare the 16-byte keys of the benchmark to block-based tables "
+            "with fixed_key_size, so data blocks have no per-entry headers");
 DEFINE_string(time_unit, "microsecond",
               "The time unit used for measuring performance. User can specify "
               "`microsecond` (default) or `nanosecond`");
@@ -317,7 +325,13 @@ int main(int argc, char** argv) {
     exit(1);
 #endif  // ROCKSDB_LITE
   } else if (FLAGS_table_factory == "block_based") {
-    tf.reset(new rocksdb::BlockBasedTableFactory());
+    rocksdb::BlockBasedTableOptions table_options;
+    table_options.block_restart_interval = FLAGS_block_restart_interval;
+    table_options.use_learned_index = FLAGS_use_learned_index;
+    if (FLAGS_fixed_size_keys) {
+      table_options.fixed_key_size = 16;
+    }
+    tf.reset(new rocksdb::BlockBasedTableFactory(table_options));
   } else {
     fprintf(stderr, "Invalid table type %s\n", FLAGS_table_factory.c_str());
   }
@@ -13,6 +13,7 @@
 #include <iostream>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -636,6 +637,17 @@ static std::vector<TestArgs> GenerateArgList() {
           one_arg.use_mmap = false;
           test_args.push_back(one_arg);
         }
+        if (test_type == BLOCK_BASED_TABLE_TEST) {
+          // Delta-encoded index blocks
+          TestArgs one_arg;
+          one_arg.type = test_type;
+          one_arg.reverse_compare = reverse_compare;
+          one_arg.restart_interval = restart_interval;
+          one_arg.compression = compression_types[0].first;
+          one_arg.format_version = 3;
+          one_arg.use_mmap = false;
+          test_args.push_back(one_arg);
+        }
       }
     }
   }
@@ -2782,9 +2794,17 @@ TEST_F(HarnessTest, FooterTests) {
 
 class IndexBlockRestartIntervalTest
     : public BlockBasedTableTest,
-      public ::testing::WithParamInterface<int> {
+      public ::testing::WithParamInterface<std::pair<int, uint32_t>> {
  public:
-  static std::vector<int> GetRestartValues() { return {-1, 0, 1, 8, 16, 32}; }
+  static std::vector<std::pair<int, uint32_t>> GetRestartValues() {
+    std::vector<std::pair<int, uint32_t>> values;
+    for (int restart_interval : {-1, 0, 1, 8, 16, 32}) {
+      for (uint32_t format_version : {2u, 3u}) {
+        values.push_back({restart_interval, format_version});
+      }
+    }
+    return values;
+  }
 };
 
 INSTANTIATE_TEST_CASE_P(
@@ -2796,12 +2816,13 @@ TEST_P(IndexBlockRestartIntervalTest, IndexBlockRestartInterval) {
   const int kKeySize = 100;
   const int kValSize = 500;
 
-  int index_block_restart_interval = GetParam();
+  int index_block_restart_interval = GetParam().first;
 
   Options options;
   BlockBasedTableOptions table_options;
   table_options.block_size = 64;  // small block size to get big index block
   table_options.index_block_restart_interval = index_block_restart_interval;
+  table_options.format_version = GetParam().second;
   options.table_factory.reset(new BlockBasedTableFactory(table_options));
 
   TableConstructor c(BytewiseComparator());
@@ -2842,6 +2863,138 @@ TEST_P(IndexBlockRestartIntervalTest, IndexBlockRestartInterval) {
   c.ResetTableReader();
 }
 
+TEST_F(BlockBasedTableTest, DeltaEncodedIndex) {
+  Random rnd(301);
+  std::vector<std::string> user_keys;
+  for (int i = 0; i < 1000; i++) {
+    user_keys.push_back(RandomString(&rnd, 16));
+  }
+  std::sort(user_keys.begin(), user_keys.end());
+
+  InternalKeyComparator icomp(BytewiseComparator());
+  // Each user key has two versions, so a user key may span two data blocks
+  // when `spanning` is true.
+  for (bool spanning : {false, true}) {
+    uint64_t index_sizes[2];
+    for (uint32_t format_version : {2u, 3u}) {
+      TableConstructor c(&icomp);
+      for (const auto& user_key : user_keys) {
+        c.Add(InternalKey(user_key, 2, kTypeValue).Encode().ToString(),
+              RandomString(&rnd, 50 + rnd.Uniform(100)));
+        if (spanning) {
+          c.Add(InternalKey(user_key, 1, kTypeValue).Encode().ToString(),
+                RandomString(&rnd, 50 + rnd.Uniform(100)));
+        }
+      }
+
+      Options options;
+      options.compression = kNoCompression;
+      BlockBasedTableOptions table_options;
+      table_options.block_size = 256;
+      table_options.index_block_restart_interval = 16;
+      table_options.format_version = format_version;
+      options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+      std::vector<std::string> keys;
+      stl_wrappers::KVMap kvmap;
+      const ImmutableCFOptions ioptions(options);
+      c.Finish(options, ioptions, table_options, icomp, &keys, &kvmap);
+      auto props = c.GetTableReader()->GetTableProperties();
+      index_sizes[format_version - 2] = props->index_size;
+      ASSERT_EQ(format_version == 3 ? 1U : 0U,
+                props->index_value_is_delta_encoded);
+      ASSERT_EQ(format_version == 3 && !spanning ? 1U : 0U,
+                props->index_key_is_user_key);
+
+      std::unique_ptr<InternalIterator> iter(
+          c.GetTableReader()->NewIterator(ReadOptions()));
+      for (auto& kv : kvmap) {
+        iter->Seek(kv.first);
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(kv.first, iter->key());
+        ASSERT_EQ(kv.second, iter->value());
+      }
+      auto kv_iter = kvmap.rbegin();
+      for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+        ASSERT_EQ(kv_iter->first, iter->key());
+        ASSERT_EQ(kv_iter->second, iter->value());
+        kv_iter++;
+      }
+      ASSERT_TRUE(kv_iter == kvmap.rend());
+      // Seeking to a newer version than any stored lands on the same key
+      for (auto& user_key : user_keys) {
+        iter->Seek(InternalKey(user_key, kMaxSequenceNumber, kTypeValue)
+                       .Encode());
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(user_key, ExtractUserKey(iter->key()));
+      }
+      c.ResetTableReader();
+    }
+    ASSERT_LT(index_sizes[1], index_sizes[0]);
+  }
+}
+
+TEST_F(BlockBasedTableTest, LearnedIndex) {
+  Random rnd(301);
+  InternalKeyComparator icomp(BytewiseComparator());
+  for (auto index_type : {BlockBasedTableOptions::kBinarySearch,
+                          BlockBasedTableOptions::kTwoLevelIndexSearch}) {
+    TableConstructor c(&icomp);
+    std::set<std::string> user_keys;
+    while (user_keys.size() < 5000) {
+      // Fixed-width keys spread uniformly
+      user_keys.insert(RandomString(&rnd, 16));
+    }
+    for (const auto& user_key : user_keys) {
+      c.Add(InternalKey(user_key, 1, kTypeValue).Encode().ToString(),
+            RandomString(&rnd, 20));
+    }
+
+    Options options;
+    options.compression = kNoCompression;
+    BlockBasedTableOptions table_options;
+    table_options.block_restart_interval = 1;
+    table_options.index_type = index_type;
+    table_options.use_learned_index = true;
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+    std::vector<std::string> keys;
+    stl_wrappers::KVMap kvmap;
+    const ImmutableCFOptions ioptions(options);
+    c.Finish(options, ioptions, table_options, icomp, &keys, &kvmap);
+
+    std::unique_ptr<InternalIterator> iter(
+        c.GetTableReader()->NewIterator(ReadOptions()));
+    for (auto& kv : kvmap) {
+      iter->Seek(kv.first);
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(kv.first, iter->key());
+      ASSERT_EQ(kv.second, iter->value());
+    }
+    for (int i = 0; i < 1000; i++) {
+      std::string target = RandomString(&rnd, 1 + rnd.Uniform(20));
+      iter->Seek(InternalKey(target, kMaxSequenceNumber, kTypeValue).Encode());
+      auto expected = user_keys.lower_bound(target);
+      if (expected == user_keys.end()) {
+        ASSERT_FALSE(iter->Valid());
+      } else {
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(*expected, ExtractUserKey(iter->key()));
+      }
+      iter->SeekForPrev(InternalKey(target, 0, kTypeValue).Encode());
+      expected = user_keys.upper_bound(target);
+      if (expected == user_keys.begin()) {
+        ASSERT_FALSE(iter->Valid());
+      } else {
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(*(--expected), ExtractUserKey(iter->key()));
+      }
+    }
+    iter.reset();
+    c.ResetTableReader();
+  }
+}
+
 class PrefixTest : public testing::Test {
  public:
   PrefixTest() : testing::Test() {}
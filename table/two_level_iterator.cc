@@ -112,8 +112,8 @@ TwoLevelIterator::TwoLevelIterator(TwoLevelIteratorState* state,
       pinned_iters_mgr_(nullptr) {}
 
 void TwoLevelIterator::Seek(const Slice& target) {
-  if (state_->check_prefix_may_match &&
-      !state_->PrefixMayMatch(target)) {
+  if ((state_->check_prefix_may_match && !state_->PrefixMayMatch(target)) ||
+      (state_->check_range_may_match && !state_->RangeMayMatch(target))) {
     SetSecondLevelIterator(nullptr);
     return;
   }
@@ -241,7 +241,8 @@ void TwoLevelIterator::InitDataBlock() {
       // second_level_iter is already constructed with this iterator, so
       // no need to change anything
     } else {
-      InternalIterator* iter = state_->NewSecondaryIterator(handle);
+      InternalIterator* iter =
+          state_->NewSecondaryIterator(handle, first_level_iter_.key());
       data_block_handle_.assign(handle.data(), handle.size());
       SetSecondLevelIterator(iter);
     }
@@ -19,16 +19,26 @@ class InternalKeyComparator;
 class Arena;
 
 struct TwoLevelIteratorState {
-  explicit TwoLevelIteratorState(bool _check_prefix_may_match)
-      : check_prefix_may_match(_check_prefix_may_match) {}
+  explicit TwoLevelIteratorState(bool _check_prefix_may_match,
+                                 bool _check_range_may_match = false)
+      : check_prefix_may_match(_check_prefix_may_match),
+        check_range_may_match(_check_range_may_match) {}
 
   virtual ~TwoLevelIteratorState() {}
-  virtual InternalIterator* NewSecondaryIterator(const Slice& handle) = 0;
+  // first_level_key is the key of the first level entry whose value is
+  // handle.
+  virtual InternalIterator* NewSecondaryIterator(
+      const Slice& handle, const Slice& first_level_key) = 0;
   virtual bool PrefixMayMatch(const Slice& internal_key) = 0;
+  // Return false if no key in [internal_key, upper bound) can exist, so a
+  // Seek() to it may leave the iterator invalid. Only called by Seek().
+  virtual bool RangeMayMatch(const Slice& internal_key) { return true; }
   virtual bool KeyReachedUpperBound(const Slice& internal_key) = 0;
 
   // If call PrefixMayMatch()
   bool check_prefix_may_match;
+  // If call RangeMayMatch()
+  bool check_range_may_match;
 };
 
 
@@ -0,0 +1,267 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// block_cache_trace_analyzer reads a trace written by
+// DB::StartBlockCacheTrace(), prints a breakdown of the accesses by block
+// type, caller and level, and simulates cache replacement policies over the
+// trace to print their miss ratio curves, i.e. the miss ratio of each policy
+// at each cache size, all in one pass over the trace.
+//
+//   ./block_cache_trace_analyzer --block_cache_trace_path=/path/to/trace
+//       --cache_sizes=64M,256M,1G --policies=lru,clock
+
+#include <inttypes.h>
+#include <cstdio>
+
+#ifndef GFLAGS
+int main() {
+  fprintf(stderr, "Please install gflags to run rocksdb tools\n");
+  return 1;
+}
+#else
+
+#include <gflags/gflags.h>
+
+#include <ctype.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "rocksdb/env.h"
+#include "rocksdb/trace_reader_writer.h"
+#include "util/block_cache_tracer.h"
+#include "util/string_util.h"
+#include "utilities/simulator_cache/cache_simulator.h"
+
+using GFLAGS::ParseCommandLineFlags;
+using GFLAGS::SetUsageMessage;
+
+DEFINE_string(block_cache_trace_path, "",
+              "The trace file written by DB::StartBlockCacheTrace().");
+DEFINE_string(cache_sizes, "16M,64M,256M,1G,4G",
+              "Comma-separated cache sizes to simulate, in bytes with an "
+              "optional K, M, G or T suffix.");
+DEFINE_string(policies, "lru,clock,fifo,lru_priority",
+              "Comma-separated cache replacement policies to simulate: lru, "
+              "clock, fifo and lru_priority (LRUCache with index and filter "
+              "blocks in its high priority pool).");
+DEFINE_string(mrc_output_path, "",
+              "If set, also write the miss ratio curves to this file as CSV "
+              "lines of policy,cache size,miss ratio.");
+
+namespace rocksdb {
+
+namespace {
+
+bool ParseCacheSize(const std::string& value, uint64_t* size) {
+  Slice input(value);
+  if (!ConsumeDecimalNumber(&input, size)) {
+    return false;
+  }
+  if (input.empty()) {
+    return true;
+  }
+  if (input.size() != 1) {
+    return false;
+  }
+  const std::string suffixes = "KMGT";
+  size_t shift = suffixes.find(static_cast<char>(toupper(input[0])));
+  if (shift == std::string::npos) {
+    return false;
+  }
+  *size <<= 10 * (shift + 1);
+  return true;
+}
+
+const char* BlockTypeName(TraceType type) {
+  switch (type) {
+    case kBlockTraceIndexBlock:
+      return "Index";
+    case kBlockTraceFilterBlock:
+      return "Filter";
+    case kBlockTraceDataBlock:
+      return "Data";
+    default:
+      return "Unknown";
+  }
+}
+
+const char* CallerName(TableReaderCaller caller) {
+  switch (caller) {
+    case kUserGet:
+      return "Get";
+    case kUserIterator:
+      return "Iterator";
+    case kCompaction:
+      return "Compaction";
+    case kFlush:
+      return "Flush";
+    case kPrefetch:
+      return "Prefetch";
+    default:
+      return "Uncategorized";
+  }
+}
+
+// Accesses and hits, as traced
+struct AccessCount {
+  uint64_t accesses = 0;
+  uint64_t hits = 0;
+
+  void Add(bool is_cache_hit) {
+    accesses++;
+    hits += is_cache_hit ? 1 : 0;
+  }
+};
+
+void PrintAccessCounts(const char* title,
+                       const std::map<std::string, AccessCount>& counts,
+                       uint64_t total) {
+  fprintf(stdout, "\nAccesses by %s:\n", title);
+  for (const auto& entry : counts) {
+    const AccessCount& count = entry.second;
+    fprintf(stdout, "  %-14s %12" PRIu64 " (%6.2f%%)  hit ratio %6.2f%%\n",
+            entry.first.c_str(), count.accesses,
+            100.0 * count.accesses / total,
+            100.0 * count.hits / count.accesses);
+  }
+}
+
+}  // namespace
+
+int BlockCacheTraceAnalyzerMain() {
+  if (FLAGS_block_cache_trace_path.empty()) {
+    fprintf(stderr, "--block_cache_trace_path is required\n");
+    return 1;
+  }
+  std::vector<uint64_t> capacities;
+  for (const auto& value : StringSplit(FLAGS_cache_sizes, ',')) {
+    uint64_t capacity = 0;
+    if (!ParseCacheSize(trim(value), &capacity) || capacity == 0) {
+      fprintf(stderr, "Invalid cache size: %s\n", value.c_str());
+      return 1;
+    }
+    capacities.push_back(capacity);
+  }
+  std::vector<std::unique_ptr<MissRatioSimulator>> simulators;
+  for (const auto& policy : StringSplit(FLAGS_policies, ',')) {
+    simulators.push_back(NewMissRatioSimulator(trim(policy), capacities));
+    if (simulators.back() == nullptr) {
+      fprintf(stderr, "Unknown policy: %s\n", policy.c_str());
+      return 1;
+    }
+  }
+  if (capacities.empty() || simulators.empty()) {
+    fprintf(stderr, "--cache_sizes and --policies must not be empty\n");
+    return 1;
+  }
+
+  Env* env = Env::Default();
+  std::unique_ptr<TraceReader> trace_reader;
+  Status s = NewFileTraceReader(env, EnvOptions(), FLAGS_block_cache_trace_path,
+                                &trace_reader);
+  if (!s.ok()) {
+    fprintf(stderr, "Cannot open %s: %s\n",
+            FLAGS_block_cache_trace_path.c_str(), s.ToString().c_str());
+    return 1;
+  }
+  BlockCacheTraceReader reader(std::move(trace_reader));
+  s = reader.ReadHeader();
+
+  uint64_t num_accesses = 0;
+  uint64_t first_timestamp = 0;
+  uint64_t last_timestamp = 0;
+  std::unordered_set<std::string> blocks;
+  uint64_t block_bytes = 0;
+  std::map<std::string, AccessCount> by_type;
+  std::map<std::string, AccessCount> by_caller;
+  std::map<std::string, AccessCount> by_level;
+  while (s.ok()) {
+    BlockCacheTraceRecord access;
+    s = reader.ReadAccess(&access);
+    if (!s.ok()) {
+      break;
+    }
+    if (num_accesses == 0) {
+      first_timestamp = access.access_timestamp;
+    }
+    last_timestamp = access.access_timestamp;
+    num_accesses++;
+    if (blocks.insert(access.block_key).second) {
+      block_bytes += access.block_size;
+    }
+    by_type[BlockTypeName(access.block_type)].Add(access.is_cache_hit);
+    by_caller[CallerName(access.caller)].Add(access.is_cache_hit);
+    by_level[access.level < 0 ? "unknown" : "L" + ToString(access.level)].Add(
+        access.is_cache_hit);
+    for (auto& simulator : simulators) {
+      simulator->Access(access);
+    }
+  }
+  // The end of the trace, or a trace that was not closed cleanly
+  if (!s.IsIncomplete()) {
+    fprintf(stderr, "Cannot read %s: %s\n",
+            FLAGS_block_cache_trace_path.c_str(), s.ToString().c_str());
+    return 1;
+  }
+  if (num_accesses == 0) {
+    fprintf(stdout, "The trace has no block cache accesses\n");
+    return 0;
+  }
+
+  fprintf(stdout, "Accesses: %" PRIu64 " over %.3f seconds\n", num_accesses,
+          (last_timestamp - first_timestamp) / 1000000.0);
+  fprintf(stdout, "Blocks: %" PRIu64 " (%s)\n",
+          static_cast<uint64_t>(blocks.size()),
+          BytesToHumanString(block_bytes).c_str());
+  PrintAccessCounts("block type", by_type, num_accesses);
+  PrintAccessCounts("caller", by_caller, num_accesses);
+  PrintAccessCounts("level", by_level, num_accesses);
+
+  fprintf(stdout, "\nMiss ratios:\n  %-14s", "cache size");
+  for (const auto& simulator : simulators) {
+    fprintf(stdout, " %13s", simulator->Name());
+  }
+  fprintf(stdout, "\n");
+  const std::vector<uint64_t>& sizes = simulators.front()->capacities();
+  for (size_t i = 0; i < sizes.size(); i++) {
+    fprintf(stdout, "  %-14s", BytesToHumanString(sizes[i]).c_str());
+    for (const auto& simulator : simulators) {
+      fprintf(stdout, " %12.2f%%", 100.0 * simulator->miss_ratio(i));
+    }
+    fprintf(stdout, "\n");
+  }
+
+  if (!FLAGS_mrc_output_path.empty()) {
+    std::string csv;
+    for (const auto& simulator : simulators) {
+      for (size_t i = 0; i < sizes.size(); i++) {
+        csv.append(simulator->Name());
+        csv.append("," + ToString(sizes[i]) + ",");
+        csv.append(ToString(simulator->miss_ratio(i)) + "\n");
+      }
+    }
+    s = WriteStringToFile(env, csv, FLAGS_mrc_output_path);
+    if (!s.ok()) {
+      fprintf(stderr, "Cannot write %s: %s\n", FLAGS_mrc_output_path.c_str(),
+              s.ToString().c_str());
+      return 1;
+    }
+  }
+  return 0;
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  SetUsageMessage(std::string("\nUSAGE:\n") + std::string(argv[0]) +
+                  " --block_cache_trace_path=<path> [OPTIONS]...");
+  ParseCommandLineFlags(&argc, &argv, true);
+  return rocksdb::BlockCacheTraceAnalyzerMain();
+}
+
+#endif  // GFLAGS
@@ -0,0 +1,403 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// compaction_replay simulates the flushes and compactions of a column family
+// with CompactionSimulator, to compare LSM options without loading data. The
+// LSM tree starts empty, fully compacted, or as the one in the MANIFEST of
+// --db:
+//
+//   ./compaction_replay --ingest_mb_per_sec=32 --duration_sec=3600
+//       --cf_options="level0_file_num_compaction_trigger=8"
+//
+// With --execute_compaction, it runs the first compaction picked for the
+// files of --db on the DB, and compares its output with the modeled one.
+
+#include <inttypes.h>
+#include <cstdio>
+
+#ifndef GFLAGS
+int main() {
+  fprintf(stderr, "Please install gflags to run rocksdb tools\n");
+  return 1;
+}
+#elif defined(ROCKSDB_LITE)
+int main() {
+  fprintf(stderr, "compaction_replay is not supported in ROCKSDB_LITE\n");
+  return 1;
+}
+#else
+
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <ctime>
+#include <limits>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "db/version_set.h"
+#include "db/write_controller.h"
+#include "options/options_parser.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/comparator.h"
+#include "rocksdb/convenience.h"
+#include "rocksdb/db.h"
+#include "rocksdb/env.h"
+#include "rocksdb/iostats_context.h"
+#include "rocksdb/options.h"
+#include "rocksdb/perf_level.h"
+#include "rocksdb/statistics.h"
+#include "rocksdb/utilities/options_util.h"
+#include "rocksdb/write_buffer_manager.h"
+#include "util/filename.h"
+#include "util/string_util.h"
+#include "utilities/simulator_compaction/compaction_simulator.h"
+
+using GFLAGS::ParseCommandLineFlags;
+using GFLAGS::SetUsageMessage;
+
+DEFINE_string(db, "",
+              "A DB to start from the LSM tree of, as in its MANIFEST. The "
+              "DB is not modified unless --execute_compaction.");
+DEFINE_string(column_family, rocksdb::kDefaultColumnFamilyName,
+              "The column family of --db to simulate.");
+DEFINE_string(options_file, "",
+              "An OPTIONS file to read the options from. By default, the "
+              "latest OPTIONS file of --db, if any.");
+DEFINE_string(db_options, "",
+              "DB options to set, e.g. \"delayed_write_rate=8388608\".");
+DEFINE_string(cf_options, "",
+              "Column family options to set, e.g. "
+              "\"compaction_style=kCompactionStyleUniversal;"
+              "write_buffer_size=67108864\".");
+DEFINE_string(initial_state, "empty",
+              "The LSM tree without --db: \"empty\", or \"compacted\" for "
+              "all the keys in the last level.");
+DEFINE_double(ingest_mb_per_sec, 16, "MB per second written by the users.");
+DEFINE_uint64(entry_size, 1024, "The size of a key and its value.");
+DEFINE_uint64(num_keys, 10 << 20,
+              "The number of distinct keys, written uniformly.");
+DEFINE_double(flush_mb_per_sec, 256, "MB per second written by a flush.");
+DEFINE_double(compaction_mb_per_sec, 128,
+              "MB per second read and written by a compaction.");
+DEFINE_uint64(duration_sec, 600, "The simulated time.");
+DEFINE_uint64(step_ms, 10, "The simulated time between two steps.");
+DEFINE_bool(execute_compaction, false,
+            "Run the first compaction picked for the LSM tree of --db on "
+            "the DB, instead of simulating.");
+
+namespace rocksdb {
+
+namespace {
+
+uint64_t MBToBytes(double mb) {
+  return static_cast<uint64_t>(mb * 1024 * 1024);
+}
+
+// Loads the options of the column family to simulate into options, and the
+// options of each column family of --db into column_families
+Status LoadOptions(Options* options,
+                   std::vector<ColumnFamilyDescriptor>* column_families) {
+  Env* env = Env::Default();
+  DBOptions db_options;
+  std::vector<ColumnFamilyDescriptor> cf_descs;
+  Status s;
+  std::string options_file = FLAGS_options_file;
+  if (options_file.empty() && !FLAGS_db.empty()) {
+    s = GetLatestOptionsFileName(FLAGS_db, env, &options_file);
+    if (s.ok()) {
+      options_file = FLAGS_db + "/" + options_file;
+    } else if (s.IsNotFound()) {
+      // An old DB, the options are the defaults
+      s = Status::OK();
+    }
+  }
+  if (!s.ok()) {
+    return s;
+  }
+  if (!options_file.empty()) {
+    // As LoadOptionsFromFile(), but also restores the built-in comparators,
+    // which the recovery of the column families checks
+    RocksDBOptionsParser parser;
+    s = parser.Parse(options_file, env);
+    if (!s.ok()) {
+      return s;
+    }
+    db_options = *parser.db_opt();
+    for (size_t i = 0; i < parser.cf_opts()->size(); i++) {
+      cf_descs.emplace_back((*parser.cf_names())[i], (*parser.cf_opts())[i]);
+      const auto& opt_map = (*parser.cf_opt_maps())[i];
+      auto comparator = opt_map.find("comparator");
+      if (comparator != opt_map.end() &&
+          comparator->second == ReverseBytewiseComparator()->Name()) {
+        cf_descs.back().options.comparator = ReverseBytewiseComparator();
+      }
+    }
+  }
+  ColumnFamilyOptions cf_options;
+  for (const auto& cf_desc : cf_descs) {
+    if (cf_desc.name == FLAGS_column_family) {
+      cf_options = cf_desc.options;
+    }
+  }
+  s = GetDBOptionsFromString(db_options, FLAGS_db_options, &db_options);
+  if (s.ok()) {
+    s = GetColumnFamilyOptionsFromString(cf_options, FLAGS_cf_options,
+                                         &cf_options);
+  }
+  if (!s.ok()) {
+    return s;
+  }
+  *options = Options(db_options, cf_options);
+
+  column_families->clear();
+  if (FLAGS_db.empty()) {
+    return Status::OK();
+  }
+  std::vector<std::string> names;
+  s = DB::ListColumnFamilies(db_options, FLAGS_db, &names);
+  if (!s.ok()) {
+    return s;
+  }
+  if (std::find(names.begin(), names.end(), FLAGS_column_family) ==
+      names.end()) {
+    return Status::InvalidArgument("No column family " + FLAGS_column_family);
+  }
+  // The other column families keep their own options, a different
+  // comparator would fail the recovery
+  for (const auto& name : names) {
+    ColumnFamilyOptions family_options;
+    if (name == FLAGS_column_family) {
+      family_options = cf_options;
+    } else {
+      for (const auto& cf_desc : cf_descs) {
+        if (cf_desc.name == name) {
+          family_options = cf_desc.options;
+        }
+      }
+    }
+    column_families->emplace_back(name, family_options);
+  }
+  return Status::OK();
+}
+
+// Reads the files of the column family from the MANIFEST of --db
+Status ReadLiveFiles(const Options& options,
+                     const std::vector<ColumnFamilyDescriptor>& column_families,
+                     std::vector<LiveFileMetaData>* files) {
+  Options db_options = options;
+  // Only the file metadata is needed
+  db_options.skip_stats_update_on_db_open = true;
+  if (db_options.db_paths.empty()) {
+    // As sanitized by DB::Open()
+    db_options.db_paths.emplace_back(FLAGS_db,
+                                     std::numeric_limits<uint64_t>::max());
+  }
+  ImmutableDBOptions immutable_db_options(db_options);
+  EnvOptions env_options;
+  std::shared_ptr<Cache> table_cache(
+      NewLRUCache(1000, db_options.table_cache_numshardbits));
+  WriteController write_controller(db_options.delayed_write_rate);
+  WriteBufferManager write_buffer_manager(db_options.db_write_buffer_size);
+  VersionSet versions(FLAGS_db, &immutable_db_options, env_options,
+                      table_cache.get(), &write_buffer_manager,
+                      &write_controller);
+  // read_only, the MANIFEST is not modified
+  Status s = versions.Recover(column_families, true /* read_only */);
+  if (!s.ok()) {
+    return s;
+  }
+  std::vector<LiveFileMetaData> all_files;
+  versions.GetLiveFilesMetaData(&all_files);
+  files->clear();
+  for (const auto& file : all_files) {
+    if (file.column_family_name == FLAGS_column_family) {
+      files->push_back(file);
+    }
+  }
+  return Status::OK();
+}
+
+void PrintCompaction(const SimulatedCompaction& compaction) {
+  fprintf(stdout, "Compaction to L%d of %" PRIu64 " files, %s:",
+          compaction.output_level,
+          static_cast<uint64_t>(compaction.input_file_numbers.size()),
+          BytesToHumanString(compaction.input_bytes).c_str());
+  for (uint64_t file_number : compaction.input_file_numbers) {
+    fprintf(stdout, " %" PRIu64, file_number);
+  }
+  fprintf(stdout, "\n  modeled output: %s\n",
+          BytesToHumanString(compaction.output_bytes).c_str());
+}
+
+// The names of the table files of a column family
+std::set<std::string> TableFileNames(DB* db, ColumnFamilyHandle* cf) {
+  ColumnFamilyMetaData cf_meta;
+  db->GetColumnFamilyMetaData(cf, &cf_meta);
+  std::set<std::string> names;
+  for (const auto& level : cf_meta.levels) {
+    for (const auto& file : level.files) {
+      names.insert(file.name);
+    }
+  }
+  return names;
+}
+
+// Runs the compaction on --db and prints its stats. CompactFiles() runs the
+// compaction in the calling thread, so its I/O time is in the IOStatsContext
+// of this thread.
+int ExecuteCompaction(DBOptions options,
+                      std::vector<ColumnFamilyDescriptor> cf_descs,
+                      const SimulatedCompaction& compaction) {
+  options.statistics = CreateDBStatistics();
+  size_t cf_index = 0;
+  for (size_t i = 0; i < cf_descs.size(); i++) {
+    if (cf_descs[i].name == FLAGS_column_family) {
+      cf_index = i;
+    }
+    cf_descs[i].options.disable_auto_compactions = true;
+  }
+  std::vector<ColumnFamilyHandle*> handles;
+  DB* db;
+  Status s = DB::Open(options, FLAGS_db, cf_descs, &handles, &db);
+  if (!s.ok()) {
+    fprintf(stderr, "Cannot open %s: %s\n", FLAGS_db.c_str(),
+            s.ToString().c_str());
+    return 1;
+  }
+  ColumnFamilyHandle* cf = handles[cf_index];
+
+  std::vector<std::string> input_file_names;
+  for (uint64_t file_number : compaction.input_file_numbers) {
+    input_file_names.push_back(MakeTableFileName("", file_number));
+  }
+  CompactionOptions compact_options;
+  compact_options.compression = cf_descs[cf_index].options.compression;
+  compact_options.output_file_size_limit = compaction.max_output_file_size;
+  const std::set<std::string> files_before = TableFileNames(db, cf);
+
+  Env* env = Env::Default();
+  SetPerfLevel(kEnableTimeExceptForMutex);
+  get_iostats_context()->Reset();
+  uint64_t start_micros = env->NowMicros();
+  std::clock_t start_cpu = std::clock();
+  s = db->CompactFiles(compact_options, cf, input_file_names,
+                       compaction.output_level);
+  uint64_t elapsed_micros = env->NowMicros() - start_micros;
+  double cpu_micros =
+      1000000.0 * (std::clock() - start_cpu) / CLOCKS_PER_SEC;
+  const IOStatsContext io_stats = *get_iostats_context();
+  SetPerfLevel(kDisable);
+
+  uint64_t num_output_files = 0;
+  uint64_t output_bytes = 0;
+  if (s.ok()) {
+    ColumnFamilyMetaData cf_meta;
+    db->GetColumnFamilyMetaData(cf, &cf_meta);
+    for (const auto& file : cf_meta.levels[compaction.output_level].files) {
+      if (files_before.count(file.name) == 0) {
+        num_output_files++;
+        output_bytes += file.size;
+      }
+    }
+  }
+  for (auto handle : handles) {
+    delete handle;
+  }
+  delete db;
+  if (!s.ok()) {
+    fprintf(stderr, "Compaction failed: %s\n", s.ToString().c_str());
+    return 1;
+  }
+
+  fprintf(stdout, "Executed in %.3f seconds, %.3f seconds of CPU\n",
+          elapsed_micros / 1000000.0, cpu_micros / 1000000.0);
+  fprintf(stdout, "  input: %s, read in %.3f seconds\n",
+          BytesToHumanString(
+              options.statistics->getTickerCount(COMPACT_READ_BYTES))
+              .c_str(),
+          io_stats.read_nanos / 1e9);
+  fprintf(stdout, "  output: %s in %" PRIu64
+                  " files, written in %.3f seconds\n",
+          BytesToHumanString(output_bytes).c_str(), num_output_files,
+          io_stats.write_nanos / 1e9);
+  if (output_bytes > 0) {
+    fprintf(stdout, "  modeled / actual output: %.3f\n",
+            static_cast<double>(compaction.output_bytes) / output_bytes);
+  }
+  return 0;
+}
+
+}  // namespace
+
+int CompactionReplayMain() {
+  if (FLAGS_execute_compaction && FLAGS_db.empty()) {
+    fprintf(stderr, "--execute_compaction requires --db\n");
+    return 1;
+  }
+  if (FLAGS_initial_state != "empty" && FLAGS_initial_state != "compacted") {
+    fprintf(stderr, "Unknown --initial_state %s\n",
+            FLAGS_initial_state.c_str());
+    return 1;
+  }
+  Options options;
+  std::vector<ColumnFamilyDescriptor> column_families;
+  Status s = LoadOptions(&options, &column_families);
+  if (!s.ok()) {
+    fprintf(stderr, "Cannot load the options: %s\n", s.ToString().c_str());
+    return 1;
+  }
+
+  CompactionSimulatorOptions sim_options;
+  sim_options.ingest_bytes_per_sec = MBToBytes(FLAGS_ingest_mb_per_sec);
+  sim_options.entry_size = FLAGS_entry_size;
+  sim_options.num_keys = FLAGS_num_keys;
+  sim_options.flush_bytes_per_sec = MBToBytes(FLAGS_flush_mb_per_sec);
+  sim_options.compaction_bytes_per_sec = MBToBytes(FLAGS_compaction_mb_per_sec);
+  sim_options.step_micros = FLAGS_step_ms * 1000;
+  CompactionSimulator simulator(options, sim_options);
+
+  if (!FLAGS_db.empty()) {
+    std::vector<LiveFileMetaData> files;
+    s = ReadLiveFiles(options, column_families, &files);
+    if (!s.ok()) {
+      fprintf(stderr, "Cannot read the MANIFEST of %s: %s\n",
+              FLAGS_db.c_str(), s.ToString().c_str());
+      return 1;
+    }
+    fprintf(stdout, "Read %" PRIu64 " files of column family %s\n",
+            static_cast<uint64_t>(files.size()), FLAGS_column_family.c_str());
+    simulator.AddFiles(files);
+  } else if (FLAGS_initial_state == "compacted") {
+    simulator.AddAllKeys(options.num_levels - 1);
+  }
+
+  if (FLAGS_execute_compaction) {
+    SimulatedCompaction compaction;
+    if (!simulator.PickFirstCompaction(&compaction)) {
+      fprintf(stdout, "No compaction is needed\n");
+      return 0;
+    }
+    PrintCompaction(compaction);
+    return ExecuteCompaction(options, column_families, compaction);
+  }
+
+  simulator.Run(FLAGS_duration_sec * 1000000);
+  fprintf(stdout, "%s", simulator.stats().ToString().c_str());
+  return 0;
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  SetUsageMessage(std::string("\nUSAGE:\n") + std::string(argv[0]) +
+                  " [--db=<path>] [OPTIONS]...");
+  ParseCommandLineFlags(&argc, &argv, true);
+  return rocksdb::CompactionReplayMain();
+}
+
+#endif  // GFLAGS
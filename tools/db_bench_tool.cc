@@ -25,7 +25,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/types.h>
+#include <array>
 #include <atomic>
+#include <cmath>
 #include <condition_variable>
 #include <cstddef>
 #include <memory>
@@ -44,6 +46,7 @@
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
 #include "rocksdb/filter_policy.h"
+#include "rocksdb/memory_allocator.h"
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/options.h"
 #include "rocksdb/perf_context.h"
@@ -51,6 +54,7 @@
 #include "rocksdb/rate_limiter.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/slice_transform.h"
+#include "rocksdb/threadpool.h"
 #include "rocksdb/utilities/object_registry.h"
 #include "rocksdb/utilities/optimistic_transaction_db.h"
 #include "rocksdb/utilities/options_util.h"
@@ -61,6 +65,8 @@
 #include "util/cast_util.h"
 #include "util/compression.h"
 #include "util/crc32c.h"
+#include "util/event_logger.h"
+#include "util/hash.h"
 #include "util/mutexlock.h"
 #include "util/random.h"
 #include "util/stderr_logger.h"
@@ -175,7 +181,17 @@ DEFINE_string(
     "\trandomreplacekeys     -- randomly replaces N keys by deleting "
     "the old version and putting the new version\n\n"
     "\ttimeseries            -- 1 writer generates time series data "
-    "and multiple readers doing random reads on id\n\n"
+    "and multiple readers doing random reads on id\n"
+    "\tmixrandom     -- N threads doing random Gets, Puts and Seeks in the "
+    "ratios of --mix_get_ratio, --mix_put_ratio and --mix_seek_ratio\n"
+    "\tycsba         -- YCSB workload A: 50% reads, 50% updates\n"
+    "\tycsbb         -- YCSB workload B: 95% reads, 5% updates\n"
+    "\tycsbc         -- YCSB workload C: 100% reads\n"
+    "\tycsbd         -- YCSB workload D: 95% reads of the latest keys, "
+    "5% inserts\n"
+    "\tycsbe         -- YCSB workload E: 95% short scans, 5% inserts\n"
+    "\tycsbf         -- YCSB workload F: 50% reads, 50% "
+    "read-modify-writes\n\n"
     "Meta operations:\n"
     "\tcompact     -- Compact the entire DB; If multiple, randomly choose one\n"
     "\tcompactall  -- Compact the entire DB\n"
@@ -183,6 +199,8 @@ DEFINE_string(
     "\tresetstats  -- Reset DB stats\n"
     "\tlevelstats  -- Print the number of files and bytes per level\n"
     "\tsstables    -- Print sstable info\n"
+    "\tfilterstats -- Print filter memory and observed false positive "
+    "rate\n"
     "\theapprofile -- Dump a heap profile (if supported by this"
     " port)\n");
 
@@ -235,8 +253,8 @@ DEFINE_int32(value_size, 100, "Size of each value");
 
 DEFINE_int32(seek_nexts, 0,
              "How many times to call Next() after Seek() in "
-             "fillseekseq, seekrandom, seekrandomwhilewriting and "
-             "seekrandomwhilemerging");
+             "fillseekseq, seekrandom, seekrandomwhilewriting, "
+             "seekrandomwhilemerging and mixrandom");
 
 DEFINE_bool(reverse_iterator, false,
             "When true use Prev rather than Next for iterators that do "
@@ -273,6 +291,56 @@ DEFINE_double(read_random_exp_range, 0.0,
               "The larger the number is, the more skewed the reads are. "
               "Only used in readrandom and multireadrandom benchmarks.");
 
+DEFINE_string(key_dist, "",
+              "Distribution of the keys of readrandom, multireadrandom, "
+              "mixrandom and the ycsb benchmarks: uniform, zipfian or "
+              "hotspot. Empty means uniform, except for the ycsb benchmarks "
+              "which default to zipfian like YCSB does.");
+
+DEFINE_double(zipf_theta, 0.99,
+              "Skew of --key_dist=zipfian, in (0, 1). Key rank i is chosen "
+              "with probability proportional to 1 / i^zipf_theta, and the "
+              "ranks are scattered over the key space.");
+
+DEFINE_double(hot_key_fraction, 0.2,
+              "Fraction of the keys, the first ones, that are hot with "
+              "--key_dist=hotspot");
+
+DEFINE_double(hot_op_fraction, 0.8,
+              "Fraction of the operations that go to the hot keys with "
+              "--key_dist=hotspot");
+
+DEFINE_int32(key_size_max, 0,
+             "If larger than --key_size, the keys are between key_size and "
+             "key_size_max bytes long. The length of a key is derived from "
+             "the key, so that it is the same for all its reads and writes.");
+
+DEFINE_string(value_size_dist, "fixed",
+              "Distribution of the sizes of the values written by the fill, "
+              "overwrite, mixrandom and ycsb benchmarks: fixed "
+              "(--value_size), uniform (between --value_size_min and "
+              "--value_size_max) or normal (centered between value_size_min "
+              "and value_size_max, with a standard deviation of a sixth of "
+              "their difference, and clipped to them).");
+
+DEFINE_int32(value_size_min, 10, "Smallest value size with --value_size_dist");
+
+DEFINE_int32(value_size_max, 1000, "Largest value size with --value_size_dist");
+
+DEFINE_int32(ycsb_max_scan_length, 100,
+             "Each scan of ycsbe reads a uniform number of keys between 1 "
+             "and this");
+
+DEFINE_double(mix_get_ratio, 0.8,
+              "Share of the operations of mixrandom that are Gets");
+
+DEFINE_double(mix_put_ratio, 0.15,
+              "Share of the operations of mixrandom that are Puts");
+
+DEFINE_double(mix_seek_ratio, 0.05,
+              "Share of the operations of mixrandom that are Seeks, each "
+              "followed by --seek_nexts Next()s");
+
 DEFINE_bool(histogram, false, "Print histogram of operation timings");
 
 DEFINE_bool(enable_numa, false,
@@ -402,6 +470,21 @@ DEFINE_double(cache_high_pri_pool_ratio, 0.0,
 DEFINE_bool(use_clock_cache, false,
             "Replace default LRU block cache with clock cache.");
 
+DEFINE_bool(use_pooled_allocator, false,
+            "Allocate the blocks of the LRU block caches with "
+            "NewPooledMemoryAllocator().");
+
+DEFINE_bool(pooled_allocator_use_thp, false,
+            "Back the pooled allocator with transparent huge pages.");
+
+DEFINE_double(cache_compressed_tier_ratio, 0.0,
+              "If > 0.0, the LRU block cache keeps the blocks it evicts in a "
+              "compressed tier that starts with this fraction of cache_size.");
+
+DEFINE_bool(cache_compressed_tier_adaptive, true,
+            "Adapt the split between the block cache and its compressed "
+            "tier to how often blocks come back from the compressed tier.");
+
 DEFINE_int64(simcache_size, -1,
              "Number of bytes to use as a simcache of "
              "uncompressed data. Nagative value disables simcache.");
@@ -462,6 +545,10 @@ DEFINE_bool(new_table_reader_for_compaction_inputs, true,
 
 DEFINE_int32(compaction_readahead_size, 0, "Compaction readahead size");
 
+DEFINE_int32(compaction_readahead_threads, 1,
+             "Threads reading compaction inputs ahead, shared by all "
+             "compactions");
+
 DEFINE_int32(random_access_max_buffer_size, 1024 * 1024,
              "Maximum windows randomaccess buffer size");
 
@@ -470,6 +557,12 @@ DEFINE_int32(writable_file_max_buffer_size, 1024 * 1024,
 
 DEFINE_int32(bloom_bits, -1, "Bloom filter bits per key. Negative means"
              " use default settings.");
+DEFINE_string(filter_type, "bloom", "Filter policy used when --bloom_bits is "
+              "set: bloom or xor");
+static std::vector<int> FLAGS_filter_bits_per_level_v;
+DEFINE_string(filter_bits_per_level, "", "Comma-separated bits per key for "
+              "each level with --filter_type=xor; deeper levels use the last "
+              "value");
 DEFINE_double(memtable_bloom_size_ratio, 0,
               "Ratio of memtable size used for bloom filter. 0 means no bloom "
               "filter.");
@@ -768,12 +861,20 @@ DEFINE_int32(stats_per_interval, 0, "Reports additional stats per interval when"
 
 DEFINE_int64(report_interval_seconds, 0,
              "If greater than zero, it will write simple stats in CVS format "
-             "to --report_file every N seconds");
+             "to --report_file every N seconds, and the latency percentiles "
+             "of each operation type in each interval to --json_report_file");
 
 DEFINE_string(report_file, "report.csv",
               "Filename where some simple stats are reported to (if "
               "--report_interval_seconds is bigger than 0)");
 
+DEFINE_string(json_report_file, "",
+              "If set, write a JSON report to this file at the end: the "
+              "flags, and for each benchmark run its throughput, the latency "
+              "percentiles of each operation type, their series over the "
+              "intervals of --report_interval_seconds, and the compaction "
+              "stats of the DB");
+
 DEFINE_int32(thread_status_per_interval, 0,
              "Takes and report a snapshot of the current status of each thread"
              " when this is greater than 0.");
@@ -877,6 +978,31 @@ static auto FLAGS_compaction_fadvice_e =
 DEFINE_bool(use_tailing_iterator, false,
             "Use tailing iterator to access a series of keys instead of get");
 
+DEFINE_int32(decompression_readahead_blocks, 0,
+             "If non-zero, iterators of readseq and seekrandom read and "
+             "decompress this many data blocks ahead on background "
+             "threads (ReadOptions::decompression_readahead_blocks)");
+
+DEFINE_int32(decompression_threads, 4,
+             "Number of threads for --decompression_readahead_blocks");
+
+DEFINE_string(trace_file, "",
+              "If not empty, record the operations of the benchmarks on the "
+              "DB in this trace file (DB::StartTrace()). Replay it with "
+              "db_replay. A benchmark that recreates the DB ends the trace.");
+
+DEFINE_int32(trace_sampling_frequency, 1,
+             "Record one in every this many operations in --trace_file");
+
+DEFINE_string(block_cache_trace_file, "",
+              "If not empty, record the block cache lookups of the benchmarks "
+              "in this trace file (DB::StartBlockCacheTrace()). Analyze it "
+              "with block_cache_trace_analyzer.");
+
+DEFINE_int32(block_cache_trace_sampling_frequency, 1,
+             "Record the lookups of one in every this many blocks in "
+             "--block_cache_trace_file");
+
 DEFINE_bool(use_adaptive_mutex, rocksdb::Options().use_adaptive_mutex,
             "Use adaptive mutex");
 
@@ -968,6 +1094,50 @@ static enum RepFactory StringToRepFactory(const char* ctype) {
 }
 
 static enum RepFactory FLAGS_rep_factory;
+
+enum KeyDistribution : unsigned char {
+  kUniformKeys,
+  kZipfianKeys,
+  kHotspotKeys,
+};
+
+static bool StringToKeyDistribution(const char* ctype,
+                                    enum KeyDistribution* dist) {
+  assert(ctype);
+
+  if (!strcasecmp(ctype, "uniform")) {
+    *dist = kUniformKeys;
+  } else if (!strcasecmp(ctype, "zipfian")) {
+    *dist = kZipfianKeys;
+  } else if (!strcasecmp(ctype, "hotspot")) {
+    *dist = kHotspotKeys;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+enum SizeDistribution : unsigned char {
+  kFixedSize,
+  kUniformSize,
+  kNormalSize,
+};
+
+static enum SizeDistribution StringToSizeDistribution(const char* ctype) {
+  assert(ctype);
+
+  if (!strcasecmp(ctype, "fixed"))
+    return kFixedSize;
+  else if (!strcasecmp(ctype, "uniform"))
+    return kUniformSize;
+  else if (!strcasecmp(ctype, "normal"))
+    return kNormalSize;
+
+  fprintf(stdout, "Cannot parse size distribution %s\n", ctype);
+  return kFixedSize;
+}
+
+static enum SizeDistribution FLAGS_value_size_dist_e = kFixedSize;
 DEFINE_string(memtablerep, "skip_list", "");
 DEFINE_int64(hash_bucket_count, 1024 * 1024, "hash bucket count");
 DEFINE_bool(use_plain_table, false, "if use plain table "
@@ -1159,7 +1329,11 @@ class RandomGenerator {
     // large enough to serve all typical value sizes we want to write.
     Random rnd(301);
     std::string piece;
-    while (data_.size() < (unsigned)std::max(1048576, FLAGS_value_size)) {
+    int max_value_size = FLAGS_value_size;
+    if (FLAGS_value_size_dist_e != kFixedSize) {
+      max_value_size = std::max(max_value_size, FLAGS_value_size_max);
+    }
+    while (data_.size() < (unsigned)std::max(1048576, max_value_size)) {
       // Add a short fragment that is as compressible as specified
       // by FLAGS_compression_ratio.
       test::CompressibleString(&rnd, FLAGS_compression_ratio, 100, &piece);
@@ -1187,6 +1361,66 @@ class RandomGenerator {
   }
 };
 
+// Draws ranks in [0, n) where rank i has a probability proportional to
+// 1 / (i + 1)^theta, with the method of Gray et al., "Quickly Generating
+// Billion-Record Synthetic Databases", as YCSB does. Thread-safe; the caller
+// provides the randomness.
+class ZipfianGenerator {
+ public:
+  // REQUIRES: n > 0, 0 < theta < 1
+  ZipfianGenerator(uint64_t n, double theta)
+      : n_(n),
+        theta_(theta),
+        alpha_(1.0 / (1.0 - theta)),
+        zetan_(Zeta(n, theta)),
+        eta_((1.0 - std::pow(2.0 / n, 1.0 - theta)) /
+             (1.0 - Zeta(2, theta) / zetan_)) {}
+
+  uint64_t Next(Random64* rand) const {
+    double u = UniformDouble(rand);
+    double uz = u * zetan_;
+    if (uz < 1.0) {
+      return 0;
+    }
+    if (uz < 1.0 + std::pow(0.5, theta_)) {
+      return 1;
+    }
+    uint64_t rank = static_cast<uint64_t>(
+        n_ * std::pow(eta_ * u - eta_ + 1.0, alpha_));
+    return std::min(rank, n_ - 1);
+  }
+
+  // In [0, 1)
+  static double UniformDouble(Random64* rand) {
+    return static_cast<double>(rand->Next() >> 11) / (uint64_t{1} << 53);
+  }
+
+ private:
+  // The sum of 1 / i^theta for i in [1, n]. The terms past the first
+  // million are approximated by an integral, so that billions of keys do not
+  // delay the start of the benchmark.
+  static double Zeta(uint64_t n, double theta) {
+    const uint64_t kExactTerms = 1 << 20;
+    uint64_t exact_terms = std::min(n, kExactTerms);
+    double sum = 0;
+    for (uint64_t i = 1; i <= exact_terms; i++) {
+      sum += 1.0 / std::pow(static_cast<double>(i), theta);
+    }
+    if (n > exact_terms) {
+      sum += (std::pow(n + 0.5, 1.0 - theta) -
+              std::pow(exact_terms + 0.5, 1.0 - theta)) /
+             (1.0 - theta);
+    }
+    return sum;
+  }
+
+  const uint64_t n_;
+  const double theta_;
+  const double alpha_;
+  const double zetan_;
+  const double eta_;
+};
+
 static void AppendWithSpace(std::string* str, Slice msg) {
   if (msg.empty()) return;
   if (!str->empty()) {
@@ -1291,16 +1525,77 @@ struct DBWithColumnFamilies {
   }
 };
 
+enum OperationType : unsigned char {
+  kRead = 0,
+  kWrite,
+  kDelete,
+  kSeek,
+  kMerge,
+  kUpdate,
+  kCompress,
+  kUncompress,
+  kCrc,
+  kHash,
+  kOthers
+};
+
+static std::unordered_map<OperationType, std::string, std::hash<unsigned char>>
+                          OperationTypeString = {
+  {kRead, "read"},
+  {kWrite, "write"},
+  {kDelete, "delete"},
+  {kSeek, "seek"},
+  {kMerge, "merge"},
+  {kUpdate, "update"},
+  {kCompress, "compress"},
+  {kUncompress, "uncompress"},
+  {kCrc, "crc"},
+  {kHash, "hash"},
+  {kOthers, "op"}
+};
+
+// The latency percentiles of an operation type
+struct LatencySummary {
+  uint64_t count;
+  double average;
+  double p50;
+  double p99;
+  double p999;
+  uint64_t max;
+
+  explicit LatencySummary(const Histogram& hist)
+      : count(hist.num()),
+        average(hist.Average()),
+        p50(hist.Percentile(50)),
+        p99(hist.Percentile(99)),
+        p999(hist.Percentile(99.9)),
+        max(hist.max()) {}
+
+  // Adds the summary to the current object of json
+  void AddToJSON(JSONWriter* json) const {
+    *json << "count" << count << "average" << average << "p50" << p50
+          << "p99" << p99 << "p99.9" << p999 << "max" << max;
+  }
+};
+
 // a class that reports stats to CSV file
 class ReporterAgent {
  public:
+  // With record_latency, the agent also keeps the latency percentiles of each
+  // operation type in each interval, see intervals()
   ReporterAgent(Env* env, const std::string& fname,
-                uint64_t report_interval_secs)
+                uint64_t report_interval_secs, bool record_latency = false)
       : env_(env),
         total_ops_done_(0),
         last_report_(0),
         report_interval_secs_(report_interval_secs),
+        record_latency_(record_latency),
         stop_(false) {
+    if (record_latency_) {
+      for (auto& latency : latencies_) {
+        latency.reset(new HistogramImpl());
+      }
+    }
     auto s = env_->NewWritableFile(fname, &report_file_, EnvOptions());
     if (s.ok()) {
       s = report_file_->Append(Header() + "\n");
@@ -1317,13 +1612,17 @@ class ReporterAgent {
     reporting_thread_ = port::Thread([&]() { SleepAndReport(); });
   }
 
-  ~ReporterAgent() {
+  ~ReporterAgent() { Stop(); }
+
+  void Stop() {
     {
       std::unique_lock<std::mutex> lk(mutex_);
       stop_ = true;
       stop_cv_.notify_all();
     }
-    reporting_thread_.join();
+    if (reporting_thread_.joinable()) {
+      reporting_thread_.join();
+    }
   }
 
   // thread safe
@@ -1331,6 +1630,24 @@ class ReporterAgent {
     total_ops_done_.fetch_add(num_ops);
   }
 
+  // thread safe
+  void ReportLatency(OperationType op_type, uint64_t micros) {
+    if (record_latency_) {
+      std::lock_guard<std::mutex> lock(latency_mutexes_[op_type]);
+      latencies_[op_type]->Add(micros);
+    }
+  }
+
+  struct Interval {
+    uint64_t secs_elapsed;
+    int64_t ops;
+    std::vector<std::pair<OperationType, LatencySummary>> latencies;
+  };
+
+  // The intervals reported so far, with their latencies if recorded.
+  // REQUIRES: Stop() was called
+  const std::vector<Interval>& intervals() const { return intervals_; }
+
  private:
   std::string Header() const { return "secs_elapsed,interval_qps"; }
   void SleepAndReport() {
@@ -1365,6 +1682,23 @@ class ReporterAgent {
                 s.ToString().c_str());
         break;
       }
+      Interval interval;
+      interval.secs_elapsed = secs_elapsed;
+      interval.ops = total_ops_done_snapshot - last_report_;
+      for (size_t i = 0; record_latency_ && i < latencies_.size(); i++) {
+        // The histogram of the interval is swapped with an empty one, so
+        // that no latency is lost while it is read
+        std::unique_ptr<HistogramImpl> latency(new HistogramImpl());
+        {
+          std::lock_guard<std::mutex> lock(latency_mutexes_[i]);
+          latencies_[i].swap(latency);
+        }
+        if (!latency->Empty()) {
+          interval.latencies.emplace_back(static_cast<OperationType>(i),
+                                          LatencySummary(*latency));
+        }
+      }
+      intervals_.push_back(std::move(interval));
       last_report_ = total_ops_done_snapshot;
     }
   }
@@ -1374,6 +1708,12 @@ class ReporterAgent {
   std::atomic<int64_t> total_ops_done_;
   int64_t last_report_;
   const uint64_t report_interval_secs_;
+  const bool record_latency_;
+  // The latencies of each operation type in the current interval, guarded by
+  // the mutex of the type
+  std::array<std::unique_ptr<HistogramImpl>, kOthers + 1> latencies_;
+  std::array<std::mutex, kOthers + 1> latency_mutexes_;
+  std::vector<Interval> intervals_;
   rocksdb::port::Thread reporting_thread_;
   std::mutex mutex_;
   // will notify on stop
@@ -1381,35 +1721,6 @@ class ReporterAgent {
   bool stop_;
 };
 
-enum OperationType : unsigned char {
-  kRead = 0,
-  kWrite,
-  kDelete,
-  kSeek,
-  kMerge,
-  kUpdate,
-  kCompress,
-  kUncompress,
-  kCrc,
-  kHash,
-  kOthers
-};
-
-static std::unordered_map<OperationType, std::string, std::hash<unsigned char>>
-                          OperationTypeString = {
-  {kRead, "read"},
-  {kWrite, "write"},
-  {kDelete, "delete"},
-  {kSeek, "seek"},
-  {kMerge, "merge"},
-  {kUpdate, "update"},
-  {kCompress, "compress"},
-  {kCompress, "uncompress"},
-  {kCrc, "crc"},
-  {kHash, "hash"},
-  {kOthers, "op"}
-};
-
 class CombinedStats;
 class Stats {
  private:
@@ -1529,7 +1840,7 @@ class Stats {
     if (reporter_agent_) {
       reporter_agent_->ReportFinishedOps(num_ops);
     }
-    if (FLAGS_histogram) {
+    if (FLAGS_histogram || !FLAGS_json_report_file.empty()) {
       uint64_t now = FLAGS_env->NowMicros();
       uint64_t micros = now - last_op_finish_;
 
@@ -1539,8 +1850,11 @@ class Stats {
         hist_.insert({op_type, std::move(hist_temp)});
       }
       hist_[op_type]->Add(micros);
+      if (reporter_agent_) {
+        reporter_agent_->ReportLatency(op_type, micros);
+      }
 
-      if (micros > 20000 && !FLAGS_stats_interval) {
+      if (FLAGS_histogram && micros > 20000 && !FLAGS_stats_interval) {
         fprintf(stderr, "long op: %" PRIu64 " micros%30s\r", micros, "");
         fflush(stderr);
       }
@@ -1642,6 +1956,26 @@ class Stats {
     bytes_ += n;
   }
 
+  // Adds the throughput and the latency percentiles of each operation type
+  // to the current object of json
+  void ReportJSON(JSONWriter* json) const {
+    double elapsed = (finish_ - start_) * 1e-6;
+    *json << "ops" << done_ << "seconds" << elapsed;
+    if (elapsed > 0) {
+      *json << "ops_per_sec" << done_ / elapsed << "mb_per_sec"
+            << (bytes_ / 1048576.0) / elapsed;
+    }
+    json->AddKey("latency_micros");
+    json->StartObject();
+    for (const auto& hist : hist_) {
+      json->AddKey(OperationTypeString[hist.first]);
+      json->StartObject();
+      LatencySummary(*hist.second).AddToJSON(json);
+      json->EndObject();
+    }
+    json->EndObject();
+  }
+
   void Report(const Slice& name) {
     // Pretend at least one op was done in case we are running a benchmark
     // that does not call FinishedOps().
@@ -1867,11 +2201,64 @@ class Benchmark {
   int64_t reads_;
   int64_t deletes_;
   double read_random_exp_range_;
+  KeyDistribution key_dist_;
+  // Built by the first benchmark that needs it
+  std::unique_ptr<ZipfianGenerator> zipf_;
+  // The next key inserted by ycsbd and ycsbe, past the loaded keys
+  std::atomic<int64_t> next_insert_key_;
   int64_t writes_;
   int64_t readwrites_;
   int64_t merge_keys_;
   bool report_file_operations_;
   bool use_blob_db_;
+  std::unique_ptr<ThreadPool> decompression_pool_;
+  // The --json_report_file report, written at the end of Run()
+  std::unique_ptr<JSONWriter> json_report_;
+
+  void StartTrace() {
+    if (db_.db == nullptr) {
+      fprintf(stderr, "--trace_file needs a single DB\n");
+      exit(1);
+    }
+    std::unique_ptr<TraceWriter> trace_writer;
+    Status s = NewFileTraceWriter(FLAGS_env, EnvOptions(), FLAGS_trace_file,
+                                  &trace_writer);
+    if (s.ok()) {
+      TraceOptions trace_options;
+      trace_options.sampling_frequency =
+          static_cast<uint64_t>(std::max(FLAGS_trace_sampling_frequency, 1));
+      s = db_.db->StartTrace(trace_options, std::move(trace_writer));
+    }
+    if (!s.ok()) {
+      fprintf(stderr, "Encountered an error starting a trace, %s\n",
+              s.ToString().c_str());
+      exit(1);
+    }
+    fprintf(stdout, "Tracing operations to %s\n", FLAGS_trace_file.c_str());
+  }
+
+  void StartBlockCacheTrace() {
+    if (db_.db == nullptr) {
+      fprintf(stderr, "--block_cache_trace_file needs a single DB\n");
+      exit(1);
+    }
+    std::unique_ptr<TraceWriter> trace_writer;
+    Status s = NewFileTraceWriter(FLAGS_env, EnvOptions(),
+                                  FLAGS_block_cache_trace_file, &trace_writer);
+    if (s.ok()) {
+      TraceOptions trace_options;
+      trace_options.sampling_frequency = static_cast<uint64_t>(
+          std::max(FLAGS_block_cache_trace_sampling_frequency, 1));
+      s = db_.db->StartBlockCacheTrace(trace_options, std::move(trace_writer));
+    }
+    if (!s.ok()) {
+      fprintf(stderr, "Encountered an error starting a block cache trace, %s\n",
+              s.ToString().c_str());
+      exit(1);
+    }
+    fprintf(stdout, "Tracing block cache lookups to %s\n",
+            FLAGS_block_cache_trace_file.c_str());
+  }
 
   bool SanityCheck() {
     if (FLAGS_compression_ratio > 1) {
@@ -2090,7 +2477,23 @@ class Benchmark {
     std::shared_ptr<TimestampEmulator> timestamp_emulator_;
   };
 
-  std::shared_ptr<Cache> NewCache(int64_t capacity) {
+  static const FilterPolicy* NewFilterPolicy() {
+    if (FLAGS_bloom_bits < 0) {
+      return nullptr;
+    }
+    if (!strcasecmp(FLAGS_filter_type.c_str(), "xor")) {
+      return NewXorFilterPolicy(FLAGS_bloom_bits,
+                                FLAGS_filter_bits_per_level_v);
+    } else if (!strcasecmp(FLAGS_filter_type.c_str(), "bloom")) {
+      return NewBloomFilterPolicy(FLAGS_bloom_bits,
+                                  FLAGS_use_block_based_filter);
+    }
+    fprintf(stderr, "Unknown filter type: %s\n", FLAGS_filter_type.c_str());
+    exit(1);
+  }
+
+  std::shared_ptr<Cache> NewCache(int64_t capacity,
+                                  double compressed_tier_ratio = 0.0) {
     if (capacity <= 0) {
       return nullptr;
     }
@@ -2102,20 +2505,42 @@ class Benchmark {
       }
       return cache;
     } else {
+      std::shared_ptr<MemoryAllocator> allocator;
+      if (FLAGS_use_pooled_allocator) {
+        PooledMemoryAllocatorOptions allocator_options;
+        allocator_options.use_transparent_huge_pages =
+            FLAGS_pooled_allocator_use_thp;
+        allocator = NewPooledMemoryAllocator(allocator_options);
+      }
+      if (compressed_tier_ratio > 0.0) {
+        CompressedTierOptions tier_options;
+        tier_options.initial_ratio = compressed_tier_ratio;
+        tier_options.min_ratio =
+            std::min(tier_options.min_ratio, compressed_tier_ratio);
+        tier_options.max_ratio =
+            std::max(tier_options.max_ratio, compressed_tier_ratio);
+        tier_options.adaptive = FLAGS_cache_compressed_tier_adaptive;
+        auto cache = NewCompressedTieredCache(
+            (size_t)capacity, tier_options, FLAGS_cache_numshardbits,
+            false /*strict_capacity_limit*/, FLAGS_cache_high_pri_pool_ratio,
+            allocator);
+        if (!cache) {
+          fprintf(stderr, "Invalid --cache_compressed_tier_ratio\n");
+          exit(1);
+        }
+        return cache;
+      }
       return NewLRUCache((size_t)capacity, FLAGS_cache_numshardbits,
                          false /*strict_capacity_limit*/,
-                         FLAGS_cache_high_pri_pool_ratio);
+                         FLAGS_cache_high_pri_pool_ratio, allocator);
     }
   }
 
  public:
   Benchmark()
-      : cache_(NewCache(FLAGS_cache_size)),
+      : cache_(NewCache(FLAGS_cache_size, FLAGS_cache_compressed_tier_ratio)),
         compressed_cache_(NewCache(FLAGS_compressed_cache_size)),
-        filter_policy_(FLAGS_bloom_bits >= 0
-                           ? NewBloomFilterPolicy(FLAGS_bloom_bits,
-                                                  FLAGS_use_block_based_filter)
-                           : nullptr),
+        filter_policy_(NewFilterPolicy()),
         prefix_extractor_(NewFixedPrefixTransform(FLAGS_prefix_size)),
         num_(FLAGS_num),
         value_size_(FLAGS_value_size),
@@ -2125,6 +2550,8 @@ class Benchmark {
         entries_per_batch_(1),
         reads_(FLAGS_reads < 0 ? FLAGS_num : FLAGS_reads),
         read_random_exp_range_(0.0),
+        key_dist_(kUniformKeys),
+        next_insert_key_(FLAGS_num),
         writes_(FLAGS_writes < 0 ? FLAGS_num : FLAGS_writes),
         readwrites_(
             (FLAGS_writes < 0 && FLAGS_reads < 0)
@@ -2147,6 +2574,10 @@ class Benchmark {
       }
     }
 
+    if (FLAGS_decompression_readahead_blocks > 0) {
+      decompression_pool_.reset(NewThreadPool(FLAGS_decompression_threads));
+    }
+
     if (report_file_operations_) {
       if (!FLAGS_hdfs.empty()) {
         fprintf(stderr,
@@ -2203,12 +2634,54 @@ class Benchmark {
   }
 
   Slice AllocateKey(std::unique_ptr<const char[]>* key_guard) {
-    char* data = new char[key_size_];
+    int size = std::max(key_size_, FLAGS_key_size_max);
+    char* data = new char[size];
     const char* const_data = data;
     key_guard->reset(const_data);
     return Slice(key_guard->get(), key_size_);
   }
 
+  // key_size_, or with --key_size_max a size in [key_size_, key_size_max]
+  // that depends only on v
+  int KeySize(uint64_t v) {
+    if (FLAGS_key_size_max <= key_size_) {
+      return key_size_;
+    }
+    return key_size_ +
+           static_cast<int>(HashInt(v) % (FLAGS_key_size_max - key_size_ + 1));
+  }
+
+  static uint64_t HashInt(uint64_t v) {
+    const char* data = reinterpret_cast<const char*>(&v);
+    return (static_cast<uint64_t>(Hash(data, sizeof(v), 397)) << 32) |
+           Hash(data, sizeof(v), 0xbc9f1d34);
+  }
+
+  // The size of the next value, drawn from --value_size_dist
+  unsigned int NextValueSize(Random64* rand) {
+    switch (FLAGS_value_size_dist_e) {
+      case kUniformSize:
+        return static_cast<unsigned int>(
+            FLAGS_value_size_min +
+            rand->Uniform(FLAGS_value_size_max - FLAGS_value_size_min + 1));
+      case kNormalSize: {
+        // Box-Muller
+        double u1 = 1.0 - ZipfianGenerator::UniformDouble(rand);
+        double u2 = ZipfianGenerator::UniformDouble(rand);
+        const double kPi = 3.14159265358979323846;
+        double z = std::sqrt(-2.0 * std::log(u1)) * std::cos(2 * kPi * u2);
+        double mean = (FLAGS_value_size_min + FLAGS_value_size_max) / 2.0;
+        double stddev = (FLAGS_value_size_max - FLAGS_value_size_min) / 6.0;
+        double size = std::round(mean + z * stddev);
+        size = std::max(size, static_cast<double>(FLAGS_value_size_min));
+        size = std::min(size, static_cast<double>(FLAGS_value_size_max));
+        return static_cast<unsigned int>(size);
+      }
+      default:
+        return static_cast<unsigned int>(value_size_);
+    }
+  }
+
   // Generate key according to the given specification and random number.
   // The resulting key will have the following format (if keys_per_prefix_
   // is positive), extra trailing bytes are either cut off or padded with '0'.
@@ -2224,6 +2697,7 @@ class Benchmark {
   void GenerateKeyFromInt(uint64_t v, int64_t num_keys, Slice* key) {
     char* start = const_cast<char*>(key->data());
     char* pos = start;
+    int key_size = KeySize(v);
     if (keys_per_prefix_ > 0) {
       int64_t num_prefix = num_keys / keys_per_prefix_;
       int64_t prefix = v % num_prefix;
@@ -2242,7 +2716,7 @@ class Benchmark {
       pos += prefix_size_;
     }
 
-    int bytes_to_fill = std::min(key_size_ - static_cast<int>(pos - start), 8);
+    int bytes_to_fill = std::min(key_size - static_cast<int>(pos - start), 8);
     if (port::kLittleEndian) {
       for (int i = 0; i < bytes_to_fill; ++i) {
         pos[i] = (v >> ((bytes_to_fill - i - 1) << 3)) & 0xFF;
@@ -2251,9 +2725,10 @@ class Benchmark {
       memcpy(pos, static_cast<void*>(&v), bytes_to_fill);
     }
     pos += bytes_to_fill;
-    if (key_size_ > pos - start) {
-      memset(pos, '0', key_size_ - (pos - start));
+    if (key_size > pos - start) {
+      memset(pos, '0', key_size - (pos - start));
     }
+    *key = Slice(start, key_size);
   }
 
   std::string GetPathForMultiple(std::string base_name, size_t id) {
@@ -2308,6 +2783,15 @@ void VerifyDBFromDB(std::string& truth_db_name) {
     }
     Open(&open_options_);
     PrintHeader();
+    if (!FLAGS_trace_file.empty()) {
+      StartTrace();
+    }
+    if (!FLAGS_block_cache_trace_file.empty()) {
+      StartBlockCacheTrace();
+    }
+    if (!FLAGS_json_report_file.empty()) {
+      StartJSONReport();
+    }
     std::stringstream benchmark_stream(FLAGS_benchmarks);
     std::string name;
     std::unique_ptr<ExpiredTimeFilter> filter;
@@ -2325,6 +2809,16 @@ void VerifyDBFromDB(std::string& truth_db_name) {
       max_num_range_tombstones_ = FLAGS_max_num_range_tombstones;
       write_options_ = WriteOptions();
       read_random_exp_range_ = FLAGS_read_random_exp_range;
+      if (FLAGS_key_dist.empty()) {
+        key_dist_ =
+            name.compare(0, 4, "ycsb") == 0 ? kZipfianKeys : kUniformKeys;
+      } else {
+        StringToKeyDistribution(FLAGS_key_dist.c_str(), &key_dist_);
+      }
+      if ((key_dist_ == kZipfianKeys || name == "ycsbd") &&
+          zipf_ == nullptr && FLAGS_num > 0) {
+        zipf_.reset(new ZipfianGenerator(FLAGS_num, FLAGS_zipf_theta));
+      }
       if (FLAGS_sync) {
         write_options_.sync = true;
       }
@@ -2467,6 +2961,29 @@ void VerifyDBFromDB(std::string& truth_db_name) {
         method = &Benchmark::ReadWhileMerging;
       } else if (name == "readrandomwriterandom") {
         method = &Benchmark::ReadRandomWriteRandom;
+      } else if (name == "mixrandom") {
+        if (FLAGS_mix_get_ratio < 0 || FLAGS_mix_put_ratio < 0 ||
+            FLAGS_mix_seek_ratio < 0 ||
+            FLAGS_mix_get_ratio + FLAGS_mix_put_ratio + FLAGS_mix_seek_ratio <=
+                0) {
+          fprintf(stderr,
+                  "mixrandom needs non-negative --mix_*_ratio flags with a "
+                  "positive sum\n");
+          exit(1);
+        }
+        method = &Benchmark::MixRandom;
+      } else if (name == "ycsba") {
+        method = &Benchmark::YCSBA;
+      } else if (name == "ycsbb") {
+        method = &Benchmark::YCSBB;
+      } else if (name == "ycsbc") {
+        method = &Benchmark::YCSBC;
+      } else if (name == "ycsbd") {
+        method = &Benchmark::YCSBD;
+      } else if (name == "ycsbe") {
+        method = &Benchmark::YCSBE;
+      } else if (name == "ycsbf") {
+        method = &Benchmark::YCSBF;
       } else if (name == "readrandommergerandom") {
         if (FLAGS_merge_operator.empty()) {
           fprintf(stdout, "%-12s : skipped (--merge_operator is unknown)\n",
@@ -2530,6 +3047,8 @@ void VerifyDBFromDB(std::string& truth_db_name) {
         PrintStats("rocksdb.levelstats");
       } else if (name == "sstables") {
         PrintStats("rocksdb.sstables");
+      } else if (name == "filterstats") {
+        PrintFilterStats();
       } else if (!name.empty()) {  // No error message for empty name
         fprintf(stderr, "unknown benchmark '%s'\n", name.c_str());
         exit(1);
@@ -2565,7 +3084,7 @@ void VerifyDBFromDB(std::string& truth_db_name) {
         }
 
         for (int i = 0; i < num_warmup; i++) {
-          RunBenchmark(num_threads, name, method);
+          RunBenchmark(num_threads, name, method, true /* warmup */);
         }
 
         if (num_repeat > 1) {
@@ -2585,6 +3104,24 @@ void VerifyDBFromDB(std::string& truth_db_name) {
         (this->*post_process_method)();
       }
     }
+    if (!FLAGS_trace_file.empty() && db_.db != nullptr) {
+      Status s = db_.db->EndTrace();
+      if (!s.ok() && !s.IsNotFound()) {
+        fprintf(stderr, "Encountered an error ending the trace, %s\n",
+                s.ToString().c_str());
+      }
+    }
+    if (!FLAGS_block_cache_trace_file.empty() && db_.db != nullptr) {
+      Status s = db_.db->EndBlockCacheTrace();
+      if (!s.ok() && !s.IsNotFound()) {
+        fprintf(stderr,
+                "Encountered an error ending the block cache trace, %s\n",
+                s.ToString().c_str());
+      }
+    }
+    if (json_report_ != nullptr) {
+      FinishJSONReport();
+    }
     if (FLAGS_statistics) {
       fprintf(stdout, "STATISTICS:\n%s\n", dbstats->ToString().c_str());
     }
@@ -2636,7 +3173,8 @@ void VerifyDBFromDB(std::string& truth_db_name) {
   }
 
   Stats RunBenchmark(int n, Slice name,
-                     void (Benchmark::*method)(ThreadState*)) {
+                     void (Benchmark::*method)(ThreadState*),
+                     bool warmup = false) {
     SharedState shared;
     shared.total = n;
     shared.num_initialized = 0;
@@ -2654,8 +3192,9 @@ void VerifyDBFromDB(std::string& truth_db_name) {
 
     std::unique_ptr<ReporterAgent> reporter_agent;
     if (FLAGS_report_interval_seconds > 0) {
-      reporter_agent.reset(new ReporterAgent(FLAGS_env, FLAGS_report_file,
-                                             FLAGS_report_interval_seconds));
+      reporter_agent.reset(new ReporterAgent(
+          FLAGS_env, FLAGS_report_file, FLAGS_report_interval_seconds,
+          json_report_ != nullptr /* record_latency */));
     }
 
     ThreadArg* arg = new ThreadArg[n];
@@ -2705,6 +3244,12 @@ void VerifyDBFromDB(std::string& truth_db_name) {
       merge_stats.Merge(arg[i].thread->stats);
     }
     merge_stats.Report(name);
+    if (json_report_ != nullptr && !warmup) {
+      if (reporter_agent != nullptr) {
+        reporter_agent->Stop();
+      }
+      AddToJSONReport(name, merge_stats, reporter_agent.get());
+    }
 
     for (int i = 0; i < n; i++) {
       delete arg[i].thread;
@@ -2714,6 +3259,102 @@ void VerifyDBFromDB(std::string& truth_db_name) {
     return merge_stats;
   }
 
+  void StartJSONReport() {
+    json_report_.reset(new JSONWriter());
+    json_report_->AddKey("flags");
+    json_report_->StartObject();
+    std::vector<GFLAGS::CommandLineFlagInfo> flags;
+    GFLAGS::GetAllFlags(&flags);
+    for (const auto& flag : flags) {
+      *json_report_ << EscapeJSONString(flag.name)
+                    << EscapeJSONString(flag.current_value);
+    }
+    json_report_->EndObject();
+    json_report_->AddKey("benchmarks");
+    json_report_->StartArray();
+  }
+
+  // Adds a run of a benchmark with its stats, the latencies of each interval
+  // of reporter_agent if any, and the compaction stats of the DB
+  void AddToJSONReport(const Slice& name, const Stats& stats,
+                       const ReporterAgent* reporter_agent) {
+    JSONWriter* json = json_report_.get();
+    json->StartArrayedObject();
+    *json << "name" << EscapeJSONString(name.ToString());
+    stats.ReportJSON(json);
+
+    if (reporter_agent != nullptr) {
+      json->AddKey("intervals");
+      json->StartArray();
+      for (const auto& interval : reporter_agent->intervals()) {
+        json->StartArrayedObject();
+        *json << "secs_elapsed" << interval.secs_elapsed << "ops"
+              << interval.ops;
+        json->AddKey("latency_micros");
+        json->StartObject();
+        for (const auto& latency : interval.latencies) {
+          json->AddKey(OperationTypeString[latency.first]);
+          json->StartObject();
+          latency.second.AddToJSON(json);
+          json->EndObject();
+        }
+        json->EndObject();
+        json->EndArrayedObject();
+      }
+      json->EndArray();
+    }
+
+    std::map<std::string, std::string> cf_stats;
+    if (db_.db != nullptr &&
+        db_.db->GetMapProperty(DB::Properties::kCFStats, &cf_stats)) {
+      json->AddKey("compaction_stats");
+      json->StartObject();
+      for (const auto& stat : cf_stats) {
+        json->AddKey(EscapeJSONString(stat.first));
+        // The values are numbers, but write them as strings otherwise
+        char* end = nullptr;
+        double value = strtod(stat.second.c_str(), &end);
+        if (!stat.second.empty() && *end == '\0' && std::isfinite(value)) {
+          json->AddValue(stat.second);
+        } else {
+          json->AddValue(EscapeJSONString(stat.second).c_str());
+        }
+      }
+      json->EndObject();
+    }
+    json->EndArrayedObject();
+  }
+
+  void FinishJSONReport() {
+    json_report_->EndArray();
+    json_report_->EndObject();
+    Status s = WriteStringToFile(FLAGS_env, json_report_->Get() + "\n",
+                                 FLAGS_json_report_file);
+    if (!s.ok()) {
+      fprintf(stderr, "Cannot write the JSON report to %s: %s\n",
+              FLAGS_json_report_file.c_str(), s.ToString().c_str());
+    }
+    json_report_.reset();
+  }
+
+  // JSONWriter writes strings as they are
+  static std::string EscapeJSONString(const std::string& str) {
+    std::string escaped;
+    for (char c : str) {
+      if (c == '"' || c == '\\') {
+        escaped.push_back('\\');
+        escaped.push_back(c);
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        char buf[8];
+        snprintf(buf, sizeof(buf), "\\u%04x", c);
+        escaped.append(buf);
+      } else {
+        escaped.push_back(c);
+      }
+    }
+    return escaped;
+  }
+
   void Crc32c(ThreadState* thread) {
     // Checksum about 500MB of data total
     const int size = 4096;
@@ -2805,7 +3446,7 @@ void VerifyDBFromDB(std::string& truth_db_name) {
     int64_t bytes = 0;
     int decompress_size;
     while (ok && bytes < 1024 * 1048576) {
-      char *uncompressed = nullptr;
+      CacheAllocationPtr uncompressed;
       switch (FLAGS_compression_type_e) {
         case rocksdb::kSnappyCompression: {
           // get size and allocate here to make comparison fair
@@ -2815,9 +3456,9 @@ void VerifyDBFromDB(std::string& truth_db_name) {
             ok = false;
             break;
           }
-          uncompressed = new char[ulength];
+          uncompressed = AllocateBlock(ulength, nullptr);
           ok = Snappy_Uncompress(compressed.data(), compressed.size(),
-                                 uncompressed);
+                                 uncompressed.get());
           break;
         }
       case rocksdb::kZlibCompression:
@@ -2853,7 +3494,6 @@ void VerifyDBFromDB(std::string& truth_db_name) {
       default:
         ok = false;
       }
-      delete[] uncompressed;
       bytes += input.size();
       thread->stats.FinishedOps(nullptr, nullptr, 1, kUncompress);
     }
@@ -2946,6 +3586,7 @@ void VerifyDBFromDB(std::string& truth_db_name) {
     options.new_table_reader_for_compaction_inputs =
         FLAGS_new_table_reader_for_compaction_inputs;
     options.compaction_readahead_size = FLAGS_compaction_readahead_size;
+    options.compaction_readahead_threads = FLAGS_compaction_readahead_threads;
     options.random_access_max_buffer_size = FLAGS_random_access_max_buffer_size;
     options.writable_file_max_buffer_size = FLAGS_writable_file_max_buffer_size;
     options.use_fsync = FLAGS_use_fsync;
@@ -3551,24 +4192,23 @@ void VerifyDBFromDB(std::string& truth_db_name) {
       for (int64_t j = 0; j < entries_per_batch_; j++) {
         int64_t rand_num = key_gens[id]->Next();
         GenerateKeyFromInt(rand_num, FLAGS_num, &key);
+        Slice val = gen.Generate(NextValueSize(&thread->rand));
         if (use_blob_db_) {
 #ifndef ROCKSDB_LITE
-          Slice val = gen.Generate(value_size_);
           int ttl = rand() % 86400;
           blob_db::BlobDB* blobdb =
               static_cast<blob_db::BlobDB*>(db_with_cfh->db);
           s = blobdb->PutWithTTL(write_options_, key, val, ttl);
 #endif  //  ROCKSDB_LITE
         } else if (FLAGS_num_column_families <= 1) {
-          batch.Put(key, gen.Generate(value_size_));
+          batch.Put(key, val);
         } else {
           // We use same rand_num as seed for key and column family so that we
           // can deterministically find the cfh corresponding to a particular
           // key while reading the key.
-          batch.Put(db_with_cfh->GetCfh(rand_num), key,
-                    gen.Generate(value_size_));
+          batch.Put(db_with_cfh->GetCfh(rand_num), key, val);
         }
-        bytes += value_size_ + key_size_;
+        bytes += val.size() + key.size();
         ++num_written;
         if (writes_per_range_tombstone_ > 0 &&
             num_written / writes_per_range_tombstone_ <=
@@ -3939,6 +4579,9 @@ void VerifyDBFromDB(std::string& truth_db_name) {
   void ReadSequential(ThreadState* thread, DB* db) {
     ReadOptions options(FLAGS_verify_checksum, true);
     options.tailing = FLAGS_use_tailing_iterator;
+    options.decompression_readahead_blocks =
+        FLAGS_decompression_readahead_blocks;
+    options.decompression_thread_pool = decompression_pool_.get();
 
     Iterator* iter = db->NewIterator(options);
     int64_t i = 0;
@@ -4046,6 +4689,21 @@ void VerifyDBFromDB(std::string& truth_db_name) {
   }
 
   int64_t GetRandomKey(Random64* rand) {
+    if (key_dist_ == kZipfianKeys) {
+      // Scatter the popular ranks over the key space
+      return static_cast<int64_t>(HashInt(zipf_->Next(rand)) % FLAGS_num);
+    }
+    if (key_dist_ == kHotspotKeys) {
+      int64_t hot_keys = std::max<int64_t>(
+          1, static_cast<int64_t>(FLAGS_num * FLAGS_hot_key_fraction));
+      hot_keys = std::min(hot_keys, FLAGS_num);
+      if (hot_keys == FLAGS_num ||
+          ZipfianGenerator::UniformDouble(rand) < FLAGS_hot_op_fraction) {
+        return static_cast<int64_t>(rand->Next() % hot_keys);
+      }
+      return hot_keys +
+             static_cast<int64_t>(rand->Next() % (FLAGS_num - hot_keys));
+    }
     uint64_t rand_int = rand->Next();
     int64_t key_rand;
     if (read_random_exp_range_ == 0) {
@@ -4198,6 +4856,9 @@ void VerifyDBFromDB(std::string& truth_db_name) {
     int64_t bytes = 0;
     ReadOptions options(FLAGS_verify_checksum, true);
     options.tailing = FLAGS_use_tailing_iterator;
+    options.decompression_readahead_blocks =
+        FLAGS_decompression_readahead_blocks;
+    options.decompression_thread_pool = decompression_pool_.get();
 
     Iterator* single_iter = nullptr;
     std::vector<Iterator*> multi_iters;
@@ -4625,6 +5286,198 @@ void VerifyDBFromDB(std::string& truth_db_name) {
     thread->stats.AddMessage(msg);
   }
 
+  // Gets, Puts and Seeks of random keys, in the ratios of the --mix_*_ratio
+  // flags
+  void MixRandom(ThreadState* thread) {
+    ReadOptions options(FLAGS_verify_checksum, true);
+    RandomGenerator gen;
+    std::string value;
+    int64_t gets = 0;
+    int64_t puts = 0;
+    int64_t seeks = 0;
+    int64_t found = 0;
+    int64_t bytes = 0;
+    const double get_weight = FLAGS_mix_get_ratio;
+    const double put_weight = FLAGS_mix_put_ratio;
+    const double total_weight = get_weight + put_weight + FLAGS_mix_seek_ratio;
+    Duration duration(FLAGS_duration, readwrites_);
+
+    std::unique_ptr<const char[]> key_guard;
+    Slice key = AllocateKey(&key_guard);
+    while (!duration.Done(1)) {
+      DB* db = SelectDB(thread);
+      GenerateKeyFromInt(GetRandomKey(&thread->rand), FLAGS_num, &key);
+      double op = ZipfianGenerator::UniformDouble(&thread->rand) * total_weight;
+      if (op < get_weight) {
+        Status s = db->Get(options, key, &value);
+        if (s.ok()) {
+          found++;
+          bytes += key.size() + value.size();
+        } else if (!s.IsNotFound()) {
+          fprintf(stderr, "get error: %s\n", s.ToString().c_str());
+          abort();
+        }
+        gets++;
+        thread->stats.FinishedOps(nullptr, db, 1, kRead);
+      } else if (op < get_weight + put_weight) {
+        Slice val = gen.Generate(NextValueSize(&thread->rand));
+        Status s = db->Put(write_options_, key, val);
+        if (!s.ok()) {
+          fprintf(stderr, "put error: %s\n", s.ToString().c_str());
+          exit(1);
+        }
+        bytes += key.size() + val.size();
+        puts++;
+        thread->stats.FinishedOps(nullptr, db, 1, kWrite);
+      } else {
+        std::unique_ptr<Iterator> iter(db->NewIterator(options));
+        iter->Seek(key);
+        for (int j = 0; j < FLAGS_seek_nexts && iter->Valid(); ++j) {
+          bytes += iter->key().size() + iter->value().size();
+          iter->Next();
+        }
+        if (iter->Valid() && iter->key().compare(key) == 0) {
+          found++;
+        }
+        seeks++;
+        thread->stats.FinishedOps(nullptr, db, 1, kSeek);
+      }
+    }
+    char msg[100];
+    snprintf(msg, sizeof(msg),
+             "( gets:%" PRIu64 " puts:%" PRIu64 " seeks:%" PRIu64
+             " found:%" PRIu64 ")",
+             gets, puts, seeks, found);
+    thread->stats.AddBytes(bytes);
+    thread->stats.AddMessage(msg);
+  }
+
+  // The operations of a YCSB workload, in percent
+  struct YCSBMix {
+    int read;
+    int update;
+    int insert;
+    int scan;
+    int read_modify_write;
+  };
+
+  // The YCSB core workloads. The keys of FLAGS_num are the loaded records,
+  // e.g. by fillrandom; inserts add keys past them. Each operation reads or
+  // writes a whole value.
+  void YCSBA(ThreadState* thread) { YCSB(thread, {50, 50, 0, 0, 0}, false); }
+  void YCSBB(ThreadState* thread) { YCSB(thread, {95, 5, 0, 0, 0}, false); }
+  void YCSBC(ThreadState* thread) { YCSB(thread, {100, 0, 0, 0, 0}, false); }
+  void YCSBD(ThreadState* thread) { YCSB(thread, {95, 0, 5, 0, 0}, true); }
+  void YCSBE(ThreadState* thread) { YCSB(thread, {0, 0, 5, 95, 0}, false); }
+  void YCSBF(ThreadState* thread) { YCSB(thread, {50, 0, 0, 0, 50}, false); }
+
+  // With read_latest, the keys are drawn from a Zipfian distribution over
+  // the most recently inserted keys, as with YCSB's "latest" distribution
+  void YCSB(ThreadState* thread, const YCSBMix& mix, bool read_latest) {
+    ReadOptions options(FLAGS_verify_checksum, true);
+    RandomGenerator gen;
+    std::string value;
+    int64_t reads = 0;
+    int64_t updates = 0;
+    int64_t inserts = 0;
+    int64_t scans = 0;
+    int64_t read_modify_writes = 0;
+    int64_t found = 0;
+    int64_t bytes = 0;
+    Duration duration(FLAGS_duration, readwrites_);
+
+    std::unique_ptr<const char[]> key_guard;
+    Slice key = AllocateKey(&key_guard);
+    while (!duration.Done(1)) {
+      DB* db = SelectDB(thread);
+      int op = static_cast<int>(thread->rand.Uniform(100));
+      if (op < mix.insert) {
+        GenerateKeyFromInt(next_insert_key_.fetch_add(1), FLAGS_num, &key);
+        Slice val = gen.Generate(NextValueSize(&thread->rand));
+        Status s = db->Put(write_options_, key, val);
+        if (!s.ok()) {
+          fprintf(stderr, "insert error: %s\n", s.ToString().c_str());
+          exit(1);
+        }
+        bytes += key.size() + val.size();
+        inserts++;
+        thread->stats.FinishedOps(nullptr, db, 1, kWrite);
+        continue;
+      }
+      op -= mix.insert;
+
+      int64_t key_rand;
+      if (read_latest) {
+        int64_t latest = next_insert_key_.load() - 1;
+        key_rand = std::max<int64_t>(
+            0, latest - static_cast<int64_t>(zipf_->Next(&thread->rand)));
+      } else {
+        key_rand = GetRandomKey(&thread->rand);
+      }
+      GenerateKeyFromInt(key_rand, FLAGS_num, &key);
+
+      // op is in [0, read) for reads, then read_modify_write, update and
+      // scan
+      const int read_modify_write_end = mix.read + mix.read_modify_write;
+      if (op < read_modify_write_end) {
+        Status s = db->Get(options, key, &value);
+        if (s.ok()) {
+          found++;
+          bytes += key.size() + value.size();
+        } else if (!s.IsNotFound()) {
+          fprintf(stderr, "get error: %s\n", s.ToString().c_str());
+          abort();
+        }
+        if (op < mix.read) {
+          reads++;
+          thread->stats.FinishedOps(nullptr, db, 1, kRead);
+          continue;
+        }
+      }
+      if (op < read_modify_write_end + mix.update) {
+        Slice val = gen.Generate(NextValueSize(&thread->rand));
+        Status s = db->Put(write_options_, key, val);
+        if (!s.ok()) {
+          fprintf(stderr, "put error: %s\n", s.ToString().c_str());
+          exit(1);
+        }
+        bytes += key.size() + val.size();
+        if (op < read_modify_write_end) {
+          read_modify_writes++;
+          thread->stats.FinishedOps(nullptr, db, 1, kUpdate);
+        } else {
+          updates++;
+          thread->stats.FinishedOps(nullptr, db, 1, kWrite);
+        }
+        continue;
+      }
+
+      std::unique_ptr<Iterator> iter(db->NewIterator(options));
+      int64_t scan_length =
+          1 + static_cast<int64_t>(thread->rand.Uniform(
+                  std::max(FLAGS_ycsb_max_scan_length, 1)));
+      iter->Seek(key);
+      for (int64_t j = 0; j < scan_length && iter->Valid(); ++j) {
+        bytes += iter->key().size() + iter->value().size();
+        iter->Next();
+      }
+      if (!iter->status().ok()) {
+        fprintf(stderr, "scan error: %s\n", iter->status().ToString().c_str());
+        abort();
+      }
+      scans++;
+      thread->stats.FinishedOps(nullptr, db, 1, kSeek);
+    }
+    char msg[200];
+    snprintf(msg, sizeof(msg),
+             "( reads:%" PRIu64 " updates:%" PRIu64 " inserts:%" PRIu64
+             " scans:%" PRIu64 " read-modify-writes:%" PRIu64
+             " found:%" PRIu64 ")",
+             reads, updates, inserts, scans, read_modify_writes, found);
+    thread->stats.AddBytes(bytes);
+    thread->stats.AddMessage(msg);
+  }
+
   //
   // Read-modify-write for random keys
   void UpdateRandom(ThreadState* thread) {
@@ -5197,6 +6050,49 @@ void VerifyDBFromDB(std::string& truth_db_name) {
     }
   }
 
+  void PrintFilterStats() {
+    uint64_t filter_bytes = 0;
+    uint64_t num_entries = 0;
+#ifndef ROCKSDB_LITE
+    std::vector<DB*> dbs;
+    if (db_.db != nullptr) {
+      dbs.push_back(db_.db);
+    }
+    for (const auto& db_with_cfh : multi_dbs_) {
+      dbs.push_back(db_with_cfh.db);
+    }
+    for (DB* db : dbs) {
+      TablePropertiesCollection props;
+      if (!db->GetPropertiesOfAllTables(&props).ok()) {
+        continue;
+      }
+      for (const auto& p : props) {
+        filter_bytes += p.second->filter_size;
+        num_entries += p.second->num_entries;
+      }
+    }
+#endif  // ROCKSDB_LITE
+    fprintf(stdout, "Filter memory: %" PRIu64 " bytes (%.2f bits/entry)\n",
+            filter_bytes,
+            num_entries == 0 ? 0.0 : filter_bytes * 8.0 / num_entries);
+    if (dbstats) {
+      uint64_t useful = dbstats->getTickerCount(BLOOM_FILTER_USEFUL);
+      uint64_t positive = dbstats->getTickerCount(BLOOM_FILTER_FULL_POSITIVE);
+      uint64_t true_positive =
+          dbstats->getTickerCount(BLOOM_FILTER_FULL_TRUE_POSITIVE);
+      uint64_t false_positive =
+          positive >= true_positive ? positive - true_positive : 0;
+      uint64_t negatives = useful + false_positive;
+      fprintf(stdout,
+              "Filter checks: %" PRIu64 " useful, %" PRIu64
+              " false positive, FP rate: %.4f%%\n",
+              useful, false_positive,
+              negatives == 0 ? 0.0 : false_positive * 100.0 / negatives);
+    } else {
+      fprintf(stdout, "Filter FP rate: (needs --statistics)\n");
+    }
+  }
+
   void PrintStats(const char* key) {
     if (db_.db != nullptr) {
       PrintStats(db_.db, key, false);
@@ -5262,6 +6158,17 @@ int db_bench_tool(int argc, char** argv) {
 #endif
   }
 
+  std::vector<std::string> filter_bits = rocksdb::StringSplit(
+      FLAGS_filter_bits_per_level, ',');
+  for (size_t j = 0; j < filter_bits.size(); j++) {
+    FLAGS_filter_bits_per_level_v.push_back(
+#ifndef CYGWIN
+        std::stoi(filter_bits[j]));
+#else
+        stoi(filter_bits[j]));
+#endif
+  }
+
   FLAGS_compression_type_e =
     StringToCompressionType(FLAGS_compression_type.c_str());
 
@@ -5297,6 +6204,25 @@ int db_bench_tool(int argc, char** argv) {
 
   FLAGS_rep_factory = StringToRepFactory(FLAGS_memtablerep.c_str());
 
+  KeyDistribution key_dist;
+  if (!FLAGS_key_dist.empty() &&
+      !StringToKeyDistribution(FLAGS_key_dist.c_str(), &key_dist)) {
+    fprintf(stderr, "Unknown key distribution %s\n", FLAGS_key_dist.c_str());
+    exit(1);
+  }
+  if (FLAGS_zipf_theta <= 0 || FLAGS_zipf_theta >= 1) {
+    fprintf(stderr, "--zipf_theta must be in (0, 1)\n");
+    exit(1);
+  }
+  FLAGS_value_size_dist_e =
+      StringToSizeDistribution(FLAGS_value_size_dist.c_str());
+  if (FLAGS_value_size_dist_e != kFixedSize &&
+      (FLAGS_value_size_min < 0 ||
+       FLAGS_value_size_min > FLAGS_value_size_max)) {
+    fprintf(stderr, "--value_size_min must be in [0, --value_size_max]\n");
+    exit(1);
+  }
+
   // Note options sanitization may increase thread pool sizes according to
   // max_background_flushes/max_background_compactions/max_background_jobs
   FLAGS_env->SetBackgroundThreads(FLAGS_num_high_pri_threads,
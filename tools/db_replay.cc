@@ -0,0 +1,115 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// db_replay re-issues the operations recorded with DB::StartTrace() against
+// a DB, at their traced pace (optionally sped up) and from a configurable
+// number of threads, and reports the latency of each kind of operation.
+//
+// The DB should start in the state the traced DB was in when the trace
+// started (e.g. a checkpoint taken then), with the same column families.
+//
+//   ./db_replay --db=/path/to/db --trace_file=/path/to/trace --num_threads=8
+
+#include <cstdio>
+
+#ifndef GFLAGS
+int main() {
+  fprintf(stderr, "Please install gflags to run rocksdb tools\n");
+  return 1;
+}
+#else
+
+#include <gflags/gflags.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/db.h"
+#include "rocksdb/env.h"
+#include "rocksdb/options.h"
+#include "rocksdb/trace_reader_writer.h"
+#include "util/trace_replay.h"
+
+using GFLAGS::ParseCommandLineFlags;
+using GFLAGS::SetUsageMessage;
+
+DEFINE_string(db, "", "The DB to replay the trace against.");
+DEFINE_string(trace_file, "", "The trace file written by DB::StartTrace().");
+DEFINE_int32(num_threads, 1,
+             "Number of threads issuing the operations. With more than one, "
+             "operations close in time may run out of order.");
+DEFINE_double(fast_forward, 1.0,
+              "Replay this many times faster than the operations were "
+              "traced. Use a large value to replay as fast as possible.");
+DEFINE_bool(create_if_missing, false,
+            "Create the DB, with only the default column family, if it does "
+            "not exist.");
+
+namespace rocksdb {
+
+int ReplayMain() {
+  if (FLAGS_db.empty() || FLAGS_trace_file.empty()) {
+    fprintf(stderr, "--db and --trace_file are required\n");
+    return 1;
+  }
+
+  Options options;
+  options.create_if_missing = FLAGS_create_if_missing;
+  std::vector<std::string> cf_names;
+  Status s = DB::ListColumnFamilies(options, FLAGS_db, &cf_names);
+  if (!s.ok()) {
+    cf_names.clear();
+    cf_names.push_back(kDefaultColumnFamilyName);
+  }
+  std::vector<ColumnFamilyDescriptor> cf_descs;
+  for (const auto& name : cf_names) {
+    cf_descs.emplace_back(name, ColumnFamilyOptions(options));
+  }
+  std::vector<ColumnFamilyHandle*> handles;
+  DB* db = nullptr;
+  s = DB::Open(options, FLAGS_db, cf_descs, &handles, &db);
+  if (!s.ok()) {
+    fprintf(stderr, "Cannot open %s: %s\n", FLAGS_db.c_str(),
+            s.ToString().c_str());
+    return 1;
+  }
+
+  std::unique_ptr<TraceReader> trace_reader;
+  s = NewFileTraceReader(options.env, EnvOptions(), FLAGS_trace_file,
+                         &trace_reader);
+  if (s.ok()) {
+    Replayer replayer(db, handles, std::move(trace_reader));
+    ReplayOptions replay_options;
+    replay_options.num_threads = FLAGS_num_threads;
+    replay_options.fast_forward = FLAGS_fast_forward;
+    ReplayStats stats;
+    uint64_t start = options.env->NowMicros();
+    s = replayer.Replay(replay_options, &stats);
+    uint64_t elapsed = options.env->NowMicros() - start;
+    fprintf(stdout, "Replayed in %.3f seconds\n", elapsed / 1000000.0);
+    fprintf(stdout, "%s", stats.ToString().c_str());
+  }
+  if (!s.ok()) {
+    fprintf(stderr, "Replay failed: %s\n", s.ToString().c_str());
+  }
+
+  for (auto handle : handles) {
+    delete handle;
+  }
+  delete db;
+  return s.ok() ? 0 : 1;
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  SetUsageMessage(std::string("\nUSAGE:\n") + std::string(argv[0]) +
+                  " --db=<path> --trace_file=<path> [OPTIONS]...");
+  ParseCommandLineFlags(&argc, &argv, true);
+  return rocksdb::ReplayMain();
+}
+
+#endif  // GFLAGS
@@ -0,0 +1,259 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// io_trace_analyzer reads a trace written by the Env of NewIOTracingEnv()
+// and prints the bytes read and written by the threads of each type and
+// operation (user, flush, compaction), the sizes of the reads and writes,
+// the most accessed files and the latency of each file operation.
+//
+//   ./io_trace_analyzer --io_trace_path=/path/to/trace --top_files=20
+
+#include <inttypes.h>
+#include <cstdio>
+
+#ifndef GFLAGS
+int main() {
+  fprintf(stderr, "Please install gflags to run rocksdb tools\n");
+  return 1;
+}
+#else
+
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "monitoring/histogram.h"
+#include "rocksdb/env.h"
+#include "util/string_util.h"
+#include "utilities/env_io_tracing.h"
+
+using GFLAGS::ParseCommandLineFlags;
+using GFLAGS::SetUsageMessage;
+
+DEFINE_string(io_trace_path, "",
+              "The trace file written by the Env of NewIOTracingEnv().");
+DEFINE_int32(top_files, 10,
+             "The number of files to print, by decreasing accesses.");
+DEFINE_bool(print_histograms, false,
+            "Print the full latency histogram of each file operation.");
+
+namespace rocksdb {
+
+namespace {
+
+// The thread type and operation of a record, e.g. "HIGH_PRIORITY/Flush"
+std::string CallerName(const IOTraceRecord& record) {
+  return ThreadStatus::GetThreadTypeName(record.thread_type) + "/" +
+         ThreadStatus::GetOperationName(record.operation_type);
+}
+
+struct IOCount {
+  uint64_t ops = 0;
+  uint64_t bytes = 0;
+  uint64_t errors = 0;
+
+  void Add(const IOTraceRecord& record) {
+    ops++;
+    bytes += record.length;
+    errors += record.ok ? 0 : 1;
+  }
+};
+
+struct FileCount {
+  IOCount reads;
+  IOCount writes;
+  uint64_t other_ops = 0;
+
+  uint64_t ops() const { return reads.ops + writes.ops + other_ops; }
+};
+
+// The reads or writes of up to 2^i bytes, from 512 bytes to 64MB
+class SizeHistogram {
+ public:
+  static const int kNumBuckets = 18;
+
+  SizeHistogram() : counts_(kNumBuckets, 0), total_(0) {}
+
+  void Add(uint64_t size) {
+    int bucket = 0;
+    while (bucket < kNumBuckets - 1 && size > (512ULL << bucket)) {
+      bucket++;
+    }
+    counts_[bucket]++;
+    total_++;
+  }
+
+  void Print(const char* title) const {
+    fprintf(stdout, "\n%s sizes:\n", title);
+    if (total_ == 0) {
+      fprintf(stdout, "  none\n");
+      return;
+    }
+    for (int i = 0; i < kNumBuckets; i++) {
+      if (counts_[i] == 0) {
+        continue;
+      }
+      std::string bound = i == kNumBuckets - 1
+                              ? "> " + BytesToHumanString(512ULL << (i - 1))
+                              : "<= " + BytesToHumanString(512ULL << i);
+      fprintf(stdout, "  %-14s %12" PRIu64 " (%6.2f%%)\n", bound.c_str(),
+              counts_[i], 100.0 * counts_[i] / total_);
+    }
+  }
+
+ private:
+  std::vector<uint64_t> counts_;
+  uint64_t total_;
+};
+
+}  // namespace
+
+int IOTraceAnalyzerMain() {
+  if (FLAGS_io_trace_path.empty()) {
+    fprintf(stderr, "--io_trace_path is required\n");
+    return 1;
+  }
+  std::unique_ptr<IOTraceReader> reader;
+  Status s = IOTraceReader::Open(Env::Default(), FLAGS_io_trace_path, &reader);
+  if (!s.ok()) {
+    fprintf(stderr, "Cannot open %s: %s\n", FLAGS_io_trace_path.c_str(),
+            s.ToString().c_str());
+    return 1;
+  }
+
+  uint64_t num_records = 0;
+  uint64_t first_timestamp = 0;
+  uint64_t last_timestamp = 0;
+  SizeHistogram read_sizes;
+  SizeHistogram write_sizes;
+  std::unordered_map<std::string, FileCount> by_file;
+  std::map<std::string, std::pair<IOCount, IOCount>> by_caller;
+  std::map<std::pair<std::string, std::string>, std::unique_ptr<HistogramImpl>>
+      latencies;
+  while (true) {
+    IOTraceRecord record;
+    s = reader->Read(&record);
+    if (!s.ok()) {
+      break;
+    }
+    if (num_records == 0) {
+      first_timestamp = record.timestamp;
+    }
+    last_timestamp = std::max(last_timestamp, record.timestamp);
+    num_records++;
+
+    const std::string caller = CallerName(record);
+    FileCount& file_count = by_file[record.file_name];
+    if (record.op == kIOTraceRead) {
+      read_sizes.Add(record.length);
+      file_count.reads.Add(record);
+      by_caller[caller].first.Add(record);
+    } else if (record.op == kIOTraceWrite) {
+      write_sizes.Add(record.length);
+      file_count.writes.Add(record);
+      by_caller[caller].second.Add(record);
+    } else {
+      file_count.other_ops++;
+    }
+    auto& latency = latencies[std::make_pair(
+        std::string(IOTraceOpName(record.op)), caller)];
+    if (latency == nullptr) {
+      latency.reset(new HistogramImpl());
+    }
+    latency->Add(record.latency_nanos / 1000);
+  }
+  if (!s.IsIncomplete()) {
+    fprintf(stderr, "Cannot read %s: %s\n", FLAGS_io_trace_path.c_str(),
+            s.ToString().c_str());
+    return 1;
+  }
+  if (num_records == 0) {
+    fprintf(stdout, "The trace has no file operations\n");
+    return 0;
+  }
+
+  fprintf(stdout, "File operations: %" PRIu64 " over %.3f seconds\n",
+          num_records, (last_timestamp - first_timestamp) / 1000000.0);
+  if (reader->num_records_written() > num_records) {
+    fprintf(stdout, "  the %" PRIu64 " oldest ones were overwritten\n",
+            reader->num_records_written() - num_records);
+  }
+
+  fprintf(stdout, "\nReads and writes by thread type/operation:\n");
+  fprintf(stdout, "  %-28s %12s %12s %12s %12s\n", "", "reads", "read bytes",
+          "writes", "write bytes");
+  for (const auto& entry : by_caller) {
+    const IOCount& reads = entry.second.first;
+    const IOCount& writes = entry.second.second;
+    fprintf(stdout, "  %-28s %12" PRIu64 " %12s %12" PRIu64 " %12s\n",
+            entry.first.c_str(), reads.ops,
+            BytesToHumanString(reads.bytes).c_str(), writes.ops,
+            BytesToHumanString(writes.bytes).c_str());
+  }
+
+  read_sizes.Print("Read");
+  write_sizes.Print("Write");
+
+  std::vector<std::pair<std::string, FileCount>> files(by_file.begin(),
+                                                       by_file.end());
+  std::sort(files.begin(), files.end(),
+            [](const std::pair<std::string, FileCount>& f1,
+               const std::pair<std::string, FileCount>& f2) -> bool {
+              if (f1.second.ops() != f2.second.ops()) {
+                return f1.second.ops() > f2.second.ops();
+              }
+              return f1.first < f2.first;
+            });
+  if (FLAGS_top_files >= 0 &&
+      files.size() > static_cast<size_t>(FLAGS_top_files)) {
+    files.resize(FLAGS_top_files);
+  }
+  fprintf(stdout, "\nMost accessed files (of %" PRIu64 "):\n",
+          static_cast<uint64_t>(by_file.size()));
+  fprintf(stdout, "  %-28s %12s %12s %12s %12s %8s\n", "", "reads",
+          "read bytes", "writes", "write bytes", "errors");
+  for (const auto& file : files) {
+    const FileCount& count = file.second;
+    fprintf(stdout, "  %-28s %12" PRIu64 " %12s %12" PRIu64 " %12s %8" PRIu64
+                    "\n",
+            file.first.c_str(), count.reads.ops,
+            BytesToHumanString(count.reads.bytes).c_str(), count.writes.ops,
+            BytesToHumanString(count.writes.bytes).c_str(),
+            count.reads.errors + count.writes.errors);
+  }
+
+  fprintf(stdout, "\nLatency (micros) by operation and thread:\n");
+  fprintf(stdout, "  %-10s %-28s %10s %10s %10s %10s %10s\n", "", "", "count",
+          "average", "P50", "P99", "max");
+  for (const auto& entry : latencies) {
+    const HistogramImpl& latency = *entry.second;
+    fprintf(stdout,
+            "  %-10s %-28s %10" PRIu64 " %10.1f %10.1f %10.1f %10" PRIu64 "\n",
+            entry.first.first.c_str(), entry.first.second.c_str(),
+            latency.num(), latency.Average(), latency.Percentile(50),
+            latency.Percentile(99), latency.max());
+    if (FLAGS_print_histograms) {
+      fprintf(stdout, "%s\n", latency.ToString().c_str());
+    }
+  }
+  return 0;
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  SetUsageMessage(std::string("\nUSAGE:\n") + std::string(argv[0]) +
+                  " --io_trace_path=<path> [OPTIONS]...");
+  ParseCommandLineFlags(&argc, &argv, true);
+  return rocksdb::IOTraceAnalyzerMain();
+}
+
+#endif  // GFLAGS
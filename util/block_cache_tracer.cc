@@ -0,0 +1,240 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "util/block_cache_tracer.h"
+
+#include "util/coding.h"
+#include "util/hash.h"
+#include "util/string_util.h"
+
+namespace rocksdb {
+
+namespace {
+
+#ifdef ROCKSDB_SUPPORT_THREAD_LOCAL
+__thread TableReaderCaller thread_caller = kUncategorized;
+#endif
+
+bool IsBlockCacheTraceType(TraceType type) {
+  return type == kBlockTraceIndexBlock || type == kBlockTraceFilterBlock ||
+         type == kBlockTraceDataBlock;
+}
+
+}  // namespace
+
+void EncodeBlockCacheTraceRecord(const BlockCacheTraceRecord& record,
+                                 Trace* trace) {
+  trace->ts = record.access_timestamp;
+  trace->type = record.block_type;
+  trace->payload.clear();
+  PutLengthPrefixedSlice(&trace->payload, record.block_key);
+  PutFixed64(&trace->payload, record.block_size);
+  PutFixed32(&trace->payload, record.cf_id);
+  PutFixed32(&trace->payload, static_cast<uint32_t>(record.level));
+  trace->payload.push_back(record.caller);
+  trace->payload.push_back(static_cast<char>(record.is_cache_hit));
+  trace->payload.push_back(static_cast<char>(record.no_insert));
+}
+
+Status DecodeBlockCacheTraceRecord(const Trace& trace,
+                                   BlockCacheTraceRecord* record) {
+  if (!IsBlockCacheTraceType(trace.type)) {
+    return Status::Corruption("Not a block cache access record");
+  }
+  record->access_timestamp = trace.ts;
+  record->block_type = trace.type;
+  Slice input(trace.payload);
+  Slice block_key;
+  uint32_t level = 0;
+  if (!GetLengthPrefixedSlice(&input, &block_key) ||
+      !GetFixed64(&input, &record->block_size) ||
+      !GetFixed32(&input, &record->cf_id) || !GetFixed32(&input, &level) ||
+      input.size() < 3) {
+    return Status::Corruption("Block cache access record too short");
+  }
+  record->block_key = block_key.ToString();
+  record->level = static_cast<int>(level);
+  record->caller = static_cast<TableReaderCaller>(input[0]);
+  record->is_cache_hit = input[1] != 0;
+  record->no_insert = input[2] != 0;
+  return Status::OK();
+}
+
+BlockCacheTraceWriter::BlockCacheTraceWriter(
+    Env* env, std::unique_ptr<TraceWriter>&& trace_writer)
+    : env_(env), trace_writer_(std::move(trace_writer)) {}
+
+Status BlockCacheTraceWriter::WriteHeader() {
+  Trace trace;
+  trace.ts = env_->NowMicros();
+  trace.type = kTraceBegin;
+  trace.payload = kTraceMagic;
+  PutFixed32(&trace.payload, kBlockCacheTraceFormatVersion);
+  return WriteTrace(trace);
+}
+
+Status BlockCacheTraceWriter::WriteBlockAccess(
+    const BlockCacheTraceRecord& record) {
+  Trace trace;
+  EncodeBlockCacheTraceRecord(record, &trace);
+  return WriteTrace(trace);
+}
+
+Status BlockCacheTraceWriter::Close() {
+  Trace trace;
+  trace.ts = env_->NowMicros();
+  trace.type = kTraceEnd;
+  Status s = WriteTrace(trace);
+  Status close_status = trace_writer_->Close();
+  return s.ok() ? close_status : s;
+}
+
+Status BlockCacheTraceWriter::WriteTrace(const Trace& trace) {
+  std::string encoded_trace;
+  EncodeTrace(trace, &encoded_trace);
+  return trace_writer_->Write(Slice(encoded_trace));
+}
+
+BlockCacheTraceReader::BlockCacheTraceReader(
+    std::unique_ptr<TraceReader>&& reader)
+    : trace_reader_(std::move(reader)) {}
+
+Status BlockCacheTraceReader::ReadHeader() {
+  std::string encoded_trace;
+  Status s = trace_reader_->Read(&encoded_trace);
+  if (!s.ok()) {
+    return s;
+  }
+  Trace header;
+  s = DecodeTrace(encoded_trace, &header);
+  if (!s.ok()) {
+    return s;
+  }
+  if (header.type != kTraceBegin) {
+    return Status::Corruption("Corrupted trace file. Incorrect header.");
+  }
+  if (header.payload.size() < kTraceMagic.size() + sizeof(uint32_t) ||
+      header.payload.compare(0, kTraceMagic.size(), kTraceMagic) != 0) {
+    return Status::Corruption("Corrupted trace file. Incorrect magic.");
+  }
+  uint32_t version = DecodeFixed32(header.payload.data() + kTraceMagic.size());
+  if (version > kBlockCacheTraceFormatVersion) {
+    return Status::NotSupported("Unknown block cache trace format version " +
+                                NumberToString(version));
+  }
+  return Status::OK();
+}
+
+Status BlockCacheTraceReader::ReadAccess(BlockCacheTraceRecord* record) {
+  assert(record != nullptr);
+  while (true) {
+    std::string encoded_trace;
+    Status s = trace_reader_->Read(&encoded_trace);
+    if (!s.ok()) {
+      return s;
+    }
+    Trace trace;
+    s = DecodeTrace(encoded_trace, &trace);
+    if (!s.ok()) {
+      return s;
+    }
+    if (trace.type == kTraceEnd) {
+      return Status::Incomplete("End of trace");
+    }
+    // Records of other kinds, e.g. from a newer format, are skipped
+    if (IsBlockCacheTraceType(trace.type)) {
+      return DecodeBlockCacheTraceRecord(trace, record);
+    }
+  }
+}
+
+BlockCacheTracer::BlockCacheTracer()
+    : env_(nullptr), sampling_frequency_(1), writer_(nullptr) {}
+
+BlockCacheTracer::~BlockCacheTracer() { EndTrace(); }
+
+Status BlockCacheTracer::StartTrace(
+    Env* env, const TraceOptions& trace_options,
+    std::unique_ptr<TraceWriter>&& trace_writer) {
+  InstrumentedMutexLock lock(&trace_writer_mutex_);
+  if (writer_.load(std::memory_order_relaxed) != nullptr) {
+    return Status::Busy("A block cache trace is already running");
+  }
+  std::unique_ptr<BlockCacheTraceWriter> writer(
+      new BlockCacheTraceWriter(env, std::move(trace_writer)));
+  Status s = writer->WriteHeader();
+  if (!s.ok()) {
+    return s;
+  }
+  env_ = env;
+  trace_options_ = trace_options;
+  sampling_frequency_.store(trace_options.sampling_frequency,
+                            std::memory_order_relaxed);
+  writer_.store(writer.release(), std::memory_order_release);
+  return Status::OK();
+}
+
+Status BlockCacheTracer::EndTrace() {
+  InstrumentedMutexLock lock(&trace_writer_mutex_);
+  std::unique_ptr<BlockCacheTraceWriter> writer(
+      writer_.load(std::memory_order_relaxed));
+  if (writer == nullptr) {
+    return Status::NotFound("No block cache trace running");
+  }
+  writer_.store(nullptr, std::memory_order_release);
+  return writer->Close();
+}
+
+Status BlockCacheTracer::WriteBlockAccess(BlockCacheTraceRecord* record) {
+  if (!is_tracing_enabled()) {
+    return Status::OK();
+  }
+  const uint64_t sampling_frequency =
+      sampling_frequency_.load(std::memory_order_relaxed);
+  if (sampling_frequency > 1 &&
+      GetSliceHash(record->block_key) % sampling_frequency != 0) {
+    return Status::OK();
+  }
+  record->caller = BlockCacheTraceCallerScope::Current();
+  InstrumentedMutexLock lock(&trace_writer_mutex_);
+  BlockCacheTraceWriter* writer = writer_.load(std::memory_order_relaxed);
+  if (writer == nullptr ||
+      writer->GetFileSize() > trace_options_.max_trace_file_size) {
+    return Status::OK();
+  }
+  record->access_timestamp = env_->NowMicros();
+  return writer->WriteBlockAccess(*record);
+}
+
+BlockCacheTraceCallerScope::BlockCacheTraceCallerScope(
+    TableReaderCaller caller)
+    : is_outermost_(false) {
+#ifdef ROCKSDB_SUPPORT_THREAD_LOCAL
+  if (thread_caller == kUncategorized) {
+    thread_caller = caller;
+    is_outermost_ = true;
+  }
+#else
+  (void)caller;
+#endif
+}
+
+BlockCacheTraceCallerScope::~BlockCacheTraceCallerScope() {
+#ifdef ROCKSDB_SUPPORT_THREAD_LOCAL
+  if (is_outermost_) {
+    thread_caller = kUncategorized;
+  }
+#endif
+}
+
+TableReaderCaller BlockCacheTraceCallerScope::Current() {
+#ifdef ROCKSDB_SUPPORT_THREAD_LOCAL
+  return thread_caller;
+#else
+  return kUncategorized;
+#endif
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,154 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "monitoring/instrumented_mutex.h"
+#include "rocksdb/env.h"
+#include "rocksdb/options.h"
+#include "rocksdb/trace_reader_writer.h"
+#include "util/trace_replay.h"
+
+namespace rocksdb {
+
+// The operation that made the table reader access a block
+enum TableReaderCaller : char {
+  kUserGet = 1,
+  kUserIterator = 2,
+  kCompaction = 3,
+  kFlush = 4,
+  // Index and filter blocks loaded when a table is opened
+  kPrefetch = 5,
+  kUncategorized = 6,
+  // All callers should be added before kMaxTableReaderCaller
+  kMaxTableReaderCaller,
+};
+
+// One lookup of a block in the block cache.
+struct BlockCacheTraceRecord {
+  uint64_t access_timestamp = 0;
+  // The key of the block in the block cache
+  std::string block_key;
+  // kBlockTraceIndexBlock, kBlockTraceFilterBlock or kBlockTraceDataBlock
+  TraceType block_type = kTraceMax;
+  // The charge of the block in the block cache, or its size on disk if it
+  // was not loaded
+  uint64_t block_size = 0;
+  uint32_t cf_id = 0;
+  // The level of the table, -1 if unknown
+  int level = -1;
+  TableReaderCaller caller = kUncategorized;
+  // Whether the block was found in the block cache or the compressed block
+  // cache
+  bool is_cache_hit = false;
+  // Whether the block is not inserted on a miss (ReadOptions::fill_cache)
+  bool no_insert = false;
+};
+
+// A block cache trace uses the record framing of util/trace_replay.h. It
+// starts with a kTraceBegin record and ends with a kTraceEnd record, and each
+// access is a record of its block_type whose payload is:
+//    block key: varint32 length + bytes
+//    block size: fixed64
+//    column family ID: fixed32
+//    level: fixed32
+//    caller: uint8
+//    is cache hit: uint8
+//    no insert: uint8
+const uint32_t kBlockCacheTraceFormatVersion = 1;
+
+extern void EncodeBlockCacheTraceRecord(const BlockCacheTraceRecord& record,
+                                        Trace* trace);
+extern Status DecodeBlockCacheTraceRecord(const Trace& trace,
+                                          BlockCacheTraceRecord* record);
+
+// BlockCacheTraceWriter writes the records of a block cache trace.
+// Not thread-safe.
+class BlockCacheTraceWriter {
+ public:
+  BlockCacheTraceWriter(Env* env, std::unique_ptr<TraceWriter>&& trace_writer);
+
+  Status WriteHeader();
+  Status WriteBlockAccess(const BlockCacheTraceRecord& record);
+  // Writes the kTraceEnd record and closes the TraceWriter
+  Status Close();
+
+  uint64_t GetFileSize() { return trace_writer_->GetFileSize(); }
+
+ private:
+  Status WriteTrace(const Trace& trace);
+
+  Env* env_;
+  std::unique_ptr<TraceWriter> trace_writer_;
+};
+
+// BlockCacheTraceReader reads the accesses of a block cache trace, in order.
+class BlockCacheTraceReader {
+ public:
+  explicit BlockCacheTraceReader(std::unique_ptr<TraceReader>&& reader);
+
+  // Reads and checks the kTraceBegin record. Must be called first.
+  Status ReadHeader();
+  // Returns Status::Incomplete at the end of the trace
+  Status ReadAccess(BlockCacheTraceRecord* record);
+
+ private:
+  std::unique_ptr<TraceReader> trace_reader_;
+};
+
+// BlockCacheTracer records the block cache accesses of the tables of a DB
+// while a trace started with DB::StartBlockCacheTrace() is running.
+// Thread-safe. With TraceOptions::sampling_frequency N, the accesses of about
+// one block in N are recorded, chosen by the hash of the block key, so that
+// the recorded accesses of a block are all of them.
+class BlockCacheTracer {
+ public:
+  BlockCacheTracer();
+  ~BlockCacheTracer();
+
+  // Returns Status::Busy if a trace is already running
+  Status StartTrace(Env* env, const TraceOptions& trace_options,
+                    std::unique_ptr<TraceWriter>&& trace_writer);
+  // Returns Status::NotFound if no trace is running
+  Status EndTrace();
+
+  bool is_tracing_enabled() const {
+    return writer_.load(std::memory_order_relaxed) != nullptr;
+  }
+
+  // Records the access if a trace is running and the block is sampled. The
+  // caller and timestamp of record are filled in here.
+  Status WriteBlockAccess(BlockCacheTraceRecord* record);
+
+ private:
+  TraceOptions trace_options_;
+  Env* env_;
+  // trace_options_.sampling_frequency, read without the mutex
+  std::atomic<uint64_t> sampling_frequency_;
+  // Guards writer_ and serializes the writes
+  InstrumentedMutex trace_writer_mutex_;
+  std::atomic<BlockCacheTraceWriter*> writer_;
+};
+
+// Tags the block cache accesses of the current thread with caller while the
+// scope is alive. Nested scopes keep the outermost caller, so that e.g. the
+// index blocks read by a compaction's iterators are attributed to the
+// compaction. Without thread-local storage all accesses are kUncategorized.
+class BlockCacheTraceCallerScope {
+ public:
+  explicit BlockCacheTraceCallerScope(TableReaderCaller caller);
+  ~BlockCacheTraceCallerScope();
+
+  static TableReaderCaller Current();
+
+ private:
+  bool is_outermost_;
+};
+
+}  // namespace rocksdb
@@ -40,6 +40,7 @@ extern void PutVarint32Varint32(std::string* dst, uint32_t value1,
 extern void PutVarint32Varint32Varint32(std::string* dst, uint32_t value1,
                                         uint32_t value2, uint32_t value3);
 extern void PutVarint64(std::string* dst, uint64_t value);
+extern void PutVarsignedint64(std::string* dst, int64_t value);
 extern void PutVarint64Varint64(std::string* dst, uint64_t value1,
                                 uint64_t value2);
 extern void PutVarint32Varint64(std::string* dst, uint32_t value1,
@@ -56,6 +57,7 @@ extern bool GetFixed64(Slice* input, uint64_t* value);
 extern bool GetFixed32(Slice* input, uint32_t* value);
 extern bool GetVarint32(Slice* input, uint32_t* value);
 extern bool GetVarint64(Slice* input, uint64_t* value);
+extern bool GetVarsignedint64(Slice* input, int64_t* value);
 extern bool GetLengthPrefixedSlice(Slice* input, Slice* result);
 // This function assumes data is well-formed.
 extern Slice GetLengthPrefixedSlice(const char* data);
@@ -68,6 +70,8 @@ extern Slice GetSliceUntil(Slice* slice, char delimiter);
 // [p..limit-1]
 extern const char* GetVarint32Ptr(const char* p,const char* limit, uint32_t* v);
 extern const char* GetVarint64Ptr(const char* p,const char* limit, uint64_t* v);
+extern const char* GetVarsignedint64Ptr(const char* p, const char* limit,
+                                        int64_t* v);
 
 // Returns the length of the varint32 or varint64 encoding of "v"
 extern int VarintLength(uint64_t v);
@@ -219,6 +223,20 @@ inline void PutVarint64(std::string* dst, uint64_t v) {
   dst->append(buf, static_cast<size_t>(ptr - buf));
 }
 
+// Signed varints are zigzag-encoded, so that numbers close to zero take few
+// bytes whatever their sign.
+inline uint64_t I64ToZigzag(const int64_t l) {
+  return (static_cast<uint64_t>(l) << 1) ^ static_cast<uint64_t>(l >> 63);
+}
+
+inline int64_t ZigzagToI64(uint64_t n) {
+  return static_cast<int64_t>(n >> 1) ^ -static_cast<int64_t>(n & 1);
+}
+
+inline void PutVarsignedint64(std::string* dst, int64_t v) {
+  PutVarint64(dst, I64ToZigzag(v));
+}
+
 inline void PutVarint64Varint64(std::string* dst, uint64_t v1, uint64_t v2) {
   char buf[20];
   char* ptr = EncodeVarint64(buf, v1);
@@ -310,6 +328,25 @@ inline bool GetVarint64(Slice* input, uint64_t* value) {
   }
 }
 
+inline const char* GetVarsignedint64Ptr(const char* p, const char* limit,
+                                        int64_t* v) {
+  uint64_t u = 0;
+  const char* q = GetVarint64Ptr(p, limit, &u);
+  if (q != nullptr) {
+    *v = ZigzagToI64(u);
+  }
+  return q;
+}
+
+inline bool GetVarsignedint64(Slice* input, int64_t* value) {
+  uint64_t u = 0;
+  if (!GetVarint64(input, &u)) {
+    return false;
+  }
+  *value = ZigzagToI64(u);
+  return true;
+}
+
 // Provide an interface for platform independent endianness transformation
 inline uint64_t EndianTransform(uint64_t input, size_t size) {
   char* pos = reinterpret_cast<char*>(&input);
@@ -9,6 +9,8 @@
 
 #include "util/coding.h"
 
+#include <limits>
+
 #include "util/testharness.h"
 
 namespace rocksdb {
@@ -136,6 +138,44 @@ TEST(Coding, Varint64) {
 
 }
 
+TEST(Coding, Varsignedint64) {
+  std::vector<int64_t> values = {0,
+                                 1,
+                                 -1,
+                                 63,
+                                 -64,
+                                 64,
+                                 -65,
+                                 std::numeric_limits<int64_t>::max(),
+                                 std::numeric_limits<int64_t>::min()};
+  for (uint32_t k = 0; k < 63; k++) {
+    const int64_t power = static_cast<int64_t>(1ull << k);
+    values.push_back(power);
+    values.push_back(-power);
+  }
+
+  std::string s;
+  for (auto v : values) {
+    PutVarsignedint64(&s, v);
+  }
+  // Small magnitudes take one byte whatever their sign
+  ASSERT_EQ(1, VarintLength(I64ToZigzag(-64)));
+  ASSERT_EQ(1, VarintLength(I64ToZigzag(63)));
+
+  Slice input(s);
+  for (auto v : values) {
+    int64_t actual = 0;
+    ASSERT_TRUE(GetVarsignedint64(&input, &actual));
+    ASSERT_EQ(v, actual);
+  }
+  ASSERT_TRUE(input.empty());
+
+  int64_t actual = 0;
+  const char* p = GetVarsignedint64Ptr(s.data(), s.data() + s.size(), &actual);
+  ASSERT_TRUE(p != nullptr);
+  ASSERT_EQ(values[0], actual);
+}
+
 TEST(Coding, Varint32Overflow) {
   uint32_t result;
   std::string input("\x81\x82\x83\x84\x85\x11");
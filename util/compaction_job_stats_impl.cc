@@ -38,6 +38,8 @@ void CompactionJobStats::Reset() {
   file_range_sync_nanos = 0;
   file_fsync_nanos = 0;
   file_prepare_write_nanos = 0;
+  file_read_nanos = 0;
+  file_prefetch_wait_nanos = 0;
 
   num_single_del_fallthru = 0;
   num_single_del_mismatch = 0;
@@ -70,6 +72,8 @@ void CompactionJobStats::Add(const CompactionJobStats& stats) {
   file_range_sync_nanos += stats.file_range_sync_nanos;
   file_fsync_nanos += stats.file_fsync_nanos;
   file_prepare_write_nanos += stats.file_prepare_write_nanos;
+  file_read_nanos += stats.file_read_nanos;
+  file_prefetch_wait_nanos += stats.file_prefetch_wait_nanos;
 
   num_single_del_fallthru += stats.num_single_del_fallthru;
   num_single_del_mismatch += stats.num_single_del_mismatch;
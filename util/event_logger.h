@@ -17,7 +17,7 @@ namespace rocksdb {
 
 class JSONWriter {
  public:
-  JSONWriter() : state_(kExpectKey), first_element_(true), in_array_(false) {
+  JSONWriter() : state_(kExpectKey), first_element_(true), array_depth_(0) {
     stream_ << "{";
   }
 
@@ -59,7 +59,7 @@ class JSONWriter {
   void StartArray() {
     assert(state_ == kExpectValue);
     state_ = kInArray;
-    in_array_ = true;
+    array_depth_++;
     stream_ << "[";
     first_element_ = true;
   }
@@ -67,7 +67,7 @@ class JSONWriter {
   void EndArray() {
     assert(state_ == kInArray);
     state_ = kExpectKey;
-    in_array_ = false;
+    array_depth_--;
     stream_ << "]";
     first_element_ = false;
   }
@@ -86,7 +86,7 @@ class JSONWriter {
   }
 
   void StartArrayedObject() {
-    assert(state_ == kInArray && in_array_);
+    assert(state_ == kInArray && array_depth_ > 0);
     state_ = kExpectValue;
     if (!first_element_) {
       stream_ << ", ";
@@ -95,7 +95,7 @@ class JSONWriter {
   }
 
   void EndArrayedObject() {
-    assert(in_array_);
+    assert(array_depth_ > 0);
     EndObject();
     state_ = kInArray;
   }
@@ -131,7 +131,9 @@ class JSONWriter {
   };
   JSONWriterState state_;
   bool first_element_;
-  bool in_array_;
+  // The number of arrays the current element is nested in, so that an
+  // arrayed object can hold arrays of its own
+  int array_depth_;
   std::ostringstream stream_;
 };
 
@@ -35,6 +35,24 @@ TEST_F(EventLoggerTest, SimpleTest) {
   ASSERT_TRUE(output.find("\"time_micros\"") != std::string::npos);
 }
 
+TEST_F(EventLoggerTest, NestedArrays) {
+  JSONWriter writer;
+  writer << "outer";
+  writer.StartArray();
+  writer.StartArrayedObject();
+  writer << "inner";
+  writer.StartArray();
+  writer << 1 << 2;
+  writer.EndArray();
+  writer.EndArrayedObject();
+  writer.StartArrayedObject();
+  writer << "id" << 3;
+  writer.EndArrayedObject();
+  writer.EndArray();
+  writer.EndObject();
+  ASSERT_EQ("{\"outer\": [{\"inner\": [1, 2]}, {\"id\": 3}]}", writer.Get());
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
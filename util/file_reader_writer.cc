@@ -10,6 +10,7 @@
 #include "util/file_reader_writer.h"
 
 #include <algorithm>
+#include <condition_variable>
 #include <mutex>
 
 #include "monitoring/histogram.h"
@@ -18,6 +19,7 @@
 #include "util/random.h"
 #include "util/rate_limiter.h"
 #include "util/sync_point.h"
+#include "util/threadpool_imp.h"
 
 namespace rocksdb {
 
@@ -601,6 +603,217 @@ class ReadaheadRandomAccessFile : public RandomAccessFile {
   mutable uint64_t buffer_offset_;
   mutable size_t buffer_len_;
 };
+
+// Like ReadaheadRandomAccessFile, but double buffered: while the reader
+// consumes one readahead window, the window following it is read into the
+// other buffer by a job running on `prefetch_pool`. A read outside of both
+// windows is served synchronously. If the prefetch of the window a read needs
+// has not started yet, it is unscheduled and done synchronously as well, so
+// a reader never waits behind other jobs queued on the pool.
+class AsyncReadaheadRandomAccessFile : public RandomAccessFile {
+ public:
+  AsyncReadaheadRandomAccessFile(std::unique_ptr<RandomAccessFile>&& file,
+                                 size_t readahead_size,
+                                 ThreadPoolImpl* prefetch_pool)
+      : file_(std::move(file)),
+        alignment_(file_->GetRequiredBufferAlignment()),
+        readahead_size_(Roundup(readahead_size, alignment_)),
+        prefetch_pool_(prefetch_pool),
+        current_(0),
+        prefetch_state_(kIdle),
+        prefetch_offset_(0) {
+    for (auto& window : windows_) {
+      window.buffer.Alignment(alignment_);
+      window.buffer.AllocateNewBuffer(readahead_size_);
+      window.offset = 0;
+      window.len = 0;
+    }
+  }
+
+  ~AsyncReadaheadRandomAccessFile() {
+    std::unique_lock<std::mutex> lk(lock_);
+    FinishPrefetch(&lk);
+  }
+
+  AsyncReadaheadRandomAccessFile(const AsyncReadaheadRandomAccessFile&) =
+      delete;
+  AsyncReadaheadRandomAccessFile& operator=(
+      const AsyncReadaheadRandomAccessFile&) = delete;
+
+  virtual Status Read(uint64_t offset, size_t n, Slice* result,
+                      char* scratch) const override {
+    if (n + alignment_ >= readahead_size_) {
+      return file_->Read(offset, n, result, scratch);
+    }
+
+    std::unique_lock<std::mutex> lk(lock_);
+    Status s;
+    size_t copied = 0;
+    while (copied < n) {
+      uint64_t pos = offset + copied;
+      if (!windows_[current_].Contains(pos)) {
+        s = MakeCurrentWindowContain(pos, &lk);
+        if (!s.ok() || !windows_[current_].Contains(pos)) {
+          // Error or end of file
+          break;
+        }
+      }
+      const Window& window = windows_[current_];
+      size_t offset_in_window = static_cast<size_t>(pos - window.offset);
+      size_t len = std::min(n - copied, window.len - offset_in_window);
+      memcpy(scratch + copied, window.buffer.BufferStart() + offset_in_window,
+             len);
+      copied += len;
+    }
+    *result = Slice(scratch, copied);
+    return s;
+  }
+
+  virtual Status Prefetch(uint64_t offset, size_t n) override {
+    std::unique_lock<std::mutex> lk(lock_);
+    size_t prefetch_offset = TruncateToPageBoundary(alignment_, offset);
+    if (prefetch_offset == windows_[current_].offset &&
+        windows_[current_].len > 0) {
+      return Status::OK();
+    }
+    FinishPrefetch(&lk);
+    return ReadWindow(&windows_[current_], prefetch_offset,
+                      Roundup(offset + n, alignment_) - prefetch_offset);
+  }
+
+  virtual size_t GetUniqueId(char* id, size_t max_size) const override {
+    return file_->GetUniqueId(id, max_size);
+  }
+
+  virtual void Hint(AccessPattern pattern) override { file_->Hint(pattern); }
+
+  virtual Status InvalidateCache(size_t offset, size_t length) override {
+    return file_->InvalidateCache(offset, length);
+  }
+
+  virtual bool use_direct_io() const override {
+    return file_->use_direct_io();
+  }
+
+ private:
+  struct Window {
+    AlignedBuffer buffer;
+    uint64_t offset;
+    size_t len;
+
+    bool Contains(uint64_t pos) const {
+      return pos >= offset && pos < offset + len;
+    }
+  };
+
+  enum PrefetchState {
+    kIdle,     // no prefetch outstanding
+    kQueued,   // job scheduled on the pool, not started
+    kReading,  // job reading into the other window
+    kDone,     // other window filled, result in prefetch_status_
+  };
+
+  static void BGPrefetch(void* arg) {
+    auto* self = reinterpret_cast<const AsyncReadaheadRandomAccessFile*>(arg);
+    TEST_SYNC_POINT("AsyncReadaheadRandomAccessFile::BGPrefetch");
+    Window* window;
+    uint64_t offset;
+    {
+      std::lock_guard<std::mutex> lk(self->lock_);
+      assert(self->prefetch_state_ == kQueued);
+      self->prefetch_state_ = kReading;
+      window = &self->windows_[1 - self->current_];
+      offset = self->prefetch_offset_;
+    }
+    // The reader leaves the other window alone until the state is kDone.
+    Status s = self->ReadWindow(window, offset, self->readahead_size_);
+    std::lock_guard<std::mutex> lk(self->lock_);
+    self->prefetch_status_ = s;
+    self->prefetch_state_ = kDone;
+    self->prefetch_cv_.notify_all();
+  }
+
+  // Fill windows_[current_] with the readahead window containing `pos`,
+  // using the prefetched window if it has it.
+  // REQUIRES: lock_ held
+  Status MakeCurrentWindowContain(uint64_t pos,
+                                  std::unique_lock<std::mutex>* lk) const {
+    bool prefetched = prefetch_state_ != kIdle && pos >= prefetch_offset_ &&
+                      pos < prefetch_offset_ + readahead_size_;
+    Status s = FinishPrefetch(lk);
+    if (prefetched && s.ok() && windows_[1 - current_].Contains(pos)) {
+      current_ = 1 - current_;
+    } else {
+      // A failed prefetch is retried here, which surfaces its error.
+      s = ReadWindow(&windows_[current_],
+                     TruncateToPageBoundary(alignment_, pos), readahead_size_);
+    }
+    if (s.ok() && windows_[current_].len == readahead_size_) {
+      // Not at the end of file yet; read the next window in the background.
+      prefetch_offset_ = windows_[current_].offset + readahead_size_;
+      prefetch_state_ = kQueued;
+      prefetch_pool_->Schedule(&BGPrefetch, const_cast<void*>(Tag()), Tag(),
+                               nullptr);
+    }
+    return s;
+  }
+
+  // Unschedule the outstanding prefetch if it has not started, otherwise wait
+  // for it to finish. Returns the status of the prefetch read, if any.
+  // REQUIRES: lock_ held
+  Status FinishPrefetch(std::unique_lock<std::mutex>* lk) const {
+    if (prefetch_state_ == kQueued && prefetch_pool_->UnSchedule(Tag()) > 0) {
+      prefetch_state_ = kIdle;
+      windows_[1 - current_].len = 0;
+      return Status::OK();
+    }
+    if (prefetch_state_ != kIdle) {
+      IOSTATS_TIMER_GUARD(prefetch_wait_nanos);
+      prefetch_cv_.wait(*lk, [this] { return prefetch_state_ == kDone; });
+      prefetch_state_ = kIdle;
+      return prefetch_status_;
+    }
+    return Status::OK();
+  }
+
+  Status ReadWindow(Window* window, uint64_t offset, size_t n) const {
+    if (n > window->buffer.Capacity()) {
+      n = window->buffer.Capacity();
+    }
+    assert(IsFileSectorAligned(offset, alignment_));
+    assert(IsFileSectorAligned(n, alignment_));
+    Slice result;
+    window->len = 0;
+    Status s = file_->Read(offset, n, &result, window->buffer.BufferStart());
+    if (s.ok()) {
+      if (result.data() != window->buffer.BufferStart()) {
+        memcpy(window->buffer.BufferStart(), result.data(), result.size());
+      }
+      window->offset = offset;
+      window->len = result.size();
+    }
+    return s;
+  }
+
+  void* Tag() const {
+    return const_cast<AsyncReadaheadRandomAccessFile*>(this);
+  }
+
+  std::unique_ptr<RandomAccessFile> file_;
+  const size_t alignment_;
+  const size_t readahead_size_;
+  ThreadPoolImpl* prefetch_pool_;
+
+  mutable std::mutex lock_;
+  mutable std::condition_variable prefetch_cv_;
+  mutable Window windows_[2];
+  // Index of the window reads are served from.
+  mutable int current_;
+  mutable PrefetchState prefetch_state_;
+  // Offset of the window being prefetched.
+  mutable uint64_t prefetch_offset_;
+  mutable Status prefetch_status_;
+};
 }  // namespace
 
 Status FilePrefetchBuffer::Prefetch(RandomAccessFileReader* reader,
@@ -632,9 +845,16 @@ bool FilePrefetchBuffer::TryReadFromCache(uint64_t offset, size_t n,
 }
 
 std::unique_ptr<RandomAccessFile> NewReadaheadRandomAccessFile(
-    std::unique_ptr<RandomAccessFile>&& file, size_t readahead_size) {
-  std::unique_ptr<RandomAccessFile> result(
-    new ReadaheadRandomAccessFile(std::move(file), readahead_size));
+    std::unique_ptr<RandomAccessFile>&& file, size_t readahead_size,
+    ThreadPoolImpl* prefetch_pool) {
+  std::unique_ptr<RandomAccessFile> result;
+  if (prefetch_pool != nullptr) {
+    result.reset(new AsyncReadaheadRandomAccessFile(
+        std::move(file), readahead_size, prefetch_pool));
+  } else {
+    result.reset(
+        new ReadaheadRandomAccessFile(std::move(file), readahead_size));
+  }
   return result;
 }
 
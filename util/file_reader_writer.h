@@ -18,9 +18,13 @@ namespace rocksdb {
 
 class Statistics;
 class HistogramImpl;
+class ThreadPoolImpl;
 
+// If `prefetch_pool` is not nullptr, the next readahead window is read on it
+// while the current one is consumed.
 std::unique_ptr<RandomAccessFile> NewReadaheadRandomAccessFile(
-  std::unique_ptr<RandomAccessFile>&& file, size_t readahead_size);
+    std::unique_ptr<RandomAccessFile>&& file, size_t readahead_size,
+    ThreadPoolImpl* prefetch_pool = nullptr);
 
 class SequentialFileReader {
  private:
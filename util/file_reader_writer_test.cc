@@ -9,6 +9,7 @@
 #include "util/random.h"
 #include "util/testharness.h"
 #include "util/testutil.h"
+#include "util/threadpool_imp.h"
 
 namespace rocksdb {
 
@@ -217,16 +218,26 @@ TEST_F(WritableFileWriterTest, AppendStatusReturn) {
 
 class ReadaheadRandomAccessFileTest
     : public testing::Test,
-      public testing::WithParamInterface<size_t> {
+      public testing::WithParamInterface<std::tuple<size_t, bool>> {
  public:
   static std::vector<size_t> GetReadaheadSizeList() {
     return {1lu << 12, 1lu << 16};
   }
   virtual void SetUp() override {
-    readahead_size_ = GetParam();
+    readahead_size_ = std::get<0>(GetParam());
+    if (std::get<1>(GetParam())) {
+      prefetch_pool_.reset(new ThreadPoolImpl());
+      prefetch_pool_->SetBackgroundThreads(1);
+    }
     scratch_.reset(new char[2 * readahead_size_]);
     ResetSourceStr();
   }
+  virtual void TearDown() override {
+    test_read_holder_.reset();
+    if (prefetch_pool_ != nullptr) {
+      prefetch_pool_->JoinAllThreads();
+    }
+  }
   ReadaheadRandomAccessFileTest() : control_contents_() {}
   std::string Read(uint64_t offset, size_t n) {
     Slice result;
@@ -240,13 +251,14 @@ class ReadaheadRandomAccessFileTest
     write_holder->Flush();
     auto read_holder = std::unique_ptr<RandomAccessFile>(
         new test::StringSource(control_contents_));
-    test_read_holder_ =
-        NewReadaheadRandomAccessFile(std::move(read_holder), readahead_size_);
+    test_read_holder_ = NewReadaheadRandomAccessFile(
+        std::move(read_holder), readahead_size_, prefetch_pool_.get());
   }
   size_t GetReadaheadSize() const { return readahead_size_; }
 
  private:
   size_t readahead_size_;
+  std::unique_ptr<ThreadPoolImpl> prefetch_pool_;
   Slice control_contents_;
   std::unique_ptr<RandomAccessFile> test_read_holder_;
   std::unique_ptr<char[]> scratch_;
@@ -303,19 +315,54 @@ TEST_P(ReadaheadRandomAccessFileTest, NExceedReadaheadTest) {
   }
 }
 
+TEST_P(ReadaheadRandomAccessFileTest, SequentialReadTest) {
+  Random rng(301);
+  size_t strLen = 8 * GetReadaheadSize() +
+                  rng.Uniform(static_cast<int>(GetReadaheadSize()));
+  std::string str =
+      test::RandomHumanReadableString(&rng, static_cast<int>(strLen));
+  ResetSourceStr(str);
+  size_t offset = 0;
+  while (offset < strLen) {
+    size_t n = 1 + rng.Uniform(static_cast<int>(GetReadaheadSize() / 4));
+    ASSERT_EQ(str.substr(offset, std::min(n, str.size() - offset)),
+              Read(offset, n));
+    offset += n;
+  }
+  ASSERT_EQ("", Read(offset, 1));
+}
+
 INSTANTIATE_TEST_CASE_P(
     EmptySourceStrTest, ReadaheadRandomAccessFileTest,
-    ::testing::ValuesIn(ReadaheadRandomAccessFileTest::GetReadaheadSizeList()));
+    ::testing::Combine(
+        ::testing::ValuesIn(
+            ReadaheadRandomAccessFileTest::GetReadaheadSizeList()),
+        ::testing::Bool()));
 INSTANTIATE_TEST_CASE_P(
     SourceStrLenLessThanReadaheadSizeTest, ReadaheadRandomAccessFileTest,
-    ::testing::ValuesIn(ReadaheadRandomAccessFileTest::GetReadaheadSizeList()));
+    ::testing::Combine(
+        ::testing::ValuesIn(
+            ReadaheadRandomAccessFileTest::GetReadaheadSizeList()),
+        ::testing::Bool()));
 INSTANTIATE_TEST_CASE_P(
     SourceStrLenCanBeGreaterThanReadaheadSizeTest,
     ReadaheadRandomAccessFileTest,
-    ::testing::ValuesIn(ReadaheadRandomAccessFileTest::GetReadaheadSizeList()));
+    ::testing::Combine(
+        ::testing::ValuesIn(
+            ReadaheadRandomAccessFileTest::GetReadaheadSizeList()),
+        ::testing::Bool()));
 INSTANTIATE_TEST_CASE_P(
     NExceedReadaheadTest, ReadaheadRandomAccessFileTest,
-    ::testing::ValuesIn(ReadaheadRandomAccessFileTest::GetReadaheadSizeList()));
+    ::testing::Combine(
+        ::testing::ValuesIn(
+            ReadaheadRandomAccessFileTest::GetReadaheadSizeList()),
+        ::testing::Bool()));
+INSTANTIATE_TEST_CASE_P(
+    SequentialReadTest, ReadaheadRandomAccessFileTest,
+    ::testing::Combine(
+        ::testing::ValuesIn(
+            ReadaheadRandomAccessFileTest::GetReadaheadSizeList()),
+        ::testing::Bool()));
 
 }  // namespace rocksdb
 
@@ -0,0 +1,191 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <stdint.h>
+#include <string.h>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "rocksdb/memory_allocator.h"
+#include "util/memory_allocator.h"
+#include "util/random.h"
+#include "util/testharness.h"
+
+namespace rocksdb {
+
+class MemoryAllocatorTest : public testing::Test {};
+
+TEST_F(MemoryAllocatorTest, ReusesFreedBlocks) {
+  auto allocator = NewPooledMemoryAllocator();
+  void* p = allocator->Allocate(4000);
+  memset(p, 'a', 4000);
+  // Rounded up to the size class
+  ASSERT_EQ(4096U, allocator->UsableSize(p, 4000));
+  allocator->Deallocate(p);
+  // Same size class
+  void* q = allocator->Allocate(3900);
+  ASSERT_EQ(p, q);
+  // Another size class
+  void* r = allocator->Allocate(5000);
+  ASSERT_NE(p, r);
+  ASSERT_EQ(5120U, allocator->UsableSize(r, 5000));
+  allocator->Deallocate(q);
+  allocator->Deallocate(r);
+
+  // Small allocations share the smallest class
+  p = allocator->Allocate(1);
+  ASSERT_EQ(256U, allocator->UsableSize(p, 1));
+  allocator->Deallocate(p);
+  ASSERT_EQ(p, allocator->Allocate(200));
+  allocator->Deallocate(p);
+}
+
+TEST_F(MemoryAllocatorTest, LargeAllocations) {
+  PooledMemoryAllocatorOptions options;
+  options.max_pooled_size = 64 << 10;
+  auto allocator = NewPooledMemoryAllocator(options);
+  void* p = allocator->Allocate((64 << 10) + 1);
+  ASSERT_EQ((64U << 10) + 1, allocator->UsableSize(p, (64 << 10) + 1));
+  memset(p, 'a', (64 << 10) + 1);
+  allocator->Deallocate(p);
+
+  p = allocator->Allocate(64 << 10);
+  ASSERT_EQ(64U << 10, allocator->UsableSize(p, 64 << 10));
+  allocator->Deallocate(p);
+}
+
+TEST_F(MemoryAllocatorTest, MaxFreeBytes) {
+  PooledMemoryAllocatorOptions options;
+  options.max_free_bytes = 2 * 4096;
+  auto allocator = NewPooledMemoryAllocator(options);
+  std::vector<void*> blocks;
+  for (int i = 0; i < 4; i++) {
+    blocks.push_back(allocator->Allocate(4096));
+  }
+  for (void* p : blocks) {
+    allocator->Deallocate(p);
+  }
+  // Only the first two blocks were kept
+  std::set<void*> kept(blocks.begin(), blocks.begin() + 2);
+  for (int i = 0; i < 2; i++) {
+    void* p = allocator->Allocate(4096);
+    ASSERT_EQ(1U, kept.erase(p));
+  }
+}
+
+TEST_F(MemoryAllocatorTest, TransparentHugePages) {
+  PooledMemoryAllocatorOptions options;
+  options.use_transparent_huge_pages = true;
+  auto allocator = NewPooledMemoryAllocator(options);
+  Random rnd(301);
+  std::vector<std::pair<char*, size_t>> blocks;
+  // More than one chunk
+  for (int i = 0; i < 1000; i++) {
+    size_t size = 1 + rnd.Uniform(16 << 10);
+    char* p = static_cast<char*>(allocator->Allocate(size));
+    ASSERT_EQ(0U, reinterpret_cast<uintptr_t>(p) % 16);
+    memset(p, static_cast<char>(i), size);
+    blocks.emplace_back(p, size);
+  }
+  for (size_t i = 0; i < blocks.size(); i++) {
+    ASSERT_EQ(static_cast<char>(i), blocks[i].first[blocks[i].second - 1]);
+    allocator->Deallocate(blocks[i].first);
+  }
+  // Blocks larger than a chunk
+  void* p = allocator->Allocate(900 << 10);
+  memset(p, 'a', 900 << 10);
+  allocator->Deallocate(p);
+  ASSERT_EQ(p, allocator->Allocate(900 << 10));
+  allocator->Deallocate(p);
+}
+
+TEST_F(MemoryAllocatorTest, TransparentHugePagesMaxFreeBytes) {
+  PooledMemoryAllocatorOptions options;
+  options.use_transparent_huge_pages = true;
+  options.max_free_bytes = 0;
+  auto allocator = NewPooledMemoryAllocator(options);
+  // 31 blocks fit in a 2MB chunk, so these take four chunks
+  std::vector<void*> blocks;
+  for (int i = 0; i < 100; i++) {
+    blocks.push_back(allocator->Allocate(64 << 10));
+  }
+  for (void* p : blocks) {
+    allocator->Deallocate(p);
+  }
+  // The first three chunks were returned to the system, so only the blocks
+  // of the last one are reused
+  std::set<void*> last_chunk(blocks.begin() + 93, blocks.end());
+  blocks.clear();
+  for (int i = 0; i < 7; i++) {
+    void* p = allocator->Allocate(64 << 10);
+    ASSERT_EQ(1U, last_chunk.erase(p));
+    memset(p, 'a', 64 << 10);
+    blocks.push_back(p);
+  }
+  for (void* p : blocks) {
+    allocator->Deallocate(p);
+  }
+}
+
+TEST_F(MemoryAllocatorTest, AllocateBlock) {
+  auto allocator = NewPooledMemoryAllocator();
+  CacheAllocationPtr block = AllocateBlock(1000, allocator.get());
+  ASSERT_EQ(allocator.get(), block.get_deleter().allocator);
+  char* p = block.get();
+  block.reset();
+  // Freed to the allocator
+  block = AllocateBlock(1000, allocator.get());
+  ASSERT_EQ(p, block.get());
+
+  CacheAllocationPtr plain = AllocateBlock(1000, nullptr);
+  ASSERT_EQ(nullptr, plain.get_deleter().allocator);
+}
+
+TEST_F(MemoryAllocatorTest, MultiThreaded) {
+  for (bool use_huge_pages : {false, true}) {
+    PooledMemoryAllocatorOptions options;
+    options.max_free_bytes = 1 << 20;
+    options.use_transparent_huge_pages = use_huge_pages;
+    auto allocator = NewPooledMemoryAllocator(options);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++) {
+      threads.emplace_back([&allocator, t]() {
+        Random rnd(301 + t);
+        std::vector<std::pair<char*, size_t>> blocks;
+        for (int i = 0; i < 10000; i++) {
+          if (!blocks.empty() && rnd.OneIn(2)) {
+            size_t idx = rnd.Uniform(static_cast<int>(blocks.size()));
+            auto block = blocks[idx];
+            for (size_t j = 0; j < block.second; j += 97) {
+              ASSERT_EQ(static_cast<char>(t), block.first[j]);
+            }
+            allocator->Deallocate(block.first);
+            blocks[idx] = blocks.back();
+            blocks.pop_back();
+          } else {
+            size_t size = 1 + rnd.Uniform(32 << 10);
+            char* p = static_cast<char*>(allocator->Allocate(size));
+            memset(p, static_cast<char>(t), size);
+            blocks.emplace_back(p, size);
+          }
+        }
+        for (auto& block : blocks) {
+          allocator->Deallocate(block.first);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
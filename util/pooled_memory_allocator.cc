@@ -0,0 +1,270 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+
+#include <stdint.h>
+#include <stdlib.h>
+#ifndef OS_WIN
+#include <sys/mman.h>
+#endif
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/memory_allocator.h"
+#include "util/mutexlock.h"
+
+namespace rocksdb {
+
+namespace {
+// Precedes every block. Keeps the block 16-byte aligned.
+struct BlockHeader {
+  uint32_t size_class;  // kUnpooled for blocks that come from malloc()
+  uint32_t chunk;       // Index of the chunk the block was carved from
+  uint64_t size;        // Usable size
+};
+static_assert(sizeof(BlockHeader) == 16, "BlockHeader must be 16 bytes");
+
+const uint32_t kUnpooled = std::numeric_limits<uint32_t>::max();
+const size_t kMinClassSize = 256;
+const size_t kHugePageSize = 2 << 20;
+
+class PooledMemoryAllocator : public MemoryAllocator {
+ public:
+  explicit PooledMemoryAllocator(const PooledMemoryAllocatorOptions& options)
+      : options_(options),
+#ifdef OS_WIN
+        use_huge_pages_(false),
+#else
+        use_huge_pages_(options.use_transparent_huge_pages),
+#endif
+        free_bytes_(0),
+        current_chunk_(0),
+        chunk_pos_(nullptr),
+        chunk_remaining_(0) {
+    // Four classes per power of two: 256, 320, 384, 448, 512, 640, ...
+    for (size_t base = kMinClassSize;
+         class_sizes_.empty() || class_sizes_.back() < options_.max_pooled_size;
+         base *= 2) {
+      for (size_t i = 0; i < 4; i++) {
+        class_sizes_.push_back(base + i * base / 4);
+      }
+    }
+    free_lists_.resize(class_sizes_.size());
+    for (auto& free_list : free_lists_) {
+      free_list.reset(new FreeList());
+    }
+  }
+
+  ~PooledMemoryAllocator() {
+    if (use_huge_pages_) {
+      for (const Chunk& chunk : chunks_) {
+        free(chunk.base);
+      }
+    } else {
+      for (auto& free_list : free_lists_) {
+        for (char* block : free_list->blocks) {
+          free(block);
+        }
+      }
+    }
+  }
+
+  const char* Name() const override { return "PooledMemoryAllocator"; }
+
+  void* Allocate(size_t size) override {
+    if (size > options_.max_pooled_size) {
+      char* block = static_cast<char*>(malloc(sizeof(BlockHeader) + size));
+      if (block == nullptr) {
+        return nullptr;
+      }
+      return InitHeader(block, kUnpooled, 0, size);
+    }
+    const uint32_t size_class = SizeClass(size);
+    if (use_huge_pages_) {
+      return AllocateFromChunk(size_class);
+    }
+    FreeList* free_list = free_lists_[size_class].get();
+    {
+      MutexLock l(&free_list->mutex);
+      if (!free_list->blocks.empty()) {
+        char* block = free_list->blocks.back();
+        free_list->blocks.pop_back();
+        free_bytes_ -= class_sizes_[size_class];
+        return block + sizeof(BlockHeader);
+      }
+    }
+    const size_t block_size = sizeof(BlockHeader) + class_sizes_[size_class];
+    char* block = static_cast<char*>(malloc(block_size));
+    if (block == nullptr) {
+      return nullptr;
+    }
+    return InitHeader(block, size_class, 0, class_sizes_[size_class]);
+  }
+
+  void Deallocate(void* p) override {
+    char* block = static_cast<char*>(p) - sizeof(BlockHeader);
+    const BlockHeader* header = reinterpret_cast<const BlockHeader*>(block);
+    if (header->size_class == kUnpooled) {
+      free(block);
+      return;
+    }
+    assert(header->size_class < class_sizes_.size());
+    if (use_huge_pages_) {
+      DeallocateToChunk(block);
+      return;
+    }
+    const size_t size = class_sizes_[header->size_class];
+    if (free_bytes_.load(std::memory_order_relaxed) + size >
+        options_.max_free_bytes) {
+      free(block);
+      return;
+    }
+    FreeList* free_list = free_lists_[header->size_class].get();
+    MutexLock l(&free_list->mutex);
+    free_list->blocks.push_back(block);
+    free_bytes_ += size;
+  }
+
+  size_t UsableSize(void* p, size_t /*allocation_size*/) const override {
+    const char* block = static_cast<const char*>(p) - sizeof(BlockHeader);
+    return static_cast<size_t>(
+        reinterpret_cast<const BlockHeader*>(block)->size);
+  }
+
+ private:
+  // Free blocks of one size class. Without huge pages each list has its own
+  // mutex; with them, all lists are protected by chunk_mutex_.
+  struct FreeList {
+    port::Mutex mutex;
+    std::vector<char*> blocks;
+  };
+
+  struct Chunk {
+    char* base;  // nullptr once the chunk was returned to the system
+    // Blocks carved from the chunk that are not in a free list
+    size_t live_blocks;
+  };
+
+  uint32_t SizeClass(size_t size) const {
+    auto it = std::lower_bound(class_sizes_.begin(), class_sizes_.end(), size);
+    assert(it != class_sizes_.end());
+    return static_cast<uint32_t>(it - class_sizes_.begin());
+  }
+
+  static void* InitHeader(char* block, uint32_t size_class, uint32_t chunk,
+                          size_t size) {
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(block);
+    header->size_class = size_class;
+    header->chunk = chunk;
+    header->size = size;
+    return block + sizeof(BlockHeader);
+  }
+
+  // Reuses a free block of the class, or carves one out of the current
+  // chunk, or out of a new chunk if it does not fit. The rest of the old
+  // chunk is left unused.
+  void* AllocateFromChunk(uint32_t size_class) {
+#ifdef OS_WIN
+    (void)size_class;
+    return nullptr;
+#else
+    MutexLock l(&chunk_mutex_);
+    FreeList* free_list = free_lists_[size_class].get();
+    if (!free_list->blocks.empty()) {
+      char* block = free_list->blocks.back();
+      free_list->blocks.pop_back();
+      free_bytes_ -= class_sizes_[size_class];
+      chunks_[reinterpret_cast<BlockHeader*>(block)->chunk].live_blocks++;
+      return block + sizeof(BlockHeader);
+    }
+    const size_t block_size = sizeof(BlockHeader) + class_sizes_[size_class];
+    if (chunk_remaining_ < block_size) {
+      // Round up to whole huge pages
+      size_t chunk_size =
+          (std::max(block_size, kHugePageSize) + kHugePageSize - 1) &
+          ~(kHugePageSize - 1);
+      void* chunk = nullptr;
+      if (posix_memalign(&chunk, kHugePageSize, chunk_size) != 0) {
+        return nullptr;
+      }
+#if defined(OS_LINUX) && defined(MADV_HUGEPAGE)
+      // Only advice; the kernel may still use small pages
+      madvise(chunk, chunk_size, MADV_HUGEPAGE);
+#endif
+      const Chunk new_chunk = {static_cast<char*>(chunk), 0};
+      if (!unused_chunk_slots_.empty()) {
+        current_chunk_ = unused_chunk_slots_.back();
+        unused_chunk_slots_.pop_back();
+        chunks_[current_chunk_] = new_chunk;
+      } else {
+        current_chunk_ = static_cast<uint32_t>(chunks_.size());
+        chunks_.push_back(new_chunk);
+      }
+      chunk_pos_ = static_cast<char*>(chunk);
+      chunk_remaining_ = chunk_size;
+    }
+    char* block = chunk_pos_;
+    chunk_pos_ += block_size;
+    chunk_remaining_ -= block_size;
+    chunks_[current_chunk_].live_blocks++;
+    return InitHeader(block, size_class, current_chunk_,
+                      class_sizes_[size_class]);
+#endif
+  }
+
+  // Puts the block in the free list of its class. Beyond max_free_bytes,
+  // returns the block's chunk to the system if none of its blocks is in use
+  // any more.
+  void DeallocateToChunk(char* block) {
+    const BlockHeader* header = reinterpret_cast<const BlockHeader*>(block);
+    MutexLock l(&chunk_mutex_);
+    free_lists_[header->size_class]->blocks.push_back(block);
+    free_bytes_ += class_sizes_[header->size_class];
+    const uint32_t chunk_index = header->chunk;
+    Chunk* chunk = &chunks_[chunk_index];
+    assert(chunk->live_blocks > 0);
+    if (--chunk->live_blocks > 0 || chunk_index == current_chunk_ ||
+        free_bytes_.load(std::memory_order_relaxed) <=
+            options_.max_free_bytes) {
+      return;
+    }
+    for (size_t i = 0; i < free_lists_.size(); i++) {
+      auto& blocks = free_lists_[i]->blocks;
+      auto it = std::remove_if(
+          blocks.begin(), blocks.end(), [chunk_index](char* b) {
+            return reinterpret_cast<BlockHeader*>(b)->chunk == chunk_index;
+          });
+      free_bytes_ -= static_cast<size_t>(blocks.end() - it) * class_sizes_[i];
+      blocks.erase(it, blocks.end());
+    }
+    free(chunk->base);
+    chunk->base = nullptr;
+    unused_chunk_slots_.push_back(chunk_index);
+  }
+
+  const PooledMemoryAllocatorOptions options_;
+  const bool use_huge_pages_;
+  std::vector<size_t> class_sizes_;
+  std::vector<std::unique_ptr<FreeList>> free_lists_;
+  std::atomic<size_t> free_bytes_;
+
+  port::Mutex chunk_mutex_;
+  std::vector<Chunk> chunks_;
+  std::vector<uint32_t> unused_chunk_slots_;
+  uint32_t current_chunk_;
+  char* chunk_pos_;
+  size_t chunk_remaining_;
+};
+}  // namespace
+
+std::shared_ptr<MemoryAllocator> NewPooledMemoryAllocator(
+    const PooledMemoryAllocatorOptions& options) {
+  return std::make_shared<PooledMemoryAllocator>(options);
+}
+
+}  // namespace rocksdb
@@ -23,6 +23,7 @@
 #include <algorithm>
 #include <atomic>
 #include <condition_variable>
+#include <iterator>
 #include <mutex>
 #include <stdlib.h>
 #include <thread>
@@ -62,7 +63,7 @@ struct ThreadPoolImpl::Impl {
   void StartBGThreads();
 
   void Submit(std::function<void()>&& schedule,
-    std::function<void()>&& unschedule, void* tag);
+    std::function<void()>&& unschedule, void* tag, double urgency = 0);
 
   int UnSchedule(void* arg);
 
@@ -110,6 +111,8 @@ private:
     void* tag = nullptr;
     std::function<void()> function;
     std::function<void()> unschedFunction;
+    // Items with a higher urgency are run first
+    double urgency = 0;
   };
 
   using BGQueue = std::deque<BGItem>;
@@ -308,7 +311,7 @@ void ThreadPoolImpl::Impl::StartBGThreads() {
 }
 
 void ThreadPoolImpl::Impl::Submit(std::function<void()>&& schedule,
-  std::function<void()>&& unschedule, void* tag) {
+  std::function<void()>&& unschedule, void* tag, double urgency) {
 
   std::lock_guard<std::mutex> lock(mu_);
 
@@ -318,11 +321,16 @@ void ThreadPoolImpl::Impl::Submit(std::function<void()>&& schedule,
 
   StartBGThreads();
 
-  // Add to priority queue
-  queue_.push_back(BGItem());
-
-  auto& item = queue_.back();
+  // Add to priority queue. The queue is kept sorted by decreasing urgency,
+  // and the new item goes behind every item of the same urgency so that
+  // equally urgent jobs still run in submission order.
+  auto pos = queue_.end();
+  while (pos != queue_.begin() && std::prev(pos)->urgency < urgency) {
+    --pos;
+  }
+  auto& item = *queue_.insert(pos, BGItem());
   item.tag = tag;
+  item.urgency = urgency;
   item.function = std::move(schedule);
   item.unschedFunction = std::move(unschedule);
 
@@ -419,7 +427,7 @@ void ThreadPoolImpl::SubmitJob(std::function<void()>&& job) {
 }
 
 void ThreadPoolImpl::Schedule(void(*function)(void* arg1), void* arg,
-  void* tag, void(*unschedFunction)(void* arg)) {
+  void* tag, void(*unschedFunction)(void* arg), double urgency) {
 
   std::function<void()> fn = [arg, function] { function(arg); };
 
@@ -429,7 +437,7 @@ void ThreadPoolImpl::Schedule(void(*function)(void* arg1), void* arg,
     unfn = std::move(uf);
   }
 
-  impl_->Submit(std::move(fn), std::move(unfn), tag);
+  impl_->Submit(std::move(fn), std::move(unfn), tag, urgency);
 }
 
 int ThreadPoolImpl::UnSchedule(void* arg) {
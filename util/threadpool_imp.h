@@ -64,9 +64,11 @@ class ThreadPoolImpl : public ThreadPool {
 
   // Schedule a job with an unschedule tag and unschedule function
   // Can be used to filter and unschedule jobs by a tag
-  // that are still in the queue and did not start running
+  // that are still in the queue and did not start running.
+  // Queued jobs with a higher urgency start first; jobs of equal
+  // urgency start in the order they were scheduled
   void Schedule(void (*function)(void* arg1), void* arg, void* tag,
-                void (*unschedFunction)(void* arg));
+                void (*unschedFunction)(void* arg), double urgency = 0);
 
   // Filter jobs that are still in a queue and match
   // the given tag. Remove them from a queue if any
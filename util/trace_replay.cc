@@ -0,0 +1,299 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "util/trace_replay.h"
+
+#include <chrono>
+#include <thread>
+
+#include "rocksdb/db.h"
+#include "rocksdb/iterator.h"
+#include "rocksdb/threadpool.h"
+#include "rocksdb/write_batch.h"
+#include "util/coding.h"
+#include "util/mutexlock.h"
+#include "util/string_util.h"
+
+namespace rocksdb {
+
+const std::string kTraceMagic = "feedcafedeadbeef";
+
+void EncodeTrace(const Trace& trace, std::string* dst) {
+  PutFixed64(dst, trace.ts);
+  dst->push_back(trace.type);
+  PutFixed32(dst, static_cast<uint32_t>(trace.payload.size()));
+  dst->append(trace.payload);
+}
+
+Status DecodeTrace(const Slice& encoded, Trace* trace) {
+  if (encoded.size() < kTraceMetadataSize) {
+    return Status::Corruption("Trace record too short");
+  }
+  trace->ts = DecodeFixed64(encoded.data());
+  trace->type = static_cast<TraceType>(encoded[kTraceTimestampSize]);
+  uint32_t payload_size =
+      DecodeFixed32(encoded.data() + kTraceTimestampSize + kTraceTypeSize);
+  if (encoded.size() != kTraceMetadataSize + payload_size) {
+    return Status::Corruption("Trace record has the wrong size");
+  }
+  trace->payload.assign(encoded.data() + kTraceMetadataSize, payload_size);
+  return Status::OK();
+}
+
+Tracer::Tracer(Env* env, const TraceOptions& trace_options,
+               std::unique_ptr<TraceWriter>&& trace_writer)
+    : env_(env),
+      trace_options_(trace_options),
+      trace_writer_(std::move(trace_writer)) {
+  WriteHeader();
+}
+
+Tracer::~Tracer() { trace_writer_.reset(); }
+
+Status Tracer::Write(WriteBatch* write_batch) {
+  if (ShouldSkipTrace()) {
+    return Status::OK();
+  }
+  Trace trace;
+  trace.ts = env_->NowMicros();
+  trace.type = kTraceWrite;
+  trace.payload = write_batch->Data();
+  return WriteTrace(trace);
+}
+
+Status Tracer::Get(uint32_t column_family_id, const Slice& key) {
+  return TraceKey(kTraceGet, column_family_id, key);
+}
+
+Status Tracer::IteratorSeek(uint32_t column_family_id, const Slice& key) {
+  return TraceKey(kTraceIteratorSeek, column_family_id, key);
+}
+
+Status Tracer::IteratorSeekForPrev(uint32_t column_family_id,
+                                   const Slice& key) {
+  return TraceKey(kTraceIteratorSeekForPrev, column_family_id, key);
+}
+
+Status Tracer::TraceKey(TraceType type, uint32_t column_family_id,
+                        const Slice& key) {
+  if (ShouldSkipTrace()) {
+    return Status::OK();
+  }
+  Trace trace;
+  trace.ts = env_->NowMicros();
+  trace.type = type;
+  PutFixed32(&trace.payload, column_family_id);
+  trace.payload.append(key.data(), key.size());
+  return WriteTrace(trace);
+}
+
+bool Tracer::ShouldSkipTrace() {
+  return trace_writer_->GetFileSize() > trace_options_.max_trace_file_size;
+}
+
+Status Tracer::WriteHeader() {
+  Trace trace;
+  trace.ts = env_->NowMicros();
+  trace.type = kTraceBegin;
+  trace.payload = kTraceMagic;
+  PutFixed32(&trace.payload, kTraceFormatVersion);
+  return WriteTrace(trace);
+}
+
+Status Tracer::WriteFooter() {
+  Trace trace;
+  trace.ts = env_->NowMicros();
+  trace.type = kTraceEnd;
+  return WriteTrace(trace);
+}
+
+Status Tracer::WriteTrace(const Trace& trace) {
+  std::string encoded_trace;
+  EncodeTrace(trace, &encoded_trace);
+  return trace_writer_->Write(Slice(encoded_trace));
+}
+
+Status Tracer::Close() {
+  Status s = WriteFooter();
+  Status close_status = trace_writer_->Close();
+  return s.ok() ? close_status : s;
+}
+
+std::string ReplayStats::ToString() const {
+  std::string out;
+  struct {
+    const char* name;
+    const HistogramImpl* hist;
+  } ops[] = {{"Write", &write_latency},
+             {"Get", &get_latency},
+             {"Seek", &seek_latency},
+             {"SeekForPrev", &seek_for_prev_latency}};
+  for (const auto& op : ops) {
+    if (op.hist->num() == 0) {
+      continue;
+    }
+    out.append(op.name);
+    out.append(" latency (micros):\n");
+    out.append(op.hist->ToString());
+  }
+  out.append("Errors: " + NumberToString(num_errors.load()) + "\n");
+  out.append("Skipped: " + NumberToString(num_skipped.load()) + "\n");
+  return out;
+}
+
+Replayer::Replayer(DB* db, const std::vector<ColumnFamilyHandle*>& handles,
+                   std::unique_ptr<TraceReader>&& reader)
+    : db_(db), env_(db->GetEnv()), trace_reader_(std::move(reader)) {
+  assert(db_ != nullptr);
+  for (ColumnFamilyHandle* cfh : handles) {
+    cf_map_[cfh->GetID()] = cfh;
+  }
+}
+
+Replayer::~Replayer() { trace_reader_.reset(); }
+
+Status Replayer::Replay(const ReplayOptions& options, ReplayStats* stats) {
+  if (options.num_threads < 1 || !(options.fast_forward > 0)) {
+    return Status::InvalidArgument(
+        "num_threads and fast_forward must be positive");
+  }
+  Trace header;
+  Status s = ReadHeader(&header);
+  if (!s.ok()) {
+    return s;
+  }
+
+  std::unique_ptr<ThreadPool> thread_pool;
+  if (options.num_threads > 1) {
+    thread_pool.reset(NewThreadPool(options.num_threads));
+  }
+
+  // Operations are issued relative to the beginning of the trace
+  const uint64_t trace_start = header.ts;
+  const uint64_t replay_start = env_->NowMicros();
+  while (true) {
+    Trace trace;
+    s = ReadTrace(&trace);
+    if (!s.ok()) {
+      break;
+    }
+    if (trace.type == kTraceEnd) {
+      break;
+    }
+    uint64_t offset = trace.ts > trace_start ? trace.ts - trace_start : 0;
+    uint64_t due = replay_start + static_cast<uint64_t>(
+                                      offset / options.fast_forward);
+    uint64_t now = env_->NowMicros();
+    if (due > now) {
+      std::this_thread::sleep_for(std::chrono::microseconds(due - now));
+    }
+    if (thread_pool != nullptr) {
+      std::shared_ptr<Trace> job_trace = std::make_shared<Trace>();
+      *job_trace = std::move(trace);
+      thread_pool->SubmitJob(
+          [this, job_trace, stats]() { Execute(*job_trace, stats); });
+    } else {
+      Execute(trace, stats);
+    }
+  }
+  if (thread_pool != nullptr) {
+    thread_pool->WaitForJobsAndJoinAllThreads();
+  }
+  // The end of the trace, or a trace that was not closed cleanly
+  if (s.IsIncomplete()) {
+    s = Status::OK();
+  }
+  return s;
+}
+
+void Replayer::Execute(const Trace& trace, ReplayStats* stats) {
+  HistogramImpl* hist = nullptr;
+  Status s;
+  uint64_t start = env_->NowMicros();
+  if (trace.type == kTraceWrite) {
+    WriteBatch batch(trace.payload);
+    s = db_->Write(WriteOptions(), &batch);
+    hist = stats != nullptr ? &stats->write_latency : nullptr;
+  } else if (trace.type == kTraceGet || trace.type == kTraceIteratorSeek ||
+             trace.type == kTraceIteratorSeekForPrev) {
+    Slice input(trace.payload);
+    uint32_t cf_id = 0;
+    if (!GetFixed32(&input, &cf_id)) {
+      s = Status::Corruption("Trace record without column family");
+    } else if (cf_map_.find(cf_id) == cf_map_.end()) {
+      if (stats != nullptr) {
+        stats->num_skipped++;
+      }
+      return;
+    } else {
+      ColumnFamilyHandle* cfh = cf_map_[cf_id];
+      if (trace.type == kTraceGet) {
+        std::string value;
+        s = db_->Get(ReadOptions(), cfh, input, &value);
+        hist = stats != nullptr ? &stats->get_latency : nullptr;
+      } else {
+        std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions(), cfh));
+        if (trace.type == kTraceIteratorSeek) {
+          iter->Seek(input);
+          hist = stats != nullptr ? &stats->seek_latency : nullptr;
+        } else {
+          iter->SeekForPrev(input);
+          hist = stats != nullptr ? &stats->seek_for_prev_latency : nullptr;
+        }
+        s = iter->status();
+      }
+    }
+  } else {
+    // Unknown operations from newer trace formats are skipped
+    if (stats != nullptr) {
+      stats->num_skipped++;
+    }
+    return;
+  }
+  uint64_t elapsed = env_->NowMicros() - start;
+  if (stats != nullptr) {
+    if (!s.ok() && !s.IsNotFound()) {
+      stats->num_errors++;
+    }
+    if (hist != nullptr) {
+      MutexLock l(&stats_mutex_);
+      hist->Add(elapsed);
+    }
+  }
+}
+
+Status Replayer::ReadHeader(Trace* header) {
+  assert(header != nullptr);
+  Status s = ReadTrace(header);
+  if (!s.ok()) {
+    return s;
+  }
+  if (header->type != kTraceBegin) {
+    return Status::Corruption("Corrupted trace file. Incorrect header.");
+  }
+  if (header->payload.size() < kTraceMagic.size() + sizeof(uint32_t) ||
+      header->payload.compare(0, kTraceMagic.size(), kTraceMagic) != 0) {
+    return Status::Corruption("Corrupted trace file. Incorrect magic.");
+  }
+  uint32_t version =
+      DecodeFixed32(header->payload.data() + kTraceMagic.size());
+  if (version > kTraceFormatVersion) {
+    return Status::NotSupported("Unknown trace format version " +
+                                NumberToString(version));
+  }
+  return Status::OK();
+}
+
+Status Replayer::ReadTrace(Trace* trace) {
+  assert(trace != nullptr);
+  std::string encoded_trace;
+  Status s = trace_reader_->Read(&encoded_trace);
+  if (!s.ok()) {
+    return s;
+  }
+  return DecodeTrace(encoded_trace, trace);
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,156 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "monitoring/histogram.h"
+#include "port/port.h"
+#include "rocksdb/env.h"
+#include "rocksdb/options.h"
+#include "rocksdb/trace_reader_writer.h"
+
+namespace rocksdb {
+
+class ColumnFamilyHandle;
+class DB;
+class WriteBatch;
+
+// A trace is a sequence of records, each passed to one TraceWriter::Write():
+//    timestamp: fixed64 (Env::NowMicros())
+//    type: uint8 (TraceType)
+//    payload size: fixed32
+//    payload: char[payload size]
+// The first record is kTraceBegin, whose payload is kTraceMagic followed by
+// the fixed32 trace format version, and the last one is kTraceEnd.
+// kTraceWrite records hold the contents of the WriteBatch; kTraceGet,
+// kTraceIteratorSeek and kTraceIteratorSeekForPrev records hold the fixed32
+// column family ID followed by the key.
+extern const std::string kTraceMagic;
+const unsigned int kTraceTimestampSize = 8;
+const unsigned int kTraceTypeSize = 1;
+const unsigned int kTracePayloadLengthSize = 4;
+const unsigned int kTraceMetadataSize =
+    kTraceTimestampSize + kTraceTypeSize + kTracePayloadLengthSize;
+const uint32_t kTraceFormatVersion = 1;
+
+enum TraceType : char {
+  kTraceBegin = 1,
+  kTraceEnd = 2,
+  kTraceWrite = 3,
+  kTraceGet = 4,
+  kTraceIteratorSeek = 5,
+  kTraceIteratorSeekForPrev = 6,
+  // Block cache accesses, see util/block_cache_tracer.h
+  kBlockTraceIndexBlock = 7,
+  kBlockTraceFilterBlock = 8,
+  kBlockTraceDataBlock = 9,
+  // All trace types should be added before kTraceMax
+  kTraceMax,
+};
+
+struct Trace {
+  uint64_t ts = 0;
+  TraceType type = kTraceMax;
+  std::string payload;
+};
+
+// Appends the encoding of trace to dst
+extern void EncodeTrace(const Trace& trace, std::string* dst);
+// Decodes one record, as returned by TraceReader::Read()
+extern Status DecodeTrace(const Slice& encoded, Trace* trace);
+
+// Tracer records the operations on a DB with a TraceWriter.
+// Not thread-safe; DBImpl serializes the calls. DBImpl also applies
+// TraceOptions::sampling_frequency before calling it, so that operations that
+// are not sampled do not wait for the other threads.
+class Tracer {
+ public:
+  Tracer(Env* env, const TraceOptions& trace_options,
+         std::unique_ptr<TraceWriter>&& trace_writer);
+  ~Tracer();
+
+  Status Write(WriteBatch* write_batch);
+  Status Get(uint32_t column_family_id, const Slice& key);
+  Status IteratorSeek(uint32_t column_family_id, const Slice& key);
+  Status IteratorSeekForPrev(uint32_t column_family_id, const Slice& key);
+
+  // Writes the kTraceEnd record and closes the TraceWriter
+  Status Close();
+
+ private:
+  // Returns true if the next operation is not recorded because the trace is
+  // full
+  bool ShouldSkipTrace();
+  Status WriteHeader();
+  Status WriteFooter();
+  Status WriteTrace(const Trace& trace);
+  Status TraceKey(TraceType type, uint32_t column_family_id,
+                  const Slice& key);
+
+  Env* env_;
+  TraceOptions trace_options_;
+  std::unique_ptr<TraceWriter> trace_writer_;
+};
+
+struct ReplayOptions {
+  // The operations are issued from this many threads. With one thread they
+  // are issued in the order of the trace. With more, each is handed to the
+  // next free thread at its time, so operations close in time may run out of
+  // order.
+  int num_threads = 1;
+
+  // Operations are issued at their traced time relative to the first
+  // operation, divided by fast_forward. A large value replays as fast as
+  // possible.
+  double fast_forward = 1.0;
+};
+
+// The latencies observed by Replayer::Replay(), in microseconds
+struct ReplayStats {
+  HistogramImpl write_latency;
+  HistogramImpl get_latency;
+  HistogramImpl seek_latency;
+  HistogramImpl seek_for_prev_latency;
+  // Operations that returned an error other than NotFound
+  std::atomic<uint64_t> num_errors{0};
+  // Operations on column families unknown to the replayer
+  std::atomic<uint64_t> num_skipped{0};
+
+  std::string ToString() const;
+};
+
+// Replayer issues the operations of a trace against a DB.
+// handles must contain a handle for each column family in the trace.
+class Replayer {
+ public:
+  Replayer(DB* db, const std::vector<ColumnFamilyHandle*>& handles,
+           std::unique_ptr<TraceReader>&& reader);
+  ~Replayer();
+
+  // Replays the whole trace, and adds the latencies to stats if it is not
+  // nullptr
+  Status Replay(const ReplayOptions& options, ReplayStats* stats);
+
+ private:
+  Status ReadHeader(Trace* header);
+  Status ReadTrace(Trace* trace);
+  // Issues one operation. Thread-safe.
+  void Execute(const Trace& trace, ReplayStats* stats);
+
+  DB* db_;
+  Env* env_;
+  std::unique_ptr<TraceReader> trace_reader_;
+  std::unordered_map<uint32_t, ColumnFamilyHandle*> cf_map_;
+  // Guards the histograms of the ReplayStats
+  port::Mutex stats_mutex_;
+};
+
+}  // namespace rocksdb
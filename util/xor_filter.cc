@@ -0,0 +1,394 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// A static XOR filter (Graf & Lemire, "Xor Filters: Faster and Smaller Than
+// Bloom and Cuckoo Filters", 2019) for full and partitioned filter blocks.
+//
+// Every key is mapped to three slots, one in each third of a table of
+// fingerprints, and the table is solved so that the XOR of the three slots
+// equals the key's fingerprint. A query is three independent loads and a
+// comparison, with no data dependent branches. With f-bit fingerprints the
+// false positive rate is 2^-f at ~1.23 * f bits per key.
+
+#include "rocksdb/filter_policy.h"
+
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "util/coding.h"
+#include "util/hash.h"
+
+namespace rocksdb {
+
+namespace {
+
+// Filter layout:
+//   [fingerprints: ceil(3 * block_length * fingerprint_bits / 8) bytes]
+//   [padding: 3 bytes, so every slot can be read with one 32-bit load]
+//   [seed: 4 bytes][block_length: 4 bytes][fingerprint_bits: 1 byte]
+//   [format marker: 1 byte]
+// fingerprint_bits == 0 denotes a filter that matches every key.
+const uint32_t kXorFilterPadding = 3;
+const uint32_t kXorFilterMetaSize = 10;
+const char kXorFilterMarker = 'X';
+const uint32_t kXorFilterMaxFingerprintBits = 24;
+// Construction with 1.23n + 32 slots fails with a probability well below
+// 1%, so a handful of seeds is always enough for distinct hashes.
+const uint32_t kXorFilterMaxAttempts = 64;
+
+inline uint64_t XorFilterHash(const Slice& key) {
+  return (static_cast<uint64_t>(Hash(key.data(), key.size(), 0xbc9f1d34))
+          << 32) |
+         Hash(key.data(), key.size(), 0x9ae16a3b);
+}
+
+inline uint64_t Rotl64(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+// Map a 32-bit value uniformly onto [0, n) without a division.
+inline uint32_t Reduce(uint32_t x, uint32_t n) {
+  return static_cast<uint32_t>((static_cast<uint64_t>(x) * n) >> 32);
+}
+
+struct XorProbe {
+  uint32_t slot[3];
+  uint32_t fingerprint;
+};
+
+inline XorProbe ComputeProbe(uint64_t hash, uint32_t seed,
+                             uint32_t block_length, uint32_t fp_mask) {
+  // Remix with the seed (murmur3 finalizer) so that a failed construction
+  // can be retried with an independent set of slots.
+  uint64_t x = hash + (seed + 1) * 0x9e3779b97f4a7c15ULL;
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+
+  XorProbe probe;
+  probe.slot[0] = Reduce(static_cast<uint32_t>(x), block_length);
+  probe.slot[1] =
+      block_length + Reduce(static_cast<uint32_t>(Rotl64(x, 21)), block_length);
+  probe.slot[2] = 2 * block_length +
+                  Reduce(static_cast<uint32_t>(Rotl64(x, 42)), block_length);
+  probe.fingerprint = static_cast<uint32_t>(x ^ (x >> 32)) & fp_mask;
+  return probe;
+}
+
+inline uint32_t FingerprintMask(uint32_t fp_bits) {
+  return (1u << fp_bits) - 1;
+}
+
+inline uint32_t GetSlot(const char* data, uint32_t index, uint32_t fp_bits,
+                        uint32_t fp_mask) {
+  const uint64_t bitpos = static_cast<uint64_t>(index) * fp_bits;
+  return (DecodeFixed32(data + bitpos / 8) >> (bitpos % 8)) & fp_mask;
+}
+
+inline void SetSlot(char* data, uint32_t index, uint32_t fp_bits,
+                    uint32_t fp_mask, uint32_t value) {
+  const uint64_t bitpos = static_cast<uint64_t>(index) * fp_bits;
+  const uint32_t shift = static_cast<uint32_t>(bitpos % 8);
+  uint32_t word = DecodeFixed32(data + bitpos / 8);
+  word &= ~(fp_mask << shift);
+  word |= value << shift;
+  EncodeFixed32(data + bitpos / 8, word);
+}
+
+uint32_t CalculateBlockLength(size_t num_entries) {
+  if (num_entries == 0) {
+    return 0;
+  }
+  return static_cast<uint32_t>((num_entries * 123 / 100 + 32) / 3 + 1);
+}
+
+uint32_t CalculateDataSize(uint32_t block_length, uint32_t fp_bits) {
+  uint64_t bits = static_cast<uint64_t>(block_length) * 3 * fp_bits;
+  return static_cast<uint32_t>((bits + 7) / 8);
+}
+
+uint32_t FingerprintBitsForBitsPerKey(int bits_per_key) {
+  if (bits_per_key <= 0) {
+    return 0;
+  }
+  // ~1.23 slots per key; round to the nearest whole fingerprint size.
+  uint32_t fp_bits = static_cast<uint32_t>(bits_per_key / 1.23 + 0.5);
+  return std::max(1u, std::min(fp_bits, kXorFilterMaxFingerprintBits));
+}
+
+class XorFilterBitsBuilder : public FilterBitsBuilder {
+ public:
+  explicit XorFilterBitsBuilder(uint32_t fp_bits) : fp_bits_(fp_bits) {
+    assert(fp_bits_ <= kXorFilterMaxFingerprintBits);
+  }
+
+  ~XorFilterBitsBuilder() {}
+
+  virtual void AddKey(const Slice& key) override {
+    uint64_t hash = XorFilterHash(key);
+    if (hash_entries_.size() == 0 || hash != hash_entries_.back()) {
+      hash_entries_.push_back(hash);
+    }
+  }
+
+  virtual Slice Finish(std::unique_ptr<const char[]>* buf) override {
+    // Peeling requires distinct hashes; keys arrive sorted so most
+    // duplicates are already gone, but prefixes may repeat.
+    std::sort(hash_entries_.begin(), hash_entries_.end());
+    hash_entries_.erase(
+        std::unique(hash_entries_.begin(), hash_entries_.end()),
+        hash_entries_.end());
+
+    uint32_t fp_bits = fp_bits_;
+    uint32_t block_length =
+        fp_bits == 0 ? 0 : CalculateBlockLength(hash_entries_.size());
+    uint32_t data_size = CalculateDataSize(block_length, fp_bits);
+    uint32_t total_size = data_size + kXorFilterPadding + kXorFilterMetaSize;
+    char* data = new char[total_size];
+    memset(data, 0, total_size);
+
+    uint32_t seed = 0;
+    if (block_length != 0) {
+      bool built = false;
+      for (; seed < kXorFilterMaxAttempts && !built; ++seed) {
+        built = Build(seed, block_length, data);
+      }
+      if (built) {
+        --seed;
+      } else {
+        // Cannot happen with distinct 64-bit hashes; degrade to a filter
+        // that matches everything rather than failing the table.
+        memset(data, 0, total_size);
+        fp_bits = 0;
+        block_length = 0;
+        data_size = 0;
+        total_size = kXorFilterPadding + kXorFilterMetaSize;
+      }
+    }
+
+    char* meta = data + data_size + kXorFilterPadding;
+    EncodeFixed32(meta, seed);
+    EncodeFixed32(meta + 4, block_length);
+    meta[8] = static_cast<char>(fp_bits);
+    meta[9] = kXorFilterMarker;
+
+    const char* const_data = data;
+    buf->reset(const_data);
+    hash_entries_.clear();
+
+    return Slice(data, total_size);
+  }
+
+  virtual int CalculateNumEntry(const uint32_t space) override {
+    if (fp_bits_ == 0) {
+      return static_cast<int>(space);
+    }
+    uint32_t overhead = kXorFilterPadding + kXorFilterMetaSize;
+    if (space <= overhead) {
+      return 0;
+    }
+    uint64_t slots =
+        static_cast<uint64_t>(space - overhead) * 8 / fp_bits_;
+    // Inverse of CalculateBlockLength, then step down to the exact fit.
+    int n = static_cast<int>(slots * 100 / 123 + 1);
+    while (n > 0 && CalculateDataSize(CalculateBlockLength(n), fp_bits_) +
+                            overhead >
+                        space) {
+      n--;
+    }
+    return n;
+  }
+
+ private:
+  // Try to solve the fingerprint table for the given seed. On success the
+  // fingerprints are written to data and true is returned.
+  bool Build(uint32_t seed, uint32_t block_length, char* data) {
+    const uint32_t num_slots = 3 * block_length;
+    const uint32_t fp_mask = FingerprintMask(fp_bits_);
+    std::vector<uint64_t> slot_xor(num_slots, 0);
+    std::vector<uint32_t> slot_count(num_slots, 0);
+    for (uint64_t hash : hash_entries_) {
+      XorProbe probe = ComputeProbe(hash, seed, block_length, fp_mask);
+      for (int j = 0; j < 3; j++) {
+        slot_xor[probe.slot[j]] ^= hash;
+        slot_count[probe.slot[j]]++;
+      }
+    }
+
+    // Peel: repeatedly remove a key that is the only one in some slot.
+    std::vector<uint32_t> queue;
+    for (uint32_t i = 0; i < num_slots; i++) {
+      if (slot_count[i] == 1) {
+        queue.push_back(i);
+      }
+    }
+    std::vector<std::pair<uint64_t, uint32_t>> order;
+    order.reserve(hash_entries_.size());
+    while (!queue.empty()) {
+      uint32_t i = queue.back();
+      queue.pop_back();
+      if (slot_count[i] != 1) {
+        continue;
+      }
+      uint64_t hash = slot_xor[i];
+      order.emplace_back(hash, i);
+      XorProbe probe = ComputeProbe(hash, seed, block_length, fp_mask);
+      for (int j = 0; j < 3; j++) {
+        uint32_t s = probe.slot[j];
+        slot_xor[s] ^= hash;
+        if (--slot_count[s] == 1) {
+          queue.push_back(s);
+        }
+      }
+    }
+    if (order.size() != hash_entries_.size()) {
+      return false;
+    }
+
+    // Assign in reverse peeling order; each key's own slot is still zero,
+    // so XOR-ing all three slots gives the value it needs.
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+      XorProbe probe = ComputeProbe(it->first, seed, block_length, fp_mask);
+      uint32_t value = probe.fingerprint ^
+                       GetSlot(data, probe.slot[0], fp_bits_, fp_mask) ^
+                       GetSlot(data, probe.slot[1], fp_bits_, fp_mask) ^
+                       GetSlot(data, probe.slot[2], fp_bits_, fp_mask);
+      SetSlot(data, it->second, fp_bits_, fp_mask, value);
+    }
+    return true;
+  }
+
+  uint32_t fp_bits_;
+  std::vector<uint64_t> hash_entries_;
+
+  // No Copy allowed
+  XorFilterBitsBuilder(const XorFilterBitsBuilder&);
+  void operator=(const XorFilterBitsBuilder&);
+};
+
+class XorFilterBitsReader : public FilterBitsReader {
+ public:
+  explicit XorFilterBitsReader(const Slice& contents)
+      : data_(contents.data()),
+        seed_(0),
+        block_length_(0),
+        fp_bits_(0),
+        fp_mask_(0),
+        match_all_(false) {
+    const uint32_t len = static_cast<uint32_t>(contents.size());
+    if (len < kXorFilterMetaSize + kXorFilterPadding) {
+      // Empty filter, remain same with the bloom filter
+      return;
+    }
+    const char* meta = data_ + len - kXorFilterMetaSize;
+    seed_ = DecodeFixed32(meta);
+    block_length_ = DecodeFixed32(meta + 4);
+    fp_bits_ = static_cast<unsigned char>(meta[8]);
+    // Broken or unknown filters, and filters built to match everything,
+    // are regarded as match.
+    if (meta[9] != kXorFilterMarker || fp_bits_ == 0 ||
+        fp_bits_ > kXorFilterMaxFingerprintBits ||
+        CalculateDataSize(block_length_, fp_bits_) + kXorFilterPadding +
+                kXorFilterMetaSize !=
+            len) {
+      match_all_ = true;
+      block_length_ = 0;
+      return;
+    }
+    fp_mask_ = FingerprintMask(fp_bits_);
+  }
+
+  ~XorFilterBitsReader() {}
+
+  virtual bool MayMatch(const Slice& entry) override {
+    if (match_all_) {
+      return true;
+    }
+    if (block_length_ == 0) {
+      return false;
+    }
+    XorProbe probe =
+        ComputeProbe(XorFilterHash(entry), seed_, block_length_, fp_mask_);
+    // The three loads are independent, so they are issued back to back.
+    uint32_t f0 = GetSlot(data_, probe.slot[0], fp_bits_, fp_mask_);
+    uint32_t f1 = GetSlot(data_, probe.slot[1], fp_bits_, fp_mask_);
+    uint32_t f2 = GetSlot(data_, probe.slot[2], fp_bits_, fp_mask_);
+    return (probe.fingerprint ^ f0 ^ f1 ^ f2) == 0;
+  }
+
+ private:
+  const char* data_;
+  uint32_t seed_;
+  uint32_t block_length_;
+  uint32_t fp_bits_;
+  uint32_t fp_mask_;
+  bool match_all_;
+
+  // No Copy allowed
+  XorFilterBitsReader(const XorFilterBitsReader&);
+  void operator=(const XorFilterBitsReader&);
+};
+
+class XorFilterPolicy : public FilterPolicy {
+ public:
+  XorFilterPolicy(int bits_per_key, const std::vector<int>& per_level)
+      : bits_per_key_(bits_per_key), bits_per_key_per_level_(per_level) {}
+
+  ~XorFilterPolicy() {}
+
+  virtual const char* Name() const override { return "rocksdb.XorFilter"; }
+
+  virtual void CreateFilter(const Slice* keys, int n,
+                            std::string* dst) const override {
+    XorFilterBitsBuilder builder(FingerprintBitsForBitsPerKey(bits_per_key_));
+    for (int i = 0; i < n; i++) {
+      builder.AddKey(keys[i]);
+    }
+    std::unique_ptr<const char[]> buf;
+    Slice filter = builder.Finish(&buf);
+    dst->append(filter.data(), filter.size());
+  }
+
+  virtual bool KeyMayMatch(const Slice& key,
+                           const Slice& filter) const override {
+    XorFilterBitsReader reader(filter);
+    return reader.MayMatch(key);
+  }
+
+  virtual FilterBitsBuilder* GetFilterBitsBuilder() const override {
+    return GetFilterBitsBuilderForLevel(-1);
+  }
+
+  virtual FilterBitsBuilder* GetFilterBitsBuilderForLevel(
+      int level) const override {
+    int bits_per_key = bits_per_key_;
+    if (level >= 0 && !bits_per_key_per_level_.empty()) {
+      size_t idx = std::min(static_cast<size_t>(level),
+                            bits_per_key_per_level_.size() - 1);
+      bits_per_key = bits_per_key_per_level_[idx];
+    }
+    return new XorFilterBitsBuilder(FingerprintBitsForBitsPerKey(bits_per_key));
+  }
+
+  virtual FilterBitsReader* GetFilterBitsReader(
+      const Slice& contents) const override {
+    return new XorFilterBitsReader(contents);
+  }
+
+ private:
+  const int bits_per_key_;
+  const std::vector<int> bits_per_key_per_level_;
+};
+
+}  // namespace
+
+const FilterPolicy* NewXorFilterPolicy(
+    int bits_per_key, const std::vector<int>& bits_per_key_per_level) {
+  return new XorFilterPolicy(bits_per_key, bits_per_key_per_level);
+}
+
+}  // namespace rocksdb
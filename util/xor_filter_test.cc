@@ -0,0 +1,259 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <vector>
+
+#include "rocksdb/filter_policy.h"
+#include "util/coding.h"
+#include "util/testharness.h"
+#include "util/testutil.h"
+
+namespace rocksdb {
+
+static const int kVerbose = 1;
+
+static Slice Key(int i, char* buffer) {
+  EncodeFixed32(buffer, static_cast<uint32_t>(i));
+  return Slice(buffer, sizeof(uint32_t));
+}
+
+static int NextLength(int length) {
+  if (length < 10) {
+    length += 1;
+  } else if (length < 100) {
+    length += 10;
+  } else if (length < 1000) {
+    length += 100;
+  } else {
+    length += 1000;
+  }
+  return length;
+}
+
+class XorFilterTest : public testing::Test {
+ private:
+  std::unique_ptr<const FilterPolicy> policy_;
+  std::unique_ptr<FilterBitsBuilder> bits_builder_;
+  std::unique_ptr<FilterBitsReader> bits_reader_;
+  std::unique_ptr<const char[]> buf_;
+  size_t filter_size_;
+
+ public:
+  XorFilterTest() : filter_size_(0) { ResetPolicy(NewXorFilterPolicy(10)); }
+
+  void ResetPolicy(const FilterPolicy* policy, int level = -1) {
+    policy_.reset(policy);
+    Reset(level);
+  }
+
+  void Reset(int level = -1) {
+    bits_builder_.reset(policy_->GetFilterBitsBuilderForLevel(level));
+    bits_reader_.reset(nullptr);
+    buf_.reset(nullptr);
+    filter_size_ = 0;
+  }
+
+  const FilterPolicy* policy() const { return policy_.get(); }
+
+  FilterBitsBuilder* builder() { return bits_builder_.get(); }
+
+  void Add(const Slice& s) { bits_builder_->AddKey(s); }
+
+  void Build() {
+    Slice filter = bits_builder_->Finish(&buf_);
+    bits_reader_.reset(policy_->GetFilterBitsReader(filter));
+    filter_size_ = filter.size();
+  }
+
+  size_t FilterSize() const { return filter_size_; }
+
+  bool Matches(const Slice& s) {
+    if (bits_reader_ == nullptr) {
+      Build();
+    }
+    return bits_reader_->MayMatch(s);
+  }
+
+  double FalsePositiveRate() {
+    char buffer[sizeof(int)];
+    int result = 0;
+    for (int i = 0; i < 10000; i++) {
+      if (Matches(Key(i + 1000000000, buffer))) {
+        result++;
+      }
+    }
+    return result / 10000.0;
+  }
+};
+
+TEST_F(XorFilterTest, EmptyFilter) {
+  // Empty filter is not match, same as the full bloom filter
+  ASSERT_TRUE(!Matches("hello"));
+  ASSERT_TRUE(!Matches("world"));
+}
+
+TEST_F(XorFilterTest, Small) {
+  Add("hello");
+  Add("world");
+  ASSERT_TRUE(Matches("hello"));
+  ASSERT_TRUE(Matches("world"));
+  ASSERT_TRUE(!Matches("x"));
+  ASSERT_TRUE(!Matches("foo"));
+}
+
+TEST_F(XorFilterTest, DuplicateKeys) {
+  // Keys repeat when only prefixes are added; peeling must not choke on
+  // duplicates that are not adjacent.
+  char buffer[sizeof(int)];
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < 100; i++) {
+      Add(Key(i, buffer));
+    }
+  }
+  for (int i = 0; i < 100; i++) {
+    ASSERT_TRUE(Matches(Key(i, buffer)));
+  }
+  ASSERT_LE(FalsePositiveRate(), 0.02);
+}
+
+TEST_F(XorFilterTest, VaryingLengths) {
+  char buffer[sizeof(int)];
+
+  // Count number of filters that significantly exceed the false positive rate
+  int mediocre_filters = 0;
+  int good_filters = 0;
+
+  for (int length = 1; length <= 10000; length = NextLength(length)) {
+    Reset();
+    for (int i = 0; i < length; i++) {
+      Add(Key(i, buffer));
+    }
+    Build();
+
+    // 8-bit fingerprints in ~1.23 slots per key, plus fixed overhead
+    ASSERT_LE(FilterSize(), (size_t)(length * 123 / 100 + 64)) << length;
+
+    // All added keys must match
+    for (int i = 0; i < length; i++) {
+      ASSERT_TRUE(Matches(Key(i, buffer)))
+          << "Length " << length << "; key " << i;
+    }
+
+    // Check false positive rate
+    double rate = FalsePositiveRate();
+    if (kVerbose >= 1) {
+      fprintf(stderr, "False positives: %5.2f%% @ length = %6d ; bytes = %6d\n",
+              rate * 100.0, length, static_cast<int>(FilterSize()));
+    }
+    ASSERT_LE(rate, 0.01);  // Must not be over 1%
+    if (rate > 0.006)
+      mediocre_filters++;  // Allowed, but not too often
+    else
+      good_filters++;
+  }
+  if (kVerbose >= 1) {
+    fprintf(stderr, "Filters: %d good, %d mediocre\n", good_filters,
+            mediocre_filters);
+  }
+  ASSERT_LE(mediocre_filters, good_filters / 5);
+}
+
+TEST_F(XorFilterTest, CalculateNumEntry) {
+  char buffer[sizeof(int)];
+  for (uint32_t space : {100u, 1000u, 4096u, 65536u}) {
+    Reset();
+    int n = builder()->CalculateNumEntry(space);
+    ASSERT_GT(n, 0);
+    for (int i = 0; i < n; i++) {
+      Add(Key(i, buffer));
+    }
+    Build();
+    ASSERT_LE(FilterSize(), space);
+    // The space is used almost completely
+    ASSERT_GT(FilterSize(), space * 9 / 10);
+  }
+}
+
+TEST_F(XorFilterTest, PerLevelBitsPerKey) {
+  char buffer[sizeof(int)];
+  const int kNumKeys = 10000;
+  ResetPolicy(NewXorFilterPolicy(16, {16, 10, 5, 0}));
+
+  size_t unknown_level_size = 0;
+  size_t sizes[5];
+  double rates[5];
+  for (int level = -1; level <= 4; level++) {
+    Reset(level);
+    for (int i = 0; i < kNumKeys; i++) {
+      Add(Key(i, buffer));
+    }
+    Build();
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_TRUE(Matches(Key(i, buffer)));
+    }
+    if (level >= 0) {
+      sizes[level] = FilterSize();
+      rates[level] = FalsePositiveRate();
+    } else {
+      unknown_level_size = FilterSize();
+    }
+  }
+  // Unknown level uses the default bits per key
+  ASSERT_EQ(unknown_level_size, sizes[0]);
+  ASSERT_GT(sizes[0], sizes[1]);
+  ASSERT_GT(sizes[1], sizes[2]);
+  ASSERT_LT(rates[0], rates[2]);
+  // A zero budget writes a tiny filter that matches everything, and levels
+  // past the end of the vector reuse its last entry.
+  ASSERT_LT(sizes[3], 32u);
+  ASSERT_EQ(rates[3], 1.0);
+  ASSERT_EQ(sizes[3], sizes[4]);
+}
+
+TEST_F(XorFilterTest, BlockBasedInterface) {
+  char buffer[sizeof(int)];
+  std::vector<std::string> keys;
+  for (int i = 0; i < 1000; i++) {
+    keys.push_back(Key(i, buffer).ToString());
+  }
+  std::vector<Slice> key_slices(keys.begin(), keys.end());
+
+  std::string filter = "prefix";
+  policy()->CreateFilter(&key_slices[0], static_cast<int>(key_slices.size()),
+                         &filter);
+  ASSERT_EQ("prefix", filter.substr(0, 6));
+  Slice contents(filter.data() + 6, filter.size() - 6);
+  for (const auto& key : keys) {
+    ASSERT_TRUE(policy()->KeyMayMatch(key, contents));
+  }
+  int false_positives = 0;
+  for (int i = 0; i < 10000; i++) {
+    if (policy()->KeyMayMatch(Key(i + 1000000000, buffer), contents)) {
+      false_positives++;
+    }
+  }
+  ASSERT_LE(false_positives, 100);
+}
+
+TEST_F(XorFilterTest, CorruptFilterMatches) {
+  char buffer[sizeof(int)];
+  for (int i = 0; i < 100; i++) {
+    Add(Key(i, buffer));
+  }
+  std::unique_ptr<const char[]> buf;
+  Slice filter = builder()->Finish(&buf);
+  // A truncated filter cannot be trusted and must not filter anything out
+  std::string truncated(filter.data() + 1, filter.size() - 1);
+  std::unique_ptr<FilterBitsReader> reader(
+      policy()->GetFilterBitsReader(truncated));
+  ASSERT_TRUE(reader->MayMatch("anything"));
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
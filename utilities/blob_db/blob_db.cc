@@ -36,11 +36,27 @@ typedef std::shared_ptr<BlobDBFlushBeginListener> FlushBeginListener_t;
 typedef std::shared_ptr<BlobReconcileWalFilter> ReconcileWalFilter_t;
 typedef std::shared_ptr<EvictAllVersionsCompactionListener>
     CompactionListener_t;
+typedef std::shared_ptr<BlobIndexCompactionFilterFactory>
+    RelocationFilterFactory_t;
 
 // to ensure the lifetime of the listeners
 std::vector<std::shared_ptr<EventListener>> all_blobdb_listeners;
 std::vector<ReconcileWalFilter_t> all_wal_filters;
 
+namespace {
+// Lets compactions of the column family relocate blobs. Returns false if the
+// column family has a compaction filter of its own.
+bool SetRelocationFilter(const RelocationFilterFactory_t& factory,
+                         ColumnFamilyOptions* cf_options) {
+  if (cf_options->compaction_filter != nullptr ||
+      cf_options->compaction_filter_factory != nullptr) {
+    return false;
+  }
+  cf_options->compaction_filter_factory = factory;
+  return true;
+}
+}  // namespace
+
 Status BlobDB::OpenAndLoad(const Options& options,
                            const BlobDBOptions& bdb_options,
                            const std::string& dbname, BlobDB** blob_db,
@@ -65,14 +81,26 @@ Status BlobDB::OpenAndLoad(const Options& options,
   changed_options->listeners.emplace_back(ce_listener);
   changed_options->wal_filter = rw_filter.get();
 
+  BlobDBOptions blob_db_options(bdb_options);
+  RelocationFilterFactory_t relocation_filter_factory;
+  if (blob_db_options.relocate_blobs_in_compaction) {
+    relocation_filter_factory =
+        std::make_shared<BlobIndexCompactionFilterFactory>();
+    blob_db_options.relocate_blobs_in_compaction =
+        SetRelocationFilter(relocation_filter_factory, changed_options);
+  }
+
   DBOptions db_options(*changed_options);
 
   // we need to open blob db first so that recovery can happen
-  BlobDBImpl* bdb = new BlobDBImpl(dbname, bdb_options, db_options);
+  BlobDBImpl* bdb = new BlobDBImpl(dbname, blob_db_options, db_options);
 
   fblistener->SetImplPtr(bdb);
   ce_listener->SetImplPtr(bdb);
   rw_filter->SetImplPtr(bdb);
+  if (relocation_filter_factory) {
+    relocation_filter_factory->SetImplPtr(bdb);
+  }
 
   Status s = bdb->OpenPhase1();
   if (!s.ok()) return s;
@@ -134,11 +162,31 @@ Status BlobDB::Open(const DBOptions& db_options_input,
     all_wal_filters.push_back(rw_filter);
   }
 
+  BlobDBOptions blob_db_options(bdb_options);
+  std::vector<ColumnFamilyDescriptor> cf_descriptors(column_families);
+  RelocationFilterFactory_t relocation_filter_factory;
+  if (blob_db_options.relocate_blobs_in_compaction) {
+    relocation_filter_factory =
+        std::make_shared<BlobIndexCompactionFilterFactory>();
+    for (auto& cf : cf_descriptors) {
+      if (!SetRelocationFilter(relocation_filter_factory, &cf.options)) {
+        ROCKS_LOG_WARN(db_options.info_log,
+                       "Column family %s has a compaction filter; blobs "
+                       "will not be relocated in compaction",
+                       cf.name.c_str());
+        blob_db_options.relocate_blobs_in_compaction = false;
+      }
+    }
+  }
+
   // we need to open blob db first so that recovery can happen
-  BlobDBImpl* bdb = new BlobDBImpl(dbname, bdb_options, db_options);
+  BlobDBImpl* bdb = new BlobDBImpl(dbname, blob_db_options, db_options);
   fblistener->SetImplPtr(bdb);
   ce_listener->SetImplPtr(bdb);
   rw_filter->SetImplPtr(bdb);
+  if (relocation_filter_factory) {
+    relocation_filter_factory->SetImplPtr(bdb);
+  }
 
   s = bdb->OpenPhase1();
   if (!s.ok()) {
@@ -150,7 +198,7 @@ Status BlobDB::Open(const DBOptions& db_options_input,
   }
 
   DB* db = nullptr;
-  s = DB::Open(db_options, dbname, column_families, handles, &db);
+  s = DB::Open(db_options, dbname, cf_descriptors, handles, &db);
   if (!s.ok()) {
     return s;
   }
@@ -162,7 +210,7 @@ Status BlobDB::Open(const DBOptions& db_options_input,
     bdb = nullptr;
   }
   *blob_db = bdb;
-  bdb_options.Dump(db_options.info_log.get());
+  blob_db_options.Dump(db_options.info_log.get());
   return s;
 }
 
@@ -189,8 +237,12 @@ void BlobDBOptions::Dump(Logger* log) const {
                    ttl_extractor.get());
   ROCKS_LOG_HEADER(log, "                blob_db_options.compression: %d",
                    static_cast<int>(compression));
+  ROCKS_LOG_HEADER(log, "                 blob_db_options.blob_cache: %p",
+                   blob_cache.get());
   ROCKS_LOG_HEADER(log, "   blob_db_options.disable_background_tasks: %d",
                    disable_background_tasks);
+  ROCKS_LOG_HEADER(log, "blob_db_options.relocate_blobs_in_compaction: %d",
+                   relocate_blobs_in_compaction);
 }
 
 }  // namespace blob_db
@@ -10,6 +10,7 @@
 #include <functional>
 #include <string>
 #include <vector>
+#include "rocksdb/cache.h"
 #include "rocksdb/db.h"
 #include "rocksdb/status.h"
 #include "rocksdb/utilities/stackable_db.h"
@@ -76,9 +77,23 @@ struct BlobDBOptions {
   // what compression to use for Blob's
   CompressionType compression = kNoCompression;
 
+  // If non-null, uncompressed blobs read by Get, MultiGet and iterators are
+  // kept in this cache, charged by their size. It can be shared with the
+  // block cache of the base DB.
+  std::shared_ptr<Cache> blob_cache = nullptr;
+
   // Disable all background job.
   bool disable_background_tasks = false;
 
+  // If true, garbage collection of simple (non-TTL) blob files happens as
+  // part of compaction of the base DB: once GC picks a blob file, every
+  // compaction that rewrites a key whose value lives in that file copies the
+  // blob to a new blob file and writes the new blob index in its output.
+  // GC then only has to confirm that no live blobs remain, instead of
+  // rewriting them and writing their new index back to the base DB.
+  // Column families that have their own compaction filter disable this.
+  bool relocate_blobs_in_compaction = false;
+
   void Dump(Logger* log) const;
 };
 
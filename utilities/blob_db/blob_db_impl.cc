@@ -128,6 +128,12 @@ Status BlobHandle::DecodeFrom(Slice* input) {
 
 Random blob_rgen(static_cast<uint32_t>(time(nullptr)));
 
+namespace {
+void DeleteCachedBlob(const Slice& /*key*/, void* value) {
+  delete reinterpret_cast<std::string*>(value);
+}
+}  // namespace
+
 void BlobDBFlushBeginListener::OnFlushBegin(DB* db, const FlushJobInfo& info) {
   if (impl_) impl_->OnFlushBeginHandler(db, info);
 }
@@ -177,6 +183,58 @@ void EvictAllVersionsCompactionListener::InternalListener::OnCompaction(
   }
 }
 
+void EvictAllVersionsCompactionListener::OnCompactionCompleted(
+    DB* /*db*/, const CompactionJobInfo& ci) {
+  if (impl_) impl_->OnCompactionCompletedHandler(ci);
+}
+
+// Moves the live blobs of the blob files being drained by GC while the
+// compaction rewrites their keys.
+class BlobIndexCompactionFilter : public CompactionFilter {
+ public:
+  BlobIndexCompactionFilter(BlobDBImpl* impl, int job_id)
+      : impl_(impl), job_id_(job_id) {}
+
+  ~BlobIndexCompactionFilter() {
+    if (relocation_file_) {
+      impl_->CloseRelocationFile(relocation_file_);
+    }
+  }
+
+  virtual Decision FilterV2(int level, const Slice& key, ValueType value_type,
+                            const Slice& existing_value,
+                            std::string* new_value,
+                            std::string* skip_until) const override {
+    if (value_type == ValueType::kValue &&
+        impl_->RelocateBlob(job_id_, key, existing_value, &relocation_file_,
+                            new_value)) {
+      return Decision::kChangeValue;
+    }
+    return Decision::kKeep;
+  }
+
+  virtual const char* Name() const override {
+    return "BlobIndexCompactionFilter";
+  }
+
+ private:
+  BlobDBImpl* impl_;
+  const int job_id_;
+  // blob file receiving the blobs moved by this compaction
+  mutable std::shared_ptr<BlobFile> relocation_file_;
+};
+
+std::unique_ptr<CompactionFilter>
+BlobIndexCompactionFilterFactory::CreateCompactionFilter(
+    const CompactionFilter::Context& context) {
+  if (impl_ == nullptr ||
+      !impl_->GetBlobDBOptions().relocate_blobs_in_compaction) {
+    return nullptr;
+  }
+  return std::unique_ptr<CompactionFilter>(
+      new BlobIndexCompactionFilter(impl_, context.job_id));
+}
+
 BlobDBImpl::BlobDBImpl(const std::string& dbname,
                        const BlobDBOptions& blob_db_options,
                        const DBOptions& db_options)
@@ -186,6 +244,9 @@ BlobDBImpl::BlobDBImpl(const std::string& dbname,
       ttl_extractor_(blob_db_options.ttl_extractor.get()),
       wo_set_(false),
       bdb_options_(blob_db_options),
+      blob_cache_id_(blob_db_options.blob_cache
+                         ? blob_db_options.blob_cache->NewId()
+                         : 0),
       db_options_(db_options),
       env_options_(db_options),
       dir_change_(false),
@@ -246,6 +307,9 @@ BlobDBImpl::BlobDBImpl(DB* db, const BlobDBOptions& blob_db_options)
       opt_db_(new OptimisticTransactionDBImpl(db, false)),
       wo_set_(false),
       bdb_options_(blob_db_options),
+      blob_cache_id_(blob_db_options.blob_cache
+                         ? blob_db_options.blob_cache->NewId()
+                         : 0),
       db_options_(db->GetOptions()),
       env_options_(db_->GetOptions()),
       dir_change_(false),
@@ -259,6 +323,8 @@ BlobDBImpl::BlobDBImpl(DB* db, const BlobDBOptions& blob_db_options)
       total_periods_write_(0),
       total_periods_ampl_(0),
       total_blob_space_(0) {
+  // the relocation filter can only be installed when the base DB is opened
+  bdb_options_.relocate_blobs_in_compaction = false;
   if (!bdb_options_.blob_dir.empty())
     blob_dir_ = (bdb_options_.path_relative)
                     ? db_->GetName() + "/" + bdb_options_.blob_dir
@@ -269,6 +335,11 @@ BlobDBImpl::~BlobDBImpl() {
   // CancelAllBackgroundWork(db_, true);
 
   Shutdown();
+
+  // Running compactions may still be relocating blobs through this object.
+  if (db_ != nullptr && bdb_options_.relocate_blobs_in_compaction) {
+    CancelAllBackgroundWork(db_, true);
+  }
 }
 
 Status BlobDBImpl::OpenPhase1() {
@@ -1165,7 +1236,8 @@ bool BlobDBImpl::SetSnapshotIfNeeded(ReadOptions* read_options) {
 
 Status BlobDBImpl::CommonGet(const ColumnFamilyData* cfd, const Slice& key,
                              const std::string& index_entry, std::string* value,
-                             SequenceNumber* sequence) {
+                             SequenceNumber* sequence, bool uncompress,
+                             BlobReadahead* readahead) {
   Slice index_entry_slice(index_entry);
   BlobHandle handle;
   Status s = handle.DecodeFrom(&index_entry_slice);
@@ -1205,14 +1277,37 @@ Status BlobDBImpl::CommonGet(const ColumnFamilyData* cfd, const Slice& key,
     return Status::OK();
   }
 
-  // takes locks when called
-  std::shared_ptr<RandomAccessFileReader> reader =
-      GetOrOpenRandomAccessReader(bfile, env_, env_options_);
+  Cache* blob_cache = bdb_options_.blob_cache.get();
+  std::string cache_key;
+  if (blob_cache != nullptr && value != nullptr && uncompress &&
+      sequence == nullptr) {
+    cache_key = BlobCacheKey(handle.filenumber(), handle.offset());
+    Cache::Handle* cache_handle = blob_cache->Lookup(cache_key);
+    if (cache_handle != nullptr) {
+      *value = *reinterpret_cast<std::string*>(blob_cache->Value(cache_handle));
+      blob_cache->Release(cache_handle);
+      return Status::OK();
+    }
+  }
+
+  std::shared_ptr<RandomAccessFileReader> shared_reader;
+  RandomAccessFileReader* reader = nullptr;
+  if (readahead != nullptr && bfile->Immutable()) {
+    s = PrepareReadahead(bfile, readahead);
+    if (!s.ok()) {
+      return s;
+    }
+    reader = readahead->reader.get();
+  } else {
+    // takes locks when called
+    shared_reader = GetOrOpenRandomAccessReader(bfile, env_, env_options_);
+    reader = shared_reader.get();
+  }
 
   if (value != nullptr) {
     std::string* valueptr = value;
     std::string value_c;
-    if (bdb_options_.compression != kNoCompression) {
+    if (bdb_options_.compression != kNoCompression && uncompress) {
       valueptr = &value_c;
     }
 
@@ -1267,7 +1362,7 @@ Status BlobDBImpl::CommonGet(const ColumnFamilyData* cfd, const Slice& key,
       return Status::Corruption("Corruption. Blob CRC mismatch");
     }
 
-    if (bdb_options_.compression != kNoCompression) {
+    if (bdb_options_.compression != kNoCompression && uncompress) {
       BlockContents contents;
       s = UncompressBlockContentsForCompressionType(
           blob_value.data(), blob_value.size(), &contents,
@@ -1275,6 +1370,12 @@ Status BlobDBImpl::CommonGet(const ColumnFamilyData* cfd, const Slice& key,
           *(cfd->ioptions()));
       *value = contents.data.ToString();
     }
+
+    if (!cache_key.empty() && s.ok()) {
+      std::string* cached_blob = new std::string(*value);
+      blob_cache->Insert(cache_key, cached_blob, cached_blob->size(),
+                         &DeleteCachedBlob);
+    }
   }
 
   if (sequence != nullptr) {
@@ -1296,6 +1397,39 @@ Status BlobDBImpl::CommonGet(const ColumnFamilyData* cfd, const Slice& key,
   return s;
 }
 
+Status BlobDBImpl::PrepareReadahead(const std::shared_ptr<BlobFile>& bfile,
+                                    BlobReadahead* readahead) {
+  if (readahead->reader != nullptr &&
+      readahead->file_number == bfile->BlobFileNumber()) {
+    return Status::OK();
+  }
+  readahead->reader.reset();
+
+  std::unique_ptr<RandomAccessFile> file;
+  Status s = env_->NewRandomAccessFile(bfile->PathName(), &file, env_options_);
+  if (!s.ok()) {
+    ROCKS_LOG_ERROR(db_options_.info_log,
+                    "Failed to open blob file for readahead: %s status: '%s'",
+                    bfile->PathName().c_str(), s.ToString().c_str());
+    return s;
+  }
+  file = NewReadaheadRandomAccessFile(std::move(file),
+                                      readahead->readahead_size);
+  readahead->reader.reset(
+      new RandomAccessFileReader(std::move(file), bfile->PathName(), env_));
+  readahead->file_number = bfile->BlobFileNumber();
+  return s;
+}
+
+std::string BlobDBImpl::BlobCacheKey(uint64_t file_number,
+                                     uint64_t offset) const {
+  std::string key;
+  PutVarint64(&key, blob_cache_id_);
+  PutVarint64(&key, file_number);
+  PutVarint64(&key, offset);
+  return key;
+}
+
 Status BlobDBImpl::Get(const ReadOptions& read_options,
                        ColumnFamilyHandle* column_family, const Slice& key,
                        PinnableSlice* value) {
@@ -1332,7 +1466,8 @@ Slice BlobDBIterator::value() const {
   TEST_SYNC_POINT("BlobDBIterator::value:BeforeGetBlob:1");
   TEST_SYNC_POINT("BlobDBIterator::value:BeforeGetBlob:2");
   Status s = db_impl_->CommonGet(cfd, iter_->key(), index_entry.ToString(false),
-                                 &vpart_);
+                                 &vpart_, nullptr /* sequence */,
+                                 true /* uncompress */, readahead_.get());
   return Slice(vpart_);
 }
 
@@ -1454,6 +1589,215 @@ bool BlobDBImpl::FindFileAndEvictABlob(uint64_t file_number, uint64_t key_size,
   return true;
 }
 
+bool BlobDBImpl::RelocateBlob(int job_id, const Slice& key,
+                              const Slice& index_entry,
+                              std::shared_ptr<BlobFile>* relocation_file,
+                              std::string* new_index_entry) {
+  if (shutdown_.load()) {
+    return false;
+  }
+
+  Slice index_entry_slice(index_entry);
+  BlobHandle handle;
+  if (!handle.DecodeFrom(&index_entry_slice).ok()) {
+    // The value was written to the base DB directly
+    return false;
+  }
+
+  std::shared_ptr<BlobFile> bfile;
+  {
+    ReadLock rl(&mutex_);
+    auto hitr = blob_files_.find(handle.filenumber());
+    if (hitr == blob_files_.end()) {
+      return false;
+    }
+    bfile = hitr->second;
+  }
+  if (bfile->relocation_epoch_.load() == 0 || bfile->Obsolete()) {
+    return false;
+  }
+
+  std::string blob;
+  SequenceNumber sn = 0;
+  Status s = CommonGet(nullptr, key, index_entry.ToString(), &blob, &sn,
+                       false /* uncompress */);
+  if (!s.ok()) {
+    ROCKS_LOG_WARN(db_options_.info_log,
+                   "Could not read blob from %s for relocation: %s",
+                   bfile->PathName().c_str(), s.ToString().c_str());
+    return false;
+  }
+
+  std::shared_ptr<BlobFile>& newfile = *relocation_file;
+  if (!newfile) {
+    std::string reason("compaction relocating from ");
+    reason += bfile->PathName();
+    newfile = NewBlobFile(reason);
+
+    // file not visible, hence no lock
+    std::shared_ptr<Writer> writer = CheckOrCreateWriterLocked(newfile);
+    newfile->file_size_ = BlobLogHeader::kHeaderSize;
+    newfile->header_.compression_ = bdb_options_.compression;
+    newfile->header_valid_ = true;
+    s = writer ? writer->WriteHeader(newfile->header_)
+               : Status::IOError("Failed to create blob writer");
+    if (!s.ok()) {
+      ROCKS_LOG_ERROR(db_options_.info_log,
+                      "File: %s - header writing failed: %s",
+                      newfile->PathName().c_str(), s.ToString().c_str());
+      newfile.reset();
+      return false;
+    }
+
+    WriteLock wl(&mutex_);
+    dir_change_.store(true);
+    blob_files_.insert(std::make_pair(newfile->BlobFileNumber(), newfile));
+  }
+
+  uint64_t key_offset = 0;
+  uint64_t blob_offset = 0;
+  {
+    WriteLock lockbfile_w(&newfile->mutex_);
+    std::shared_ptr<Writer> writer = newfile->GetWriter();
+    s = writer->AddRecord(key, blob, &key_offset, &blob_offset);
+    if (s.ok()) {
+      s = writer->AddRecordFooter(sn);
+    }
+    if (s.ok()) {
+      extendSN(&newfile->sn_range_, sn);
+    }
+  }
+  if (!s.ok()) {
+    // The file may end in a partial record, so stop using it. Blobs that
+    // are not moved are rewritten by GCFileAndUpdateLSM() later.
+    ROCKS_LOG_ERROR(db_options_.info_log,
+                    "Failed to relocate blob to %s: %s",
+                    newfile->PathName().c_str(), s.ToString().c_str());
+    newfile.reset();
+    return false;
+  }
+
+  uint64_t record_size = BlobLogRecord::kHeaderSize + key.size() +
+                         blob.size() + BlobLogRecord::kFooterSize;
+  newfile->blob_count_++;
+  newfile->file_size_ += record_size;
+  last_period_ampl_ += record_size;
+  total_blob_space_ += record_size;
+
+  BlobHandle new_handle;
+  new_handle.set_filenumber(newfile->BlobFileNumber());
+  new_handle.set_size(blob.size());
+  new_handle.set_offset(blob_offset);
+  new_handle.set_compression(bdb_options_.compression);
+  new_handle.EncodeTo(new_index_entry);
+
+  // Which copy is garbage depends on whether the compaction output gets
+  // installed, see OnCompactionCompletedHandler().
+  {
+    MutexLock l(&relocation_mutex_);
+    pending_relocations_[job_id].push_back(
+        {{handle.filenumber(), key.size(), handle.offset(), handle.size(), sn},
+         {newfile->BlobFileNumber(), key.size(), blob_offset, blob.size(),
+          sn}});
+  }
+
+  if (newfile->GetFileSize() >= bdb_options_.blob_file_size) {
+    CloseRelocationFile(newfile);
+    newfile.reset();
+  }
+  return true;
+}
+
+void BlobDBImpl::OnCompactionCompletedHandler(const CompactionJobInfo& info) {
+  CountRelocatedBlobsAsGarbage(info.job_id, info.status);
+}
+
+Status BlobDBImpl::CompactFiles(
+    const CompactionOptions& compact_options,
+    ColumnFamilyHandle* column_family,
+    const std::vector<std::string>& input_file_names, const int output_level,
+    const int output_path_id) {
+  // No listener hears about these compactions, so count what they relocated
+  // here, while no other CompactFiles() call adds to the same job id.
+  MutexLock l(&compact_files_mutex_);
+  Status s = db_->CompactFiles(compact_options, column_family,
+                               input_file_names, output_level, output_path_id);
+  CountRelocatedBlobsAsGarbage(kCompactFilesJobId, s);
+  return s;
+}
+
+void BlobDBImpl::CountRelocatedBlobsAsGarbage(int job_id,
+                                              const Status& status) {
+  std::vector<relocation_packet_t> relocated;
+  {
+    MutexLock l(&relocation_mutex_);
+    auto it = pending_relocations_.find(job_id);
+    if (it == pending_relocations_.end()) {
+      return;
+    }
+    relocated.swap(it->second);
+    pending_relocations_.erase(it);
+  }
+
+  // The base DB points to the moved copies only if the output was installed.
+  for (const auto& packet : relocated) {
+    const override_packet_t& garbage = status.ok() ? packet.from_ : packet.to_;
+    FindFileAndEvictABlob(garbage.file_number_, garbage.key_size_,
+                          garbage.blob_offset_, garbage.blob_size_);
+  }
+  ROCKS_LOG_INFO(db_options_.info_log,
+                 "[JOB %d] Compaction %s relocating %" ROCKSDB_PRIszt
+                 " blobs: %s",
+                 job_id, status.ok() ? "finished" : "failed",
+                 relocated.size(), status.ToString().c_str());
+}
+
+void BlobDBImpl::CloseRelocationFile(const std::shared_ptr<BlobFile>& bfile) {
+  WriteLock lockbfile_w(&bfile->mutex_);
+  if (bfile->closed_.load() || !bfile->log_writer_) {
+    return;
+  }
+  // The compaction output referencing these blobs may be installed as soon as
+  // the filter is gone.
+  bfile->log_writer_->Sync();
+  Status s = bfile->WriteFooterAndCloseLocked();
+  if (!s.ok()) {
+    ROCKS_LOG_ERROR(db_options_.info_log,
+                    "Failed to close relocation blob file %s: %s",
+                    bfile->PathName().c_str(), s.ToString().c_str());
+  }
+}
+
+bool BlobDBImpl::DrainedByCompaction(const std::shared_ptr<BlobFile>& bfile) {
+  uint64_t since = bfile->relocation_epoch_.load();
+  if (since == 0) {
+    bfile->relocation_epoch_ = current_epoch_;
+    ROCKS_LOG_INFO(db_options_.info_log,
+                   "Compactions will relocate live blobs of %s",
+                   bfile->PathName().c_str());
+    return false;
+  }
+
+  uint64_t live_blobs = 0;
+  {
+    ReadLock lockbfile_r(&bfile->mutex_);
+    if (bfile->deleted_count_ < bfile->BlobCount()) {
+      live_blobs = bfile->BlobCount() - bfile->deleted_count_;
+    }
+  }
+  if (live_blobs == 0) {
+    return true;
+  }
+  if (current_epoch_ - since >= kMaxCompactionRelocationPeriods) {
+    ROCKS_LOG_INFO(db_options_.info_log,
+                   "Compactions left %" PRIu64
+                   " live blobs in %s, rewriting them",
+                   live_blobs, bfile->PathName().c_str());
+    return true;
+  }
+  return false;
+}
+
 bool BlobDBImpl::MarkBlobDeleted(const Slice& key, const Slice& lsmValue) {
   Slice val(lsmValue);
   BlobHandle handle;
@@ -2205,6 +2549,13 @@ std::pair<bool, int64_t> BlobDBImpl::RunGC(bool aborted) {
   // in this collect the set of files, which became obsolete
   std::vector<std::shared_ptr<BlobFile>> obsoletes;
   for (auto bfile : to_process) {
+    // Let compactions move the live blobs first; GCFileAndUpdateLSM() then
+    // only confirms that nothing is left.
+    if (bdb_options_.relocate_blobs_in_compaction && !bfile->HasTTL() &&
+        !bfile->gc_once_after_open_.load() && !DrainedByCompaction(bfile)) {
+      continue;
+    }
+
     GCStats gc_stats;
     Status s = GCFileAndUpdateLSM(bfile, &gc_stats);
     if (!s.ok()) {
@@ -2255,7 +2606,8 @@ Iterator* BlobDBImpl::NewIterator(const ReadOptions& read_options,
   ReadOptions ro(read_options);
   bool snapshot_created = SetSnapshotIfNeeded(&ro);
   return new BlobDBIterator(db_->NewIterator(ro, column_family), column_family,
-                            this, snapshot_created, ro.snapshot);
+                            this, snapshot_created, ro.snapshot,
+                            read_options.readahead_size);
 }
 
 Status DestroyBlobDB(const std::string& dbname, const Options& options,
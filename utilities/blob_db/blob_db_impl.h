@@ -16,6 +16,7 @@
 #include <set>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -95,16 +96,43 @@ class EvictAllVersionsCompactionListener : public EventListener {
   };
 
   explicit EvictAllVersionsCompactionListener()
-      : internal_listener_(new InternalListener()) {}
+      : internal_listener_(new InternalListener()), impl_(nullptr) {}
 
   virtual CompactionEventListener* GetCompactionEventListener() override {
     return internal_listener_.get();
   }
 
-  void SetImplPtr(BlobDBImpl* p) { internal_listener_->SetImplPtr(p); }
+  virtual void OnCompactionCompleted(DB* db,
+                                     const CompactionJobInfo& ci) override;
+
+  void SetImplPtr(BlobDBImpl* p) {
+    internal_listener_->SetImplPtr(p);
+    impl_ = p;
+  }
 
  private:
   std::unique_ptr<InternalListener> internal_listener_;
+  BlobDBImpl* impl_;
+};
+
+// Creates the compaction filters that move live blobs out of the blob files
+// picked for garbage collection (see
+// BlobDBOptions::relocate_blobs_in_compaction).
+class BlobIndexCompactionFilterFactory : public CompactionFilterFactory {
+ public:
+  BlobIndexCompactionFilterFactory() : impl_(nullptr) {}
+
+  void SetImplPtr(BlobDBImpl* p) { impl_ = p; }
+
+  virtual std::unique_ptr<CompactionFilter> CreateCompactionFilter(
+      const CompactionFilter::Context& context) override;
+
+  virtual const char* Name() const override {
+    return "BlobIndexCompactionFilterFactory";
+  }
+
+ private:
+  BlobDBImpl* impl_;
 };
 
 #if 0
@@ -133,6 +161,17 @@ struct blobf_compare_ttl {
                   const std::shared_ptr<BlobFile>& rhs) const;
 };
 
+// Readahead state of one iterator: a reader with readahead over the
+// immutable blob file the iterator last read a blob from.
+struct BlobReadahead {
+  explicit BlobReadahead(size_t _readahead_size)
+      : readahead_size(_readahead_size), file_number(0) {}
+
+  size_t readahead_size;
+  uint64_t file_number;
+  std::unique_ptr<RandomAccessFileReader> reader;
+};
+
 struct GCStats {
   uint64_t blob_count = 0;
   uint64_t num_deletes = 0;
@@ -155,6 +194,7 @@ struct GCStats {
 class BlobDBImpl : public BlobDB {
   friend class BlobDBFlushBeginListener;
   friend class EvictAllVersionsCompactionListener;
+  friend class BlobIndexCompactionFilter;
   friend class BlobDB;
   friend class BlobFile;
   friend class BlobDBIterator;
@@ -193,6 +233,13 @@ class BlobDBImpl : public BlobDB {
   // if 50% of the space of a blob file has been deleted/expired,
   static constexpr uint32_t kPartialExpirationPercentage = 75;
 
+  // with relocate_blobs_in_compaction, how many GC periods compactions get
+  // to move the live blobs out of a file before GC rewrites the rest itself
+  static constexpr uint32_t kMaxCompactionRelocationPeriods = 60;
+
+  // job id of the compactions run by DB::CompactFiles()
+  static constexpr int kCompactFilesJobId = 0;
+
   // how often should we schedule a job to fsync open files
   static constexpr uint32_t kFSyncFilesPeriodMillisecs = 10 * 1000;
 
@@ -235,6 +282,13 @@ class BlobDBImpl : public BlobDB {
 
   virtual Status Write(const WriteOptions& opts, WriteBatch* updates) override;
 
+  using rocksdb::StackableDB::CompactFiles;
+  virtual Status CompactFiles(const CompactionOptions& compact_options,
+                              ColumnFamilyHandle* column_family,
+                              const std::vector<std::string>& input_file_names,
+                              const int output_level,
+                              const int output_path_id = -1) override;
+
   using BlobDB::PutWithTTL;
   Status PutWithTTL(const WriteOptions& options,
                     ColumnFamilyHandle* column_family, const Slice& key,
@@ -282,9 +336,20 @@ class BlobDBImpl : public BlobDB {
   // Return true if a snapshot is created.
   bool SetSnapshotIfNeeded(ReadOptions* read_options);
 
+  // If uncompress is false, *value is the blob as stored in the blob file
+  // and cfd may be nullptr. If readahead is given, blobs of immutable files
+  // are read through it.
   Status CommonGet(const ColumnFamilyData* cfd, const Slice& key,
                    const std::string& index_entry, std::string* value,
-                   SequenceNumber* sequence = nullptr);
+                   SequenceNumber* sequence = nullptr, bool uncompress = true,
+                   BlobReadahead* readahead = nullptr);
+
+  // Points readahead at the given immutable blob file.
+  Status PrepareReadahead(const std::shared_ptr<BlobFile>& bfile,
+                          BlobReadahead* readahead);
+
+  // Key of a blob in bdb_options_.blob_cache
+  std::string BlobCacheKey(uint64_t file_number, uint64_t offset) const;
 
   Slice GetCompressedSlice(const Slice& raw,
                            std::string* compression_output) const;
@@ -293,6 +358,12 @@ class BlobDBImpl : public BlobDB {
   // this handler is called.
   void OnFlushBeginHandler(DB* db, const FlushJobInfo& info);
 
+  // Once a compaction is over, counts the blobs it relocated as garbage in
+  // the files they were moved from if its output was installed, or in its
+  // relocation files if it failed.
+  void OnCompactionCompletedHandler(const CompactionJobInfo& info);
+  void CountRelocatedBlobsAsGarbage(int job_id, const Status& status);
+
   // is this file ready for Garbage collection. if the TTL of the file
   // has expired or if threshold of the file has been evicted
   // tt - current time
@@ -408,6 +479,23 @@ class BlobDBImpl : public BlobDB {
   // blobs
   bool FileDeleteOk_SnapshotCheckLocked(const std::shared_ptr<BlobFile>& bfile);
 
+  // Called by compaction job_id for the newest version of a key. If the
+  // blob index_entry points to is in a file being drained by GC, copies the
+  // blob to *relocation_file (creating it if needed), sets *new_index_entry
+  // to its new location and returns true.
+  bool RelocateBlob(int job_id, const Slice& key, const Slice& index_entry,
+                    std::shared_ptr<BlobFile>* relocation_file,
+                    std::string* new_index_entry);
+
+  // Syncs and closes a blob file filled by RelocateBlob().
+  void CloseRelocationFile(const std::shared_ptr<BlobFile>& bfile);
+
+  // With relocate_blobs_in_compaction, decides whether a simple blob file
+  // picked by GC is ready for GCFileAndUpdateLSM(): either compactions have
+  // moved all of its blobs, or they had kMaxCompactionRelocationPeriods to
+  // do so. Files seen for the first time start being drained.
+  bool DrainedByCompaction(const std::shared_ptr<BlobFile>& bfile);
+
   bool MarkBlobDeleted(const Slice& key, const Slice& lsmValue);
 
   bool FindFileAndEvictABlob(uint64_t file_number, uint64_t key_size,
@@ -437,6 +525,9 @@ class BlobDBImpl : public BlobDB {
 
   // the options that govern the behavior of Blob Storage
   BlobDBOptions bdb_options_;
+
+  // distinguishes the blobs of this DB in a shared bdb_options_.blob_cache
+  uint64_t blob_cache_id_;
   DBOptions db_options_;
   EnvOptions env_options_;
 
@@ -500,6 +591,24 @@ class BlobDBImpl : public BlobDB {
   // that are being compacted
   mpsc_queue_t<override_packet_t> override_vals_q_;
 
+  // a blob moved by a compaction, from the file being drained by GC to the
+  // relocation file of the compaction
+  struct relocation_packet_t {
+    override_packet_t from_;
+    override_packet_t to_;
+  };
+
+  // blobs moved by the compactions that have not completed yet, by job id.
+  // Compactions run by CompactFiles() all have job id
+  // kCompactFilesJobId and do not notify listeners, so CompactFiles()
+  // drains them itself.
+  std::unordered_map<int, std::vector<relocation_packet_t>>
+      pending_relocations_;
+  port::Mutex relocation_mutex_;
+
+  // CompactFiles() calls share a job id, so they run one at a time
+  port::Mutex compact_files_mutex_;
+
   // atomic bool to represent shutdown
   std::atomic<bool> shutdown_;
 
@@ -582,6 +691,10 @@ class BlobFile {
   // should this file been gc'd once to reconcile lost deletes/compactions
   std::atomic<bool> gc_once_after_open_;
 
+  // GC epoch in which compactions started moving the blobs out of this
+  // file, or 0 if they are not doing so
+  std::atomic<uint64_t> relocation_epoch_;
+
   // et - lt of the blobs
   ttlrange_t ttl_range_;
 
@@ -655,6 +768,8 @@ class BlobFile {
 
   ttlrange_t GetTTLRange() const { return ttl_range_; }
 
+  uint64_t GetDeletedCount() const { return deleted_count_; }
+
   snrange_t GetSNRange() const { return sn_range_; }
 
   bool HasTTL() const {
@@ -707,12 +822,14 @@ class BlobDBIterator : public Iterator {
  public:
   explicit BlobDBIterator(Iterator* iter, ColumnFamilyHandle* column_family,
                           BlobDBImpl* impl, bool own_snapshot,
-                          const Snapshot* snapshot)
+                          const Snapshot* snapshot, size_t readahead_size = 0)
       : iter_(iter),
         cfh_(column_family),
         db_impl_(impl),
         own_snapshot_(own_snapshot),
-        snapshot_(snapshot) {
+        snapshot_(snapshot),
+        readahead_(readahead_size > 0 ? new BlobReadahead(readahead_size)
+                                      : nullptr) {
     assert(iter != nullptr);
     assert(snapshot != nullptr);
   }
@@ -753,6 +870,7 @@ class BlobDBIterator : public Iterator {
   bool own_snapshot_;
   const Snapshot* snapshot_;
   mutable std::string vpart_;
+  std::unique_ptr<BlobReadahead> readahead_;
 };
 
 }  // namespace blob_db
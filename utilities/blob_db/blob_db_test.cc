@@ -117,8 +117,9 @@ class BlobDBTest : public testing::Test {
 
   // Verify blob db contain expected data and nothing more.
   // TODO(yiwu): Verify blob files are consistent with data in LSM.
-  void VerifyDB(const std::map<std::string, std::string> &data) {
-    Iterator *iter = blob_db_->NewIterator(ReadOptions());
+  void VerifyDB(const std::map<std::string, std::string> &data,
+                const ReadOptions &read_options = ReadOptions()) {
+    Iterator *iter = blob_db_->NewIterator(read_options);
     iter->SeekToFirst();
     for (auto &p : data) {
       ASSERT_TRUE(iter->Valid());
@@ -512,6 +513,110 @@ TEST_F(BlobDBTest, Compression) {
 }
 #endif
 
+TEST_F(BlobDBTest, BlobCache) {
+  Random rnd(301);
+  std::shared_ptr<Cache> cache = NewLRUCache(1 << 20);
+  BlobDBOptions bdb_options;
+  bdb_options.disable_background_tasks = true;
+  bdb_options.blob_cache = cache;
+  Open(bdb_options);
+  std::map<std::string, std::string> data;
+  size_t total_size = 0;
+  for (int i = 0; i < 10; i++) {
+    PutRandom("key" + ToString(i), &rnd, &data);
+    total_size += data["key" + ToString(i)].size();
+  }
+  ASSERT_EQ(0, cache->GetUsage());
+  for (int pass = 0; pass < 2; pass++) {
+    for (auto &p : data) {
+      PinnableSlice value;
+      ASSERT_OK(blob_db_->Get(ReadOptions(), blob_db_->DefaultColumnFamily(),
+                              p.first, &value));
+      ASSERT_EQ(p.second, value.ToString());
+    }
+    // Blobs are only cached once.
+    ASSERT_EQ(total_size, cache->GetUsage());
+  }
+  VerifyDB(data);
+}
+
+TEST_F(BlobDBTest, IteratorReadahead) {
+  // Counts the reads of one file and remembers the largest.
+  class ReadCountingEnv : public EnvWrapper {
+   public:
+    class CountingFile : public RandomAccessFile {
+     public:
+      CountingFile(unique_ptr<RandomAccessFile> &&target, ReadCountingEnv *env)
+          : target_(std::move(target)), env_(env) {}
+
+      Status Read(uint64_t offset, size_t n, Slice *result,
+                  char *scratch) const override {
+        env_->num_reads_++;
+        env_->max_read_size_ = std::max(env_->max_read_size_, n);
+        return target_->Read(offset, n, result, scratch);
+      }
+
+      size_t GetRequiredBufferAlignment() const override {
+        return target_->GetRequiredBufferAlignment();
+      }
+
+      bool use_direct_io() const override { return target_->use_direct_io(); }
+
+     private:
+      unique_ptr<RandomAccessFile> target_;
+      ReadCountingEnv *env_;
+    };
+
+    ReadCountingEnv()
+        : EnvWrapper(Env::Default()), num_reads_(0), max_read_size_(0) {}
+
+    Status NewRandomAccessFile(const std::string &fname,
+                               unique_ptr<RandomAccessFile> *result,
+                               const EnvOptions &options) override {
+      Status s = EnvWrapper::NewRandomAccessFile(fname, result, options);
+      if (s.ok() && fname == counted_file_) {
+        result->reset(new CountingFile(std::move(*result), this));
+      }
+      return s;
+    }
+
+    std::string counted_file_;
+    int num_reads_;
+    size_t max_read_size_;
+  };
+
+  Random rnd(301);
+  ReadCountingEnv env;
+  Options options;
+  options.env = &env;
+  BlobDBOptions bdb_options;
+  bdb_options.disable_background_tasks = true;
+  Open(bdb_options, options);
+  BlobDBImpl *blob_db_impl =
+      static_cast_with_check<BlobDBImpl, BlobDB>(blob_db_);
+  std::map<std::string, std::string> data;
+  for (int i = 0; i < 100; i++) {
+    PutRandom("key" + ToString(i), &rnd, &data);
+  }
+  auto blob_files = blob_db_impl->TEST_GetBlobFiles();
+  ASSERT_EQ(1, blob_files.size());
+  ASSERT_OK(blob_db_impl->TEST_CloseBlobFile(blob_files[0]));
+  // Keys in the still open blob file are read without readahead.
+  for (int i = 50; i < 150; i++) {
+    PutRandom("key" + ToString(i), &rnd, &data);
+  }
+  env.counted_file_ = blob_files[0]->PathName();
+  ReadOptions read_options;
+  read_options.readahead_size = 64 * 1024;
+  VerifyDB(data, read_options);
+  // The 50 blobs left in the closed file come in whole readahead windows.
+  ASSERT_GT(env.num_reads_, 0);
+  ASSERT_LT(env.num_reads_, 50);
+  ASSERT_EQ(read_options.readahead_size, env.max_read_size_);
+  // The DB must not outlive env.
+  Destroy();
+}
+
 TEST_F(BlobDBTest, MultipleWriters) {
   Open(BlobDBOptions());
 
@@ -722,6 +827,160 @@ TEST_F(BlobDBTest, GCOldestSimpleBlobFileWhenOutOfSpace) {
             obsolete_files[0]->BlobFileNumber());
 }
 
+TEST_F(BlobDBTest, RelocateBlobsInCompaction) {
+  Random rnd(301);
+  BlobDBOptions bdb_options;
+  // Make the only blob file eligible for GC as the oldest simple blob file.
+  bdb_options.blob_dir_size = 1;
+  bdb_options.relocate_blobs_in_compaction = true;
+  bdb_options.disable_background_tasks = true;
+  Open(bdb_options);
+  std::map<std::string, std::string> data;
+  for (int i = 0; i < 10; i++) {
+    PutRandom("key" + ToString(i), &rnd, &data);
+  }
+  BlobDBImpl *blob_db_impl =
+      static_cast_with_check<BlobDBImpl, BlobDB>(blob_db_);
+  auto blob_files = blob_db_impl->TEST_GetBlobFiles();
+  ASSERT_EQ(1, blob_files.size());
+  ASSERT_OK(blob_db_impl->TEST_CloseBlobFile(blob_files[0]));
+
+  // The first GC pass leaves the file to compactions.
+  blob_db_impl->TEST_RunGC();
+  ASSERT_EQ(0, blob_db_impl->TEST_GetObsoleteFiles().size());
+
+  ASSERT_OK(blob_db_->Flush(FlushOptions()));
+  ASSERT_OK(blob_db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(2, blob_db_impl->TEST_GetBlobFiles().size());
+  VerifyDB(data);
+
+  // Nothing is left to relocate, so GC drops the file without writing to
+  // the base DB.
+  SequenceNumber sequence = blob_db_->GetLatestSequenceNumber();
+  blob_db_impl->TEST_RunGC();
+  ASSERT_EQ(sequence, blob_db_->GetLatestSequenceNumber());
+  auto obsolete_files = blob_db_impl->TEST_GetObsoleteFiles();
+  ASSERT_EQ(1, obsolete_files.size());
+  ASSERT_EQ(blob_files[0]->BlobFileNumber(),
+            obsolete_files[0]->BlobFileNumber());
+  blob_db_impl->TEST_DeleteObsoleteFiles();
+  ASSERT_EQ(1, blob_db_impl->TEST_GetBlobFiles().size());
+  VerifyDB(data);
+}
+
+TEST_F(BlobDBTest, RelocateBlobsInFailedCompaction) {
+  class SstWriteFailingEnv : public EnvWrapper {
+   public:
+    SstWriteFailingEnv() : EnvWrapper(Env::Default()), fail_(false) {}
+
+    Status NewWritableFile(const std::string &fname,
+                           unique_ptr<WritableFile> *result,
+                           const EnvOptions &options) override {
+      if (fail_.load() && fname.size() > 4 &&
+          fname.compare(fname.size() - 4, 4, ".sst") == 0) {
+        return Status::IOError("injected", fname);
+      }
+      return EnvWrapper::NewWritableFile(fname, result, options);
+    }
+
+    std::atomic<bool> fail_;
+  };
+
+  Random rnd(301);
+  SstWriteFailingEnv env;
+  Options options;
+  options.env = &env;
+  // Keep the DB writable after the compaction fails.
+  options.paranoid_checks = false;
+  BlobDBOptions bdb_options;
+  bdb_options.blob_dir_size = 1;
+  bdb_options.relocate_blobs_in_compaction = true;
+  bdb_options.disable_background_tasks = true;
+  Open(bdb_options, options);
+  std::map<std::string, std::string> data;
+  for (int i = 0; i < 10; i++) {
+    PutRandom("key" + ToString(i), &rnd, &data);
+  }
+  BlobDBImpl *blob_db_impl =
+      static_cast_with_check<BlobDBImpl, BlobDB>(blob_db_);
+  auto blob_files = blob_db_impl->TEST_GetBlobFiles();
+  ASSERT_EQ(1, blob_files.size());
+  ASSERT_OK(blob_db_impl->TEST_CloseBlobFile(blob_files[0]));
+  blob_db_impl->TEST_RunGC();
+  ASSERT_OK(blob_db_->Flush(FlushOptions()));
+
+  // The compaction moves blobs, then fails to write its output.
+  env.fail_ = true;
+  ASSERT_NOK(blob_db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  env.fail_ = false;
+  blob_files = blob_db_impl->TEST_GetBlobFiles();
+  ASSERT_EQ(2, blob_files.size());
+  // The base DB still points to the old copies, so only the new ones are
+  // garbage.
+  ASSERT_EQ(0, blob_files[0]->GetDeletedCount());
+  ASSERT_GT(blob_files[1]->BlobCount(), 0);
+  ASSERT_EQ(blob_files[1]->BlobCount(), blob_files[1]->GetDeletedCount());
+  VerifyDB(data);
+
+  ASSERT_OK(blob_db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  blob_files = blob_db_impl->TEST_GetBlobFiles();
+  ASSERT_EQ(3, blob_files.size());
+  ASSERT_EQ(10, blob_files[0]->GetDeletedCount());
+  ASSERT_EQ(0, blob_files[2]->GetDeletedCount());
+  VerifyDB(data);
+
+  // GC drops the old file, and maybe the one of the failed compaction.
+  blob_db_impl->TEST_RunGC();
+  std::set<uint64_t> obsolete_file_numbers;
+  for (auto &bfile : blob_db_impl->TEST_GetObsoleteFiles()) {
+    obsolete_file_numbers.insert(bfile->BlobFileNumber());
+  }
+  ASSERT_EQ(1, obsolete_file_numbers.count(blob_files[0]->BlobFileNumber()));
+  ASSERT_EQ(0, obsolete_file_numbers.count(blob_files[2]->BlobFileNumber()));
+  blob_db_impl->TEST_DeleteObsoleteFiles();
+  VerifyDB(data);
+  // The DB must not outlive env.
+  Destroy();
+}
+
+TEST_F(BlobDBTest, RelocateBlobsInCompactFiles) {
+  Random rnd(301);
+  BlobDBOptions bdb_options;
+  bdb_options.blob_dir_size = 1;
+  bdb_options.relocate_blobs_in_compaction = true;
+  bdb_options.disable_background_tasks = true;
+  Open(bdb_options);
+  std::map<std::string, std::string> data;
+  for (int i = 0; i < 10; i++) {
+    PutRandom("key" + ToString(i), &rnd, &data);
+  }
+  BlobDBImpl *blob_db_impl =
+      static_cast_with_check<BlobDBImpl, BlobDB>(blob_db_);
+  auto blob_files = blob_db_impl->TEST_GetBlobFiles();
+  ASSERT_EQ(1, blob_files.size());
+  ASSERT_OK(blob_db_impl->TEST_CloseBlobFile(blob_files[0]));
+  blob_db_impl->TEST_RunGC();
+  ASSERT_OK(blob_db_->Flush(FlushOptions()));
+
+  // CompactFiles() does not notify listeners, but the blobs it moves are
+  // counted as garbage all the same.
+  std::vector<LiveFileMetaData> metadata;
+  blob_db_->GetLiveFilesMetaData(&metadata);
+  ASSERT_EQ(1, metadata.size());
+  ASSERT_OK(blob_db_->CompactFiles(CompactionOptions(), {metadata[0].name},
+                                   1 /* output_level */));
+  blob_files = blob_db_impl->TEST_GetBlobFiles();
+  ASSERT_EQ(2, blob_files.size());
+  ASSERT_EQ(10, blob_files[0]->GetDeletedCount());
+  ASSERT_EQ(0, blob_files[1]->GetDeletedCount());
+  VerifyDB(data);
+
+  blob_db_impl->TEST_RunGC();
+  ASSERT_EQ(1, blob_db_impl->TEST_GetObsoleteFiles().size());
+  blob_db_impl->TEST_DeleteObsoleteFiles();
+  VerifyDB(data);
+}
+
 TEST_F(BlobDBTest, ReadWhileGC) {
   // run the same test for Get(), MultiGet() and Iterator each.
   for (int i = 0; i < 3; i++) {
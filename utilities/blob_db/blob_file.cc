@@ -28,6 +28,7 @@ BlobFile::BlobFile()
       closed_(false),
       can_be_deleted_(false),
       gc_once_after_open_(false),
+      relocation_epoch_(0),
       ttl_range_(std::make_pair(0, 0)),
       time_range_(std::make_pair(0, 0)),
       sn_range_(std::make_pair(0, 0)),
@@ -47,6 +48,7 @@ BlobFile::BlobFile(const BlobDBImpl* p, const std::string& bdir, uint64_t fn)
       closed_(false),
       can_be_deleted_(false),
       gc_once_after_open_(false),
+      relocation_epoch_(0),
       ttl_range_(std::make_pair(0, 0)),
       time_range_(std::make_pair(0, 0)),
       sn_range_(std::make_pair(0, 0)),
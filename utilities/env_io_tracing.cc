@@ -0,0 +1,665 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "utilities/env_io_tracing.h"
+
+#include <string.h>
+#include <algorithm>
+
+#include "monitoring/thread_status_util.h"
+#include "rocksdb/env.h"
+#include "util/coding.h"
+#include "util/mutexlock.h"
+
+namespace rocksdb {
+
+#ifndef ROCKSDB_LITE
+
+namespace {
+
+const char kIOTraceMagic[] = "RDBIOTRC";
+const size_t kIOTraceMagicSize = 8;
+
+std::string EncodeIOTraceHeader(uint64_t num_slots, uint64_t num_records) {
+  std::string header(kIOTraceMagic, kIOTraceMagicSize);
+  PutFixed32(&header, kIOTraceFormatVersion);
+  PutFixed32(&header, static_cast<uint32_t>(kIOTraceSlotSize));
+  PutFixed64(&header, num_slots);
+  PutFixed64(&header, num_records);
+  header.resize(kIOTraceSlotSize, '\0');
+  return header;
+}
+
+}  // namespace
+
+const char* IOTraceOpName(IOTraceOp op) {
+  switch (op) {
+    case kIOTraceOpen:
+      return "open";
+    case kIOTraceRead:
+      return "read";
+    case kIOTraceWrite:
+      return "write";
+    case kIOTraceSync:
+      return "sync";
+    case kIOTraceFsync:
+      return "fsync";
+    case kIOTraceRangeSync:
+      return "range_sync";
+    case kIOTraceTruncate:
+      return "truncate";
+    case kIOTraceClose:
+      return "close";
+    case kIOTraceDelete:
+      return "delete";
+    case kIOTraceRename:
+      return "rename";
+    default:
+      return "unknown";
+  }
+}
+
+void EncodeIOTraceRecord(const IOTraceRecord& record, char* slot) {
+  memset(slot, 0, kIOTraceSlotSize);
+  EncodeFixed64(slot, record.timestamp);
+  EncodeFixed64(slot + 8, record.offset);
+  EncodeFixed64(slot + 16, record.length);
+  EncodeFixed64(slot + 24, record.latency_nanos);
+  slot[32] = static_cast<char>(record.op);
+  slot[33] = static_cast<char>(record.thread_type);
+  slot[34] = static_cast<char>(record.operation_type);
+  slot[35] = record.ok ? 0 : 1;
+  size_t name_length =
+      std::min(record.file_name.size(), kIOTraceMaxFileNameLength);
+  slot[36] = static_cast<char>(name_length);
+  memcpy(slot + 37, record.file_name.data(), name_length);
+}
+
+Status DecodeIOTraceRecord(const Slice& slot, IOTraceRecord* record) {
+  if (slot.size() != kIOTraceSlotSize) {
+    return Status::Corruption("Truncated I/O trace record");
+  }
+  const char* data = slot.data();
+  record->timestamp = DecodeFixed64(data);
+  record->offset = DecodeFixed64(data + 8);
+  record->length = DecodeFixed64(data + 16);
+  record->latency_nanos = DecodeFixed64(data + 24);
+  uint8_t op = static_cast<uint8_t>(data[32]);
+  uint8_t thread_type = static_cast<uint8_t>(data[33]);
+  uint8_t operation_type = static_cast<uint8_t>(data[34]);
+  size_t name_length = static_cast<uint8_t>(data[36]);
+  if (op == 0 || op >= kIOTraceOpMax ||
+      thread_type >= ThreadStatus::NUM_THREAD_TYPES ||
+      operation_type >= ThreadStatus::NUM_OP_TYPES ||
+      name_length > kIOTraceMaxFileNameLength) {
+    return Status::Corruption("Invalid I/O trace record");
+  }
+  record->op = static_cast<IOTraceOp>(op);
+  record->thread_type = static_cast<ThreadStatus::ThreadType>(thread_type);
+  record->operation_type =
+      static_cast<ThreadStatus::OperationType>(operation_type);
+  record->ok = data[35] == 0;
+  record->file_name.assign(data + 37, name_length);
+  return Status::OK();
+}
+
+Status IOTraceWriter::Open(Env* env, const std::string& trace_filename,
+                           uint64_t max_trace_file_size,
+                           std::unique_ptr<IOTraceWriter>* writer) {
+  uint64_t num_slots = max_trace_file_size / kIOTraceSlotSize;
+  num_slots = num_slots > 1 ? num_slots - 1 : 1;
+  // Not to keep the records of an older, larger trace
+  env->DeleteFile(trace_filename);
+  std::unique_ptr<RandomRWFile> file;
+  Status s = env->NewRandomRWFile(trace_filename, &file, EnvOptions());
+  if (!s.ok()) {
+    return s;
+  }
+  s = file->Write(0, EncodeIOTraceHeader(num_slots, 0));
+  if (!s.ok()) {
+    return s;
+  }
+  writer->reset(new IOTraceWriter(std::move(file), num_slots));
+  return Status::OK();
+}
+
+IOTraceWriter::IOTraceWriter(std::unique_ptr<RandomRWFile>&& file,
+                             uint64_t num_slots)
+    : file_(std::move(file)),
+      num_slots_(num_slots),
+      num_records_(0),
+      num_flushed_records_(0) {
+  buffer_.reserve(kBufferedRecords * kIOTraceSlotSize);
+}
+
+IOTraceWriter::~IOTraceWriter() {
+  Flush();
+  file_->Close();
+}
+
+void IOTraceWriter::Write(const IOTraceRecord& record) {
+  char slot[kIOTraceSlotSize];
+  EncodeIOTraceRecord(record, slot);
+  MutexLock l(&mutex_);
+  buffer_.append(slot, kIOTraceSlotSize);
+  num_records_++;
+  if (buffer_.size() >= kBufferedRecords * kIOTraceSlotSize) {
+    FlushLocked();
+  }
+}
+
+Status IOTraceWriter::Flush() {
+  MutexLock l(&mutex_);
+  return FlushLocked();
+}
+
+uint64_t IOTraceWriter::num_records() const {
+  MutexLock l(&mutex_);
+  return num_records_;
+}
+
+Status IOTraceWriter::FlushLocked() {
+  if (!status_.ok()) {
+    // Keep the trace that was written before the error
+    buffer_.clear();
+    return status_;
+  }
+  uint64_t record = num_flushed_records_;
+  size_t pos = 0;
+  while (pos < buffer_.size() && status_.ok()) {
+    // Up to the end of the ring
+    uint64_t slot = record % num_slots_;
+    size_t size = static_cast<size_t>(
+        std::min<uint64_t>(buffer_.size() - pos,
+                           (num_slots_ - slot) * kIOTraceSlotSize));
+    status_ = file_->Write((slot + 1) * kIOTraceSlotSize,
+                           Slice(buffer_.data() + pos, size));
+    pos += size;
+    record += size / kIOTraceSlotSize;
+  }
+  buffer_.clear();
+  if (status_.ok()) {
+    num_flushed_records_ = num_records_;
+    status_ = file_->Write(0, EncodeIOTraceHeader(num_slots_, num_records_));
+  }
+  return status_;
+}
+
+Status IOTraceReader::Open(Env* env, const std::string& trace_filename,
+                           std::unique_ptr<IOTraceReader>* reader) {
+  std::unique_ptr<RandomAccessFile> file;
+  Status s = env->NewRandomAccessFile(trace_filename, &file, EnvOptions());
+  if (!s.ok()) {
+    return s;
+  }
+  char scratch[kIOTraceSlotSize];
+  Slice header;
+  s = file->Read(0, kIOTraceSlotSize, &header, scratch);
+  if (!s.ok()) {
+    return s;
+  }
+  if (header.size() != kIOTraceSlotSize ||
+      memcmp(header.data(), kIOTraceMagic, kIOTraceMagicSize) != 0) {
+    return Status::Corruption("Not an I/O trace", trace_filename);
+  }
+  if (DecodeFixed32(header.data() + 8) != kIOTraceFormatVersion ||
+      DecodeFixed32(header.data() + 12) != kIOTraceSlotSize) {
+    return Status::NotSupported("Unknown I/O trace format", trace_filename);
+  }
+  uint64_t num_slots = DecodeFixed64(header.data() + 16);
+  uint64_t num_records_written = DecodeFixed64(header.data() + 24);
+  if (num_slots == 0) {
+    return Status::Corruption("Invalid I/O trace header", trace_filename);
+  }
+  reader->reset(
+      new IOTraceReader(std::move(file), num_slots, num_records_written));
+  return Status::OK();
+}
+
+IOTraceReader::IOTraceReader(std::unique_ptr<RandomAccessFile>&& file,
+                             uint64_t num_slots, uint64_t num_records_written)
+    : file_(std::move(file)),
+      num_slots_(num_slots),
+      num_records_written_(num_records_written),
+      next_record_(num_records_written > num_slots
+                       ? num_records_written - num_slots
+                       : 0) {}
+
+Status IOTraceReader::Read(IOTraceRecord* record) {
+  if (next_record_ >= num_records_written_) {
+    return Status::Incomplete("End of the I/O trace");
+  }
+  char scratch[kIOTraceSlotSize];
+  Slice slot;
+  Status s = file_->Read(
+      (next_record_ % num_slots_ + 1) * kIOTraceSlotSize, kIOTraceSlotSize,
+      &slot, scratch);
+  if (!s.ok()) {
+    return s;
+  }
+  next_record_++;
+  return DecodeIOTraceRecord(slot, record);
+}
+
+namespace {
+
+// The name of fname in the records, without its directory
+std::string IOTraceFileName(const std::string& fname) {
+  size_t pos = fname.rfind('/');
+  std::string name = pos == std::string::npos ? fname : fname.substr(pos + 1);
+  if (name.size() > kIOTraceMaxFileNameLength) {
+    name.resize(kIOTraceMaxFileNameLength);
+  }
+  return name;
+}
+
+// Times one file operation, and writes its record
+class IOTraceTimer {
+ public:
+  IOTraceTimer(Env* env, IOTraceWriter* writer)
+      : env_(env),
+        writer_(writer),
+        start_micros_(env->NowMicros()),
+        start_nanos_(env->NowNanos()) {}
+
+  void Record(IOTraceOp op, const std::string& file_name, uint64_t offset,
+              uint64_t length, const Status& s) {
+    IOTraceRecord record;
+    record.latency_nanos = env_->NowNanos() - start_nanos_;
+    record.timestamp = start_micros_;
+    record.offset = offset;
+    record.length = length;
+    record.op = op;
+    record.thread_type = ThreadStatusUtil::GetThreadType();
+    record.operation_type = ThreadStatusUtil::GetThreadOperation();
+    record.ok = s.ok();
+    record.file_name = file_name;
+    writer_->Write(record);
+  }
+
+ private:
+  Env* env_;
+  IOTraceWriter* writer_;
+  const uint64_t start_micros_;
+  const uint64_t start_nanos_;
+};
+
+class IOTracingSequentialFile : public SequentialFile {
+ public:
+  IOTracingSequentialFile(std::unique_ptr<SequentialFile>&& target, Env* env,
+                          IOTraceWriter* writer, const std::string& fname)
+      : target_(std::move(target)),
+        env_(env),
+        writer_(writer),
+        file_name_(IOTraceFileName(fname)),
+        offset_(0) {}
+
+  virtual Status Read(size_t n, Slice* result, char* scratch) override {
+    IOTraceTimer timer(env_, writer_);
+    Status s = target_->Read(n, result, scratch);
+    timer.Record(kIOTraceRead, file_name_, offset_, result->size(), s);
+    offset_ += result->size();
+    return s;
+  }
+
+  virtual Status Skip(uint64_t n) override {
+    offset_ += n;
+    return target_->Skip(n);
+  }
+
+  virtual bool use_direct_io() const override {
+    return target_->use_direct_io();
+  }
+
+  virtual size_t GetRequiredBufferAlignment() const override {
+    return target_->GetRequiredBufferAlignment();
+  }
+
+  virtual Status InvalidateCache(size_t offset, size_t length) override {
+    return target_->InvalidateCache(offset, length);
+  }
+
+  virtual Status PositionedRead(uint64_t offset, size_t n, Slice* result,
+                                char* scratch) override {
+    IOTraceTimer timer(env_, writer_);
+    Status s = target_->PositionedRead(offset, n, result, scratch);
+    timer.Record(kIOTraceRead, file_name_, offset, result->size(), s);
+    return s;
+  }
+
+ private:
+  std::unique_ptr<SequentialFile> target_;
+  Env* env_;
+  IOTraceWriter* writer_;
+  const std::string file_name_;
+  uint64_t offset_;
+};
+
+class IOTracingRandomAccessFile : public RandomAccessFile {
+ public:
+  IOTracingRandomAccessFile(std::unique_ptr<RandomAccessFile>&& target,
+                            Env* env, IOTraceWriter* writer,
+                            const std::string& fname)
+      : target_(std::move(target)),
+        env_(env),
+        writer_(writer),
+        file_name_(IOTraceFileName(fname)) {}
+
+  virtual Status Read(uint64_t offset, size_t n, Slice* result,
+                      char* scratch) const override {
+    IOTraceTimer timer(env_, writer_);
+    Status s = target_->Read(offset, n, result, scratch);
+    timer.Record(kIOTraceRead, file_name_, offset, result->size(), s);
+    return s;
+  }
+
+  virtual Status Prefetch(uint64_t offset, size_t n) override {
+    return target_->Prefetch(offset, n);
+  }
+
+  virtual size_t GetUniqueId(char* id, size_t max_size) const override {
+    return target_->GetUniqueId(id, max_size);
+  }
+
+  virtual void Hint(AccessPattern pattern) override { target_->Hint(pattern); }
+
+  virtual bool use_direct_io() const override {
+    return target_->use_direct_io();
+  }
+
+  virtual size_t GetRequiredBufferAlignment() const override {
+    return target_->GetRequiredBufferAlignment();
+  }
+
+  virtual Status InvalidateCache(size_t offset, size_t length) override {
+    return target_->InvalidateCache(offset, length);
+  }
+
+ private:
+  std::unique_ptr<RandomAccessFile> target_;
+  Env* env_;
+  IOTraceWriter* writer_;
+  const std::string file_name_;
+};
+
+// Derives from WritableFileWrapper to forward the protected methods
+class IOTracingWritableFile : public WritableFileWrapper {
+ public:
+  IOTracingWritableFile(std::unique_ptr<WritableFile>&& target, Env* env,
+                        IOTraceWriter* writer, const std::string& fname)
+      : WritableFileWrapper(target.get()),
+        target_(std::move(target)),
+        env_(env),
+        writer_(writer),
+        file_name_(IOTraceFileName(fname)),
+        offset_(target_->GetFileSize()) {}
+
+  virtual Status Append(const Slice& data) override {
+    IOTraceTimer timer(env_, writer_);
+    Status s = target_->Append(data);
+    timer.Record(kIOTraceWrite, file_name_, offset_, data.size(), s);
+    offset_ += data.size();
+    return s;
+  }
+
+  virtual Status PositionedAppend(const Slice& data,
+                                  uint64_t offset) override {
+    IOTraceTimer timer(env_, writer_);
+    Status s = target_->PositionedAppend(data, offset);
+    timer.Record(kIOTraceWrite, file_name_, offset, data.size(), s);
+    offset_ = std::max(offset_, offset + data.size());
+    return s;
+  }
+
+  virtual Status Truncate(uint64_t size) override {
+    IOTraceTimer timer(env_, writer_);
+    Status s = target_->Truncate(size);
+    timer.Record(kIOTraceTruncate, file_name_, size, 0, s);
+    offset_ = size;
+    return s;
+  }
+
+  virtual Status Close() override {
+    IOTraceTimer timer(env_, writer_);
+    Status s = target_->Close();
+    timer.Record(kIOTraceClose, file_name_, offset_, 0, s);
+    return s;
+  }
+
+  virtual Status Sync() override {
+    IOTraceTimer timer(env_, writer_);
+    Status s = target_->Sync();
+    timer.Record(kIOTraceSync, file_name_, offset_, 0, s);
+    return s;
+  }
+
+  virtual Status Fsync() override {
+    IOTraceTimer timer(env_, writer_);
+    Status s = target_->Fsync();
+    timer.Record(kIOTraceFsync, file_name_, offset_, 0, s);
+    return s;
+  }
+
+  virtual bool use_direct_io() const override {
+    return target_->use_direct_io();
+  }
+
+  virtual size_t GetRequiredBufferAlignment() const override {
+    return target_->GetRequiredBufferAlignment();
+  }
+
+ protected:
+  virtual Status RangeSync(uint64_t offset, uint64_t nbytes) override {
+    IOTraceTimer timer(env_, writer_);
+    Status s = WritableFileWrapper::RangeSync(offset, nbytes);
+    timer.Record(kIOTraceRangeSync, file_name_, offset, nbytes, s);
+    return s;
+  }
+
+ private:
+  std::unique_ptr<WritableFile> target_;
+  Env* env_;
+  IOTraceWriter* writer_;
+  const std::string file_name_;
+  uint64_t offset_;
+};
+
+class IOTracingRandomRWFile : public RandomRWFile {
+ public:
+  IOTracingRandomRWFile(std::unique_ptr<RandomRWFile>&& target, Env* env,
+                        IOTraceWriter* writer, const std::string& fname)
+      : target_(std::move(target)),
+        env_(env),
+        writer_(writer),
+        file_name_(IOTraceFileName(fname)) {}
+
+  virtual bool use_direct_io() const override {
+    return target_->use_direct_io();
+  }
+
+  virtual size_t GetRequiredBufferAlignment() const override {
+    return target_->GetRequiredBufferAlignment();
+  }
+
+  virtual Status Write(uint64_t offset, const Slice& data) override {
+    IOTraceTimer timer(env_, writer_);
+    Status s = target_->Write(offset, data);
+    timer.Record(kIOTraceWrite, file_name_, offset, data.size(), s);
+    return s;
+  }
+
+  virtual Status Read(uint64_t offset, size_t n, Slice* result,
+                      char* scratch) const override {
+    IOTraceTimer timer(env_, writer_);
+    Status s = target_->Read(offset, n, result, scratch);
+    timer.Record(kIOTraceRead, file_name_, offset, result->size(), s);
+    return s;
+  }
+
+  virtual Status Flush() override { return target_->Flush(); }
+
+  virtual Status Sync() override {
+    IOTraceTimer timer(env_, writer_);
+    Status s = target_->Sync();
+    timer.Record(kIOTraceSync, file_name_, 0, 0, s);
+    return s;
+  }
+
+  virtual Status Fsync() override {
+    IOTraceTimer timer(env_, writer_);
+    Status s = target_->Fsync();
+    timer.Record(kIOTraceFsync, file_name_, 0, 0, s);
+    return s;
+  }
+
+  virtual Status Close() override {
+    IOTraceTimer timer(env_, writer_);
+    Status s = target_->Close();
+    timer.Record(kIOTraceClose, file_name_, 0, 0, s);
+    return s;
+  }
+
+ private:
+  std::unique_ptr<RandomRWFile> target_;
+  Env* env_;
+  IOTraceWriter* writer_;
+  const std::string file_name_;
+};
+
+// An environment that records the file operations done through it in an
+// I/O trace. The trace itself is written through the base Env.
+class IOTracingEnv : public EnvWrapper {
+ public:
+  IOTracingEnv(Env* base_env, std::unique_ptr<IOTraceWriter>&& writer)
+      : EnvWrapper(base_env), writer_(std::move(writer)) {}
+
+  virtual Status NewSequentialFile(const std::string& fname,
+                                   unique_ptr<SequentialFile>* result,
+                                   const EnvOptions& options) override {
+    IOTraceTimer timer(target(), writer_.get());
+    unique_ptr<SequentialFile> file;
+    Status s = EnvWrapper::NewSequentialFile(fname, &file, options);
+    timer.Record(kIOTraceOpen, IOTraceFileName(fname), 0, 0, s);
+    if (s.ok()) {
+      result->reset(new IOTracingSequentialFile(std::move(file), target(),
+                                                writer_.get(), fname));
+    }
+    return s;
+  }
+
+  virtual Status NewRandomAccessFile(const std::string& fname,
+                                     unique_ptr<RandomAccessFile>* result,
+                                     const EnvOptions& options) override {
+    IOTraceTimer timer(target(), writer_.get());
+    unique_ptr<RandomAccessFile> file;
+    Status s = EnvWrapper::NewRandomAccessFile(fname, &file, options);
+    timer.Record(kIOTraceOpen, IOTraceFileName(fname), 0, 0, s);
+    if (s.ok()) {
+      result->reset(new IOTracingRandomAccessFile(std::move(file), target(),
+                                                  writer_.get(), fname));
+    }
+    return s;
+  }
+
+  virtual Status NewWritableFile(const std::string& fname,
+                                 unique_ptr<WritableFile>* result,
+                                 const EnvOptions& options) override {
+    IOTraceTimer timer(target(), writer_.get());
+    unique_ptr<WritableFile> file;
+    Status s = EnvWrapper::NewWritableFile(fname, &file, options);
+    timer.Record(kIOTraceOpen, IOTraceFileName(fname), 0, 0, s);
+    if (s.ok()) {
+      result->reset(new IOTracingWritableFile(std::move(file), target(),
+                                              writer_.get(), fname));
+    }
+    return s;
+  }
+
+  virtual Status ReopenWritableFile(const std::string& fname,
+                                    unique_ptr<WritableFile>* result,
+                                    const EnvOptions& options) override {
+    IOTraceTimer timer(target(), writer_.get());
+    unique_ptr<WritableFile> file;
+    Status s = EnvWrapper::ReopenWritableFile(fname, &file, options);
+    timer.Record(kIOTraceOpen, IOTraceFileName(fname), 0, 0, s);
+    if (s.ok()) {
+      result->reset(new IOTracingWritableFile(std::move(file), target(),
+                                              writer_.get(), fname));
+    }
+    return s;
+  }
+
+  virtual Status ReuseWritableFile(const std::string& fname,
+                                   const std::string& old_fname,
+                                   unique_ptr<WritableFile>* result,
+                                   const EnvOptions& options) override {
+    IOTraceTimer timer(target(), writer_.get());
+    unique_ptr<WritableFile> file;
+    Status s = EnvWrapper::ReuseWritableFile(fname, old_fname, &file, options);
+    timer.Record(kIOTraceOpen, IOTraceFileName(fname), 0, 0, s);
+    if (s.ok()) {
+      result->reset(new IOTracingWritableFile(std::move(file), target(),
+                                              writer_.get(), fname));
+    }
+    return s;
+  }
+
+  virtual Status NewRandomRWFile(const std::string& fname,
+                                 unique_ptr<RandomRWFile>* result,
+                                 const EnvOptions& options) override {
+    IOTraceTimer timer(target(), writer_.get());
+    unique_ptr<RandomRWFile> file;
+    Status s = EnvWrapper::NewRandomRWFile(fname, &file, options);
+    timer.Record(kIOTraceOpen, IOTraceFileName(fname), 0, 0, s);
+    if (s.ok()) {
+      result->reset(new IOTracingRandomRWFile(std::move(file), target(),
+                                              writer_.get(), fname));
+    }
+    return s;
+  }
+
+  virtual Status DeleteFile(const std::string& fname) override {
+    IOTraceTimer timer(target(), writer_.get());
+    Status s = EnvWrapper::DeleteFile(fname);
+    timer.Record(kIOTraceDelete, IOTraceFileName(fname), 0, 0, s);
+    return s;
+  }
+
+  virtual Status RenameFile(const std::string& src,
+                            const std::string& target_name) override {
+    IOTraceTimer timer(target(), writer_.get());
+    Status s = EnvWrapper::RenameFile(src, target_name);
+    timer.Record(kIOTraceRename, IOTraceFileName(src), 0, 0, s);
+    return s;
+  }
+
+ private:
+  std::unique_ptr<IOTraceWriter> writer_;
+};
+
+}  // namespace
+
+Status NewIOTracingEnv(Env* base_env, const std::string& trace_filename,
+                       uint64_t max_trace_file_size, Env** result) {
+  std::unique_ptr<IOTraceWriter> writer;
+  Status s = IOTraceWriter::Open(base_env, trace_filename, max_trace_file_size,
+                                 &writer);
+  if (!s.ok()) {
+    return s;
+  }
+  *result = new IOTracingEnv(base_env, std::move(writer));
+  return Status::OK();
+}
+
+#else  // ROCKSDB_LITE
+
+Status NewIOTracingEnv(Env* base_env, const std::string& trace_filename,
+                       uint64_t max_trace_file_size, Env** result) {
+  return Status::NotSupported("Not supported in ROCKSDB_LITE");
+}
+
+#endif  // !ROCKSDB_LITE
+
+}  // namespace rocksdb
@@ -0,0 +1,146 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#ifndef ROCKSDB_LITE
+
+#include <memory>
+#include <string>
+
+#include "port/port.h"
+#include "rocksdb/env.h"
+#include "rocksdb/thread_status.h"
+
+namespace rocksdb {
+
+// The file operation of an I/O trace record
+enum IOTraceOp : char {
+  kIOTraceOpen = 1,
+  kIOTraceRead = 2,
+  kIOTraceWrite = 3,
+  kIOTraceSync = 4,
+  kIOTraceFsync = 5,
+  kIOTraceRangeSync = 6,
+  kIOTraceTruncate = 7,
+  kIOTraceClose = 8,
+  kIOTraceDelete = 9,
+  kIOTraceRename = 10,
+  // All operations should be added before kIOTraceOpMax
+  kIOTraceOpMax,
+};
+
+extern const char* IOTraceOpName(IOTraceOp op);
+
+// One file operation done through the Env of NewIOTracingEnv()
+struct IOTraceRecord {
+  // When the operation started, in microseconds since the epoch
+  uint64_t timestamp = 0;
+  // The position of a read or write in the file, the size for a truncate
+  uint64_t offset = 0;
+  // The bytes read or written
+  uint64_t length = 0;
+  uint64_t latency_nanos = 0;
+  IOTraceOp op = kIOTraceOpMax;
+  // The pool of the thread, and what it was doing (only known with
+  // DBOptions::enable_thread_tracking)
+  ThreadStatus::ThreadType thread_type = ThreadStatus::USER;
+  ThreadStatus::OperationType operation_type = ThreadStatus::OP_UNKNOWN;
+  bool ok = true;
+  // The name of the file without its directory, cut to
+  // kIOTraceMaxFileNameLength bytes
+  std::string file_name;
+};
+
+// An I/O trace is a ring buffer of fixed-size slots in one file, so that it
+// keeps the latest records once it is full. The file starts with a header
+// of one slot:
+//    magic: 8 bytes
+//    format version: fixed32
+//    slot size: fixed32
+//    number of record slots: fixed64
+//    number of records ever written: fixed64
+// and the record slots follow, record i in slot i modulo their number:
+//    timestamp: fixed64
+//    offset: fixed64
+//    length: fixed64
+//    latency in nanoseconds: fixed64
+//    op: uint8
+//    thread type: uint8
+//    operation type: uint8
+//    flags: uint8, 1 if the operation failed
+//    file name: uint8 length + kIOTraceMaxFileNameLength bytes
+const uint32_t kIOTraceFormatVersion = 1;
+const size_t kIOTraceSlotSize = 64;
+const size_t kIOTraceMaxFileNameLength = 27;
+
+// IOTraceWriter writes the records of an I/O trace to a file through env.
+// The records are buffered and written to their slots in batches.
+// Thread-safe.
+class IOTraceWriter {
+ public:
+  // Creates the trace file, with room for the records of
+  // max_trace_file_size bytes, at least one
+  static Status Open(Env* env, const std::string& trace_filename,
+                     uint64_t max_trace_file_size,
+                     std::unique_ptr<IOTraceWriter>* writer);
+
+  ~IOTraceWriter();
+
+  void Write(const IOTraceRecord& record);
+
+  // Writes the buffered records and the header
+  Status Flush();
+
+  uint64_t num_records() const;
+
+ private:
+  IOTraceWriter(std::unique_ptr<RandomRWFile>&& file, uint64_t num_slots);
+
+  // REQUIRES: mutex_ held
+  Status FlushLocked();
+
+  static const size_t kBufferedRecords = 256;
+
+  std::unique_ptr<RandomRWFile> file_;
+  const uint64_t num_slots_;
+  mutable port::Mutex mutex_;
+  std::string buffer_;
+  // The records written to the file, plus the ones in buffer_
+  uint64_t num_records_;
+  uint64_t num_flushed_records_;
+  Status status_;
+};
+
+// IOTraceReader returns the records of an I/O trace from the oldest one
+// kept to the newest.
+class IOTraceReader {
+ public:
+  static Status Open(Env* env, const std::string& trace_filename,
+                     std::unique_ptr<IOTraceReader>* reader);
+
+  // Returns Status::Incomplete after the last record
+  Status Read(IOTraceRecord* record);
+
+  // The records ever written to the trace, including the ones overwritten
+  uint64_t num_records_written() const { return num_records_written_; }
+
+ private:
+  IOTraceReader(std::unique_ptr<RandomAccessFile>&& file, uint64_t num_slots,
+                uint64_t num_records_written);
+
+  std::unique_ptr<RandomAccessFile> file_;
+  const uint64_t num_slots_;
+  const uint64_t num_records_written_;
+  // The number of the next record to read
+  uint64_t next_record_;
+};
+
+extern void EncodeIOTraceRecord(const IOTraceRecord& record, char* slot);
+extern Status DecodeIOTraceRecord(const Slice& slot, IOTraceRecord* record);
+
+}  // namespace rocksdb
+
+#endif  // ROCKSDB_LITE
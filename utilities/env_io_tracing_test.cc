@@ -0,0 +1,183 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include "utilities/env_io_tracing.h"
+
+#include <vector>
+
+#include "rocksdb/env.h"
+#include "util/testharness.h"
+#include "util/testutil.h"
+
+namespace rocksdb {
+
+class IOTracingEnvTest : public testing::Test {
+ public:
+  IOTracingEnvTest()
+      : env_(Env::Default()),
+        test_dir_(test::TmpDir(env_) + "/env_io_tracing_test"),
+        trace_path_(test_dir_ + "/io_trace") {
+    env_->CreateDirIfMissing(test_dir_);
+  }
+
+  ~IOTracingEnvTest() {
+    env_->DeleteFile(trace_path_);
+    env_->DeleteFile(test_dir_ + "/f");
+    env_->DeleteFile(test_dir_ + "/g");
+    env_->DeleteDir(test_dir_);
+  }
+
+  std::vector<IOTraceRecord> ReadTrace(uint64_t* num_records_written) {
+    std::vector<IOTraceRecord> records;
+    std::unique_ptr<IOTraceReader> reader;
+    EXPECT_OK(IOTraceReader::Open(env_, trace_path_, &reader));
+    Status s;
+    while (true) {
+      IOTraceRecord record;
+      s = reader->Read(&record);
+      if (!s.ok()) {
+        break;
+      }
+      records.push_back(record);
+    }
+    EXPECT_TRUE(s.IsIncomplete());
+    *num_records_written = reader->num_records_written();
+    return records;
+  }
+
+  Env* env_;
+  const std::string test_dir_;
+  const std::string trace_path_;
+};
+
+TEST_F(IOTracingEnvTest, EncodeDecode) {
+  IOTraceRecord record;
+  record.timestamp = 1500000000000000;
+  record.offset = 4096;
+  record.length = 100;
+  record.latency_nanos = 12345;
+  record.op = kIOTraceWrite;
+  record.thread_type = ThreadStatus::LOW_PRIORITY;
+  record.operation_type = ThreadStatus::OP_COMPACTION;
+  record.ok = false;
+  record.file_name = std::string(40, 'x');
+  char slot[kIOTraceSlotSize];
+  EncodeIOTraceRecord(record, slot);
+
+  IOTraceRecord decoded;
+  ASSERT_OK(DecodeIOTraceRecord(Slice(slot, kIOTraceSlotSize), &decoded));
+  ASSERT_EQ(record.timestamp, decoded.timestamp);
+  ASSERT_EQ(record.offset, decoded.offset);
+  ASSERT_EQ(record.length, decoded.length);
+  ASSERT_EQ(record.latency_nanos, decoded.latency_nanos);
+  ASSERT_EQ(kIOTraceWrite, decoded.op);
+  ASSERT_EQ(ThreadStatus::LOW_PRIORITY, decoded.thread_type);
+  ASSERT_EQ(ThreadStatus::OP_COMPACTION, decoded.operation_type);
+  ASSERT_FALSE(decoded.ok);
+  // The file name is cut
+  ASSERT_EQ(std::string(kIOTraceMaxFileNameLength, 'x'), decoded.file_name);
+
+  slot[32] = 0;
+  ASSERT_TRUE(
+      DecodeIOTraceRecord(Slice(slot, kIOTraceSlotSize), &decoded)
+          .IsCorruption());
+}
+
+TEST_F(IOTracingEnvTest, TraceFileOperations) {
+  Env* tracing_env = nullptr;
+  ASSERT_OK(NewIOTracingEnv(env_, trace_path_, 1 << 20, &tracing_env));
+  std::unique_ptr<Env> tracing_env_guard(tracing_env);
+  const std::string fname = test_dir_ + "/f";
+  {
+    std::unique_ptr<WritableFile> file;
+    ASSERT_OK(tracing_env->NewWritableFile(fname, &file, EnvOptions()));
+    ASSERT_OK(file->Append("hello"));
+    ASSERT_OK(file->Append(" world"));
+    ASSERT_OK(file->Sync());
+    ASSERT_OK(file->Close());
+  }
+  {
+    std::unique_ptr<RandomAccessFile> file;
+    ASSERT_OK(tracing_env->NewRandomAccessFile(fname, &file, EnvOptions()));
+    char scratch[10];
+    Slice result;
+    ASSERT_OK(file->Read(6, 5, &result, scratch));
+    ASSERT_EQ("world", result.ToString());
+  }
+  ASSERT_OK(tracing_env->RenameFile(fname, test_dir_ + "/g"));
+  ASSERT_OK(tracing_env->DeleteFile(test_dir_ + "/g"));
+  // Writes the buffered records
+  tracing_env_guard.reset();
+
+  uint64_t num_records_written = 0;
+  std::vector<IOTraceRecord> records = ReadTrace(&num_records_written);
+  ASSERT_EQ(9U, records.size());
+  ASSERT_EQ(9U, num_records_written);
+  const IOTraceOp expected_ops[] = {
+      kIOTraceOpen, kIOTraceWrite, kIOTraceWrite, kIOTraceSync, kIOTraceClose,
+      kIOTraceOpen, kIOTraceRead,  kIOTraceRename, kIOTraceDelete};
+  for (size_t i = 0; i < records.size(); i++) {
+    ASSERT_EQ(expected_ops[i], records[i].op);
+    ASSERT_TRUE(records[i].ok);
+    ASSERT_EQ(ThreadStatus::USER, records[i].thread_type);
+  }
+  ASSERT_EQ("f", records[0].file_name);
+  ASSERT_EQ(0U, records[1].offset);
+  ASSERT_EQ(5U, records[1].length);
+  ASSERT_EQ(5U, records[2].offset);
+  ASSERT_EQ(6U, records[2].length);
+  ASSERT_EQ(6U, records[6].offset);
+  ASSERT_EQ(5U, records[6].length);
+  ASSERT_EQ("g", records[8].file_name);
+}
+
+TEST_F(IOTracingEnvTest, RingBuffer) {
+  // Room for 10 records
+  const uint64_t kNumSlots = 10;
+  const uint64_t kNumRecords = 1000;
+  {
+    std::unique_ptr<IOTraceWriter> writer;
+    ASSERT_OK(IOTraceWriter::Open(env_, trace_path_,
+                                  (kNumSlots + 1) * kIOTraceSlotSize, &writer));
+    for (uint64_t i = 0; i < kNumRecords; i++) {
+      IOTraceRecord record;
+      record.op = kIOTraceRead;
+      record.offset = i;
+      writer->Write(record);
+    }
+    ASSERT_EQ(kNumRecords, writer->num_records());
+  }
+  uint64_t file_size = 0;
+  ASSERT_OK(env_->GetFileSize(trace_path_, &file_size));
+  ASSERT_EQ((kNumSlots + 1) * kIOTraceSlotSize, file_size);
+
+  // The latest records are kept, oldest first
+  uint64_t num_records_written = 0;
+  std::vector<IOTraceRecord> records = ReadTrace(&num_records_written);
+  ASSERT_EQ(kNumRecords, num_records_written);
+  ASSERT_EQ(kNumSlots, records.size());
+  for (uint64_t i = 0; i < kNumSlots; i++) {
+    ASSERT_EQ(kNumRecords - kNumSlots + i, records[i].offset);
+  }
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#else  // ROCKSDB_LITE
+#include <stdio.h>
+
+int main(int argc, char** argv) {
+  fprintf(stderr, "SKIPPED as IOTracingEnv is not supported in ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,317 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "utilities/simulator_cache/cache_simulator.h"
+
+#include <algorithm>
+#include <deque>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "rocksdb/cache.h"
+
+namespace rocksdb {
+
+namespace {
+
+// Computes the miss ratios of an LRU cache at all the capacities at once.
+// An LRU cache of capacity C holds the most recently used blocks whose sizes
+// add up to at most C, so an access hits iff the block, plus the blocks used
+// since its previous access, fit in C. Those bytes (its stack distance) are
+// kept in a Fenwick tree indexed by the position of the last access to each
+// block.
+//
+// An access with no_insert leaves the stack as it is, whether it would hit at
+// a capacity or not.
+class LRUStackSimulator : public MissRatioSimulator {
+ public:
+  explicit LRUStackSimulator(const std::vector<uint64_t>& capacities)
+      : MissRatioSimulator(capacities),
+        first_hits_(capacities_.size(), 0),
+        tree_(kMinTreeSize + 1, 0),
+        next_position_(1) {}
+
+  virtual const char* Name() const override { return "lru"; }
+
+  virtual void Access(const BlockCacheTraceRecord& access) override {
+    num_accesses_++;
+    if (next_position_ == tree_.size()) {
+      Compact();
+    }
+    auto iter = blocks_.find(access.block_key);
+    if (iter != blocks_.end()) {
+      Block& block = iter->second;
+      uint64_t distance =
+          static_cast<uint64_t>(Sum(next_position_ - 1) - Sum(block.position)) +
+          access.block_size;
+      auto first_hit =
+          std::lower_bound(capacities_.begin(), capacities_.end(), distance);
+      if (first_hit != capacities_.end()) {
+        first_hits_[first_hit - capacities_.begin()]++;
+      }
+      if (access.no_insert) {
+        return;
+      }
+      Add(block.position, -static_cast<int64_t>(block.size));
+    } else if (access.no_insert) {
+      return;
+    }
+    Block& block = blocks_[access.block_key];
+    block.position = next_position_++;
+    block.size = access.block_size;
+    Add(block.position, static_cast<int64_t>(block.size));
+  }
+
+  virtual uint64_t num_misses(size_t i) const override {
+    uint64_t hits = 0;
+    for (size_t j = 0; j <= i; j++) {
+      hits += first_hits_[j];
+    }
+    return num_accesses_ - hits;
+  }
+
+ private:
+  static const size_t kMinTreeSize = 1024;
+
+  struct Block {
+    uint64_t position = 0;
+    uint64_t size = 0;
+  };
+
+  void Add(uint64_t position, int64_t delta) {
+    for (; position < tree_.size(); position += position & (~position + 1)) {
+      tree_[position] += delta;
+    }
+  }
+
+  // The bytes of the blocks last accessed at positions [1, position]
+  int64_t Sum(uint64_t position) const {
+    int64_t sum = 0;
+    for (; position > 0; position -= position & (~position + 1)) {
+      sum += tree_[position];
+    }
+    return sum;
+  }
+
+  // Renumbers the blocks from 1 in the order of their last access, and
+  // leaves room for as many new accesses
+  void Compact() {
+    std::vector<Block*> blocks;
+    blocks.reserve(blocks_.size());
+    for (auto& entry : blocks_) {
+      blocks.push_back(&entry.second);
+    }
+    std::sort(blocks.begin(), blocks.end(), [](const Block* a, const Block* b) {
+      return a->position < b->position;
+    });
+    tree_.assign(std::max(2 * blocks.size(), kMinTreeSize) + 1, 0);
+    next_position_ = 1;
+    for (Block* block : blocks) {
+      block->position = next_position_++;
+      Add(block->position, static_cast<int64_t>(block->size));
+    }
+  }
+
+  // first_hits_[i] counts the accesses that hit at capacities_[i] but not at
+  // the smaller capacities
+  std::vector<uint64_t> first_hits_;
+  std::unordered_map<std::string, Block> blocks_;
+  std::vector<int64_t> tree_;
+  uint64_t next_position_;
+};
+
+// A cache of one capacity
+class SimulatedCache {
+ public:
+  virtual ~SimulatedCache() {}
+
+  // Returns whether the block is in the cache. If not, inserts it unless
+  // access.no_insert.
+  virtual bool Lookup(const BlockCacheTraceRecord& access) = 0;
+};
+
+class FIFOSimulatedCache : public SimulatedCache {
+ public:
+  explicit FIFOSimulatedCache(uint64_t capacity)
+      : capacity_(capacity), usage_(0) {}
+
+  virtual bool Lookup(const BlockCacheTraceRecord& access) override {
+    if (keys_.count(access.block_key) > 0) {
+      return true;
+    }
+    if (!access.no_insert && access.block_size <= capacity_) {
+      while (usage_ + access.block_size > capacity_) {
+        usage_ -= queue_.front().second;
+        keys_.erase(queue_.front().first);
+        queue_.pop_front();
+      }
+      queue_.emplace_back(access.block_key, access.block_size);
+      keys_.insert(access.block_key);
+      usage_ += access.block_size;
+    }
+    return false;
+  }
+
+ private:
+  const uint64_t capacity_;
+  uint64_t usage_;
+  std::deque<std::pair<std::string, uint64_t>> queue_;
+  std::unordered_set<std::string> keys_;
+};
+
+// The blocks form a ring swept by a hand. A hit sets the reference bit of the
+// block; the hand evicts the first block without the bit, clearing the bits
+// on its way. New blocks are inserted behind the hand.
+class ClockSimulatedCache : public SimulatedCache {
+ public:
+  explicit ClockSimulatedCache(uint64_t capacity)
+      : capacity_(capacity), usage_(0), hand_(ring_.end()) {}
+
+  virtual bool Lookup(const BlockCacheTraceRecord& access) override {
+    auto iter = blocks_.find(access.block_key);
+    if (iter != blocks_.end()) {
+      iter->second->referenced = true;
+      return true;
+    }
+    if (!access.no_insert && access.block_size <= capacity_) {
+      while (usage_ + access.block_size > capacity_) {
+        if (hand_ == ring_.end()) {
+          hand_ = ring_.begin();
+        }
+        if (hand_->referenced) {
+          hand_->referenced = false;
+          ++hand_;
+        } else {
+          usage_ -= hand_->size;
+          blocks_.erase(hand_->key);
+          hand_ = ring_.erase(hand_);
+        }
+      }
+      auto entry = ring_.insert(hand_, Entry{access.block_key,
+                                             access.block_size, false});
+      blocks_[access.block_key] = entry;
+      usage_ += access.block_size;
+    }
+    return false;
+  }
+
+ private:
+  struct Entry {
+    std::string key;
+    uint64_t size;
+    bool referenced;
+  };
+
+  const uint64_t capacity_;
+  uint64_t usage_;
+  std::list<Entry> ring_;
+  std::list<Entry>::iterator hand_;
+  std::unordered_map<std::string, std::list<Entry>::iterator> blocks_;
+};
+
+// rocksdb's LRUCache, unsharded, with index and filter blocks in the high
+// priority pool
+class LRUPrioritySimulatedCache : public SimulatedCache {
+ public:
+  explicit LRUPrioritySimulatedCache(uint64_t capacity)
+      : cache_(NewLRUCache(static_cast<size_t>(capacity),
+                           0 /* num_shard_bits */,
+                           false /* strict_capacity_limit */,
+                           0.5 /* high_pri_pool_ratio */)) {}
+
+  virtual bool Lookup(const BlockCacheTraceRecord& access) override {
+    Cache::Handle* handle = cache_->Lookup(access.block_key);
+    if (handle != nullptr) {
+      cache_->Release(handle);
+      return true;
+    }
+    if (!access.no_insert) {
+      cache_->Insert(access.block_key, nullptr /* value */,
+                     static_cast<size_t>(access.block_size),
+                     nullptr /* deleter */, nullptr /* handle */,
+                     access.block_type == kBlockTraceDataBlock
+                         ? Cache::Priority::LOW
+                         : Cache::Priority::HIGH);
+    }
+    return false;
+  }
+
+ private:
+  std::shared_ptr<Cache> cache_;
+};
+
+// Simulates a SimulatedCache per capacity
+template <class CacheType>
+class PerCapacitySimulator : public MissRatioSimulator {
+ public:
+  PerCapacitySimulator(const char* name,
+                       const std::vector<uint64_t>& capacities)
+      : MissRatioSimulator(capacities),
+        name_(name),
+        misses_(capacities_.size(), 0) {
+    for (uint64_t capacity : capacities_) {
+      caches_.emplace_back(new CacheType(capacity));
+    }
+  }
+
+  virtual const char* Name() const override { return name_; }
+
+  virtual void Access(const BlockCacheTraceRecord& access) override {
+    num_accesses_++;
+    for (size_t i = 0; i < caches_.size(); i++) {
+      if (!caches_[i]->Lookup(access)) {
+        misses_[i]++;
+      }
+    }
+  }
+
+  virtual uint64_t num_misses(size_t i) const override { return misses_[i]; }
+
+ private:
+  const char* name_;
+  std::vector<std::unique_ptr<SimulatedCache>> caches_;
+  std::vector<uint64_t> misses_;
+};
+
+}  // namespace
+
+MissRatioSimulator::MissRatioSimulator(const std::vector<uint64_t>& capacities)
+    : capacities_(capacities), num_accesses_(0) {
+  std::sort(capacities_.begin(), capacities_.end());
+}
+
+double MissRatioSimulator::miss_ratio(size_t i) const {
+  if (num_accesses_ == 0) {
+    return 0;
+  }
+  return static_cast<double>(num_misses(i)) / num_accesses_;
+}
+
+const std::vector<std::string>& MissRatioSimulatorPolicies() {
+  static const std::vector<std::string> policies = {"lru", "clock", "fifo",
+                                                    "lru_priority"};
+  return policies;
+}
+
+std::unique_ptr<MissRatioSimulator> NewMissRatioSimulator(
+    const std::string& policy, const std::vector<uint64_t>& capacities) {
+  std::unique_ptr<MissRatioSimulator> simulator;
+  if (policy == "lru") {
+    simulator.reset(new LRUStackSimulator(capacities));
+  } else if (policy == "clock") {
+    simulator.reset(
+        new PerCapacitySimulator<ClockSimulatedCache>("clock", capacities));
+  } else if (policy == "fifo") {
+    simulator.reset(
+        new PerCapacitySimulator<FIFOSimulatedCache>("fifo", capacities));
+  } else if (policy == "lru_priority") {
+    simulator.reset(new PerCapacitySimulator<LRUPrioritySimulatedCache>(
+        "lru_priority", capacities));
+  }
+  return simulator;
+}
+
+}  // namespace rocksdb
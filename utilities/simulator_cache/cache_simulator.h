@@ -0,0 +1,59 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "util/block_cache_tracer.h"
+
+namespace rocksdb {
+
+// MissRatioSimulator replays the accesses of a block cache trace (see
+// DB::StartBlockCacheTrace()) against a cache replacement policy at several
+// capacities at once, which gives the miss ratio curve of the policy in one
+// pass over the trace.
+//
+// A block is charged its traced size. Accesses with no_insert do not insert
+// the block on a miss.
+class MissRatioSimulator {
+ public:
+  virtual ~MissRatioSimulator() {}
+
+  virtual const char* Name() const = 0;
+
+  virtual void Access(const BlockCacheTraceRecord& access) = 0;
+
+  // The simulated capacities in bytes, in increasing order
+  const std::vector<uint64_t>& capacities() const { return capacities_; }
+  uint64_t num_accesses() const { return num_accesses_; }
+  // The number of accesses that missed at capacities()[i]
+  virtual uint64_t num_misses(size_t i) const = 0;
+  // In [0, 1]; 0 before the first access
+  double miss_ratio(size_t i) const;
+
+ protected:
+  explicit MissRatioSimulator(const std::vector<uint64_t>& capacities);
+
+  std::vector<uint64_t> capacities_;
+  uint64_t num_accesses_;
+};
+
+// The names of the policies NewMissRatioSimulator() knows:
+//   lru: least recently used, computed for all capacities at once from the
+//        stack distance of each access
+//   clock: CLOCK (second chance)
+//   fifo: first in, first out
+//   lru_priority: rocksdb's LRUCache, with half of it reserved for index and
+//        filter blocks (cache_index_and_filter_blocks_with_high_priority)
+extern const std::vector<std::string>& MissRatioSimulatorPolicies();
+
+// Returns nullptr if policy is unknown
+extern std::unique_ptr<MissRatioSimulator> NewMissRatioSimulator(
+    const std::string& policy, const std::vector<uint64_t>& capacities);
+
+}  // namespace rocksdb
@@ -0,0 +1,151 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "utilities/simulator_cache/cache_simulator.h"
+
+#include <list>
+#include <unordered_map>
+
+#include "util/random.h"
+#include "util/string_util.h"
+#include "util/testharness.h"
+
+namespace rocksdb {
+
+class CacheSimulatorTest : public testing::Test {
+ public:
+  static BlockCacheTraceRecord Access(const std::string& key,
+                                      uint64_t size = 1,
+                                      bool no_insert = false) {
+    BlockCacheTraceRecord access;
+    access.block_key = key;
+    access.block_type = kBlockTraceDataBlock;
+    access.block_size = size;
+    access.no_insert = no_insert;
+    return access;
+  }
+
+  // Returns the number of misses of each policy on the accesses to keys,
+  // with a cache of capacity blocks of size 1
+  static std::unordered_map<std::string, uint64_t> CountMisses(
+      const std::vector<std::string>& keys, uint64_t capacity) {
+    std::unordered_map<std::string, uint64_t> misses;
+    for (const auto& policy : MissRatioSimulatorPolicies()) {
+      auto simulator = NewMissRatioSimulator(policy, {capacity});
+      for (const auto& key : keys) {
+        simulator->Access(Access(key));
+      }
+      EXPECT_EQ(keys.size(), simulator->num_accesses());
+      misses[policy] = simulator->num_misses(0);
+    }
+    return misses;
+  }
+};
+
+// A straightforward LRU cache, to check the stack distances against
+class ReferenceLRUCache {
+ public:
+  explicit ReferenceLRUCache(uint64_t capacity)
+      : capacity_(capacity), usage_(0) {}
+
+  bool Lookup(const std::string& key, uint64_t size) {
+    auto iter = index_.find(key);
+    if (iter != index_.end()) {
+      lru_.splice(lru_.begin(), lru_, iter->second);
+      return true;
+    }
+    while (usage_ + size > capacity_) {
+      usage_ -= lru_.back().second;
+      index_.erase(lru_.back().first);
+      lru_.pop_back();
+    }
+    lru_.emplace_front(key, size);
+    index_[key] = lru_.begin();
+    usage_ += size;
+    return false;
+  }
+
+ private:
+  typedef std::list<std::pair<std::string, uint64_t>> List;
+  const uint64_t capacity_;
+  uint64_t usage_;
+  List lru_;
+  std::unordered_map<std::string, List::iterator> index_;
+};
+
+TEST_F(CacheSimulatorTest, Policies) {
+  // A B C fill the cache, A hits, D evicts A (fifo) or B (lru, clock)
+  auto misses = CountMisses({"A", "B", "C", "A", "D", "A"}, 3);
+  ASSERT_EQ(4U, misses["lru"]);
+  ASSERT_EQ(4U, misses["lru_priority"]);
+  ASSERT_EQ(4U, misses["clock"]);
+  ASSERT_EQ(5U, misses["fifo"]);
+
+  // Clock gives a second chance to each referenced block: E clears the bits
+  // of A, B and C and evicts D, where LRU evicts A
+  misses = CountMisses({"A", "B", "C", "A", "B", "C", "D", "C", "B", "E", "A"},
+                       4);
+  ASSERT_EQ(6U, misses["lru"]);
+  ASSERT_EQ(5U, misses["clock"]);
+}
+
+TEST_F(CacheSimulatorTest, NoInsert) {
+  for (const auto& policy : MissRatioSimulatorPolicies()) {
+    auto simulator = NewMissRatioSimulator(policy, {10});
+    simulator->Access(Access("A", 1, true /* no_insert */));
+    simulator->Access(Access("A"));
+    simulator->Access(Access("A", 1, true /* no_insert */));
+    ASSERT_EQ(3U, simulator->num_accesses());
+    ASSERT_EQ(2U, simulator->num_misses(0)) << policy;
+    ASSERT_DOUBLE_EQ(2.0 / 3, simulator->miss_ratio(0));
+  }
+}
+
+TEST_F(CacheSimulatorTest, LRUStackDistance) {
+  const std::vector<uint64_t> capacities = {4000, 100, 1000, 20000, 50};
+  auto simulator = NewMissRatioSimulator("lru", capacities);
+  ASSERT_EQ(std::vector<uint64_t>({50, 100, 1000, 4000, 20000}),
+            simulator->capacities());
+  std::vector<ReferenceLRUCache> caches;
+  std::vector<uint64_t> misses;
+  for (uint64_t capacity : simulator->capacities()) {
+    caches.emplace_back(capacity);
+    misses.push_back(0);
+  }
+
+  // Enough accesses for the simulator to renumber its blocks a few times,
+  // with a skewed popularity
+  Random rnd(301);
+  const int kNumBlocks = 500;
+  for (int i = 0; i < 20000; i++) {
+    int block = rnd.Skewed(9) % kNumBlocks;
+    uint64_t size = 1 + block % 50;
+    std::string key = "block" + ToString(block);
+    simulator->Access(Access(key, size));
+    for (size_t j = 0; j < caches.size(); j++) {
+      if (!caches[j].Lookup(key, size)) {
+        misses[j]++;
+      }
+    }
+  }
+  for (size_t j = 0; j < caches.size(); j++) {
+    ASSERT_EQ(misses[j], simulator->num_misses(j)) << j;
+  }
+  // A larger cache never misses more
+  for (size_t j = 1; j < caches.size(); j++) {
+    ASSERT_LE(simulator->miss_ratio(j), simulator->miss_ratio(j - 1));
+  }
+}
+
+TEST_F(CacheSimulatorTest, UnknownPolicy) {
+  ASSERT_EQ(nullptr, NewMissRatioSimulator("random", {100}));
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,731 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include "utilities/simulator_compaction/compaction_simulator.h"
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "db/compaction.h"
+#include "db/compaction_picker_universal.h"
+#include "rocksdb/comparator.h"
+#include "util/filename.h"
+#include "util/log_buffer.h"
+#include "util/string_util.h"
+
+namespace rocksdb {
+
+namespace {
+
+Options SimulatedOptions(const Options& options) {
+  Options result = options;
+  result.comparator = BytewiseComparator();
+  result.compaction_filter = nullptr;
+  result.compaction_filter_factory = nullptr;
+  result.num_levels = std::max(result.num_levels, 1);
+  // The compactions pick their output path among db_paths
+  result.db_paths.clear();
+  result.db_paths.emplace_back("simulated",
+                               std::numeric_limits<uint64_t>::max());
+  return result;
+}
+
+}  // namespace
+
+// The keys in [smallest, largest], of which a fraction coverage is in the
+// file, spread uniformly
+struct CompactionSimulator::KeyRange {
+  uint64_t smallest;
+  uint64_t largest;
+  double coverage;
+
+  double num_entries() const { return coverage * (largest - smallest + 1); }
+};
+
+struct CompactionSimulator::SimFile {
+  FileMetaData meta;
+  KeyRange range;
+  int level;
+};
+
+struct CompactionSimulator::Job {
+  std::unique_ptr<Compaction> compaction;
+  // Keeps the files of the inputs valid for the picker
+  std::shared_ptr<VersionStorageInfo> vstorage;
+  std::vector<SimFile*> inputs;
+  std::vector<KeyRange> outputs;
+  bool trivial_move = false;
+  uint64_t end_micros = 0;
+};
+
+double CompactionSimulatorStats::write_amp() const {
+  if (bytes_ingested == 0) {
+    return 0;
+  }
+  return static_cast<double>(bytes_flushed + bytes_compacted_written) /
+         bytes_ingested;
+}
+
+double CompactionSimulatorStats::space_amp() const {
+  if (live_bytes == 0) {
+    return 0;
+  }
+  return static_cast<double>(sst_bytes) / live_bytes;
+}
+
+std::string CompactionSimulatorStats::ToString() const {
+  std::string result;
+  char buf[300];
+  const double elapsed_sec = elapsed_micros / 1000000.0;
+  snprintf(buf, sizeof(buf),
+           "Simulated %.1f seconds, %s ingested\n"
+           "Flushes: %" PRIu64 ", %s written\n"
+           "Compactions: %" PRIu64 " (and %" PRIu64
+           " trivial moves), %s read, %s written\n",
+           elapsed_sec, BytesToHumanString(bytes_ingested).c_str(),
+           num_flushes, BytesToHumanString(bytes_flushed).c_str(),
+           num_compactions, num_trivial_moves,
+           BytesToHumanString(bytes_compacted_read).c_str(),
+           BytesToHumanString(bytes_compacted_written).c_str());
+  result.append(buf);
+  snprintf(buf, sizeof(buf),
+           "Write amplification: %.2f\n"
+           "Space amplification: %.2f at the end, %.2f on average, %.2f at "
+           "most\n"
+           "L0 files: %.1f on average, %" PRIu64 " at most\n",
+           write_amp(), space_amp(), avg_space_amp, max_space_amp,
+           avg_l0_files, max_l0_files);
+  result.append(buf);
+  snprintf(buf, sizeof(buf),
+           "Write stalls: stopped %.1f seconds (%.1f%%), slowed down %.1f "
+           "seconds (%.1f%%)\n",
+           stop_micros / 1000000.0,
+           elapsed_micros == 0 ? 0.0 : 100.0 * stop_micros / elapsed_micros,
+           slowdown_micros / 1000000.0,
+           elapsed_micros == 0 ? 0.0
+                               : 100.0 * slowdown_micros / elapsed_micros);
+  result.append(buf);
+  snprintf(buf, sizeof(buf), "\n%-6s %8s %10s %10s %10s %8s\n", "Level",
+           "Files", "Size", "Read", "Written", "W-Amp");
+  result.append(buf);
+  for (size_t level = 0; level < levels.size(); level++) {
+    const CompactionSimulatorLevelStats& stats = levels[level];
+    if (stats.num_files == 0 && stats.bytes_written == 0) {
+      continue;
+    }
+    snprintf(buf, sizeof(buf), "L%-5d %8" PRIu64 " %10s %10s %10s %8.2f\n",
+             static_cast<int>(level), stats.num_files,
+             BytesToHumanString(stats.size).c_str(),
+             BytesToHumanString(stats.bytes_read).c_str(),
+             BytesToHumanString(stats.bytes_written).c_str(),
+             bytes_ingested == 0
+                 ? 0.0
+                 : static_cast<double>(stats.bytes_written) / bytes_ingested);
+    result.append(buf);
+  }
+  return result;
+}
+
+CompactionSimulator::CompactionSimulator(
+    const Options& options, const CompactionSimulatorOptions& sim_options)
+    : ucmp_(BytewiseComparator()),
+      icmp_(ucmp_),
+      files_ucmp_(options.comparator),
+      options_(SimulatedOptions(options)),
+      ioptions_(options_),
+      mutable_cf_options_(options_),
+      sim_options_(sim_options),
+      levels_(options_.num_levels),
+      version_changed_(true),
+      next_file_number_(1),
+      last_sequence_(0),
+      now_micros_(0),
+      next_sample_micros_(1000000),
+      active_memtable_bytes_(0),
+      ingest_remainder_(0),
+      flush_end_micros_(0) {
+  mutable_cf_options_.RefreshDerivedOptions(ioptions_);
+  if (ioptions_.compaction_style == kCompactionStyleUniversal) {
+    picker_.reset(new UniversalCompactionPicker(ioptions_, &icmp_));
+  } else if (ioptions_.compaction_style == kCompactionStyleFIFO) {
+    picker_.reset(new FIFOCompactionPicker(ioptions_, &icmp_));
+  } else if (ioptions_.compaction_style == kCompactionStyleNone) {
+    picker_.reset(new NullCompactionPicker(ioptions_, &icmp_));
+  } else {
+    picker_.reset(new LevelCompactionPicker(ioptions_, &icmp_));
+  }
+  stats_.levels.resize(options_.num_levels);
+}
+
+CompactionSimulator::~CompactionSimulator() {
+  for (auto& job : running_compactions_) {
+    picker_->ReleaseCompactionFiles(job->compaction.get(), Status::OK());
+  }
+  running_compactions_.clear();
+}
+
+std::string CompactionSimulator::EncodeKey(uint64_t key) {
+  std::string result(sizeof(key), '\0');
+  for (size_t i = 0; i < sizeof(key); i++) {
+    result[i] = static_cast<char>((key >> (8 * (sizeof(key) - 1 - i))) & 0xff);
+  }
+  return result;
+}
+
+uint64_t CompactionSimulator::FileSize(const KeyRange& range) const {
+  return std::max<uint64_t>(
+      1, static_cast<uint64_t>(range.num_entries() * sim_options_.entry_size +
+                               0.5));
+}
+
+CompactionSimulator::SimFile* CompactionSimulator::NewFile(
+    int level, uint64_t file_number, const KeyRange& range,
+    SequenceNumber smallest_seqno, SequenceNumber largest_seqno) {
+  SimFile* file = new SimFile;
+  file->range = range;
+  file->level = level;
+  FileMetaData* meta = &file->meta;
+  meta->fd = FileDescriptor(file_number, 0, FileSize(range));
+  // With the same sequence number, smallest <= largest even if they have
+  // the same user key
+  meta->smallest =
+      InternalKey(EncodeKey(range.smallest), largest_seqno, kTypeValue);
+  meta->largest =
+      InternalKey(EncodeKey(range.largest), largest_seqno, kTypeValue);
+  meta->smallest_seqno = smallest_seqno;
+  meta->largest_seqno = largest_seqno;
+  meta->compensated_file_size = meta->fd.GetFileSize();
+  files_[file_number].reset(file);
+  next_file_number_ = std::max(next_file_number_, file_number + 1);
+  return file;
+}
+
+void CompactionSimulator::InsertFile(int level, SimFile* file) {
+  file->level = level;
+  std::vector<SimFile*>& files = levels_[level];
+  if (level == 0) {
+    // Newest first, like VersionBuilder
+    auto pos = std::upper_bound(
+        files.begin(), files.end(), file,
+        [](const SimFile* f1, const SimFile* f2) -> bool {
+          if (f1->meta.largest_seqno != f2->meta.largest_seqno) {
+            return f1->meta.largest_seqno > f2->meta.largest_seqno;
+          }
+          return f1->meta.fd.GetNumber() > f2->meta.fd.GetNumber();
+        });
+    files.insert(pos, file);
+  } else {
+    auto pos = std::upper_bound(
+        files.begin(), files.end(), file,
+        [](const SimFile* f1, const SimFile* f2) -> bool {
+          return f1->range.smallest < f2->range.smallest;
+        });
+    files.insert(pos, file);
+  }
+  version_changed_ = true;
+}
+
+void CompactionSimulator::AddFile(int level, uint64_t file_number,
+                                  uint64_t smallest_key, uint64_t largest_key,
+                                  uint64_t file_size) {
+  assert(level < options_.num_levels);
+  assert(smallest_key <= largest_key);
+  KeyRange range;
+  range.smallest = smallest_key;
+  range.largest = largest_key;
+  range.coverage = std::min(
+      1.0, static_cast<double>(file_size) / sim_options_.entry_size /
+               (largest_key - smallest_key + 1));
+  last_sequence_++;
+  InsertFile(level,
+             NewFile(level, file_number, range, last_sequence_,
+                     last_sequence_));
+}
+
+void CompactionSimulator::AddFiles(const std::vector<LiveFileMetaData>& files) {
+  std::vector<std::string> boundaries;
+  for (const auto& file : files) {
+    boundaries.push_back(file.smallestkey);
+    boundaries.push_back(file.largestkey);
+  }
+  auto less = [&](const std::string& a, const std::string& b) {
+    return files_ucmp_->Compare(a, b) < 0;
+  };
+  std::sort(boundaries.begin(), boundaries.end(), less);
+  boundaries.erase(
+      std::unique(boundaries.begin(), boundaries.end(),
+                  [&](const std::string& a, const std::string& b) {
+                    return files_ucmp_->Compare(a, b) == 0;
+                  }),
+      boundaries.end());
+  const uint64_t max_key = std::max<uint64_t>(sim_options_.num_keys, 1) - 1;
+  auto key_of = [&](const std::string& user_key) -> uint64_t {
+    size_t rank = std::lower_bound(boundaries.begin(), boundaries.end(),
+                                   user_key, less) -
+                  boundaries.begin();
+    if (boundaries.size() <= 1) {
+      return 0;
+    }
+    return static_cast<uint64_t>(static_cast<double>(max_key) * rank /
+                                 (boundaries.size() - 1));
+  };
+  for (const auto& file : files) {
+    KeyRange range;
+    range.smallest = key_of(file.smallestkey);
+    range.largest = key_of(file.largestkey);
+    range.coverage = std::min(
+        1.0, static_cast<double>(file.size) / sim_options_.entry_size /
+                 (range.largest - range.smallest + 1));
+    last_sequence_ = std::max(last_sequence_, file.largest_seqno);
+    InsertFile(file.level,
+               NewFile(file.level, TableFileNameToNumber(file.name), range,
+                       file.smallest_seqno, file.largest_seqno));
+  }
+}
+
+void CompactionSimulator::AddAllKeys(int level) {
+  SimFile all_keys;
+  all_keys.range.smallest = 0;
+  all_keys.range.largest = std::max<uint64_t>(sim_options_.num_keys, 1) - 1;
+  all_keys.range.coverage = 1.0;
+  last_sequence_++;
+  for (const KeyRange& range :
+       MergeFiles({&all_keys},
+                  mutable_cf_options_.MaxFileSizeForLevel(level))) {
+    InsertFile(level, NewFile(level, next_file_number_, range, last_sequence_,
+                              last_sequence_));
+  }
+}
+
+std::vector<CompactionSimulator::KeyRange> CompactionSimulator::MergeFiles(
+    const std::vector<SimFile*>& files, uint64_t max_file_size) const {
+  // Sweeps the starts and ends of the files. A key is in the merged
+  // output unless it is in none of the files covering it.
+  std::vector<std::pair<uint64_t, const SimFile*>> starts;
+  std::vector<std::pair<uint64_t, const SimFile*>> ends;
+  for (const SimFile* file : files) {
+    starts.emplace_back(file->range.smallest, file);
+    ends.emplace_back(file->range.largest + 1, file);
+  }
+  auto by_key = [](const std::pair<uint64_t, const SimFile*>& e1,
+                   const std::pair<uint64_t, const SimFile*>& e2) -> bool {
+    return e1.first < e2.first;
+  };
+  std::sort(starts.begin(), starts.end(), by_key);
+  std::sort(ends.begin(), ends.end(), by_key);
+
+  const double max_entries =
+      max_file_size == 0
+          ? std::numeric_limits<double>::max()
+          : std::max(1.0, static_cast<double>(max_file_size) /
+                              sim_options_.entry_size);
+  std::vector<KeyRange> outputs;
+  KeyRange output;
+  double output_entries = 0;
+  bool output_open = false;
+  auto finish_output = [&]() {
+    output.coverage = std::min(
+        1.0, output_entries / (output.largest - output.smallest + 1));
+    outputs.push_back(output);
+    output_open = false;
+  };
+
+  size_t next_start = 0;
+  size_t next_end = 0;
+  size_t num_active = 0;
+  size_t num_full = 0;
+  // Of log(1 - coverage), for the files of coverage < 1
+  double log_missing = 0;
+  uint64_t key = 0;
+  while (next_end < ends.size()) {
+    uint64_t next_key = ends[next_end].first;
+    if (next_start < starts.size()) {
+      next_key = std::min(next_key, starts[next_start].first);
+    }
+    if (num_active > 0 && next_key > key) {
+      const double coverage =
+          num_full > 0 ? 1.0 : 1.0 - std::exp(log_missing);
+      uint64_t pos = key;
+      while (pos < next_key && coverage > 0) {
+        if (!output_open) {
+          output.smallest = pos;
+          output_entries = 0;
+          output_open = true;
+        }
+        const double room = max_entries - output_entries;
+        const uint64_t width = next_key - pos;
+        if (coverage * width <= room) {
+          output_entries += coverage * width;
+          output.largest = next_key - 1;
+          pos = next_key;
+        } else {
+          uint64_t cut = width;
+          if (room / coverage < width) {
+            cut = std::max<uint64_t>(1, static_cast<uint64_t>(room / coverage));
+          }
+          output_entries += coverage * cut;
+          output.largest = pos + cut - 1;
+          pos += cut;
+          finish_output();
+        }
+      }
+    }
+    key = next_key;
+    while (next_end < ends.size() && ends[next_end].first == key) {
+      const double coverage = ends[next_end].second->range.coverage;
+      if (coverage >= 1.0) {
+        num_full--;
+      } else {
+        log_missing -= std::log(1.0 - coverage);
+      }
+      num_active--;
+      next_end++;
+    }
+    while (next_start < starts.size() && starts[next_start].first == key) {
+      const double coverage = starts[next_start].second->range.coverage;
+      if (coverage >= 1.0) {
+        num_full++;
+      } else {
+        log_missing += std::log(1.0 - coverage);
+      }
+      num_active++;
+      next_start++;
+    }
+    if (num_active == 0) {
+      log_missing = 0;
+    }
+  }
+  if (output_open) {
+    finish_output();
+  }
+  return outputs;
+}
+
+void CompactionSimulator::UpdateVersion() {
+  vstorage_.reset(new VersionStorageInfo(&icmp_, ucmp_, options_.num_levels,
+                                         ioptions_.compaction_style, nullptr,
+                                         false));
+  for (int level = 0; level < options_.num_levels; level++) {
+    for (SimFile* file : levels_[level]) {
+      vstorage_->AddFile(level, &file->meta);
+    }
+  }
+  vstorage_->CalculateBaseBytes(ioptions_, mutable_cf_options_);
+  vstorage_->UpdateFilesByCompactionPri(ioptions_.compaction_pri);
+  vstorage_->UpdateNumNonEmptyLevels();
+  vstorage_->GenerateFileIndexer();
+  vstorage_->GenerateLevelFilesBrief();
+  vstorage_->ComputeCompactionScore(ioptions_, mutable_cf_options_);
+  vstorage_->GenerateLevel0NonOverlapping();
+  vstorage_->ComputeFilesMarkedForCompaction();
+  vstorage_->SetFinalized();
+  version_changed_ = false;
+
+  if (running_compactions_.empty()) {
+    for (uint64_t file_number : obsolete_files_) {
+      files_.erase(file_number);
+    }
+    obsolete_files_.clear();
+  }
+}
+
+Compaction* CompactionSimulator::PickCompaction() {
+  if (version_changed_) {
+    UpdateVersion();
+  }
+  if (!picker_->NeedsCompaction(vstorage_.get())) {
+    return nullptr;
+  }
+  LogBuffer log_buffer(InfoLogLevel::INFO_LEVEL, ioptions_.info_log);
+  Compaction* c = picker_->PickCompaction(
+      kDefaultColumnFamilyName, mutable_cf_options_, vstorage_.get(),
+      &log_buffer);
+  log_buffer.FlushBufferToLog();
+  return c;
+}
+
+bool CompactionSimulator::PickFirstCompaction(
+    SimulatedCompaction* compaction) {
+  std::unique_ptr<Compaction> c(PickCompaction());
+  if (c == nullptr) {
+    return false;
+  }
+  std::vector<SimFile*> inputs;
+  compaction->input_file_numbers.clear();
+  compaction->input_bytes = 0;
+  for (size_t i = 0; i < c->num_input_levels(); i++) {
+    for (size_t j = 0; j < c->num_input_files(i); j++) {
+      FileMetaData* meta = c->input(i, j);
+      meta->being_compacted = false;
+      inputs.push_back(files_[meta->fd.GetNumber()].get());
+      compaction->input_file_numbers.push_back(meta->fd.GetNumber());
+      compaction->input_bytes += meta->fd.GetFileSize();
+    }
+  }
+  compaction->output_level = c->output_level();
+  compaction->max_output_file_size = c->max_output_file_size();
+  compaction->output_bytes = 0;
+  if (!c->deletion_compaction()) {
+    for (const KeyRange& range :
+         MergeFiles(inputs, c->max_output_file_size())) {
+      compaction->output_bytes += FileSize(range);
+    }
+  }
+  picker_->ReleaseCompactionFiles(c.get(), Status::OK());
+  // The scores were updated for the picked compaction
+  version_changed_ = true;
+  return true;
+}
+
+void CompactionSimulator::StartCompaction(Compaction* c) {
+  std::unique_ptr<Job> job(new Job);
+  job->compaction.reset(c);
+  job->vstorage = vstorage_;
+  uint64_t input_bytes = 0;
+  for (size_t i = 0; i < c->num_input_levels(); i++) {
+    for (size_t j = 0; j < c->num_input_files(i); j++) {
+      FileMetaData* meta = c->input(i, j);
+      job->inputs.push_back(files_[meta->fd.GetNumber()].get());
+      input_bytes += meta->fd.GetFileSize();
+    }
+  }
+  job->end_micros = now_micros_;
+  if (c->deletion_compaction()) {
+    // Deletes the inputs, no I/O
+  } else if (c->IsTrivialMove()) {
+    job->trivial_move = true;
+  } else {
+    job->outputs = MergeFiles(job->inputs, c->max_output_file_size());
+    uint64_t output_bytes = 0;
+    for (const KeyRange& range : job->outputs) {
+      output_bytes += FileSize(range);
+    }
+    job->end_micros +=
+        std::max<uint64_t>(1, (input_bytes + output_bytes) * 1000000 /
+                                  std::max<uint64_t>(
+                                      sim_options_.compaction_bytes_per_sec,
+                                      1));
+  }
+  running_compactions_.push_back(std::move(job));
+}
+
+void CompactionSimulator::FinishCompaction(Job* job) {
+  Compaction* c = job->compaction.get();
+  const int output_level = c->output_level();
+  SequenceNumber smallest_seqno = kMaxSequenceNumber;
+  SequenceNumber largest_seqno = 0;
+  for (SimFile* file : job->inputs) {
+    std::vector<SimFile*>& level_files = levels_[file->level];
+    level_files.erase(
+        std::find(level_files.begin(), level_files.end(), file));
+    file->meta.being_compacted = false;
+    smallest_seqno = std::min(smallest_seqno, file->meta.smallest_seqno);
+    largest_seqno = std::max(largest_seqno, file->meta.largest_seqno);
+    if (job->trivial_move) {
+      InsertFile(output_level, file);
+    } else {
+      if (!c->deletion_compaction()) {
+        stats_.levels[file->level].bytes_read += file->meta.fd.GetFileSize();
+        stats_.bytes_compacted_read += file->meta.fd.GetFileSize();
+      }
+      obsolete_files_.push_back(file->meta.fd.GetNumber());
+    }
+  }
+  picker_->ReleaseCompactionFiles(c, Status::OK());
+
+  for (const KeyRange& range : job->outputs) {
+    SimFile* file = NewFile(output_level, next_file_number_, range,
+                            smallest_seqno, largest_seqno);
+    InsertFile(output_level, file);
+    stats_.levels[output_level].bytes_written += file->meta.fd.GetFileSize();
+    stats_.bytes_compacted_written += file->meta.fd.GetFileSize();
+  }
+  if (job->trivial_move) {
+    stats_.num_trivial_moves++;
+  } else {
+    stats_.num_compactions++;
+  }
+  version_changed_ = true;
+}
+
+void CompactionSimulator::StartFlush() {
+  assert(flush_end_micros_ == 0 && !immutable_memtables_.empty());
+  flush_end_micros_ =
+      now_micros_ +
+      std::max<uint64_t>(
+          1, immutable_memtables_.front() * 1000000 /
+                 std::max<uint64_t>(sim_options_.flush_bytes_per_sec, 1));
+}
+
+void CompactionSimulator::FinishFlush() {
+  const uint64_t num_entries = std::max<uint64_t>(
+      1, immutable_memtables_.front() / sim_options_.entry_size);
+  immutable_memtables_.pop_front();
+  flush_end_micros_ = 0;
+
+  // num_entries writes of uniform keys
+  const uint64_t num_keys = std::max<uint64_t>(sim_options_.num_keys, 1);
+  KeyRange range;
+  range.smallest = 0;
+  range.largest = num_keys - 1;
+  range.coverage =
+      1.0 - std::exp(-static_cast<double>(num_entries) / num_keys);
+  SimFile* file = NewFile(0, next_file_number_, range, last_sequence_ + 1,
+                          last_sequence_ + num_entries);
+  last_sequence_ += num_entries;
+  InsertFile(0, file);
+  stats_.num_flushes++;
+  stats_.bytes_flushed += file->meta.fd.GetFileSize();
+  stats_.levels[0].bytes_written += file->meta.fd.GetFileSize();
+}
+
+void CompactionSimulator::Step() {
+  if (flush_end_micros_ != 0 && flush_end_micros_ <= now_micros_) {
+    FinishFlush();
+  }
+  for (size_t i = 0; i < running_compactions_.size();) {
+    if (running_compactions_[i]->end_micros <= now_micros_) {
+      FinishCompaction(running_compactions_[i].get());
+      running_compactions_.erase(running_compactions_.begin() + i);
+    } else {
+      i++;
+    }
+  }
+  if (!mutable_cf_options_.disable_auto_compactions) {
+    const size_t max_compactions =
+        std::max(options_.max_background_compactions, 1);
+    while (running_compactions_.size() < max_compactions) {
+      Compaction* c = PickCompaction();
+      if (c == nullptr) {
+        break;
+      }
+      StartCompaction(c);
+      // Trivial moves and deletions take no time
+      if (running_compactions_.back()->end_micros <= now_micros_) {
+        FinishCompaction(running_compactions_.back().get());
+        running_compactions_.pop_back();
+      }
+    }
+  }
+  if (version_changed_) {
+    UpdateVersion();
+  }
+
+  // The write stall conditions of
+  // ColumnFamilyData::RecalculateWriteStallConditions()
+  const uint64_t write_buffer_size = mutable_cf_options_.write_buffer_size;
+  const size_t max_write_buffer_number =
+      std::max(mutable_cf_options_.max_write_buffer_number, 2);
+  const bool memtables_full =
+      active_memtable_bytes_ >= write_buffer_size &&
+      immutable_memtables_.size() + 1 >= max_write_buffer_number;
+  const bool check_compactions = !mutable_cf_options_.disable_auto_compactions;
+  const int l0_files = vstorage_->l0_delay_trigger_count();
+  const uint64_t pending_bytes = vstorage_->estimated_compaction_needed_bytes();
+  const uint64_t hard_limit =
+      mutable_cf_options_.hard_pending_compaction_bytes_limit;
+  const uint64_t soft_limit =
+      mutable_cf_options_.soft_pending_compaction_bytes_limit;
+  const bool stop =
+      memtables_full ||
+      (check_compactions &&
+       (l0_files >= mutable_cf_options_.level0_stop_writes_trigger ||
+        (hard_limit > 0 && pending_bytes >= hard_limit)));
+  const bool slowdown =
+      !stop && check_compactions &&
+      (l0_files >= mutable_cf_options_.level0_slowdown_writes_trigger ||
+       (soft_limit > 0 && pending_bytes >= soft_limit));
+
+  const uint64_t step_micros = std::max<uint64_t>(sim_options_.step_micros, 1);
+  if (stop) {
+    stats_.stop_micros += step_micros;
+  } else {
+    uint64_t rate = sim_options_.ingest_bytes_per_sec;
+    if (slowdown) {
+      const uint64_t delayed_write_rate = options_.delayed_write_rate == 0
+                                              ? 16 << 20
+                                              : options_.delayed_write_rate;
+      rate = std::min(rate, delayed_write_rate);
+      stats_.slowdown_micros += step_micros;
+    }
+    ingest_remainder_ += rate * step_micros;
+    const uint64_t bytes = ingest_remainder_ / 1000000;
+    ingest_remainder_ %= 1000000;
+    active_memtable_bytes_ += bytes;
+    stats_.bytes_ingested += bytes;
+  }
+  if (active_memtable_bytes_ >= write_buffer_size &&
+      immutable_memtables_.size() + 1 < max_write_buffer_number) {
+    immutable_memtables_.push_back(active_memtable_bytes_);
+    active_memtable_bytes_ = 0;
+  }
+  if (flush_end_micros_ == 0 && !immutable_memtables_.empty()) {
+    StartFlush();
+  }
+
+  now_micros_ += step_micros;
+  stats_.elapsed_micros += step_micros;
+  if (now_micros_ >= next_sample_micros_) {
+    Sample();
+    next_sample_micros_ += 1000000;
+  }
+}
+
+void CompactionSimulator::Sample() {
+  const uint64_t l0_files = levels_[0].size();
+  std::vector<SimFile*> all_files;
+  uint64_t sst_bytes = 0;
+  for (const auto& level_files : levels_) {
+    for (SimFile* file : level_files) {
+      all_files.push_back(file);
+      sst_bytes += file->meta.fd.GetFileSize();
+    }
+  }
+  uint64_t live_bytes = 0;
+  for (const KeyRange& range : MergeFiles(all_files, 0)) {
+    live_bytes += FileSize(range);
+  }
+  const double space_amp =
+      live_bytes == 0 ? 0.0 : static_cast<double>(sst_bytes) / live_bytes;
+
+  const double n = static_cast<double>(stats_.num_samples);
+  stats_.avg_l0_files = (stats_.avg_l0_files * n + l0_files) / (n + 1);
+  stats_.avg_space_amp = (stats_.avg_space_amp * n + space_amp) / (n + 1);
+  stats_.max_l0_files = std::max(stats_.max_l0_files, l0_files);
+  stats_.max_space_amp = std::max(stats_.max_space_amp, space_amp);
+  stats_.num_samples++;
+  stats_.sst_bytes = sst_bytes;
+  stats_.live_bytes = live_bytes;
+}
+
+void CompactionSimulator::Run(uint64_t duration_micros) {
+  const uint64_t end_micros = now_micros_ + duration_micros;
+  while (now_micros_ < end_micros) {
+    Step();
+  }
+  Sample();
+  for (int level = 0; level < options_.num_levels; level++) {
+    CompactionSimulatorLevelStats& level_stats = stats_.levels[level];
+    level_stats.num_files = levels_[level].size();
+    level_stats.size = 0;
+    for (SimFile* file : levels_[level]) {
+      level_stats.size += file->meta.fd.GetFileSize();
+    }
+  }
+}
+
+}  // namespace rocksdb
+
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,197 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#ifndef ROCKSDB_LITE
+
+#include <stdint.h>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "db/compaction_picker.h"
+#include "db/dbformat.h"
+#include "db/version_set.h"
+#include "options/cf_options.h"
+#include "rocksdb/metadata.h"
+#include "rocksdb/options.h"
+
+namespace rocksdb {
+
+// The simulated workload and the speed of the simulated machine
+struct CompactionSimulatorOptions {
+  // Bytes written per second by the users, unless writes are stalled
+  uint64_t ingest_bytes_per_sec = 16 << 20;
+  // The size of a key and its value, in memtables and in table files
+  uint64_t entry_size = 1024;
+  // The number of distinct keys, the writes are uniform over them
+  uint64_t num_keys = 10 << 20;
+  // Bytes per second that a flush writes
+  uint64_t flush_bytes_per_sec = 256 << 20;
+  // Bytes per second that one compaction reads and writes
+  uint64_t compaction_bytes_per_sec = 128 << 20;
+  // The simulated time between two steps
+  uint64_t step_micros = 10000;
+};
+
+struct CompactionSimulatorLevelStats {
+  uint64_t num_files = 0;
+  uint64_t size = 0;
+  // By flushes (L0) or compactions into the level
+  uint64_t bytes_written = 0;
+  // By compactions from the level
+  uint64_t bytes_read = 0;
+};
+
+struct CompactionSimulatorStats {
+  uint64_t elapsed_micros = 0;
+  uint64_t bytes_ingested = 0;
+  uint64_t bytes_flushed = 0;
+  uint64_t bytes_compacted_read = 0;
+  uint64_t bytes_compacted_written = 0;
+  uint64_t num_flushes = 0;
+  uint64_t num_compactions = 0;
+  uint64_t num_trivial_moves = 0;
+  // The time that writes were stopped, or delayed to
+  // DBOptions::delayed_write_rate
+  uint64_t stop_micros = 0;
+  uint64_t slowdown_micros = 0;
+  // Sampled every simulated second
+  uint64_t num_samples = 0;
+  uint64_t max_l0_files = 0;
+  double avg_l0_files = 0;
+  double max_space_amp = 0;
+  double avg_space_amp = 0;
+  // The table files, and the distinct keys in them, at the end
+  uint64_t sst_bytes = 0;
+  uint64_t live_bytes = 0;
+  std::vector<CompactionSimulatorLevelStats> levels;
+
+  // Bytes written to table files per byte ingested
+  double write_amp() const;
+  // Bytes of table files per byte of distinct keys, at the end
+  double space_amp() const;
+
+  std::string ToString() const;
+};
+
+// A compaction picked by CompactionSimulator
+struct SimulatedCompaction {
+  std::vector<uint64_t> input_file_numbers;
+  int output_level = 0;
+  uint64_t max_output_file_size = 0;
+  uint64_t input_bytes = 0;
+  // As modeled
+  uint64_t output_bytes = 0;
+};
+
+// CompactionSimulator replays the flushes and compactions of a column family
+// without data. It models each table file by its key range and the fraction
+// of the keys of the range it holds, picks compactions with the
+// CompactionPicker of the options on a VersionStorageInfo of the files (so
+// levels are scored like in a DB), and derives the output files of each
+// compaction from its inputs. Writes stall on the triggers of the options.
+//
+// Keys are the numbers in [0, num_keys), as 8-byte big-endian user keys of
+// the bytewise comparator. Not thread-safe.
+class CompactionSimulator {
+ public:
+  CompactionSimulator(const Options& options,
+                      const CompactionSimulatorOptions& sim_options);
+  ~CompactionSimulator();
+
+  // Adds a file of the keys in [smallest_key, largest_key] to the LSM tree
+  // before Run(). The files of a level > 0 must not overlap.
+  void AddFile(int level, uint64_t file_number, uint64_t smallest_key,
+               uint64_t largest_key, uint64_t file_size);
+
+  // Adds the files of a captured LSM tree, e.g. read from a MANIFEST. Their
+  // keys are mapped to [0, num_keys) by their rank, in the order of the
+  // comparator of the options, among the smallest and largest keys of all the
+  // files, which keeps the shape of the tree.
+  void AddFiles(const std::vector<LiveFileMetaData>& files);
+
+  // Adds all the keys, as the files of one level
+  void AddAllKeys(int level);
+
+  // Returns false if no compaction is needed, else the compaction that a DB
+  // would pick first for the files added so far
+  bool PickFirstCompaction(SimulatedCompaction* compaction);
+
+  // Simulates duration_micros of writes, flushes and compactions
+  void Run(uint64_t duration_micros);
+
+  const CompactionSimulatorStats& stats() const { return stats_; }
+
+ private:
+  struct SimFile;
+  struct KeyRange;
+  struct Job;
+
+  static std::string EncodeKey(uint64_t key);
+
+  SimFile* NewFile(int level, uint64_t file_number, const KeyRange& range,
+                   SequenceNumber smallest_seqno,
+                   SequenceNumber largest_seqno);
+  void InsertFile(int level, SimFile* file);
+  // Builds the VersionStorageInfo of the files of levels_
+  void UpdateVersion();
+  // Splits the distinct keys of files into ranges of up to max_file_size
+  // bytes
+  std::vector<KeyRange> MergeFiles(const std::vector<SimFile*>& files,
+                                   uint64_t max_file_size) const;
+  uint64_t FileSize(const KeyRange& range) const;
+
+  Compaction* PickCompaction();
+  void StartCompaction(Compaction* c);
+  void FinishCompaction(Job* job);
+  void StartFlush();
+  void FinishFlush();
+  void Step();
+  void Sample();
+
+  const Comparator* ucmp_;
+  InternalKeyComparator icmp_;
+  // Of the keys of the files passed to AddFiles()
+  const Comparator* files_ucmp_;
+  Options options_;
+  ImmutableCFOptions ioptions_;
+  MutableCFOptions mutable_cf_options_;
+  const CompactionSimulatorOptions sim_options_;
+  std::unique_ptr<CompactionPicker> picker_;
+
+  // All files, by file number
+  std::unordered_map<uint64_t, std::unique_ptr<SimFile>> files_;
+  // Level 0 newest first, other levels by key
+  std::vector<std::vector<SimFile*>> levels_;
+  // Deleted files that running compactions may still refer to
+  std::vector<uint64_t> obsolete_files_;
+  // Running compactions hold the version they were picked from
+  std::shared_ptr<VersionStorageInfo> vstorage_;
+  bool version_changed_;
+
+  uint64_t next_file_number_;
+  SequenceNumber last_sequence_;
+  uint64_t now_micros_;
+  uint64_t next_sample_micros_;
+
+  // The bytes written to the memtables
+  uint64_t active_memtable_bytes_;
+  // The part of a byte not ingested yet, in millionths of a byte
+  uint64_t ingest_remainder_;
+  std::deque<uint64_t> immutable_memtables_;
+  // 0 if no flush is running
+  uint64_t flush_end_micros_;
+
+  std::vector<std::unique_ptr<Job>> running_compactions_;
+  CompactionSimulatorStats stats_;
+};
+
+}  // namespace rocksdb
+
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,216 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include "utilities/simulator_compaction/compaction_simulator.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "rocksdb/comparator.h"
+#include "util/filename.h"
+#include "util/testharness.h"
+
+namespace rocksdb {
+
+class CompactionSimulatorTest : public testing::Test {
+ public:
+  CompactionSimulatorTest() {
+    options_.write_buffer_size = 1 << 20;
+    options_.target_file_size_base = 1 << 20;
+    options_.max_bytes_for_level_base = 4 << 20;
+    options_.level0_file_num_compaction_trigger = 4;
+    options_.level0_slowdown_writes_trigger = 8;
+    options_.level0_stop_writes_trigger = 12;
+    sim_options_.ingest_bytes_per_sec = 1 << 20;
+    sim_options_.entry_size = 128;
+    sim_options_.num_keys = 1 << 20;
+  }
+
+  static uint64_t Seconds(uint64_t seconds) { return seconds * 1000000; }
+
+  Options options_;
+  CompactionSimulatorOptions sim_options_;
+};
+
+TEST_F(CompactionSimulatorTest, FlushOnly) {
+  options_.disable_auto_compactions = true;
+  options_.level0_stop_writes_trigger = 100;
+  CompactionSimulator simulator(options_, sim_options_);
+  simulator.Run(Seconds(10));
+  const CompactionSimulatorStats& stats = simulator.stats();
+  ASSERT_EQ(Seconds(10), stats.elapsed_micros);
+  ASSERT_EQ(10U << 20, stats.bytes_ingested);
+  // The last memtable is still being written, or flushed
+  ASSERT_GE(stats.num_flushes, 8U);
+  ASSERT_LE(stats.num_flushes, 10U);
+  ASSERT_EQ(0U, stats.num_compactions);
+  ASSERT_EQ(stats.num_flushes, stats.levels[0].num_files);
+  // Few keys are written twice
+  ASSERT_GT(stats.write_amp(), 0.75);
+  ASSERT_LE(stats.write_amp(), 1.0);
+  ASSERT_EQ(0U, stats.stop_micros);
+  ASSERT_GE(stats.space_amp(), 1.0);
+}
+
+TEST_F(CompactionSimulatorTest, LeveledCompaction) {
+  CompactionSimulator simulator(options_, sim_options_);
+  simulator.Run(Seconds(120));
+  const CompactionSimulatorStats& stats = simulator.stats();
+  ASSERT_GT(stats.num_compactions, 0U);
+  ASSERT_GT(stats.bytes_compacted_written, 0U);
+  ASSERT_GT(stats.write_amp(), 1.5);
+  ASSERT_LT(stats.max_l0_files,
+            static_cast<uint64_t>(options_.level0_stop_writes_trigger));
+  ASSERT_EQ(0U, stats.stop_micros);
+  // The data reached the levels below L1
+  uint64_t deeper_bytes = 0;
+  for (size_t level = 2; level < stats.levels.size(); level++) {
+    deeper_bytes += stats.levels[level].size;
+  }
+  ASSERT_GT(deeper_bytes, 0U);
+  ASSERT_GE(stats.space_amp(), 1.0);
+  ASSERT_LT(stats.space_amp(), 3.0);
+  ASSERT_GT(stats.live_bytes, 0U);
+  // At most all the keys
+  ASSERT_LE(stats.live_bytes, sim_options_.num_keys * sim_options_.entry_size);
+  ASSERT_NE(std::string::npos, stats.ToString().find("Write amplification"));
+}
+
+TEST_F(CompactionSimulatorTest, WriteStalls) {
+  // Compactions cannot keep up
+  sim_options_.ingest_bytes_per_sec = 8 << 20;
+  sim_options_.compaction_bytes_per_sec = 1 << 20;
+  CompactionSimulator simulator(options_, sim_options_);
+  simulator.Run(Seconds(60));
+  const CompactionSimulatorStats& stats = simulator.stats();
+  ASSERT_GT(stats.stop_micros, 0U);
+  ASSERT_GT(stats.slowdown_micros, 0U);
+  ASSERT_GE(stats.max_l0_files,
+            static_cast<uint64_t>(options_.level0_slowdown_writes_trigger));
+  ASSERT_LT(stats.bytes_ingested, 60U * sim_options_.ingest_bytes_per_sec);
+}
+
+TEST_F(CompactionSimulatorTest, PickFirstCompaction) {
+  CompactionSimulator simulator(options_, sim_options_);
+  SimulatedCompaction compaction;
+  ASSERT_FALSE(simulator.PickFirstCompaction(&compaction));
+
+  // Four L0 files over all the keys, and L1 files over the first half
+  std::vector<LiveFileMetaData> files;
+  for (int i = 0; i < 4; i++) {
+    files.emplace_back();
+    files.back().name = MakeTableFileName("", 10 + i);
+    files.back().level = 0;
+    files.back().size = 1 << 20;
+    files.back().smallestkey = "a";
+    files.back().largestkey = "z";
+    files.back().smallest_seqno = 100 + 10 * i;
+    files.back().largest_seqno = 100 + 10 * i + 9;
+  }
+  for (int i = 0; i < 3; i++) {
+    files.emplace_back();
+    files.back().name = MakeTableFileName("", 20 + i);
+    files.back().level = 1;
+    files.back().size = 1 << 20;
+    files.back().smallestkey = std::string(1, static_cast<char>('b' + 2 * i));
+    files.back().largestkey = std::string(1, static_cast<char>('c' + 2 * i));
+    files.back().smallest_seqno = 1;
+    files.back().largest_seqno = 50;
+  }
+  simulator.AddFiles(files);
+  ASSERT_TRUE(simulator.PickFirstCompaction(&compaction));
+  ASSERT_EQ(1, compaction.output_level);
+  std::vector<uint64_t> input_files = compaction.input_file_numbers;
+  std::sort(input_files.begin(), input_files.end());
+  ASSERT_EQ(std::vector<uint64_t>({10, 11, 12, 13, 20, 21, 22}), input_files);
+  ASSERT_EQ(7U << 20, compaction.input_bytes);
+  ASSERT_GT(compaction.output_bytes, 0U);
+  ASSERT_LE(compaction.output_bytes, compaction.input_bytes);
+
+  // Picking again gives the same compaction
+  SimulatedCompaction again;
+  ASSERT_TRUE(simulator.PickFirstCompaction(&again));
+  std::sort(again.input_file_numbers.begin(), again.input_file_numbers.end());
+  ASSERT_EQ(input_files, again.input_file_numbers);
+}
+
+TEST_F(CompactionSimulatorTest, AddFilesOfReverseComparator) {
+  options_.comparator = ReverseBytewiseComparator();
+  CompactionSimulator simulator(options_, sim_options_);
+  // Two L1 files over the keys "z" to "n" and "m" to "a", and an L0 file
+  // that overlaps only the second one
+  std::vector<LiveFileMetaData> files(3);
+  const char* ranges[][2] = {{"z", "n"}, {"m", "a"}, {"k", "b"}};
+  for (int i = 0; i < 3; i++) {
+    files[i].name = MakeTableFileName("", 10 + i);
+    files[i].level = i < 2 ? 1 : 0;
+    files[i].size = 1 << 20;
+    files[i].smallestkey = ranges[i][0];
+    files[i].largestkey = ranges[i][1];
+    files[i].smallest_seqno = i < 2 ? 1 : 100;
+    files[i].largest_seqno = i < 2 ? 50 : 150;
+  }
+  // Four L0 files trigger a compaction
+  for (int i = 0; i < 3; i++) {
+    files.push_back(files[2]);
+    files.back().name = MakeTableFileName("", 13 + i);
+    files.back().smallest_seqno = 200 + 100 * i;
+    files.back().largest_seqno = 250 + 100 * i;
+  }
+  simulator.AddFiles(files);
+  SimulatedCompaction compaction;
+  ASSERT_TRUE(simulator.PickFirstCompaction(&compaction));
+  ASSERT_EQ(1, compaction.output_level);
+  std::vector<uint64_t> input_files = compaction.input_file_numbers;
+  std::sort(input_files.begin(), input_files.end());
+  ASSERT_EQ(std::vector<uint64_t>({11, 12, 13, 14, 15}), input_files);
+}
+
+TEST_F(CompactionSimulatorTest, FromCompactedLevel) {
+  options_.num_levels = 4;
+  CompactionSimulator simulator(options_, sim_options_);
+  simulator.AddAllKeys(3);
+  simulator.Run(Seconds(1));
+  const CompactionSimulatorStats& stats = simulator.stats();
+  ASSERT_EQ(sim_options_.num_keys * sim_options_.entry_size,
+            stats.levels[3].size);
+  // Of target_file_size_base
+  ASSERT_EQ(128U, stats.levels[3].num_files);
+  // Nothing else was written yet, so all the table data is live
+  ASSERT_EQ(0U, stats.num_flushes);
+  ASSERT_EQ(stats.sst_bytes, stats.live_bytes);
+}
+
+TEST_F(CompactionSimulatorTest, UniversalCompaction) {
+  options_.compaction_style = kCompactionStyleUniversal;
+  options_.num_levels = 1;
+  CompactionSimulator simulator(options_, sim_options_);
+  simulator.Run(Seconds(60));
+  const CompactionSimulatorStats& stats = simulator.stats();
+  ASSERT_GT(stats.num_compactions, 0U);
+  ASSERT_GT(stats.write_amp(), 1.0);
+  ASSERT_LT(stats.max_l0_files,
+            static_cast<uint64_t>(options_.level0_stop_writes_trigger));
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#else  // ROCKSDB_LITE
+#include <stdio.h>
+
+int main(int argc, char** argv) {
+  fprintf(stderr,
+          "SKIPPED as CompactionSimulator is not supported in ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // ROCKSDB_LITE
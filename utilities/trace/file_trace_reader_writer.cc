@@ -0,0 +1,105 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "utilities/trace/file_trace_reader_writer.h"
+
+#include "util/coding.h"
+#include "util/file_reader_writer.h"
+#include "util/trace_replay.h"
+
+namespace rocksdb {
+
+FileTraceReader::FileTraceReader(
+    std::unique_ptr<RandomAccessFileReader>&& reader)
+    : file_reader_(std::move(reader)), offset_(0) {}
+
+FileTraceReader::~FileTraceReader() { Close(); }
+
+Status FileTraceReader::Close() {
+  file_reader_.reset();
+  return Status::OK();
+}
+
+Status FileTraceReader::ReadAt(size_t n, std::string* dst) {
+  size_t old_size = dst->size();
+  dst->resize(old_size + n);
+  char* scratch = &(*dst)[old_size];
+  Slice result;
+  Status s = file_reader_->Read(offset_, n, &result, scratch);
+  if (!s.ok()) {
+    return s;
+  }
+  if (result.size() < n) {
+    // The end of the file, or a record cut short by a crash while tracing
+    return Status::Incomplete("End of trace file");
+  }
+  if (result.data() != scratch) {
+    memcpy(scratch, result.data(), n);
+  }
+  offset_ += n;
+  return Status::OK();
+}
+
+Status FileTraceReader::Read(std::string* data) {
+  assert(file_reader_ != nullptr);
+  data->clear();
+  Status s = ReadAt(kTraceMetadataSize, data);
+  if (!s.ok()) {
+    return s;
+  }
+  uint32_t payload_size =
+      DecodeFixed32(data->data() + kTraceTimestampSize + kTraceTypeSize);
+  return ReadAt(payload_size, data);
+}
+
+FileTraceWriter::~FileTraceWriter() { Close(); }
+
+Status FileTraceWriter::Close() {
+  Status s;
+  if (file_writer_ != nullptr) {
+    s = file_writer_->Close();
+    file_writer_.reset();
+  }
+  return s;
+}
+
+Status FileTraceWriter::Write(const Slice& data) {
+  return file_writer_->Append(data);
+}
+
+uint64_t FileTraceWriter::GetFileSize() { return file_writer_->GetFileSize(); }
+
+Status NewFileTraceReader(Env* env, const EnvOptions& env_options,
+                          const std::string& trace_filename,
+                          std::unique_ptr<TraceReader>* trace_reader) {
+  std::unique_ptr<RandomAccessFile> trace_file;
+  Status s = env->NewRandomAccessFile(trace_filename, &trace_file, env_options);
+  if (!s.ok()) {
+    return s;
+  }
+
+  std::unique_ptr<RandomAccessFileReader> file_reader;
+  file_reader.reset(
+      new RandomAccessFileReader(std::move(trace_file), trace_filename));
+  trace_reader->reset(new FileTraceReader(std::move(file_reader)));
+  return s;
+}
+
+Status NewFileTraceWriter(Env* env, const EnvOptions& env_options,
+                          const std::string& trace_filename,
+                          std::unique_ptr<TraceWriter>* trace_writer) {
+  std::unique_ptr<WritableFile> trace_file;
+  Status s = env->NewWritableFile(trace_filename, &trace_file, env_options);
+  if (!s.ok()) {
+    return s;
+  }
+
+  std::unique_ptr<WritableFileWriter> file_writer;
+  file_writer.reset(new WritableFileWriter(std::move(trace_file), env_options));
+  trace_writer->reset(new FileTraceWriter(std::move(file_writer)));
+  return s;
+}
+
+}  // namespace rocksdb